@@ -540,6 +540,13 @@ ComplexFunc fft2d_c2c(ComplexFunc x,
 
     dft1T.compute_at(dft, outer);
 
+    // If requested, parallelize the batch. Everything above is computed inside
+    // the outer loop of dft, so this parallelizes the whole transform. The
+    // pure definition of dft is undef, so only the update needs scheduling.
+    if (desc.parallel_batch && x.dimensions() > 2) {
+        dft.update().parallel(outer);
+    }
+
     dft.bound(dft.args()[0], 0, N0);
     dft.bound(dft.args()[1], 0, N1);
 
@@ -844,6 +851,16 @@ ComplexFunc fft2d_r2c(Func r,
     dft.update(5).allow_race_conditions()
         .vectorize(n0z2, target.natural_vector_size<float>());
 
+    // If requested, parallelize the batch. The columns FFT and the unzipping
+    // are computed inside the outer loop of dft, so this parallelizes the
+    // whole transform.
+    if (desc.parallel_batch && !args.empty()) {
+        dft.parallel(outer);
+        for (int i = 0; i < dft.num_update_definitions(); i++) {
+            dft.update(i).parallel(outer);
+        }
+    }
+
     // Our result is undefined outside these bounds.
     dft.bound(n0, 0, N0);
     dft.bound(n1, 0, (N1 + 1) / 2 + 1);
@@ -1000,6 +1017,12 @@ Func fft2d_c2r(ComplexFunc c,
         .vectorize(n0, zip_width)
         .unroll(n0, gcd(N0 / zip_width, 4));
 
+    // If requested, parallelize the batch. Note that this also parallelizes
+    // dft, which is computed inside this loop of unzipped.
+    if (desc.parallel_batch && !args.empty()) {
+        unzipped.parallel(outer);
+    }
+
     return unzipped;
 }
 
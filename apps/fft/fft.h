@@ -30,6 +30,13 @@ struct Fft2dDesc {
     // if there is no outer loop around FFTs that can be parallelized.
     bool parallel = false;
 
+    // The following option indicates that the FFT should parallelize over the
+    // dimensions beyond the first two (the batch) instead of within a single
+    // FFT. This is the better option when one realization computes a batch of
+    // small FFTs, e.g. many tiles per frame. It composes with 'parallel', but
+    // usually at most one of the two makes sense.
+    bool parallel_batch = false;
+
     // This option will schedule the input to the FFT at the innermost location
     // that makes sense.
     bool schedule_input = false;
@@ -38,6 +45,12 @@ struct Fft2dDesc {
     std::string name = "";
 };
 
+// In all of the transforms below, any dimensions beyond the first 2 are
+// treated as a batch: each slice along those dimensions is transformed
+// independently, so one realization computes the whole batch, with the
+// twiddle factors computed once and shared by every slice. Use
+// Fft2dDesc::parallel_batch to distribute the batch across threads.
+
 // Compute the N0 x N1 2D complex DFT of the first 2 dimensions of a complex
 // valued function x. The first 2 dimensions of x should be defined on at least
 // [0, N0) and [0, N1) for dimensions 0, 1, respectively. sign = -1 indicates a
@@ -53,8 +66,9 @@ ComplexFunc fft2d_c2c(ComplexFunc x, int N0, int N1, int sign,
 // Compute the N0 x N1 2D complex DFT of the first 2 dimensions of a real valued
 // function r. The first 2 dimensions of r should be defined on at least [0, N0)
 // and [0, N1) for dimensions 0, 1, respectively. Note that the transform domain
-// has dimensions N0 x N1 / 2 + 1 due to the conjugate symmetry of real DFTs.
-// There is no normalization.
+// has dimensions N0 x N1 / 2 + 1 due to the conjugate symmetry of real DFTs;
+// exploiting this symmetry roughly halves the work and memory of a complex
+// transform of the same data. There is no normalization.
 ComplexFunc fft2d_r2c(Halide::Func r, int N0, int N1,
                       const Halide::Target& target,
                       const Fft2dDesc& desc = Fft2dDesc());
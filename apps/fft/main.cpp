@@ -230,10 +230,76 @@ int main(int argc, char **argv) {
            2.5*W*H*(log2(W) + log2(H))/fftw_t,
            fftw_t / halide_t);
 
+    // Benchmark batches of small FFTs with the batch loop parallelized. This
+    // is the many-small-tiles use case, e.g. tiled deconvolution. Unlike the
+    // benchmarks above, each rep gets its own output, since the reps run
+    // concurrently.
+    Fft2dDesc batch_desc;
+    batch_desc.parallel_batch = true;
+
+    ComplexFunc c2c_batch_in;
+    // All reps read from the same input. See notes on c2c_in.
+    c2c_batch_in(x, y, rep) = {re_in(x, y), im_in(x, y)};
+    Func bench_c2c_batch = fft2d_c2c(c2c_batch_in, W, H, -1, target, batch_desc);
+    Realization R_c2c_batch = bench_c2c_batch.realize(W, H, reps, target);
+
+    halide_t = benchmark(samples, 1, [&]() { bench_c2c_batch.realize(R_c2c_batch); })*1e6/reps;
+#ifdef WITH_FFTW
+    std::vector<std::pair<float, float>> fftw_cb1(W * H * reps);
+    std::vector<std::pair<float, float>> fftw_cb2(W * H * reps);
+    int fftw_n[2] = {W, H};
+    // Use FFTW_MEASURE instead of FFTW_EXHAUSTIVE here; exhaustive planning of
+    // a batch this large takes unreasonably long.
+    fftwf_plan c2c_batch_plan =
+        fftwf_plan_many_dft(2, fftw_n, reps,
+                            (fftwf_complex*)&fftw_cb1[0], nullptr, 1, W * H,
+                            (fftwf_complex*)&fftw_cb2[0], nullptr, 1, W * H,
+                            FFTW_FORWARD, FFTW_MEASURE);
+    fftw_t = benchmark(samples, 1, [&]() { fftwf_execute(c2c_batch_plan); })*1e6/reps;
+#else
+    fftw_t = 0;
+#endif
+    printf("%12s %10.3f %10.2f %10.3f %10.2f %10.3g\n",
+           "c2c batch",
+           halide_t,
+           5*W*H*(log2(W) + log2(H))/halide_t,
+           fftw_t,
+           5*W*H*(log2(W) + log2(H))/fftw_t,
+           fftw_t / halide_t);
+
+    Func r2c_batch_in;
+    // All reps read from the same input. See notes on c2c_in.
+    r2c_batch_in(x, y, rep) = re_in(x, y);
+    Func bench_r2c_batch = fft2d_r2c(r2c_batch_in, W, H, target, batch_desc);
+    Realization R_r2c_batch = bench_r2c_batch.realize(W, H/2 + 1, reps, target);
+
+    halide_t = benchmark(samples, 1, [&]() { bench_r2c_batch.realize(R_r2c_batch); })*1e6/reps;
+#ifdef WITH_FFTW
+    std::vector<float> fftw_rb(W * H * reps);
+    std::vector<std::pair<float, float>> fftw_cb(W * (H/2 + 1) * reps);
+    fftwf_plan r2c_batch_plan =
+        fftwf_plan_many_dft_r2c(2, fftw_n, reps,
+                                &fftw_rb[0], nullptr, 1, W * H,
+                                (fftwf_complex*)&fftw_cb[0], nullptr, 1, W * (H/2 + 1),
+                                FFTW_MEASURE);
+    fftw_t = benchmark(samples, 1, [&]() { fftwf_execute(r2c_batch_plan); })*1e6/reps;
+#else
+    fftw_t = 0;
+#endif
+    printf("%12s %10.3f %10.2f %10.3f %10.2f %10.3g\n",
+           "r2c batch",
+           halide_t,
+           2.5*W*H*(log2(W) + log2(H))/halide_t,
+           fftw_t,
+           2.5*W*H*(log2(W) + log2(H))/fftw_t,
+           fftw_t / halide_t);
+
 #ifdef WITH_FFTW
     fftwf_destroy_plan(c2c_plan);
     fftwf_destroy_plan(r2c_plan);
     fftwf_destroy_plan(c2r_plan);
+    fftwf_destroy_plan(c2c_batch_plan);
+    fftwf_destroy_plan(r2c_batch_plan);
 #endif
 
     return 0;
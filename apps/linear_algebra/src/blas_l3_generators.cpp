@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <vector>
 #include "Halide.h"
 
@@ -20,6 +21,12 @@ class GEMMGenerator :
     GeneratorParam<bool> transpose_A_ = {"transpose_A", false};
     GeneratorParam<bool> transpose_B_ = {"transpose_B", false};
 
+    // Cache sizes to block for. The Target doesn't describe the cache
+    // hierarchy of the machine, so take the sizes as parameters, with
+    // typical per-core defaults.
+    GeneratorParam<int> l1_cache_size_ = {"l1_cache_size", 32 * 1024};
+    GeneratorParam<int> l2_cache_size_ = {"l2_cache_size", 256 * 1024};
+
     // Standard ordering of parameters in GEMM functions.
     Input<T>         a_ = {"a_", 1};
     Input<Buffer<T>> A_ = {"A_", 2};
@@ -40,6 +47,18 @@ class GEMMGenerator :
         const int vec = natural_vector_size(a_.type());
         const int s = vec * 2;
 
+        // Pick the blocking sizes for the cache hierarchy. The reduction
+        // is split into blocks of kc, sized so that the panel of packed A
+        // (s x kc) and the matching panel of packed B (kc x 4) a microtile
+        // consumes together fit in half the L1 cache. Tiles of the output
+        // are mc x mc, sized so that the packed pieces of A and B a tile
+        // consumes per reduction block fit in half the L2 cache.
+        const int tbytes = (int)sizeof(T);
+        int kc = (int)l1_cache_size_ / (2 * tbytes * (s + 4)) / s * s;
+        kc = std::max(kc, 2);
+        int mc = (int)l2_cache_size_ / (2 * tbytes * kc) / (2 * s) * (2 * s);
+        mc = std::max(mc, 2 * s);
+
         Input<Buffer<T>> *A_in = &A_;
         Input<Buffer<T>> *B_in = &B_;
 
@@ -55,7 +74,7 @@ class GEMMGenerator :
         Var ti[3], tj[3];
 
         // Swizzle A for better memory order in the inner loop.
-        Func A("A"), B("B"), Btmp("Btmp"), As("As"), Atmp("Atmp");
+        Func A("A"), B("B"), Btmp("Btmp"), As("As"), Bs("Bs"), Atmp("Atmp");
         Atmp(i, j) = BoundaryConditions::constant_exterior(*A_in, cast<T>(0))(i, j);
 
         if (transpose_A) {
@@ -66,12 +85,16 @@ class GEMMGenerator :
 
         A(i, j) = As(i % s, j, i / s);
 
-        Btmp(i, j) = (*B_in)(i, j);
+        // Swizzle B into packed panels of 4 columns, the width of the
+        // microkernel, so the inner loop reads both operands from dense
+        // packed buffers. The transpose, if any, is folded into the packing.
+        Btmp(i, j) = BoundaryConditions::constant_exterior(*B_in, cast<T>(0))(i, j);
         if (transpose_B) {
-            B(i, j) = Btmp(j, i);
+            Bs(i, j, jo) = Btmp(jo*4 + j, i);
         } else {
-            B(i, j) = Btmp(i, j);
+            Bs(i, j, jo) = Btmp(i, jo*4 + j);
         }
+        B(i, j) = Bs(i, j % 4, j / 4);
 
         Var k("k");
         Func prod;
@@ -94,7 +117,7 @@ class GEMMGenerator :
         // Do the part that makes it a 'general' matrix multiply.
         result_(i, j) = (a_ * ABt(i, j) + b_ * C_(i, j));
 
-        result_.tile(i, j, ti[1], tj[1], i, j, 2*s, 2*s, TailStrategy::GuardWithIf);
+        result_.tile(i, j, ti[1], tj[1], i, j, mc, mc, TailStrategy::GuardWithIf);
         if (transpose_AB) {
             result_
                 .tile(i, j, ii, ji, 4, s)
@@ -128,22 +151,21 @@ class GEMMGenerator :
         Atmp.compute_at(As, io)
             .vectorize(i).unroll(j);
 
-        if (transpose_B) {
-            B.compute_at(result_, t)
-                .tile(i, j, ii, ji, 8, 8)
-                .vectorize(ii).unroll(ji);
-            Btmp.reorder_storage(j, i)
-                .compute_at(B, i)
-                .vectorize(i)
-                .unroll(j);
-        }
+        Bs.compute_root()
+            .split(i, io, ii, s).reorder(ii, j, io, jo)
+            .unroll(j).vectorize(ii)
+            .specialize(B_.width() >= 256 && B_.height() >= 256).parallel(jo, 4);
 
+        Btmp.compute_at(Bs, io)
+            .vectorize(i).unroll(j);
 
+        RVar rvo("rvo"), rvi("rvi");
         AB.compute_at(result_, i)
             .bound_extent(j, 4).unroll(j)
             .bound_extent(i, s).vectorize(i)
             .update()
-            .reorder(i, j, rv).unroll(j).unroll(rv, 2).vectorize(i);
+            .split(rv, rvo, rvi, kc)
+            .reorder(i, j, rvi, rvo).unroll(j).unroll(rvi, 2).vectorize(i);
         if (transpose_AB) {
             ABt.compute_at(result_, i)
                 .bound_extent(i, 4).unroll(i)
@@ -0,0 +1,10 @@
+WINOGRAD_CONVOLUTION=$1
+# Columns are: schedule C W H N output_depth, input_offset, filter_offset,
+# input_depth, pad_width, pad_height, byte_zero. The filter is always 3x3 and
+# the stride is always 1.
+
+$WINOGRAD_CONVOLUTION 8 17 17 1 8 -128 -128 8 1 1 0
+$WINOGRAD_CONVOLUTION 8 17 17 1 16 -128 -128 8 1 1 0
+$WINOGRAD_CONVOLUTION 8 17 17 1 16 -128 -140 8 1 1 0
+$WINOGRAD_CONVOLUTION 8 18 18 1 8 -128 -128 8 0 0 0
+$WINOGRAD_CONVOLUTION 12 17 17 1 16 -128 -140 12 1 1 3
@@ -0,0 +1,263 @@
+// This generator implements 3x3 stride-1 convolution using the Winograd
+// F(2x2, 3x3) transform, and schedules for CPU and HVX. It is a drop-in
+// alternative to the direct Convolution generator for layers with a 3x3
+// filter and a stride of 1, and shares its quantization scheme:
+// (1) an input offset is added to the 8-bit input
+// (2) a filter offset is added to the 8-bit filter
+// (3) perform convolution
+// (4) convolution result is right-shifted and multiplied by a multiplier
+// (5) an output offset is added to the quantized convolution result
+// (6) the output is saturated and narrowed to 8-bit
+//
+// The Winograd transform computes each 2x2 tile of output from a 4x4 tile
+// of input using 16 multiplies per depth instead of 36, a 2.25x reduction.
+// The standard filter transform G contains halves, so we use 2*G instead,
+// which makes all three transforms exact in integer arithmetic. The
+// transformed products are then 4x the true convolution, which we undo
+// with a final shift before quantizing. This costs 2 bits of headroom in
+// the 32-bit accumulator relative to direct convolution.
+
+// The output dimension is a function of input dimension and padding.
+// Input dimension: {input_depth, input_width, input_height, input_batches}
+// Filter dimension: {filter_depth(=input_depth), 3, 3, filter_batches}
+// Output dimension: {filter_batches, input_width + 2 * pad_width - 2,
+// input_height + 2 * pad_height - 2, input_batches}
+
+#include "common.h"
+#include <Halide.h>
+
+using Halide::Generator;
+using Halide::Var;
+using Halide::BoundaryConditions::constant_exterior;
+using Halide::ConciseCasts::i16;
+using Halide::ConciseCasts::u16_sat;
+using Halide::ConciseCasts::u8_sat;
+
+class WinogradConvolution : public Generator<WinogradConvolution> {
+public:
+    // Unsigned 8-bit input tensor, indexed by input_depth, input_x, input_y,
+    // input_batch.
+    Input<Buffer<uint8_t>> input_{"input", 4};
+
+    // A 4D array of 8-bit filter coefficients indexed by filter_depth,
+    // filter_x, filter_y, filter_batch (aka. output_depth). The filter_x and
+    // filter_y extents must be 3.
+    Input<Buffer<uint8_t>> filter_{"filter", 4};
+
+    // A 1D array of 32-bit biases. The bias should be added to the depth
+    // dimension of the output (i.e., # filter batches).
+    Input<Buffer<int32_t>> bias_{"bias", 1};
+
+    // Offsets and multipliers for the input, filter, and output.
+    Input<int16_t> input_offset_{ "input_offset", 0, -255, 0 };
+    Input<int16_t> filter_offset_{ "filter_offset", 0, -255, 0 };
+
+    // For each x, y, batch, only the first input_depth_ elements can be
+    // non-zero. All remaining elements are assigned byte_zero_. This value
+    // should be <= input_.dim(0).extent()
+    Input<int> input_depth_{ "input_depth" };
+
+    // The stride is always 1; Winograd convolution does not subsample the
+    // input. The caller is responsible for allocating the correct output
+    // memory.
+    Input<int> pad_width_{ "pad_width" };
+    Input<int> pad_height_{ "pad_height" };
+    // byte_zero_ denotes the value padded at the input tensor boundary (in the
+    // x and y dimensions). The name byte_zero_ follows tfmini convention.
+    Input<uint8_t> byte_zero_{ "byte_zero" };
+
+    // Parameters for pointwise operations on the output.
+    Input<int> output_multiplier_{ "output_multiplier" };
+    Input<int> output_shift_{ "output_shift" };
+    Input<int> output_offset_{ "output_offset", 0, 0, 255 };
+    Input<uint8_t> output_min_{ "output_min" };
+    Input<uint8_t> output_max_{ "output_max" };
+
+    Output<Buffer<uint8_t>> output_{"output", 4};
+
+    void generate() {
+        // The algorithm.
+
+        // Some free variables. x and y represent the spatial dimensions, u and
+        // v index the 4x4 Winograd transform domain, tx and ty index 2x2
+        // output tiles, and px and py index within a tile.
+        Var x("x"), y("y"), depth("depth"), batch("batch");
+        Var u("u"), v("v"), tx("tx"), ty("ty"), px("px"), py("py");
+
+        // For the input, add the offset and upcast to 16-bit.
+        Func input_with_offset("input_with_offset");
+        input_with_offset(depth, x, y, batch) =
+            i16(input_(depth, x, y, batch)) + input_offset_;
+
+        // Add a zero boundary condition to x and y dimensions of the input.
+        Func input_with_offset_bounded =
+            constant_exterior(input_with_offset, i16(byte_zero_),
+                              { { Expr(), Expr() },
+                                { 0, input_.dim(1).extent() },
+                                { 0, input_.dim(2).extent() },
+                                { Expr(), Expr() } });
+
+        // For the filter, add the offset and upcast to 16-bit.
+        Func filter_with_offset("filter_with_offset");
+        filter_with_offset(depth, x, y, batch) =
+            i16(filter_(depth, x, y, batch)) + filter_offset_;
+
+        // Shift the input spatially in [x, y] by -[pad_width, pad_height].
+        Func shifted_input_with_offset("shifted_input_with_offset");
+        shifted_input_with_offset(depth, x, y, batch) = input_with_offset_bounded(
+            depth, x - pad_width_, y - pad_height_, batch);
+
+        // Transform the filter: U = (2G) f (2G)', where
+        // 2G = [[2, 0, 0], [1, 1, 1], [1, -1, 1], [0, 0, 2]].
+        // One pass along filter_x, one pass along filter_y. 16-bit values stay
+        // within +/- 9*510.
+        Func filter_gt("filter_gt");
+        filter_gt(depth, u, y, batch) = select(
+            u == 0, 2 * filter_with_offset(depth, 0, y, batch),
+            u == 1, filter_with_offset(depth, 0, y, batch) +
+                    filter_with_offset(depth, 1, y, batch) +
+                    filter_with_offset(depth, 2, y, batch),
+            u == 2, filter_with_offset(depth, 0, y, batch) -
+                    filter_with_offset(depth, 1, y, batch) +
+                    filter_with_offset(depth, 2, y, batch),
+            2 * filter_with_offset(depth, 2, y, batch));
+
+        Func filter_transformed("filter_transformed");
+        filter_transformed(depth, u, v, batch) = select(
+            v == 0, 2 * filter_gt(depth, u, 0, batch),
+            v == 1, filter_gt(depth, u, 0, batch) +
+                    filter_gt(depth, u, 1, batch) +
+                    filter_gt(depth, u, 2, batch),
+            v == 2, filter_gt(depth, u, 0, batch) -
+                    filter_gt(depth, u, 1, batch) +
+                    filter_gt(depth, u, 2, batch),
+            2 * filter_gt(depth, u, 2, batch));
+
+        // Transform each 4x4 input tile: V = B' d B, where
+        // B' = [[1, 0, -1, 0], [0, 1, 1, 0], [0, -1, 1, 0], [0, 1, 0, -1]].
+        // The tile at (tx, ty) covers input rows/cols [2*tx, 2*tx + 4) x
+        // [2*ty, 2*ty + 4) and produces the 2x2 output tile at (2*tx, 2*ty).
+        Func input_bt("input_bt");
+        input_bt(depth, u, tx, y, batch) = select(
+            u == 0, shifted_input_with_offset(depth, 2*tx + 0, y, batch) -
+                    shifted_input_with_offset(depth, 2*tx + 2, y, batch),
+            u == 1, shifted_input_with_offset(depth, 2*tx + 1, y, batch) +
+                    shifted_input_with_offset(depth, 2*tx + 2, y, batch),
+            u == 2, shifted_input_with_offset(depth, 2*tx + 2, y, batch) -
+                    shifted_input_with_offset(depth, 2*tx + 1, y, batch),
+            shifted_input_with_offset(depth, 2*tx + 1, y, batch) -
+            shifted_input_with_offset(depth, 2*tx + 3, y, batch));
+
+        Func input_transformed("input_transformed");
+        input_transformed(depth, u, v, tx, ty, batch) = select(
+            v == 0, input_bt(depth, u, tx, 2*ty + 0, batch) -
+                    input_bt(depth, u, tx, 2*ty + 2, batch),
+            v == 1, input_bt(depth, u, tx, 2*ty + 1, batch) +
+                    input_bt(depth, u, tx, 2*ty + 2, batch),
+            v == 2, input_bt(depth, u, tx, 2*ty + 2, batch) -
+                    input_bt(depth, u, tx, 2*ty + 1, batch),
+            input_bt(depth, u, tx, 2*ty + 1, batch) -
+            input_bt(depth, u, tx, 2*ty + 3, batch));
+
+        // Multiply pointwise in the transform domain and accumulate over the
+        // input depth in 32-bit.
+        Func product("product");
+        RDom rc(0, input_depth_);
+        product(depth, u, v, tx, ty, batch) +=
+            cast<int32_t>(filter_transformed(rc, u, v, depth)) *
+            cast<int32_t>(input_transformed(rc, u, v, tx, ty, batch));
+
+        // Transform back: m = A' M A, where A' = [[1, 1, 1, 0], [0, 1, -1, -1]].
+        Func product_at("product_at");
+        product_at(depth, px, v, tx, ty, batch) = select(
+            px == 0, product(depth, 0, v, tx, ty, batch) +
+                     product(depth, 1, v, tx, ty, batch) +
+                     product(depth, 2, v, tx, ty, batch),
+            product(depth, 1, v, tx, ty, batch) -
+            product(depth, 2, v, tx, ty, batch) -
+            product(depth, 3, v, tx, ty, batch));
+
+        Func tile_out("tile_out");
+        tile_out(depth, px, py, tx, ty, batch) = select(
+            py == 0, product_at(depth, px, 0, tx, ty, batch) +
+                     product_at(depth, px, 1, tx, ty, batch) +
+                     product_at(depth, px, 2, tx, ty, batch),
+            product_at(depth, px, 1, tx, ty, batch) -
+            product_at(depth, px, 2, tx, ty, batch) -
+            product_at(depth, px, 3, tx, ty, batch));
+
+        // Undo the 2x scale folded into each filter transform pass. The
+        // result is exactly divisible by 4.
+        Func convolved("convolved");
+        convolved(depth, x, y, batch) =
+            tile_out(depth, x % 2, y % 2, x / 2, y / 2, batch) >> 2;
+
+        Func scaled_plus_offset("scaled_plus_offset");
+        scaled_plus_offset(depth, x, y, batch) =
+            multiply_quantized_multiplier(
+                convolved(depth, x, y, batch) + bias_(depth), output_multiplier_,
+                output_shift_) +
+            output_offset_;
+
+        // Saturate and narrow the output.
+        output_(depth, x, y, batch) =
+            min(output_max_,
+                max(output_min_,
+                    u8_sat(u16_sat(scaled_plus_offset(depth, x, y, batch)))));
+
+        // Require a 3x3 filter.
+        filter_.dim(1).set_bounds(0, 3);
+        filter_.dim(2).set_bounds(0, 3);
+
+        const bool use_hexagon =
+            get_target().features_any_of({ Target::HVX_64, Target::HVX_128 });
+
+        // Specifying .hexagon() on a Func will generate an RPC to run this stage
+        // on Hexagon. If Hexagon is the host (that is, the architecture is
+        // Hexagon), we have to omit the .hexagon() directive as we are already
+        // running on Hexagon.
+        if (use_hexagon && get_target().arch != Target::Hexagon) {
+            output_.hexagon();
+        }
+
+        // Schedule for CPU and HVX.
+        int vector_size_u8 = get_target().natural_vector_size<uint8_t>();
+        if (get_target().has_feature(Target::HVX_64)) {
+            vector_size_u8 = 64;
+        } else if (get_target().has_feature(Target::HVX_128)) {
+            vector_size_u8 = 128;
+        }
+        // We only perform vectorization when the depth >= vector size.
+        Expr can_vectorize_across_depth =
+            filter_.dim(3).extent() >= vector_size_u8;
+
+        // The filter transform doesn't depend on the input, compute it once
+        // per call.
+        filter_transformed.compute_root();
+
+        // Each row of 4x4 tiles produces two rows of output. Compute the
+        // transformed input tiles and products once per pair of output rows,
+        // so each transformed tile is consumed while it is still in cache.
+        Var yo("yo"), yi("yi");
+        output_.split(y, yo, yi, 2, TailStrategy::GuardWithIf)
+            .parallel(yo)
+            .specialize(can_vectorize_across_depth)
+            .vectorize(depth, vector_size_u8);
+
+        input_transformed.compute_at(output_, yo)
+            .unroll(u).unroll(v)
+            .vectorize(depth, vector_size_u8, TailStrategy::GuardWithIf);
+
+        product.compute_at(output_, yo)
+            .unroll(u).unroll(v)
+            .specialize(can_vectorize_across_depth)
+            .vectorize(depth, vector_size_u8);
+        product.update()
+            .reorder(depth, u, v, rc, tx)
+            .unroll(u).unroll(v)
+            .specialize(can_vectorize_across_depth)
+            .vectorize(depth, vector_size_u8);
+    }
+};
+
+HALIDE_REGISTER_GENERATOR(WinogradConvolution, WinogradConvolution)
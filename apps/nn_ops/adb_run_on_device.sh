@@ -17,7 +17,7 @@ BIN=bin
 APP_TARGET=arm-64-android
 
 # Build the app.
-make bin/${APP_TARGET}/AveragePool bin/${APP_TARGET}/Convolution bin/${APP_TARGET}/DepthwiseConvolution bin/${APP_TARGET}/Im2col bin/${APP_TARGET}/MatrixMultiply bin/${APP_TARGET}/MaxPool
+make bin/${APP_TARGET}/AveragePool bin/${APP_TARGET}/Convolution bin/${APP_TARGET}/DepthwiseConvolution bin/${APP_TARGET}/Im2col bin/${APP_TARGET}/MatrixMultiply bin/${APP_TARGET}/MaxPool bin/${APP_TARGET}/WinogradConvolution
 
 # Make a folder on device for the app and our dependencies.
 adb shell mkdir -p ${DEVICE_PATH}
@@ -37,6 +37,7 @@ adb push ${BIN}/${APP_TARGET}/DepthwiseConvolution ${DEVICE_PATH}
 adb push ${BIN}/${APP_TARGET}/Im2col ${DEVICE_PATH}
 adb push ${BIN}/${APP_TARGET}/MatrixMultiply ${DEVICE_PATH}
 adb push ${BIN}/${APP_TARGET}/MaxPool ${DEVICE_PATH}
+adb push ${BIN}/${APP_TARGET}/WinogradConvolution ${DEVICE_PATH}
 
 adb shell chmod +x ${DEVICE_PATH}/AveragePool
 adb shell chmod +x ${DEVICE_PATH}/Convolution
@@ -44,6 +45,7 @@ adb shell chmod +x ${DEVICE_PATH}/DepthwiseConvolution
 adb shell chmod +x ${DEVICE_PATH}/Im2col
 adb shell chmod +x ${DEVICE_PATH}/MatrixMultiply
 adb shell chmod +x ${DEVICE_PATH}/MaxPool
+adb shell chmod +x ${DEVICE_PATH}/WinogradConvolution
 
 adb push AveragePool.sh ${DEVICE_PATH}
 adb push Convolution.sh ${DEVICE_PATH}
@@ -51,6 +53,7 @@ adb push DepthwiseConvolution.sh ${DEVICE_PATH}
 adb push Im2col.sh ${DEVICE_PATH}
 adb push MatrixMultiply.sh ${DEVICE_PATH}
 adb push MaxPool.sh ${DEVICE_PATH}
+adb push WinogradConvolution.sh ${DEVICE_PATH}
 
 adb shell ${DEVICE_ENV} ${DEVICE_PATH}/AveragePool.sh ${DEVICE_PATH}/AveragePool
 adb shell ${DEVICE_ENV} ${DEVICE_PATH}/Convolution.sh ${DEVICE_PATH}/Convolution
@@ -58,3 +61,4 @@ adb shell ${DEVICE_ENV} ${DEVICE_PATH}/DepthwiseConvolution.sh ${DEVICE_PATH}/De
 adb shell ${DEVICE_ENV} ${DEVICE_PATH}/Im2col.sh ${DEVICE_PATH}/Im2col
 adb shell ${DEVICE_ENV} ${DEVICE_PATH}/MatrixMultiply.sh ${DEVICE_PATH}/MatrixMultiply
 adb shell ${DEVICE_ENV} ${DEVICE_PATH}/MaxPool.sh ${DEVICE_PATH}/MaxPool
+adb shell ${DEVICE_ENV} ${DEVICE_PATH}/WinogradConvolution.sh ${DEVICE_PATH}/WinogradConvolution
@@ -0,0 +1,94 @@
+#include "halide_resize.h"
+
+#include "resize_box_float32_up.h"
+#include "resize_box_float32_down.h"
+#include "resize_box_uint8_up.h"
+#include "resize_box_uint8_down.h"
+#include "resize_box_uint16_up.h"
+#include "resize_box_uint16_down.h"
+#include "resize_linear_float32_up.h"
+#include "resize_linear_float32_down.h"
+#include "resize_linear_uint8_up.h"
+#include "resize_linear_uint8_down.h"
+#include "resize_linear_uint16_up.h"
+#include "resize_linear_uint16_down.h"
+#include "resize_cubic_float32_up.h"
+#include "resize_cubic_float32_down.h"
+#include "resize_cubic_uint8_up.h"
+#include "resize_cubic_uint8_down.h"
+#include "resize_cubic_uint16_up.h"
+#include "resize_cubic_uint16_down.h"
+#include "resize_lanczos_float32_up.h"
+#include "resize_lanczos_float32_down.h"
+#include "resize_lanczos_uint8_up.h"
+#include "resize_lanczos_uint8_down.h"
+#include "resize_lanczos_uint16_up.h"
+#include "resize_lanczos_uint16_down.h"
+
+namespace {
+
+typedef int (*resize_fn)(halide_buffer_t *, float, halide_buffer_t *);
+
+// Indexed by [interp][type][down/up]. Order matches
+// halide_resize_interp_t and type_index below.
+const resize_fn variants[4][3][2] = {
+    {{resize_box_float32_down, resize_box_float32_up},
+     {resize_box_uint8_down, resize_box_uint8_up},
+     {resize_box_uint16_down, resize_box_uint16_up}},
+    {{resize_linear_float32_down, resize_linear_float32_up},
+     {resize_linear_uint8_down, resize_linear_uint8_up},
+     {resize_linear_uint16_down, resize_linear_uint16_up}},
+    {{resize_cubic_float32_down, resize_cubic_float32_up},
+     {resize_cubic_uint8_down, resize_cubic_uint8_up},
+     {resize_cubic_uint16_down, resize_cubic_uint16_up}},
+    {{resize_lanczos_float32_down, resize_lanczos_float32_up},
+     {resize_lanczos_uint8_down, resize_lanczos_uint8_up},
+     {resize_lanczos_uint16_down, resize_lanczos_uint16_up}},
+};
+
+int type_index(const halide_type_t &t) {
+    if (t == halide_type_t(halide_type_float, 32)) {
+        return 0;
+    } else if (t == halide_type_t(halide_type_uint, 8)) {
+        return 1;
+    } else if (t == halide_type_t(halide_type_uint, 16)) {
+        return 2;
+    }
+    return -1;
+}
+
+}  // namespace
+
+extern "C" int halide_resize(halide_resize_interp_t interp, float scale_factor,
+                             const halide_buffer_t *input,
+                             halide_buffer_t *output) {
+    if (!input || !output ||
+        interp < halide_resize_box || interp > halide_resize_lanczos ||
+        !(scale_factor > 0.0f)) {
+        return halide_error_code_generic_error;
+    }
+    int type = type_index(input->type);
+    if (type < 0 || !(output->type == input->type)) {
+        return halide_error_code_generic_error;
+    }
+    int up = scale_factor >= 1.0f ? 1 : 0;
+    // The pipelines don't write through their input.
+    halide_buffer_t in = *input;
+    return variants[interp][type][up](&in, scale_factor, output);
+}
+
+extern "C" int halide_resize_batch(halide_resize_interp_t interp, float scale_factor,
+                                   int count,
+                                   const halide_buffer_t * const *inputs,
+                                   halide_buffer_t * const *outputs) {
+    if (count < 0 || (count > 0 && (!inputs || !outputs))) {
+        return halide_error_code_generic_error;
+    }
+    for (int i = 0; i < count; i++) {
+        int err = halide_resize(interp, scale_factor, inputs[i], outputs[i]);
+        if (err != 0) {
+            return err;
+        }
+    }
+    return 0;
+}
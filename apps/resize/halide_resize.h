@@ -0,0 +1,48 @@
+#ifndef HALIDE_RESIZE_H
+#define HALIDE_RESIZE_H
+
+// A small image-rescaling library built from the resize generator, in
+// the spirit of apps/linear_algebra's halide_blas: link against
+// libhalide_resize.a and call one entry point instead of compiling
+// your own variant per run. The interpolation method, element type
+// (float32, uint8 or uint16) and up/downsampling direction are
+// dispatched at runtime to the matching precompiled pipeline; integer
+// types use the generator's fixed-point path.
+
+#include "HalideRuntime.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum halide_resize_interp_t {
+    halide_resize_box = 0,
+    halide_resize_linear = 1,
+    halide_resize_cubic = 2,
+    halide_resize_lanczos = 3,
+} halide_resize_interp_t;
+
+/** Resample a 3-d (width, height, channels) image by 'scale_factor'.
+ * The output buffer determines the output size and must have the same
+ * element type as the input; both planar and packed (interleaved)
+ * layouts are supported. Returns 0 on success, or a halide_error_code_t.
+ */
+extern int halide_resize(halide_resize_interp_t interp, float scale_factor,
+                         const struct halide_buffer_t *input,
+                         struct halide_buffer_t *output);
+
+/** Resample a batch of images with the same scale factor and method.
+ * 'inputs' and 'outputs' are arrays of 'count' buffers. Each image is
+ * processed by an internally-parallel pipeline, so the batch is
+ * processed serially without leaving cores idle. Stops at the first
+ * failure and returns its error code. */
+extern int halide_resize_batch(halide_resize_interp_t interp, float scale_factor,
+                               int count,
+                               const struct halide_buffer_t * const *inputs,
+                               struct halide_buffer_t * const *outputs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HALIDE_RESIZE_H
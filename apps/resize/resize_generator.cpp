@@ -66,6 +66,13 @@ public:
     // resample in x and in y).
     GeneratorParam<bool> upsample{"upsample", false};
 
+    // For integer input types, resample in fixed point rather than
+    // float: the filter taps are quantized to int16 (Q14 for 8-bit
+    // input, Q12 for 16-bit) and the passes accumulate in 32 bits,
+    // which roughly doubles throughput on 8-bit data. Ignored for
+    // float input.
+    GeneratorParam<bool> fixed_point{"fixed_point", true};
+
     Input<Buffer<>> input{"input", 3};
     Input<float> scale_factor{"scale_factor"};
     Output<Buffer<>> output{"output", 3};
@@ -74,19 +81,33 @@ public:
     Var x, y, c, k;
 
     // Intermediate Funcs
-    Func as_float, clamped, resized_x, resized_y,
+    Func widened, clamped, resized_x, resized_y,
         unnormalized_kernel_x, unnormalized_kernel_y,
         kernel_x, kernel_y,
+        kernel_x_q, kernel_y_q,
         kernel_sum_x, kernel_sum_y;
 
+    // Set in generate(), used by schedule().
+    bool use_fixed_point = false;
+
     void generate() {
 
         clamped = BoundaryConditions::repeat_edge(input,
                  {{input.dim(0).min(), input.dim(0).extent()},
                   {input.dim(1).min(), input.dim(1).extent()}});
 
-        // Handle different types by just casting to float
-        as_float(x, y, c) = cast<float>(clamped(x, y, c));
+        use_fixed_point = fixed_point && !input.type().is_float();
+
+        // The intermediate type the two passes work in: float for
+        // float input, or a widened integer for the fixed-point path.
+        // 8-bit fixed-point intermediates fit in int16 (the taps are
+        // normalized, so a pass overshoots the input range by at most
+        // a small factor); 16-bit needs int32.
+        Type inter_t = Float(32);
+        if (use_fixed_point) {
+            inter_t = input.type().bits() <= 8 ? Int(16) : Int(32);
+        }
+        widened(x, y, c) = cast(inter_t, clamped(x, y, c));
 
         // For downscaling, widen the interpolation kernel to perform lowpass
         // filtering.
@@ -119,17 +140,38 @@ public:
         kernel_x(x, k) = unnormalized_kernel_x(x, k) / kernel_sum_x(x);
         kernel_y(y, k) = unnormalized_kernel_y(y, k) / kernel_sum_y(y);
 
+        // Quantized taps for the fixed-point path. Q14 leaves plenty
+        // of int32 headroom for 8-bit data; Q12 keeps the worst case
+        // of a 16-bit pass (normalized taps can overshoot by a small
+        // factor) comfortably inside int32.
+        const int kernel_bits = input.type().bits() <= 8 ? 14 : 12;
+        kernel_x_q(x, k) = cast<int16_t>(round(kernel_x(x, k) * (1 << kernel_bits)));
+        kernel_y_q(y, k) = cast<int16_t>(round(kernel_y(y, k) * (1 << kernel_bits)));
+
+        // One resampling pass: a weighted sum over the taps, with a
+        // rounding shift back to the intermediate type in fixed point.
+        auto resample = [&](Func taps, Expr value, const std::string &name) {
+            if (use_fixed_point) {
+                Expr acc = sum(cast<int32_t>(taps(taps.args()[0], r)) * value, name);
+                return cast(inter_t, (acc + (1 << (kernel_bits - 1))) >> kernel_bits);
+            } else {
+                return Expr(sum(taps(taps.args()[0], r) * value, name));
+            }
+        };
+        Func tx = use_fixed_point ? kernel_x_q : kernel_x;
+        Func ty = use_fixed_point ? kernel_y_q : kernel_y;
+
         // Perform separable resizing. The resize in x vectorizes
         // poorly compared to the resize in y, so do it first if we're
         // upsampling, and do it second if we're downsampling.
         Func resized;
         if (upsample) {
-            resized_x(x, y, c) = sum(kernel_x(x, r) * as_float(r + beginx, y, c), "resized_x");
-            resized_y(x, y, c) = sum(kernel_y(y, r) * resized_x(x, r + beginy, c), "resized_y");
+            resized_x(x, y, c) = resample(tx, widened(r + beginx, y, c), "resized_x");
+            resized_y(x, y, c) = resample(ty, resized_x(x, r + beginy, c), "resized_y");
             resized = resized_y;
         } else {
-            resized_y(x, y, c) = sum(kernel_y(y, r) * as_float(x, r + beginy, c), "resized_y");
-            resized_x(x, y, c) = sum(kernel_x(x, r) * resized_y(r + beginx, y, c), "resized_x");
+            resized_y(x, y, c) = resample(ty, widened(x, r + beginy, c), "resized_y");
+            resized_x(x, y, c) = resample(tx, resized_y(r + beginx, y, c), "resized_x");
             resized = resized_x;
         }
 
@@ -141,6 +183,19 @@ public:
     }
 
     void schedule() {
+        if (auto_schedule) {
+            input.dim(0).set_bounds_estimate(0, 1536);
+            input.dim(1).set_bounds_estimate(0, 2560);
+            input.dim(2).set_bounds_estimate(0, 3);
+            scale_factor.set_estimate(upsample ? 4.0f : 0.5f);
+            int ox = upsample ? 6144 : 768;
+            int oy = upsample ? 10240 : 1280;
+            output.estimate(x, 0, ox)
+                .estimate(y, 0, oy)
+                .estimate(c, 0, 3);
+            return;
+        }
+
         Var xi, yi;
         unnormalized_kernel_x
             .compute_at(kernel_x, x)
@@ -163,6 +218,18 @@ public:
             .compute_at(output, y)
             .reorder(k, y).vectorize(y, 8);
 
+        if (use_fixed_point) {
+            // The passes read the quantized taps; precompute them the
+            // same way as their float sources.
+            kernel_x_q
+                .compute_root()
+                .reorder(k, x)
+                .vectorize(x, 8);
+            kernel_y_q
+                .compute_at(output, y)
+                .reorder(k, y).vectorize(y, 8);
+        }
+
         if (upsample) {
             output
                 .tile(x, y, xi, yi, 16, 64)
@@ -171,7 +238,7 @@ public:
             resized_x
                 .compute_at(output, x)
                 .vectorize(x, 8);
-            as_float
+            widened
                 .compute_at(output, y)
                 .vectorize(x, 8);
         } else {
@@ -0,0 +1,132 @@
+#!/bin/bash
+# Build and benchmark a curated set of the apps, emit machine-readable
+# results, and optionally compare them against a recorded baseline.
+#
+# Normally invoked via the top-level Makefile:
+#
+#   make benchmark_apps            # run, report, compare to the baseline
+#   make benchmark_apps_baseline   # run and record a new baseline
+#
+# Environment:
+#   HALIDE_BIN_PATH, HALIDE_SRC_PATH, BIN  - as for 'make test_apps'
+#   HL_TARGET                 - target to benchmark (default: host)
+#   BENCHMARK_OUTPUT          - csv file to write results to
+#   BENCHMARK_BASELINE        - baseline csv to compare against (optional)
+#   BENCHMARK_TOLERANCE       - allowed slowdown vs the baseline, in
+#                               percent (default: 10)
+#
+# The csv rows are: app,schedule,target,time_ms
+#
+# Baselines are machine-specific: record one on the machine you intend
+# to track regressions on, and keep it with that machine's results.
+
+set -e
+
+APPS_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+IMAGES="${APPS_DIR}/images"
+HL_TARGET="${HL_TARGET:-host}"
+BIN="${BIN:-${APPS_DIR}/benchmark_bin}"
+BENCHMARK_OUTPUT="${BENCHMARK_OUTPUT:-${BIN}/benchmark_apps.csv}"
+BENCHMARK_TOLERANCE="${BENCHMARK_TOLERANCE:-10}"
+
+MAKE_VARS=(HL_TARGET="${HL_TARGET}")
+if [ -n "${HALIDE_BIN_PATH}" ]; then
+    MAKE_VARS+=(HALIDE_BIN_PATH="${HALIDE_BIN_PATH}")
+fi
+if [ -n "${HALIDE_SRC_PATH}" ]; then
+    MAKE_VARS+=(HALIDE_SRC_PATH="${HALIDE_SRC_PATH}")
+fi
+
+mkdir -p "$(dirname "${BENCHMARK_OUTPUT}")"
+echo "app,schedule,target,time_ms" > "${BENCHMARK_OUTPUT}"
+
+emit() {  # app schedule time_ms
+    echo "$1,$2,${HL_TARGET},$3" | tee -a "${BENCHMARK_OUTPUT}"
+}
+
+build() {  # app make-target
+    make -C "${APPS_DIR}/$1" "${MAKE_VARS[@]}" BIN="${BIN}/$1" "${BIN}/$1/$2" > /dev/null
+}
+
+# Pull "Manually-tuned time: 12.3ms" / "Auto-scheduled time: 45.6ms"
+# out of the output of the process binaries that use that convention.
+parse_tuned_times() {  # app output-file
+    emit "$1" manual "$(sed -n 's/^Manually-tuned time: \(.*\)ms$/\1/p' "$2")"
+    emit "$1" auto "$(sed -n 's/^Auto-scheduled time: \(.*\)ms$/\1/p' "$2")"
+}
+
+LOG="${BIN}/benchmark_apps.log"
+mkdir -p "${BIN}"
+
+echo "Benchmarking blur..."
+build blur host/test
+"${BIN}/blur/host/test" > "${LOG}"
+# "times: <slow> <fast> <halide>", in seconds.
+emit blur manual "$(awk '/^times:/ {printf "%g", $4 * 1e3}' "${LOG}")"
+
+echo "Benchmarking local_laplacian..."
+build local_laplacian process
+"${BIN}/local_laplacian/process" "${IMAGES}/rgb.png" 8 1 1 10 \
+    "${BIN}/local_laplacian/out.png" > "${LOG}"
+parse_tuned_times local_laplacian "${LOG}"
+
+echo "Benchmarking bilateral_grid..."
+build bilateral_grid filter
+"${BIN}/bilateral_grid/filter" "${IMAGES}/gray.png" \
+    "${BIN}/bilateral_grid/out.png" 0.1 10 > "${LOG}"
+parse_tuned_times bilateral_grid "${LOG}"
+
+echo "Benchmarking nl_means..."
+build nl_means process
+"${BIN}/nl_means/process" "${IMAGES}/rgb.png" 7 7 0.12 10 \
+    "${BIN}/nl_means/out.png" > "${LOG}"
+parse_tuned_times nl_means "${LOG}"
+
+echo "Benchmarking camera_pipe..."
+build camera_pipe process
+"${BIN}/camera_pipe/process" "${IMAGES}/bayer_raw.png" 3700 2.0 50 1.0 10 \
+    "${BIN}/camera_pipe/out.png" "${BIN}/camera_pipe/h_auto.png" 2> "${LOG}"
+# "Halide (manual):	1234us" / "Halide (auto):	1234us", on stderr.
+emit camera_pipe manual "$(sed -n 's/^Halide (manual):[[:space:]]*\(.*\)us$/\1/p' "${LOG}" | awk '{printf "%g", $1 / 1e3}')"
+emit camera_pipe auto "$(sed -n 's/^Halide (auto):[[:space:]]*\(.*\)us$/\1/p' "${LOG}" | awk '{printf "%g", $1 / 1e3}')"
+
+echo "Benchmarking conv_layer..."
+build conv_layer process
+"${BIN}/conv_layer/process" > "${LOG}"
+parse_tuned_times conv_layer "${LOG}"
+
+echo "Results written to ${BENCHMARK_OUTPUT}"
+
+if [ -z "${BENCHMARK_BASELINE}" ]; then
+    exit 0
+fi
+if [ ! -s "${BENCHMARK_BASELINE}" ] ||
+   [ "$(grep -cv -e '^#' -e '^app,' "${BENCHMARK_BASELINE}")" -eq 0 ]; then
+    echo "No baseline recorded in ${BENCHMARK_BASELINE};" \
+         "run 'make benchmark_apps_baseline' on this machine to create one."
+    exit 0
+fi
+
+echo "Comparing against ${BENCHMARK_BASELINE} (tolerance ${BENCHMARK_TOLERANCE}%)..."
+awk -F, -v tol="${BENCHMARK_TOLERANCE}" '
+    FNR == 1 { next }  # skip headers
+    /^#/ { next }
+    NR == FNR { base[$1 "," $2 "," $3] = $4; next }
+    {
+        key = $1 "," $2 "," $3;
+        if (!(key in base)) {
+            printf "NOTE: %s has no baseline entry\n", key;
+            next;
+        }
+        limit = base[key] * (1 + tol / 100);
+        if ($4 > limit) {
+            printf "FAIL: %s took %gms, baseline %gms (limit %gms)\n",
+                key, $4, base[key], limit;
+            failed = 1;
+        } else {
+            printf "ok:   %s took %gms, baseline %gms\n", key, $4, base[key];
+        }
+    }
+    END { exit failed }
+' "${BENCHMARK_BASELINE}" "${BENCHMARK_OUTPUT}"
+echo "All benchmarks within tolerance."
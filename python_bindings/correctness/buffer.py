@@ -103,6 +103,23 @@ def test_fill_all_equal():
     assert not buf.all_equal(3)
 
 
+def test_ndarray_as_realize_dst():
+    # An ndarray can be passed anywhere a Buffer is expected, including
+    # as a realize() destination; the pipeline writes into its memory
+    # directly (no copy).
+    x, y = hl.Var("x"), hl.Var("y")
+    f = hl.Func("f")
+    f[x, y] = hl.i32(x) + y * 2
+
+    # Use Fortran ordering so that dimension 0 is the dense one,
+    # matching the default output constraint of the pipeline.
+    a = np.zeros((4, 3), dtype=np.int32, order="F")
+    f.realize(a)
+    for xx in range(4):
+        for yy in range(3):
+            assert a[xx, yy] == xx + yy * 2
+
+
 def test_bufferinfo_sharing():
     # Torture-test to ensure that huge Python Buffer Protocol allocations are properly
     # shared (rather than copied), and also that the lifetime is held appropriately
@@ -123,5 +140,6 @@ if __name__ == "__main__":
     test_buffer_to_ndarray()
     test_for_each_element()
     test_fill_all_equal()
+    test_ndarray_as_realize_dst()
     test_bufferinfo_sharing()
 
@@ -474,6 +474,12 @@ void define_buffer(py::module &m) {
             return o.str();
         })
     ;
+
+    // Allow any buffer-protocol object (e.g. an ndarray) to be passed
+    // directly wherever a Buffer is expected (realize() destinations,
+    // input Params, etc). The memory is wrapped, not copied; the
+    // temporary Buffer is kept alive for the duration of the call.
+    py::implicitly_convertible<py::buffer, Buffer<>>();
 }
 
 }  // namespace PythonBindings
@@ -39,6 +39,7 @@ void define_enums(py::module &m) {
         .value("Stack", MemoryType::Stack)
         .value("Register", MemoryType::Register)
         .value("GPUShared", MemoryType::GPUShared)
+        .value("VTCM", MemoryType::VTCM)
     ;
 
     py::enum_<NameMangling>(m, "NameMangling")
@@ -80,7 +81,8 @@ void define_enums(py::module &m) {
         .value("ARM", Target::Arch::ARM)
         .value("MIPS", Target::Arch::MIPS)
         .value("Hexagon", Target::Arch::Hexagon)
-        .value("POWERPC", Target::Arch::POWERPC);
+        .value("POWERPC", Target::Arch::POWERPC)
+        .value("RISCV", Target::Arch::RISCV);
 
     py::enum_<Target::Feature>(m, "TargetFeature")
         .value("JIT", Target::Feature::JIT)
@@ -136,13 +138,19 @@ void define_enums(py::module &m) {
         .value("LegacyBufferWrappers", Target::Feature::LegacyBufferWrappers)
         .value("TSAN", Target::Feature::TSAN)
         .value("ASAN", Target::Feature::ASAN)
+        .value("ARMDotProd", Target::Feature::ARMDotProd)
+        .value("ARMFp16", Target::Feature::ARMFp16)
+        .value("ParallelRoots", Target::Feature::ParallelRoots)
+        .value("RVV", Target::Feature::RVV)
+        .value("SVE", Target::Feature::SVE)
         .value("FeatureEnd", Target::Feature::FeatureEnd);
 
     py::enum_<halide_type_code_t>(m, "TypeCode")
         .value("Int", Type::Int)
         .value("UInt", Type::UInt)
         .value("Float", Type::Float)
-        .value("Handle", Type::Handle);
+        .value("Handle", Type::Handle)
+        .value("BFloat", Type::BFloat);
 }
 
 }  // namespace PythonBindings
@@ -82,37 +82,64 @@ void define_func(py::module &m) {
         // for implicitly_convertible
         .def(py::init([](const ImageParam &im) -> Func { return im; }))
 
+        // The GIL is released while the pipeline runs (compiling and
+        // running hold no Python state), so Python-driven batch jobs can
+        // overlap I/O with compute. Note that an ndarray (or any other
+        // buffer-protocol object) is accepted anywhere a Buffer is, with
+        // its memory wrapped directly rather than copied.
         .def("realize", [](Func &f, Buffer<> buffer, const Target &target, const ParamMap &param_map) -> void {
-            f.realize(buffer, target);
+            py::gil_scoped_release release;
+            f.realize(buffer, target, param_map);
         }, py::arg("dst"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // This will actually allow a list-of-buffers as well as a tuple-of-buffers, but that's OK.
         .def("realize", [](Func &f, std::vector<Buffer<>> buffers, const Target &t, const ParamMap &param_map) -> void {
-            f.realize(Realization(buffers), t);
+            py::gil_scoped_release release;
+            f.realize(Realization(buffers), t, param_map);
         }, py::arg("dst"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         .def("realize", [](Func &f, std::vector<int32_t> sizes, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(f.realize(sizes, target, param_map));
+            Realization r = [&]() -> Realization {
+                py::gil_scoped_release release;
+                return f.realize(sizes, target, param_map);
+            }();
+            return realization_to_object(r);
         }, py::arg("sizes") = std::vector<int32_t>{}, py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Func &f, int x_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(f.realize(x_size, target, param_map));
+            Realization r = [&]() -> Realization {
+                py::gil_scoped_release release;
+                return f.realize(x_size, target, param_map);
+            }();
+            return realization_to_object(r);
         }, py::arg("x_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Func &f, int x_size, int y_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(f.realize(x_size, y_size, target, param_map));
+            Realization r = [&]() -> Realization {
+                py::gil_scoped_release release;
+                return f.realize(x_size, y_size, target, param_map);
+            }();
+            return realization_to_object(r);
         }, py::arg("x_size"), py::arg("y_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Func &f, int x_size, int y_size, int z_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(f.realize(x_size, y_size, z_size, target, param_map));
+            Realization r = [&]() -> Realization {
+                py::gil_scoped_release release;
+                return f.realize(x_size, y_size, z_size, target, param_map);
+            }();
+            return realization_to_object(r);
         }, py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Func &f, int x_size, int y_size, int z_size, int w_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(f.realize(x_size, y_size, z_size, w_size, target, param_map));
+            Realization r = [&]() -> Realization {
+                py::gil_scoped_release release;
+                return f.realize(x_size, y_size, z_size, w_size, target, param_map);
+            }();
+            return realization_to_object(r);
         }, py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("w_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         .def("defined", &Func::defined)
@@ -149,7 +176,11 @@ void define_func(py::module &m) {
         .def("store_at", (Func &(Func::*)(LoopLevel)) &Func::store_at,
             py::arg("loop_level"))
 
-        .def("memoize", &Func::memoize)
+        .def("memoize", (Func &(Func::*)()) &Func::memoize)
+        .def("memoize", (Func &(Func::*)(const Expr &)) &Func::memoize,
+            py::arg("eviction_key"))
+        .def("compute_if", &Func::compute_if,
+            py::arg("condition"))
         .def("compute_inline", &Func::compute_inline)
         .def("compute_root", &Func::compute_root)
         .def("store_root", &Func::store_root)
@@ -210,7 +241,8 @@ void define_func(py::module &m) {
         .def("compile_to_module", &Func::compile_to_module,
             py::arg("arguments"), py::arg("fn_name") = "", py::arg("target") = get_target_from_environment())
 
-        .def("compile_jit", &Func::compile_jit, py::arg("target") = get_jit_target_from_environment())
+        .def("compile_jit", &Func::compile_jit, py::arg("target") = get_jit_target_from_environment(),
+            py::call_guard<py::gil_scoped_release>())
 
         .def("has_update_definition", &Func::has_update_definition)
         .def("num_update_definitions", &Func::num_update_definitions)
@@ -80,41 +80,66 @@ void define_pipeline(py::module &m) {
             py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::arg("linkage") = LinkageType::ExternalPlusMetadata)
 
         .def("compile_jit", [](Pipeline &p, const Target &target) -> void {
-            (void) p.compile_jit();
+            py::gil_scoped_release release;
+            (void) p.compile_jit(target);
         }, py::arg("target") = get_jit_target_from_environment())
 
-
+        // As with Func::realize, the GIL is released while the pipeline
+        // runs, and buffer-protocol objects (e.g. ndarrays) are accepted
+        // as destinations, wrapped without copying.
         .def("realize", [](Pipeline &p, Buffer<> buffer, const Target &target, const ParamMap &param_map) -> void {
-            p.realize(Realization(buffer), target);
+            py::gil_scoped_release release;
+            p.realize(Realization(buffer), target, param_map);
         }, py::arg("dst"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // This will actually allow a list-of-buffers as well as a tuple-of-buffers, but that's OK.
         .def("realize", [](Pipeline &p, std::vector<Buffer<>> buffers, const Target &t, const ParamMap &param_map) -> void {
-            p.realize(Realization(buffers), t);
+            py::gil_scoped_release release;
+            p.realize(Realization(buffers), t, param_map);
         }, py::arg("dst"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         .def("realize", [](Pipeline &p, std::vector<int32_t> sizes, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(p.realize(sizes, target, param_map));
+            Realization r = [&]() -> Realization {
+                py::gil_scoped_release release;
+                return p.realize(sizes, target, param_map);
+            }();
+            return realization_to_object(r);
         }, py::arg("sizes") = std::vector<int32_t>{}, py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Pipeline &p, int x_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(p.realize(x_size, target, param_map));
+            Realization r = [&]() -> Realization {
+                py::gil_scoped_release release;
+                return p.realize(x_size, target, param_map);
+            }();
+            return realization_to_object(r);
         }, py::arg("x_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Pipeline &p, int x_size, int y_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(p.realize(x_size, y_size, target, param_map));
+            Realization r = [&]() -> Realization {
+                py::gil_scoped_release release;
+                return p.realize(x_size, y_size, target, param_map);
+            }();
+            return realization_to_object(r);
         }, py::arg("x_size"), py::arg("y_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Pipeline &p, int x_size, int y_size, int z_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(p.realize(x_size, y_size, z_size, target, param_map));
+            Realization r = [&]() -> Realization {
+                py::gil_scoped_release release;
+                return p.realize(x_size, y_size, z_size, target, param_map);
+            }();
+            return realization_to_object(r);
         }, py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Pipeline &p, int x_size, int y_size, int z_size, int w_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(p.realize(x_size, y_size, z_size, w_size, target, param_map));
+            Realization r = [&]() -> Realization {
+                py::gil_scoped_release release;
+                return p.realize(x_size, y_size, z_size, w_size, target, param_map);
+            }();
+            return realization_to_object(r);
         }, py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("w_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         .def("infer_input_bounds", [](Pipeline &p, int x_size, int y_size, int z_size, int w_size, const ParamMap &param_map) -> void {
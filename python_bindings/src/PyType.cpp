@@ -35,6 +35,9 @@ std::string halide_type_to_string(const Type &type) {
         case halide_type_handle:
             stream << "handle";
             break;
+        case halide_type_bfloat:
+            stream << "bfloat";
+            break;
         default:
             stream << "#unknown";
             break;
@@ -91,6 +94,7 @@ void define_type(py::module &m) {
     m.def("Int", Int, py::arg("bits"), py::arg("lanes") = 1);
     m.def("UInt", UInt, py::arg("bits"), py::arg("lanes") = 1);
     m.def("Float", Float, py::arg("bits"), py::arg("lanes") = 1);
+    m.def("BFloat", BFloat, py::arg("bits"), py::arg("lanes") = 1);
     m.def("Bool", Bool, py::arg("lanes") = 1);
     m.def("Handle", make_handle, py::arg("lanes") = 1);
 }
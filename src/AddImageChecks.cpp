@@ -95,7 +95,8 @@ Stmt add_image_checks(Stmt s,
                       const Target &t,
                       const vector<string> &order,
                       const map<string, Function> &env,
-                      const FuncValueBounds &fb) {
+                      const FuncValueBounds &fb,
+                      Stmt *bounds_query_body) {
 
     bool no_asserts = t.has_feature(Target::NoAsserts);
     bool no_bounds_query = t.has_feature(Target::NoBoundsQuery);
@@ -144,6 +145,11 @@ Stmt add_image_checks(Stmt s,
     // Inject the code that conditionally returns if we're in inference mode
     Expr maybe_return_condition = const_false();
 
+    // Whether the required bounds depend on bounds query calls to
+    // extern stages. Those only happen in the full pipeline body, so
+    // we can't build a standalone bounds query statement.
+    bool required_bounds_depend_on_extern_queries = false;
+
     // We're also going to apply the constraints to the required min
     // and extent. To do this we have to substitute all references to
     // the actual sizes of the input images in the constraints with
@@ -240,6 +246,9 @@ Stmt add_image_checks(Stmt s,
                 }
                 merge_boxes(touched, query_box);
             }
+            if (!extern_users.empty()) {
+                required_bounds_depend_on_extern_queries = true;
+            }
         }
 
         ReductionDomain rdom;
@@ -638,6 +647,27 @@ Stmt add_image_checks(Stmt s,
         s = LetStmt::make(lets_required[i-1].first, lets_required[i-1].second, s);
     }
 
+    // Also build a statement that does only the bounds query buffer
+    // rewrites, with none of the assertions, for the dedicated bounds
+    // query entry point.
+    if (bounds_query_body && !no_bounds_query &&
+        !required_bounds_depend_on_extern_queries) {
+        Stmt q = Evaluate::make(0);
+        for (size_t i = buffer_rewrites.size(); i > 0; i--) {
+            q = Block::make(buffer_rewrites[i-1], q);
+        }
+        for (size_t i = lets_proposed.size(); i > 0; i--) {
+            q = LetStmt::make(lets_proposed[i-1].first, lets_proposed[i-1].second, q);
+        }
+        for (size_t i = lets_constrained.size(); i > 0; i--) {
+            q = LetStmt::make(lets_constrained[i-1].first, lets_constrained[i-1].second, q);
+        }
+        for (size_t i = lets_required.size(); i > 0; i--) {
+            q = LetStmt::make(lets_required[i-1].first, lets_required[i-1].second, q);
+        }
+        *bounds_query_body = q;
+    }
+
     return s;
 }
 
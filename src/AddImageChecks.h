@@ -20,14 +20,18 @@ namespace Internal {
 
 /** Insert checks to make sure a statement doesn't read out of bounds
  * on inputs or outputs, and that the inputs and outputs conform to
- * the format required (e.g. stride.0 must be 1).
+ * the format required (e.g. stride.0 must be 1). If bounds_query_body
+ * is non-null, it is also set to a standalone statement that performs
+ * only the bounds query buffer rewrites, for use as a lightweight
+ * bounds query entry point.
  */
 Stmt add_image_checks(Stmt s,
                       const std::vector<Function> &outputs,
                       const Target &t,
                       const std::vector<std::string> &order,
                       const std::map<std::string, Function> &env,
-                      const FuncValueBounds &fb);
+                      const FuncValueBounds &fb,
+                      Stmt *bounds_query_body = nullptr);
 
 }  // namespace Internal
 }  // namespace Halide
@@ -28,7 +28,8 @@ public:
 
 // Insert checks to make sure that parameters are within their
 // declared range.
-Stmt add_parameter_checks(Stmt s, const Target &t) {
+Stmt add_parameter_checks(Stmt s, const Target &t,
+                          vector<pair<string, Expr>> *constrained_param_lets) {
     // First, find all the parameters
     FindParameters finder;
     s.accept(&finder);
@@ -82,6 +83,10 @@ Stmt add_parameter_checks(Stmt s, const Target &t) {
         }
     }
 
+    if (constrained_param_lets) {
+        *constrained_param_lets = lets;
+    }
+
     // Replace the params with their constrained version in the rest of the pipeline
     s = substitute(replace_with_constrained, s);
 
@@ -7,6 +7,9 @@
  * scalar parameters.
  */
 
+#include <utility>
+#include <vector>
+
 #include "IR.h"
 
 namespace Halide {
@@ -16,8 +19,13 @@ struct Target;
 namespace Internal {
 
 /** Insert checks to make sure that all referenced parameters meet
- * their constraints. */
-Stmt add_parameter_checks(Stmt s, const Target &t);
+ * their constraints. If constrained_param_lets is non-null, it is
+ * also populated with the let bindings that define the constrained
+ * versions of the parameters, so that other statements that reference
+ * them (e.g. the bounds query entry point) can be wrapped in the same
+ * bindings. */
+Stmt add_parameter_checks(Stmt s, const Target &t,
+                          std::vector<std::pair<std::string, Expr>> *constrained_param_lets = nullptr);
 
 }  // namespace Internal
 }  // namespace Halide
@@ -1,4 +1,5 @@
 #include "ApplySplit.h"
+#include "IROperator.h"
 #include "Simplify.h"
 #include "Substitute.h"
 
@@ -9,6 +10,22 @@ using std::map;
 using std::string;
 using std::vector;
 
+namespace {
+
+// Extract the even bits of t and compact them into the low half,
+// i.e. invert one axis of a bit-interleave. The odd bits are the
+// even bits of t >> 1.
+Expr morton_deinterleave(Expr t) {
+    Expr x = t & make_const(Int(32), 0x55555555);
+    x = (x | (x >> 1)) & make_const(Int(32), 0x33333333);
+    x = (x | (x >> 2)) & make_const(Int(32), 0x0f0f0f0f);
+    x = (x | (x >> 4)) & make_const(Int(32), 0x00ff00ff);
+    x = (x | (x >> 8)) & make_const(Int(32), 0x0000ffff);
+    return x;
+}
+
+}  // namespace
+
 vector<ApplySplitResult> apply_split(const Split &split, bool is_update, string prefix,
                                      map<string, Expr> &dim_extent_alignment) {
     vector<ApplySplitResult> result;
@@ -89,6 +106,39 @@ vector<ApplySplitResult> apply_split(const Split &split, bool is_update, string
         result.push_back(ApplySplitResult(old_var_name, base_var + inner, ApplySplitResult::LetStmt));
         result.push_back(ApplySplitResult(base_name, base, ApplySplitResult::LetStmt));
 
+    } else if (split.is_morton_fuse()) {
+        // Define the inner and outer in terms of the fused var by
+        // de-interleaving its bits: the inner coordinate is the even
+        // bits and the outer the odd bits, so consecutive values of
+        // the fused var trace a Z-curve over the iteration space.
+        Expr fused = Variable::make(Int(32), prefix + split.old_var);
+        Expr inner_min = Variable::make(Int(32), prefix + split.inner + ".loop_min");
+        Expr outer_min = Variable::make(Int(32), prefix + split.outer + ".loop_min");
+        Expr inner_extent = Variable::make(Int(32), prefix + split.inner + ".loop_extent");
+        Expr outer_extent = Variable::make(Int(32), prefix + split.outer + ".loop_extent");
+
+        Expr inner_bits = morton_deinterleave(fused);
+        Expr outer_bits = morton_deinterleave(fused >> 1);
+
+        // The fused loop walks the smallest power-of-two square
+        // enclosing the iteration space; skip the points outside
+        // it. The conditions are deliberately not marked likely -
+        // the rejected points are scattered through the loop, so
+        // there is no contiguous region to partition off.
+        result.push_back(ApplySplitResult(inner_bits < inner_extent));
+        result.push_back(ApplySplitResult(outer_bits < outer_extent));
+
+        // The clamps are an identity for the iterations that survive
+        // the predicates; they're there so that bounds inference
+        // sees the same bounds a plain fuse would produce.
+        Expr inner = clamp(inner_bits, 0, inner_extent - 1) + inner_min;
+        Expr outer = clamp(outer_bits, 0, outer_extent - 1) + outer_min;
+
+        result.push_back(ApplySplitResult(prefix + split.inner, inner, ApplySplitResult::Substitution));
+        result.push_back(ApplySplitResult(prefix + split.outer, outer, ApplySplitResult::Substitution));
+        result.push_back(ApplySplitResult(prefix + split.inner, inner, ApplySplitResult::LetStmt));
+        result.push_back(ApplySplitResult(prefix + split.outer, outer, ApplySplitResult::LetStmt));
+
     } else if (split.is_fuse()) {
         // Define the inner and outer in terms of the fused var
         Expr fused = Variable::make(Int(32), prefix + split.old_var);
@@ -146,6 +196,23 @@ vector<std::pair<string, Expr>> compute_loop_bounds_after_split(const Split &spl
         let_stmts.push_back({ prefix + split.outer + ".loop_min", 0 });
         let_stmts.push_back({ prefix + split.outer + ".loop_max", outer_extent-1 });
         let_stmts.push_back({ prefix + split.outer + ".loop_extent", outer_extent });
+    } else if (split.is_morton_fuse()) {
+        // The fused loop walks the smallest power-of-two square that
+        // encloses the inner x outer iteration space; round the
+        // larger of the two extents up to a power of two.
+        Expr inner_extent = Variable::make(Int(32), prefix + split.inner + ".loop_extent");
+        Expr outer_extent = Variable::make(Int(32), prefix + split.outer + ".loop_extent");
+        Expr d = max(inner_extent, outer_extent) - 1;
+        d = d | (d >> 1);
+        d = d | (d >> 2);
+        d = d | (d >> 4);
+        d = d | (d >> 8);
+        d = d | (d >> 16);
+        Expr side = d + 1;
+        Expr fused_extent = side * side;
+        let_stmts.push_back({ prefix + split.old_var + ".loop_min", 0 });
+        let_stmts.push_back({ prefix + split.old_var + ".loop_max", fused_extent - 1 });
+        let_stmts.push_back({ prefix + split.old_var + ".loop_extent", fused_extent });
     } else if (split.is_fuse()) {
         // Define bounds on the fused var using the bounds on the inner and outer
         Expr inner_extent = Variable::make(Int(32), prefix + split.inner + ".loop_extent");
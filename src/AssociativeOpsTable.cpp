@@ -169,16 +169,27 @@ void populate_ops_table_double_general_add(const vector<Type> &types, vector<Ass
 
 void populate_ops_table_double_general_mul(const vector<Type> &types, vector<AssociativePattern> &table) {
     declare_vars_double(types);
+    if (types[0] == types[1]) {
+        // Product of the first elements, scaling the second by the
+        // accumulated product (the multiplicative analogue of the
+        // {x0 + y0, x0 + y1} pattern above).
+        table.push_back({{x0 * y0, x0 * y1}, {one_0, zero_1}, true});
+    }
 }
 
 void populate_ops_table_double_general_max(const vector<Type> &types, vector<AssociativePattern> &table) {
     declare_vars_double(types);
     table.push_back({{max(x0, y0), select(y0 < x0, x1, y1)}, {tmin_0, zero_1}, true});
+    // As above, but breaking ties towards the value already in the
+    // accumulator, as argmax reductions are often written.
+    table.push_back({{max(x0, y0), select(x0 < y0, y1, x1)}, {tmin_0, zero_1}, true});
 }
 
 void populate_ops_table_double_general_min(const vector<Type> &types, vector<AssociativePattern> &table) {
     declare_vars_double(types);
     table.push_back({{min(x0, y0), select(x0 < y0, x1, y1)}, {tmax_0, zero_1}, true});
+    // Tie-breaking towards the accumulator.
+    table.push_back({{min(x0, y0), select(y0 < x0, y1, x1)}, {tmax_0, zero_1}, true});
 }
 
 void populate_ops_table_double_general_sub(const vector<Type> &types, vector<AssociativePattern> &table) {
@@ -13,6 +13,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <mutex>
 
 namespace Halide {
 namespace Internal {
@@ -315,10 +316,105 @@ vector<set<int>> compute_subgraphs(vector<set<int>> dependencies) {
     return subgraphs;
 }
 
-} // anonymous namespace
+// Rename every variable, call, and let in the op to a canonical name
+// determined by order of first occurrence, with the self-reference
+// seeded to a fixed name, so that structurally identical update
+// definitions on different Funcs produce identical exprs. Records the
+// mapping back to the original names. Sets 'ok' to false (giving up
+// on canonicalization) if a binding would shadow an existing name.
+class AlphaRename : public IRMutator2 {
+    using IRMutator2::visit;
 
+    map<string, string> &forward;
+    map<string, string> &reverse;
 
-AssociativeOp prove_associativity(const string &f, vector<Expr> args, vector<Expr> exprs) {
+    string rename(const string &name) {
+        auto it = forward.find(name);
+        if (it != forward.end()) {
+            return it->second;
+        }
+        string canon = "_ac" + std::to_string(forward.size());
+        forward.emplace(name, canon);
+        reverse.emplace(canon, name);
+        return canon;
+    }
+
+    Expr visit(const Variable *op) override {
+        return Variable::make(op->type, rename(op->name), op->image,
+                              op->param, op->reduction_domain);
+    }
+
+    Expr visit(const Call *op) override {
+        Expr e = IRMutator2::visit(op);
+        const Call *call = e.as<Call>();
+        internal_assert(call);
+        return Call::make(call->type, rename(call->name), call->args,
+                          call->call_type, call->func, call->value_index,
+                          call->image, call->param);
+    }
+
+    Expr visit(const Let *op) override {
+        if (forward.count(op->name)) {
+            ok = false;
+            return op;
+        }
+        Expr value = mutate(op->value);
+        string name = rename(op->name);
+        return Let::make(name, value, mutate(op->body));
+    }
+
+public:
+    bool ok = true;
+    AlphaRename(map<string, string> &forward, map<string, string> &reverse)
+        : forward(forward), reverse(reverse) {}
+};
+
+// Undo an AlphaRename using its reverse mapping. Names not present in
+// the mapping (e.g. the prover's x/y placeholders) are left alone.
+class RenameBack : public IRMutator2 {
+    using IRMutator2::visit;
+
+    const map<string, string> &reverse;
+
+    string rename(const string &name) const {
+        auto it = reverse.find(name);
+        return (it != reverse.end()) ? it->second : name;
+    }
+
+    Expr visit(const Variable *op) override {
+        return Variable::make(op->type, rename(op->name), op->image,
+                              op->param, op->reduction_domain);
+    }
+
+    Expr visit(const Call *op) override {
+        Expr e = IRMutator2::visit(op);
+        const Call *call = e.as<Call>();
+        internal_assert(call);
+        return Call::make(call->type, rename(call->name), call->args,
+                          call->call_type, call->func, call->value_index,
+                          call->image, call->param);
+    }
+
+    Expr visit(const Let *op) override {
+        Expr value = mutate(op->value);
+        return Let::make(rename(op->name), value, mutate(op->body));
+    }
+
+public:
+    RenameBack(const map<string, string> &reverse) : reverse(reverse) {}
+};
+
+// Proof results for canonicalized ops, keyed on the args and exprs
+// packed into a single Call node so IRDeepCompare can order them.
+// Proving associativity involves expensive solver work, and a
+// generator that rfactors many structurally similar reductions pays
+// it once per reduction without this.
+std::mutex associativity_cache_mutex;
+map<Expr, AssociativeOp, IRDeepCompare> associativity_cache;
+
+const char * const canonical_func_name = "_acf";
+
+AssociativeOp prove_associativity_impl(const string &f, vector<Expr> args, vector<Expr> exprs) {
     AssociativeOp assoc_op(exprs.size());
 
     for (Expr &arg : args) {
@@ -454,6 +550,58 @@ AssociativeOp prove_associativity(const string &f, vector<Expr> args, vector<Exp
     return assoc_op;
 }
 
+} // anonymous namespace
+
+AssociativeOp prove_associativity(const string &f, vector<Expr> args, vector<Expr> exprs) {
+    // Canonicalize the op so that cached proofs are shared between
+    // structurally identical update definitions, then map the cached
+    // result back into the caller's names.
+    map<string, string> forward, reverse;
+    forward.emplace(f, canonical_func_name);
+    reverse.emplace(canonical_func_name, f);
+    AlphaRename renamer(forward, reverse);
+
+    vector<Expr> canon_args(args.size()), canon_exprs(exprs.size());
+    for (size_t i = 0; i < args.size(); ++i) {
+        canon_args[i] = renamer.mutate(args[i]);
+    }
+    for (size_t i = 0; i < exprs.size(); ++i) {
+        canon_exprs[i] = renamer.mutate(exprs[i]);
+    }
+    if (!renamer.ok) {
+        // Shadowed bindings; don't bother caching.
+        return prove_associativity_impl(f, args, exprs);
+    }
+
+    vector<Expr> key_args = canon_args;
+    key_args.push_back((int)args.size()); // Delimit args from exprs
+    key_args.insert(key_args.end(), canon_exprs.begin(), canon_exprs.end());
+    Expr key = Call::make(Int(32), "associativity_cache_key", key_args, Call::Extern);
+
+    {
+        std::lock_guard<std::mutex> lock(associativity_cache_mutex);
+        auto it = associativity_cache.find(key);
+        if (it == associativity_cache.end()) {
+            AssociativeOp canon_op =
+                prove_associativity_impl(canonical_func_name, canon_args, canon_exprs);
+            it = associativity_cache.emplace(key, std::move(canon_op)).first;
+        }
+        AssociativeOp result = it->second;
+        RenameBack undo(reverse);
+        for (auto &x : result.xs) {
+            if (x.expr.defined()) {
+                x.expr = undo.mutate(x.expr);
+            }
+        }
+        for (auto &y : result.ys) {
+            if (y.expr.defined()) {
+                y.expr = undo.mutate(y.expr);
+            }
+        }
+        return result;
+    }
+}
+
 namespace {
 
 std::string print_args(const string &f, const vector<Expr> &args, const vector<Expr> &exprs) {
@@ -0,0 +1,356 @@
+#include "AsyncProducers.h"
+#include "Function.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+/** Does this stmt contain the production of the given func? */
+class ContainsProduce : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const ProducerConsumer *op) override {
+        if (op->is_producer && op->name == func) {
+            result = true;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+    const string &func;
+public:
+    bool result = false;
+    ContainsProduce(const string &func) : func(func) {}
+};
+
+bool contains_produce(Stmt s, const string &func) {
+    ContainsProduce c(func);
+    s.accept(&c);
+    return c.result;
+}
+
+/** Does this stmt contain a consume node of the given func? */
+class ContainsConsume : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const ProducerConsumer *op) override {
+        if (!op->is_producer && op->name == func) {
+            result = true;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+    const string &func;
+public:
+    bool result = false;
+    ContainsConsume(const string &func) : func(func) {}
+};
+
+bool contains_consume(Stmt s, const string &func) {
+    ContainsConsume c(func);
+    s.accept(&c);
+    return c.result;
+}
+
+Stmt semaphore_op(const char *name, const Expr &sem) {
+    return Evaluate::make(Call::make(Int(32), name, {sem, 1}, Call::Extern));
+}
+
+Stmt acquire(const Expr &sem) {
+    return semaphore_op("halide_semaphore_acquire", sem);
+}
+
+Stmt release(const Expr &sem) {
+    return semaphore_op("halide_semaphore_release", sem);
+}
+
+/** Split a stmt into a producer-side copy and a consumer-side copy,
+ * walking down through the loops and lets shared by both sides until
+ * the block at which the production of 'func' and its consumption
+ * become siblings. The produce subtree goes to the producer side
+ * bracketed by semaphore operations; everything after it goes to the
+ * consumer side, bracketed by the matching operations. Returns false
+ * if the stmt doesn't have a structure we know how to fork. */
+bool split_producer_consumer(Stmt s, const string &func,
+                             const Expr &full_sem, const Expr &empty_sem,
+                             Stmt *producer, Stmt *consumer) {
+    if (const LetStmt *let = s.as<LetStmt>()) {
+        // Loop bounds and the like. The values are pure at this
+        // point, so they can be evaluated on both sides.
+        if (!split_producer_consumer(let->body, func, full_sem, empty_sem,
+                                     producer, consumer)) {
+            return false;
+        }
+        *producer = LetStmt::make(let->name, let->value, *producer);
+        *consumer = LetStmt::make(let->name, let->value, *consumer);
+        return true;
+    } else if (const For *loop = s.as<For>()) {
+        if (loop->for_type != ForType::Serial) {
+            return false;
+        }
+        if (!split_producer_consumer(loop->body, func, full_sem, empty_sem,
+                                     producer, consumer)) {
+            return false;
+        }
+        *producer = For::make(loop->name, loop->min, loop->extent,
+                              loop->for_type, loop->device_api, *producer);
+        *consumer = For::make(loop->name, loop->min, loop->extent,
+                              loop->for_type, loop->device_api, *consumer);
+        return true;
+    } else if (const Block *block = s.as<Block>()) {
+        if (!contains_produce(block->first, func) ||
+            contains_produce(block->rest, func)) {
+            // The production must be entirely in the first stmt.
+            return false;
+        }
+        if (!contains_consume(block->first, func)) {
+            // This is the fork point. One acquire/release pair per
+            // arrival here, so the producer can get at most one
+            // iteration of the enclosing loop ahead.
+            *producer = Block::make({acquire(empty_sem), block->first, release(full_sem)});
+            *consumer = Block::make({acquire(full_sem), block->rest, release(empty_sem)});
+            return true;
+        } else if (!contains_consume(block->rest, func)) {
+            // Production and consumption are both inside the first
+            // stmt; the rest is unrelated trailing code, which can
+            // run on the consumer side after the consumption.
+            if (!split_producer_consumer(block->first, func, full_sem, empty_sem,
+                                         producer, consumer)) {
+                return false;
+            }
+            *consumer = Block::make(*consumer, block->rest);
+            return true;
+        }
+        return false;
+    }
+    // Anything else (nested realizations, if statements, folding
+    // checks, ...) is a structure we don't know how to fork safely.
+    return false;
+}
+
+class ForkAsyncProducers : public IRMutator2 {
+    using IRMutator2::visit;
+
+    const map<string, Function> &env;
+
+    Stmt visit(const Realize *op) override {
+        auto it = env.find(op->name);
+        if (it == env.end() || !it->second.schedule().async()) {
+            return IRMutator2::visit(op);
+        }
+
+        // Handle any nested async realizations first.
+        Stmt body = mutate(op->body);
+
+        // The producer signals the full semaphore as folds become
+        // valid, and waits on the empty semaphore before reusing
+        // them, so it runs at most one fold ahead of the consumer.
+        string empty_name = op->name + ".folding_semaphore.empty";
+        string full_name = op->name + ".folding_semaphore.full";
+        Expr empty_sem = Variable::make(Handle(), empty_name);
+        Expr full_sem = Variable::make(Handle(), full_name);
+
+        Stmt producer, consumer;
+        if (!split_producer_consumer(body, op->name, full_sem, empty_sem,
+                                     &producer, &consumer)) {
+            user_warning << "Func \"" << op->name << "\" is scheduled async(), "
+                         << "but its producer and consumer have a structure that "
+                         << "cannot be run as separate tasks. It will be computed "
+                         << "serially instead.\n";
+            return Realize::make(op->name, op->types, op->memory_type,
+                                 op->bounds, op->condition, body);
+        }
+
+        // Run the two sides as a parallel loop of extent two. The
+        // thread that encounters the fork participates as one of the
+        // two tasks, as in any other parallel loop.
+        string task_name = unique_name(op->name + ".async_task");
+        Expr task_var = Variable::make(Int(32), task_name);
+        Stmt fork_body = IfThenElse::make(task_var == 0, producer, consumer);
+        Stmt fork = For::make(task_name, 0, 2, ForType::Parallel,
+                              DeviceAPI::None, fork_body);
+
+        Stmt free_sems =
+            Block::make(Evaluate::make(Call::make(Int(32), "halide_semaphore_free",
+                                                  {empty_sem}, Call::Extern)),
+                        Evaluate::make(Call::make(Int(32), "halide_semaphore_free",
+                                                  {full_sem}, Call::Extern)));
+        Stmt s = Block::make(fork, free_sems);
+        s = LetStmt::make(full_name,
+                          Call::make(Handle(), "halide_semaphore_allocate",
+                                     {0}, Call::Extern), s);
+        s = LetStmt::make(empty_name,
+                          Call::make(Handle(), "halide_semaphore_allocate",
+                                     {1}, Call::Extern), s);
+
+        return Realize::make(op->name, op->types, op->memory_type,
+                             op->bounds, op->condition, s);
+    }
+
+public:
+    ForkAsyncProducers(const map<string, Function> &env) : env(env) {}
+};
+
+/** Collect the names of the Funcs and buffers a stmt reads and
+ * writes, for deciding whether two root-level stages may run
+ * concurrently. */
+class StageDeps : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Call *op) override {
+        IRVisitor::visit(op);
+        if (op->call_type == Call::Halide || op->call_type == Call::Image) {
+            reads.insert(op->name);
+        }
+    }
+
+    void visit(const Variable *op) override {
+        if (ends_with(op->name, ".buffer")) {
+            // Extern stages and bounds queries take entire buffers by
+            // name. Treat any such mention as a read; the stage's own
+            // output is covered by the produce node wrapping it.
+            reads.insert(op->name.substr(0, op->name.size() - 7));
+        }
+    }
+
+    void visit(const Provide *op) override {
+        IRVisitor::visit(op);
+        writes.insert(op->name);
+    }
+
+public:
+    set<string> reads, writes;
+};
+
+bool disjoint(const set<string> &a, const set<string> &b) {
+    for (const string &x : a) {
+        if (b.count(x)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Rewrite runs of consecutive root-level produce nodes that touch
+ * disjoint sets of buffers into a single parallel loop that runs one
+ * stage per iteration. Such runs arise when a Pipeline has several
+ * independent outputs: schedule_functions emits their productions
+ * back-to-back at the end of the root block, and realization order
+ * would otherwise run them strictly serially. */
+class ForkIndependentRootStages : public IRMutator2 {
+    using IRMutator2::visit;
+
+    struct RootStage {
+        Stmt stmt;
+        set<string> reads, writes;
+    };
+
+    // Only the spine of root-level blocks, realizations and
+    // producer-consumer markers is considered. Anything inside a loop
+    // already expresses whatever parallelism it has explicitly.
+    Stmt visit(const For *op) override {
+        return op;
+    }
+
+    Stmt visit(const Block *op) override {
+        // Flatten the chain of blocks.
+        vector<Stmt> stmts;
+        stmts.push_back(op->first);
+        Stmt rest = op->rest;
+        while (const Block *b = rest.as<Block>()) {
+            stmts.push_back(b->first);
+            rest = b->rest;
+        }
+        stmts.push_back(rest);
+
+        bool changed = false;
+        vector<Stmt> result;
+        vector<RootStage> batch;
+
+        auto flush_batch = [&]() {
+            if (batch.size() < 2) {
+                for (const RootStage &stage : batch) {
+                    result.push_back(stage.stmt);
+                }
+            } else {
+                // Run the stages as a parallel loop with one
+                // iteration per stage, mirroring the way async
+                // producers are forked above.
+                string task_name = unique_name("root_stage_task");
+                Expr task_var = Variable::make(Int(32), task_name);
+                Stmt body = batch.back().stmt;
+                for (size_t i = batch.size() - 1; i > 0; i--) {
+                    body = IfThenElse::make(task_var == (int)(i - 1),
+                                            batch[i - 1].stmt, body);
+                }
+                result.push_back(For::make(task_name, 0, (int)batch.size(),
+                                           ForType::Parallel, DeviceAPI::None, body));
+                changed = true;
+            }
+            batch.clear();
+        };
+
+        for (const Stmt &s : stmts) {
+            Stmt m = mutate(s);
+            changed |= !m.same_as(s);
+            const ProducerConsumer *pc = m.as<ProducerConsumer>();
+            if (pc && pc->is_producer) {
+                RootStage stage;
+                stage.stmt = m;
+                StageDeps deps;
+                m.accept(&deps);
+                stage.reads = std::move(deps.reads);
+                stage.writes = std::move(deps.writes);
+                stage.writes.insert(pc->name);
+                for (const RootStage &other : batch) {
+                    if (!disjoint(stage.reads, other.writes) ||
+                        !disjoint(stage.writes, other.reads) ||
+                        !disjoint(stage.writes, other.writes)) {
+                        flush_batch();
+                        break;
+                    }
+                }
+                batch.push_back(std::move(stage));
+            } else {
+                flush_batch();
+                result.push_back(m);
+            }
+        }
+        flush_batch();
+
+        if (!changed) {
+            return op;
+        }
+        return Block::make(result);
+    }
+};
+
+}  // namespace
+
+Stmt fork_independent_root_stages(Stmt s) {
+    return ForkIndependentRootStages().mutate(s);
+}
+
+Stmt fork_async_producers(Stmt s, const map<string, Function> &env) {
+    bool any_async = false;
+    for (const auto &p : env) {
+        any_async |= p.second.schedule().async();
+    }
+    if (!any_async) {
+        return s;
+    }
+    return ForkAsyncProducers(env).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
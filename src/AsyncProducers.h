@@ -0,0 +1,37 @@
+#ifndef HALIDE_ASYNC_PRODUCERS_H
+#define HALIDE_ASYNC_PRODUCERS_H
+
+#include <map>
+
+#include "IR.h"
+
+/** \file
+ * Defines the lowering pass that forks the producers of Funcs
+ * scheduled with Func::async() off onto their own tasks.
+ */
+
+namespace Halide {
+namespace Internal {
+
+class Function;
+
+/** For each Func scheduled as async(), split its realization into a
+ * producer side and a consumer side that run as two parallel tasks,
+ * synchronized by a pair of counting semaphores so that the producer
+ * runs at most one fold ahead of the consumer. Realizations whose
+ * structure is too complex to fork are left untouched, with a
+ * warning. */
+Stmt fork_async_producers(Stmt s, const std::map<std::string, Function> &env);
+
+/** Find runs of consecutive root-level stage productions that read
+ * and write disjoint sets of buffers (e.g. independent outputs of a
+ * multi-output Pipeline), and rewrite each run into a parallel loop
+ * that runs one stage per iteration, so independent stages execute
+ * concurrently on the thread pool. Enabled by the parallel_roots
+ * target feature. */
+Stmt fork_independent_root_stages(Stmt s);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
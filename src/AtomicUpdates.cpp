@@ -0,0 +1,96 @@
+#include "AtomicUpdates.h"
+#include "Function.h"
+#include "IREquality.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+
+namespace {
+
+class LowerAtomicUpdates : public IRMutator2 {
+    using IRMutator2::visit;
+
+    // Flattened buffer names belonging to Funcs with atomic updates.
+    const set<string> &atomic_bufs;
+
+    Stmt visit(const Store *op) override {
+        Stmt s = IRMutator2::visit(op);
+        if (!atomic_bufs.count(op->name)) {
+            return s;
+        }
+        const Store *store = s.as<Store>();
+        internal_assert(store);
+
+        // Only scalar, unpredicated additive stores that read back
+        // the location they write can become atomic adds. Anything
+        // else (e.g. the pure init of the Func) is left as a plain
+        // store; atomic() guarantees the update stages themselves are
+        // additive.
+        if (!store->value.type().is_scalar() ||
+            !is_one(store->predicate)) {
+            return s;
+        }
+        const Add *add = store->value.as<Add>();
+        if (!add) {
+            return s;
+        }
+        const Load *la = add->a.as<Load>();
+        const Load *lb = add->b.as<Load>();
+        Expr old_value, addend;
+        if (la && la->name == store->name && equal(la->index, store->index)) {
+            old_value = add->a;
+            addend = add->b;
+        } else if (lb && lb->name == store->name && equal(lb->index, store->index)) {
+            old_value = add->b;
+            addend = add->a;
+        } else {
+            return s;
+        }
+
+        // The Load carries the buffer name, index, and parameter that
+        // codegen needs to form the address of the atomic op.
+        Expr rmw = Call::make(store->value.type(), Call::atomic_add,
+                              {old_value, addend}, Call::Intrinsic);
+        return Evaluate::make(rmw);
+    }
+
+public:
+    LowerAtomicUpdates(const set<string> &bufs) : atomic_bufs(bufs) {}
+};
+
+}  // namespace
+
+Stmt lower_atomic_updates(Stmt s, const map<string, Function> &env) {
+    set<string> atomic_bufs;
+    for (const auto &p : env) {
+        bool any_atomic = false;
+        for (const Definition &def : p.second.updates()) {
+            any_atomic |= def.schedule().atomic();
+        }
+        if (!any_atomic) {
+            continue;
+        }
+        // Tuple-valued Funcs were split into one buffer per component
+        // before storage flattening.
+        if (p.second.values().size() == 1) {
+            atomic_bufs.insert(p.first);
+        } else {
+            for (size_t i = 0; i < p.second.values().size(); i++) {
+                atomic_bufs.insert(p.first + "." + std::to_string(i));
+            }
+        }
+    }
+    if (atomic_bufs.empty()) {
+        return s;
+    }
+    return LowerAtomicUpdates(atomic_bufs).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
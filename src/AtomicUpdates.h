@@ -0,0 +1,29 @@
+#ifndef HALIDE_ATOMIC_UPDATES_H
+#define HALIDE_ATOMIC_UPDATES_H
+
+#include <map>
+
+#include "IR.h"
+
+/** \file
+ * Defines the lowering pass that turns the stores of update stages
+ * scheduled with atomic() into atomic read-modify-write operations.
+ */
+
+namespace Halide {
+namespace Internal {
+
+class Function;
+
+/** For each Func with an update definition scheduled as atomic(),
+ * rewrite stores of the form f[x] = f[x] + e into calls to the
+ * atomic_add intrinsic, which codegen lowers to an atomic
+ * read-modify-write on the buffer. This makes it safe to parallelize
+ * over the RVars of such updates. Must run after storage flattening,
+ * once Provides have been lowered to Stores. */
+Stmt lower_atomic_updates(Stmt s, const std::map<std::string, Function> &env);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
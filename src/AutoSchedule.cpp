@@ -1,6 +1,13 @@
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
 #include <regex>
 
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
 #include "AutoSchedule.h"
 #include "AutoScheduleUtils.h"
 #include "ExprUsesVar.h"
@@ -8,11 +15,13 @@
 #include "Func.h"
 #include "IREquality.h"
 #include "Inline.h"
+#include "InterFuncCSE.h"
 #include "ParallelRVar.h"
 #include "RealizationOrder.h"
 #include "RegionCosts.h"
 #include "Scope.h"
 #include "Simplify.h"
+#include "ThreadPool.h"
 #include "Util.h"
 
 namespace Halide {
@@ -1197,6 +1206,15 @@ struct Partitioner {
         Function func, bool is_group_output, const Target &t, set<string> &rvars,
         map<string, Expr> &estimates, AutoSchedule &sched);
 
+    // Loop over the dimensions of function stage 'f_handle' starting from
+    // innermost and map up to 'max_dims' pure dimensions to gpu threads,
+    // staying within the thread limit of a gpu block. Returns the total
+    // number of threads mapped (one if no dimension could be mapped).
+    Expr mark_gpu_threads(Stage f_handle, int stage_num, Definition def,
+                          const set<string> &rvars,
+                          const map<string, Expr> &estimates,
+                          size_t max_dims, AutoSchedule &sched);
+
     // Reorder the dimensions to preserve spatial locality. This function
     // checks the stride of each access. The dimensions of the loop are reordered
     // such that the dimension with the smallest access stride is innermost.
@@ -2493,6 +2511,58 @@ void Partitioner::vectorize_stage(const Group &g, Stage f_handle, int stage_num,
     }
 }
 
+// A conservative limit on the number of threads in a gpu block. All the
+// gpu apis Halide targets allow at least this many.
+const int max_threads_per_block = 1024;
+
+Expr Partitioner::mark_gpu_threads(Stage f_handle, int stage_num, Definition def,
+                                   const set<string> &rvars,
+                                   const map<string, Expr> &estimates,
+                                   size_t max_dims, AutoSchedule &sched) {
+    vector<Dim> &dims = def.schedule().dims();
+    vector<VarOrRVar> thread_dims;
+    Expr num_threads = make_one(Int(64));
+
+    max_dims = std::min(max_dims, (size_t)3);
+    for (int d = 0; d < (int)dims.size() - 1 && thread_dims.size() < max_dims; d++) {
+        string dim_name = get_base_name(dims[d].var);
+        if (rvars.find(dim_name) != rvars.end()) {
+            // Mapping an rvar to gpu threads would introduce a race;
+            // stay conservative and stop at the first one.
+            break;
+        }
+        const auto &iter = estimates.find(dim_name);
+        if ((iter == estimates.end()) || !iter->second.defined()) {
+            break;
+        }
+        if (!can_prove(num_threads * iter->second <= max_threads_per_block)) {
+            break;
+        }
+        num_threads = simplify(num_threads * iter->second);
+        thread_dims.push_back(VarOrRVar(dim_name, false));
+    }
+
+    if (!thread_dims.empty()) {
+        string var_list = thread_dims[0].name();
+        set<string> var_set = {thread_dims[0].name()};
+        if (thread_dims.size() == 1) {
+            f_handle.gpu_threads(thread_dims[0]);
+        } else if (thread_dims.size() == 2) {
+            f_handle.gpu_threads(thread_dims[0], thread_dims[1]);
+        } else {
+            f_handle.gpu_threads(thread_dims[0], thread_dims[1], thread_dims[2]);
+        }
+        for (size_t i = 1; i < thread_dims.size(); i++) {
+            var_list += ", " + thread_dims[i].name();
+            var_set.insert(thread_dims[i].name());
+        }
+        sched.push_schedule(f_handle.name(), stage_num,
+                            "gpu_threads(" + var_list + ")", var_set);
+    }
+
+    return num_threads;
+}
+
 // Return true if the vars/rvars in 'ordering' are in the same order as the
 // dim list.
 inline bool operator==(const vector<Dim> &dims, const vector<VarOrRVar> &ordering) {
@@ -2760,20 +2830,66 @@ void Partitioner::generate_group_cpu_schedule(
         }
     }
 
-    vectorize_stage(g, f_handle, g.output.stage_num, def, g_out, true, t,
-                    rvars, stg_estimates, sched);
-
-    // Parallelize definition
     Expr def_par = 1;
-    // TODO: Investigate if it is better to pull one large dimension and
-    // parallelize over it or to generate nested parallelism.
-    //
-    // Go from the outer to the innermost loop until sufficient parallelism
-    // is achieved. Stop the search once we find a vectorized dimension since
-    // it doesn't make any sense to have a parallelized inner loop within a
-    // vectorized outer loop.
-    bool nested_parallelism = true;
-    if (nested_parallelism) {
+    if (t.has_gpu_feature()) {
+        // Map the tile structure onto the gpu grid: the intra-tile
+        // dimensions become threads and the inter-tile dimensions become
+        // blocks. Group members computed at the block level end up in
+        // shared memory, which is what the footprint-limited tile sizing
+        // accounts for on gpu targets.
+        Expr num_threads = mark_gpu_threads(f_handle, g.output.stage_num, def,
+                                            rvars, stg_estimates,
+                                            inner_dims.size(), sched);
+
+        vector<VarOrRVar> block_dims;
+        Expr num_blocks = make_one(Int(64));
+        for (const auto &v : outer_dims) {
+            if (v.is_rvar || block_dims.size() >= 3) {
+                // Mapping an rvar to gpu blocks would introduce a race;
+                // stay conservative and stop at the first one.
+                break;
+            }
+            const auto &iter = stg_estimates.find(v.name());
+            if ((iter == stg_estimates.end()) || !iter->second.defined()) {
+                break;
+            }
+            num_blocks = simplify(num_blocks * iter->second);
+            block_dims.push_back(v);
+        }
+
+        if (is_one(num_threads) || block_dims.empty()) {
+            user_warning << "Could not map \"" << f_handle.name()
+                         << "\" onto the gpu grid; leaving it on the host\n";
+        } else {
+            string var_list = block_dims[0].name();
+            set<string> var_set = {block_dims[0].name()};
+            if (block_dims.size() == 1) {
+                f_handle.gpu_blocks(block_dims[0]);
+            } else if (block_dims.size() == 2) {
+                f_handle.gpu_blocks(block_dims[0], block_dims[1]);
+            } else {
+                f_handle.gpu_blocks(block_dims[0], block_dims[1], block_dims[2]);
+            }
+            for (size_t i = 1; i < block_dims.size(); i++) {
+                var_list += ", " + block_dims[i].name();
+                var_set.insert(block_dims[i].name());
+            }
+            sched.push_schedule(f_handle.name(), g.output.stage_num,
+                                "gpu_blocks(" + var_list + ")", var_set);
+            def_par = simplify(num_blocks * num_threads);
+        }
+    } else {
+        vectorize_stage(g, f_handle, g.output.stage_num, def, g_out, true, t,
+                        rvars, stg_estimates, sched);
+
+        // Parallelize definition
+        // TODO: Investigate if it is better to pull one large dimension and
+        // parallelize over it or to generate nested parallelism.
+        //
+        // Go from the outer to the innermost loop until sufficient parallelism
+        // is achieved. Stop the search once we find a vectorized dimension since
+        // it doesn't make any sense to have a parallelized inner loop within a
+        // vectorized outer loop.
         int dim_start = dims.size() - 2;
         string seq_var = "";
         for (int d = dim_start; d >= 0; d--) {
@@ -2887,8 +3003,15 @@ void Partitioner::generate_group_cpu_schedule(
             }
         }
 
-        vectorize_stage(g, mem_handle, mem.stage_num, mem_def, mem.func, false,
-                        t, mem_rvars, mem_estimates, sched);
+        if (t.has_gpu_feature()) {
+            // The member stage runs inside a gpu block; let its threads
+            // cooperate on computing it into shared memory.
+            mark_gpu_threads(mem_handle, mem.stage_num, mem_def, mem_rvars,
+                             mem_estimates, 3, sched);
+        } else {
+            vectorize_stage(g, mem_handle, mem.stage_num, mem_def, mem.func, false,
+                            t, mem_rvars, mem_estimates, sched);
+        }
     }
 }
 
@@ -3325,6 +3448,14 @@ bool inline_unbounded(const vector<Function> &outputs,
 // Generate schedules for all functions in the pipeline required to compute the
 // outputs. This applies the schedules and returns a string representation of
 // the schedules. The target architecture is specified by 'target'.
+// Defined at the bottom of this file, next to MachineParams::detect().
+// Returns measured per-op-class costs for 'target' (consulting a
+// per-target cache file and microbenchmarking the host on a miss), or
+// the default constants if 'target' is not the machine we're running
+// on. If a measured memory balance is also available it is stored in
+// '*balance'; otherwise '*balance' is set to zero.
+OpCostModel calibrated_op_cost_model(const Target &target, int32_t *balance);
+
 string generate_schedules(const vector<Function> &outputs, const Target &target,
                           const MachineParams &arch_params) {
     // Make an environment map which is used throughout the auto scheduling process.
@@ -3339,6 +3470,19 @@ string generate_schedules(const vector<Function> &outputs, const Target &target,
         iter.second.lock_loop_levels();
     }
 
+    // Give each non-trivial subexpression that several Funcs compute
+    // identically its own Func, so the grouping below can choose to
+    // compute it once rather than once per consumer. The new Funcs
+    // start out inlined, so this changes nothing unless materializing
+    // one of them pays for itself.
+    debug(2) << "Extracting subexpressions shared between Funcs...\n";
+    if (extract_inter_func_cse(env) > 0) {
+        // Finalize the LoopLevels of the newly created Funcs too.
+        for (auto &iter : env) {
+            iter.second.lock_loop_levels();
+        }
+    }
+
     // Compute the topological order, before any trivial inlining (i.e. before
     // we remove any functions from 'env'). We need the full topological
     // order to pass to get_func() when generating the string representation
@@ -3417,7 +3561,9 @@ string generate_schedules(const vector<Function> &outputs, const Target &target,
     // Initialize the cost model.
     // Compute the expression costs for each function in the pipeline.
     debug(2) << "Initializing region costs...\n";
-    RegionCosts costs(env);
+    int32_t calibrated_balance = 0;
+    OpCostModel op_cost_model = calibrated_op_cost_model(target, &calibrated_balance);
+    RegionCosts costs(env, op_cost_model);
     if (debug::debug_level() >= 3) {
         costs.disp_func_costs();
     }
@@ -3452,15 +3598,53 @@ string generate_schedules(const vector<Function> &outputs, const Target &target,
         debug(2) << "Re-computing function value bounds...\n";
         func_val_bounds = compute_function_value_bounds(order, env);
         debug(2) << "Re-initializing region costs...\n";
-        RegionCosts costs(env);
+        RegionCosts costs(env, op_cost_model);
         debug(2) << "Re-initializing dependence analysis...\n";
         dep_analysis = DependenceAnalysis(env, order, func_val_bounds);
         debug(2) << "Re-computing pipeline bounds...\n";
         pipeline_bounds = get_pipeline_bounds(dep_analysis, outputs, &costs.input_estimates);
     }
 
+    // When targeting a gpu, reinterpret the machine model: grouping needs
+    // enough parallel work for the whole grid rather than a handful of
+    // cores, and tiles staged at the block level land in shared memory
+    // rather than cache, so the footprint limit should be the shared
+    // memory size. If the caller passed the generic defaults, substitute
+    // gpu-appropriate values; explicit values are taken as given.
+    MachineParams effective_params = arch_params;
+    if (target.has_gpu_feature()) {
+        MachineParams generic = MachineParams::generic();
+        if (equal(effective_params.parallelism, generic.parallelism)) {
+            effective_params.parallelism = 2048;
+        }
+        if (equal(effective_params.last_level_cache_size, generic.last_level_cache_size)) {
+            effective_params.last_level_cache_size = 48 * 1024;
+        }
+    } else {
+        // If the caller passed the generic defaults and we're
+        // compiling for the machine we're running on (e.g. JIT),
+        // use the detected parameters of this host instead, so the
+        // schedule matches the actual core count and cache size.
+        // Explicit values and cross-compiles are taken as given.
+        MachineParams generic = MachineParams::generic();
+        Target host = get_host_target();
+        if (target.arch == host.arch &&
+            target.bits == host.bits &&
+            target.os == host.os &&
+            equal(effective_params.parallelism, generic.parallelism) &&
+            equal(effective_params.last_level_cache_size, generic.last_level_cache_size) &&
+            equal(effective_params.balance, generic.balance)) {
+            effective_params = MachineParams::detect();
+            // Prefer the calibrated (cached, per-target) balance over
+            // the per-process probe when it is available.
+            if (calibrated_balance > 0) {
+                effective_params.balance = calibrated_balance;
+            }
+        }
+    }
+
     debug(2) << "Initializing partitioner...\n";
-    Partitioner part(pipeline_bounds, arch_params, outputs, dep_analysis, costs);
+    Partitioner part(pipeline_bounds, effective_params, outputs, dep_analysis, costs);
 
     // Compute and display reuse
     /* TODO: Use the reuse estimates to reorder loops
@@ -3514,7 +3698,7 @@ string generate_schedules(const vector<Function> &outputs, const Target &target,
 
     std::ostringstream oss;
     oss << "// Target: " << target.to_string() << "\n";
-    oss << "// MachineParams: " << arch_params.to_string() << "\n";
+    oss << "// MachineParams: " << effective_params.to_string() << "\n";
     oss << "\n";
     oss << sched;
     string sched_string = oss.str();
@@ -3523,7 +3707,6 @@ string generate_schedules(const vector<Function> &outputs, const Target &target,
              << "*******************************\n" << sched_string << "\n\n";
 
     // TODO: Unify both inlining and grouping for fast mem
-    // TODO: GPU scheduling
     // TODO: Hierarchical tiling
 
     return sched_string;
@@ -3535,6 +3718,115 @@ MachineParams MachineParams::generic() {
     return MachineParams(16, 16 * 1024 * 1024, 40);
 }
 
+namespace {
+
+// Returns the size in bytes of the host's last-level data cache, or
+// zero if it can't be determined.
+int64_t detect_last_level_cache_size() {
+#if defined(__linux__)
+    // There's a directory per cache. Take the largest data or unified
+    // cache visible to cpu0.
+    int64_t best = 0;
+    for (int idx = 0; idx < 16; idx++) {
+        std::string dir =
+            "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(idx);
+        std::ifstream type_file(dir + "/type");
+        std::string type;
+        if (!(type_file >> type)) {
+            break;
+        }
+        if (type == "Instruction") {
+            continue;
+        }
+        std::ifstream size_file(dir + "/size");
+        int64_t size = 0;
+        char suffix = 0;
+        if (!(size_file >> size)) {
+            continue;
+        }
+        size_file >> suffix;
+        if (suffix == 'K') {
+            size <<= 10;
+        } else if (suffix == 'M') {
+            size <<= 20;
+        }
+        best = std::max(best, size);
+    }
+    return best;
+#elif defined(__APPLE__)
+    for (const char *name : {"hw.l3cachesize", "hw.l2cachesize"}) {
+        int64_t size = 0;
+        size_t len = sizeof(size);
+        if (sysctlbyname(name, &size, &len, nullptr, 0) == 0 && size > 0) {
+            return size;
+        }
+    }
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+// Estimates the cost of a load served from beyond the last-level
+// cache relative to an arithmetic operation, by timing a streaming
+// pass over a buffer several times larger than the cache against a
+// pure-register arithmetic loop of the same trip count.
+int32_t measure_balance(int64_t llc_size) {
+    const int64_t n =
+        std::min<int64_t>(std::max<int64_t>(llc_size * 4, 1 << 24), 1 << 27) /
+        sizeof(int32_t);
+
+    std::vector<int32_t> data((size_t)n, 1);
+
+    auto t0 = std::chrono::steady_clock::now();
+    int32_t sum = 0;
+    for (int64_t i = 0; i < n; i++) {
+        sum += data[(size_t)i];
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    int32_t acc = sum | 1;
+    for (int64_t i = 0; i < n; i++) {
+        acc = acc * 3 + (int32_t)i;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    // Make sure neither loop gets optimized away.
+    static volatile int32_t sink;
+    sink = sum + acc;
+
+    double load_time = std::chrono::duration<double>(t1 - t0).count();
+    double alu_time = std::chrono::duration<double>(t2 - t1).count();
+    if (load_time <= 0 || alu_time <= 0) {
+        return 0;
+    }
+    // Clamp to a sane range; the probe is rough and can be perturbed
+    // by frequency scaling or a loaded machine.
+    int64_t balance = std::lround(load_time / alu_time);
+    return (int32_t)std::min<int64_t>(std::max<int64_t>(balance, 10), 320);
+}
+
+}  // anonymous namespace
+
+MachineParams MachineParams::detect() {
+    static MachineParams cached = []() {
+        MachineParams p = MachineParams::generic();
+        int64_t cores = (int64_t)Internal::ThreadPool<void>::num_processors_online();
+        if (cores > 0) {
+            p.parallelism = (int32_t)cores;
+        }
+        int64_t llc = detect_last_level_cache_size();
+        if (llc > 0) {
+            p.last_level_cache_size = (int32_t)std::min<int64_t>(llc, 0x7fffffff);
+        }
+        int32_t balance = measure_balance(llc);
+        if (balance > 0) {
+            p.balance = balance;
+        }
+        return p;
+    }();
+    return cached;
+}
+
 std::string MachineParams::to_string() const {
     internal_assert(parallelism.type().is_int() &&
                     last_level_cache_size.type().is_int() &&
@@ -3552,4 +3844,162 @@ MachineParams::MachineParams(const std::string &s) {
     balance = Internal::string_to_int(v[2]);
 }
 
+namespace Internal {
+
+namespace {
+
+// The calibration cache is a text file with one line per target:
+//   v1 <target-string> <balance> <mul> <div> <math>
+// By default it lives in $HOME/.halide_cost_calibration; the location
+// can be overridden (or calibration disabled by pointing it at an
+// unwritable path) with HL_COST_CALIBRATION_CACHE.
+const char * const kCalibrationVersion = "v1";
+
+std::string cost_calibration_path() {
+    std::string path = get_env_variable("HL_COST_CALIBRATION_CACHE");
+    if (!path.empty()) {
+        return path;
+    }
+    std::string home = get_env_variable("HOME");
+    if (home.empty()) {
+        return "";
+    }
+    return home + "/.halide_cost_calibration";
+}
+
+bool load_cost_calibration(const std::string &path, const std::string &target,
+                           int32_t *balance, OpCostModel *model) {
+    std::ifstream file(path);
+    std::string line;
+    bool found = false;
+    while (std::getline(file, line)) {
+        std::istringstream tokens(line);
+        std::string version, t;
+        int32_t b, mul, div, math;
+        if ((tokens >> version >> t >> b >> mul >> div >> math) &&
+            version == kCalibrationVersion && t == target &&
+            b > 0 && mul > 0 && div > 0 && math > 0) {
+            // Keep scanning: a later line for the same target (from a
+            // re-calibration) wins.
+            *balance = b;
+            model->mul = mul;
+            model->div = div;
+            model->math = math;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void save_cost_calibration(const std::string &path, const std::string &target,
+                           int32_t balance, const OpCostModel &model) {
+    std::ofstream file(path, std::ios::app);
+    if (!file.good()) {
+        debug(1) << "Could not write cost calibration cache " << path << "\n";
+        return;
+    }
+    file << kCalibrationVersion << " " << target << " " << balance << " "
+         << model.mul << " " << model.div << " " << model.math << "\n";
+}
+
+// Microbenchmark the op classes the cost model distinguishes and
+// express each as a multiple of a simple integer add. The loops all
+// carry a dependence through the accumulator so they measure latency
+// rather than how many independent ops the core can overlap, which is
+// the regime the greedy grouping's estimates are closest to.
+OpCostModel measure_op_cost_model() {
+    const int64_t n = 1 << 22;
+    static volatile int32_t sink32;
+    static volatile float sinkf;
+
+    auto t0 = std::chrono::steady_clock::now();
+    int32_t acc = 1;
+    for (int64_t i = 0; i < n; i++) {
+        acc += (int32_t)i;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    int32_t mul_acc = 3;
+    for (int64_t i = 0; i < n; i++) {
+        mul_acc *= (int32_t)i | 1;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    int32_t div_acc = 0x7fffffff;
+    for (int64_t i = 0; i < n; i++) {
+        div_acc = div_acc / ((int32_t)(i & 0xffff) | 3) + 0x7fffffff;
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    // Transcendentals are slow enough to need fewer trips.
+    const int64_t math_n = n >> 4;
+    float math_acc = 0.0f;
+    for (int64_t i = 0; i < math_n; i++) {
+        math_acc = std::exp(math_acc * 1e-10f - 1.0f);
+    }
+    auto t4 = std::chrono::steady_clock::now();
+    sink32 = acc + mul_acc + div_acc;
+    sinkf = math_acc;
+
+    double add_time = std::chrono::duration<double>(t1 - t0).count() / n;
+    if (add_time <= 0) {
+        return OpCostModel();
+    }
+    auto ratio = [=](double time, int64_t trips, int32_t min_val, int32_t max_val) {
+        int64_t r = std::lround(time / trips / add_time);
+        return (int32_t)std::min<int64_t>(std::max<int64_t>(r, min_val), max_val);
+    };
+    OpCostModel m;
+    m.mul = ratio(std::chrono::duration<double>(t2 - t1).count(), n, 1, 32);
+    m.div = ratio(std::chrono::duration<double>(t3 - t2).count(), n, 1, 128);
+    m.math = ratio(std::chrono::duration<double>(t4 - t3).count(), math_n, 1, 512);
+    return m;
+}
+
+}  // anonymous namespace
+
+OpCostModel calibrated_op_cost_model(const Target &target, int32_t *balance) {
+    *balance = 0;
+
+    // Measured constants only make sense for the machine we are
+    // running on; cross-compiles get the defaults.
+    Target host = get_host_target();
+    if (target.arch != host.arch ||
+        target.bits != host.bits ||
+        target.os != host.os) {
+        return OpCostModel();
+    }
+
+    // Calibration is a one-time cost per target: results are cached in
+    // a file so every process on the machine (and every machine in a
+    // fleet sharing a home directory per host type) reuses them.
+    struct Calibration {
+        int32_t balance;
+        OpCostModel model;
+    };
+    static std::map<std::string, Calibration> calibrated;
+    std::string key = target.to_string();
+    auto iter = calibrated.find(key);
+    if (iter == calibrated.end()) {
+        Calibration c;
+        c.balance = 0;
+        std::string path = cost_calibration_path();
+        if (path.empty() ||
+            !load_cost_calibration(path, key, &c.balance, &c.model)) {
+            debug(1) << "Calibrating auto scheduler cost constants for "
+                     << key << "...\n";
+            c.balance = measure_balance(detect_last_level_cache_size());
+            c.model = measure_op_cost_model();
+            if (!path.empty() && c.balance > 0) {
+                save_cost_calibration(path, key, c.balance, c.model);
+            }
+        }
+        debug(1) << "Auto scheduler cost constants for " << key
+                 << ": balance=" << c.balance << " mul=" << c.model.mul
+                 << " div=" << c.model.div << " math=" << c.model.math << "\n";
+        iter = calibrated.emplace(key, c).first;
+    }
+    *balance = iter->second.balance;
+    return iter->second.model;
+}
+
+}  // namespace Internal
+
 }  // namespace Halide
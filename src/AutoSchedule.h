@@ -28,6 +28,17 @@ struct MachineParams {
     /** Default machine parameters for generic CPU architecture. */
     static MachineParams generic();
 
+    /** Machine parameters measured on the host: core count from the
+     * number of processors online, last-level cache size from the OS
+     * (sysfs on Linux, sysctl on OS X), and balance from a short
+     * micro-probe that compares streaming-load and arithmetic
+     * throughput. Falls back to the generic values for anything that
+     * can't be detected. The detection runs once and is cached, but
+     * the first call may take a few milliseconds. Only meaningful
+     * when compiling for the machine Halide is running on (e.g. when
+     * JITting); for cross-compilation, pass explicit parameters. */
+    static MachineParams detect();
+
     /** Convert the MachineParams into canonical string form. */
     std::string to_string() const;
 
@@ -55,15 +55,21 @@ class BoundSmallAllocations : public IRMutator2 {
             << "Allocation " << op->name << " has a dynamic size. "
             << "Only fixed-size allocations are supported on the gpu. "
             << "Try storing into shared memory instead.";
-        // 128 bytes is a typical minimum allocation size in
-        // halide_malloc. For now we are very conservative, and only
-        // round sizes up to a constant if they're smaller than that.
-        Expr malloc_overhead = 128 / op->type.bytes();
+        // For automatic memory types, round a dynamic size up to a
+        // constant bound whenever the worst case still fits on the
+        // stack (see can_allocation_fit_on_stack). Codegen would put
+        // a constant allocation of that size on the stack anyway, so
+        // the only cost is allocating the bound instead of the
+        // runtime size, and it saves a malloc/free pair per
+        // realization - which adds up for compute_at-scanline
+        // schedules with parametric widths.
+        const int64_t stack_limit = 1024 * 16;
+        Expr stack_elements = make_const(Int(64), stack_limit / op->type.bytes());
         if (bound.defined() &&
             (in_thread_loop ||
              op->memory_type == MemoryType::Stack ||
              op->memory_type == MemoryType::Register ||
-             (op->memory_type == MemoryType::Auto && can_prove(bound <= malloc_overhead)))) {
+             (op->memory_type == MemoryType::Auto && can_prove(bound <= stack_elements)))) {
             user_assert(can_prove(bound <= Int(32).max()))
                 << "Allocation " << op->name << " has a size greater than 2^31: " << bound << "\n";
             bound = simplify(cast<int32_t>(bound));
@@ -125,6 +125,11 @@ public:
     const FuncValueBounds &func_bounds;
     set<string> in_pipeline, inner_productions;
     const Target target;
+    // Number of enclosing loops that may run iterations concurrently.
+    int parallel_depth = 0;
+    // Scratch allocations (name and size in ints) for caching extern
+    // bounds query results; wrapped around the pipeline at the end.
+    vector<pair<string, int>> bounds_query_caches;
 
     struct CondValue {
         Expr cond; // Condition on params only (can't depend on loop variable)
@@ -142,6 +147,9 @@ public:
         vector<CondValue> exprs;
         set<ReductionVariable, ReductionVariable::Compare> rvars;
         string stage_prefix;
+        // Owned by the enclosing BoundsInference; do_bounds_query
+        // registers its cache allocations here.
+        vector<pair<string, int>> *query_caches = nullptr;
 
         // Computed expressions on the left and right-hand sides.
         // Note that a function definition might have different LHS or reduction domain
@@ -346,7 +354,8 @@ public:
                            const vector<set<FusedPair>> &fused_pairs_in_groups,
                            const set<string> &in_pipeline,
                            const set<string> inner_productions,
-                           const Target &target) {
+                           const Target &target,
+                           bool can_cache_query) {
 
             // Merge all the relevant boxes.
             Box b;
@@ -421,7 +430,7 @@ public:
                 // Because we're wrapping a stmt, this happens in reverse order.
 
                 // 4)
-                s = do_bounds_query(s, in_pipeline, target);
+                s = do_bounds_query(s, in_pipeline, target, can_cache_query);
 
                 if (!in_pipeline.empty()) {
                     // 3)
@@ -451,7 +460,7 @@ public:
                     }
 
                     // 2)
-                    s = do_bounds_query(s, in_pipeline, target);
+                    s = do_bounds_query(s, in_pipeline, target, can_cache_query);
 
                     // 1)
                     s = LetStmt::make(func.name() + ".outer_bounds_query",
@@ -477,7 +486,7 @@ public:
                         s = LetStmt::make(func.name() + ".s0." + func_args[i] + ".min", new_min, s);
                     }
 
-                    s = do_bounds_query(s, in_pipeline, target);
+                    s = do_bounds_query(s, in_pipeline, target, can_cache_query);
 
                 }
 
@@ -533,6 +542,27 @@ public:
                         s = LetStmt::make(max_var, max_required, s);
                     }
                 }
+
+                // Grow the required region by any scheduled padding
+                // in a second pass, so the lets above (in particular
+                // alignment) see the padded region and round it
+                // outwards.
+                for (size_t i = 0; i < func.schedule().bounds().size(); i++) {
+                    Bound bound = func.schedule().bounds()[i];
+                    if (!bound.pad_before.defined() && !bound.pad_after.defined()) {
+                        continue;
+                    }
+                    string min_var = prefix + bound.var + ".min";
+                    string max_var = prefix + bound.var + ".max";
+                    if (bound.pad_before.defined()) {
+                        Expr min_required = Variable::make(Int(32), min_var);
+                        s = LetStmt::make(min_var, min_required - bound.pad_before, s);
+                    }
+                    if (bound.pad_after.defined()) {
+                        Expr max_required = Variable::make(Int(32), max_var);
+                        s = LetStmt::make(max_var, max_required + bound.pad_after, s);
+                    }
+                }
             }
 
             for (size_t d = 0; d < b.size(); d++) {
@@ -557,7 +587,7 @@ public:
             return s;
         }
 
-        Stmt do_bounds_query(Stmt s, const set<string> &in_pipeline, const Target &target) {
+        Stmt do_bounds_query(Stmt s, const set<string> &in_pipeline, const Target &target, bool can_cache) {
 
             const string &extern_name = func.extern_function_name();
             const vector<ExternFuncArgument> &args = func.extern_arguments();
@@ -566,6 +596,10 @@ public:
 
             vector<pair<string, Expr>> lets;
 
+            // The buffers the extern call mutates, and their
+            // dimensionality, for caching the query results.
+            vector<pair<Expr, int>> buffers_to_cache;
+
             // Iterate through all of the input args to the extern
             // function building a suitable argument list for the
             // extern function call.  We need a query buffer_t per
@@ -590,6 +624,7 @@ public:
                         lets.push_back({ name, buf });
                         bounds_inference_args.push_back(Variable::make(type_of<struct halide_buffer_t *>(), name));
                         buffers_to_annotate.push_back(bounds_inference_args.back());
+                        buffers_to_cache.push_back({bounds_inference_args.back(), input.dimensions()});
                     }
                 } else if (args[j].is_image_param() || args[j].is_buffer()) {
                     Parameter p = args[j].image_param;
@@ -616,6 +651,7 @@ public:
                     // Although we expect ImageParams to be properly initialized and sanitized by the caller,
                     // we create a copy with copy_memory (not msan-aware), so we need to annotate it as initialized.
                     buffers_to_annotate.push_back(bounds_inference_args.back());
+                    buffers_to_cache.push_back({bounds_inference_args.back(), dims});
                 } else {
                     internal_error << "Bad ExternFuncArgument type";
                 }
@@ -642,6 +678,7 @@ public:
                 // Since this is a temporary, internal-only buffer used for bounds inference,
                 // we need to mark it
                 buffers_to_annotate.push_back(bounds_inference_args.back());
+                buffers_to_cache.push_back({bounds_inference_args.back(), func.dimensions()});
                 lets.push_back({ buf_name, output_buffer_t });
             }
 
@@ -680,6 +717,76 @@ public:
                 check = Block::make(annotate, check);
             }
 
+            if (can_cache && !in_pipeline.empty()) {
+                // The result of the query is a function of the
+                // requested output box only - everything else it may
+                // depend on (scalar params, input buffer shapes)
+                // can't change during a realization. When the query
+                // re-runs per iteration of an enclosing loop we can
+                // therefore keep the last answer and skip the call
+                // whenever the box matches, which it always does for
+                // static shapes. The cache is a stack allocation at
+                // the pipeline root, so nothing persists across
+                // realizations.
+                vector<Expr> key;
+                for (const string &arg : func.args()) {
+                    string prefix = func.name() + ".s" + std::to_string(stage) + "." + arg;
+                    Expr min = Variable::make(Int(32), prefix + ".min");
+                    Expr max = Variable::make(Int(32), prefix + ".max");
+                    key.push_back(min);
+                    key.push_back(max + 1 - min);
+                }
+
+                int num_results = 0;
+                for (const auto &p : buffers_to_cache) {
+                    num_results += 2 * p.second;
+                }
+                int cache_size = 1 + (int)key.size() + num_results;
+                string cache_name = unique_name(func.name() + ".s" + std::to_string(stage) + ".bounds_query_cache");
+
+                auto cache_load = [&](int idx) {
+                    return Load::make(Int(32), cache_name, idx, Buffer<>(), Parameter(), const_true());
+                };
+                auto cache_store = [&](int idx, Expr value) {
+                    return Store::make(cache_name, value, idx, Parameter(), const_true());
+                };
+
+                // Slot 0 holds a valid flag, then the key, then the
+                // (min, extent) pairs the last call produced.
+                Expr hit = (cache_load(0) == 1);
+                for (size_t i = 0; i < key.size(); i++) {
+                    hit = hit && (cache_load(1 + (int)i) == key[i]);
+                }
+
+                // On a hit, restore the bounds the call would have
+                // written to the query buffers. On a miss, make the
+                // call and remember its answer.
+                Stmt restore, remember;
+                int idx = 1 + (int)key.size();
+                for (const auto &p : buffers_to_cache) {
+                    for (int d = 0; d < p.second; d++) {
+                        Stmt set_bounds = Evaluate::make(
+                            Call::make(type_of<struct halide_buffer_t *>(), Call::buffer_set_bounds,
+                                       {p.first, d, cache_load(idx), cache_load(idx + 1)}, Call::Extern));
+                        restore = restore.defined() ? Block::make(restore, set_bounds) : set_bounds;
+
+                        Stmt save = Block::make(
+                            cache_store(idx, Call::make(Int(32), Call::buffer_get_min, {p.first, d}, Call::Extern)),
+                            cache_store(idx + 1, Call::make(Int(32), Call::buffer_get_extent, {p.first, d}, Call::Extern)));
+                        remember = remember.defined() ? Block::make(remember, save) : save;
+                        idx += 2;
+                    }
+                }
+                for (size_t i = 0; i < key.size(); i++) {
+                    remember = Block::make(remember, cache_store(1 + (int)i, key[i]));
+                }
+                remember = Block::make(remember, cache_store(0, 1));
+
+                check = IfThenElse::make(hit, restore, Block::make(check, remember));
+                internal_assert(query_caches);
+                query_caches->push_back({cache_name, cache_size});
+            }
+
             // Now inner code is free to extract the fields from the buffer_t
             s = Block::make(check, s);
 
@@ -924,6 +1031,10 @@ public:
                 s.bounds[{ s.name, s.stage }] = output_box;
             }
         }
+
+        for (auto &s : stages) {
+            s.query_caches = &bounds_query_caches;
+        }
     }
 
     using IRMutator2::visit;
@@ -973,8 +1084,18 @@ public:
             internal_assert((int)box.size() == f.dimensions());
         }
 
-        // Recurse.
+        // Recurse. Iterations of anything other than a serial or
+        // unrolled loop may run concurrently, which stages below need
+        // to know before sharing any state across iterations.
+        bool loop_is_parallel = (op->for_type != ForType::Serial &&
+                                 op->for_type != ForType::Unrolled);
+        if (loop_is_parallel) {
+            parallel_depth++;
+        }
         body = mutate(body);
+        if (loop_is_parallel) {
+            parallel_depth--;
+        }
 
         if (!no_pipelines) {
             // We only care about the bounds of a func if:
@@ -997,7 +1118,8 @@ public:
                     }
                     body = stages[i].define_bounds(
                         body, f, stage_name, stage_index, op->name, fused_groups,
-                        fused_pairs_in_groups, in_pipeline, inner_productions, target);
+                        fused_pairs_in_groups, in_pipeline, inner_productions, target,
+                        parallel_depth == 0);
                 }
             }
 
@@ -1125,9 +1247,21 @@ Stmt bounds_inference(Stmt s,
 
     // Add an outermost bounds inference marker
     s = For::make("<outermost>", 0, 1, ForType::Serial, DeviceAPI::None, s);
-    s = BoundsInference(funcs, fused_func_groups, fused_pairs_in_groups,
-                        outputs, func_bounds, target).mutate(s);
-    return s.as<For>()->body;
+    BoundsInference inference(funcs, fused_func_groups, fused_pairs_in_groups,
+                              outputs, func_bounds, target);
+    s = inference.mutate(s);
+    s = s.as<For>()->body;
+
+    // Wrap the pipeline in the scratch allocations for any extern
+    // bounds query caches, marked invalid at the start of each
+    // realization.
+    for (const auto &cache : inference.bounds_query_caches) {
+        Stmt invalidate = Store::make(cache.first, 0, 0, Parameter(), const_true());
+        s = Block::make(invalidate, s);
+        s = Allocate::make(cache.first, Int(32), MemoryType::Stack,
+                           {cache.second}, const_true(), s);
+    }
+    return s;
 }
 
 }  // namespace Internal
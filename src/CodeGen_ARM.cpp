@@ -427,7 +427,133 @@ void CodeGen_ARM::visit(const Div *op) {
     CodeGen_Posix::visit(op);
 }
 
+bool CodeGen_ARM::try_to_match_dot_product(const Add *op) {
+#if LLVM_VERSION >= 60
+    // Collect the terms of the sum.
+    vector<Expr> terms;
+    vector<Expr> pending = {op->a, op->b};
+    while (!pending.empty()) {
+        Expr e = pending.back();
+        pending.pop_back();
+        if (const Add *add = e.as<Add>()) {
+            pending.push_back(add->a);
+            pending.push_back(add->b);
+        } else {
+            terms.push_back(e);
+        }
+    }
+
+    // Partition the terms into widening 8-bit multiplies of stride-4
+    // loads and everything else. A stride-4 load of four bytes is one
+    // quarter of a dense 16-byte load, which is the operand shape
+    // sdot/udot wants.
+    struct DotProductTerm {
+        const Load *a;
+        const Load *b;
+        const Ramp *ramp_a;
+        const Ramp *ramp_b;
+    };
+    vector<DotProductTerm> muls;
+    Expr accumulator;
+    for (const Expr &t : terms) {
+        const Mul *mul = t.as<Mul>();
+        const Cast *cast_a = mul ? mul->a.as<Cast>() : nullptr;
+        const Cast *cast_b = mul ? mul->b.as<Cast>() : nullptr;
+        const Load *load_a = cast_a ? cast_a->value.as<Load>() : nullptr;
+        const Load *load_b = cast_b ? cast_b->value.as<Load>() : nullptr;
+        const Ramp *ramp_a = load_a ? load_a->index.as<Ramp>() : nullptr;
+        const Ramp *ramp_b = load_b ? load_b->index.as<Ramp>() : nullptr;
+        if (ramp_a && ramp_b &&
+            load_a->type.bits() == 8 &&
+            load_b->type == load_a->type &&
+            (load_a->type.is_int() || load_a->type.is_uint()) &&
+            is_one(load_a->predicate) &&
+            is_one(load_b->predicate) &&
+            is_const(ramp_a->stride, 4) &&
+            is_const(ramp_b->stride, 4)) {
+            muls.push_back({load_a, load_b, ramp_a, ramp_b});
+        } else if (!accumulator.defined() && t.type() == op->type) {
+            accumulator = t;
+        } else {
+            return false;
+        }
+    }
+    if (muls.size() != 4) {
+        return false;
+    }
+
+    // All eight loads must come from just two buffers.
+    for (int i = 1; i < 4; i++) {
+        if (muls[i].a->name != muls[0].a->name ||
+            muls[i].b->name != muls[0].b->name) {
+            return false;
+        }
+    }
+
+    // The four multiplies must cover byte offsets 0..3 of a common
+    // base, pairing offset k of one buffer with offset k of the
+    // other.
+    int offsets[4];
+    for (int i = 0; i < 4; i++) {
+        Expr delta_a = simplify(muls[i].ramp_a->base - muls[0].ramp_a->base);
+        Expr delta_b = simplify(muls[i].ramp_b->base - muls[0].ramp_b->base);
+        const int64_t *da = as_const_int(delta_a);
+        const int64_t *db = as_const_int(delta_b);
+        if (!da || !db || *da != *db) {
+            return false;
+        }
+        offsets[i] = (int)(*da);
+    }
+    int min_offset = std::min(std::min(offsets[0], offsets[1]),
+                              std::min(offsets[2], offsets[3]));
+    bool seen[4] = {false, false, false, false};
+    for (int i = 0; i < 4; i++) {
+        int o = offsets[i] - min_offset;
+        if (o < 0 || o > 3 || seen[o]) {
+            return false;
+        }
+        seen[o] = true;
+    }
+
+    if (!accumulator.defined()) {
+        accumulator = make_zero(op->type);
+    }
+
+    // Emit the two dense 16-byte loads and the dot product. The order
+    // in which the four products reach each output lane doesn't
+    // matter; integer addition is associative.
+    Type narrow = muls[0].a->type.with_lanes(16);
+    Expr base_a = simplify(muls[0].ramp_a->base + min_offset);
+    Expr base_b = simplify(muls[0].ramp_b->base + min_offset);
+    Expr dense_a = Load::make(narrow, muls[0].a->name,
+                              Ramp::make(base_a, 1, 16),
+                              muls[0].a->image, muls[0].a->param,
+                              const_true(16));
+    Expr dense_b = Load::make(narrow, muls[0].b->name,
+                              Ramp::make(base_b, 1, 16),
+                              muls[0].b->image, muls[0].b->param,
+                              const_true(16));
+    const char *intrin = narrow.is_int() ?
+        "llvm.aarch64.neon.sdot.v4i32.v16i8" :
+        "llvm.aarch64.neon.udot.v4i32.v16i8";
+    value = call_intrin(op->type, 4, intrin, {accumulator, dense_a, dense_b});
+    return true;
+#else
+    return false;
+#endif
+}
+
 void CodeGen_ARM::visit(const Add *op) {
+    if (!neon_intrinsics_disabled() &&
+        target.bits == 64 &&
+        target.has_feature(Target::ARMDotProd) &&
+        op->type.is_vector() &&
+        op->type.bits() == 32 &&
+        op->type.lanes() == 4 &&
+        (op->type.is_int() || op->type.is_uint()) &&
+        try_to_match_dot_product(op)) {
+        return;
+    }
     CodeGen_Posix::visit(op);
 }
 
@@ -981,10 +1107,37 @@ string CodeGen_ARM::mattrs() const {
             return "-neon";
         }
     } else {
+        string armv8_2_attrs;
+        if (target.has_feature(Target::ARMDotProd)) {
+            armv8_2_attrs = "+dotprod";
+        }
+        if (target.has_feature(Target::ARMFp16)) {
+            // Native half-precision arithmetic (e.g. fmla.8h). Without
+            // it LLVM widens Float(16) vectors to float, halving the
+            // effective vector width.
+            if (!armv8_2_attrs.empty()) {
+                armv8_2_attrs += ",";
+            }
+            armv8_2_attrs += "+fullfp16";
+        }
+        if (target.has_feature(Target::SVE)) {
+            // This llvm has no scalable vector types, so SVE codegen
+            // is fixed-width: vectors are sized by
+            // natural_vector_size for a 256-bit implementation and
+            // legalized onto the SVE registers by the backend.
+            if (!armv8_2_attrs.empty()) {
+                armv8_2_attrs += ",";
+            }
+            armv8_2_attrs += "+sve";
+        }
         if (target.os == Target::IOS || target.os == Target::OSX) {
-            return "+reserve-x18";
+            if (armv8_2_attrs.empty()) {
+                return "+reserve-x18";
+            } else {
+                return "+reserve-x18," + armv8_2_attrs;
+            }
         } else {
-            return "";
+            return armv8_2_attrs;
         }
     }
 }
@@ -999,6 +1152,9 @@ bool CodeGen_ARM::use_soft_float_abi() const {
 }
 
 int CodeGen_ARM::native_vector_bits() const {
+    if (target.bits == 64 && target.has_feature(Target::SVE)) {
+        return 256;
+    }
     return 128;
 }
 
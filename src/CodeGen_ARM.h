@@ -63,6 +63,11 @@ protected:
     llvm::Value *call_pattern(const Pattern &p, llvm::Type *t, const std::vector<llvm::Value *> &args);
     // @}
 
+    /** Try to recognize a sum of four widening 8-bit multiplies plus
+     * an accumulator as an ARMv8.2-a sdot/udot instruction. Returns
+     * true and sets 'value' on success. */
+    bool try_to_match_dot_product(const Add *op);
+
     std::string mcpu() const;
     std::string mattrs() const;
     bool use_soft_float_abi() const;
@@ -306,6 +306,8 @@ string type_to_c_type(Type type, bool include_space, bool c_plus_plus = true) {
     bool needs_space = true;
     ostringstream oss;
 
+    user_assert(!type.is_bfloat()) << "The C backend does not support bfloat types: " << type << "\n";
+
     if (type.is_float()) {
         if (type.bits() == 32) {
             oss << "float";
@@ -818,6 +820,23 @@ private:
 
         const char *native_vector_decl = R"INLINE_CODE(
 #if __has_attribute(ext_vector_type) || __has_attribute(vector_size)
+
+// Whether we can use __builtin_convertvector for integral mask
+// narrowing (the float->int rounding concerns that keep convert_from
+// scalar don't apply to it), and whether the compiler supports the
+// element-wise ternary operator on vector types.
+#if (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9) || defined(__clang__)
+#define halide_cpp_has_convertvector 1
+#else
+#define halide_cpp_has_convertvector 0
+#endif
+#if (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 5) || \
+    (defined(__clang__) && __clang_major__ >= 10)
+#define halide_cpp_has_vector_ternary 1
+#else
+#define halide_cpp_has_vector_ternary 0
+#endif
+
 template <typename ElementType_, size_t Lanes_>
 class NativeVector {
 public:
@@ -1012,67 +1031,122 @@ public:
         return Vec(from_native_vector, a | b.native_vector);
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator<(const Vec &a, const Vec &b) {
+#if halide_cpp_has_convertvector
+        // The native comparison yields -1/0 lanes of the element
+        // width; narrowing them to the uint8 mask is integral, so
+        // the convert_from rounding concerns don't apply.
+        return Mask(Mask::from_native_vector,
+                    __builtin_convertvector(a.native_vector < b.native_vector,
+                                            typename Mask::NativeVectorType));
+#else
         Mask r;
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = a[i] < b[i] ? 0xff : 0x00;
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator<=(const Vec &a, const Vec &b) {
+#if halide_cpp_has_convertvector
+        // The native comparison yields -1/0 lanes of the element
+        // width; narrowing them to the uint8 mask is integral, so
+        // the convert_from rounding concerns don't apply.
+        return Mask(Mask::from_native_vector,
+                    __builtin_convertvector(a.native_vector <= b.native_vector,
+                                            typename Mask::NativeVectorType));
+#else
         Mask r;
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = a[i] <= b[i] ? 0xff : 0x00;
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator>(const Vec &a, const Vec &b) {
+#if halide_cpp_has_convertvector
+        // The native comparison yields -1/0 lanes of the element
+        // width; narrowing them to the uint8 mask is integral, so
+        // the convert_from rounding concerns don't apply.
+        return Mask(Mask::from_native_vector,
+                    __builtin_convertvector(a.native_vector > b.native_vector,
+                                            typename Mask::NativeVectorType));
+#else
         Mask r;
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = a[i] > b[i] ? 0xff : 0x00;
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator>=(const Vec &a, const Vec &b) {
+#if halide_cpp_has_convertvector
+        // The native comparison yields -1/0 lanes of the element
+        // width; narrowing them to the uint8 mask is integral, so
+        // the convert_from rounding concerns don't apply.
+        return Mask(Mask::from_native_vector,
+                    __builtin_convertvector(a.native_vector >= b.native_vector,
+                                            typename Mask::NativeVectorType));
+#else
         Mask r;
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = a[i] >= b[i] ? 0xff : 0x00;
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator==(const Vec &a, const Vec &b) {
+#if halide_cpp_has_convertvector
+        // The native comparison yields -1/0 lanes of the element
+        // width; narrowing them to the uint8 mask is integral, so
+        // the convert_from rounding concerns don't apply.
+        return Mask(Mask::from_native_vector,
+                    __builtin_convertvector(a.native_vector == b.native_vector,
+                                            typename Mask::NativeVectorType));
+#else
         Mask r;
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = a[i] == b[i] ? 0xff : 0x00;
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator!=(const Vec &a, const Vec &b) {
+#if halide_cpp_has_convertvector
+        // The native comparison yields -1/0 lanes of the element
+        // width; narrowing them to the uint8 mask is integral, so
+        // the convert_from rounding concerns don't apply.
+        return Mask(Mask::from_native_vector,
+                    __builtin_convertvector(a.native_vector != b.native_vector,
+                                            typename Mask::NativeVectorType));
+#else
         Mask r;
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = a[i] != b[i] ? 0xff : 0x00;
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     static Vec select(const Mask &cond, const Vec &true_value, const Vec &false_value) {
+#if halide_cpp_has_convertvector && halide_cpp_has_vector_ternary
+        // Widen the mask to the element width so the vector ternary
+        // sees a condition with matching lane size.
+        NativeVectorType cond_wide = __builtin_convertvector(cond.native_vector, NativeVectorType);
+        return Vec(from_native_vector,
+                   cond_wide != 0 ? true_value.native_vector : false_value.native_vector);
+#else
         Vec r(empty);
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = cond[i] ? true_value[i] : false_value[i];
         }
         return r;
+#endif
     }
 
     template <typename OtherVec>
@@ -1095,22 +1169,30 @@ public:
 #endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     static Vec max(const Vec &a, const Vec &b) {
+#if halide_cpp_has_vector_ternary
+        return Vec(from_native_vector,
+                   a.native_vector > b.native_vector ? a.native_vector : b.native_vector);
+#else
         Vec r(empty);
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = ::halide_cpp_max(a[i], b[i]);
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     static Vec min(const Vec &a, const Vec &b) {
+#if halide_cpp_has_vector_ternary
+        return Vec(from_native_vector,
+                   a.native_vector < b.native_vector ? a.native_vector : b.native_vector);
+#else
         Vec r(empty);
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = ::halide_cpp_min(a[i], b[i]);
         }
         return r;
+#endif
     }
 
 private:
@@ -1959,6 +2041,14 @@ void CodeGen_C::visit(const Call *op) {
         Type t = op->type.with_code(op->type.is_int() ? Type::UInt : op->type.code());
         Expr e = cast(t, select(a < b, b - a, a - b));
         rhs << print_expr(e);
+    } else if (op->is_intrinsic(Call::widening_add) ||
+               op->is_intrinsic(Call::widening_mul) ||
+               op->is_intrinsic(Call::halving_add) ||
+               op->is_intrinsic(Call::halving_sub) ||
+               op->is_intrinsic(Call::rounding_halving_add) ||
+               op->is_intrinsic(Call::saturating_add) ||
+               op->is_intrinsic(Call::saturating_sub)) {
+        rhs << print_expr(lower_widening_arithmetic(op));
     } else if (op->is_intrinsic(Call::return_second)) {
         internal_assert(op->args.size() == 2);
         string arg0 = print_expr(op->args[0]);
@@ -2436,7 +2526,7 @@ void CodeGen_C::visit(const Allocate *op) {
 
     // For sizes less than 8k, do a stack allocation
     bool on_stack = false;
-    int32_t constant_size;
+    int64_t constant_size;
     string size_id;
     if (op->new_expr.defined()) {
         Allocation alloc;
@@ -2445,20 +2535,23 @@ void CodeGen_C::visit(const Allocate *op) {
         heap_allocations.push(op->name);
         stream << op_type << "*" << op_name << " = (" << print_expr(op->new_expr) << ");\n";
     } else {
-        constant_size = op->constant_allocation_size();
+        constant_size = op->constant_allocation_size_64();
         if (constant_size > 0) {
-            int64_t stack_bytes = constant_size * op->type.bytes();
-
-            if (stack_bytes > ((int64_t(1) << 31) - 1)) {
+            if (constant_size > target.maximum_buffer_size() / op->type.bytes()) {
                 user_error << "Total size for allocation "
-                           << op->name << " is constant but exceeds 2^31 - 1.\n";
+                           << op->name << " is constant but exceeds "
+                           << (target.has_large_buffers() ? "2^63 - 1" : "2^31 - 1") << ".\n";
+            }
+            int64_t stack_bytes = constant_size * op->type.bytes();
+            if (constant_size > std::numeric_limits<int32_t>::max()) {
+                size_id = print_expr(make_const(Int(64), constant_size));
             } else {
                 size_id = print_expr(Expr(static_cast<int32_t>(constant_size)));
-                if (op->memory_type == MemoryType::Stack ||
-                    (op->memory_type == MemoryType::Auto &&
-                     can_allocation_fit_on_stack(stack_bytes))) {
-                    on_stack = true;
-                }
+            }
+            if (op->memory_type == MemoryType::Stack ||
+                (op->memory_type == MemoryType::Auto &&
+                 can_allocation_fit_on_stack(stack_bytes))) {
+                on_stack = true;
             }
         } else {
             // Check that the allocation is not scalar (if it were scalar
@@ -10,6 +10,7 @@
 #include "CodeGen_ARM.h"
 #include "CodeGen_MIPS.h"
 #include "CodeGen_PowerPC.h"
+#include "CodeGen_RISCV.h"
 #include "CodeGen_X86.h"
 
 #include "IR.h"
@@ -300,6 +300,17 @@ void CodeGen_Hexagon::compile_func(const LoweredFunc &f,
     body = unpredicate_loads_stores(body);
     debug(2) << "Lowering after unpredicating loads/stores:\n" << body << "\n\n";
 
+#if LLVM_VERSION >= 60
+    if (target.has_feature(Target::HVX_v65)) {
+        // Generate vscatter/vgather instructions before optimizing
+        // shuffles, so that indirect accesses to VTCM become gathers
+        // and scatters, and everything else can still become a vlut.
+        debug(1) << "Generating vscatter-vgather...\n";
+        body = scatter_gather_generator(body, target);
+        debug(2) << "Lowering after generating vscatter-vgather:\n" << body << "\n\n";
+    }
+#endif
+
     debug(1) << "Optimizing shuffles...\n";
     // vlut always indexes 64 bytes of the LUT at a time, even in 128 byte mode.
     const int lut_alignment = 64;
@@ -1799,6 +1810,59 @@ void CodeGen_Hexagon::visit(const Call *op) {
             Value *idx = codegen(op->args[1]);
             value = vlut(lut, idx, *min_index, *max_index);
             return;
+        } else if (op->is_intrinsic("gather")) {
+#if LLVM_VERSION >= 60
+            internal_assert(op->args.size() == 5);
+            internal_assert(op->type.bits() == 16 || op->type.bits() == 32);
+            bool is_128B = target.has_feature(Halide::Target::HVX_128);
+            const Variable *dst = op->args[0].as<Variable>();
+            const Variable *src = op->args[2].as<Variable>();
+            internal_assert(dst && src);
+            Value *dst_ptr = codegen_buffer_pointer(dst->name, op->type.element_of(), op->args[1]);
+            Value *src_base = builder->CreatePtrToInt(sym_get(src->name), i32_t);
+            Value *size = codegen(op->args[3]);
+            Value *offsets = codegen(op->args[4]);
+            Intrinsic::ID id = op->type.bits() == 16 ?
+                IPICK(is_128B, Intrinsic::hexagon_V6_vgathermh) :
+                IPICK(is_128B, Intrinsic::hexagon_V6_vgathermw);
+            llvm::Function *fn = Intrinsic::getDeclaration(module, id);
+            value = builder->CreateCall(fn,
+                {builder->CreatePointerCast(dst_ptr, fn->getFunctionType()->params()[0]),
+                 src_base, size,
+                 create_bitcast(offsets, fn->getFunctionType()->params()[3])});
+#else
+            user_error << "Hexagon vgather/vscatter requires LLVM 6.0 or later.\n";
+#endif
+            return;
+        } else if (op->is_intrinsic("scatter") || op->is_intrinsic("scatter_acc")) {
+#if LLVM_VERSION >= 60
+            internal_assert(op->args.size() == 4);
+            internal_assert(op->type.bits() == 16 || op->type.bits() == 32);
+            bool is_128B = target.has_feature(Halide::Target::HVX_128);
+            const Variable *buf = op->args[0].as<Variable>();
+            internal_assert(buf);
+            Value *base = builder->CreatePtrToInt(sym_get(buf->name), i32_t);
+            Value *size = codegen(op->args[1]);
+            Value *offsets = codegen(op->args[2]);
+            Value *val = codegen(op->args[3]);
+            bool acc = op->is_intrinsic("scatter_acc");
+            Intrinsic::ID id;
+            if (op->type.bits() == 16) {
+                id = acc ? IPICK(is_128B, Intrinsic::hexagon_V6_vscattermh_add) :
+                           IPICK(is_128B, Intrinsic::hexagon_V6_vscattermh);
+            } else {
+                id = acc ? IPICK(is_128B, Intrinsic::hexagon_V6_vscattermw_add) :
+                           IPICK(is_128B, Intrinsic::hexagon_V6_vscattermw);
+            }
+            llvm::Function *fn = Intrinsic::getDeclaration(module, id);
+            value = builder->CreateCall(fn,
+                {base, size,
+                 create_bitcast(offsets, fn->getFunctionType()->params()[2]),
+                 create_bitcast(val, fn->getFunctionType()->params()[3])});
+#else
+            user_error << "Hexagon vgather/vscatter requires LLVM 6.0 or later.\n";
+#endif
+            return;
         } else if (op->is_intrinsic(Call::select_mask)) {
             internal_assert(op->args.size() == 3);
             // eliminate_bool_vectors has replaced all boolean vectors
@@ -1836,6 +1900,21 @@ void CodeGen_Hexagon::visit(const Call *op) {
         return;
     }
 
+    if (op->is_intrinsic("scatter_release")) {
+        // Issue a store tagged scatter_release followed by a load of
+        // the same address, which stalls until all outstanding
+        // scatters to the buffer have landed.
+        internal_assert(op->args.size() == 1);
+        const Variable *buf = op->args[0].as<Variable>();
+        internal_assert(buf);
+        llvm::Function *fn = module->getFunction("halide.hexagon.scatter.release");
+        internal_assert(fn) << "Could not find halide.hexagon.scatter.release in module\n";
+        Value *ptr = builder->CreatePointerCast(sym_get(buf->name),
+                                                fn->getFunctionType()->params()[0]);
+        value = builder->CreateCall(fn, {ptr});
+        return;
+    }
+
     if (op->is_intrinsic(Call::prefetch)) {
         internal_assert((op->args.size() == 4) || (op->args.size() == 6))
             << "Hexagon only supports 1D or 2D prefetch\n";
@@ -4,6 +4,7 @@
 #include "IRMutator.h"
 #include "IROperator.h"
 #include "LLVM_Headers.h"
+#include "Simplify.h"
 
 namespace Halide {
 namespace Internal {
@@ -127,6 +128,8 @@ llvm::Type *llvm_type_of(LLVMContext *c, Halide::Type t) {
         } else if (t.is_handle()) {
             return llvm::Type::getInt8PtrTy(*c);
         } else {
+            // Ints, uints, and bfloats (which are stored as i16 and
+            // converted to float32 to compute) are all bags of bits.
             return llvm::Type::getIntNTy(*c, t.bits());
         }
     } else {
@@ -250,6 +253,38 @@ Expr lower_euclidean_div(Expr a, Expr b) {
     }
 }
 
+Expr lower_widening_arithmetic(const Call *op) {
+    internal_assert(op->args.size() == 2);
+    Expr a = op->args[0], b = op->args[1];
+    Type t = a.type();
+    // The type widened in the intermediate computation, and a signed
+    // version of it for the ops whose intermediate can go negative.
+    Type w = t.with_bits(t.bits() * 2);
+    Type ws = w.with_code(Type::Int);
+    if (op->is_intrinsic(Call::widening_add)) {
+        return cast(w, a) + cast(w, b);
+    } else if (op->is_intrinsic(Call::widening_mul)) {
+        return cast(w, a) * cast(w, b);
+    } else if (op->is_intrinsic(Call::halving_add)) {
+        return cast(t, (cast(w, a) + cast(w, b)) / 2);
+    } else if (op->is_intrinsic(Call::halving_sub)) {
+        return cast(t, (cast(w, a) - cast(w, b)) / 2);
+    } else if (op->is_intrinsic(Call::rounding_halving_add)) {
+        return cast(t, (cast(w, a) + cast(w, b) + 1) / 2);
+    } else if (op->is_intrinsic(Call::saturating_add)) {
+        Expr tmin = simplify(cast(w, t.min()));
+        Expr tmax = simplify(cast(w, t.max()));
+        return cast(t, clamp(cast(w, a) + cast(w, b), tmin, tmax));
+    } else if (op->is_intrinsic(Call::saturating_sub)) {
+        // Widen to a signed type so the difference can go negative.
+        Expr tsmin = simplify(cast(ws, t.min()));
+        Expr tsmax = simplify(cast(ws, t.max()));
+        return cast(t, clamp(cast(ws, a) - cast(ws, b), tsmin, tsmax));
+    }
+    internal_error << "Not a widening arithmetic intrinsic: " << Expr(op) << "\n";
+    return Expr();
+}
+
 Expr lower_euclidean_mod(Expr a, Expr b) {
     internal_assert(a.type() == b.type());
     // IROperator's mod_round_to_zero will replace this with a % b for
@@ -436,6 +471,16 @@ void clone_target_options(const llvm::Module &from, llvm::Module &to) {
     }
 }
 
+int llvm_opt_level() {
+    std::string level = get_env_variable("HL_LLVM_OPT_LEVEL");
+    if (level.empty()) {
+        return 3;
+    }
+    user_assert(level.size() == 1 && level[0] >= '0' && level[0] <= '3')
+        << "HL_LLVM_OPT_LEVEL must be 0, 1, 2, or 3; saw \"" << level << "\"\n";
+    return level[0] - '0';
+}
+
 std::unique_ptr<llvm::TargetMachine> make_target_machine(const llvm::Module &module) {
     std::string error_string;
 
@@ -455,6 +500,12 @@ std::unique_ptr<llvm::TargetMachine> make_target_machine(const llvm::Module &mod
     std::string mattrs = "";
     get_target_options(module, options, mcpu, mattrs);
 
+    const int opt_level = llvm_opt_level();
+    const llvm::CodeGenOpt::Level codegen_opt_levels[4] =
+        {llvm::CodeGenOpt::None, llvm::CodeGenOpt::Less,
+         llvm::CodeGenOpt::Default, llvm::CodeGenOpt::Aggressive};
+    options.EnableFastISel = (opt_level < 2);
+
     return std::unique_ptr<llvm::TargetMachine>(llvm_target->createTargetMachine(module.getTargetTriple(),
                                                 mcpu, mattrs,
                                                 options,
@@ -464,7 +515,7 @@ std::unique_ptr<llvm::TargetMachine> make_target_machine(const llvm::Module &mod
 #else
                                                 llvm::CodeModel::Small,
 #endif
-                                                llvm::CodeGenOpt::Aggressive));
+                                                codegen_opt_levels[opt_level]));
 }
 
 void set_function_attributes_for_target(llvm::Function *fn, Target t) {
@@ -75,6 +75,12 @@ Expr lower_euclidean_div(Expr a, Expr b);
 Expr lower_euclidean_mod(Expr a, Expr b);
 ///@}
 
+/** Expand one of the widening/halving/saturating arithmetic intrinsics
+ * (Call::widening_add et al) into the canonical arithmetic the backend
+ * peephole matchers recognize (e.g. the ARM averaging and saturating
+ * instruction patterns). The result is deliberately not simplified. */
+Expr lower_widening_arithmetic(const Call *op);
+
 /** Replace predicated loads/stores with unpredicated equivalents
  * inside branches. */
 Stmt unpredicate_loads_stores(Stmt s);
@@ -85,6 +91,13 @@ void get_target_options(const llvm::Module &module, llvm::TargetOptions &options
 /** Given two llvm::Modules, clone target options from one to the other */
 void clone_target_options(const llvm::Module &from, llvm::Module &to);
 
+/** The LLVM optimization level to compile with, 0 through 3 (default
+ * 3). Controlled by HL_LLVM_OPT_LEVEL, and re-read on every compile so
+ * that e.g. an autotuner can screen schedule candidates with cheap
+ * compiles and re-compile the finalists at full optimization. Levels
+ * below 2 also select LLVM's fast instruction selection. */
+int llvm_opt_level();
+
 /** Given an llvm::Module, get or create an llvm:TargetMachine */
 std::unique_ptr<llvm::TargetMachine> make_target_machine(const llvm::Module &module);
 
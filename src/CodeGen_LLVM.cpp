@@ -12,6 +12,7 @@
 #include "CodeGen_LLVM.h"
 #include "CodeGen_MIPS.h"
 #include "CodeGen_PowerPC.h"
+#include "CodeGen_RISCV.h"
 #include "CodeGen_X86.h"
 #include "Debug.h"
 #include "Deinterleave.h"
@@ -131,6 +132,12 @@ using std::vector;
 #define InitializeHexagonAsmPrinter()   InitializeAsmPrinter(Hexagon)
 #endif
 
+#ifdef WITH_RISCV
+#define InitializeRISCVTarget()       InitializeTarget(RISCV)
+#define InitializeRISCVAsmParser()    InitializeAsmParser(RISCV)
+#define InitializeRISCVAsmPrinter()   InitializeAsmPrinter(RISCV)
+#endif
+
 namespace {
 
 // Get the LLVM linkage corresponding to a Halide linkage type.
@@ -302,6 +309,11 @@ CodeGen_LLVM *CodeGen_LLVM::new_for_target(const Target &target,
             return make_codegen<CodeGen_GPU_Host<CodeGen_MIPS>>(target, context);
         }
 #endif
+#ifdef WITH_RISCV
+        if (target.arch == Target::RISCV) {
+            return make_codegen<CodeGen_GPU_Host<CodeGen_RISCV>>(target, context);
+        }
+#endif
 #ifdef WITH_POWERPC
         if (target.arch == Target::POWERPC) {
             return make_codegen<CodeGen_GPU_Host<CodeGen_PowerPC>>(target, context);
@@ -320,6 +332,8 @@ CodeGen_LLVM *CodeGen_LLVM::new_for_target(const Target &target,
         return make_codegen<CodeGen_MIPS>(target, context);
     } else if (target.arch == Target::POWERPC) {
         return make_codegen<CodeGen_PowerPC>(target, context);
+    } else if (target.arch == Target::RISCV) {
+        return make_codegen<CodeGen_RISCV>(target, context);
     } else if (target.arch == Target::Hexagon) {
         return make_codegen<CodeGen_Hexagon>(target, context);
     }
@@ -456,6 +470,7 @@ bool CodeGen_LLVM::llvm_NVPTX_enabled = false;
 bool CodeGen_LLVM::llvm_Mips_enabled = false;
 bool CodeGen_LLVM::llvm_PowerPC_enabled = false;
 bool CodeGen_LLVM::llvm_AMDGPU_enabled = false;
+bool CodeGen_LLVM::llvm_RISCV_enabled = false;
 
 namespace {
 
@@ -1056,14 +1071,14 @@ void CodeGen_LLVM::optimize_module() {
     function_pass_manager.add(createTargetTransformInfoWrapperPass(TM ? TM->getTargetIRAnalysis() : TargetIRAnalysis()));
 
     PassManagerBuilder b;
-    b.OptLevel = 3;
+    b.OptLevel = llvm_opt_level();
 #if LLVM_VERSION >= 50
     b.Inliner = createFunctionInliningPass(b.OptLevel, 0, false);
 #else
     b.Inliner = createFunctionInliningPass(b.OptLevel, 0);
 #endif
-    b.LoopVectorize = true;
-    b.SLPVectorize = true;
+    b.LoopVectorize = (b.OptLevel >= 2);
+    b.SLPVectorize = (b.OptLevel >= 2);
 
 #if LLVM_VERSION >= 50
     if (TM) {
@@ -1203,6 +1218,56 @@ void CodeGen_LLVM::visit(const Cast *op) {
     Halide::Type src = op->value.type();
     Halide::Type dst = op->type;
 
+    if (src.is_bfloat() || dst.is_bfloat()) {
+        // bfloat16 is a storage-only type, represented as the top 16
+        // bits of an IEEE float32 held in a 16-bit integer. All
+        // conversions go through Float(32); when targets grow native
+        // bfloat instructions this is the place to use them.
+        user_assert((!src.is_bfloat() || src.bits() == 16) &&
+                    (!dst.is_bfloat() || dst.bits() == 16))
+            << "Only 16-bit bfloats are supported: " << src << " -> " << dst << "\n";
+        Type f32 = Float(32, src.lanes());
+        if (src.is_bfloat() && dst != f32) {
+            // Widen to float32 first, then do whatever cast was asked for.
+            codegen(Cast::make(dst, Cast::make(f32, op->value)));
+            return;
+        }
+        if (dst.is_bfloat() && src != f32) {
+            // Convert to float32 first, then narrow.
+            codegen(Cast::make(dst, Cast::make(f32, op->value)));
+            return;
+        }
+        if (src.is_bfloat()) {
+            // bfloat16 -> float32: shift the bits into the top half of
+            // a float32.
+            value = codegen(op->value);
+            llvm::Type *i32_t = llvm_type_of(UInt(32, src.lanes()));
+            value = builder->CreateZExt(value, i32_t);
+            value = builder->CreateShl(value, ConstantInt::get(i32_t, 16));
+            value = builder->CreateBitCast(value, llvm_type_of(f32));
+        } else {
+            // float32 -> bfloat16: round to nearest even by adding
+            // 0x7fff plus the lsb of the result, then take the top
+            // half. The round-up can carry a NaN payload into the
+            // exponent, so NaNs are quieted explicitly instead.
+            llvm::Value *f = codegen(op->value);
+            llvm::Type *i32_t = llvm_type_of(UInt(32, src.lanes()));
+            llvm::Value *bits = builder->CreateBitCast(f, i32_t);
+            llvm::Value *top = builder->CreateLShr(bits, ConstantInt::get(i32_t, 16));
+            llvm::Value *lsb = builder->CreateAnd(top, ConstantInt::get(i32_t, 1));
+            llvm::Value *bias = builder->CreateAdd(lsb, ConstantInt::get(i32_t, 0x7fff));
+            llvm::Value *rounded = builder->CreateLShr(builder->CreateAdd(bits, bias),
+                                                       ConstantInt::get(i32_t, 16));
+            llvm::Type *i16_t = llvm_type_of(dst.with_code(Type::UInt));
+            llvm::Value *result = builder->CreateTrunc(rounded, i16_t);
+            llvm::Value *quiet_nan = builder->CreateOr(builder->CreateTrunc(top, i16_t),
+                                                       ConstantInt::get(i16_t, 0x0040));
+            llvm::Value *is_nan = builder->CreateFCmpUNO(f, f);
+            value = builder->CreateSelect(is_nan, quiet_nan, result);
+        }
+        return;
+    }
+
     value = codegen(op->value);
 
     llvm::Type *llvm_dst = llvm_type_of(dst);
@@ -1771,6 +1836,50 @@ void CodeGen_LLVM::visit(const Load *op) {
             }
 
             value = shuffle_vectors(vec_a, vec_b, indices);
+        } else if (ramp && stride &&
+                   stride->value >= 3 && stride->value <= 8 &&
+                   ramp->lanes >= stride->value) {
+            // Load the entire footprint as dense vectors and shuffle
+            // out the lanes we want. On x86 llvm lowers the shuffles
+            // to pshufb sequences (tbl on aarch64), which beats the
+            // scalar gather below for things like packed RGB(A)
+            // images, or the byte planes of MIPI-packed raw camera
+            // input (RAW10 is five-byte groups, RAW12 three-byte
+            // groups). ARM doesn't get here for strides 2-4, which
+            // CodeGen_ARM peels off as vldN.
+            int s = (int)stride->value;
+
+            // The dense loads cover s*lanes elements, but the last
+            // lane we actually want is at s*(lanes-1), so the final
+            // load is slid back by s-1 elements to avoid reading
+            // beyond the end of the buffer. Allocation padding only
+            // covers a one-element over-read (see
+            // CodeGen_Posix::allocation_padding), so unlike the
+            // stride-2 case above we do this unconditionally.
+            vector<Value *> vecs(s);
+            for (int i = 0; i < s; i++) {
+                Expr slice_base = ramp->base + i * ramp->lanes;
+                if (i == s - 1) {
+                    slice_base -= (s - 1);
+                }
+                Expr slice_index = Ramp::make(slice_base, make_one(slice_base.type()), ramp->lanes);
+                Expr slice = Load::make(op->type, op->name, slice_index, op->image, op->param, op->predicate);
+                vecs[i] = codegen(slice);
+            }
+            Value *all = concat_vectors(vecs);
+
+            // Lanes drawn from the final (slid back) load need their
+            // indices nudged forwards to compensate.
+            vector<int> indices(ramp->lanes);
+            for (int i = 0; i < ramp->lanes; i++) {
+                int idx = i * s;
+                if (idx >= (s - 1) * ramp->lanes) {
+                    idx += s - 1;
+                }
+                indices[i] = idx;
+            }
+
+            value = shuffle_vectors(all, indices);
         } else if (ramp && stride && stride->value == -1) {
             // Load the vector and then flip it in-place
             Expr flipped_base = ramp->base - ramp->lanes + 1;
@@ -2716,6 +2825,45 @@ void CodeGen_LLVM::visit(const Call *op) {
 
         value = builder->CreateCall(prefetch_fn, args);
 
+    } else if (op->is_intrinsic(Call::atomic_add)) {
+        internal_assert(op->args.size() == 2);
+        internal_assert(op->type.is_scalar());
+        const Load *load = op->args[0].as<Load>();
+        internal_assert(load) << "First argument to atomic_add must be a load from the buffer being updated\n";
+
+        Value *ptr = codegen_buffer_pointer(load->name, load->type, load->index);
+        Value *val = codegen(op->args[1]);
+        if (op->type.is_float()) {
+            // There's no atomicrmw for floats, so emit a
+            // compare-and-swap loop on the bits of the value.
+            llvm::Type *int_ty = llvm_type_of(op->type.with_code(Type::Int));
+            Value *int_ptr = builder->CreatePointerCast(ptr, int_ty->getPointerTo());
+            Value *orig = builder->CreateLoad(int_ptr);
+            BasicBlock *entry_bb = builder->GetInsertBlock();
+            BasicBlock *loop_bb = BasicBlock::Create(*context, "atomic_add_loop", function);
+            BasicBlock *after_bb = BasicBlock::Create(*context, "after_atomic_add", function);
+            builder->CreateBr(loop_bb);
+            builder->SetInsertPoint(loop_bb);
+            PHINode *expected = builder->CreatePHI(int_ty, 2);
+            expected->addIncoming(orig, entry_bb);
+            Value *expected_fp = builder->CreateBitCast(expected, llvm_type_of(op->type));
+            Value *desired = builder->CreateFAdd(expected_fp, val);
+            Value *desired_bits = builder->CreateBitCast(desired, int_ty);
+            Value *cmpxchg =
+                builder->CreateAtomicCmpXchg(int_ptr, expected, desired_bits,
+                                             llvm::AtomicOrdering::Monotonic,
+                                             llvm::AtomicOrdering::Monotonic);
+            expected->addIncoming(builder->CreateExtractValue(cmpxchg, 0),
+                                  builder->GetInsertBlock());
+            Value *success = builder->CreateExtractValue(cmpxchg, 1);
+            builder->CreateCondBr(success, after_bb, loop_bb);
+            builder->SetInsertPoint(after_bb);
+            value = expected_fp;
+        } else {
+            // Returns the old value, like the load it replaced would have.
+            value = builder->CreateAtomicRMW(llvm::AtomicRMWInst::Add, ptr, val,
+                                             llvm::AtomicOrdering::Monotonic);
+        }
     } else if (op->is_intrinsic(Call::signed_integer_overflow)) {
         user_error << "Signed integer overflow occurred during constant-folding. Signed"
             " integer overflow for int32 and int64 is undefined behavior in"
@@ -2732,6 +2880,17 @@ void CodeGen_LLVM::visit(const Call *op) {
         builder->setFastMathFlags(safe_flags);
         builder->setDefaultFPMathTag(strict_fp_math_md);
         value = codegen(op->args[0]);
+    } else if (op->is_intrinsic(Call::widening_add) ||
+               op->is_intrinsic(Call::widening_mul) ||
+               op->is_intrinsic(Call::halving_add) ||
+               op->is_intrinsic(Call::halving_sub) ||
+               op->is_intrinsic(Call::rounding_halving_add) ||
+               op->is_intrinsic(Call::saturating_add) ||
+               op->is_intrinsic(Call::saturating_sub)) {
+        // Expand here, after lowering and simplification, so the
+        // canonical shape reaches the backend pattern matchers intact
+        // (e.g. the ARM averaging and saturating cast patterns).
+        value = codegen(lower_widening_arithmetic(op));
     } else if (op->is_intrinsic()) {
         internal_error << "Unknown intrinsic: " << op->name << "\n";
     } else if (op->call_type == Call::PureExtern && op->name == "pow_f32") {
@@ -120,6 +120,7 @@ protected:
     static bool llvm_Mips_enabled;
     static bool llvm_PowerPC_enabled;
     static bool llvm_AMDGPU_enabled;
+    static bool llvm_RISCV_enabled;
 
     const Module *input_module;
     std::unique_ptr<llvm::Module> module;
@@ -284,8 +285,11 @@ protected:
 
     /** Mark a load or store with type-based-alias-analysis metadata
      * so that llvm knows it can reorder loads and stores across
-     * different buffers */
-    void add_tbaa_metadata(llvm::Instruction *inst, std::string buffer, Expr index);
+     * different buffers. Virtual because it is called at every load
+     * and store with the buffer name, so backends can piggyback
+     * additional per-buffer metadata (e.g. the PTX backend marks
+     * loads from read-only buffers as invariant). */
+    virtual void add_tbaa_metadata(llvm::Instruction *inst, std::string buffer, Expr index);
 
     /** Get a unique name for the actual block of memory that an
      * allocate node uses. Used so that alias analysis understands
@@ -12,8 +12,11 @@
 #include "Simplify.h"
 #include "Solve.h"
 #include "Target.h"
+#include "Util.h"
 
+#include <cstdio>
 #include <fstream>
+#include <sstream>
 
 // This is declared in NVPTX.h, which is not exported. Ugly, but seems better than
 // hardcoding a path to the .h file.
@@ -70,14 +73,30 @@ void CodeGen_PTX_Dev::add_kernel(Stmt stmt,
     function = llvm::Function::Create(func_t, llvm::Function::ExternalLinkage, name, module.get());
     set_function_attributes_for_target(function, target);
 
-    // Mark the buffer args as no alias
+    // Mark the buffer args as no alias, and remember which buffers
+    // this kernel only reads. Loads from those get marked invariant
+    // (see add_tbaa_metadata), which makes the NVPTX backend emit
+    // ld.global.nc so they go through the read-only data (texture)
+    // cache. That roughly doubles effective bandwidth for
+    // gather-heavy sampling kernels, where the random access pattern
+    // defeats L1 but fits the texture cache's 2D locality.
+    read_only_buffers.clear();
     for (size_t i = 0; i < args.size(); i++) {
         if (args[i].is_buffer) {
             #if LLVM_VERSION < 50
             function->setDoesNotAlias(i+1);
+            if (!args[i].write) {
+                function->addAttribute(i+1, Attribute::ReadOnly);
+            }
             #else
             function->addParamAttr(i, Attribute::NoAlias);
+            if (!args[i].write) {
+                function->addParamAttr(i, Attribute::ReadOnly);
+            }
             #endif
+            if (args[i].read && !args[i].write) {
+                read_only_buffers.insert(args[i].name);
+            }
         }
     }
 
@@ -253,6 +272,24 @@ void CodeGen_PTX_Dev::visit(const Load *op) {
         }
     }
 
+    // Similarly, do aligned dense loads of 16-bit vectors as a single
+    // 32, 64 or 128-bit load, so e.g. a pair of halves arrives as one
+    // ld.b32 instead of two ld.b16s. The arithmetic on <2 x half>
+    // then selects to packed half2 instructions on sm_53+ (given a
+    // new enough LLVM); wider vectors legalize into pairs.
+    if (is_one(op->predicate) && r && is_one(r->stride) && op->type.bits() == 16 &&
+        (r->lanes == 2 || r->lanes == 4 || r->lanes == 8)) {
+        ModulusRemainder align = modulus_remainder(r->base, alignment_info);
+        if (align.modulus % r->lanes == 0 && align.remainder % r->lanes == 0) {
+            Expr index = simplify(r->base / r->lanes);
+            Expr equiv = Load::make(UInt(16 * r->lanes), op->name, index,
+                                    op->image, op->param, const_true());
+            equiv = reinterpret(op->type, equiv);
+            codegen(equiv);
+            return;
+        }
+    }
+
     CodeGen_LLVM::visit(op);
 }
 
@@ -272,9 +309,36 @@ void CodeGen_PTX_Dev::visit(const Store *op) {
         }
     }
 
+    // Do aligned dense stores of 16-bit vectors as a single 32, 64 or
+    // 128-bit store. See the matching case in visit(const Load *).
+    if (is_one(op->predicate) && r && is_one(r->stride) && op->value.type().bits() == 16 &&
+        (r->lanes == 2 || r->lanes == 4 || r->lanes == 8)) {
+        ModulusRemainder align = modulus_remainder(r->base, alignment_info);
+        if (align.modulus % r->lanes == 0 && align.remainder % r->lanes == 0) {
+            Expr index = simplify(r->base / r->lanes);
+            Expr value = reinterpret(UInt(16 * r->lanes), op->value);
+            Stmt equiv = Store::make(op->name, value, index, op->param, const_true());
+            codegen(equiv);
+            return;
+        }
+    }
+
     CodeGen_LLVM::visit(op);
 }
 
+void CodeGen_PTX_Dev::add_tbaa_metadata(llvm::Instruction *inst, string buffer, Expr index) {
+    CodeGen_LLVM::add_tbaa_metadata(inst, buffer, index);
+    // Nothing in this kernel writes to the buffer, so within the
+    // lifetime of the launch the load is invariant, which is the
+    // condition for routing it through the non-coherent (texture)
+    // cache. This hook sees every load the kernel makes, including
+    // the scalarized elements of gathers.
+    if (isa<LoadInst>(inst) && read_only_buffers.count(buffer)) {
+        inst->setMetadata(LLVMContext::MD_invariant_load,
+                          MDNode::get(inst->getContext(), {}));
+    }
+}
+
 string CodeGen_PTX_Dev::march() const {
     return "nvptx64";
 }
@@ -313,6 +377,113 @@ bool CodeGen_PTX_Dev::use_soft_float_abi() const {
     return false;
 }
 
+#ifdef WITH_PTX
+namespace {
+
+// Print a per-kernel resource summary for the PTX just generated, so
+// a schedule change that silently doubles register pressure shows up
+// at compile time instead of in a profiler later. The PTX text gives
+// the statically visible numbers (virtual registers, shared and local
+// memory); if the CUDA SDK is in the path, ptxas -v supplies the real
+// post-allocation register and spill counts. Enabled by setting
+// HL_GPU_KERNEL_REPORT to a non-empty value. If HL_GPU_MAX_REGISTERS
+// is also set, kernels to which ptxas assigns more registers than
+// that get a user_warning, which generator CI can gate on.
+void report_kernel_resources(const vector<char> &ptx, const string &gpu_name) {
+    string src(ptx.begin(), ptx.end());
+
+    // Static summary from the PTX text. Virtual register counts
+    // appear as ".reg .b32 %r<N>;" declarations, and shared/local
+    // arrays as ".shared ... name[bytes];".
+    {
+        std::istringstream stream(src);
+        string line, kernel = "<module scope>";
+        int64_t regs = 0, shared_bytes = 0, local_bytes = 0;
+        bool any = false;
+        auto flush = [&]() {
+            if (any) {
+                debug(0) << "PTX kernel " << kernel << ": "
+                         << regs << " virtual registers, "
+                         << shared_bytes << " bytes shared, "
+                         << local_bytes << " bytes local\n";
+            }
+            regs = shared_bytes = local_bytes = 0;
+        };
+        while (std::getline(stream, line)) {
+            size_t pos = line.find(".entry");
+            if (pos != string::npos) {
+                flush();
+                kernel = line.substr(pos + 7);
+                kernel = kernel.substr(0, kernel.find_first_of("( \t"));
+                any = true;
+                continue;
+            }
+            long long n;
+            if (line.find(".reg") != string::npos &&
+                (pos = line.find('<')) != string::npos &&
+                sscanf(line.c_str() + pos, "<%lld>", &n) == 1) {
+                regs += n;
+            } else if ((pos = line.find('[')) != string::npos &&
+                       sscanf(line.c_str() + pos, "[%lld]", &n) == 1) {
+                if (line.find(".shared") != string::npos) {
+                    shared_bytes += n;
+                } else if (line.find(".local") != string::npos) {
+                    local_bytes += n;
+                }
+            }
+        }
+        flush();
+    }
+
+    // Accurate numbers need the actual register allocator. This
+    // mirrors the SASS dump above: it works if the CUDA SDK is in the
+    // path, and is quietly skipped otherwise.
+    TemporaryFile ptx_file("kernel_report", ".ptx");
+    TemporaryFile cubin_file("kernel_report", ".cubin");
+    TemporaryFile log_file("kernel_report", ".log");
+    {
+        std::ofstream f(ptx_file.pathname());
+        f << src;
+    }
+    string cmd = "ptxas -v --gpu-name " + gpu_name + " " + ptx_file.pathname() +
+                 " -o " + cubin_file.pathname() + " 2> " + log_file.pathname();
+    if (system(cmd.c_str()) != 0) {
+        debug(0) << "ptxas not available; static PTX summary only\n";
+        return;
+    }
+
+    int max_registers = 0;
+    string threshold = get_env_variable("HL_GPU_MAX_REGISTERS");
+    if (!threshold.empty()) {
+        max_registers = atoi(threshold.c_str());
+    }
+
+    std::ifstream log(log_file.pathname());
+    string line, kernel;
+    while (std::getline(log, line)) {
+        char buf[256];
+        if (sscanf(line.c_str(), "ptxas info : Compiling entry function '%255[^']'", buf) == 1) {
+            kernel = buf;
+        }
+        int regs;
+        if (sscanf(line.c_str(), "ptxas info : Used %d registers", &regs) == 1 &&
+            max_registers > 0 && regs > max_registers) {
+            user_warning << "CUDA kernel " << kernel << " uses " << regs
+                         << " registers, more than the threshold of "
+                         << max_registers << " set by HL_GPU_MAX_REGISTERS. "
+                         << "Occupancy may have regressed.\n";
+        }
+        if (line.find("ptxas info") != string::npos ||
+            line.find("bytes spill") != string::npos ||
+            line.find("bytes stack frame") != string::npos) {
+            debug(0) << line << "\n";
+        }
+    }
+}
+
+}  // namespace
+#endif
+
 vector<char> CodeGen_PTX_Dev::compile_to_src() {
 
     #ifdef WITH_PTX
@@ -454,6 +625,10 @@ vector<char> CodeGen_PTX_Dev::compile_to_src() {
 
     vector<char> buffer(outstr.begin(), outstr.end());
 
+    if (!get_env_variable("HL_GPU_KERNEL_REPORT").empty()) {
+        report_kernel_resources(buffer, mcpu());
+    }
+
     // Dump the SASS too if the cuda SDK is in the path
     if (debug::debug_level() >= 2) {
         debug(2) << "Compiling PTX to SASS. Will fail if CUDA SDK is not installed (and in the path).\n";
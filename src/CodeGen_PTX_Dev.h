@@ -5,6 +5,8 @@
  * Defines the code-generator for producing CUDA host code
  */
 
+#include <set>
+
 #include "CodeGen_GPU_Dev.h"
 #include "CodeGen_GPU_Host.h"
 #include "CodeGen_LLVM.h"
@@ -63,6 +65,16 @@ protected:
     void visit(const Store *);
     // @}
 
+    /** In addition to the usual TBAA info, mark loads from buffers
+     * that this kernel only reads as invariant, so that the NVPTX
+     * backend emits them as ld.global.nc and they go through the
+     * read-only data (texture) cache. */
+    void add_tbaa_metadata(llvm::Instruction *inst, std::string buffer, Expr index);
+
+    /** The buffer arguments of the current kernel that are read but
+     * never written. */
+    std::set<std::string> read_only_buffers;
+
     std::string march() const;
     std::string mcpu() const;
     std::string mattrs() const;
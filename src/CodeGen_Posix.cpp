@@ -1,4 +1,5 @@
 #include <iostream>
+#include <limits>
 
 #include "CSE.h"
 #include "CodeGen_Internal.h"
@@ -84,23 +85,29 @@ CodeGen_Posix::Allocation CodeGen_Posix::create_allocation(const std::string &na
                                                            Expr new_expr, std::string free_function) {
     Value *llvm_size = nullptr;
     int64_t stack_bytes = 0;
-    int32_t constant_bytes = Allocate::constant_allocation_size(extents, name);
+    int64_t constant_bytes = Allocate::constant_allocation_size_64(extents, name);
     if (constant_bytes > 0) {
+        if (constant_bytes > target.maximum_buffer_size() / type.bytes()) {
+            const string str_max_size = target.has_large_buffers() ? "2^63 - 1" : "2^31 - 1";
+            user_error << "Total size for allocation " << name << " is constant but exceeds " << str_max_size << ".";
+        }
         constant_bytes *= type.bytes();
         stack_bytes = constant_bytes;
 
-        if (stack_bytes > target.maximum_buffer_size()) {
-            const string str_max_size = target.has_large_buffers() ? "2^63 - 1" : "2^31 - 1";
-            user_error << "Total size for allocation " << name << " is constant but exceeds " << str_max_size << ".";
-        } else if (memory_type == MemoryType::Heap ||
-                   (memory_type != MemoryType::Stack &&
-                    memory_type != MemoryType::Register &&
-                    !can_allocation_fit_on_stack(stack_bytes))) {
-            // We should put the allocation on the heap if it's
-            // explicitly placed on the heap, or if it's not
+        if (memory_type == MemoryType::Heap ||
+            memory_type == MemoryType::VTCM ||
+            (memory_type != MemoryType::Stack &&
+             memory_type != MemoryType::Register &&
+             !can_allocation_fit_on_stack(stack_bytes))) {
+            // We should put the allocation on the heap (or in VTCM)
+            // if it's explicitly placed there, or if it's not
             // explicitly placed on the stack/register and it's large.
             stack_bytes = 0;
-            llvm_size = codegen(Expr(constant_bytes));
+            if (constant_bytes > std::numeric_limits<int32_t>::max()) {
+                llvm_size = codegen(make_const(Int(64), constant_bytes));
+            } else {
+                llvm_size = codegen(Expr(static_cast<int32_t>(constant_bytes)));
+            }
         }
     } else {
         // Should have been caught in bound_small_allocations
@@ -183,8 +190,15 @@ CodeGen_Posix::Allocation CodeGen_Posix::create_allocation(const std::string &na
             allocation.ptr = codegen(new_expr);
         } else {
             // call malloc
-            llvm::Function *malloc_fn = module->getFunction("halide_malloc");
-            internal_assert(malloc_fn) << "Could not find halide_malloc in module\n";
+            const char *malloc_fn_name = "halide_malloc";
+            if (memory_type == MemoryType::VTCM) {
+                user_assert(target.arch == Target::Hexagon)
+                    << "Allocation " << name << " is scheduled in MemoryType::VTCM, "
+                    << "which is only available on Hexagon targets.\n";
+                malloc_fn_name = "halide_vtcm_malloc";
+            }
+            llvm::Function *malloc_fn = module->getFunction(malloc_fn_name);
+            internal_assert(malloc_fn) << "Could not find " << malloc_fn_name << " in module\n";
             #if LLVM_VERSION < 50
             malloc_fn->setDoesNotAlias(0);
             #else
@@ -228,7 +242,8 @@ CodeGen_Posix::Allocation CodeGen_Posix::create_allocation(const std::string &na
 
         // Register a destructor for this allocation.
         if (free_function.empty()) {
-            free_function = "halide_free";
+            free_function = (memory_type == MemoryType::VTCM) ?
+                "halide_vtcm_free" : "halide_free";
         }
         llvm::Function *free_fn = module->getFunction(free_function);
         internal_assert(free_fn) << "Could not find " << free_function << " in module.\n";
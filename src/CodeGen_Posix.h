@@ -52,11 +52,11 @@ protected:
 
         /** How many bytes this allocation is, or 0 if not
          * constant. */
-        int constant_bytes;
+        int64_t constant_bytes;
 
         /** How many bytes of stack space used. 0 implies it was a
          * heap allocation. */
-        int stack_bytes;
+        int64_t stack_bytes;
 
         /** A unique name for this allocation. May not be equal to the
          * Allocate node name in cases where we detect multiple
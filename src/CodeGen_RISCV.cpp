@@ -0,0 +1,54 @@
+#include "CodeGen_RISCV.h"
+#include "LLVM_Headers.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+using std::vector;
+
+using namespace llvm;
+
+CodeGen_RISCV::CodeGen_RISCV(Target t) : CodeGen_Posix(t) {
+    #if !(WITH_RISCV)
+    user_error << "llvm build not configured with RISCV target enabled.\n";
+    #endif
+    user_assert(llvm_RISCV_enabled) << "llvm build not configured with RISCV target enabled.\n";
+}
+
+string CodeGen_RISCV::mcpu() const {
+    if (target.bits == 32) {
+        return "generic-rv32";
+    } else {
+        return "generic-rv64";
+    }
+}
+
+string CodeGen_RISCV::mattrs() const {
+    // Assume the standard general-purpose profile: integer
+    // multiply/divide, atomics, single and double float, and
+    // compressed instructions.
+    string attrs = "+m,+a,+f,+d,+c";
+    if (target.has_feature(Target::RVV)) {
+        // This version of llvm has no scalable vector types, so
+        // Halide's fixed-width vectors are emitted as fixed llvm
+        // vectors and legalized onto the V unit by the backend.
+        attrs += ",+experimental-v";
+    }
+    return attrs;
+}
+
+bool CodeGen_RISCV::use_soft_float_abi() const {
+    return false;
+}
+
+int CodeGen_RISCV::native_vector_bits() const {
+    // The architectural minimum VLEN for application processors. The
+    // backend splits wider vectors, and narrower hardware is not a
+    // target we generate for.
+    return 128;
+}
+
+}  // namespace Internal
+}  // namespace Halide
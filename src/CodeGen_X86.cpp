@@ -199,6 +199,56 @@ void CodeGen_X86::visit(const Select *op) {
     }
 }
 
+void CodeGen_X86::visit(const Load *op) {
+    // AVX2 has hardware gathers for 32- and 64-bit elements. Use them
+    // for vector loads with data-dependent indices (e.g. LUT
+    // application and warping kernels) instead of scalarizing.
+    if (target.has_feature(Target::AVX2) &&
+        op->type.is_vector() &&
+        !op->type.is_handle() &&
+        (op->type.bits() == 32 || op->type.bits() == 64) &&
+        is_one(op->predicate) &&
+        op->index.type().element_of() == Int(32) &&
+        op->index.as<Ramp>() == nullptr) {
+        Value *index = codegen(op->index);
+        Value *base = codegen_buffer_pointer(op->name, op->type.element_of(), make_zero(Int(32)));
+        // A gep with a vector index yields a vector of pointers.
+        Value *ptrs = builder->CreateInBoundsGEP(base, index);
+        Value *mask = Constant::getAllOnesValue(VectorType::get(i1_t, op->type.lanes()));
+        Value *pass_thru = UndefValue::get(llvm_type_of(op->type));
+        value = builder->CreateMaskedGather(ptrs, op->type.bytes(), mask, pass_thru);
+        return;
+    }
+    CodeGen_Posix::visit(op);
+}
+
+void CodeGen_X86::visit(const Store *op) {
+    // AVX-512 has hardware scatters. llvm.masked.scatter guarantees
+    // that colliding lanes are written in lane order (the highest
+    // lane wins), which matches the scalarized store loop, so no
+    // conflict-detection loop is needed for plain stores.
+    if ((target.has_feature(Target::AVX512) ||
+         target.has_feature(Target::AVX512_KNL) ||
+         target.has_feature(Target::AVX512_Skylake) ||
+         target.has_feature(Target::AVX512_Cannonlake)) &&
+        op->value.type().is_vector() &&
+        !op->value.type().is_handle() &&
+        (op->value.type().bits() == 32 || op->value.type().bits() == 64) &&
+        is_one(op->predicate) &&
+        op->index.type().element_of() == Int(32) &&
+        op->index.as<Ramp>() == nullptr &&
+        op->index.as<Let>() == nullptr) {
+        Value *val = codegen(op->value);
+        Value *index = codegen(op->index);
+        Value *base = codegen_buffer_pointer(op->name, op->value.type().element_of(), make_zero(Int(32)));
+        Value *ptrs = builder->CreateInBoundsGEP(base, index);
+        Value *mask = Constant::getAllOnesValue(VectorType::get(i1_t, op->value.type().lanes()));
+        builder->CreateMaskedScatter(val, ptrs, op->value.type().bytes(), mask);
+        return;
+    }
+    CodeGen_Posix::visit(op);
+}
+
 void CodeGen_X86::visit(const Cast *op) {
 
     if (!op->type.is_vector()) {
@@ -252,7 +302,17 @@ void CodeGen_X86::visit(const Cast *op) {
         {Target::FeatureEnd, true, UInt(16, 8), 0, "llvm.x86.sse2.psubus.w",
          u16(max(wild_i32x_ - wild_i32x_, 0))},
 
-        // Only use the avx2 version if we have > 8 lanes
+        // Only use the 512-bit version if we have > 16 lanes, and the
+        // 256-bit version if we have > 8 lanes. The avx512 helpers
+        // require avx512bw, which both Skylake and Cannonlake have.
+        {Target::AVX512_Cannonlake, true, Int(16, 32), 17, "pmulhwx32",
+         i16((wild_i32x_ * wild_i32x_) / 65536)},
+        {Target::AVX512_Skylake, true, Int(16, 32), 17, "pmulhwx32",
+         i16((wild_i32x_ * wild_i32x_) / 65536)},
+        {Target::AVX512_Cannonlake, true, UInt(16, 32), 17, "pmulhuwx32",
+         u16((wild_u32x_ * wild_u32x_) / 65536)},
+        {Target::AVX512_Skylake, true, UInt(16, 32), 17, "pmulhuwx32",
+         u16((wild_u32x_ * wild_u32x_) / 65536)},
         {Target::AVX2, true, Int(16, 16), 9, "llvm.x86.avx2.pmulh.w",
          i16((wild_i32x_ * wild_i32x_) / 65536)},
         {Target::AVX2, true, UInt(16, 16), 9, "llvm.x86.avx2.pmulhu.w",
@@ -262,6 +322,16 @@ void CodeGen_X86::visit(const Cast *op) {
          i16((wild_i32x_ * wild_i32x_) / 65536)},
         {Target::FeatureEnd, true, UInt(16, 8), 0, "llvm.x86.sse2.pmulhu.w",
          u16((wild_u32x_ * wild_u32x_) / 65536)},
+        // The 512-bit averaging helpers are generic IR on all LLVM
+        // versions, so they sit outside the version split below.
+        {Target::AVX512_Cannonlake, true, UInt(8, 64), 33, "pavgbx64",
+         u8(((wild_u16x_ + wild_u16x_) + 1) / 2)},
+        {Target::AVX512_Skylake, true, UInt(8, 64), 33, "pavgbx64",
+         u8(((wild_u16x_ + wild_u16x_) + 1) / 2)},
+        {Target::AVX512_Cannonlake, true, UInt(16, 32), 17, "pavgwx32",
+         u16(((wild_u32x_ + wild_u32x_) + 1) / 2)},
+        {Target::AVX512_Skylake, true, UInt(16, 32), 17, "pavgwx32",
+         u16(((wild_u32x_ + wild_u32x_) + 1) / 2)},
 #if LLVM_VERSION < 60
         // Older LLVM versions support this as an intrinsic
         {Target::AVX2, true, UInt(8, 32), 0, "llvm.x86.avx2.pavg.b",
@@ -283,18 +353,34 @@ void CodeGen_X86::visit(const Cast *op) {
         {Target::FeatureEnd, true, UInt(16, 8), 0, "pavgwx8",
          u16(((wild_u32x_ + wild_u32x_) + 1) / 2)},
 #endif
+        {Target::AVX512_Cannonlake, false, Int(16, 32), 17, "packssdwx32",
+         i16_sat(wild_i32x_)},
+        {Target::AVX512_Skylake, false, Int(16, 32), 17, "packssdwx32",
+         i16_sat(wild_i32x_)},
         {Target::AVX2, false, Int(16, 16), 0, "packssdwx16",
          i16_sat(wild_i32x_)},
         {Target::FeatureEnd, false, Int(16, 8), 0, "packssdwx8",
          i16_sat(wild_i32x_)},
+        {Target::AVX512_Cannonlake, false, Int(8, 64), 33, "packsswbx64",
+         i8_sat(wild_i16x_)},
+        {Target::AVX512_Skylake, false, Int(8, 64), 33, "packsswbx64",
+         i8_sat(wild_i16x_)},
         {Target::AVX2, false, Int(8, 32), 0, "packsswbx32",
          i8_sat(wild_i16x_)},
         {Target::FeatureEnd, false, Int(8, 16), 0, "packsswbx16",
          i8_sat(wild_i16x_)},
+        {Target::AVX512_Cannonlake, false, UInt(8, 64), 33, "packuswbx64",
+         u8_sat(wild_i16x_)},
+        {Target::AVX512_Skylake, false, UInt(8, 64), 33, "packuswbx64",
+         u8_sat(wild_i16x_)},
         {Target::AVX2, false, UInt(8, 32), 0, "packuswbx32",
          u8_sat(wild_i16x_)},
         {Target::FeatureEnd, false, UInt(8, 16), 0, "packuswbx16",
          u8_sat(wild_i16x_)},
+        {Target::AVX512_Cannonlake, false, UInt(16, 32), 17, "packusdwx32",
+         u16_sat(wild_i32x_)},
+        {Target::AVX512_Skylake, false, UInt(16, 32), 17, "packusdwx32",
+         u16_sat(wild_i32x_)},
         {Target::AVX2, false, UInt(16, 16), 0, "packusdwx16",
          u16_sat(wild_i32x_)},
         {Target::SSE41, false, UInt(16, 8), 0, "packusdwx8",
@@ -328,6 +414,22 @@ void CodeGen_X86::visit(const Cast *op) {
         }
     }
 
+    // With F16C we can convert vectors of float16 in one instruction
+    // via the helpers in x86_avx.ll. LLVM otherwise scalarizes these
+    // casts through conversion libcalls, which defeats storing
+    // intermediates at half precision.
+    if (target.has_feature(Target::F16C) &&
+        target.has_feature(Target::AVX) &&
+        op->type.is_float() && op->value.type().is_float()) {
+        if (op->type.bits() == 32 && op->value.type().bits() == 16) {
+            value = call_intrin(op->type, 8, "vcvtph2psx8", {op->value});
+            return;
+        } else if (op->type.bits() == 16 && op->value.type().bits() == 32) {
+            value = call_intrin(op->type, 8, "vcvtps2phx8", {op->value});
+            return;
+        }
+    }
+
     // Workaround for https://llvm.org/bugs/show_bug.cgi?id=24512
     // LLVM uses a numerically unstable method for vector
     // uint32->float conversion before AVX.
@@ -45,6 +45,14 @@ protected:
     void visit(const NE *);
     void visit(const Select *);
     // @}
+
+    /** Vector loads and stores with data-dependent indices become
+     * hardware gathers (AVX2) and scatters (AVX-512) instead of
+     * being scalarized. */
+    // @{
+    void visit(const Load *);
+    void visit(const Store *);
+    // @}
 };
 
 }  // namespace Internal
@@ -1,4 +1,8 @@
 #include "Debug.h"
+#include "Util.h"
+
+#include <fstream>
+#include <stdio.h>
 
 namespace Halide {
 namespace Internal {
@@ -11,5 +15,73 @@ int debug::debug_level() {
     return cached_debug_level;
 }
 
+namespace {
+
+#ifndef _WIN32
+// Wraps a popen'd FILE in a streambuf, so that gzip-compressed debug
+// output can be used as a std::ostream.
+class PipeStreambuf : public std::streambuf {
+    FILE *f;
+
+    int overflow(int c) override {
+        if (c != EOF && fputc(c, f) == EOF) {
+            return EOF;
+        }
+        return c;
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override {
+        return (std::streamsize)fwrite(s, 1, (size_t)n, f);
+    }
+
+    int sync() override {
+        return fflush(f);
+    }
+
+public:
+    PipeStreambuf(FILE *f) : f(f) {}
+};
+
+FILE *debug_output_pipe = nullptr;
+
+void close_debug_output_pipe() {
+    if (debug_output_pipe) {
+        pclose(debug_output_pipe);
+        debug_output_pipe = nullptr;
+    }
+}
+#endif
+
+}  // anonymous namespace
+
+std::ostream &debug::stream() {
+    static std::ostream *cached_stream = ([]() -> std::ostream * {
+        std::string file = get_env_variable("HL_DEBUG_CODEGEN_FILE");
+        if (file.empty()) {
+            return &std::cerr;
+        }
+#ifndef _WIN32
+        if (ends_with(file, ".gz")) {
+            std::string cmd = "gzip > '" + file + "'";
+            debug_output_pipe = popen(cmd.c_str(), "w");
+            if (debug_output_pipe) {
+                // Make sure gzip sees EOF and finishes writing before
+                // the process disappears.
+                atexit(close_debug_output_pipe);
+                return new std::ostream(new PipeStreambuf(debug_output_pipe));
+            }
+            // gzip unavailable; fall through to an uncompressed file.
+        }
+#endif
+        auto *f = new std::ofstream(file);
+        if (f->good()) {
+            return f;
+        }
+        delete f;
+        return &std::cerr;
+    })();
+    return *cached_stream;
+}
+
 }  // namespace Internal
 }  // namespace Halide
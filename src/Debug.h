@@ -46,6 +46,14 @@ std::ostream &operator<<(std::ostream &, const LoweredFunc &);
  * tracing everything that occurs. The verbosity with which to print
  * is determined by the value of the environment variable
  * HL_DEBUG_CODEGEN
+ *
+ * Output goes to stderr unless HL_DEBUG_CODEGEN_FILE names a file to
+ * write to instead. If the filename ends in ".gz" the output is
+ * piped through gzip (not supported on Windows), which matters when
+ * dumping the IR of large pipelines after every lowering pass. The
+ * per-pass Stmt dumps can additionally be trimmed with
+ * HL_DEBUG_CODEGEN_PASSES, HL_DEBUG_CODEGEN_FUNCS, and
+ * HL_DEBUG_CODEGEN_DIFF; see Lower.cpp.
  */
 
 class debug {
@@ -57,12 +65,16 @@ public:
     template<typename T>
     debug &operator<<(T&& x) {
         if (logging) {
-            std::cerr << std::forward<T>(x);
+            stream() << std::forward<T>(x);
         }
         return *this;
     }
 
     static int debug_level();
+
+    /** The stream debug output is written to: stderr, or the file
+     * named by HL_DEBUG_CODEGEN_FILE. */
+    static std::ostream &stream();
 };
 
 }  // namespace Internal
@@ -0,0 +1,232 @@
+#include "DoubleBuffering.h"
+#include "Function.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::string;
+using std::vector;
+
+const char *const double_buffer_marker = "halide_double_buffer_marker";
+
+bool is_double_buffer_marker(const Stmt &s) {
+    const Evaluate *e = s.as<Evaluate>();
+    const Call *c = e ? e->value.as<Call>() : nullptr;
+    return c && c->is_intrinsic(double_buffer_marker);
+}
+
+namespace {
+
+// Offsets all accesses to a func along one dimension, so that
+// successive iterations of the enclosing serial loop use alternating
+// halves of the doubled storage.
+class PhaseAccesses : public IRMutator2 {
+    const string &func;
+    int dim;
+    Expr offset;
+
+    using IRMutator2::visit;
+
+    Expr visit(const Call *op) override {
+        Expr expr = IRMutator2::visit(op);
+        op = expr.as<Call>();
+        internal_assert(op);
+        if (op->call_type == Call::Halide && op->name == func) {
+            vector<Expr> args = op->args;
+            args[dim] += offset;
+            expr = Call::make(op->type, op->name, args, op->call_type,
+                              op->func, op->value_index, op->image, op->param);
+        }
+        return expr;
+    }
+
+    Stmt visit(const Provide *op) override {
+        Stmt stmt = IRMutator2::visit(op);
+        op = stmt.as<Provide>();
+        internal_assert(op);
+        if (op->name == func) {
+            vector<Expr> args = op->args;
+            args[dim] += offset;
+            stmt = Provide::make(op->name, op->values, args);
+        }
+        return stmt;
+    }
+
+public:
+    PhaseAccesses(const string &func, int dim, Expr offset)
+        : func(func), dim(dim), offset(offset) {}
+};
+
+// Check that nothing else is realized at the block level inside a
+// double-buffered loop. Such storage would be written each iteration
+// without an end-of-iteration barrier to protect the previous
+// iteration's reads.
+class CheckBlockLevelRealizations : public IRVisitor {
+    const string &func;
+
+    using IRVisitor::visit;
+
+    void visit(const For *op) {
+        if (op->for_type == ForType::GPUThread ||
+            op->for_type == ForType::GPULane) {
+            return;
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Realize *op) {
+        user_error
+            << "Func \"" << op->name << "\" is realized at the gpu block level "
+            << "inside the serial loop over which \"" << func << "\" is "
+            << "double-buffered. Store it outside that loop, or compute it "
+            << "inside gpu threads.\n";
+    }
+
+public:
+    CheckBlockLevelRealizations(const string &func) : func(func) {}
+};
+
+// Descend from a double-buffered realization to the serial loop
+// directly below it, phase the func's accesses there by the loop
+// variable's parity, and mark the loop so that gpu synchronization
+// injection can omit the barrier at the end of each iteration.
+class DoubleBufferLoop : public IRMutator2 {
+    const string &func;
+    int dim;
+    Expr extent;
+    const map<string, Function> &env;
+
+    using IRMutator2::visit;
+
+    Stmt visit(const For *op) override {
+        user_assert(op->for_type == ForType::Serial)
+            << "Func \"" << func << "\" is scheduled with double_buffer(), "
+            << "but is not produced inside a serial loop below its storage level.\n";
+
+        CheckBlockLevelRealizations check(func);
+        op->body.accept(&check);
+
+        Expr loop_var = Variable::make(Int(32), op->name);
+        Expr phase = (loop_var - op->min) % 2;
+        Stmt body = PhaseAccesses(func, dim, phase * extent).mutate(op->body);
+
+        // An inner double-buffered realization over the same loop
+        // will already have left a marker.
+        const Block *b = body.as<Block>();
+        if (!(b && is_double_buffer_marker(b->first))) {
+            Stmt marker =
+                Evaluate::make(Call::make(Int(32), double_buffer_marker,
+                                          vector<Expr>(), Call::Intrinsic));
+            body = Block::make(marker, body);
+        }
+
+        return For::make(op->name, op->min, op->extent,
+                         op->for_type, op->device_api, body);
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        return LetStmt::make(op->name, op->value, mutate(op->body));
+    }
+
+    Stmt visit(const Realize *op) override {
+        // Any realization between the double-buffered one and the
+        // serial loop has the same lifetime as the double-buffered
+        // storage, but without the doubling its writes in iteration
+        // k+1 would race with iteration k's reads once the
+        // end-of-iteration barrier is dropped. Only other
+        // double-buffered funcs may sit here.
+        map<string, Function>::const_iterator iter = env.find(op->name);
+        if (iter == env.end() ||
+            !iter->second.schedule().double_buffered()) {
+            user_error
+                << "Func \"" << op->name << "\" is realized between the "
+                << "double-buffered realization of \"" << func << "\" and its "
+                << "serial loop. Store it outside that loop and schedule it "
+                << "with double_buffer(), or compute it inside gpu threads.\n";
+        }
+        return Realize::make(op->name, op->types, op->memory_type,
+                             op->bounds, op->condition, mutate(op->body));
+    }
+
+public:
+    using IRMutator2::mutate;
+
+    Stmt mutate(const Stmt &s) override {
+        user_assert(s.as<For>() || s.as<LetStmt>() || s.as<Realize>())
+            << "Func \"" << func << "\" is scheduled with double_buffer(), "
+            << "but is not produced inside a serial loop below its storage level.\n";
+        return IRMutator2::mutate(s);
+    }
+
+    DoubleBufferLoop(const string &func, int dim, Expr extent,
+                     const map<string, Function> &env)
+        : func(func), dim(dim), extent(extent), env(env) {}
+};
+
+class InjectDoubleBuffering : public IRMutator2 {
+    const map<string, Function> &env;
+    bool in_gpu_block;
+
+    using IRMutator2::visit;
+
+    Stmt visit(const For *op) override {
+        ScopedValue<bool> old_in_gpu_block(in_gpu_block,
+                                           (in_gpu_block ||
+                                            op->for_type == ForType::GPUBlock));
+        return IRMutator2::visit(op);
+    }
+
+    Stmt visit(const Realize *op) override {
+        map<string, Function>::const_iterator iter = env.find(op->name);
+        if (iter == env.end() ||
+            !iter->second.schedule().double_buffered()) {
+            return IRMutator2::visit(op);
+        }
+        const Function &f = iter->second;
+
+        user_assert(in_gpu_block)
+            << "Func \"" << f.name() << "\" is scheduled with double_buffer(), "
+            << "but is not stored inside a loop over gpu blocks.\n";
+
+        // Process the body first. Other double-buffered realizations
+        // at the same storage level share the same serial loop.
+        Stmt body = mutate(op->body);
+
+        // Double the outermost storage dimension. Each iteration of
+        // the serial loop produces into one half while consuming the
+        // previous iteration's half.
+        int dim = (int)op->bounds.size() - 1;
+        const vector<StorageDim> &storage_dims = f.schedule().storage_dims();
+        if (!storage_dims.empty()) {
+            for (int i = 0; i < (int)f.args().size(); i++) {
+                if (f.args()[i] == storage_dims.back().var) {
+                    dim = i;
+                }
+            }
+        }
+        Expr extent = op->bounds[dim].extent;
+
+        body = DoubleBufferLoop(op->name, dim, extent, env).mutate(body);
+
+        Region bounds = op->bounds;
+        bounds[dim].extent *= 2;
+        return Realize::make(op->name, op->types, op->memory_type,
+                             bounds, op->condition, body);
+    }
+
+public:
+    InjectDoubleBuffering(const map<string, Function> &env)
+        : env(env), in_gpu_block(false) {}
+};
+
+}  // namespace
+
+Stmt inject_double_buffering(Stmt s, const map<string, Function> &env) {
+    return InjectDoubleBuffering(env).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
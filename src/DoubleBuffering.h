@@ -0,0 +1,39 @@
+#ifndef HALIDE_DOUBLE_BUFFERING_H
+#define HALIDE_DOUBLE_BUFFERING_H
+
+/** \file
+ *
+ * Defines the lowering pass that implements the double_buffer()
+ * scheduling directive by doubling the storage of the realization and
+ * alternating the half accessed on each iteration of the enclosing
+ * serial loop.
+ */
+
+#include <map>
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+class Function;
+
+/** The name of the intrinsic marker left at the top of a
+ * double-buffered serial loop. FuseGPUThreadLoops consumes it and
+ * omits the end-of-iteration thread barrier for such loops. */
+extern const char *const double_buffer_marker;
+
+/** Is the given statement a double-buffer marker? */
+bool is_double_buffer_marker(const Stmt &s);
+
+/** Double the storage of any realizations scheduled with
+ * double_buffer(), phase their accesses by the parity of the
+ * enclosing serial loop, and mark that loop so that gpu
+ * synchronization injection can skip the barrier at the end of each
+ * iteration. */
+Stmt inject_double_buffering(Stmt s, const std::map<std::string, Function> &env);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
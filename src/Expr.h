@@ -182,25 +182,10 @@ struct IRHandle : public IntrusivePtr<const IRNode> {
 struct IntImm : public ExprNode<IntImm> {
     int64_t value;
 
-    static const IntImm *make(Type t, int64_t value) {
-        internal_assert(t.is_int() && t.is_scalar())
-            << "IntImm must be a scalar Int\n";
-        internal_assert(t.bits() == 8 || t.bits() == 16 || t.bits() == 32 || t.bits() == 64)
-            << "IntImm must be 8, 16, 32, or 64-bit\n";
-
-        // Normalize the value by dropping the high bits.
-        // Since left-shift of negative value is UB in C++, cast to uint64 first;
-        // it's unlikely any compilers we care about will misbehave, but UBSan will complain.
-        value = (int64_t) (((uint64_t) value) << (64 - t.bits()));
-
-        // Then sign-extending to get them back
-        value >>= (64 - t.bits());
-
-        IntImm *node = new IntImm;
-        node->type = t;
-        node->value = value;
-        return node;
-    }
+    /** Construct an IntImm. Small values are interned, so
+     * structurally equal constants usually share a node and can be
+     * compared by pointer. Defined in IR.cpp. */
+    static const IntImm *make(Type t, int64_t value);
 
     static const IRNodeType _node_type = IRNodeType::IntImm;
 };
@@ -209,21 +194,10 @@ struct IntImm : public ExprNode<IntImm> {
 struct UIntImm : public ExprNode<UIntImm> {
     uint64_t value;
 
-    static const UIntImm *make(Type t, uint64_t value) {
-        internal_assert(t.is_uint() && t.is_scalar())
-            << "UIntImm must be a scalar UInt\n";
-        internal_assert(t.bits() == 1 || t.bits() == 8 || t.bits() == 16 || t.bits() == 32 || t.bits() == 64)
-            << "UIntImm must be 1, 8, 16, 32, or 64-bit\n";
-
-        // Normalize the value by dropping the high bits
-        value <<= (64 - t.bits());
-        value >>= (64 - t.bits());
-
-        UIntImm *node = new UIntImm;
-        node->type = t;
-        node->value = value;
-        return node;
-    }
+    /** Construct a UIntImm. Small values are interned, so
+     * structurally equal constants usually share a node and can be
+     * compared by pointer. Defined in IR.cpp. */
+    static const UIntImm *make(Type t, uint64_t value);
 
     static const IRNodeType _node_type = IRNodeType::UIntImm;
 };
@@ -366,6 +340,13 @@ enum class MemoryType {
      * "local" in OpenCL, and "threadgroup" in metal. Can be shared
      * across GPU threads within the same block. */
     GPUShared,
+
+    /** Allocation is stored in Hexagon's vector tightly-coupled
+     * memory (VTCM). VTCM is a small scratchpad with much higher
+     * bandwidth than the rest of the memory hierarchy, so it's a
+     * good place for intermediates of HVX pipelines. Allocated using
+     * halide_vtcm_malloc. Only legal on Hexagon targets. */
+    VTCM,
 };
 
 namespace Internal {
@@ -286,6 +286,18 @@ void Stage::set_dim_type(VarOrRVar var, ForType t) {
     for (size_t i = 0; i < dims.size(); i++) {
         if (var_name_match(dims[i].var, var.name())) {
             found = true;
+
+            // Atomic updates lower to scalar atomic read-modify-write
+            // operations before vectorization runs, and we have no
+            // way to emit vector atomics, so vectorizing any
+            // dimension of an atomic definition is off the table.
+            user_assert(t != ForType::Vectorized ||
+                        !definition.schedule().atomic())
+                << "In schedule for " << name()
+                << ", can't vectorize across " << var.name()
+                << " because the definition is atomic(), and atomic"
+                << " updates lower to scalar atomic operations.\n";
+
             dims[i].for_type = t;
 
             // If it's an rvar and the for type is parallel, we need to
@@ -294,7 +306,11 @@ void Stage::set_dim_type(VarOrRVar var, ForType t) {
                 (t == ForType::Vectorized || t == ForType::Parallel ||
                  t == ForType::GPUBlock || t == ForType::GPUThread ||
                  t == ForType::GPULane)) {
-                user_assert(definition.schedule().allow_race_conditions())
+                // Atomic updates are race-free when parallelized, but
+                // we have no way to emit vector atomics.
+                bool race_ok = definition.schedule().allow_race_conditions() ||
+                    (definition.schedule().atomic() && t != ForType::Vectorized);
+                user_assert(race_ok)
                     << "In schedule for " << name()
                     << ", marking var " << var.name()
                     << " as parallel or vectorized may introduce a race"
@@ -590,6 +606,29 @@ Func Stage::rfactor(RVar r, Var v) {
     return rfactor({{r, v}});
 }
 
+Func Stage::parallel_rfactor(RVar r, const Expr &task_size) {
+    user_assert(!definition.is_init())
+        << "parallel_rfactor() must be called on an update definition\n";
+    user_assert(task_size.defined())
+        << "parallel_rfactor() called with an undefined task size\n";
+
+    // Split the rvar into tasks and lift the per-task partial
+    // reductions into an intermediate Func. rfactor() checks
+    // associativity (and, since only the inner dimension remains a
+    // reduction, commutativity) of the update's operator.
+    RVar outer(r.name() + "_o"), inner(r.name() + "_i");
+    Var task(r.name() + "_task");
+    split(r, outer, inner, task_size, TailStrategy::GuardWithIf);
+    Func intm = rfactor(outer, task);
+
+    // Compute the partial results across cores. The merge over the
+    // remaining rvar stays serial, but only has one iteration per
+    // task.
+    intm.compute_root().parallel(task);
+    intm.update().parallel(task);
+    return intm;
+}
+
 Func Stage::rfactor(vector<pair<RVar, Var>> preserved) {
     user_assert(!definition.is_init()) << "rfactor() must be called on an update definition\n";
 
@@ -1122,6 +1161,23 @@ Stage &Stage::fuse(VarOrRVar inner, VarOrRVar outer, VarOrRVar fused) {
     return *this;
 }
 
+Stage &Stage::fuse_morton(VarOrRVar inner, VarOrRVar outer, VarOrRVar fused) {
+    // A Morton fuse reorders iterations, so it's only legal on pure
+    // Vars.
+    user_assert(!inner.is_rvar && !outer.is_rvar && !fused.is_rvar)
+        << "In schedule for " << name()
+        << ", can't fuse RVars in Morton order, because it reorders "
+        << "the iterations of the reduction domain.
+";
+
+    fuse(inner, outer, fused);
+
+    // The fuse above pushed a FuseVars split; flip it to the
+    // Morton-ordered variant.
+    definition.schedule().splits().back().split_type = Split::FuseVarsMorton;
+    return *this;
+}
+
 namespace Internal {
 class CheckForFreeVars : public IRGraphVisitor {
 public:
@@ -1405,6 +1461,39 @@ Stage &Stage::allow_race_conditions() {
     return *this;
 }
 
+Stage &Stage::atomic() {
+    user_assert(!definition.is_init())
+        << "In schedule for " << name()
+        << ", atomic() must be called on an update definition\n";
+
+    // Atomics are only safe if the update is associative, so reuse
+    // the prover that backs rfactor().
+    const auto &prover_result =
+        prove_associativity(function.name(), definition.args(), definition.values());
+    user_assert(prover_result.associative())
+        << "Failed to call atomic() on " << name()
+        << " since it can't prove associativity of the operator\n";
+
+    for (size_t i = 0; i < prover_result.size(); i++) {
+        user_assert(prover_result.pattern.ops[i].as<Add>() != nullptr)
+            << "Failed to call atomic() on " << name()
+            << " since only additive updates (f(...) = f(...) + e) are"
+            << " currently supported\n";
+    }
+
+    // The same restriction set_dim_type enforces for schedules
+    // applied after this call.
+    for (const Dim &d : definition.schedule().dims()) {
+        user_assert(d.for_type != ForType::Vectorized)
+            << "Failed to call atomic() on " << name()
+            << " since dimension " << d.var << " is vectorized, and atomic"
+            << " updates lower to scalar atomic operations.\n";
+    }
+
+    definition.schedule().atomic() = true;
+    return *this;
+}
+
 Stage &Stage::serial(VarOrRVar var) {
     set_dim_type(var, ForType::Serial);
     return *this;
@@ -1464,6 +1553,47 @@ Stage &Stage::unroll(VarOrRVar var, Expr factor, TailStrategy tail) {
     return *this;
 }
 
+Stage &Stage::unroll_and_jam(VarOrRVar var, Expr factor, TailStrategy tail) {
+    string jam_name;
+    if (var.is_rvar) {
+        RVar tmp;
+        split(var.rvar, var.rvar, tmp, factor, tail);
+        unroll(tmp);
+        jam_name = tmp.name();
+    } else {
+        Var tmp;
+        split(var.var, var.var, tmp, factor, tail);
+        unroll(tmp);
+        jam_name = tmp.name();
+    }
+
+    // Sink the unrolled copies of the loop body inwards, jamming them
+    // together so that loads they share stay in registers. Stop at
+    // any vectorized dimension, and don't reorder the copies past
+    // another RVar, as that could change the meaning of the
+    // algorithm.
+    vector<Dim> &dims = definition.schedule().dims();
+    size_t jam_idx = dims.size();
+    for (size_t i = 0; i < dims.size(); i++) {
+        if (var_name_match(dims[i].var, jam_name)) {
+            jam_idx = i;
+            break;
+        }
+    }
+    internal_assert(jam_idx < dims.size());
+    size_t dst = jam_idx;
+    while (dst > 0 &&
+           dims[dst-1].for_type != ForType::Vectorized &&
+           (dims[jam_idx].is_pure() || dims[dst-1].is_pure())) {
+        dst--;
+    }
+    for (size_t i = jam_idx; i > dst; i--) {
+        std::swap(dims[i], dims[i-1]);
+    }
+
+    return *this;
+}
+
 Stage &Stage::tile(VarOrRVar x, VarOrRVar y,
                    VarOrRVar xo, VarOrRVar yo,
                    VarOrRVar xi, VarOrRVar yi,
@@ -1962,6 +2092,12 @@ Func &Func::fuse(VarOrRVar inner, VarOrRVar outer, VarOrRVar fused) {
     return *this;
 }
 
+Func &Func::fuse_morton(VarOrRVar inner, VarOrRVar outer, VarOrRVar fused) {
+    invalidate_cache();
+    Stage(func, func.definition(), 0, args()).fuse_morton(inner, outer, fused);
+    return *this;
+}
+
 Func &Func::rename(VarOrRVar old_name, VarOrRVar new_name) {
     invalidate_cache();
     Stage(func, func.definition(), 0, args()).rename(old_name, new_name);
@@ -1973,12 +2109,70 @@ Func &Func::allow_race_conditions() {
     return *this;
 }
 
+Func &Func::atomic() {
+    invalidate_cache();
+    user_assert(num_update_definitions() > 0)
+        << "Func \"" << name() << "\" has no update definitions to make atomic\n";
+    for (int i = 0; i < num_update_definitions(); i++) {
+        update(i).atomic();
+    }
+    return *this;
+}
+
 Func &Func::memoize() {
     invalidate_cache();
     func.schedule().memoized() = true;
     return *this;
 }
 
+Func &Func::memoize(const Expr &eviction_key) {
+    invalidate_cache();
+    user_assert(eviction_key.defined())
+        << "memoize() called with an undefined eviction key on " << name() << "\n";
+    user_assert(eviction_key.type().is_scalar() &&
+                (eviction_key.type().is_int() || eviction_key.type().is_uint()))
+        << "The eviction key passed to memoize() on " << name()
+        << " must be a scalar integer, but has type " << eviction_key.type() << "\n";
+    func.schedule().memoized() = true;
+    func.schedule().memoize_eviction_key() = cast(UInt(64), eviction_key);
+    return *this;
+}
+
+Func &Func::compute_if(Expr condition) {
+    invalidate_cache();
+    user_assert(condition.defined())
+        << "compute_if() called with an undefined condition on " << name() << "\n";
+    user_assert(condition.type().is_bool() && condition.type().is_scalar())
+        << "The condition passed to compute_if() on " << name()
+        << " must be a scalar boolean, but has type " << condition.type() << "\n";
+    func.schedule().compute_predicate() = condition;
+    return *this;
+}
+
+Func &Func::async() {
+    invalidate_cache();
+    func.schedule().async() = true;
+    return *this;
+}
+
+Func &Func::auto_prefetch() {
+    invalidate_cache();
+    func.schedule().auto_prefetch() = true;
+    return *this;
+}
+
+Func &Func::double_buffer() {
+    invalidate_cache();
+    func.schedule().double_buffered() = true;
+    return *this;
+}
+
+Func &Func::strict_float() {
+    invalidate_cache();
+    func.schedule().strict_float() = true;
+    return *this;
+}
+
 Func &Func::store_in(MemoryType t) {
     invalidate_cache();
     func.schedule().memory_type() = t;
@@ -1990,6 +2184,53 @@ Stage Func::specialize(Expr c) {
     return Stage(func, func.definition(), 0, args()).specialize(c);
 }
 
+namespace {
+// Collects the input buffer parameters a definition reads from.
+class FindInputBuffers : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Call *op) override {
+        IRVisitor::visit(op);
+        if (op->call_type == Call::Image && op->param.defined()) {
+            bufs[op->param.name()] = op->param;
+        }
+    }
+
+public:
+    std::map<std::string, Internal::Parameter> bufs;
+};
+}  // namespace
+
+Stage Func::specialize_on_dense_inputs(int alignment) {
+    user_assert(alignment >= 1 && ((alignment & (alignment - 1)) == 0))
+        << "The alignment passed to specialize_on_dense_inputs must be a power of two.\n";
+
+    FindInputBuffers finder;
+    const Definition &def = func.definition();
+    for (const Expr &v : def.values()) {
+        v.accept(&finder);
+    }
+    for (const Expr &a : def.args()) {
+        a.accept(&finder);
+    }
+    user_assert(!finder.bufs.empty())
+        << "Can't call specialize_on_dense_inputs on Func \"" << name()
+        << "\", because it does not read any input buffers.\n";
+
+    Expr condition;
+    for (const auto &p : finder.bufs) {
+        const Internal::Parameter &param = p.second;
+        Expr stride = Variable::make(Int(32), param.name() + ".stride.0", param);
+        Expr buf = Variable::make(type_of<struct halide_buffer_t *>(),
+                                  param.name() + ".buffer", param);
+        Expr host = Call::make(Handle(), Call::buffer_get_host, {buf}, Call::Extern);
+        Expr dense = (stride == 1) &&
+                     (reinterpret(UInt(64), host) % alignment == 0);
+        condition = condition.defined() ? condition && dense : dense;
+    }
+    return specialize(condition);
+}
+
 void Func::specialize_fail(const std::string &message) {
     invalidate_cache();
     (void) Stage(func, func.definition(), 0, args()).specialize_fail(message);
@@ -2037,6 +2278,12 @@ Func &Func::unroll(VarOrRVar var, Expr factor, TailStrategy tail) {
     return *this;
 }
 
+Func &Func::unroll_and_jam(VarOrRVar var, Expr factor, TailStrategy tail) {
+    invalidate_cache();
+    Stage(func, func.definition(), 0, args()).unroll_and_jam(var, factor, tail);
+    return *this;
+}
+
 Func &Func::bound(Var var, Expr min, Expr extent) {
     user_assert(!min.defined() || Int(32).can_represent(min.type())) << "Can't represent min bound in int32\n";
     user_assert(extent.defined()) << "Extent bound of a Func can't be undefined\n";
@@ -2104,6 +2351,29 @@ Func &Func::align_bounds(Var var, Expr modulus, Expr remainder) {
     return *this;
 }
 
+Func &Func::pad_bounds(Var var, Expr before, Expr after) {
+    user_assert(before.defined()) << "before is undefined\n";
+    user_assert(after.defined()) << "after is undefined\n";
+    user_assert(Int(32).can_represent(before.type())) << "Can't represent padding as int32\n";
+    user_assert(Int(32).can_represent(after.type())) << "Can't represent padding as int32\n";
+
+    before = cast<int32_t>(before);
+    after = cast<int32_t>(after);
+
+    invalidate_cache();
+
+    bool found = func.is_pure_arg(var.name());
+    user_assert(found)
+        << "Can't pad bounds of variable " << var.name()
+        << " of function " << name()
+        << " because " << var.name()
+        << " is not one of the pure variables of " << name() << ".\n";
+
+    Bound b = {var.name(), Expr(), Expr(), Expr(), Expr(), before, after};
+    func.schedule().bounds().push_back(b);
+    return *this;
+}
+
 Func &Func::tile(VarOrRVar x, VarOrRVar y,
                  VarOrRVar xo, VarOrRVar yo,
                  VarOrRVar xi, VarOrRVar yi,
@@ -2370,6 +2640,29 @@ Func &Func::fold_storage(Var dim, Expr factor, bool fold_forward) {
     return *this;
 }
 
+Func &Func::tile_storage(Var x, Var y, Expr x_size, Expr y_size) {
+    invalidate_cache();
+
+    vector<StorageDim> &dims = func.schedule().storage_dims();
+    user_assert(dims.size() >= 2)
+        << "Cannot tile the storage of " << name()
+        << ", which has fewer than two dimensions.\n";
+    user_assert(var_name_match(dims[0].var, x.name()) &&
+                var_name_match(dims[1].var, y.name()))
+        << "In schedule for " << name()
+        << ", tile_storage requires the two innermost storage dimensions, "
+        << "in order. Use reorder_storage first if necessary.\n";
+    dims[0].tile_factor = x_size;
+    dims[1].tile_factor = y_size;
+    return *this;
+}
+
+Func &Func::interleave_storage() {
+    invalidate_cache();
+    func.schedule().tuple_interleaved() = true;
+    return *this;
+}
+
 Func &Func::compute_at(LoopLevel loop_level) {
     invalidate_cache();
     func.schedule().compute_level() = loop_level;
@@ -2435,6 +2728,24 @@ Func &Func::store_root() {
     return store_at(LoopLevel::root());
 }
 
+Func &Func::hoist_storage(LoopLevel loop_level) {
+    invalidate_cache();
+    func.schedule().hoist_storage_level() = loop_level;
+    return *this;
+}
+
+Func &Func::hoist_storage(Func f, RVar var) {
+    return hoist_storage(LoopLevel(f, var));
+}
+
+Func &Func::hoist_storage(Func f, Var var) {
+    return hoist_storage(LoopLevel(f, var));
+}
+
+Func &Func::hoist_storage_root() {
+    return hoist_storage(LoopLevel::root());
+}
+
 Func &Func::compute_inline() {
     return compute_at(LoopLevel::inlined());
 }
@@ -3066,6 +3377,10 @@ void *Func::compile_jit(const Target &target) {
     return pipeline().compile_jit(target);
 }
 
+void Func::warmup(const Target &target) {
+    pipeline().warmup(target);
+}
+
 Var _("_");
 Var _0("_0"), _1("_1"), _2("_2"), _3("_3"), _4("_4"),
            _5("_5"), _6("_6"), _7("_7"), _8("_8"), _9("_9");
@@ -180,6 +180,27 @@ public:
     Func rfactor(RVar r, Var v);
     // @}
 
+    /** A one-call convenience wrapper around rfactor() for
+     * parallelizing an associative reduction. Splits the given RVar
+     * into tasks of 'task_size' iterations each, lifts the per-task
+     * partial reductions into an intermediate Func via rfactor(), and
+     * schedules the intermediate compute_root() with both its
+     * definitions parallelized over the task index. The update this is
+     * called on becomes a serial merge of one partial result per task.
+     * So
+     \code
+     f() = 0;
+     f() += a(r) * b(r);
+     f.update().parallel_rfactor(r, 8192);
+     \endcode
+     * computes the dot product across all cores without spelling out
+     * the split, the intermediate, or its schedule. Throws an error if
+     * it can't prove the update's operator associative (and, because
+     * the split reorders the reduction, commutative). Returns the
+     * intermediate Func, which may be scheduled further, e.g. to
+     * vectorize the per-task loop. */
+    Func parallel_rfactor(RVar r, const Expr &task_size);
+
     /** Schedule the iteration over this stage to be fused with another
      * stage 's' from outermost loop to a given LoopLevel. 'this' stage will
      * be computed AFTER 's' in the innermost fused dimension. There should not
@@ -191,6 +212,23 @@ public:
      * the stage we are calling compute_with on should not have specializations,
      * e.g. f2.compute_with(f1, x) is allowed only if f2 has no specializations.
      *
+     * Update stages can be fused as well, by calling compute_with on
+     * the Stage returned by update(), and the LoopLevel may be a
+     * gpu_blocks loop, in which case the fused stages share one
+     * traversal of the blocks (the fused dims must have matching loop
+     * types on both stages). For example, two update stages that
+     * iterate the same tiles can share block scheduling like this:
+     \code
+     f(x, y) = ...; f(x, y) += ...;
+     g(x, y) = ...; g(x, y) += ...;
+     f.compute_root().gpu_tile(x, y, xi, yi, 8, 8);
+     f.update().gpu_tile(x, y, xi, yi, 8, 8);
+     g.compute_root().gpu_tile(x, y, xi, yi, 8, 8);
+     g.update().gpu_tile(x, y, xi, yi, 8, 8);
+     g.compute_with(f, x);
+     g.update().compute_with(f.update(0), x);
+     \endcode
+     *
      * Given the constraints, this has a variety of uses. Consider the
      * following code:
      \code
@@ -312,6 +350,7 @@ public:
 
     Stage &split(VarOrRVar old, VarOrRVar outer, VarOrRVar inner, Expr factor, TailStrategy tail = TailStrategy::Auto);
     Stage &fuse(VarOrRVar inner, VarOrRVar outer, VarOrRVar fused);
+    Stage &fuse_morton(VarOrRVar inner, VarOrRVar outer, VarOrRVar fused);
     Stage &serial(VarOrRVar var);
     Stage &parallel(VarOrRVar var);
     Stage &vectorize(VarOrRVar var);
@@ -319,6 +358,7 @@ public:
     Stage &parallel(VarOrRVar var, Expr task_size, TailStrategy tail = TailStrategy::Auto);
     Stage &vectorize(VarOrRVar var, Expr factor, TailStrategy tail = TailStrategy::Auto);
     Stage &unroll(VarOrRVar var, Expr factor, TailStrategy tail = TailStrategy::Auto);
+    Stage &unroll_and_jam(VarOrRVar var, Expr factor, TailStrategy tail = TailStrategy::Auto);
     Stage &tile(VarOrRVar x, VarOrRVar y,
                 VarOrRVar xo, VarOrRVar yo,
                 VarOrRVar xi, VarOrRVar yi, Expr
@@ -395,6 +435,8 @@ public:
 
     Stage &allow_race_conditions();
 
+    Stage &atomic();
+
     Stage &hexagon(VarOrRVar x = Var::outermost());
     Stage &prefetch(const Func &f, VarOrRVar var, Expr offset = 1,
                            PrefetchBoundStrategy strategy = PrefetchBoundStrategy::GuardWithIf);
@@ -917,6 +959,12 @@ public:
      */
     void *compile_jit(const Target &target = get_jit_target_from_environment());
 
+    /** Perform every lazy initialization that would otherwise happen
+     * on the first call to realize (jit compilation, worker thread
+     * creation, GPU context creation), so that the first realization
+     * costs the same as the Nth. */
+    void warmup(const Target &target = get_jit_target_from_environment());
+
     /** Set the error handler function that be called in the case of
      * runtime errors during halide pipelines. If you are compiling
      * statically, you can also just define your own function with
@@ -1118,7 +1166,16 @@ public:
     /** Add an extern definition for this Func. This lets you define a
      * Func that represents an external pipeline stage. You can, for
      * example, use it to wrap a call to an extern library such as
-     * fftw. */
+     * fftw.
+     *
+     * By default the extern function receives its buffer arguments as
+     * halide_buffer_t pointers directly; the call costs nothing beyond
+     * the call itself, which matters for small extern stages invoked
+     * many times per frame. Pass uses_old_buffer_t = true only for
+     * callees still written against the legacy buffer_t struct. That
+     * makes Halide generate a wrapper around every call which
+     * translates the shapes to buffer_t and back per invocation, and
+     * requires the legacy_buffer_wrappers target feature. */
     // @{
     void define_extern(const std::string &function_name,
                        const std::vector<ExternFuncArgument> &params,
@@ -1418,6 +1475,20 @@ public:
      * outer dimensions given. */
     Func &fuse(VarOrRVar inner, VarOrRVar outer, VarOrRVar fused);
 
+    /** Join two dimensions into a single fused dimension that is
+     * traversed in Morton (Z-curve) order rather than row-major
+     * order. Successive iterations stay close in both of the
+     * original dimensions at every scale, which gives
+     * cache-oblivious locality for transpose-like access patterns
+     * without picking tile sizes for each level of the memory
+     * hierarchy. The fused loop walks the smallest power-of-two
+     * square enclosing the iteration space and skips the points
+     * outside it, so it is most profitable when the two extents are
+     * similar and the loop body is substantial - e.g. fusing the
+     * tile-index loops of a tiled transpose. Because it reorders
+     * iterations it is only available for pure Vars. */
+    Func &fuse_morton(VarOrRVar inner, VarOrRVar outer, VarOrRVar fused);
+
     /** Mark a dimension to be traversed serially. This is the default. */
     Func &serial(VarOrRVar var);
 
@@ -1459,6 +1530,18 @@ public:
      * dimension of the split. 'factor' must be an integer. */
     Func &unroll(VarOrRVar var, Expr factor, TailStrategy tail = TailStrategy::Auto);
 
+    /** Split a dimension by the given factor, unroll the inner
+     * dimension, then move it innermost, so that the unrolled copies
+     * of the loop body are jammed together. This is the classic
+     * register-blocking transform: a stencil unroll_and_jam'ed over
+     * rows computes several output rows per iteration, and loads
+     * shared between adjacent rows stay in registers instead of being
+     * re-issued. The unrolled dimension stops sinking at any
+     * vectorized dimension, and will not be reordered past another
+     * RVar. After this call, var refers to the outer dimension of the
+     * split. 'factor' must be an integer. */
+    Func &unroll_and_jam(VarOrRVar var, Expr factor, TailStrategy tail = TailStrategy::Auto);
+
     /** Statically declare that the range over which a function should
      * be evaluated is given by the second and third arguments. This
      * can let Halide perform some optimizations. E.g. if you know
@@ -1487,6 +1570,18 @@ public:
      * assertions are injected. */
     Func &align_bounds(Var var, Expr modulus, Expr remainder = 0);
 
+    /** Expand the region computed and allocated for this Func by
+     * 'before' extra elements below the min and 'after' extra
+     * elements above the max of the given dimension, beyond what
+     * consumers require. This allocates intermediates with a halo:
+     * the apron is filled once per realization by this Func's own
+     * definition (e.g. an edge-replicating boundary condition), so
+     * consumers whose stencils stay within the margin can read it
+     * without per-pixel clamping. The region computed always contains
+     * the region that would have been computed without this
+     * directive, so no assertions are injected. */
+    Func &pad_bounds(Var var, Expr before, Expr after);
+
     /** Bound the extent of a Func's realization, but not its
      * min. This means the dimension can be unrolled or vectorized
      * even when its min is not fixed (for example because it is
@@ -1533,6 +1628,15 @@ public:
      * different values at different times or on different machines. */
     Func &allow_race_conditions();
 
+    /** Specify that the update stores of this Func should be lowered
+     * to atomic read-modify-write operations, which makes it safe to
+     * parallelize over the RVars of an associative update (e.g. a
+     * histogram). Only additive updates of the form f(e) = f(e) + v
+     * are currently supported. Atomic updates may be parallelized but
+     * not vectorized. On the CPU integer updates use a native atomic
+     * add and floating-point updates use a compare-and-swap loop; on
+     * CUDA both map to atomic instructions. */
+    Func &atomic();
 
     /** Specialize a Func. This creates a special-case version of the
      * Func where the given condition is true. The most effective
@@ -1697,9 +1801,49 @@ public:
      \endcode
      * When cond is true, this is equivalent to g.compute_at(f,y).
      * When it is false, this is equivalent to g.compute_at(f,x).
+     *
+     * Because stages scheduled inside a Func are included in every
+     * path of its if statement, specializing the output of a pipeline
+     * replicates the entire loop nest, so a single pipeline can carry
+     * several differently-scheduled variants of itself. This is
+     * useful when one schedule does not suit all sizes; for example a
+     * schedule tuned for large frames (wide vectors, big tiles) is
+     * often a poor fit for thumbnails:
+     \code
+     Expr small = output.width() <= 256 && output.height() <= 256;
+     output.specialize(small).vectorize(x, 4);
+     output.tile(x, y, xi, yi, 64, 64).vectorize(xi, 16);  // the large case
+     \endcode
+     * The conditions are tested once per call, in order, at the entry
+     * of the Func's produce node, so selecting a variant costs a
+     * single branch. The price is code size: each specialization
+     * emits another copy of the loop nest, and specializations of
+     * several compute_root Funcs add up, so use a handful of coarse
+     * variants rather than one per size class. Specializations that
+     * can never be reached (a const-false condition, anything after a
+     * const-true condition, or a condition that simplifies to that of
+     * an earlier specialization) are pruned during lowering and cost
+     * nothing.
      */
     Stage specialize(Expr condition);
 
+    /** Add a specialization for the case in which every input buffer
+     * this Func reads is densely laid out (innermost stride one) and
+     * has its host pointer aligned to the given number of bytes,
+     * which must be a power of two. This is equivalent to calling
+     * specialize() with that condition spelled out by hand over each
+     * input, but gathers the inputs automatically, so a pipeline with
+     * many ImageParams doesn't need one dim(0).stride() == 1 clause
+     * per input. Within the specialized branch the innermost strides
+     * are known to be one, so strided loads become dense vector
+     * loads. Returns the specialized Stage, so the fast path can be
+     * scheduled independently:
+     \code
+     f.specialize_on_dense_inputs().vectorize(x, 16);
+     \endcode
+     */
+    Stage specialize_on_dense_inputs(int alignment = 64);
+
     /** Add a specialization to a Func that always terminates execution
      * with a call to halide_error(). By itself, this is of limited use,
      * but can be useful to terminate chains of specialize() calls where
@@ -1884,6 +2028,17 @@ public:
     }
     // @}
 
+    /** Automatically prefetch the inputs this Func reads. During
+     * lowering, a prefetch of each input is inserted at the innermost
+     * serial loop of each of this Func's stages, fetching the region
+     * read a target-tuned number of iterations ahead (further on
+     * Hexagon, where the prefetch latency to be hidden is longer).
+     * Inputs that already have an explicit prefetch() directive on a
+     * stage are left to that directive. This is a convenience for the
+     * common streaming case; use prefetch() directly to pick the loop
+     * level, distance, or bounds strategy by hand. */
+    Func &auto_prefetch();
+
     /** Specify how the storage for the function is laid out. These
      * calls let you specify the nesting order of the dimensions. For
      * example, foo.reorder_storage(y, x) tells Halide to use
@@ -1954,6 +2109,28 @@ public:
      */
     Func &fold_storage(Var dim, Expr extent, bool fold_forward = true);
 
+    /** Store realizations of this function in 2D tiles of the given
+     * size, instead of row-major. Elements within a tile are
+     * contiguous in memory, and tiles are laid out row-major. This
+     * reduces TLB and cache pressure when a large intermediate is
+     * produced row-wise but consumed column-wise (e.g. the transposed
+     * pass of a separable blur), at the cost of a slightly more
+     * expensive addressing computation.
+     *
+     * x and y must be the two innermost storage dimensions, in order;
+     * use reorder_storage first if they are not. The allocated
+     * extents are rounded up to whole tiles. Only supported for
+     * intermediate Funcs - pipeline inputs and outputs have their
+     * layout dictated by their buffers. */
+    Func &tile_storage(Var x, Var y, Expr x_size, Expr y_size);
+
+    /** Store the components of a Tuple-valued function interleaved in
+     * a single allocation (AoS), rather than split into one planar
+     * allocation per component. This is more efficient when consumers
+     * read all of the components of each element together. All
+     * components of the Tuple must have the same type. */
+    Func &interleave_storage();
+
     /** Compute this function as needed for each unique value of the
      * given var for the given calling function f.
      *
@@ -2086,6 +2263,77 @@ public:
      */
     Func &memoize();
 
+    /** As memoize(), but additionally tag every cache entry this Func
+     * produces with the given eviction key, so that groups of entries
+     * can be flushed explicitly with
+     * halide_memoization_cache_evict(user_context, key) (or
+     * Internal::JITSharedRuntime::memoization_cache_evict when
+     * jitting). The key is evaluated at the point the entry is
+     * stored, so it may reference scalar Params; e.g. tagging with a
+     * Param holding a frame or asset id lets entries for one input be
+     * invalidated without flushing the whole cache. The key must be a
+     * scalar integer expression; it is cast to an unsigned 64-bit
+     * value. It does not participate in the cache key itself, so
+     * entries tagged with different keys can still hit each other;
+     * when jitting, any Param it references must also be used
+     * elsewhere in the pipeline for argument inference to find it. */
+    Func &memoize(const Expr &eviction_key);
+
+    /** Only compute this Func when the given condition is true,
+     * leaving its values undefined where the condition is false. The
+     * condition is evaluated once per realization, at the loop level
+     * where the Func is computed, so with compute_at it becomes a
+     * per-tile test. It may reference Vars of the enclosing loops (by
+     * suffix, as with compute_at), params, and calls to Funcs or
+     * images produced outside this Func's realization -- e.g. a cheap
+     * mask sampled at the tile coordinates:
+     *
+     \code
+     out(x, y) = select(mask(x/8, y/8) != 0, heavy(x, y), 0.0f);
+     out.tile(x, y, xo, yo, xi, yi, 8, 8);
+     heavy.compute_at(out, xo).compute_if(mask(xo, yo) != 0);
+     \endcode
+     *
+     * The tiles where the mask is zero skip the computation of heavy
+     * entirely (and producers used only by heavy are skipped with it,
+     * by the same analysis that drives automatic stage skipping). It
+     * is up to you to ensure that consumers only read values for
+     * which the condition held; reads of skipped regions see
+     * uninitialized memory. */
+    Func &compute_if(Expr condition);
+
+    /** Produce this Func asynchronously on its own task, overlapped
+     * with the stages that consume it. The producer and consumer are
+     * synchronized with a pair of semaphores so that the producer
+     * runs at most one fold of the storage ahead of the consumer;
+     * combined with store_at/compute_at and storage folding this
+     * gives double-buffered (ring-buffered) execution. When giving an
+     * explicit fold factor with fold_storage, leave one fold of slack
+     * for the producer to work in. Requires the pipeline to run with
+     * at least two threads, since the producer and the consumer block
+     * waiting on each other. */
+    Func &async();
+
+    /** Allocate two copies of this Func's storage, and make each
+     * iteration of the enclosing serial loop produce into one copy
+     * while consuming from the other. Intended for Funcs staged into
+     * GPU shared memory inside a serial loop (e.g. the tiles of a
+     * matrix multiply): dropping the end-of-iteration barrier lets
+     * threads that finish consuming a tile early begin loading the
+     * next one, overlapping global memory loads with compute. The
+     * Func must be stored inside gpu_blocks and produced inside a
+     * serial loop below its storage level. */
+    Func &double_buffer();
+
+    /** Keep all floating-point math in this Func's definitions
+     * strict: no reassociation, FMA contraction, or approximate
+     * transcendentals during codegen, so results are bit-exact and
+     * reproducible across targets. Other Funcs in the pipeline are
+     * unaffected and still get relaxed floating-point codegen. This is
+     * the per-Func counterpart of the Target::StrictFloat feature,
+     * useful when one numerically sensitive stage must stay exact
+     * without giving up fast math everywhere else. */
+    Func &strict_float();
 
     /** Allocate storage for this function within f's loop over
      * var. Scheduling storage is optional, and can be used to
@@ -2196,6 +2444,45 @@ public:
      * outside the outermost loop. */
     Func &store_root();
 
+    /** Hoist this function's allocation to the site immediately
+     * inside the given loop of f, while leaving the storage layout
+     * and lifetime semantics at the store_at/compute_at site. The
+     * hoisted allocation is sized to an upper bound of the sizes
+     * needed across the iterations it now spans, so a Func computed
+     * per tile stops paying an allocate/free per tile:
+     *
+     \code
+     Func f, g;
+     Var x, y, xo, yo, xi, yi;
+     g(x, y) = x*y;
+     f(x, y) = g(x, y) + g(x+1, y+1);
+     f.tile(x, y, xo, yo, xi, yi, 64, 64).parallel(yo);
+     g.compute_at(f, xo).hoist_storage(f, yo);
+     \endcode
+     *
+     * Here g is still computed (and its region still inferred) per
+     * tile, but the buffer backing it is allocated once per yo
+     * iteration and reused across that row of tiles; under the
+     * parallel yo loop each thread task gets its own instance. This
+     * differs from store_at(f, yo), which would size the buffer to
+     * hold the whole row at once and enable sliding-window reuse of
+     * its contents.
+     *
+     * The destination loop must enclose the allocation site and
+     * hoisting may not cross an intervening parallel loop (the
+     * instances would be shared between threads). Allocations with a
+     * custom allocator expression (e.g. from Func::memoize) cannot be
+     * hoisted. */
+    // @{
+    Func &hoist_storage(Func f, Var var);
+    Func &hoist_storage(Func f, RVar var);
+    Func &hoist_storage(LoopLevel loop_level);
+    // @}
+
+    /** Equivalent to \ref Func::hoist_storage, but hoists the
+     * allocation outside the outermost loop. */
+    Func &hoist_storage_root();
+
     /** Aggressively inline all uses of this function. This is the
      * default schedule, so you're unlikely to need to call this. For
      * a Func with an update definition, that means it gets computed
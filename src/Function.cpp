@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <set>
@@ -14,6 +15,7 @@
 #include "ParallelRVar.h"
 #include "Random.h"
 #include "Scope.h"
+#include "ThreadPool.h"
 #include "Var.h"
 
 namespace Halide {
@@ -309,12 +311,13 @@ ExternFuncArgument deep_copy_extern_func_argument_helper(
         return copy;
     }
 
-    // If the FunctionContents has already been deep-copied previously, i.e.
-    // it's in the 'copied_map', use the deep-copied version from the map instead
-    // of creating a new deep-copy
-    FunctionPtr &copied_func = copied_map[src.func];
-    internal_assert(copied_func.defined());
-    copy.func = copied_func;
+    // The FunctionContents must already have a deep-copy registered in
+    // the 'copied_map'; use it instead of creating a new deep-copy. A
+    // find() rather than operator[] so that concurrent deep-copies
+    // never mutate the map (see the pipeline-level deep_copy below).
+    auto iter = copied_map.find(src.func);
+    internal_assert(iter != copied_map.end() && iter->second.defined());
+    copy.func = iter->second;
     return copy;
 }
 
@@ -323,8 +326,13 @@ void Function::deep_copy(FunctionPtr copy, DeepCopyMap &copied_map) const {
         << "Cannot deep-copy undefined Function\n";
 
     // Add reference to this Function's deep-copy to the map in case of
-    // self-reference, e.g. self-reference in an Definition.
-    copied_map[contents] = copy;
+    // self-reference, e.g. self-reference in an Definition. The
+    // pipeline-level deep_copy below pre-registers every copy and runs
+    // the per-Function copies in parallel, so don't touch the map if
+    // the entry is already there.
+    if (copied_map.count(contents) == 0) {
+        copied_map[contents] = copy;
+    }
 
     debug(4) << "Deep-copy function contents: \"" << contents->name << "\"\n";
 
@@ -912,6 +920,7 @@ void Function::lock_loop_levels() {
     auto &schedule = contents->func_schedule;
     schedule.compute_level().lock();
     schedule.store_level().lock();
+    schedule.hoist_storage_level().lock();
     // If store_level is inlined, use the compute_level instead.
     // (Note that we deliberately do *not* do the same if store_level
     // is undefined.)
@@ -1051,15 +1060,52 @@ pair<vector<Function>, map<string, Function>> deep_copy(
         i++;
     }
 
-    // Deep copy all Functions in 'env' into their corresponding empty copies
+    // Deep copy all Functions in 'env' into their corresponding empty
+    // copies, then substitute-in all old Function references in all
+    // Exprs referenced within the Function with the deep-copy
+    // versions. With every copy pre-registered above, each Function
+    // only reads 'copied_map' and writes its own copy, and IR nodes
+    // are immutable with atomic ref-counts, so the per-Function work
+    // is independent and can run in parallel. Pipelines with many
+    // Funcs spend real time here, so farm it out.
+    vector<std::function<void()>> jobs;
     for (const auto &iter : env) {
-        iter.second.deep_copy(copied_map[iter.second.get_contents()], copied_map);
-    }
-
-    // Need to substitute-in all old Function references in all Exprs referenced
-    // within the Function with the deep-copy versions
-    for (auto &iter : copied_map) {
-        Function(iter.second).substitute_calls(copied_map);
+        const Function &func = iter.second;
+        FunctionPtr copy = copied_map[func.get_contents()];
+        jobs.push_back([func, copy, &copied_map]() {
+            func.deep_copy(copy, copied_map);
+            Function(copy).substitute_calls(copied_map);
+        });
+    }
+
+    size_t num_threads = std::min(jobs.size(), ThreadPool<void>::num_processors_online());
+    if (num_threads > 1) {
+        ThreadPool<void> pool(num_threads);
+        vector<std::future<void>> futures;
+        vector<std::exception_ptr> errors(jobs.size());
+        for (size_t i = 0; i < jobs.size(); i++) {
+            futures.push_back(pool.async([&jobs, &errors, i]() {
+                // The ThreadPool doesn't forward exceptions out of
+                // worker threads, so stash them and rethrow below.
+                try {
+                    jobs[i]();
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            }));
+        }
+        for (auto &f : futures) {
+            f.wait();
+        }
+        for (const auto &e : errors) {
+            if (e) {
+                std::rethrow_exception(e);
+            }
+        }
+    } else {
+        for (auto &job : jobs) {
+            job();
+        }
     }
 
     // Populate the env with the deep-copy version
@@ -4,6 +4,7 @@
 #include "Bounds.h"
 #include "CSE.h"
 #include "CodeGen_GPU_Dev.h"
+#include "DoubleBuffering.h"
 #include "ExprUsesVar.h"
 #include "FuseGPUThreadLoops.h"
 #include "IR.h"
@@ -42,11 +43,25 @@ class InjectThreadBarriers : public IRMutator2 {
                                           op->for_type == ForType::GPULane));
 
         if (op->for_type == ForType::Serial) {
-            Stmt body = mutate(op->body);
+            // Double-buffered loops leave a marker as their first
+            // statement. Each iteration writes the half of the
+            // storage that the next iteration reads from, so the
+            // end-of-iteration barrier can be omitted, letting
+            // threads that finish consuming early start producing the
+            // next iteration's half.
+            Stmt old_body = op->body;
+            bool double_buffered = false;
+            if (const Block *b = old_body.as<Block>()) {
+                if (is_double_buffer_marker(b->first)) {
+                    double_buffered = true;
+                    old_body = b->rest;
+                }
+            }
+            Stmt body = mutate(old_body);
             // Serial for loops at the block level with internal
             // synchronization also need synchronization after each
             // loop iteration.
-            if (!in_threads && !body.same_as(op->body)) {
+            if (!in_threads && !double_buffered && !body.same_as(old_body)) {
                 body = Block::make(body, barrier);
             }
             return For::make(op->name, op->min, op->extent,
@@ -74,6 +89,21 @@ public:
     }
 };
 
+// If there's no loop over threads in a kernel, InjectThreadBarriers
+// doesn't run, so any double-buffer markers must be removed here
+// instead.
+class StripDoubleBufferMarkers : public IRMutator2 {
+    using IRMutator2::visit;
+
+    Stmt visit(const Block *op) override {
+        if (is_double_buffer_marker(op->first)) {
+            return mutate(op->rest);
+        } else {
+            return IRMutator2::visit(op);
+        }
+    }
+};
+
 
 class ExtractBlockSize : public IRVisitor {
     Expr block_extent[4];
@@ -775,6 +805,8 @@ class FuseGPUThreadLoopsSingleKernel : public IRMutator2 {
                 // If there's no loop over threads, everything is already synchronous.
                 InjectThreadBarriers i;
                 body = i.mutate(body);
+            } else {
+                body = StripDoubleBufferMarkers().mutate(body);
             }
 
             debug(3) << "Injected synchronization:\n" << body << "\n\n";
@@ -1,10 +1,14 @@
 #include <cmath>
+#include <cstring>
 #include <fstream>
+#include <iostream>
 #include <set>
 
 #include "Generator.h"
+#include "LLVM_Output.h"
 #include "Outputs.h"
 #include "Simplify.h"
+#include "ThreadPool.h"
 
 namespace Halide {
 
@@ -767,13 +771,156 @@ std::string halide_type_to_c_type(const Type &t) {
     return m.at(encode(t));
 }
 
-int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
-    const char kUsage[] = "gengen [-g GENERATOR_NAME] [-f FUNCTION_NAME] [-o OUTPUT_DIR] [-r RUNTIME_NAME] [-e EMIT_OPTIONS] [-x EXTENSION_OPTIONS] [-n FILE_BASE_NAME] "
+namespace {
+
+// One axis of a -p variant matrix: a GeneratorParam name and the values
+// it takes.
+using VariantAxis = std::pair<std::string, std::vector<std::string>>;
+
+// Build the cross product of the -p axes and compile one variant of the
+// generator per combination, all in this one invocation. This mirrors
+// compile_multitarget, but over GeneratorParam values rather than
+// targets: the generator front end runs serially per variant
+// (generators may not be re-entrant), while the LLVM codegen for each
+// variant -- the bulk of the work -- is farmed out to a thread pool,
+// sharing a single process's LLVM initialization. Each combination gets
+// the function name suffixed with its parameter values, and the objects
+// are combined into one static library together with a single shared
+// runtime.
+void compile_variant_matrix(const std::string &generator_name,
+                            const std::string &function_name,
+                            const std::string &base_path,
+                            const Target &target,
+                            const GeneratorParamsMap &generator_args,
+                            const std::vector<VariantAxis> &variant_axes,
+                            const GeneratorBase::EmitOptions &emit_options) {
+    // Expand the cross product, axes in declaration order.
+    std::vector<GeneratorParamsMap> combinations(1);
+    std::vector<std::string> suffixes(1);
+    for (const VariantAxis &axis : variant_axes) {
+        std::vector<GeneratorParamsMap> next_combinations;
+        std::vector<std::string> next_suffixes;
+        for (size_t i = 0; i < combinations.size(); i++) {
+            for (const std::string &value : axis.second) {
+                GeneratorParamsMap c = combinations[i];
+                c[axis.first] = value;
+                next_combinations.push_back(c);
+                // Suffix each variant with its values, sanitized to
+                // keep the function name a valid C identifier.
+                std::string s = suffixes[i] + "_";
+                for (char ch : value) {
+                    s += isalnum(ch) ? ch : '_';
+                }
+                next_suffixes.push_back(s);
+            }
+        }
+        combinations.swap(next_combinations);
+        suffixes.swap(next_suffixes);
+    }
+
+    // The variants share one runtime (emitted below), unless the caller
+    // asked for no runtime at all.
+    const bool shared_runtime = emit_options.emit_static_library &&
+                                !target.has_feature(Target::NoRuntime);
+    const Target sub_target = target.with_feature(Target::NoRuntime);
+
+    GeneratorBase::EmitOptions sub_options = emit_options;
+    sub_options.emit_static_library = false;
+    // Objects are needed to assemble the library; only keep them around
+    // if they were requested explicitly.
+    const bool keep_objects = emit_options.emit_o;
+    sub_options.emit_o = keep_objects || emit_options.emit_static_library;
+
+    ThreadPool<void> compile_pool(std::min(combinations.size(),
+                                           ThreadPool<void>::num_processors_online()));
+    std::vector<std::future<void>> sub_compiles;
+    std::vector<std::exception_ptr> sub_compile_errors(combinations.size());
+    std::vector<std::string> object_files;
+
+    for (size_t i = 0; i < combinations.size(); i++) {
+        GeneratorParamsMap sub_args = generator_args;
+        sub_args.erase("target");
+        for (const auto &kv : combinations[i]) {
+            sub_args[kv.first] = kv.second;
+        }
+        const std::string sub_fn_name = function_name + suffixes[i];
+        auto gen = GeneratorRegistry::create(generator_name, GeneratorContext(sub_target));
+        gen->set_generator_param_values(sub_args);
+        Module sub_module = gen->build_module(sub_fn_name);
+
+        Outputs sub_out = compute_outputs(sub_target, base_path + suffixes[i], sub_options);
+        if (!sub_out.object_name.empty()) {
+            object_files.push_back(sub_out.object_name);
+        }
+        debug(1) << "compile_variant_matrix: compile_variant " << sub_fn_name << "\n";
+        auto compile_job = [](Module m, Outputs o, std::exception_ptr *error) {
+            try {
+                m.compile(o);
+            } catch (...) {
+                *error = std::current_exception();
+            }
+        };
+        sub_compiles.push_back(
+            compile_pool.async(compile_job, sub_module, sub_out, &sub_compile_errors[i]));
+    }
+    for (auto &sc : sub_compiles) {
+        sc.wait();
+    }
+    for (const auto &e : sub_compile_errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+
+    if (emit_options.emit_static_library) {
+        std::string runtime_object;
+        if (shared_runtime) {
+            const bool is_windows_coff = target.os == Target::Windows &&
+                                         !target.has_feature(Target::MinGW);
+            runtime_object = base_path + "_shared_runtime" +
+                             get_extension(is_windows_coff ? ".obj" : ".o", emit_options);
+            compile_standalone_runtime(runtime_object, target);
+            object_files.push_back(runtime_object);
+        }
+        Outputs lib_out = compute_outputs(target, base_path, emit_options);
+        create_static_library(object_files, target, lib_out.static_library_name);
+        if (!keep_objects) {
+            for (const auto &o : object_files) {
+                file_unlink(o);
+            }
+        } else if (!runtime_object.empty()) {
+            file_unlink(runtime_object);
+        }
+    }
+}
+
+int generate_filter_main_inner(int argc, char **argv, std::ostream &cerr) {
+    const char kUsage[] = "gengen [-g GENERATOR_NAME] [-f FUNCTION_NAME] [-o OUTPUT_DIR] [-r RUNTIME_NAME] [-e EMIT_OPTIONS] [-x EXTENSION_OPTIONS] [-n FILE_BASE_NAME] [-m MULTI_ISA] [-p VARIANT_MATRIX] [-b BATCH_FILE] "
                           "target=target-string[,target-string...] [generator_arg=value [...]]\n\n"
                           "  -e  A comma separated list of files to emit. Accepted values are "
                           "[assembly, bitcode, cpp, h, html, o, static_library, stmt, cpp_stub, schedule]. If omitted, default value is [static_library, h].\n"
                           "  -x  A comma separated list of file extension pairs to substitute during file naming, "
-                          "in the form [.old=.new[,.old2=.new2]]\n";
+                          "in the form [.old=.new[,.old2=.new2]]\n"
+                          "  -m  A comma separated list of x86 vector ISAs ([sse41, avx2, avx512], or "
+                          "'all' for all of them). A variant of the pipeline is compiled for each, "
+                          "sharing a single copy of the runtime, and wrapped in a dispatcher that "
+                          "picks the best variant for the host cpu at runtime. The single target "
+                          "given is used as the fallback variant and for the shared runtime.\n"
+                          "  -p  A semicolon separated list of GeneratorParam axes, each in the "
+                          "form name=value[,value...]. The cross product of all axes is compiled "
+                          "in this one invocation: each combination gets the function name "
+                          "suffixed with its parameter values, the variants are compiled on "
+                          "parallel worker threads sharing one LLVM initialization, and the "
+                          "static library combines all of them plus a single shared runtime "
+                          "(one header is emitted per variant).\n"
+                          "  -b  A file containing one compile request per line (or '-' to stream "
+                          "requests from stdin). Each line holds the arguments that would otherwise "
+                          "be passed for a single invocation; any other flags given on the command "
+                          "line are prepended to every request. All requests run in this one process, "
+                          "amortizing process startup and LLVM initialization across the batch. "
+                          "After each request a status line ('OK' or 'ERR <code>') is written to "
+                          "stdout and flushed, so a build system can drive a warm process "
+                          "interactively over a pipe.\n";
 
     std::map<std::string, std::string> flags_info = { { "-f", "" },
                                                       { "-g", "" },
@@ -781,7 +928,9 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
                                                       { "-e", "" },
                                                       { "-n", "" },
                                                       { "-x", "" },
-                                                      { "-r", "" }};
+                                                      { "-r", "" },
+                                                      { "-m", "" },
+                                                      { "-p", "" }};
     GeneratorParamsMap generator_args;
 
     for (int i = 1; i < argc; ++i) {
@@ -915,6 +1064,92 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
         targets.push_back(Target(s));
     }
 
+    const std::string multi_isa = flags_info["-m"];
+    if (!multi_isa.empty()) {
+        if (targets.size() != 1) {
+            cerr << "Only one baseline target may be specified when using -m.\n";
+            cerr << kUsage;
+            return 1;
+        }
+        const Target &base = targets[0];
+        if (base.arch != Target::X86) {
+            cerr << "-m is only supported for x86 targets.\n";
+            return 1;
+        }
+        std::vector<std::string> isas = split_string(multi_isa, ",");
+        if (isas.size() == 1 && isas[0] == "all") {
+            isas = {"sse41", "avx2", "avx512"};
+        }
+        bool use_sse41 = false, use_avx2 = false, use_avx512 = false;
+        for (const std::string &isa : isas) {
+            if (isa == "sse41") {
+                use_sse41 = true;
+            } else if (isa == "avx2") {
+                use_avx2 = true;
+            } else if (isa == "avx512") {
+                use_avx512 = true;
+            } else {
+                cerr << "Unrecognized -m option: " << isa << " not one of [sse41, avx2, avx512, all].\n";
+                cerr << kUsage;
+                return 1;
+            }
+        }
+        // The dispatcher tries variants in the order given, so list the
+        // widest first; the final target is the baseline, which is also
+        // used for the shared runtime.
+        const Target sse41_target = base.with_feature(Target::SSE41);
+        const Target avx2_target = sse41_target
+            .with_feature(Target::AVX)
+            .with_feature(Target::AVX2)
+            .with_feature(Target::FMA);
+        const Target avx512_target = avx2_target
+            .with_feature(Target::AVX512)
+            .with_feature(Target::AVX512_Skylake);
+        targets.clear();
+        if (use_avx512) {
+            targets.push_back(avx512_target);
+        }
+        if (use_avx2) {
+            targets.push_back(avx2_target);
+        }
+        if (use_sse41) {
+            targets.push_back(sse41_target);
+        }
+        targets.push_back(base);
+    }
+
+    const std::string variant_matrix = flags_info["-p"];
+    std::vector<VariantAxis> variant_axes;
+    if (!variant_matrix.empty()) {
+        for (const std::string &axis : split_string(variant_matrix, ";")) {
+            if (axis.empty()) {
+                continue;
+            }
+            auto axis_pair = split_string(axis, "=");
+            if (axis_pair.size() != 2 || axis_pair[0].empty() || axis_pair[1].empty()) {
+                cerr << "Malformed -p axis: " << axis << "\n";
+                cerr << kUsage;
+                return 1;
+            }
+            if (axis_pair[0] == "target") {
+                cerr << "-p cannot vary the target; use -m or a multitarget string instead.\n";
+                cerr << kUsage;
+                return 1;
+            }
+            variant_axes.push_back({axis_pair[0], split_string(axis_pair[1], ",")});
+        }
+        if (variant_axes.empty()) {
+            cerr << "-p requires at least one axis.\n";
+            cerr << kUsage;
+            return 1;
+        }
+        if (targets.size() != 1 || !multi_isa.empty()) {
+            cerr << "Only one target may be specified when using -p.\n";
+            cerr << kUsage;
+            return 1;
+        }
+    }
+
     if (!runtime_name.empty()) {
         if (targets.size() != 1) {
             cerr << "Only one target allowed here";
@@ -947,7 +1182,11 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
                     gen->set_generator_param_values(sub_generator_args);
                     return gen->build_module(name);
                 };
-            if (targets.size() > 1 || !emit_options.substitutions.empty()) {
+            if (!variant_axes.empty()) {
+                compile_variant_matrix(generator_name, function_name, base_path,
+                                       targets[0], generator_args, variant_axes,
+                                       emit_options);
+            } else if (targets.size() > 1 || !emit_options.substitutions.empty()) {
                 compile_multitarget(function_name, output_files, targets, module_producer, emit_options.substitutions);
             } else {
                 user_assert(emit_options.substitutions.empty()) << "substitutions not supported for single-target";
@@ -961,6 +1200,75 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
     return 0;
 }
 
+}  // namespace
+
+int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
+    // Peel off a -b flag (if present) before handing the arguments to the
+    // usual single-request path. In batch mode we loop over the requests
+    // here rather than once-per-process, so the (substantial) fixed cost
+    // of process startup and LLVM target/pass initialization is paid once
+    // for the whole batch instead of once per generator invocation.
+    std::string batch_file;
+    std::vector<char *> common_argv;
+    for (int i = 0; i < argc; ++i) {
+        if (i > 0 && !strcmp(argv[i], "-b")) {
+            if (i + 1 >= argc) {
+                cerr << "-b requires an argument\n";
+                return 1;
+            }
+            batch_file = argv[i + 1];
+            ++i;
+            continue;
+        }
+        common_argv.push_back(argv[i]);
+    }
+
+    if (batch_file.empty()) {
+        return generate_filter_main_inner(argc, argv, cerr);
+    }
+
+    std::ifstream batch_stream;
+    if (batch_file != "-") {
+        batch_stream.open(batch_file);
+        if (!batch_stream) {
+            cerr << "Unable to open batch file: " << batch_file << "\n";
+            return 1;
+        }
+    }
+    std::istream &in = (batch_file == "-") ? std::cin : batch_stream;
+
+    int result = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        // Skip blank lines and comments so a build system can annotate
+        // the request file.
+        std::vector<std::string> tokens;
+        for (const std::string &t : split_string(line, " ")) {
+            if (!t.empty()) {
+                tokens.push_back(t);
+            }
+        }
+        if (tokens.empty() || tokens[0][0] == '#') {
+            continue;
+        }
+
+        // Flags given on the command line proper act as defaults shared
+        // by every request (e.g. a common -o or -e).
+        std::vector<char *> request_argv = common_argv;
+        for (std::string &t : tokens) {
+            request_argv.push_back(&t[0]);
+        }
+        int r = generate_filter_main_inner((int) request_argv.size(), request_argv.data(), cerr);
+        if (r != 0) {
+            result = r;
+            std::cout << "ERR " << r << std::endl;
+        } else {
+            std::cout << "OK" << std::endl;
+        }
+    }
+    return result;
+}
+
 GeneratorParamBase::GeneratorParamBase(const std::string &name) : name(name) {
     ObjectInstanceRegistry::register_instance(this, 0, ObjectInstanceRegistry::GeneratorParam,
                                               this, nullptr);
@@ -1379,6 +1687,20 @@ Module GeneratorBase::build_module(const std::string &function_name,
         auto_schedule_result = pipeline.auto_schedule(get_target(), get_machine_params());
     }
 
+    // Hooks for external schedule search tools (see util/HalideTuner.cpp):
+    // HL_APPLY_SCHEDULE replaces the schedule with one written by
+    // save_schedule before compiling, and HL_SAVE_SCHEDULE writes out the
+    // schedule actually used. Applying happens first so that a saved
+    // schedule reflects what was compiled.
+    std::string apply_schedule_file = get_env_variable("HL_APPLY_SCHEDULE");
+    if (!apply_schedule_file.empty()) {
+        pipeline.apply_schedule(apply_schedule_file);
+    }
+    std::string save_schedule_file = get_env_variable("HL_SAVE_SCHEDULE");
+    if (!save_schedule_file.empty()) {
+        pipeline.save_schedule(save_schedule_file);
+    }
+
     // Special-case here: for certain legacy Generators, building the pipeline
     // can mutate the Params/ImageParams (mainly, to customize the type/dim
     // of an ImageParam based on a GeneratorParam); to handle these, we discard (and rebuild)
@@ -1,6 +1,8 @@
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <sstream>
 
 #include "Closure.h"
 #include "Elf.h"
@@ -1017,44 +1019,93 @@ Buffer<uint8_t> compile_module_to_hexagon_shared_object(const Module &device_cod
 
     std::string signer = get_env_variable("HL_HEXAGON_CODE_SIGNER");
     if (!signer.empty()) {
-        // If signer is specified, shell out to a tool/script that will
-        // sign the Hexagon code in a specific way. The tool is expected
-        // to be of the form
-        //
-        //     signer /path/to/unsigned.so /path/to/signed.so
-        //
-        // where unsigned and signed paths must not be the same file.
-        // If the signed file already exists, it will be overwritten.
-
-        TemporaryFile input("hvx_unsigned", ".so");
-        TemporaryFile output("hvx_signed", ".so");
-
-        debug(1) << "Signing Hexagon code: " << input.pathname() << " -> " << output.pathname() << "\n";
-
-        {
-            std::ofstream f(input.pathname());
-            f.write(shared_object.data(), shared_object.size());
-            f.flush();
-            internal_assert(f.good());
-            f.close();
+        // Signing can shell out to slow external services, so if a
+        // cache directory is specified, look for an already-signed
+        // copy of this object first, keyed by a hash of the unsigned
+        // bytes. This saves seconds of startup when the same pipeline
+        // is signed again in a later process.
+        std::string cache_dir = get_env_variable("HL_HEXAGON_CODE_SIGNER_CACHE");
+        std::string cache_path;
+        bool signed_from_cache = false;
+        if (!cache_dir.empty()) {
+            uint64_t hash = 0xcbf29ce484222325ULL;
+            for (char c : shared_object) {
+                hash ^= (uint8_t)c;
+                hash *= 0x100000001b3ULL;
+            }
+            std::ostringstream key;
+            key << std::hex << hash;
+            cache_path = cache_dir + "/halide_hvx_signed_" + key.str() + ".so";
+
+            std::ifstream f(cache_path);
+            if (f.good()) {
+                f.seekg(0, std::ifstream::end);
+                size_t signed_size = f.tellg();
+                std::vector<char> cached(signed_size);
+                f.seekg(0, std::ifstream::beg);
+                f.read(cached.data(), cached.size());
+                if (f.good()) {
+                    shared_object.swap(cached);
+                    signed_from_cache = true;
+                    debug(1) << "Using cached signed Hexagon code: " << cache_path << "\n";
+                }
+            }
         }
 
-        debug(1) << "Signing tool: (" << signer << ")\n";
-        std::string cmd = signer + " " + input.pathname() + " " + output.pathname();
-        int result = system(cmd.c_str());
-        internal_assert(result == 0)
-            << "HL_HEXAGON_CODE_SIGNER failed: result = " << result
-            << " for cmd (" << cmd << ")";
-
-        {
-            std::ifstream f(output.pathname());
-            f.seekg(0, std::ifstream::end);
-            size_t signed_size = f.tellg();
-            shared_object.resize(signed_size);
-            f.seekg(0, std::ifstream::beg);
-            f.read(shared_object.data(), shared_object.size());
-            internal_assert(f.good());
-            f.close();
+        if (!signed_from_cache) {
+            // If signer is specified, shell out to a tool/script that will
+            // sign the Hexagon code in a specific way. The tool is expected
+            // to be of the form
+            //
+            //     signer /path/to/unsigned.so /path/to/signed.so
+            //
+            // where unsigned and signed paths must not be the same file.
+            // If the signed file already exists, it will be overwritten.
+
+            TemporaryFile input("hvx_unsigned", ".so");
+            TemporaryFile output("hvx_signed", ".so");
+
+            debug(1) << "Signing Hexagon code: " << input.pathname() << " -> " << output.pathname() << "\n";
+
+            {
+                std::ofstream f(input.pathname());
+                f.write(shared_object.data(), shared_object.size());
+                f.flush();
+                internal_assert(f.good());
+                f.close();
+            }
+
+            debug(1) << "Signing tool: (" << signer << ")\n";
+            std::string cmd = signer + " " + input.pathname() + " " + output.pathname();
+            int result = system(cmd.c_str());
+            internal_assert(result == 0)
+                << "HL_HEXAGON_CODE_SIGNER failed: result = " << result
+                << " for cmd (" << cmd << ")";
+
+            {
+                std::ifstream f(output.pathname());
+                f.seekg(0, std::ifstream::end);
+                size_t signed_size = f.tellg();
+                shared_object.resize(signed_size);
+                f.seekg(0, std::ifstream::beg);
+                f.read(shared_object.data(), shared_object.size());
+                internal_assert(f.good());
+                f.close();
+            }
+
+            if (!cache_path.empty()) {
+                // Write through a temporary and rename, so a
+                // concurrent compilation never reads a partial file.
+                std::string tmp_path = cache_path + ".tmp";
+                std::ofstream f(tmp_path);
+                f.write(shared_object.data(), shared_object.size());
+                f.flush();
+                f.close();
+                if (f.good()) {
+                    std::rename(tmp_path.c_str(), cache_path.c_str());
+                    debug(1) << "Cached signed Hexagon code: " << cache_path << "\n";
+                }
+            }
         }
     }
 
@@ -1612,6 +1612,325 @@ public:
     OptimizeShuffles(int lut_alignment) : lut_alignment(lut_alignment) {}
 };
 
+// Convert indirect loads from buffers in VTCM into vgather
+// intrinsics, and indirect stores to buffers in VTCM into vscatter
+// intrinsics (v65 and later). vlut is a better fit for small LUTs,
+// so this runs before OptimizeShuffles and only claims accesses that
+// touch VTCM; whatever it leaves behind can still become a vlut or
+// fall back to scalar code.
+class ScatterGatherGenerator : public IRMutator2 {
+    int native_bits;
+
+    // The constant size in bytes of each VTCM allocation in scope.
+    Scope<int32_t> vtcm_allocations;
+
+    using IRMutator2::visit;
+
+    Stmt visit(const Allocate *op) override {
+        int32_t size = op->constant_allocation_size();
+        if (op->memory_type == MemoryType::VTCM && size > 0) {
+            ScopedBinding<int32_t> bind(vtcm_allocations, op->name,
+                                        size * op->type.bytes());
+            return IRMutator2::visit(op);
+        }
+        return IRMutator2::visit(op);
+    }
+
+    // vgather/vscatter operate on a single native vector of 16 or 32
+    // bit elements. Other types have to take the existing paths.
+    bool is_native_gather_type(Type t) const {
+        return t.is_vector() &&
+               (t.bits() == 16 || t.bits() == 32) &&
+               t.bits() * t.lanes() == native_bits;
+    }
+
+    // Make the vector of byte offsets for a gather/scatter of
+    // elements of the given type, or an undefined Expr if the
+    // offsets can't be expressed at the width the instruction
+    // requires.
+    Expr make_byte_offsets(Type type, Expr index, int32_t size_bytes) {
+        if (type.bits() == 16) {
+            // Halfword gathers/scatters take the offsets as unsigned
+            // halfwords, so the buffer must fit in 64 KB.
+            if (size_bytes > 65536) {
+                return Expr();
+            }
+            return simplify(cast(UInt(16, index.type().lanes()), index * 2));
+        } else {
+            return simplify(index * 4);
+        }
+    }
+
+    Expr make_buffer(const string &name) {
+        return Variable::make(Handle(), name);
+    }
+
+    Stmt visit(const Store *op) override {
+        if (!is_one(op->predicate)) {
+            return IRMutator2::visit(op);
+        }
+        Type type = op->value.type();
+        if (!is_native_gather_type(type)) {
+            return IRMutator2::visit(op);
+        }
+
+        if (vtcm_allocations.contains(op->name) &&
+            op->index.type().is_vector() && !op->index.as<Ramp>()) {
+            Stmt scatter = make_scatter(op);
+            if (scatter.defined()) {
+                return scatter;
+            }
+        }
+
+        // A store of an indirect load, where both buffers live in
+        // VTCM and the store is a dense aligned vector, can gather
+        // straight into the destination.
+        const Ramp *ramp = op->index.as<Ramp>();
+        const Load *load = op->value.as<Load>();
+        if (ramp && load && is_one(ramp->stride) &&
+            is_one(load->predicate) &&
+            load->index.type().is_vector() && !load->index.as<Ramp>() &&
+            vtcm_allocations.contains(op->name) &&
+            vtcm_allocations.contains(load->name) &&
+            // The gather writes the destination with an aligned
+            // vector store, so the store must be vector aligned.
+            can_prove(ramp->base % ramp->lanes == 0)) {
+            int32_t size = vtcm_allocations.get(load->name);
+            Expr offsets = make_byte_offsets(type, mutate(load->index), size);
+            if (offsets.defined()) {
+                Expr gather = Call::make(type, "gather",
+                                         {make_buffer(op->name), ramp->base,
+                                          make_buffer(load->name), size - 1, offsets},
+                                         Call::Intrinsic);
+                return Evaluate::make(gather);
+            }
+        }
+        return IRMutator2::visit(op);
+    }
+
+    Stmt make_scatter(const Store *op) {
+        Type type = op->value.type();
+        int32_t size = vtcm_allocations.get(op->name);
+        Expr index = mutate(op->index);
+        Expr value = mutate(op->value);
+
+        // Recognize scatter-accumulates: storing a value added to a
+        // load of the same buffer at the same indices. Note that, as
+        // with any vectorized impure update, lanes with colliding
+        // indices were already unordered before we got here.
+        string intrin = "scatter";
+        const Add *add = value.as<Add>();
+        if (add) {
+            const Load *load_a = add->a.as<Load>();
+            const Load *load_b = add->b.as<Load>();
+            if (load_a && load_a->name == op->name &&
+                is_one(load_a->predicate) && equal(load_a->index, index)) {
+                intrin = "scatter_acc";
+                value = add->b;
+            } else if (load_b && load_b->name == op->name &&
+                       is_one(load_b->predicate) && equal(load_b->index, index)) {
+                intrin = "scatter_acc";
+                value = add->a;
+            }
+        }
+
+        Expr offsets = make_byte_offsets(type, index, size);
+        if (!offsets.defined()) {
+            return Stmt();
+        }
+        Expr scatter = Call::make(type, intrin,
+                                  {make_buffer(op->name), size - 1, offsets, value},
+                                  Call::Intrinsic);
+        return Evaluate::make(scatter);
+    }
+
+public:
+    ScatterGatherGenerator(const Target &t) {
+        native_bits = t.has_feature(Target::HVX_128) ? 128 * 8 : 64 * 8;
+    }
+};
+
+// Scatters and gathers in VTCM are posted transactions: they complete
+// asynchronously with respect to other memory accesses. Insert
+// scatter-release barriers between scatters to a buffer and later
+// accesses of the same buffer. Scatters don't need to be ordered with
+// respect to each other.
+class SynchronizationBarriers : public IRMutator2 {
+    // Buffers with scatters not yet known to have completed.
+    std::set<string> pending;
+
+    using IRMutator2::visit;
+
+    // Find which buffers a piece of IR scatters to, and which it
+    // accesses in any other way.
+    class FindBufferAccesses : public IRVisitor {
+        using IRVisitor::visit;
+
+        void visit(const Load *op) override {
+            accessed.insert(op->name);
+            IRVisitor::visit(op);
+        }
+
+        void visit(const Store *op) override {
+            accessed.insert(op->name);
+            IRVisitor::visit(op);
+        }
+
+        void visit(const Free *op) override {
+            accessed.insert(op->name);
+        }
+
+        void visit(const Call *op) override {
+            if (op->is_intrinsic("scatter") || op->is_intrinsic("scatter_acc")) {
+                const Variable *buf = op->args[0].as<Variable>();
+                internal_assert(buf);
+                scattered.insert(buf->name);
+                for (size_t i = 1; i < op->args.size(); i++) {
+                    op->args[i].accept(this);
+                }
+            } else if (op->is_intrinsic("gather")) {
+                // A gather reads its source through the scatter-gather
+                // unit, and writes its destination with a vector store.
+                const Variable *dst = op->args[0].as<Variable>();
+                const Variable *src = op->args[2].as<Variable>();
+                internal_assert(dst && src);
+                accessed.insert(dst->name);
+                accessed.insert(src->name);
+                op->args[1].accept(this);
+                op->args[3].accept(this);
+                op->args[4].accept(this);
+            } else {
+                IRVisitor::visit(op);
+            }
+        }
+
+    public:
+        std::set<string> scattered, accessed;
+    };
+
+    Stmt release(const string &buf) {
+        Expr call = Call::make(Int(32), "scatter_release",
+                               {Variable::make(Handle(), buf)}, Call::Intrinsic);
+        return Evaluate::make(call);
+    }
+
+    // Remove pending scatters to the given buffers from the pending
+    // set, and return a release barrier for each.
+    vector<Stmt> get_barriers(const std::set<string> &accessed) {
+        vector<Stmt> barriers;
+        for (const string &buf : accessed) {
+            if (pending.erase(buf)) {
+                barriers.push_back(release(buf));
+            }
+        }
+        return barriers;
+    }
+
+    static Stmt prepend(const vector<Stmt> &barriers, Stmt s) {
+        for (size_t i = barriers.size(); i > 0; i--) {
+            s = Block::make(barriers[i - 1], s);
+        }
+        return s;
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        // Loads in the value happen before the body runs.
+        FindBufferAccesses f;
+        op->value.accept(&f);
+        vector<Stmt> barriers = get_barriers(f.accessed);
+        return prepend(barriers, IRMutator2::visit(op));
+    }
+
+    Stmt visit(const IfThenElse *op) override {
+        FindBufferAccesses f;
+        op->condition.accept(&f);
+        vector<Stmt> barriers = get_barriers(f.accessed);
+
+        // Either branch may run, so scatters from both are pending
+        // afterwards.
+        std::set<string> before = pending;
+        Stmt then_case = mutate(op->then_case);
+        std::swap(pending, before);
+        Stmt else_case = mutate(op->else_case);
+        pending.insert(before.begin(), before.end());
+
+        Stmt stmt;
+        if (then_case.same_as(op->then_case) && else_case.same_as(op->else_case)) {
+            stmt = op;
+        } else {
+            stmt = IfThenElse::make(op->condition, then_case, else_case);
+        }
+        return prepend(barriers, stmt);
+    }
+
+    Stmt visit(const For *op) override {
+        FindBufferAccesses f;
+        op->min.accept(&f);
+        op->extent.accept(&f);
+        vector<Stmt> barriers = get_barriers(f.accessed);
+
+        Stmt body = mutate(op->body);
+
+        // Scatters still outstanding at the bottom of the loop body
+        // conflict with accesses at the top of the next iteration, so
+        // release them at the top of the body. They stay pending for
+        // whatever follows the loop.
+        FindBufferAccesses fb;
+        op->body.accept(&fb);
+        vector<Stmt> loop_barriers;
+        for (const string &buf : fb.accessed) {
+            if (pending.count(buf)) {
+                loop_barriers.push_back(release(buf));
+            }
+        }
+        body = prepend(loop_barriers, body);
+
+        Stmt stmt;
+        if (body.same_as(op->body)) {
+            stmt = op;
+        } else {
+            stmt = For::make(op->name, op->min, op->extent, op->for_type,
+                             op->device_api, body);
+        }
+        return prepend(barriers, stmt);
+    }
+
+    Stmt visit(const Allocate *op) override {
+        Stmt stmt = IRMutator2::visit(op);
+        if (pending.erase(op->name)) {
+            // Don't free the buffer while scatters to it are still in
+            // flight.
+            const Allocate *a = stmt.as<Allocate>();
+            internal_assert(a);
+            stmt = Allocate::make(a->name, a->type, a->memory_type, a->extents,
+                                  a->condition, Block::make(a->body, release(a->name)),
+                                  a->new_expr, a->free_function);
+        }
+        return stmt;
+    }
+
+public:
+    using IRMutator2::mutate;
+
+    Stmt mutate(const Stmt &s) override {
+        if (!s.defined()) {
+            return s;
+        }
+        if (s.as<Block>() || s.as<For>() || s.as<LetStmt>() ||
+            s.as<IfThenElse>() || s.as<ProducerConsumer>() || s.as<Allocate>()) {
+            // Compound statements: recurse to place barriers as close
+            // to the conflicting access as possible.
+            return IRMutator2::mutate(s);
+        }
+        // Leaf statements: check for conflicts with pending scatters.
+        FindBufferAccesses f;
+        s.accept(&f);
+        Stmt stmt = prepend(get_barriers(f.accessed), IRMutator2::mutate(s));
+        pending.insert(f.scattered.begin(), f.scattered.end());
+        return stmt;
+    }
+};
+
 // Attempt to generate vtmpy instructions. This requires that all lets
 // be substituted prior to running, and so must be an IRGraphMutator2.
 class VtmpyGenerator : public IRGraphMutator2 {
@@ -1867,6 +2186,15 @@ Stmt optimize_hexagon_shuffles(Stmt s, int lut_alignment) {
     return OptimizeShuffles(lut_alignment).mutate(s);
 }
 
+Stmt scatter_gather_generator(Stmt s, const Target &t) {
+    // Replace indirect loads and stores that touch VTCM with
+    // vgather/vscatter, and insert the release barriers the posted
+    // scatters require.
+    s = ScatterGatherGenerator(t).mutate(s);
+    s = SynchronizationBarriers().mutate(s);
+    return s;
+}
+
 Stmt vtmpy_generator(Stmt s) {
     // Generate vtmpy instruction if possible
     s = substitute_in_all_lets(s);
@@ -14,6 +14,12 @@ namespace Internal {
  * calls. */
 Stmt optimize_hexagon_shuffles(Stmt s, int lut_alignment);
 
+/** Replace indirect loads from buffers in VTCM with vgather
+ * intrinsics, and indirect stores to buffers in VTCM with vscatter
+ * intrinsics, inserting the scatter-release barriers they
+ * require. Only valid for Hexagon v65 or later. */
+Stmt scatter_gather_generator(Stmt s, const Target &t);
+
 /** Generate vtmpy instruction if possible */
 Stmt vtmpy_generator(Stmt s);
 
@@ -0,0 +1,260 @@
+#include "HoistStorage.h"
+
+#include <utility>
+
+#include "Bounds.h"
+#include "ExprUsesVar.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Interval.h"
+#include "Scope.h"
+#include "Simplify.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace {
+
+class HoistStorage : public IRMutator2 {
+public:
+    HoistStorage(const map<string, Function> &env) : env(env) {
+        // A sentinel frame representing the root of the pipeline, for
+        // allocations scheduled with hoist_storage_root.
+        frames.push_back(Frame{nullptr, 0, {}});
+    }
+
+    // Wrap the mutated pipeline in any allocations hoisted all the
+    // way to the root.
+    Stmt inject_root_allocations(Stmt s) {
+        internal_assert(frames.size() == 1);
+        return inject_pending(frames.back(), std::move(s));
+    }
+
+private:
+    using IRMutator2::visit;
+
+    const map<string, Function> &env;
+
+    struct PendingAllocation {
+        string name;
+        Type type;
+        MemoryType memory_type;
+        vector<Expr> extents;
+        Expr condition;
+    };
+
+    // One entry per enclosing For loop, innermost last, plus the root
+    // sentinel. Each frame owns the allocations to be placed
+    // immediately inside its loop, and remembers how many variables
+    // were tracked on entry so we know which bindings sit between the
+    // loop and an allocation being hoisted to it.
+    struct Frame {
+        const For *loop;
+        size_t tracked_base;
+        vector<PendingAllocation> pending;
+    };
+    vector<Frame> frames;
+
+    // The loop variables and lets bound below the root, in binding
+    // order. The intervals are fully resolved at push time, so they
+    // never mention other tracked variables. Lets whose values don't
+    // involve tracked variables get a single-point interval, so
+    // substituting them just inlines the value.
+    vector<pair<string, Interval>> tracked;
+    Scope<Interval> scope;
+
+    void track(const string &name, const Interval &in) {
+        tracked.push_back({name, in});
+        scope.push(name, in);
+    }
+
+    void untrack() {
+        scope.pop(tracked.back().first);
+        tracked.pop_back();
+    }
+
+    // Find the Function an allocation belongs to. Flattened
+    // allocation names may carry dotted suffixes (e.g. the tuple
+    // components "f.0", "f.1"), so strip suffixes until we find a
+    // match.
+    const Function *lookup(const string &name) const {
+        string key = name;
+        while (true) {
+            auto it = env.find(key);
+            if (it != env.end()) {
+                return &it->second;
+            }
+            size_t pos = key.rfind('.');
+            if (pos == string::npos) {
+                return nullptr;
+            }
+            key = key.substr(0, pos);
+        }
+    }
+
+    static Stmt inject_pending(Frame &frame, Stmt body) {
+        while (!frame.pending.empty()) {
+            const PendingAllocation &p = frame.pending.back();
+            body = Allocate::make(p.name, p.type, p.memory_type,
+                                  p.extents, p.condition, body);
+            frame.pending.pop_back();
+        }
+        return body;
+    }
+
+    Stmt visit(const For *op) override {
+        Interval bounds(bounds_of_expr_in_scope(op->min, scope).min,
+                        bounds_of_expr_in_scope(op->min + op->extent - 1, scope).max);
+        track(op->name, bounds);
+        frames.push_back(Frame{op, tracked.size(), {}});
+
+        Stmt body = mutate(op->body);
+        body = inject_pending(frames.back(), std::move(body));
+
+        frames.pop_back();
+        untrack();
+
+        if (body.same_as(op->body)) {
+            return op;
+        }
+        return For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        if (expr_uses_vars(op->value, scope)) {
+            track(op->name, bounds_of_expr_in_scope(op->value, scope));
+        } else {
+            track(op->name, Interval::single_point(op->value));
+        }
+        Stmt body = mutate(op->body);
+        untrack();
+
+        if (body.same_as(op->body)) {
+            return op;
+        }
+        return LetStmt::make(op->name, op->value, body);
+    }
+
+    Stmt visit(const Allocate *op) override {
+        const Function *f = lookup(op->name);
+        if (!f) {
+            return IRMutator2::visit(op);
+        }
+        const LoopLevel &level = f->schedule().hoist_storage_level();
+        if (level.is_inlined()) {
+            return IRMutator2::visit(op);
+        }
+
+        // Find the frame the allocation should move to.
+        size_t target = frames.size();
+        if (level.is_root()) {
+            target = 0;
+        } else {
+            for (size_t i = frames.size(); i > 0; i--) {
+                const For *loop = frames[i - 1].loop;
+                if (loop && level.match(loop->name)) {
+                    target = i - 1;
+                    break;
+                }
+            }
+        }
+        if (target == frames.size()) {
+            // The hoist level doesn't enclose this allocation site
+            // (e.g. the storage is already outside the named loop);
+            // leave the allocation where it is.
+            return IRMutator2::visit(op);
+        }
+
+        user_assert(!op->new_expr.defined())
+            << "Cannot hoist storage for " << op->name
+            << ", because it has a custom allocation expression.\n";
+
+        // The target loop itself being parallel is fine (each task
+        // gets its own instance), but hoisting out of a parallel loop
+        // would share one buffer between threads.
+        for (size_t i = target + 1; i < frames.size(); i++) {
+            const For *loop = frames[i].loop;
+            user_assert(!loop->is_parallel())
+                << "Cannot hoist storage for " << op->name
+                << " across the parallel loop " << loop->name << ".\n";
+        }
+
+        // The variables bound between the target loop and here. The
+        // hoisted extents may not mention them.
+        Scope<Interval> crossed;
+        for (size_t i = frames[target].tracked_base; i < tracked.size(); i++) {
+            crossed.push(tracked[i].first, tracked[i].second);
+        }
+
+        vector<Expr> extents;
+        for (Expr e : op->extents) {
+            if (expr_uses_vars(e, crossed)) {
+                Interval in = bounds_of_expr_in_scope(e, crossed);
+                user_assert(in.has_upper_bound())
+                    << "Cannot hoist storage for " << op->name
+                    << " to loop level " << level.to_string()
+                    << ", because the extent " << e
+                    << " has no upper bound there.\n";
+                e = simplify(in.max);
+            }
+            extents.push_back(e);
+        }
+        Expr condition = op->condition;
+        if (expr_uses_vars(condition, crossed)) {
+            // Conservatively always allocate.
+            condition = const_true();
+        }
+
+        // Merge with another hoisted allocation of the same name
+        // (e.g. the same Func allocated in two sibling loop bodies).
+        Frame &frame = frames[target];
+        PendingAllocation *existing = nullptr;
+        for (auto &p : frame.pending) {
+            if (p.name == op->name) {
+                existing = &p;
+            }
+        }
+        if (existing) {
+            internal_assert(existing->type == op->type &&
+                            existing->extents.size() == extents.size());
+            for (size_t i = 0; i < extents.size(); i++) {
+                existing->extents[i] = simplify(max(existing->extents[i], extents[i]));
+            }
+            existing->condition = simplify(existing->condition || condition);
+        } else {
+            frame.pending.push_back({op->name, op->type, op->memory_type,
+                                     extents, condition});
+        }
+
+        // Drop the Allocate node itself; the buffer symbol is now
+        // bound by the hoisted copy.
+        return mutate(op->body);
+    }
+};
+
+}  // namespace
+
+Stmt hoist_storage(Stmt s, const map<string, Function> &env) {
+    // Don't bother walking the IR unless something asks to be hoisted.
+    bool any_hoisted = false;
+    for (const auto &p : env) {
+        if (!p.second.schedule().hoist_storage_level().is_inlined()) {
+            any_hoisted = true;
+        }
+    }
+    if (!any_hoisted) {
+        return s;
+    }
+
+    HoistStorage hoister(env);
+    s = hoister.mutate(s);
+    return hoister.inject_root_allocations(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,28 @@
+#ifndef HALIDE_HOIST_STORAGE_H
+#define HALIDE_HOIST_STORAGE_H
+
+/** \file
+ * Defines the lowering pass that lifts allocations to the loop level
+ * named by Func::hoist_storage.
+ */
+
+#include <map>
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Lift the allocations of any Funcs scheduled with
+ * Func::hoist_storage out to just inside the named loop, so the
+ * buffer is allocated once per iteration of that loop and reused by
+ * the iterations of everything beneath it. Extents that depend on the
+ * loop variables or lets being crossed are replaced with upper bounds
+ * over them. Runs after storage flattening, when Realize nodes have
+ * become Allocate nodes with explicit extents. */
+Stmt hoist_storage(Stmt s, const std::map<std::string, Function> &env);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
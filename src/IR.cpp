@@ -1,3 +1,5 @@
+#include <limits>
+
 #include "IR.h"
 #include "IRMutator.h"
 #include "IRPrinter.h"
@@ -6,6 +8,110 @@
 namespace Halide {
 namespace Internal {
 
+namespace {
+
+// Small integer constants make up the bulk of the leaves of most
+// pipelines' IR, so we intern them. Structurally equal subtrees built
+// from interned constants share nodes, which lets the same_as fast
+// paths in IREquality (and hence Simplify and CSE) skip the deep
+// walk. The cache pins a reference to each node so they are never
+// destroyed.
+const int64_t interned_imm_min = -16;
+const int64_t interned_imm_max = 256;
+const int num_interned_imms = (int)(interned_imm_max - interned_imm_min);
+
+// Indexed by [log2(bits) - 3][value - interned_imm_min].
+struct InternedIntImms {
+    Expr imms[4][num_interned_imms];
+    InternedIntImms() {
+        for (int b = 0; b < 4; b++) {
+            Type t = Int(8 << b);
+            for (int i = 0; i < num_interned_imms; i++) {
+                int64_t value = interned_imm_min + i;
+                if (b == 0 && (value < -128 || value > 127)) continue;
+                IntImm *node = new IntImm;
+                node->type = t;
+                node->value = value;
+                imms[b][i] = node;
+            }
+        }
+    }
+};
+
+struct InternedUIntImms {
+    Expr imms[5][num_interned_imms];
+    InternedUIntImms() {
+        for (int b = 0; b < 5; b++) {
+            Type t = UInt(b == 0 ? 1 : (8 << (b - 1)));
+            for (int i = 0; i < num_interned_imms; i++) {
+                int64_t value = interned_imm_min + i;
+                if (value < 0 || (b == 0 && value > 1)) continue;
+                UIntImm *node = new UIntImm;
+                node->type = t;
+                node->value = (uint64_t)value;
+                imms[b][i] = node;
+            }
+        }
+    }
+};
+
+}  // namespace
+
+const IntImm *IntImm::make(Type t, int64_t value) {
+    internal_assert(t.is_int() && t.is_scalar())
+        << "IntImm must be a scalar Int\n";
+    internal_assert(t.bits() == 8 || t.bits() == 16 || t.bits() == 32 || t.bits() == 64)
+        << "IntImm must be 8, 16, 32, or 64-bit\n";
+
+    // Normalize the value by dropping the high bits.
+    // Since left-shift of negative value is UB in C++, cast to uint64 first;
+    // it's unlikely any compilers we care about will misbehave, but UBSan will complain.
+    value = (int64_t) (((uint64_t) value) << (64 - t.bits()));
+
+    // Then sign-extending to get them back
+    value >>= (64 - t.bits());
+
+    if (value >= interned_imm_min && value < interned_imm_max) {
+        // Initialization of function-local statics is thread-safe.
+        static InternedIntImms interned;
+        const Expr &e = interned.imms[t.bits() == 8 ? 0 : t.bits() == 16 ? 1 : t.bits() == 32 ? 2 : 3]
+                                     [value - interned_imm_min];
+        if (e.defined()) {
+            return (const IntImm *)e.get();
+        }
+    }
+
+    IntImm *node = new IntImm;
+    node->type = t;
+    node->value = value;
+    return node;
+}
+
+const UIntImm *UIntImm::make(Type t, uint64_t value) {
+    internal_assert(t.is_uint() && t.is_scalar())
+        << "UIntImm must be a scalar UInt\n";
+    internal_assert(t.bits() == 1 || t.bits() == 8 || t.bits() == 16 || t.bits() == 32 || t.bits() == 64)
+        << "UIntImm must be 1, 8, 16, 32, or 64-bit\n";
+
+    // Normalize the value by dropping the high bits
+    value <<= (64 - t.bits());
+    value >>= (64 - t.bits());
+
+    if (value < (uint64_t)interned_imm_max) {
+        static InternedUIntImms interned;
+        const Expr &e = interned.imms[t.bits() == 1 ? 0 : t.bits() == 8 ? 1 : t.bits() == 16 ? 2 : t.bits() == 32 ? 3 : 4]
+                                     [(int64_t)value - interned_imm_min];
+        if (e.defined()) {
+            return (const UIntImm *)e.get();
+        }
+    }
+
+    UIntImm *node = new UIntImm;
+    node->type = t;
+    node->value = value;
+    return node;
+}
+
 Expr Cast::make(Type t, Expr v) {
     internal_assert(v.defined()) << "Cast of undefined\n";
     internal_assert(t.lanes() == v.type().lanes()) << "Cast may not change vector widths\n";
@@ -400,7 +506,7 @@ Stmt Allocate::make(const std::string &name, Type type, MemoryType memory_type,
     return node;
 }
 
-int32_t Allocate::constant_allocation_size(const std::vector<Expr> &extents, const std::string &name) {
+int64_t Allocate::constant_allocation_size_64(const std::vector<Expr> &extents, const std::string &name) {
     int64_t result = 1;
 
     for (size_t i = 0; i < extents.size(); i++) {
@@ -417,17 +523,32 @@ int32_t Allocate::constant_allocation_size(const std::vector<Expr> &extents, con
                     int_size->value << " which is greater than 2^31 - 1.";
             }
             */
-            result *= int_size->value;
-            if (result > (static_cast<int64_t>(1)<<31) - 1) {
+            if (int_size->value != 0 &&
+                result > std::numeric_limits<int64_t>::max() / int_size->value) {
                 user_error
                     << "Total size for allocation " << name
-                    << " is constant but exceeds 2^31 - 1.\n";
+                    << " is constant but exceeds 2^63 - 1.\n";
             }
+            result *= int_size->value;
         } else {
             return 0;
         }
     }
 
+    return result;
+}
+
+int64_t Allocate::constant_allocation_size_64() const {
+    return Allocate::constant_allocation_size_64(extents, name);
+}
+
+int32_t Allocate::constant_allocation_size(const std::vector<Expr> &extents, const std::string &name) {
+    int64_t result = constant_allocation_size_64(extents, name);
+    if (result > (static_cast<int64_t>(1)<<31) - 1) {
+        user_error
+            << "Total size for allocation " << name
+            << " is constant but exceeds 2^31 - 1.\n";
+    }
     return static_cast<int32_t>(result);
 }
 
@@ -835,6 +956,7 @@ Call::ConstString Call::shift_left = "shift_left";
 Call::ConstString Call::shift_right = "shift_right";
 Call::ConstString Call::abs = "abs";
 Call::ConstString Call::absd = "absd";
+Call::ConstString Call::atomic_add = "atomic_add";
 Call::ConstString Call::lerp = "lerp";
 Call::ConstString Call::random = "random";
 Call::ConstString Call::popcount = "popcount";
@@ -868,6 +990,13 @@ Call::ConstString Call::extract_mask_element = "extract_mask_element";
 Call::ConstString Call::require = "require";
 Call::ConstString Call::size_of_halide_buffer_t = "size_of_halide_buffer_t";
 Call::ConstString Call::strict_float = "strict_float";
+Call::ConstString Call::widening_add = "widening_add";
+Call::ConstString Call::widening_mul = "widening_mul";
+Call::ConstString Call::halving_add = "halving_add";
+Call::ConstString Call::halving_sub = "halving_sub";
+Call::ConstString Call::rounding_halving_add = "rounding_halving_add";
+Call::ConstString Call::saturating_add = "saturating_add";
+Call::ConstString Call::saturating_sub = "saturating_sub";
 
 Call::ConstString Call::buffer_get_min = "_halide_buffer_get_min";
 Call::ConstString Call::buffer_get_extent = "_halide_buffer_get_extent";
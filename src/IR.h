@@ -371,6 +371,13 @@ struct Allocate : public StmtNode<Allocate> {
     static int32_t constant_allocation_size(const std::vector<Expr> &extents, const std::string &name);
     int32_t constant_allocation_size() const;
 
+    /** As above, but without the 2^31 - 1 cap, for use on 64-bit
+     * targets with the LargeBuffers feature. Asserts if the result
+     * would overflow 2^63 - 1; it is up to the caller to enforce the
+     * target's actual maximum buffer size. */
+    static int64_t constant_allocation_size_64(const std::vector<Expr> &extents, const std::string &name);
+    int64_t constant_allocation_size_64() const;
+
     static const IRNodeType _node_type = IRNodeType::Allocate;
 };
 
@@ -484,6 +491,7 @@ struct Call : public ExprNode<Call> {
         shift_right,
         abs,
         absd,
+        atomic_add,
         rewrite_buffer,
         random,
         lerp,
@@ -517,7 +525,14 @@ struct Call : public ExprNode<Call> {
         extract_mask_element,
         require,
         size_of_halide_buffer_t,
-        strict_float;
+        strict_float,
+        widening_add,
+        widening_mul,
+        halving_add,
+        halving_sub,
+        rounding_halving_add,
+        saturating_add,
+        saturating_sub;
 
     // We also declare some symbolic names for some of the runtime
     // functions that we want to construct Call nodes to here to avoid
@@ -46,23 +46,47 @@ void mutate_binary_operator(IRMutator *mutator, const T *op, Expr *expr, Stmt *s
     *stmt = nullptr;
 }
 
+// Mutate a vector of Exprs without allocating a fresh vector until a
+// child actually changes. Returns whether anything changed; when
+// nothing does, 'result' is left empty and the caller should keep
+// using the old vector.
+template<typename Mutator>
+bool mutate_exprs(Mutator *mutator, const vector<Expr> &old, vector<Expr> *result) {
+    bool changed = false;
+    for (size_t i = 0; i < old.size(); i++) {
+        Expr new_e = mutator->mutate(old[i]);
+        if (!changed && !new_e.same_as(old[i])) {
+            changed = true;
+            result->reserve(old.size());
+            result->insert(result->end(), old.begin(), old.begin() + i);
+        }
+        if (changed) {
+            result->push_back(std::move(new_e));
+        }
+    }
+    return changed;
+}
+
 template<typename Mutator>
 pair<Region, bool> mutate_region(Mutator *mutator, const Region &bounds) {
-    Region new_bounds(bounds.size());
+    Region new_bounds;
     bool bounds_changed = false;
 
     for (size_t i = 0; i < bounds.size(); i++) {
-        Expr old_min = bounds[i].min;
-        Expr old_extent = bounds[i].extent;
+        const Expr &old_min = bounds[i].min;
+        const Expr &old_extent = bounds[i].extent;
         Expr new_min = mutator->mutate(old_min);
         Expr new_extent = mutator->mutate(old_extent);
-        if (!new_min.same_as(old_min)) {
+        if (!bounds_changed &&
+            (!new_min.same_as(old_min) ||
+             !new_extent.same_as(old_extent))) {
             bounds_changed = true;
+            new_bounds.reserve(bounds.size());
+            new_bounds.insert(new_bounds.end(), bounds.begin(), bounds.begin() + i);
         }
-        if (!new_extent.same_as(old_extent)) {
-            bounds_changed = true;
+        if (bounds_changed) {
+            new_bounds.push_back(Range(std::move(new_min), std::move(new_extent)));
         }
-        new_bounds[i] = Range(new_min, new_extent);
     }
     return {new_bounds, bounds_changed};
 }
@@ -154,18 +178,8 @@ void IRMutator::visit(const Broadcast *op) {
 }
 
 void IRMutator::visit(const Call *op) {
-    vector<Expr> new_args(op->args.size());
-    bool changed = false;
-
-    // Mutate the args
-    for (size_t i = 0; i < op->args.size(); i++) {
-        const Expr &old_arg = op->args[i];
-        Expr new_arg = mutate(old_arg);
-        if (!new_arg.same_as(old_arg)) changed = true;
-        new_args[i] = std::move(new_arg);
-    }
-
-    if (!changed) {
+    vector<Expr> new_args;
+    if (!mutate_exprs(this, op->args, &new_args)) {
         expr = op;
     } else {
         expr = Call::make(op->type, op->name, new_args, op->call_type,
@@ -241,52 +255,37 @@ void IRMutator::visit(const Store *op) {
 }
 
 void IRMutator::visit(const Provide *op) {
-    vector<Expr> new_args(op->args.size());
-    vector<Expr> new_values(op->values.size());
-    bool changed = false;
+    vector<Expr> new_args, new_values;
+    bool args_changed = mutate_exprs(this, op->args, &new_args);
+    bool values_changed = mutate_exprs(this, op->values, &new_values);
 
-    // Mutate the args
-    for (size_t i = 0; i < op->args.size(); i++) {
-        const Expr &old_arg = op->args[i];
-        Expr new_arg = mutate(old_arg);
-        if (!new_arg.same_as(old_arg)) changed = true;
-        new_args[i] = new_arg;
-    }
-
-    for (size_t i = 0; i < op->values.size(); i++) {
-        const Expr &old_value = op->values[i];
-        Expr new_value = mutate(old_value);
-        if (!new_value.same_as(old_value)) changed = true;
-        new_values[i] = new_value;
-    }
-
-    if (!changed) {
+    if (!args_changed && !values_changed) {
         stmt = op;
     } else {
-        stmt = Provide::make(op->name, new_values, new_args);
+        stmt = Provide::make(op->name,
+                             values_changed ? new_values : op->values,
+                             args_changed ? new_args : op->args);
     }
 }
 
 void IRMutator::visit(const Allocate *op) {
     std::vector<Expr> new_extents;
-    bool all_extents_unmodified = true;
-    for (size_t i = 0; i < op->extents.size(); i++) {
-        new_extents.push_back(mutate(op->extents[i]));
-        all_extents_unmodified &= new_extents[i].same_as(op->extents[i]);
-    }
+    bool extents_changed = mutate_exprs(this, op->extents, &new_extents);
     Stmt body = mutate(op->body);
     Expr condition = mutate(op->condition);
     Expr new_expr;
     if (op->new_expr.defined()) {
         new_expr = mutate(op->new_expr);
     }
-    if (all_extents_unmodified &&
+    if (!extents_changed &&
         body.same_as(op->body) &&
         condition.same_as(op->condition) &&
         new_expr.same_as(op->new_expr)) {
         stmt = op;
     } else {
-        stmt = Allocate::make(op->name, op->type, op->memory_type, new_extents, std::move(condition),
+        stmt = Allocate::make(op->name, op->type, op->memory_type,
+                              extents_changed ? new_extents : op->extents,
+                              std::move(condition),
                               std::move(body), std::move(new_expr), op->free_function);
     }
 }
@@ -309,7 +308,8 @@ void IRMutator::visit(const Realize *op) {
         condition.same_as(op->condition)) {
         stmt = op;
     } else {
-        stmt = Realize::make(op->name, op->types, op->memory_type, new_bounds,
+        stmt = Realize::make(op->name, op->types, op->memory_type,
+                             bounds_changed ? new_bounds : op->bounds,
                              std::move(condition), std::move(body));
     }
 }
@@ -362,17 +362,8 @@ void IRMutator::visit(const Evaluate *op) {
 }
 
 void IRMutator::visit(const Shuffle *op) {
-    vector<Expr> new_vectors(op->vectors.size());
-    bool changed = false;
-
-    for (size_t i = 0; i < op->vectors.size(); i++) {
-        Expr old_vector = op->vectors[i];
-        Expr new_vector = mutate(old_vector);
-        if (!new_vector.same_as(old_vector)) changed = true;
-        new_vectors[i] = new_vector;
-    }
-
-    if (!changed) {
+    vector<Expr> new_vectors;
+    if (!mutate_exprs(this, op->vectors, &new_vectors)) {
         expr = op;
     } else {
         expr = Shuffle::make(new_vectors, op->indices);
@@ -486,18 +477,8 @@ Expr IRMutator2::visit(const Broadcast *op) {
 }
 
 Expr IRMutator2::visit(const Call *op) {
-    vector<Expr> new_args(op->args.size());
-    bool changed = false;
-
-    // Mutate the args
-    for (size_t i = 0; i < op->args.size(); i++) {
-        const Expr &old_arg = op->args[i];
-        Expr new_arg = mutate(old_arg);
-        if (!new_arg.same_as(old_arg)) changed = true;
-        new_args[i] = std::move(new_arg);
-    }
-
-    if (!changed) {
+    vector<Expr> new_args;
+    if (!mutate_exprs(this, op->args, &new_args)) {
         return op;
     }
     return Call::make(op->type, op->name, new_args, op->call_type,
@@ -566,52 +547,36 @@ Stmt IRMutator2::visit(const Store *op) {
 }
 
 Stmt IRMutator2::visit(const Provide *op) {
-    vector<Expr> new_args(op->args.size());
-    vector<Expr> new_values(op->values.size());
-    bool changed = false;
+    vector<Expr> new_args, new_values;
+    bool args_changed = mutate_exprs(this, op->args, &new_args);
+    bool values_changed = mutate_exprs(this, op->values, &new_values);
 
-    // Mutate the args
-    for (size_t i = 0; i < op->args.size(); i++) {
-        const Expr &old_arg = op->args[i];
-        Expr new_arg = mutate(old_arg);
-        if (!new_arg.same_as(old_arg)) changed = true;
-        new_args[i] = new_arg;
-    }
-
-    for (size_t i = 0; i < op->values.size(); i++) {
-        const Expr &old_value = op->values[i];
-        Expr new_value = mutate(old_value);
-        if (!new_value.same_as(old_value)) changed = true;
-        new_values[i] = new_value;
-    }
-
-    if (!changed) {
+    if (!args_changed && !values_changed) {
         return op;
     }
-    return Provide::make(op->name, new_values, new_args);
+    return Provide::make(op->name,
+                         values_changed ? new_values : op->values,
+                         args_changed ? new_args : op->args);
 }
 
 Stmt IRMutator2::visit(const Allocate *op) {
     std::vector<Expr> new_extents;
-    bool all_extents_unmodified = true;
-    for (size_t i = 0; i < op->extents.size(); i++) {
-        new_extents.push_back(mutate(op->extents[i]));
-        all_extents_unmodified &= new_extents[i].same_as(op->extents[i]);
-    }
+    bool extents_changed = mutate_exprs(this, op->extents, &new_extents);
     Stmt body = mutate(op->body);
     Expr condition = mutate(op->condition);
     Expr new_expr;
     if (op->new_expr.defined()) {
         new_expr = mutate(op->new_expr);
     }
-    if (all_extents_unmodified &&
+    if (!extents_changed &&
         body.same_as(op->body) &&
         condition.same_as(op->condition) &&
         new_expr.same_as(op->new_expr)) {
         return op;
     }
     return Allocate::make(op->name, op->type, op->memory_type,
-                          new_extents, std::move(condition),
+                          extents_changed ? new_extents : op->extents,
+                          std::move(condition),
                           std::move(body), std::move(new_expr), op->free_function);
 }
 
@@ -633,7 +598,8 @@ Stmt IRMutator2::visit(const Realize *op) {
         condition.same_as(op->condition)) {
         return op;
     }
-    return Realize::make(op->name, op->types, op->memory_type, new_bounds,
+    return Realize::make(op->name, op->types, op->memory_type,
+                         bounds_changed ? new_bounds : op->bounds,
                          std::move(condition), std::move(body));
 }
 
@@ -681,17 +647,8 @@ Stmt IRMutator2::visit(const Evaluate *op) {
 }
 
 Expr IRMutator2::visit(const Shuffle *op) {
-    vector<Expr> new_vectors(op->vectors.size());
-    bool changed = false;
-
-    for (size_t i = 0; i < op->vectors.size(); i++) {
-        Expr old_vector = op->vectors[i];
-        Expr new_vector = mutate(old_vector);
-        if (!new_vector.same_as(old_vector)) changed = true;
-        new_vectors[i] = new_vector;
-    }
-
-    if (!changed) {
+    vector<Expr> new_vectors;
+    if (!mutate_exprs(this, op->vectors, &new_vectors)) {
         return op;
     }
     return Shuffle::make(new_vectors, op->indices);
@@ -291,6 +291,10 @@ Expr make_const_helper(Type t, T val) {
         return UIntImm::make(t, (uint64_t)val);
     } else if (t.is_float()) {
         return FloatImm::make(t, (double)val);
+    } else if (t.is_bfloat()) {
+        // There is no bfloat immediate; leave the narrowing conversion
+        // in place for codegen.
+        return Cast::make(t, FloatImm::make(Float(32), (double)val));
     } else {
         internal_error << "Can't make a constant of type " << t << "\n";
         return Expr();
@@ -413,6 +417,11 @@ void match_types(Expr &a, Expr &b) {
         << "Can't do arithmetic on opaque pointer types: "
         << a << ", " << b << "\n";
 
+    user_assert(!a.type().is_bfloat() && !b.type().is_bfloat())
+        << "Can't do arithmetic directly on bfloat values; cast to Float(32) "
+        << "to compute and back to bfloat for storage: "
+        << a << ", " << b << "\n";
+
     // First widen to match
     if (a.type().is_scalar() && b.type().is_vector()) {
         a = Broadcast::make(std::move(a), b.type().lanes());
@@ -814,6 +823,165 @@ Expr fast_exp(Expr x_full) {
     result = common_subexpression_elimination(result);
     return result;
 }
+
+namespace {
+
+// Reduce the argument of a trig function to y in [-pi/4, pi/4] plus a
+// quadrant number. pi/2 is split into three parts, the first of which
+// has few enough mantissa bits that k times it is exact, in the same
+// way halide_exp splits ln2.
+void range_reduce_trig(const Expr &x, Expr *reduced, Expr *quadrant) {
+    const float two_over_pi = 0.63661977236758134308f;
+    const float pi_over_two_part1 = 1.5703125f;
+    const float pi_over_two_part2 = 4.83751296997070312500e-4f;
+    const float pi_over_two_part3 = 7.54978995489188516351e-8f;
+
+    Expr scaled = x * two_over_pi;
+    Expr k_real = round(scaled);
+    Expr k = cast(Int(32, x.type().lanes()), k_real);
+
+    Expr y = x - k_real * pi_over_two_part1;
+    y -= k_real * pi_over_two_part2;
+    y -= k_real * pi_over_two_part3;
+
+    *reduced = y;
+    *quadrant = k & 3;
+}
+
+} // namespace
+
+Expr fast_sin(Expr x_full, ApproximationPrecision precision) {
+    user_assert(x_full.type() == Float(32)) << "fast_sin only works for Float(32)";
+
+    Expr y, q;
+    range_reduce_trig(x_full, &y, &q);
+    Expr y2 = y * y;
+
+    // Minimax odd polynomial for sin and even polynomial for cos on
+    // [-pi/4, pi/4]. The Fast tier drops the highest-order term of
+    // each, which costs about three decimal digits.
+    Expr sin_poly, cos_poly;
+    if (precision == ApproximationPrecision::Fast) {
+        sin_poly = y * (1.0f + y2 * (-0.16664527099620287f + y2 * 0.0079881436586633540f));
+        cos_poly = 1.0f + y2 * (-0.49985158205212948f + y2 * 0.041518066216802663f);
+    } else {
+        sin_poly = y * (1.0f + y2 * (-0.16666654611123568f +
+                                     y2 * (0.0083321608736116495f +
+                                           y2 * -0.00019515295891076930f)));
+        cos_poly = 1.0f + y2 * (-0.49999997251786327f +
+                                y2 * (0.041666456829882796f +
+                                      y2 * -0.0013887316254937104f));
+    }
+
+    // Pick the polynomial and sign for the quadrant.
+    Expr use_cos = (q & 1) != 0;
+    Expr result = select(use_cos, cos_poly, sin_poly);
+    result = select((q & 2) != 0, -result, result);
+
+    return common_subexpression_elimination(result);
+}
+
+Expr fast_cos(Expr x_full, ApproximationPrecision precision) {
+    user_assert(x_full.type() == Float(32)) << "fast_cos only works for Float(32)";
+    // cos(x) = sin(x + pi/2), and adding one to the quadrant inside
+    // fast_sin would save the add, but the extra term in the range
+    // reduction is cheap and keeps the two implementations in sync.
+    const float pi_over_two = 1.57079632679489661923f;
+    return fast_sin(std::move(x_full) + pi_over_two, precision);
+}
+
+Expr fast_tanh(Expr x_full, ApproximationPrecision precision) {
+    user_assert(x_full.type() == Float(32)) << "fast_tanh only works for Float(32)";
+
+    if (precision == ApproximationPrecision::Fast) {
+        // The degree 7/6 truncation of the Lambert continued fraction
+        // for tanh. It needs no exponential at all, but diverges past
+        // +/-4.9, where tanh has saturated anyway, so clamp there.
+        Expr x = clamp(x_full, -4.9f, 4.9f);
+        Expr x2 = x * x;
+        Expr p = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
+        Expr q = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f));
+        return common_subexpression_elimination(p / q);
+    }
+
+    // tanh(x) = 1 - 2/(exp(2x) + 1), computed on the magnitude so the
+    // exponential can't overflow, with the sign reapplied at the end.
+    // The accuracy tier picks which exp approximation feeds it.
+    Expr sign = select(x_full < 0, -1.0f, 1.0f);
+    Expr x = abs(x_full);
+    Expr e;
+    if (precision == ApproximationPrecision::Accurate) {
+        e = Internal::halide_exp(2.0f * x);
+    } else {
+        e = fast_exp(2.0f * x);
+    }
+    Expr result = sign * (1.0f - 2.0f / (e + 1.0f));
+    return common_subexpression_elimination(result);
+}
+
+Expr fast_lerp(Expr zero_val, Expr one_val, Expr weight) {
+    user_assert(zero_val.defined()) << "fast_lerp with undefined zero value";
+    user_assert(one_val.defined()) << "fast_lerp with undefined one value";
+    user_assert(weight.defined()) << "fast_lerp with undefined weight";
+
+    if (zero_val.type().is_float()) {
+        // The exact lerp is already a multiply-add chain for floats.
+        return lerp(std::move(zero_val), std::move(one_val), std::move(weight));
+    }
+
+    user_assert(zero_val.type() == one_val.type())
+        << "Can't fast_lerp between " << zero_val << " of type " << zero_val.type()
+        << " and " << one_val << " of different type " << one_val.type() << "\n";
+
+    Type t = zero_val.type();
+    user_assert(t.is_uint() && (t.bits() == 8 || t.bits() == 16))
+        << "fast_lerp only supports UInt(8), UInt(16), and float values. "
+        << "Use lerp for other types.\n";
+    user_assert(weight.type() == t || weight.type().is_float())
+        << "A fast_lerp weight must be a float or an unsigned integer of "
+        << "the same width as the values, but fast_lerp weight " << weight
+        << " has type " << weight.type() << ".\n";
+
+    int bits = t.bits();
+    Type wide = Int(bits * 2, t.lanes());
+    Type wider = Int(bits * 4, t.lanes());
+
+    // Convert the weight to a signed fixed-point value with 2*bits-1
+    // fractional bits, so the blend below is a
+    // multiply-high-with-rounding. An integer weight of the type's
+    // max becomes 1 - 2^(1-2*bits) rather than exactly one, which is
+    // where the (documented) error of this op comes from.
+    Expr wq;
+    if (weight.type().is_float()) {
+        float q_one = (float)((1u << (2 * bits - 1)) - 1);
+        wq = cast(wide, round(weight * q_one));
+    } else {
+        wq = cast(wide, weight) << (bits - 1);
+    }
+
+    Expr z = cast(wide, zero_val);
+    Expr diff = cast(wide, one_val) - z;
+
+    // This is the shape the ARM backend recognizes as a saturating
+    // rounding doubling multiply-high (sqrdmulh). The saturation
+    // never actually triggers for in-range weights.
+    Expr blend;
+    if (bits == 8) {
+        blend = saturating_cast(wide, (cast(wider, diff) * cast(wider, wq) + (1 << 14)) / (1 << 15));
+    } else {
+        blend = saturating_cast(wide, (cast(wider, diff) * cast(wider, wq) + (1 << 30)) / Expr(int64_t(1) << 31));
+    }
+
+    return cast(t, z + blend);
+}
+
+Expr fast_erf(Expr x_full) {
+    user_assert(x_full.type() == Float(32)) << "fast_erf only works for Float(32)";
+    // halide_erf is already a polynomial that vectorizes cleanly;
+    // provided under this name for symmetry with the other fast_ ops.
+    return Internal::halide_erf(std::move(x_full));
+}
+
 Expr stringify(const std::vector<Expr> &args) {
     return Internal::Call::make(type_of<const char *>(), Internal::Call::stringify,
                                 args, Internal::Call::Intrinsic);
@@ -862,19 +1030,22 @@ Expr require(Expr condition, const std::vector<Expr> &args) {
     user_assert(condition.type().is_bool()) << "Require condition must be a boolean type\n";
     user_assert(args.at(0).defined()) << "Require of undefined value\n";
 
-    Expr requirement_failed_error =
-        Internal::Call::make(Int(32),
-                             "halide_error_requirement_failed",
-                             {stringify({condition}), combine_strings(args)},
-                             Internal::Call::Extern);
+    Expr error = Internal::requirement_failed_error(condition, args);
     return Internal::Call::make(args[0].type(),
                                 Internal::Call::require,
-                                {likely(std::move(condition)), args[0], requirement_failed_error},
+                                {likely(std::move(condition)), args[0], error},
                                 Internal::Call::PureIntrinsic);
 }
 
 namespace Internal {
 
+Expr requirement_failed_error(Expr condition, const std::vector<Expr> &args) {
+    return Internal::Call::make(Int(32),
+                                "halide_error_requirement_failed",
+                                {stringify({std::move(condition)}), combine_strings(args)},
+                                Internal::Call::Extern);
+}
+
 Expr memoize_tag_helper(Expr result, const std::vector<Expr> &cache_key_values) {
     Type t = result.type();
     std::vector<Expr> args;
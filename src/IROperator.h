@@ -866,6 +866,95 @@ inline Expr absd(Expr a, Expr b) {
                                 Internal::Call::PureIntrinsic);
 }
 
+namespace Internal {
+/** Validate and unify the arguments to one of the widening/saturating
+ * arithmetic helpers below. */
+inline Type binary_intrinsic_type(const char *name, Expr &a, Expr &b) {
+    user_assert(a.defined() && b.defined()) << name << " of undefined Expr\n";
+    match_types(a, b);
+    user_assert(a.type().is_int() || a.type().is_uint())
+        << name << " of non-integer Expr: " << a << ", " << b << "\n";
+    // The widening variants compute at twice the bit width of the
+    // arguments, and no wider integer type exists beyond 64 bits.
+    user_assert(a.type().bits() <= 32)
+        << name << " of Expr wider than 32 bits: " << a << ", " << b << "\n";
+    return a.type();
+}
+}  // namespace Internal
+
+/** Compute the sum of two integer expressions at twice the bit width
+ * of the arguments, so that it cannot overflow. These arithmetic
+ * helpers construct intrinsics which stay opaque until code
+ * generation, so simplification cannot pull the pattern apart, and
+ * backends with a matching instruction (e.g. ARM's widening adds)
+ * recognize them reliably. */
+inline Expr widening_add(Expr a, Expr b) {
+    Type t = Internal::binary_intrinsic_type("widening_add", a, b);
+    return Internal::Call::make(t.with_bits(t.bits() * 2),
+                                Internal::Call::widening_add, {std::move(a), std::move(b)},
+                                Internal::Call::PureIntrinsic);
+}
+
+/** Compute the product of two integer expressions at twice the bit
+ * width of the arguments, so that it cannot overflow. See \ref
+ * widening_add. */
+inline Expr widening_mul(Expr a, Expr b) {
+    Type t = Internal::binary_intrinsic_type("widening_mul", a, b);
+    return Internal::Call::make(t.with_bits(t.bits() * 2),
+                                Internal::Call::widening_mul, {std::move(a), std::move(b)},
+                                Internal::Call::PureIntrinsic);
+}
+
+/** Compute (a + b) / 2 without overflow in the intermediate sum,
+ * rounding towards negative infinity. Maps to instructions like ARM's
+ * vhadd. See \ref widening_add. */
+inline Expr halving_add(Expr a, Expr b) {
+    Type t = Internal::binary_intrinsic_type("halving_add", a, b);
+    return Internal::Call::make(t, Internal::Call::halving_add,
+                                {std::move(a), std::move(b)},
+                                Internal::Call::PureIntrinsic);
+}
+
+/** Compute (a - b) / 2 without overflow in the intermediate
+ * difference. For unsigned arguments the difference must be
+ * non-negative. See \ref widening_add. */
+inline Expr halving_sub(Expr a, Expr b) {
+    Type t = Internal::binary_intrinsic_type("halving_sub", a, b);
+    return Internal::Call::make(t, Internal::Call::halving_sub,
+                                {std::move(a), std::move(b)},
+                                Internal::Call::PureIntrinsic);
+}
+
+/** Compute (a + b + 1) / 2 without overflow in the intermediate sum:
+ * the average rounding up. Maps to instructions like ARM's
+ * vrhadd. See \ref widening_add. */
+inline Expr rounding_halving_add(Expr a, Expr b) {
+    Type t = Internal::binary_intrinsic_type("rounding_halving_add", a, b);
+    return Internal::Call::make(t, Internal::Call::rounding_halving_add,
+                                {std::move(a), std::move(b)},
+                                Internal::Call::PureIntrinsic);
+}
+
+/** Compute a + b, clamping the result to the range of the argument
+ * type instead of overflowing. Maps to instructions like ARM's
+ * vqadd. See \ref widening_add. */
+inline Expr saturating_add(Expr a, Expr b) {
+    Type t = Internal::binary_intrinsic_type("saturating_add", a, b);
+    return Internal::Call::make(t, Internal::Call::saturating_add,
+                                {std::move(a), std::move(b)},
+                                Internal::Call::PureIntrinsic);
+}
+
+/** Compute a - b, clamping the result to the range of the argument
+ * type instead of overflowing. Maps to instructions like ARM's
+ * vqsub. See \ref widening_add. */
+inline Expr saturating_sub(Expr a, Expr b) {
+    Type t = Internal::binary_intrinsic_type("saturating_sub", a, b);
+    return Internal::Call::make(t, Internal::Call::saturating_sub,
+                                {std::move(a), std::move(b)},
+                                Internal::Call::PureIntrinsic);
+}
+
 /** Returns an expression similar to the ternary operator in C, except
  * that it always evaluates all arguments. If the first argument is
  * true, then return the second, else return the third. Typically
@@ -1211,6 +1300,37 @@ inline Expr fast_pow(Expr x, Expr y) {
     return select(x == 0.0f, 0.0f, fast_exp(fast_log(x) * std::move(y)));
 }
 
+/** Selects the accuracy/speed trade-off made by the fast approximate
+ * trigonometric and hyperbolic functions below. */
+enum class ApproximationPrecision {
+    Fast,     ///< Maximum absolute error around 1e-3. Cheapest.
+    Medium,   ///< Maximum absolute error around 1e-5. The default.
+    Accurate  ///< Accurate to within a few ulps for modest arguments.
+};
+
+/** Fast approximate cleanly vectorizable sin for Float(32). Argument
+ * reduction is accurate for arguments up to a few thousand radians;
+ * beyond that the result degrades like any single-precision
+ * reduction. Vectorizes cleanly, unlike sin, which lowers to a scalar
+ * libm call. */
+Expr fast_sin(Expr x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+
+/** Fast approximate cleanly vectorizable cos for Float(32). See \ref
+ * fast_sin. */
+Expr fast_cos(Expr x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+
+/** Fast approximate cleanly vectorizable tanh for Float(32). The
+ * Accurate tier is built on an accurate exponential, Medium on
+ * fast_exp, and Fast on a rational approximation with no exponential
+ * at all. Saturates correctly to +/-1 for large arguments in all
+ * tiers. */
+Expr fast_tanh(Expr x, ApproximationPrecision precision = ApproximationPrecision::Medium);
+
+/** Fast approximate cleanly vectorizable erf for Float(32). A synonym
+ * for erf, which is already a vectorizable polynomial; provided for
+ * symmetry with the other fast_ ops. */
+Expr fast_erf(Expr x);
+
 /** Fast approximate inverse for Float(32). Corresponds to the rcpps
  * instruction on x86, and the vrecpe instruction on ARM. Vectorizes
  * cleanly. */
@@ -1465,6 +1585,116 @@ inline Expr operator>>(int x, Expr y) {
 }
 // @}
 
+/** Extract 'bits' contiguous bits of 'x' starting at bit 'lsb',
+ * zero-extended into the type of 'x'. This is the canonical way to
+ * consume data packed at sub-byte granularity (e.g. 4-bit quantized
+ * weights stored two to a byte): stream the packed bytes through a
+ * UInt(8) buffer at full memory bandwidth and unpack fields in
+ * registers, where the shift and mask this lowers to vectorize
+ * cleanly. See also unpack_uint4 and friends below for the common
+ * cases. */
+inline Expr extract_bits(Expr x, Expr lsb, int bits) {
+    user_assert(x.defined() && lsb.defined()) << "extract_bits of undefined Expr\n";
+    Type t = x.type();
+    user_assert(t.is_int() || t.is_uint())
+        << "The first argument to extract_bits must be an integer or unsigned integer";
+    user_assert(bits > 0 && bits <= t.bits())
+        << "extract_bits of " << bits << " bits from type " << t << "\n";
+    Expr field = std::move(x) >> cast(t, std::move(lsb));
+    if (bits < t.bits()) {
+        field = field & Internal::make_const(t, ((int64_t)1 << bits) - 1);
+    }
+    return field;
+}
+
+/** Like extract_bits, but sign-extend the field. The result has the
+ * signed type of the same width as 'x'. */
+inline Expr extract_signed_bits(Expr x, Expr lsb, int bits) {
+    user_assert(x.defined() && lsb.defined()) << "extract_signed_bits of undefined Expr\n";
+    Type t = x.type();
+    user_assert(t.is_int() || t.is_uint())
+        << "The first argument to extract_signed_bits must be an integer or unsigned integer";
+    user_assert(bits > 0 && bits <= t.bits())
+        << "extract_signed_bits of " << bits << " bits from type " << t << "\n";
+    Type st = t.with_code(Type::Int);
+    // Shift the field to the top of the word, then arithmetic-shift it
+    // back down to sign-extend.
+    Expr up = std::move(x) << (Internal::make_const(t, t.bits() - bits) - cast(t, std::move(lsb)));
+    return reinterpret(st, up) >> Internal::make_const(st, t.bits() - bits);
+}
+
+/** Unpack one element from a byte of packed sub-byte data. 'bytes'
+ * must have type UInt(8) and holds two 4-bit (or eight 1-bit) values;
+ * 'index' is the index of the packed element, of which only the
+ * position within the byte is used, so a Func holding 4-bit weights
+ * packed two to a byte is read as:
+ *
+ \code
+ Expr w = unpack_int4(packed(i / 2), i);
+ \endcode
+ *
+ * The fields are assumed packed little-endian (element 0 in the low
+ * bits). unpack_uint4 and unpack_uint1 return UInt(8); unpack_int4
+ * sign-extends the nibble and returns Int(8). */
+// @{
+inline Expr unpack_uint4(Expr bytes, Expr index) {
+    user_assert(bytes.defined() && bytes.type() == UInt(8))
+        << "unpack_uint4 requires a UInt(8) expression of packed nibbles\n";
+    Expr lsb = cast(UInt(8), (std::move(index) % 2) * 4);
+    return extract_bits(std::move(bytes), std::move(lsb), 4);
+}
+inline Expr unpack_int4(Expr bytes, Expr index) {
+    user_assert(bytes.defined() && bytes.type() == UInt(8))
+        << "unpack_int4 requires a UInt(8) expression of packed nibbles\n";
+    Expr lsb = cast(UInt(8), (std::move(index) % 2) * 4);
+    return extract_signed_bits(std::move(bytes), std::move(lsb), 4);
+}
+inline Expr unpack_uint1(Expr bytes, Expr index) {
+    user_assert(bytes.defined() && bytes.type() == UInt(8))
+        << "unpack_uint1 requires a UInt(8) expression of packed bits\n";
+    Expr lsb = cast(UInt(8), std::move(index) % 8);
+    return extract_bits(std::move(bytes), std::move(lsb), 1);
+}
+// @}
+
+/** Unpack one sample of MIPI-packed raw camera input as UInt(16).
+ * RAW10 packs four 10-bit samples into five bytes: four bytes of high
+ * eight bits followed by one byte holding the four 2-bit remainders.
+ * RAW12 packs two 12-bit samples into three bytes, with the 4-bit
+ * remainders in the third byte. 'hi_byte' is the sample's high-bits
+ * byte, 'lsb_byte' the group's shared remainder byte, and 'lane' the
+ * sample's index, of which only the position within the group is
+ * used. The recommended formulation unpacks a group per evaluation:
+ *
+ \code
+ // raw is a UInt(8) buffer of RAW10: 4 samples packed in 5 bytes.
+ unpacked(j, g) = unpack_raw10(raw(5 * g + j), raw(5 * g + 4), j);
+ out(x) = unpacked(x % 4, x / 4);
+ \endcode
+ *
+ * with 'unpacked' computed vectorized across groups 'g'. Its stride-5
+ * byte loads compile to dense loads plus byte shuffles (pshufb/tbl),
+ * and the reload in 'out' simplifies to a dense load, so the packed
+ * stream is widened at close to memory bandwidth. */
+// @{
+inline Expr unpack_raw10(Expr hi_byte, Expr lsb_byte, Expr lane) {
+    user_assert(hi_byte.defined() && hi_byte.type() == UInt(8) &&
+                lsb_byte.defined() && lsb_byte.type() == UInt(8))
+        << "unpack_raw10 requires UInt(8) expressions of packed bytes\n";
+    Expr lsb = cast(UInt(8), (std::move(lane) % 4) * 2);
+    return (cast(UInt(16), std::move(hi_byte)) << 2) |
+           cast(UInt(16), extract_bits(std::move(lsb_byte), std::move(lsb), 2));
+}
+inline Expr unpack_raw12(Expr hi_byte, Expr lsb_byte, Expr lane) {
+    user_assert(hi_byte.defined() && hi_byte.type() == UInt(8) &&
+                lsb_byte.defined() && lsb_byte.type() == UInt(8))
+        << "unpack_raw12 requires UInt(8) expressions of packed bytes\n";
+    Expr lsb = cast(UInt(8), (std::move(lane) % 2) * 4);
+    return (cast(UInt(16), std::move(hi_byte)) << 4) |
+           cast(UInt(16), extract_bits(std::move(lsb_byte), std::move(lsb), 4));
+}
+// @}
+
 /** Linear interpolate between the two values according to a weight.
  * \param zero_val The result when weight is 0
  * \param one_val The result when weight is 1
@@ -1573,6 +1803,39 @@ inline Expr lerp(Expr zero_val, Expr one_val, Expr weight) {
                                 Internal::Call::PureIntrinsic);
 }
 
+/** Approximate linear interpolation for UInt(8) and UInt(16) values
+ * (floats fall through to the exact lerp, which is already cheap).
+ * The weight is treated as a fraction of 2^bits rather than of the
+ * type's max, so the result can differ from lerp by up to 2, but the
+ * blend becomes a single rounding multiply-high, which maps to
+ * sqrdmulh on ARM instead of the exact lerp's longer widening
+ * multiply and divide chain. Use this for compositing and resampling
+ * where the last bit doesn't matter. */
+Expr fast_lerp(Expr zero_val, Expr one_val, Expr weight);
+
+/** Bilinearly interpolate between four values using two weights: the
+ * first weight blends along the first axis (zero_zero towards
+ * one_zero, and zero_one towards one_one), and the second blends
+ * between the results. Exactly three lerps; see lerp for the
+ * treatment of types and weights. */
+inline Expr bilerp(Expr zero_zero, Expr one_zero,
+                   Expr zero_one, Expr one_one,
+                   Expr weight_x, Expr weight_y) {
+    Expr lower = lerp(std::move(zero_zero), std::move(one_zero), weight_x);
+    Expr upper = lerp(std::move(zero_one), std::move(one_one), std::move(weight_x));
+    return lerp(std::move(lower), std::move(upper), std::move(weight_y));
+}
+
+/** The approximate version of bilerp, built on fast_lerp. The errors
+ * of the three fast_lerps can compound to around 4 for UInt(8). */
+inline Expr fast_bilerp(Expr zero_zero, Expr one_zero,
+                        Expr zero_one, Expr one_one,
+                        Expr weight_x, Expr weight_y) {
+    Expr lower = fast_lerp(std::move(zero_zero), std::move(one_zero), weight_x);
+    Expr upper = fast_lerp(std::move(zero_one), std::move(one_one), std::move(weight_x));
+    return fast_lerp(std::move(lower), std::move(upper), std::move(weight_y));
+}
+
 /** Count the number of set bits in an expression. */
 inline Expr popcount(Expr x) {
     user_assert(x.defined()) << "popcount of undefined Expr\n";
@@ -1799,6 +2062,13 @@ inline HALIDE_NO_USER_CODE_INLINE Expr require(Expr condition, Expr value, Args&
 
 // @}
 
+namespace Internal {
+/** Build the error Expr raised when a requirement condition fails: a
+ * call to halide_error_requirement_failed with the stringified
+ * condition and the user's error args. Used by require() and
+ * Pipeline::add_requirement. */
+Expr requirement_failed_error(Expr condition, const std::vector<Expr> &args);
+}  // namespace Internal
 
 /** Return an undef value of the given type. Halide skips stores that
  * depend on undef values, so you can use this to mean "do not modify
@@ -27,6 +27,9 @@ ostream &operator<<(ostream &out, const Type &type) {
     case Type::Float:
         out << "float";
         break;
+    case Type::BFloat:
+        out << "bfloat";
+        break;
     case Type::Handle:
         if (type.handle_type) {
             out << "(" << type.handle_type->inner_name.name << " *)";
@@ -118,6 +121,9 @@ std::ostream &operator<<(std::ostream &out, const MemoryType &t) {
     case MemoryType::GPUShared:
         out << "GPUShared";
         break;
+    case MemoryType::VTCM:
+        out << "VTCM";
+        break;
     }
     return out;
 }
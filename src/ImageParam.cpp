@@ -67,6 +67,60 @@ ImageParam::operator Func() const {
     return func;
 }
 
+Func ImageParam::bind_producer(const Func &producer) {
+    internal_assert(func.defined());
+    user_assert(producer.defined())
+        << "Cannot bind ImageParam " << name()
+        << " to undefined producer Func " << producer.name() << "\n";
+    user_assert(producer.outputs() == 1)
+        << "Cannot bind ImageParam " << name()
+        << " to Tuple-valued producer Func " << producer.name() << "\n";
+    user_assert(producer.output_types()[0] == type())
+        << "Cannot bind ImageParam " << name()
+        << " of type " << type()
+        << " to producer Func " << producer.name()
+        << " of type " << producer.output_types()[0] << "\n";
+    user_assert(producer.dimensions() == dimensions())
+        << "Cannot bind " << dimensions() << "-dimensional ImageParam " << name()
+        << " to " << producer.dimensions() << "-dimensional producer Func "
+        << producer.name() << "\n";
+
+    // Rewrite the definition of the Func that mediates access to this
+    // parameter so that it calls the producer instead of loading from
+    // the bound buffer. Existing calls to this ImageParam all go
+    // through that Func, so they now reach the producer's pipeline.
+    std::vector<Expr> args_expr;
+    for (int i = 0; i < dimensions(); ++i) {
+        args_expr.push_back(Var::implicit(i));
+    }
+    func.function().definition().values()[0] = producer(args_expr);
+    return func;
+}
+
+Func ImageParam::bind_fill(const std::string &fill_function_name,
+                           const std::vector<ExternFuncArgument> &extern_args) {
+    internal_assert(func.defined());
+    user_assert(!fill_function_name.empty())
+        << "Cannot bind ImageParam " << name()
+        << " to an empty fill function name\n";
+
+    // An extern stage stands in for the input. Bounds inference hands
+    // it the box of the input each consumer requires, so the fill
+    // function only ever sees the regions actually read.
+    Func filled(name() + "_fill");
+    filled.define_extern(fill_function_name, extern_args, type(), dimensions());
+
+    // Rewrite the definition of the Func that mediates access to this
+    // parameter so that it calls the extern stage instead of loading
+    // from the bound buffer (as in bind_producer).
+    std::vector<Expr> args_expr;
+    for (int i = 0; i < dimensions(); ++i) {
+        args_expr.push_back(Var::implicit(i));
+    }
+    func.function().definition().values()[0] = filled(args_expr);
+    return filled;
+}
+
 Func ImageParam::in(const Func &f) {
     internal_assert(func.defined());
     return func.in(f);
@@ -124,6 +124,74 @@ public:
     Func in();
     // @}
 
+    /** Bind this ImageParam to the output Func of another pipeline, so
+     * that the two pipelines compile as one and the boundary can be
+     * scheduled. Loads from this ImageParam become calls to 'producer',
+     * and this ImageParam no longer appears as an argument of the
+     * combined pipeline (the producer's own arguments take its place).
+     *
+     * This is useful for fusing separately-authored pipelines without
+     * realizing the intermediate result into memory:
+     \code
+     // From the producer library:
+     Func denoised = make_denoise(raw);
+     // The consumer was authored against an ImageParam:
+     ImageParam img(Int(32), 2);
+     Func toned;
+     toned(x, y) = ... img(x, y) ...
+     // Fuse them:
+     img.bind_producer(denoised);
+     denoised.compute_at(toned, y);
+     \endcode
+     *
+     * The rewrite happens via this ImageParam's intrinsic Func
+     * representation (see \ref ImageParam::in), whose definition is
+     * replaced with a call to 'producer'. That wrapper Func is returned
+     * and may itself be scheduled to stage the boundary; its dimensions
+     * are named with implicit vars (_0, _1, ...). By default it is
+     * inlined, so calls to this ImageParam reach 'producer' directly.
+     *
+     * 'producer' must be a defined, non-Tuple Func whose type and
+     * dimensionality match this ImageParam. Any Buffer previously bound
+     * with set() is ignored. For a producer pipeline with multiple
+     * outputs, bind each output Func to its own ImageParam. */
+    Func bind_producer(const Func &producer);
+
+    /** Bind this ImageParam to an extern "fill" function, so that the
+     * required region of the input is populated on demand instead of
+     * being materialized in full before realization. This is useful
+     * when the input lives in some external store (a file, a tiled
+     * database) and the pipeline only touches a crop of it.
+     *
+     * 'fill_function_name' names an extern function following the
+     * same protocol as \ref Func::define_extern: it is passed
+     * 'extern_args' followed by an output halide_buffer_t. When the
+     * buffer's host pointer is null it is a bounds query and the
+     * function may adjust the requested box; otherwise it must fill
+     * the region described by the buffer's mins and extents.
+     *
+     \code
+     ImageParam img(Float(32), 2);
+     Func blurry;
+     blurry(x, y) = ... img(x, y) ...
+     Func fill = img.bind_fill("load_tile");
+     blurry.tile(x, y, xi, yi, 64, 64);
+     fill.compute_at(blurry, x);  // load_tile is called once per tile
+     \endcode
+     *
+     * The returned Func is the extern stage; schedule it compute_at
+     * the consumer's tile loop to fetch each tile's required box as
+     * it is needed, or compute_root to fetch the pipeline's entire
+     * required region in one call (still just the region bounds
+     * inference proves necessary, not the whole input).
+     *
+     * Like \ref ImageParam::bind_producer, this replaces the
+     * definition of the Func that mediates access to this parameter,
+     * so the ImageParam no longer appears as a pipeline argument and
+     * any Buffer bound with set() is ignored. */
+    Func bind_fill(const std::string &fill_function_name,
+                   const std::vector<ExternFuncArgument> &extern_args = std::vector<ExternFuncArgument>());
+
     /** Return true iff the name was explicitly specified in the ctor (vs autogenerated). */
     bool is_explicit_name() const {
         return param.is_explicit_name();
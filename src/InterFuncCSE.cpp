@@ -0,0 +1,300 @@
+#include <algorithm>
+
+#include "InterFuncCSE.h"
+
+#include "Debug.h"
+#include "IREquality.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Substitute.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Subexpressions smaller than this (counted in IR nodes) are not
+// worth the overhead of an extra Func boundary; within-definition CSE
+// already handles them where it matters.
+const int min_subexpr_size = 8;
+
+// The canonical names given to the pure arguments of an extracted
+// subexpression. Chosen to be unlikely to collide with the name of
+// any Param or ImageParam referenced by the subexpression.
+string canonical_arg_name(size_t i) {
+    return "cse_arg$" + std::to_string(i);
+}
+
+// Decides whether an expression may be extracted into its own Func:
+// it must be pure, refer only to the enclosing definition's pure
+// arguments, and call at least one other Func or input image (purely
+// arithmetic expressions are better left where they are). Also
+// records the distinct pure arguments used, in the order they are
+// first encountered; this defines the argument order of the
+// extracted Func.
+class AnalyzeCandidate : public IRGraphVisitor {
+    const set<string> &pure_args;
+
+    using IRGraphVisitor::visit;
+
+    void include(const Expr &e) override {
+        size++;
+        IRGraphVisitor::include(e);
+    }
+
+    void visit(const Variable *op) override {
+        if (op->param.defined() || op->image.defined()) {
+            return;
+        }
+        if (pure_args.count(op->name)) {
+            if (std::find(args_used.begin(), args_used.end(), op->name) == args_used.end()) {
+                args_used.push_back(op->name);
+            }
+        } else {
+            // A reduction variable or a let binding.
+            valid = false;
+        }
+    }
+
+    void visit(const Call *op) override {
+        switch (op->call_type) {
+        case Call::Halide:
+        case Call::Image:
+            calls_func = true;
+            break;
+        case Call::PureExtern:
+        case Call::PureIntrinsic:
+            break;
+        default:
+            // Impure, so not safe to reorder or deduplicate.
+            valid = false;
+            return;
+        }
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Let *op) override {
+        // Lifting an expression that contains a binding would require
+        // rewriting the binding too. Not worth the complexity.
+        valid = false;
+    }
+
+    void visit(const Load *op) override {
+        valid = false;
+    }
+
+public:
+    bool valid = true;
+    bool calls_func = false;
+    int size = 0;
+    vector<string> args_used;
+
+    AnalyzeCandidate(const set<string> &pure_args) : pure_args(pure_args) {}
+
+    void analyze(const Expr &e) {
+        IRGraphVisitor::include(e);
+        size++;
+    }
+};
+
+// Rewrite an expression over the enclosing definition's pure
+// arguments into canonical form, so that structurally identical
+// subexpressions from different Funcs compare equal.
+Expr normalize(const Expr &e, const vector<string> &args_used) {
+    map<string, Expr> renaming;
+    for (size_t i = 0; i < args_used.size(); i++) {
+        renaming.emplace(args_used[i], Variable::make(Int(32), canonical_arg_name(i)));
+    }
+    return substitute(renaming, e);
+}
+
+// Everything we know about one candidate subexpression, keyed in a
+// map by its normalized form.
+struct CandidateInfo {
+    // The Funcs whose pure definitions contain the subexpression.
+    set<string> users;
+    // Number of pure arguments the subexpression depends on.
+    size_t num_args = 0;
+    // If the subexpression is already the entire value of some Func,
+    // that Func; callers should reuse it instead of defining a new
+    // one.
+    Function existing;
+    // The Func calls to the subexpression should resolve to (either
+    // 'existing' or a newly created Func). Set once the candidate is
+    // chosen for extraction.
+    Function extracted;
+};
+
+// Walks a definition's value and records every subexpression that
+// could be extracted.
+class CollectCandidates : public IRGraphVisitor {
+    const set<string> &pure_args;
+    const string &func;
+    map<Expr, CandidateInfo, IRDeepCompare> &candidates;
+
+    void include(const Expr &e) override {
+        AnalyzeCandidate analyzer(pure_args);
+        analyzer.analyze(e);
+        if (analyzer.valid && analyzer.calls_func && analyzer.size >= min_subexpr_size) {
+            CandidateInfo &info = candidates[normalize(e, analyzer.args_used)];
+            info.users.insert(func);
+            info.num_args = analyzer.args_used.size();
+        }
+        IRGraphVisitor::include(e);
+    }
+
+public:
+    CollectCandidates(const set<string> &pure_args, const string &func,
+                      map<Expr, CandidateInfo, IRDeepCompare> &candidates)
+        : pure_args(pure_args), func(func), candidates(candidates) {}
+
+    void collect(const Expr &e) {
+        include(e);
+    }
+};
+
+// Replaces occurrences of the chosen subexpressions with calls to the
+// Funcs that now compute them.
+class ExtractChosen : public IRMutator2 {
+    const set<string> &pure_args;
+    const string &func;
+    const map<Expr, CandidateInfo, IRDeepCompare> &chosen;
+
+    using IRMutator2::visit;
+
+public:
+    int replacements = 0;
+
+    ExtractChosen(const set<string> &pure_args, const string &func,
+                  const map<Expr, CandidateInfo, IRDeepCompare> &chosen)
+        : pure_args(pure_args), func(func), chosen(chosen) {}
+
+    using IRMutator2::mutate;
+
+    Expr mutate(const Expr &e) override {
+        if (e.defined()) {
+            AnalyzeCandidate analyzer(pure_args);
+            analyzer.analyze(e);
+            if (analyzer.valid && analyzer.calls_func && analyzer.size >= min_subexpr_size) {
+                auto it = chosen.find(normalize(e, analyzer.args_used));
+                // Don't rewrite a Func in terms of itself; if this
+                // subexpression is the entire value of 'func', it is
+                // the one occurrence that must stay put.
+                if (it != chosen.end() && it->second.extracted.name() != func) {
+                    vector<Expr> call_args;
+                    for (const string &arg : analyzer.args_used) {
+                        call_args.push_back(Variable::make(Int(32), arg));
+                    }
+                    replacements++;
+                    return Call::make(it->second.extracted, call_args);
+                }
+            }
+        }
+        return IRMutator2::mutate(e);
+    }
+};
+
+}  // anonymous namespace
+
+int extract_inter_func_cse(map<string, Function> &env) {
+    // Step 1: gather every extractable subexpression of every pure
+    // definition, keyed by normalized form so identical computations
+    // in different Funcs land on the same entry.
+    map<Expr, CandidateInfo, IRDeepCompare> candidates;
+    for (const auto &iter : env) {
+        const Function &f = iter.second;
+        if (!f.has_pure_definition() || f.has_extern_definition()) {
+            continue;
+        }
+        set<string> pure_args(f.args().begin(), f.args().end());
+        for (const Expr &value : f.definition().values()) {
+            CollectCandidates collector(pure_args, f.name(), candidates);
+            collector.collect(value);
+
+            // If this Func is just this value, other users of the
+            // same expression should call it rather than a new Func.
+            if (f.definition().values().size() == 1 && !f.has_update_definition()) {
+                AnalyzeCandidate analyzer(pure_args);
+                analyzer.analyze(value);
+                // Callers pass arguments in the order the
+                // subexpression first uses them, so this Func is only
+                // reusable if that matches its declared argument
+                // order.
+                if (analyzer.valid && analyzer.calls_func &&
+                    analyzer.size >= min_subexpr_size &&
+                    analyzer.args_used == f.args()) {
+                    candidates[normalize(value, analyzer.args_used)].existing = f;
+                }
+            }
+        }
+    }
+
+    // Step 2: pick the subexpressions computed by more than one Func,
+    // and create a Func for each one that doesn't already have one.
+    map<Expr, CandidateInfo, IRDeepCompare> chosen;
+    int num_extracted = 0;
+    for (auto &iter : candidates) {
+        CandidateInfo &info = iter.second;
+        if (info.users.size() < 2) {
+            continue;
+        }
+        if (info.existing.get_contents().defined()) {
+            info.extracted = info.existing;
+            debug(1) << "Inter-Func CSE: rewriting " << (info.users.size() - 1)
+                     << " Func(s) to reuse \"" << info.extracted.name()
+                     << "\", which already computes " << iter.first << "\n";
+        } else {
+            Function f(unique_name("common_subexpr"));
+            vector<string> arg_names;
+            for (size_t i = 0; i < info.num_args; i++) {
+                arg_names.push_back(canonical_arg_name(i));
+            }
+            f.define(arg_names, {iter.first});
+            info.extracted = f;
+            debug(1) << "Inter-Func CSE: extracting subexpression shared by "
+                     << info.users.size() << " Funcs into \"" << f.name()
+                     << "\": " << iter.first << "\n";
+        }
+        chosen.emplace(iter.first, info);
+        num_extracted++;
+    }
+
+    if (chosen.empty()) {
+        return 0;
+    }
+
+    // Step 3: rewrite the using definitions to call the extracted
+    // Funcs. Since mutate() checks each expression before descending
+    // into it, the largest chosen subexpression at any position wins.
+    for (auto &iter : env) {
+        Function &f = iter.second;
+        if (!f.has_pure_definition() || f.has_extern_definition()) {
+            continue;
+        }
+        set<string> pure_args(f.args().begin(), f.args().end());
+        ExtractChosen extractor(pure_args, f.name(), chosen);
+        for (Expr &value : f.definition().values()) {
+            value = extractor.mutate(value);
+        }
+    }
+
+    // Step 4: add the newly created Funcs to the environment.
+    for (const auto &iter : chosen) {
+        const Function &f = iter.second.extracted;
+        if (env.find(f.name()) == env.end()) {
+            env.emplace(f.name(), f);
+        }
+    }
+
+    return num_extracted;
+}
+
+}  // namespace Internal
+}  // namespace Halide
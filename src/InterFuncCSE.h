@@ -0,0 +1,36 @@
+#ifndef HALIDE_INTER_FUNC_CSE_H
+#define HALIDE_INTER_FUNC_CSE_H
+
+/** \file
+ *
+ * Defines a pass that extracts non-trivial subexpressions computed
+ * identically by several Funcs into new shared Funcs. The usual CSE
+ * in CSE.cpp works within a single definition; this pass works across
+ * Func boundaries.
+ */
+
+#include <map>
+#include <string>
+
+#include "Function.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Find non-trivial subexpressions that two or more Funcs in 'env'
+ * compute identically (up to renaming of their pure definition
+ * arguments), define a new pure Func computing each one, and rewrite
+ * the using definitions to call it instead. If such a subexpression
+ * is already the entire value of some Func in 'env', the other users
+ * are rewritten to call that Func rather than a new one. Newly
+ * created Funcs are added to 'env' with their default (inlined)
+ * schedules, so a subsequent scheduling pass decides whether each one
+ * is actually worth materializing; if they all stay inlined, the
+ * pipeline computes exactly what it did before. Only pure definitions
+ * are considered. Returns the number of subexpressions extracted. */
+int extract_inter_func_cse(std::map<std::string, Function> &env);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -43,6 +43,26 @@ class DebugSections {
 
     bool calibrated;
 
+    // The binary stays mapped for the lifetime of this object
+    // (ObjectFile::createObjectFile memory-maps it), so we can locate
+    // the debug sections cheaply up front and defer the expensive
+    // DWARF walk until the first query that actually needs it.
+    llvm::object::OwningBinary<llvm::object::ObjectFile> object_file;
+    llvm::StringRef debug_info_section, debug_abbrev_section, debug_str_section,
+        debug_line_section, debug_ranges_section;
+    uint8_t address_size;
+    bool parsed;
+
+    // The canary tests registered by each compilation unit at static
+    // initialization time. They query the debug info themselves, so
+    // running them is deferred along with the parse.
+    struct CanaryTest {
+        bool (*test)(bool (*)(const void *, const std::string &));
+        bool (*test_a)(const void *, const std::string &);
+        void (*calib)();
+    };
+    vector<CanaryTest> pending_tests;
+
     struct FieldFormat {
         uint64_t name, form;
         FieldFormat() : name(0), form(0) {}
@@ -164,7 +184,7 @@ public:
 
     bool working;
 
-    DebugSections(std::string binary) : calibrated(false), working(false) {
+    DebugSections(std::string binary) : calibrated(false), address_size(0), parsed(false), working(false) {
         #ifdef __APPLE__
         size_t last_slash = binary.rfind('/');
         if (last_slash == std::string::npos ||
@@ -179,7 +199,16 @@ public:
 
         debug(5) << "Loading " << binary << "\n";
 
-        load_and_parse_object_file(binary);
+        load_object_file(binary);
+    }
+
+    /** Queue up a per-compilation-unit canary test to run when the
+     * debug info is first queried. */
+    void defer_canary_test(bool (*test)(bool (*)(const void *, const std::string &)),
+                           bool (*test_a)(const void *, const std::string &),
+                           void (*calib)()) {
+        CanaryTest t = {test, test_a, calib};
+        pending_tests.push_back(t);
     }
 
     int count_trailing_zeros(int64_t x) {
@@ -316,6 +345,8 @@ public:
 
     // Get the debug name of a global var from a pointer to it
     std::string get_global_variable_name(const void *global_pointer, const std::string &type_name = "") {
+        ensure_parsed();
+        if (!working) return "";
         // Find the index of the first global variable with this address
         int idx = find_global_variable(global_pointer);
 
@@ -371,6 +402,8 @@ public:
     }
 
     void register_heap_object(const void *obj, size_t size, const void *helper) {
+        ensure_parsed();
+        if (!working) return;
         // helper should be a pointer to a global
         int idx = find_global_variable(helper);
         if (idx == -1) {
@@ -472,6 +505,8 @@ public:
 
     // Get the debug name of a member of a heap variable from a pointer to it
     std::string get_heap_member_name(const void *ptr, const std::string &type_name = "") {
+        ensure_parsed();
+        if (!working) return "";
         debug(5) << "Getting heap member name of " << ptr << "\n";
 
         if (heap_objects.empty()) {
@@ -558,6 +593,8 @@ public:
 
     // Get the debug name of a stack variable from a pointer to it
     std::string get_stack_variable_name(const void *stack_pointer, const std::string &type_name = "") {
+        ensure_parsed();
+        if (!working) return "";
 
         // Check it's a plausible stack pointer
         int marker = 0;
@@ -710,6 +747,8 @@ public:
 
     // Look up n stack frames and get the source location as filename:line
     std::string get_source_location() {
+        ensure_parsed();
+        if (!working) return "";
         debug(5) << "Finding source location\n";
 
         if (!source_lines.size()) {
@@ -790,6 +829,7 @@ public:
     }
 
     void dump() {
+        ensure_parsed();
         // Dump all the types
         for (size_t i = 0; i < types.size(); i++) {
             printf("Class %s of size %llu @ %llx: \n",
@@ -864,10 +904,11 @@ public:
 
 private:
 
-    void load_and_parse_object_file(const std::string &binary) {
-        llvm::object::ObjectFile *obj = nullptr;
-
-        // Open the object file in question.
+    void load_object_file(const std::string &binary) {
+        // Open the object file in question. This memory-maps it, so
+        // locating the debug sections below touches only the section
+        // table, and the expensive DWARF walk can wait until a query
+        // needs it.
         llvm::Expected<llvm::object::OwningBinary<llvm::object::ObjectFile>> maybe_obj =
             llvm::object::ObjectFile::createObjectFile(binary);
 
@@ -877,21 +918,16 @@ private:
             return;
         }
 
-        obj = maybe_obj.get().getBinary();
+        object_file = std::move(maybe_obj.get());
+        llvm::object::ObjectFile *obj = object_file.getBinary();
 
-        if (obj) {
-            working = true;
-            parse_object_file(obj);
-        } else {
+        if (!obj) {
             debug(1) << "Could not load object file: " << binary << "\n";
             working = false;
+            return;
         }
-    }
 
-    void parse_object_file(llvm::object::ObjectFile *obj) {
         // Look for the debug_info, debug_abbrev, debug_line, and debug_str sections
-        llvm::StringRef debug_info, debug_abbrev, debug_str, debug_line, debug_ranges;
-
 #ifdef __APPLE__
         std::string prefix = "__";
 #else
@@ -904,39 +940,67 @@ private:
             iter->getName(name);
             debug(2) << "Section: " << name.str() << "\n";
             if (name == prefix + "debug_info") {
-                iter->getContents(debug_info);
+                iter->getContents(debug_info_section);
             } else if (name == prefix + "debug_abbrev") {
-                iter->getContents(debug_abbrev);
+                iter->getContents(debug_abbrev_section);
             } else if (name == prefix + "debug_str") {
-                iter->getContents(debug_str);
+                iter->getContents(debug_str_section);
             } else if (name == prefix + "debug_line") {
-                iter->getContents(debug_line);
+                iter->getContents(debug_line_section);
             } else if (name == prefix + "debug_ranges") {
-                iter->getContents(debug_ranges);
+                iter->getContents(debug_ranges_section);
             }
         }
 
-        if (debug_info.empty() ||
-            debug_abbrev.empty() ||
-            debug_str.empty() ||
-            debug_line.empty() ||
-            debug_ranges.empty()) {
+        if (debug_info_section.empty() ||
+            debug_abbrev_section.empty() ||
+            debug_str_section.empty() ||
+            debug_line_section.empty() ||
+            debug_ranges_section.empty()) {
             debug(2) << "Debugging sections not found\n";
             working = false;
             return;
         }
 
+        address_size = obj->getBytesInAddress();
+        working = true;
+    }
+
+    /** Parse the DWARF on first demand, then calibrate and run the
+     * deferred per-compilation-unit canary tests. The tests issue
+     * queries themselves, which is fine: the parsed flag is set
+     * before they run. */
+    void ensure_parsed() {
+        if (parsed || !working) {
+            return;
+        }
+        parsed = true;
+
         {
             // Parse the debug_info section to populate the functions and local variables
-            llvm::DataExtractor extractor(debug_info, true, obj->getBytesInAddress());
-            llvm::DataExtractor debug_abbrev_extractor(debug_abbrev, true, obj->getBytesInAddress());
-            parse_debug_info(extractor, debug_abbrev_extractor, debug_str, debug_ranges);
+            llvm::DataExtractor extractor(debug_info_section, true, address_size);
+            llvm::DataExtractor debug_abbrev_extractor(debug_abbrev_section, true, address_size);
+            parse_debug_info(extractor, debug_abbrev_extractor, debug_str_section, debug_ranges_section);
         }
 
         {
-            llvm::DataExtractor e(debug_line, true, obj->getBytesInAddress());
+            llvm::DataExtractor e(debug_line_section, true, address_size);
             parse_debug_line(e);
         }
+
+        for (size_t i = 0; i < pending_tests.size() && working; i++) {
+            const CanaryTest &t = pending_tests[i];
+            calibrate_pc_offset(t.calib);
+            if (!working) {
+                debug(5) << "Failed because offset calibration failed\n";
+                break;
+            }
+            working = (*t.test)(t.test_a);
+            if (!working) {
+                debug(5) << "Failed because test routine failed\n";
+            }
+        }
+        pending_tests.clear();
     }
 
     void parse_debug_ranges(const llvm::DataExtractor &e) {
@@ -2239,19 +2303,10 @@ void test_compilation_unit(bool (*test)(bool (*)(const void *, const std::string
         debug_sections->working = false;
         debug(5) << "Failed because frame pointer not saved\n";
     } else if (debug_sections->working) {
-        debug_sections->calibrate_pc_offset(calib);
-        if (!debug_sections->working) {
-            debug(5) << "Failed because offset calibration failed\n";
-            return;
-        }
-
-        debug_sections->working = (*test)(test_a);
-        if (!debug_sections->working) {
-            debug(5) << "Failed because test routine failed\n";
-            return;
-        }
-
-        debug(5) << "Test passed\n";
+        // This runs at static initialization time, so don't force the
+        // DWARF parse here; queue the test (and its calibration
+        // marker) to run when the debug info is first queried.
+        debug_sections->defer_canary_test(test, test_a, calib);
     }
 
     //debug_sections->dump();
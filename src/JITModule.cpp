@@ -1,7 +1,9 @@
 #include <string>
+#include <string.h>
 #include <stdint.h>
 #include <mutex>
 #include <set>
+#include <thread>
 
 #ifndef _WIN32
 #include <sys/mman.h>
@@ -114,6 +116,62 @@ void load_metal() {
 #endif
 }
 
+// An opt-in on-disk cache of JIT-compiled objects, enabled by setting
+// HL_JIT_OBJECT_CACHE_DIR to a writable directory. Objects are keyed
+// on a hash of the module's bitcode (which encodes the lowered
+// pipeline), the target string, and the build of libHalide, so warm
+// starts skip LLVM codegen and load machine code from disk instead.
+class JITObjectCache : public llvm::ObjectCache {
+public:
+    JITObjectCache(const std::string &dir, const std::string &key)
+        : path(dir + "/halide_jit_" + key + ".o") {}
+
+    void notifyObjectCompiled(const llvm::Module *, llvm::MemoryBufferRef obj) override {
+        std::error_code err;
+        llvm::raw_fd_ostream file(path, err, llvm::sys::fs::F_None);
+        if (err) {
+            debug(1) << "Could not write JIT object cache entry " << path << "\n";
+            return;
+        }
+        file << obj.getBuffer();
+    }
+
+    std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *) override {
+        auto buffer = llvm::MemoryBuffer::getFile(path);
+        if (!buffer) {
+            return nullptr;
+        }
+        debug(1) << "Loading JIT-compiled object from cache entry " << path << "\n";
+        return std::move(*buffer);
+    }
+
+    // Compute the cache key for a module about to be compiled for the
+    // given target.
+    static std::string key_for_module(const llvm::Module &m, const Target &target) {
+        llvm::SmallVector<char, 4096> bitcode;
+        llvm::raw_svector_ostream bitcode_stream(bitcode);
+#if LLVM_VERSION >= 70
+        llvm::WriteBitcodeToFile(m, bitcode_stream);
+#else
+        llvm::WriteBitcodeToFile(&m, bitcode_stream);
+#endif
+        llvm::MD5 hash;
+        hash.update(llvm::StringRef(bitcode.data(), bitcode.size()));
+        hash.update(target.to_string());
+        // Salt with the libHalide build, so stale objects from older
+        // compilers are never loaded.
+        hash.update(__DATE__ " " __TIME__);
+        llvm::MD5::MD5Result result;
+        hash.final(result);
+        llvm::SmallString<32> digest;
+        llvm::MD5::stringifyResult(result, digest);
+        return digest.str();
+    }
+
+private:
+    std::string path;
+};
+
 }  // namespace
 
 using namespace llvm;
@@ -136,6 +194,8 @@ public:
     std::map<std::string, JITModule::Symbol> exports;
     llvm::LLVMContext context;
     ExecutionEngine *execution_engine;
+    // Must outlive the execution engine, which holds a raw pointer to it.
+    std::unique_ptr<llvm::ObjectCache> object_cache;
     std::vector<JITModule> dependencies;
     JITModule::Symbol entrypoint;
     JITModule::Symbol argv_entrypoint;
@@ -265,10 +325,23 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     string mattrs;
     llvm::TargetOptions options;
     get_target_options(*m, options, mcpu, mattrs);
+    // At reduced optimization levels, use fast instruction selection as
+    // well: schedule exploration cares about compile latency, not peak
+    // code quality.
+    const int opt_level = llvm_opt_level();
+    options.EnableFastISel = (opt_level < 2);
 
     DataLayout initial_module_data_layout = m->getDataLayout();
     string module_name = m->getModuleIdentifier();
 
+    // If the user has opted in to the on-disk object cache, key this
+    // module before the engine builder takes ownership of it.
+    string object_cache_dir = get_env_variable("HL_JIT_OBJECT_CACHE_DIR");
+    if (!object_cache_dir.empty()) {
+        jit_module->object_cache.reset(
+            new JITObjectCache(object_cache_dir, JITObjectCache::key_for_module(*m, target)));
+    }
+
     llvm::EngineBuilder engine_builder((std::move(m)));
     engine_builder.setTargetOptions(options);
     engine_builder.setErrorStr(&error_string);
@@ -276,7 +349,9 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     HalideJITMemoryManager *memory_manager = new HalideJITMemoryManager(dependencies);
     engine_builder.setMCJITMemoryManager(std::unique_ptr<RTDyldMemoryManager>(memory_manager));
 
-    engine_builder.setOptLevel(CodeGenOpt::Aggressive);
+    const CodeGenOpt::Level codegen_opt_levels[4] =
+        {CodeGenOpt::None, CodeGenOpt::Less, CodeGenOpt::Default, CodeGenOpt::Aggressive};
+    engine_builder.setOptLevel(codegen_opt_levels[opt_level]);
     if (!mcpu.empty()) {
         engine_builder.setMCPU(mcpu);
     }
@@ -297,6 +372,10 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     if (!ee) std::cerr << error_string << "\n";
     internal_assert(ee) << "Couldn't create execution engine\n";
 
+    if (jit_module->object_cache) {
+        ee->setObjectCache(jit_module->object_cache.get());
+    }
+
     // Do any target-specific initialization
     std::vector<llvm::JITEventListener *> listeners;
 
@@ -453,6 +532,46 @@ void JITModule::memoization_cache_set_size(int64_t size) const {
     }
 }
 
+void JITModule::memoization_cache_set_device_size(int64_t size) const {
+    std::map<std::string, Symbol>::const_iterator f =
+        exports().find("halide_memoization_cache_set_device_size");
+    if (f != exports().end()) {
+        return (reinterpret_bits<void (*)(int64_t)>(f->second.address))(size);
+    }
+}
+
+void JITModule::memoization_cache_evict(uint64_t eviction_key) const {
+    std::map<std::string, Symbol>::const_iterator f =
+        exports().find("halide_memoization_cache_evict");
+    if (f != exports().end()) {
+        return (reinterpret_bits<void (*)(void *, uint64_t)>(f->second.address))(NULL, eviction_key);
+    }
+}
+
+void JITModule::memoization_cache_get_stats(struct halide_memoization_cache_stats *stats) const {
+    std::map<std::string, Symbol>::const_iterator f =
+        exports().find("halide_memoization_cache_get_stats");
+    if (f != exports().end()) {
+        return (reinterpret_bits<void (*)(struct halide_memoization_cache_stats *)>(f->second.address))(stats);
+    }
+}
+
+void JITModule::trace_set_func_filter(const char *funcs) const {
+    std::map<std::string, Symbol>::const_iterator f =
+        exports().find("halide_trace_set_func_filter");
+    if (f != exports().end()) {
+        (reinterpret_bits<int (*)(void *, const char *)>(f->second.address))(NULL, funcs);
+    }
+}
+
+void JITModule::trace_set_sample_rate(int rate) const {
+    std::map<std::string, Symbol>::const_iterator f =
+        exports().find("halide_trace_set_sample_rate");
+    if (f != exports().end()) {
+        (reinterpret_bits<int (*)(void *, int)>(f->second.address))(NULL, rate);
+    }
+}
+
 bool JITModule::compiled() const {
   return jit_module->execution_engine != nullptr;
 }
@@ -463,6 +582,9 @@ JITHandlers runtime_internal_handlers;
 JITHandlers default_handlers;
 JITHandlers active_handlers;
 int64_t default_cache_size;
+int64_t default_device_cache_size;
+std::string default_trace_func_filter;
+int default_trace_sample_rate = 1;
 
 void merge_handlers(JITHandlers &base, const JITHandlers &addins) {
     if (addins.custom_print) {
@@ -601,9 +723,10 @@ std::mutex shared_runtimes_mutex;
 // shared across JIT compilations that do not use the same target
 // options. At present, the split is into a MainShared module that
 // contains most of the runtime except for device API specific code
-// (GPU runtimes). There is one shared runtime per device API and a
-// the JITModule for a Func depends on all device API modules
-// specified in the target when it is JITted. (Instruction set variant
+// (GPU runtimes). There is one shared runtime per device API, and
+// the JITModule for a Func depends on the device API modules that are
+// enabled in the target *and* actually referenced by the compiled
+// pipeline; each is compiled on first use. (Instruction set variant
 // specific code, such as math routines, is inlined into the module
 // produced by compiling a Func so it can be specialized exactly for
 // each target.)
@@ -740,6 +863,15 @@ JITModule &make_module(llvm::Module *for_module, Target target,
             if (default_cache_size != 0) {
                 runtime.memoization_cache_set_size(default_cache_size);
             }
+            if (default_device_cache_size != 0) {
+                runtime.memoization_cache_set_device_size(default_device_cache_size);
+            }
+            if (!default_trace_func_filter.empty()) {
+                runtime.trace_set_func_filter(default_trace_func_filter.c_str());
+            }
+            if (default_trace_sample_rate > 1) {
+                runtime.trace_set_sample_rate(default_trace_sample_rate);
+            }
 
             runtime.jit_module->name = "MainShared";
         } else {
@@ -759,6 +891,39 @@ JITModule &make_module(llvm::Module *for_module, Target target,
     return runtime;
 }
 
+// The symbol prefix a device API's runtime module provides, or
+// nullptr for kinds that are always needed.
+const char *runtime_kind_symbol_prefix(RuntimeKind kind) {
+    switch (kind) {
+    case OpenCL:        return "halide_opencl_";
+    case Metal:         return "halide_metal_";
+    case CUDA:          return "halide_cuda_";
+    case OpenGL:        return "halide_opengl_";
+    case OpenGLCompute: return "halide_openglcompute_";
+    case Hexagon:       return "halide_hexagon_";
+    default:            return nullptr;
+    }
+}
+
+// Does the compiled pipeline actually call into the given device
+// runtime? Targets often enable a device API as a capability (e.g. a
+// host-cuda default target), but a pipeline that schedules nothing on
+// that device makes no halide_cuda_* calls, and compiling the device
+// runtime for it would be pure cold-start cost.
+bool module_uses_runtime_kind(llvm::Module *for_module, RuntimeKind kind) {
+    const char *prefix = runtime_kind_symbol_prefix(kind);
+    if (!for_module || !prefix) {
+        // Nothing to inspect; assume it's needed.
+        return true;
+    }
+    for (const auto &f : *for_module) {
+        if (f.isDeclaration() && f.getName().startswith(prefix)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 }  // anonymous namespace
 
 /* Shared runtimes are stored as global state. The set needed is
@@ -779,40 +944,71 @@ std::vector<JITModule> JITSharedRuntime::get(llvm::Module *for_module, const Tar
         result.push_back(m);
     }
 
-    // Add all requested GPU modules, each only depending on the main shared runtime.
-    std::vector<JITModule> gpu_modules;
-    if (target.has_feature(Target::OpenCL)) {
-        JITModule m = make_module(for_module, target, OpenCL, result, create);
-        if (m.compiled()) {
-            result.push_back(m);
-        }
+    // Work out which device runtime modules this pipeline needs. A
+    // device API enabled in the target is only a capability; the
+    // device runtime is compiled lazily, when a pipeline that
+    // references its symbols first turns up.
+    std::vector<RuntimeKind> needed;
+    if (target.has_feature(Target::OpenCL) &&
+        module_uses_runtime_kind(for_module, OpenCL)) {
+        needed.push_back(OpenCL);
     }
-    if (target.has_feature(Target::Metal)) {
-        JITModule m = make_module(for_module, target, Metal, result, create);
-        if (m.compiled()) {
-            result.push_back(m);
-        }
+    if (target.has_feature(Target::Metal) &&
+        module_uses_runtime_kind(for_module, Metal)) {
+        needed.push_back(Metal);
     }
-    if (target.has_feature(Target::CUDA)) {
-        JITModule m = make_module(for_module, target, CUDA, result, create);
-        if (m.compiled()) {
-            result.push_back(m);
-        }
+    if (target.has_feature(Target::CUDA) &&
+        module_uses_runtime_kind(for_module, CUDA)) {
+        needed.push_back(CUDA);
     }
-    if (target.has_feature(Target::OpenGL)) {
-        JITModule m = make_module(for_module, target, OpenGL, result, create);
-        if (m.compiled()) {
-            result.push_back(m);
-        }
+    if (target.has_feature(Target::OpenGL) &&
+        module_uses_runtime_kind(for_module, OpenGL)) {
+        needed.push_back(OpenGL);
     }
-    if (target.has_feature(Target::OpenGLCompute)) {
-        JITModule m = make_module(for_module, target, OpenGLCompute, result, create);
-        if (m.compiled()) {
-            result.push_back(m);
+    if (target.has_feature(Target::OpenGLCompute) &&
+        module_uses_runtime_kind(for_module, OpenGLCompute)) {
+        needed.push_back(OpenGLCompute);
+    }
+    if (target.features_any_of({Target::HVX_64, Target::HVX_128}) &&
+        module_uses_runtime_kind(for_module, Hexagon)) {
+        needed.push_back(Hexagon);
+    }
+
+    // If more than one device runtime still needs compiling, compile
+    // them concurrently. They each depend only on the main shared
+    // runtime and live in their own LLVMContexts, so the compiles are
+    // independent; we just load any support libraries up front, since
+    // those loaders mutate process-wide state.
+    if (create) {
+        std::vector<RuntimeKind> to_compile;
+        for (RuntimeKind kind : needed) {
+            if (!shared_runtimes(kind).compiled()) {
+                to_compile.push_back(kind);
+            }
+        }
+        if (to_compile.size() > 1) {
+            for (RuntimeKind kind : to_compile) {
+                if (kind == Metal) {
+                    load_metal();
+                } else if (kind == OpenGL || kind == OpenGLCompute) {
+                    load_opengl();
+                }
+            }
+            std::vector<std::thread> compilers;
+            for (RuntimeKind kind : to_compile) {
+                compilers.emplace_back([&, kind]() {
+                    make_module(for_module, target, kind, result, create);
+                });
+            }
+            for (std::thread &t : compilers) {
+                t.join();
+            }
         }
     }
-    if (target.features_any_of({Target::HVX_64, Target::HVX_128})) {
-        JITModule m = make_module(for_module, target, Hexagon, result, create);
+
+    // Collect the modules (compiling any stragglers on this thread).
+    for (RuntimeKind kind : needed) {
+        JITModule m = make_module(for_module, target, kind, result, create);
         if (m.compiled()) {
             result.push_back(m);
         }
@@ -858,5 +1054,41 @@ void JITSharedRuntime::memoization_cache_set_size(int64_t size) {
     }
 }
 
+void JITSharedRuntime::memoization_cache_set_device_size(int64_t size) {
+    std::lock_guard<std::mutex> lock(shared_runtimes_mutex);
+
+    if (size != default_device_cache_size) {
+        default_device_cache_size = size;
+        shared_runtimes(MainShared).memoization_cache_set_device_size(size);
+    }
+}
+
+void JITSharedRuntime::memoization_cache_evict(uint64_t eviction_key) {
+    std::lock_guard<std::mutex> lock(shared_runtimes_mutex);
+
+    shared_runtimes(MainShared).memoization_cache_evict(eviction_key);
+}
+
+void JITSharedRuntime::memoization_cache_get_stats(struct halide_memoization_cache_stats *stats) {
+    std::lock_guard<std::mutex> lock(shared_runtimes_mutex);
+
+    memset(stats, 0, sizeof(*stats));
+    shared_runtimes(MainShared).memoization_cache_get_stats(stats);
+}
+
+void JITSharedRuntime::trace_set_func_filter(const std::string &funcs) {
+    std::lock_guard<std::mutex> lock(shared_runtimes_mutex);
+
+    default_trace_func_filter = funcs;
+    shared_runtimes(MainShared).trace_set_func_filter(funcs.c_str());
+}
+
+void JITSharedRuntime::trace_set_sample_rate(int rate) {
+    std::lock_guard<std::mutex> lock(shared_runtimes_mutex);
+
+    default_trace_sample_rate = rate;
+    shared_runtimes(MainShared).trace_set_sample_rate(rate);
+}
+
 }  // namespace Internal
 }  // namespace Halide
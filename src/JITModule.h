@@ -116,6 +116,26 @@ struct JITModule {
     /** Encapsulate device (GPU) and buffer interactions. */
     void memoization_cache_set_size(int64_t size) const;
 
+    /** Set the device (GPU) memory budget for memoized results kept
+     * resident on the device. */
+    void memoization_cache_set_device_size(int64_t size) const;
+
+    /** Evict all memoization cache entries tagged with the given
+     * eviction key (see Func::memoize(eviction_key)). */
+    void memoization_cache_evict(uint64_t eviction_key) const;
+
+    /** Fetch the memoization cache's statistics from this module's
+     * runtime, if it has one. */
+    void memoization_cache_get_stats(struct halide_memoization_cache_stats *stats) const;
+
+    /** Restrict tracing to the given list of Funcs in this module's
+     * runtime, if it has one. */
+    void trace_set_func_filter(const char *funcs) const;
+
+    /** Set the trace sampling rate in this module's runtime, if it
+     * has one. */
+    void trace_set_sample_rate(int rate) const;
+
     /** Return true if compile_module has been called on this module. */
     bool compiled() const;
 };
@@ -153,6 +173,38 @@ public:
      */
     static void memoization_cache_set_size(int64_t size);
 
+    /** Set the maximum number of bytes of device (GPU) memory kept
+     * resident by memoization caching. If you are compiling
+     * statically, you should include HalideRuntime.h and call
+     * halide_memoization_cache_set_device_size() instead.
+     */
+    static void memoization_cache_set_device_size(int64_t size);
+
+    /** Evict all memoization cache entries stored with the given
+     * eviction key (see Func::memoize(eviction_key)). If you are
+     * compiling statically, include HalideRuntime.h and call
+     * halide_memoization_cache_evict() instead. */
+    static void memoization_cache_evict(uint64_t eviction_key);
+
+    /** Fetch statistics about the memoization cache (hits, misses,
+     * evictions, bytes in use). If you are compiling statically,
+     * include HalideRuntime.h and call
+     * halide_memoization_cache_get_stats() instead. */
+    static void memoization_cache_get_stats(struct halide_memoization_cache_stats *stats);
+
+    /** Restrict tracing to the given comma- or semicolon-separated
+     * list of Func names (see halide_trace_set_func_filter). Pass an
+     * empty string to trace every Func again. If you are compiling
+     * statically, you should include HalideRuntime.h and call
+     * halide_trace_set_func_filter() instead. */
+    static void trace_set_func_filter(const std::string &funcs);
+
+    /** Only trace every Nth realization of each Func (see
+     * halide_trace_set_sample_rate). If you are compiling statically,
+     * you should include HalideRuntime.h and call
+     * halide_trace_set_sample_rate() instead. */
+    static void trace_set_sample_rate(int rate);
+
     static void release_all();
 };
 
@@ -426,7 +426,6 @@ class GroupLoopInvariants : public IRMutator2 {
     }
 };
 
-// Turn for loops of size one into let statements
 Stmt loop_invariant_code_motion(Stmt s) {
     s = GroupLoopInvariants().mutate(s);
     s = common_subexpression_elimination(s);
@@ -30,6 +30,8 @@
 #include <llvm/Bitcode/BitcodeReader.h>
 #include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/Support/MD5.h>
 #include <llvm/IR/LegacyPassManager.h>
 #if LLVM_VERSION < 50
 #include <llvm/Support/Path.h>
@@ -5,6 +5,11 @@
 #include "LLVM_Headers.h"
 #include "LLVM_Runtime_Linker.h"
 
+#include <llvm/IR/DiagnosticInfo.h>
+#if LLVM_VERSION >= 60
+#include <llvm/IR/DiagnosticHandler.h>
+#endif
+
 #include <fstream>
 #include <iostream>
 
@@ -337,14 +342,85 @@ std::unique_ptr<llvm::Module> clone_module(const llvm::Module &module_in) {
     return std::move(cloned_module.get());
 }
 
+#if LLVM_VERSION >= 50
+// The register allocator emits a per-loop spill/reload remark as it
+// runs. Capture those remarks during backend codegen so that
+// schedules that over-unroll can be diagnosed without disassembling
+// the output. Only wired up when HL_DEBUG_CODEGEN is at least 1.
+struct RegAllocRemarks {
+    int64_t total_spills = 0;
+    int64_t total_reloads = 0;
+
+    void handle(const llvm::DiagnosticInfo &info) {
+        const auto *remark = llvm::dyn_cast<llvm::DiagnosticInfoOptimizationBase>(&info);
+        if (!remark || remark->getPassName() != llvm::StringRef("regalloc")) {
+            return;
+        }
+        for (const auto &arg : remark->getArgs()) {
+            if (arg.Key == "NumSpills") {
+                total_spills += std::atoll(arg.Val.c_str());
+            } else if (arg.Key == "NumReloads") {
+                total_reloads += std::atoll(arg.Val.c_str());
+            }
+        }
+        // The remark's message describes the loop the spills belong
+        // to; the function name carries the Halide pipeline name.
+        Internal::debug(1) << "Register allocator: in "
+                           << remark->getFunction().getName().str()
+                           << ": " << remark->getMsg() << "\n";
+    }
+};
+
+#if LLVM_VERSION >= 60
+struct RegAllocRemarkHandler : public llvm::DiagnosticHandler {
+    RegAllocRemarks *remarks;
+
+    RegAllocRemarkHandler(RegAllocRemarks *remarks) : remarks(remarks) {}
+
+    bool handleDiagnostics(const llvm::DiagnosticInfo &info) override {
+        remarks->handle(info);
+        return true;
+    }
+
+    // The backend only constructs remarks for passes the handler
+    // claims an interest in.
+    bool isAnalysisRemarkEnabled(llvm::StringRef pass_name) const override {
+        return pass_name == "regalloc";
+    }
+    bool isMissedOptRemarkEnabled(llvm::StringRef pass_name) const override {
+        return pass_name == "regalloc";
+    }
+    bool isPassedOptRemarkEnabled(llvm::StringRef pass_name) const override {
+        return pass_name == "regalloc";
+    }
+    bool isAnyRemarkEnabled() const override {
+        return true;
+    }
+};
+#else
+void regalloc_remark_trampoline(const llvm::DiagnosticInfo &info, void *context) {
+    ((RegAllocRemarks *)context)->handle(info);
+}
+#endif
+#endif  // LLVM_VERSION >= 50
+
 }  // namespace
 
-void emit_file(const llvm::Module &module_in, Internal::LLVMOStream& out, llvm::TargetMachine::CodeGenFileType file_type) {
+void emit_file(llvm::Module &module_in, Internal::LLVMOStream& out, llvm::TargetMachine::CodeGenFileType file_type, bool preserve_module) {
     Internal::debug(1) << "emit_file.Compiling to native code...\n";
     Internal::debug(2) << "Target triple: " << module_in.getTargetTriple() << "\n";
 
-    // Work on a copy of the module to avoid modifying the original.
-    std::unique_ptr<llvm::Module> module = clone_module(module_in);
+    // The backend passes can modify the module, so work on a copy if
+    // the caller still needs it. The clone round-trips the module
+    // through bitcode, which isn't cheap, so callers emitting several
+    // outputs should do their last native emission with
+    // preserve_module = false.
+    std::unique_ptr<llvm::Module> cloned;
+    llvm::Module *module = &module_in;
+    if (preserve_module) {
+        cloned = clone_module(module_in);
+        module = cloned.get();
+    }
 
     // Get the target specific parser.
     auto target_machine = Internal::make_target_machine(*module);
@@ -380,19 +456,51 @@ void emit_file(const llvm::Module &module_in, Internal::LLVMOStream& out, llvm::
     // Ask the target to add backend passes as necessary.
     target_machine->addPassesToEmitFile(pass_manager, out, file_type);
 
+#if LLVM_VERSION >= 50
+    RegAllocRemarks remarks;
+    bool capture_remarks = Internal::debug::debug_level() >= 1;
+    if (capture_remarks) {
+#if LLVM_VERSION >= 60
+        module->getContext().setDiagnosticHandler(
+            std::unique_ptr<llvm::DiagnosticHandler>(new RegAllocRemarkHandler(&remarks)));
+#else
+        module->getContext().setDiagnosticHandler(
+            regalloc_remark_trampoline, &remarks, /* RespectFilters */ false);
+#endif
+    }
+#endif
+
     pass_manager.run(*module);
+
+#if LLVM_VERSION >= 50
+    if (capture_remarks) {
+        if (remarks.total_spills > 0 || remarks.total_reloads > 0) {
+            Internal::debug(1) << "Register allocator: " << remarks.total_spills
+                               << " spill(s) and " << remarks.total_reloads
+                               << " reload(s) in " << module->getName().str()
+                               << ". Over-unrolled or over-vectorized schedules are "
+                               << "the usual cause.\n";
+        }
+#if LLVM_VERSION >= 60
+        module->getContext().setDiagnosticHandler(
+            std::unique_ptr<llvm::DiagnosticHandler>());
+#else
+        module->getContext().setDiagnosticHandler(nullptr, nullptr);
+#endif
+    }
+#endif
 }
 
 std::unique_ptr<llvm::Module> compile_module_to_llvm_module(const Module &module, llvm::LLVMContext &context) {
     return codegen_llvm(module, context);
 }
 
-void compile_llvm_module_to_object(llvm::Module &module, Internal::LLVMOStream& out) {
-    emit_file(module, out, llvm::TargetMachine::CGFT_ObjectFile);
+void compile_llvm_module_to_object(llvm::Module &module, Internal::LLVMOStream& out, bool preserve_module) {
+    emit_file(module, out, llvm::TargetMachine::CGFT_ObjectFile, preserve_module);
 }
 
-void compile_llvm_module_to_assembly(llvm::Module &module, Internal::LLVMOStream& out) {
-    emit_file(module, out, llvm::TargetMachine::CGFT_AssemblyFile);
+void compile_llvm_module_to_assembly(llvm::Module &module, Internal::LLVMOStream& out, bool preserve_module) {
+    emit_file(module, out, llvm::TargetMachine::CGFT_AssemblyFile, preserve_module);
 }
 
 void compile_llvm_module_to_llvm_bitcode(llvm::Module &module, Internal::LLVMOStream& out) {
@@ -33,10 +33,14 @@ std::unique_ptr<llvm::Module> compile_module_to_llvm_module(const Module &module
 /** Construct an llvm output stream for writing to files. */
 std::unique_ptr<llvm::raw_fd_ostream> make_raw_fd_ostream(const std::string &filename);
 
-/** Compile an LLVM module to native targets (objects, native assembly). */
+/** Compile an LLVM module to native targets (objects, native
+ * assembly). The backend passes can modify the module, so by default
+ * they run on a clone of it. Callers that don't need the module
+ * afterwards should pass preserve_module = false to skip the clone,
+ * which round-trips the module through bitcode. */
 // @{
-void compile_llvm_module_to_object(llvm::Module &module, Internal::LLVMOStream& out);
-void compile_llvm_module_to_assembly(llvm::Module &module, Internal::LLVMOStream& out);
+void compile_llvm_module_to_object(llvm::Module &module, Internal::LLVMOStream& out, bool preserve_module = true);
+void compile_llvm_module_to_assembly(llvm::Module &module, Internal::LLVMOStream& out, bool preserve_module = true);
 // @}
 
 /** Compile an LLVM module to LLVM targets (bitcode, LLVM assembly). */
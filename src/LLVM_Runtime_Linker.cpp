@@ -75,18 +75,27 @@ DECLARE_CPP_INITMOD(android_tempfile)
 DECLARE_CPP_INITMOD(buffer_t)
 DECLARE_CPP_INITMOD(cache)
 DECLARE_CPP_INITMOD(can_use_target)
+DECLARE_CPP_INITMOD(context_overrides)
 DECLARE_CPP_INITMOD(cuda)
+DECLARE_CPP_INITMOD(cuda_managed)
+DECLARE_CPP_INITMOD(cuda_managed_stubs)
 DECLARE_CPP_INITMOD(destructors)
 DECLARE_CPP_INITMOD(device_interface)
+DECLARE_CPP_INITMOD(distributed)
 DECLARE_CPP_INITMOD(errors)
+DECLARE_CPP_INITMOD(fake_cpu_topology)
+DECLARE_CPP_INITMOD(fake_thread_affinity)
 DECLARE_CPP_INITMOD(fake_thread_pool)
 DECLARE_CPP_INITMOD(float16_t)
 DECLARE_CPP_INITMOD(gpu_device_selection)
 DECLARE_CPP_INITMOD(hexagon_host)
 DECLARE_CPP_INITMOD(ios_io)
 DECLARE_CPP_INITMOD(linux_clock)
+DECLARE_CPP_INITMOD(linux_cpu_topology)
 DECLARE_CPP_INITMOD(linux_host_cpu_count)
 DECLARE_CPP_INITMOD(linux_opengl_context)
+DECLARE_CPP_INITMOD(linux_perf_counters)
+DECLARE_CPP_INITMOD(linux_thread_affinity)
 DECLARE_CPP_INITMOD(linux_yield)
 DECLARE_CPP_INITMOD(matlab)
 DECLARE_CPP_INITMOD(metadata)
@@ -118,6 +127,7 @@ DECLARE_CPP_INITMOD(profiler)
 DECLARE_CPP_INITMOD(profiler_inlined)
 DECLARE_CPP_INITMOD(qurt_allocator)
 DECLARE_CPP_INITMOD(qurt_hvx)
+DECLARE_CPP_INITMOD(qurt_hvx_vtcm)
 DECLARE_CPP_INITMOD(qurt_init_fini)
 DECLARE_CPP_INITMOD(qurt_threads)
 DECLARE_CPP_INITMOD(qurt_threads_tsan)
@@ -187,12 +197,14 @@ DECLARE_LL_INITMOD(ptx_compute_35)
 #endif  // WITH_PTX
 
 #ifdef WITH_X86
+DECLARE_LL_INITMOD(x86_avx512)
 DECLARE_LL_INITMOD(x86_avx2)
 DECLARE_LL_INITMOD(x86_avx)
 DECLARE_LL_INITMOD(x86)
 DECLARE_LL_INITMOD(x86_sse41)
 DECLARE_CPP_INITMOD(x86_cpu_features)
 #else
+DECLARE_NO_INITMOD(x86_avx512)
 DECLARE_NO_INITMOD(x86_avx2)
 DECLARE_NO_INITMOD(x86_avx)
 DECLARE_NO_INITMOD(x86)
@@ -216,6 +228,14 @@ DECLARE_NO_INITMOD(powerpc)
 DECLARE_NO_INITMOD(powerpc_cpu_features)
 #endif  // WITH_POWERPC
 
+#ifdef WITH_RISCV
+DECLARE_LL_INITMOD(riscv)
+DECLARE_CPP_INITMOD(riscv_cpu_features)
+#else
+DECLARE_NO_INITMOD(riscv)
+DECLARE_NO_INITMOD(riscv_cpu_features)
+#endif  // WITH_RISCV
+
 #ifdef WITH_HEXAGON
 DECLARE_LL_INITMOD(hvx_64)
 DECLARE_LL_INITMOD(hvx_128)
@@ -282,6 +302,12 @@ llvm::DataLayout get_data_layout_for_target(Target target) {
         } else {
             return llvm::DataLayout("e-m:e-i64:64-n32:64");
         }
+    } else if (target.arch == Target::RISCV) {
+        if (target.bits == 32) {
+            return llvm::DataLayout("e-m:e-p:32:32-i64:64-n32-S128");
+        } else {
+            return llvm::DataLayout("e-m:e-p:64:64-i64:64-i128:128-n64-S128");
+        }
     } else if (target.arch == Target::Hexagon) {
         return llvm::DataLayout(
             "e-m:e-p:32:32:32-a:0-n16:32-i64:64:64-i32:32:32-i16:16:16-i1:8:8"
@@ -376,6 +402,20 @@ llvm::Triple get_triple_for_target(const Target &target) {
         } else {
             user_error << "No mips support for this OS\n";
         }
+    } else if (target.arch == Target::RISCV) {
+        if (target.bits == 32) {
+            triple.setArch(llvm::Triple::riscv32);
+        } else {
+            user_assert(target.bits == 64) << "Target must be 32- or 64-bit.\n";
+            triple.setArch(llvm::Triple::riscv64);
+        }
+
+        if (target.os == Target::Linux) {
+            triple.setOS(llvm::Triple::Linux);
+            triple.setEnvironment(llvm::Triple::GNU);
+        } else {
+            user_error << "No riscv support for this OS\n";
+        }
     } else if (target.arch == Target::POWERPC) {
         #if (WITH_POWERPC)
         // Only ppc*-unknown-linux-gnu are supported for the time being.
@@ -480,9 +520,17 @@ void link_modules(std::vector<std::unique_ptr<llvm::Module>> &modules, Target t)
 
         llvm::GlobalValue::LinkageTypes linkage = f.getLinkage();
         if (can_strip) {
-            if (linkage == llvm::GlobalValue::WeakAnyLinkage) {
-                f.setLinkage(llvm::GlobalValue::LinkOnceAnyLinkage);
-            } else if (linkage == llvm::GlobalValue::WeakODRLinkage) {
+            // These are one-definition-rule symbols: every copy of
+            // the runtime provides the same definition, so linkonce
+            // (rather than linkonce_odr) would be needlessly
+            // conservative. The distinction matters because the
+            // optimizer refuses to inline non-odr linkonce
+            // definitions, which keeps hot runtime helpers (like the
+            // copy loops behind halide_copy_to_host) from being
+            // inlined and specialized against their call sites in the
+            // rest of the runtime.
+            if (linkage == llvm::GlobalValue::WeakAnyLinkage ||
+                linkage == llvm::GlobalValue::WeakODRLinkage) {
                 f.setLinkage(llvm::GlobalValue::LinkOnceODRLinkage);
             }
         }
@@ -641,6 +689,9 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
                 modules.push_back(get_initmod_posix_tempfile(c, bits_64, debug));
                 modules.push_back(get_initmod_linux_host_cpu_count(c, bits_64, debug));
                 modules.push_back(get_initmod_linux_yield(c, bits_64, debug));
+                modules.push_back(get_initmod_linux_thread_affinity(c, bits_64, debug));
+                modules.push_back(get_initmod_linux_cpu_topology(c, bits_64, debug));
+                modules.push_back(get_initmod_linux_perf_counters(c, bits_64, debug));
                 if (tsan) {
                     modules.push_back(get_initmod_posix_threads_tsan(c, bits_64, debug));
                 } else {
@@ -656,6 +707,8 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
                 modules.push_back(get_initmod_posix_tempfile(c, bits_64, debug));
                 modules.push_back(get_initmod_osx_host_cpu_count(c, bits_64, debug));
                 modules.push_back(get_initmod_osx_yield(c, bits_64, debug));
+                modules.push_back(get_initmod_fake_thread_affinity(c, bits_64, debug));
+                modules.push_back(get_initmod_fake_cpu_topology(c, bits_64, debug));
                 if (tsan) {
                     modules.push_back(get_initmod_posix_threads_tsan(c, bits_64, debug));
                 } else {
@@ -675,6 +728,8 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
                 modules.push_back(get_initmod_android_tempfile(c, bits_64, debug));
                 modules.push_back(get_initmod_android_host_cpu_count(c, bits_64, debug));
                 modules.push_back(get_initmod_linux_yield(c, bits_64, debug)); // TODO: verify
+                modules.push_back(get_initmod_linux_thread_affinity(c, bits_64, debug));
+                modules.push_back(get_initmod_linux_cpu_topology(c, bits_64, debug));
                 if (tsan) {
                     modules.push_back(get_initmod_posix_threads_tsan(c, bits_64, debug));
                 } else {
@@ -689,6 +744,8 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
                 modules.push_back(get_initmod_windows_io(c, bits_64, debug));
                 modules.push_back(get_initmod_windows_tempfile(c, bits_64, debug));
                 modules.push_back(get_initmod_windows_yield(c, bits_64, debug));
+                modules.push_back(get_initmod_fake_thread_affinity(c, bits_64, debug));
+                modules.push_back(get_initmod_fake_cpu_topology(c, bits_64, debug));
                 if (tsan) {
                     modules.push_back(get_initmod_windows_threads_tsan(c, bits_64, debug));
                 } else {
@@ -707,6 +764,8 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
                 modules.push_back(get_initmod_posix_tempfile(c, bits_64, debug));
                 modules.push_back(get_initmod_osx_host_cpu_count(c, bits_64, debug));
                 modules.push_back(get_initmod_osx_yield(c, bits_64, debug));
+                modules.push_back(get_initmod_fake_thread_affinity(c, bits_64, debug));
+                modules.push_back(get_initmod_fake_cpu_topology(c, bits_64, debug));
                 if (tsan) {
                     modules.push_back(get_initmod_posix_threads_tsan(c, bits_64, debug));
                 } else {
@@ -715,6 +774,8 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             } else if (t.os == Target::QuRT) {
                 modules.push_back(get_initmod_qurt_allocator(c, bits_64, debug));
                 modules.push_back(get_initmod_qurt_yield(c, bits_64, debug));
+                modules.push_back(get_initmod_fake_thread_affinity(c, bits_64, debug));
+                modules.push_back(get_initmod_fake_cpu_topology(c, bits_64, debug));
                 if (tsan) {
                     modules.push_back(get_initmod_qurt_threads_tsan(c, bits_64, debug));
                 } else {
@@ -767,6 +828,7 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
                 modules.push_back(get_initmod_cache(c, bits_64, debug));
             }
             modules.push_back(get_initmod_to_string(c, bits_64, debug));
+            modules.push_back(get_initmod_context_overrides(c, bits_64, debug));
 
             if (t.arch == Target::Hexagon ||
                 t.has_feature(Target::HVX_64) ||
@@ -777,6 +839,7 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             }
 
             modules.push_back(get_initmod_device_interface(c, bits_64, debug));
+            modules.push_back(get_initmod_distributed(c, bits_64, debug));
             modules.push_back(get_initmod_metadata(c, bits_64, debug));
             modules.push_back(get_initmod_float16_t(c, bits_64, debug));
             modules.push_back(get_initmod_errors(c, bits_64, debug));
@@ -827,8 +890,12 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             if (t.arch == Target::POWERPC) {
                 modules.push_back(get_initmod_powerpc_ll(c));
             }
+            if (t.arch == Target::RISCV) {
+                modules.push_back(get_initmod_riscv_ll(c));
+            }
             if (t.arch == Target::Hexagon) {
                 modules.push_back(get_initmod_qurt_hvx(c, bits_64, debug));
+                modules.push_back(get_initmod_qurt_hvx_vtcm(c, bits_64, debug));
                 if (t.has_feature(Target::HVX_64)) {
                     modules.push_back(get_initmod_hvx_64_ll(c));
                 } else if (t.has_feature(Target::HVX_128)) {
@@ -846,6 +913,10 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             if (t.has_feature(Target::AVX2)) {
                 modules.push_back(get_initmod_x86_avx2_ll(c));
             }
+            if (t.has_feature(Target::AVX512_Skylake) ||
+                t.has_feature(Target::AVX512_Cannonlake)) {
+                modules.push_back(get_initmod_x86_avx512_ll(c));
+            }
             if (t.has_feature(Target::Profile)) {
                 modules.push_back(get_initmod_profiler_inlined(c, bits_64, debug));
             }
@@ -870,6 +941,9 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             if (t.arch == Target::POWERPC) {
                 modules.push_back(get_initmod_powerpc_cpu_features(c, bits_64, debug));
             }
+            if (t.arch == Target::RISCV) {
+                modules.push_back(get_initmod_riscv_cpu_features(c, bits_64, debug));
+            }
             if (t.arch == Target::Hexagon) {
                 modules.push_back(get_initmod_hexagon_cpu_features(c, bits_64, debug));
             }
@@ -890,6 +964,11 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             } else {
                 modules.push_back(get_initmod_cuda(c, bits_64, debug));
             }
+            if (t.has_feature(Target::ManagedMemory)) {
+                modules.push_back(get_initmod_cuda_managed(c, bits_64, debug));
+            } else {
+                modules.push_back(get_initmod_cuda_managed_stubs(c, bits_64, debug));
+            }
         }
         if (t.has_feature(Target::OpenCL)) {
             if (t.os == Target::Windows) {
@@ -22,9 +22,11 @@ namespace {
 
 /** If an integer expression varies linearly with the variables in the
  * scope, return the linear term. Otherwise return an undefined
- * Expr. */
+ * Expr. Vector expressions are linear if they vary linearly in each
+ * lane by the same amount, so the linear term returned for a vector
+ * expression may be a broadcastable scalar. */
 Expr is_linear(Expr e, const Scope<Expr> &linear) {
-    if (e.type() != Int(32)) {
+    if (e.type().element_of() != Int(32)) {
         return Expr();
     }
     if (const Variable *v = e.as<Variable>()) {
@@ -549,5 +551,71 @@ Stmt loop_carry(Stmt s, int max_carried_values) {
     return s;
 }
 
+namespace {
+
+/** Count the loads from a given buffer inside the body of the first
+ * serial For loop encountered. */
+class CountLoadsInLoop : public IRVisitor {
+    using IRVisitor::visit;
+
+    bool in_loop = false;
+
+    void visit(const For *op) override {
+        bool old_in_loop = in_loop;
+        in_loop = true;
+        IRVisitor::visit(op);
+        in_loop = old_in_loop;
+    }
+
+    void visit(const Load *op) override {
+        if (in_loop && op->name == buffer) {
+            count++;
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    const string buffer;
+    int count = 0;
+    CountLoadsInLoop(const string &b) : buffer(b) {}
+};
+
+}  // namespace
+
+void loop_carry_test() {
+    Expr y = Variable::make(Int(32), "y");
+    const int lanes = 8;
+
+    // A width-3 vertical stencil, vectorized across x, with the
+    // vector index hoisted into a let the way lowered code has it.
+    // Rows y+1 and y+2 loaded on one iteration are rows y and y+1 of
+    // the next, so two of the three loads should be carried.
+    Expr idx = Variable::make(Int(32, lanes), "idx");
+    auto load_row = [&](int row) {
+        Expr index = idx;
+        if (row != 0) {
+            index = index + Broadcast::make(row * lanes, lanes);
+        }
+        return Load::make(Int(32, lanes), "in", index,
+                          Buffer<>(), Parameter(), const_true(lanes));
+    };
+
+    Expr stencil = load_row(0) + load_row(1) + load_row(2);
+    Stmt store = Store::make("out", stencil, idx, Parameter(), const_true(lanes));
+    Stmt body = LetStmt::make("idx", Ramp::make(y * lanes, 1, lanes), store);
+    Stmt loop = For::make("y", 0, 100, ForType::Serial, DeviceAPI::None, body);
+    Stmt s = ProducerConsumer::make("in", false, loop);
+
+    Stmt carried = loop_carry(s);
+
+    CountLoadsInLoop counter("in");
+    carried.accept(&counter);
+    internal_assert(counter.count == 1)
+        << "loop_carry should have reduced the per-iteration loads from 'in' "
+        << "to one, but there are " << counter.count << ":\n" << carried;
+
+    std::cout << "loop_carry test passed" << std::endl;
+}
+
 }  // namespace Internal
 }  // namespace Halide
@@ -14,6 +14,8 @@ namespace Internal {
  * for Hexagon. */
 Stmt loop_carry(Stmt, int max_carried_values = 8);
 
+void loop_carry_test();
+
 }  // namespace Internal
 }  // namespace Halide
 
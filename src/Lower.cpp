@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <set>
 #include <sstream>
@@ -8,6 +10,8 @@
 #include "AddImageChecks.h"
 #include "AddParameterChecks.h"
 #include "AllocationBoundsInference.h"
+#include "AsyncProducers.h"
+#include "AtomicUpdates.h"
 #include "BoundSmallAllocations.h"
 #include "Bounds.h"
 #include "BoundsInference.h"
@@ -17,6 +21,7 @@
 #include "DebugArguments.h"
 #include "DebugToFile.h"
 #include "Deinterleave.h"
+#include "DoubleBuffering.h"
 #include "EarlyFree.h"
 #include "FindCalls.h"
 #include "Func.h"
@@ -24,9 +29,12 @@
 #include "FuseGPUThreadLoops.h"
 #include "FuzzFloatStores.h"
 #include "HexagonOffload.h"
+#include "HoistStorage.h"
+#include "IREquality.h"
 #include "IRMutator.h"
 #include "IROperator.h"
 #include "IRPrinter.h"
+#include "IRVisitor.h"
 #include "InferArguments.h"
 #include "InjectHostDevBufferCopies.h"
 #include "InjectOpenGLIntrinsics.h"
@@ -35,7 +43,9 @@
 #include "LoopCarry.h"
 #include "LowerWarpShuffles.h"
 #include "Memoization.h"
+#include "NarrowIndices.h"
 #include "PartitionLoops.h"
+#include "PerformanceLint.h"
 #include "Prefetch.h"
 #include "Profiling.h"
 #include "Qualify.h"
@@ -49,9 +59,12 @@
 #include "SimplifySpecializations.h"
 #include "SkipStages.h"
 #include "SlidingWindow.h"
+#include "Solve.h"
 #include "SplitTuples.h"
 #include "StorageFlattening.h"
 #include "StorageFolding.h"
+#include "StorageReuse.h"
+#include "StrengthReduceDivision.h"
 #include "StrictifyFloat.h"
 #include "Substitute.h"
 #include "Tracing.h"
@@ -70,18 +83,188 @@ namespace Internal {
 
 using std::map;
 using std::ostringstream;
+using std::pair;
 using std::set;
 using std::string;
 using std::vector;
 
+namespace {
+
+// Count the distinct IR nodes in a statement. Shared subexpressions
+// are counted once, so this tracks the size of the DAG the later
+// passes and codegen will actually walk.
+class CountIRNodes : public IRGraphVisitor {
+    using IRGraphVisitor::include;
+
+    std::set<const IRNode *> counted;
+
+protected:
+    void include(const Expr &e) override {
+        counted.insert(e.get());
+        IRGraphVisitor::include(e);
+    }
+
+    void include(const Stmt &s) override {
+        counted.insert(s.get());
+        IRGraphVisitor::include(s);
+    }
+
+public:
+    int64_t count(const Stmt &s) {
+        s.accept(this);
+        // The root node is dispatched directly, not via include.
+        return (int64_t)counted.size() + 1;
+    }
+};
+
+thread_local std::vector<LowerPassStats> lower_stats;
+
+// Times the passes in lower(). Each record() call closes out the pass
+// that ran since the previous one.
+class LowerPassTimer {
+    std::chrono::steady_clock::time_point last;
+
+public:
+    LowerPassTimer() {
+        lower_stats.clear();
+        last = std::chrono::steady_clock::now();
+    }
+
+    void record(const string &name, const Stmt &s) {
+        auto now = std::chrono::steady_clock::now();
+        LowerPassStats stats;
+        stats.name = name;
+        stats.wall_time = std::chrono::duration<double>(now - last).count();
+        stats.ir_nodes = CountIRNodes().count(s);
+        lower_stats.push_back(stats);
+        // Don't charge the node counting itself to the next pass.
+        last = std::chrono::steady_clock::now();
+    }
+
+    void dump() const {
+        if (debug::debug_level() < 1) {
+            return;
+        }
+        double total = 0;
+        for (const LowerPassStats &stats : lower_stats) {
+            total += stats.wall_time;
+        }
+        debug(1) << "Lowering pass breakdown:\n";
+        for (const LowerPassStats &stats : lower_stats) {
+            ostringstream line;
+            line << "  " << std::setw(9) << std::fixed << std::setprecision(3)
+                 << (stats.wall_time * 1000) << " ms  "
+                 << std::setw(10) << stats.ir_nodes << " nodes  "
+                 << stats.name << "\n";
+            debug(1) << line.str();
+        }
+        ostringstream line;
+        line << "  " << std::setw(9) << std::fixed << std::setprecision(3)
+             << (total * 1000) << " ms total\n";
+        debug(1) << line.str();
+    }
+};
+
+// Prints the produce nodes of a chosen set of Funcs, skipping
+// everything else in the Stmt.
+class PrintFuncs : public IRVisitor {
+    using IRVisitor::visit;
+
+    const set<string> &funcs;
+
+    void visit(const ProducerConsumer *op) override {
+        if (op->is_producer && funcs.count(op->name)) {
+            debug(2) << Stmt(op) << "\n";
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+public:
+    PrintFuncs(const set<string> &funcs) : funcs(funcs) {}
+};
+
+// Prints the Stmt after each lowering pass at HL_DEBUG_CODEGEN >= 2.
+// On large pipelines the full dump can run to many gigabytes, so
+// several environment variables trim it:
+//   HL_DEBUG_CODEGEN_PASSES: comma-separated substrings; only passes
+//     whose description contains one of them are dumped.
+//   HL_DEBUG_CODEGEN_FUNCS: comma-separated Func names; only the
+//     produce nodes of those Funcs are dumped.
+//   HL_DEBUG_CODEGEN_DIFF: if set, a pass that didn't change the Stmt
+//     prints a one-line note instead of the whole thing.
+// HL_DEBUG_CODEGEN_FILE redirects the output, optionally gzip
+// compressed (see Debug.h).
+class StmtDumper {
+    vector<string> pass_filters;
+    set<string> func_filter;
+    bool diff_only;
+    Stmt last;
+
+public:
+    StmtDumper() {
+        for (const string &f : split_string(get_env_variable("HL_DEBUG_CODEGEN_PASSES"), ",")) {
+            if (!f.empty()) {
+                pass_filters.push_back(f);
+            }
+        }
+        for (const string &f : split_string(get_env_variable("HL_DEBUG_CODEGEN_FUNCS"), ",")) {
+            if (!f.empty()) {
+                func_filter.insert(f);
+            }
+        }
+        diff_only = !get_env_variable("HL_DEBUG_CODEGEN_DIFF").empty();
+    }
+
+    void dump(const string &description, const Stmt &s) {
+        if (debug::debug_level() < 2) {
+            return;
+        }
+        if (!pass_filters.empty()) {
+            bool match = false;
+            for (const string &f : pass_filters) {
+                match |= description.find(f) != string::npos;
+            }
+            if (!match) {
+                return;
+            }
+        }
+        if (diff_only) {
+            if (last.defined() && equal(last, s)) {
+                debug(2) << description << ": (unchanged)\n";
+                return;
+            }
+            last = s;
+        }
+        debug(2) << description << ":\n";
+        if (!func_filter.empty()) {
+            PrintFuncs printer(func_filter);
+            s.accept(&printer);
+        } else {
+            debug(2) << s << '\n';
+        }
+    }
+};
+
+}  // namespace
+
+const std::vector<LowerPassStats> &get_lower_pass_stats() {
+    return lower_stats;
+}
+
 Module lower(const vector<Function> &output_funcs, const string &pipeline_name, const Target &t,
              const vector<Argument> &args, const LinkageType linkage_type,
-             const vector<IRMutator2 *> &custom_passes) {
+             const vector<IRMutator2 *> &custom_passes,
+             const vector<Stmt> &requirements) {
     std::vector<std::string> namespaces;
     std::string simple_pipeline_name = extract_namespaces(pipeline_name, namespaces);
 
     Module result_module(simple_pipeline_name, t);
 
+    // Results cached by earlier lowerings can't be hit from this one
+    // (variable names are unique per pipeline), so drop them.
+    clear_solver_cache();
+
     // Compute an environment
     map<string, Function> env;
     for (Function f : output_funcs) {
@@ -118,30 +301,62 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     // specializations' conditions
     simplify_specializations(env);
 
+    LowerPassTimer pass_timer;
+    StmtDumper dumper;
+
     debug(1) << "Creating initial loop nests...\n";
     bool any_memoized = false;
     Stmt s = schedule_functions(outputs, fused_groups, env, t, any_memoized);
-    debug(2) << "Lowering after creating initial loop nests:\n" << s << '\n';
+    dumper.dump("Lowering after creating initial loop nests", s);
+    pass_timer.record("creating initial loop nests", s);
+
+    debug(1) << "Injecting compute predicates...\n";
+    s = inject_compute_predicates(s, env);
+    dumper.dump("Lowering after injecting compute predicates", s);
+    pass_timer.record("injecting compute predicates", s);
 
     debug(1) << "Canonicalizing GPU var names...\n";
     s = canonicalize_gpu_vars(s);
-    debug(2) << "Lowering after canonicalizing GPU var names:\n" << s << '\n';
+    dumper.dump("Lowering after canonicalizing GPU var names", s);
+    pass_timer.record("canonicalizing GPU var names", s);
 
     if (any_memoized) {
         debug(1) << "Injecting memoization...\n";
         s = inject_memoization(s, env, pipeline_name, outputs);
-        debug(2) << "Lowering after injecting memoization:\n" << s << '\n';
+        dumper.dump("Lowering after injecting memoization", s);
+        pass_timer.record("injecting memoization", s);
     } else {
         debug(1) << "Skipping injecting memoization...\n";
     }
 
     debug(1) << "Injecting tracing...\n";
     s = inject_tracing(s, pipeline_name, env, outputs, t);
-    debug(2) << "Lowering after injecting tracing:\n" << s << '\n';
+    dumper.dump("Lowering after injecting tracing", s);
+    pass_timer.record("injecting tracing", s);
 
     debug(1) << "Adding checks for parameters\n";
-    s = add_parameter_checks(s, t);
-    debug(2) << "Lowering after injecting parameter checks:\n" << s << '\n';
+    vector<pair<string, Expr>> constrained_param_lets;
+    s = add_parameter_checks(s, t, &constrained_param_lets);
+    dumper.dump("Lowering after injecting parameter checks", s);
+    pass_timer.record("injecting parameter checks", s);
+
+    if (!requirements.empty()) {
+        debug(1) << "Injecting requirements\n";
+        // Wrap the pipeline in an if per requirement, rather than
+        // prepending a block of asserts, so that the simplifier can
+        // assume each condition holds throughout the pipeline body
+        // (it mines IfThenElse conditions for facts). Walking the
+        // list backwards makes the first-added requirement
+        // outermost, so requirements are checked in the order they
+        // were added.
+        for (size_t i = requirements.size(); i > 0; i--) {
+            const AssertStmt *a = requirements[i-1].as<AssertStmt>();
+            internal_assert(a) << "Requirements must be AssertStmts\n";
+            s = IfThenElse::make(a->condition, s, requirements[i-1]);
+        }
+        dumper.dump("Lowering after injecting requirements", s);
+        pass_timer.record("injecting requirements", s);
+    }
 
     // Compute the maximum and minimum possible value of each
     // function. Used in later bounds inference passes.
@@ -151,71 +366,117 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     // The checks will be in terms of the symbols defined by bounds
     // inference.
     debug(1) << "Adding checks for images\n";
-    s = add_image_checks(s, outputs, t, order, env, func_bounds);
-    debug(2) << "Lowering after injecting image checks:\n" << s << '\n';
+    Stmt bounds_query_body;
+    s = add_image_checks(s, outputs, t, order, env, func_bounds, &bounds_query_body);
+    dumper.dump("Lowering after injecting image checks", s);
+    pass_timer.record("injecting image checks", s);
 
     // This pass injects nested definitions of variable names, so we
     // can't simplify statements from here until we fix them up. (We
     // can still simplify Exprs).
     debug(1) << "Performing computation bounds inference...\n";
     s = bounds_inference(s, outputs, order, fused_groups, env, func_bounds, t);
-    debug(2) << "Lowering after computation bounds inference:\n" << s << '\n';
+    dumper.dump("Lowering after computation bounds inference", s);
+    pass_timer.record("computation bounds inference", s);
 
     debug(1) << "Performing sliding window optimization...\n";
     s = sliding_window(s, env);
-    debug(2) << "Lowering after sliding window:\n" << s << '\n';
+    dumper.dump("Lowering after sliding window", s);
+    pass_timer.record("sliding window", s);
 
     debug(1) << "Performing allocation bounds inference...\n";
     s = allocation_bounds_inference(s, env, func_bounds);
-    debug(2) << "Lowering after allocation bounds inference:\n" << s << '\n';
+    dumper.dump("Lowering after allocation bounds inference", s);
+    pass_timer.record("allocation bounds inference", s);
 
     debug(1) << "Removing code that depends on undef values...\n";
     s = remove_undef(s);
-    debug(2) << "Lowering after removing code that depends on undef values:\n" << s << "\n\n";
+    dumper.dump("Lowering after removing code that depends on undef values", s);
+    pass_timer.record("removing code that depends on undef values", s);
 
     // This uniquifies the variable names, so we're good to simplify
     // after this point. This lets later passes assume syntactic
     // equivalence means semantic equivalence.
     debug(1) << "Uniquifying variable names...\n";
     s = uniquify_variable_names(s);
-    debug(2) << "Lowering after uniquifying variable names:\n" << s << "\n\n";
+    dumper.dump("Lowering after uniquifying variable names", s);
+    pass_timer.record("uniquifying variable names", s);
 
     debug(1) << "Simplifying...\n";
     s = simplify(s, false); // Keep dead lets. Storage flattening needs them.
-    debug(2) << "Lowering after first simplification:\n" << s << "\n\n";
+    dumper.dump("Lowering after first simplification", s);
+    pass_timer.record("first simplification", s);
 
     debug(1) << "Performing storage folding optimization...\n";
     s = storage_folding(s, env);
-    debug(2) << "Lowering after storage folding:\n" << s << '\n';
+    dumper.dump("Lowering after storage folding", s);
+    pass_timer.record("storage folding", s);
+
+    debug(1) << "Injecting double buffering...\n";
+    s = inject_double_buffering(s, env);
+    dumper.dump("Lowering after injecting double buffering", s);
+    pass_timer.record("injecting double buffering", s);
+
+    debug(1) << "Forking asynchronous producers...\n";
+    s = fork_async_producers(s, env);
+    dumper.dump("Lowering after forking asynchronous producers", s);
+    pass_timer.record("forking asynchronous producers", s);
+
+    if (t.has_feature(Target::ParallelRoots)) {
+        debug(1) << "Forking independent root stages...\n";
+        s = fork_independent_root_stages(s);
+        dumper.dump("Lowering after forking independent root stages", s);
+        pass_timer.record("forking independent root stages", s);
+    }
 
     debug(1) << "Injecting debug_to_file calls...\n";
     s = debug_to_file(s, outputs, env);
-    debug(2) << "Lowering after injecting debug_to_file calls:\n" << s << '\n';
+    dumper.dump("Lowering after injecting debug_to_file calls", s);
+    pass_timer.record("injecting debug_to_file calls", s);
 
     debug(1) << "Injecting prefetches...\n";
-    s = inject_prefetch(s, env);
-    debug(2) << "Lowering after injecting prefetches:\n" << s << "\n\n";
+    s = inject_prefetch(s, env, t);
+    dumper.dump("Lowering after injecting prefetches", s);
+    pass_timer.record("injecting prefetches", s);
 
     debug(1) << "Dynamically skipping stages...\n";
     s = skip_stages(s, order);
-    debug(2) << "Lowering after dynamically skipping stages:\n" << s << "\n\n";
+    dumper.dump("Lowering after dynamically skipping stages", s);
+    pass_timer.record("dynamically skipping stages", s);
 
     debug(1) << "Destructuring tuple-valued realizations...\n";
     s = split_tuples(s, env);
-    debug(2) << "Lowering after destructuring tuple-valued realizations:\n" << s << "\n\n";
+    dumper.dump("Lowering after destructuring tuple-valued realizations", s);
+    pass_timer.record("destructuring tuple-valued realizations", s);
 
     debug(1) << "Performing storage flattening...\n";
     s = storage_flattening(s, outputs, env, t);
-    debug(2) << "Lowering after storage flattening:\n" << s << "\n\n";
+    dumper.dump("Lowering after storage flattening", s);
+    pass_timer.record("storage flattening", s);
+
+    debug(1) << "Hoisting storage...\n";
+    s = hoist_storage(s, env);
+    dumper.dump("Lowering after hoisting storage", s);
+    pass_timer.record("hoisting storage", s);
+
+    debug(1) << "Performing storage reuse...\n";
+    s = storage_reuse(s, env);
+    dumper.dump("Lowering after storage reuse", s);
+    pass_timer.record("storage reuse", s);
+
+    debug(1) << "Lowering atomic updates...\n";
+    s = lower_atomic_updates(s, env);
+    dumper.dump("Lowering after lowering atomic updates", s);
+    pass_timer.record("lowering atomic updates", s);
 
     debug(1) << "Unpacking buffer arguments...\n";
     s = unpack_buffers(s);
-    debug(2) << "Lowering after unpacking buffer arguments...\n" << s << "\n\n";
+    dumper.dump("Lowering after unpacking buffer arguments", s);
 
     if (any_memoized) {
         debug(1) << "Rewriting memoized allocations...\n";
         s = rewrite_memoized_allocations(s, env);
-        debug(2) << "Lowering after rewriting memoized allocations:\n" << s << "\n\n";
+        dumper.dump("Lowering after rewriting memoized allocations", s);
     } else {
         debug(1) << "Skipping rewriting memoized allocations...\n";
     }
@@ -226,88 +487,114 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
         (t.arch != Target::Hexagon && (t.features_any_of({Target::HVX_64, Target::HVX_128})))) {
         debug(1) << "Selecting a GPU API for GPU loops...\n";
         s = select_gpu_api(s, t);
-        debug(2) << "Lowering after selecting a GPU API:\n" << s << "\n\n";
+        dumper.dump("Lowering after selecting a GPU API", s);
 
         debug(1) << "Injecting host <-> dev buffer copies...\n";
         s = inject_host_dev_buffer_copies(s, t);
-        debug(2) << "Lowering after injecting host <-> dev buffer copies:\n" << s << "\n\n";
+        dumper.dump("Lowering after injecting host <-> dev buffer copies", s);
 
         debug(1) << "Selecting a GPU API for extern stages...\n";
         s = select_gpu_api(s, t);
-        debug(2) << "Lowering after selecting a GPU API for extern stages:\n" << s << "\n\n";
+        dumper.dump("Lowering after selecting a GPU API for extern stages", s);
     }
 
     if (t.has_feature(Target::OpenGL)) {
         debug(1) << "Injecting OpenGL texture intrinsics...\n";
         s = inject_opengl_intrinsics(s);
-        debug(2) << "Lowering after OpenGL intrinsics:\n" << s << "\n\n";
+        dumper.dump("Lowering after OpenGL intrinsics", s);
     }
 
     if (t.has_gpu_feature() ||
         t.has_feature(Target::OpenGLCompute)) {
         debug(1) << "Injecting per-block gpu synchronization...\n";
         s = fuse_gpu_thread_loops(s);
-        debug(2) << "Lowering after injecting per-block gpu synchronization:\n" << s << "\n\n";
+        dumper.dump("Lowering after injecting per-block gpu synchronization", s);
     }
 
     debug(1) << "Simplifying...\n";
     s = simplify(s);
     s = unify_duplicate_lets(s);
     s = remove_trivial_for_loops(s);
-    debug(2) << "Lowering after second simplifcation:\n" << s << "\n\n";
+    dumper.dump("Lowering after second simplifcation", s);
+    pass_timer.record("second simplifcation", s);
+
+    if (t.has_large_buffers()) {
+        debug(1) << "Narrowing 64-bit indices that fit in 32 bits...\n";
+        s = narrow_indices(s);
+        dumper.dump("Lowering after narrowing indices", s);
+        pass_timer.record("narrowing indices", s);
+    }
 
     debug(1) << "Reduce prefetch dimension...\n";
     s = reduce_prefetch_dimension(s, t);
-    debug(2) << "Lowering after reduce prefetch dimension:\n" << s << "\n";
+    dumper.dump("Lowering after reduce prefetch dimension", s);
+    pass_timer.record("reduce prefetch dimension", s);
+
+    debug(1) << "Strength-reducing divisions...\n";
+    s = strength_reduce_division(s);
+    dumper.dump("Lowering after strength-reducing divisions", s);
+    pass_timer.record("strength-reducing divisions", s);
+
+    debug(1) << "Hoisting loop invariant code...\n";
+    s = loop_invariant_code_motion(s);
+    dumper.dump("Lowering after hoisting loop invariants", s);
+    pass_timer.record("hoisting loop invariants", s);
 
     debug(1) << "Unrolling...\n";
-    s = unroll_loops(s);
+    s = unroll_loops(s, t);
     s = simplify(s);
-    debug(2) << "Lowering after unrolling:\n" << s << "\n\n";
+    dumper.dump("Lowering after unrolling", s);
+    pass_timer.record("unrolling", s);
 
     debug(1) << "Vectorizing...\n";
     s = vectorize_loops(s, t);
     s = simplify(s);
-    debug(2) << "Lowering after vectorizing:\n" << s << "\n\n";
+    dumper.dump("Lowering after vectorizing", s);
+    pass_timer.record("vectorizing", s);
 
     debug(1) << "Detecting vector interleavings...\n";
     s = rewrite_interleavings(s);
     s = simplify(s);
-    debug(2) << "Lowering after rewriting vector interleavings:\n" << s << "\n\n";
+    dumper.dump("Lowering after rewriting vector interleavings", s);
+    pass_timer.record("rewriting vector interleavings", s);
 
     debug(1) << "Partitioning loops to simplify boundary conditions...\n";
     s = partition_loops(s);
     s = simplify(s);
-    debug(2) << "Lowering after partitioning loops:\n" << s << "\n\n";
+    dumper.dump("Lowering after partitioning loops", s);
+    pass_timer.record("partitioning loops", s);
 
     debug(1) << "Trimming loops to the region over which they do something...\n";
     s = trim_no_ops(s);
-    debug(2) << "Lowering after loop trimming:\n" << s << "\n\n";
+    dumper.dump("Lowering after loop trimming", s);
+    pass_timer.record("loop trimming", s);
 
     debug(1) << "Injecting early frees...\n";
     s = inject_early_frees(s);
-    debug(2) << "Lowering after injecting early frees:\n" << s << "\n\n";
+    dumper.dump("Lowering after injecting early frees", s);
+    pass_timer.record("injecting early frees", s);
 
     if (t.has_feature(Target::Profile)) {
         debug(1) << "Injecting profiling...\n";
         s = inject_profiling(s, pipeline_name);
-        debug(2) << "Lowering after injecting profiling:\n" << s << "\n\n";
+        dumper.dump("Lowering after injecting profiling", s);
     }
 
     if (t.has_feature(Target::FuzzFloatStores)) {
         debug(1) << "Fuzzing floating point stores...\n";
         s = fuzz_float_stores(s);
-        debug(2) << "Lowering after fuzzing floating point stores:\n" << s << "\n\n";
+        dumper.dump("Lowering after fuzzing floating point stores", s);
     }
 
     debug(1) << "Bounding small allocations...\n";
     s = bound_small_allocations(s);
-    debug(2) << "Lowering after bounding small allocations:\n" << s << "\n\n";
+    dumper.dump("Lowering after bounding small allocations", s);
+    pass_timer.record("bounding small allocations", s);
 
     if (t.has_feature(Target::CUDA)) {
         debug(1) << "Injecting warp shuffles...\n";
         s = lower_warp_shuffles(s);
-        debug(2) << "Lowering after injecting warp shuffles:\n" << s << "\n\n";
+        dumper.dump("Lowering after injecting warp shuffles", s);
     }
 
     debug(1) << "Simplifying...\n";
@@ -316,11 +603,11 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     if (t.has_feature(Target::OpenGL)) {
         debug(1) << "Detecting varying attributes...\n";
         s = find_linear_expressions(s);
-        debug(2) << "Lowering after detecting varying attributes:\n" << s << "\n\n";
+        dumper.dump("Lowering after detecting varying attributes", s);
 
         debug(1) << "Moving varying attribute expressions out of the shader...\n";
         s = setup_gpu_vertex_buffer(s);
-        debug(2) << "Lowering after removing varying attributes:\n" << s << "\n\n";
+        dumper.dump("Lowering after removing varying attributes", s);
     }
 
     s = remove_dead_allocations(s);
@@ -328,11 +615,18 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     s = simplify(s);
     s = loop_invariant_code_motion(s);
     debug(1) << "Lowering after final simplification:\n" << s << "\n\n";
+    pass_timer.record("final simplification", s);
+
+    if (!get_env_variable("HL_PERF_LINT").empty()) {
+        debug(1) << "Running performance lint...\n";
+        performance_lint(s, t);
+    }
 
     if (t.arch != Target::Hexagon && (t.features_any_of({Target::HVX_64, Target::HVX_128}))) {
         debug(1) << "Splitting off Hexagon offload...\n";
         s = inject_hexagon_rpc(s, t, result_module);
-        debug(2) << "Lowering after splitting off Hexagon offload:\n" << s << '\n';
+        dumper.dump("Lowering after splitting off Hexagon offload", s);
+        pass_timer.record("splitting off Hexagon offload", s);
     } else {
         debug(1) << "Skipping Hexagon offload...\n";
     }
@@ -342,9 +636,12 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
             debug(1) << "Running custom lowering pass " << i << "...\n";
             s = custom_passes[i]->mutate(s);
             debug(1) << "Lowering after custom pass " << i << ":\n" << s << "\n\n";
+            pass_timer.record("custom lowering pass " + std::to_string(i), s);
         }
     }
 
+    pass_timer.dump();
+
     vector<Argument> public_args = args;
     for (const auto &out : outputs) {
         for (Parameter buf : out.output_buffers()) {
@@ -428,6 +725,41 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
 
     result_module.append(main_func);
 
+    // Also emit a trusted twin of the pipeline that skips the runtime
+    // argument checks, for callers that validate arguments once up
+    // front (e.g. against the metadata) and then call the pipeline
+    // many times. Stripping the AssertStmts here has the same effect
+    // on this entry point that the no_asserts feature would have on
+    // the whole module; the simplifier then sweeps away the dead lets
+    // that computed the check conditions.
+    if (t.has_feature(Target::UncheckedEntry) && !t.has_feature(Target::NoAsserts)) {
+        class StripAsserts : public IRMutator2 {
+            using IRMutator2::visit;
+            Stmt visit(const AssertStmt *op) override {
+                return Evaluate::make(0);
+            }
+        };
+        Stmt unchecked = simplify(StripAsserts().mutate(s));
+        result_module.append(LoweredFunc(pipeline_name + "_unchecked",
+                                         public_args, unchecked, linkage_type));
+    }
+
+    // Also emit a lightweight entry point that performs only the
+    // bounds query buffer rewrites, with the same signature as the
+    // pipeline, so that callers negotiating buffer shapes don't have
+    // to run the full pipeline prologue.
+    if (bounds_query_body.defined()) {
+        Stmt bq = bounds_query_body;
+        for (size_t i = constrained_param_lets.size(); i > 0; i--) {
+            bq = LetStmt::make(constrained_param_lets[i-1].first,
+                               constrained_param_lets[i-1].second, bq);
+        }
+        bq = unpack_buffers(bq);
+        bq = simplify(bq);
+        result_module.append(LoweredFunc(pipeline_name + "_bounds_query",
+                                         public_args, bq, linkage_type));
+    }
+
     // Append a wrapper for this pipeline that accepts old buffer_ts
     // and upgrades them. It will use the same name, so it will
     // require C++ linkage. We don't need it when jitting.
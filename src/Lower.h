@@ -19,16 +19,38 @@ namespace Internal {
 
 class IRMutator2;
 
+/** Statistics about a single pass within lower(), for diagnosing
+ * compile-time problems in large pipelines. */
+struct LowerPassStats {
+    /** The name of the pass, as printed by HL_DEBUG_CODEGEN=1. */
+    std::string name;
+
+    /** Wall-clock time the pass took, in seconds. */
+    double wall_time;
+
+    /** The number of distinct IR nodes in the statement after the
+     * pass ran. */
+    int64_t ir_nodes;
+};
+
+/** Retrieve per-pass statistics for the most recent call to lower()
+ * on the current thread. Also dumped as a table at the end of
+ * lowering when HL_DEBUG_CODEGEN is at least 1. */
+const std::vector<LowerPassStats> &get_lower_pass_stats();
+
 /** Given a vector of scheduled halide functions, create a Module that
  * evaluates it. Automatically pulls in all the functions f depends
  * on. Some stages of lowering may be target-specific. The Module may
  * contain submodules for computation offloaded to another execution
  * engine or API as well as buffers that are used in the passed in
  * Stmt. Multiple LoweredFuncs are added to support legacy buffer_t
- * calling convention. */
+ * calling convention. Any requirements (AssertStmts registered via
+ * Pipeline::add_requirement) are checked at pipeline entry and
+ * assumed to hold for the rest of the pipeline. */
 Module lower(const std::vector<Function> &output_funcs, const std::string &pipeline_name, const Target &t,
                     const std::vector<Argument> &args, const LinkageType linkage_type,
-                    const std::vector<IRMutator2 *> &custom_passes = std::vector<IRMutator2 *>());
+                    const std::vector<IRMutator2 *> &custom_passes = std::vector<IRMutator2 *>(),
+                    const std::vector<Stmt> &requirements = std::vector<Stmt>());
 
 /** Given a halide function with a schedule, create a statement that
  * evaluates it. Automatically pulls in all the functions f depends
@@ -437,10 +437,125 @@ class LowerWarpShuffles : public IRMutator2 {
             return For::make(op->name, op->min, warp_size,
                              op->for_type, op->device_api, body);
         } else {
+            if (this_lane.defined() &&
+                may_use_warp_shuffle &&
+                op->for_type == ForType::Serial &&
+                is_zero(op->min) &&
+                equal(op->extent, warp_size)) {
+                Stmt equiv = lower_warp_reduction(op);
+                if (equiv.defined()) {
+                    return equiv;
+                }
+            }
             return IRMutator2::visit(op);
         }
     }
 
+    // Recognize a serial loop over the entire warp that accumulates a
+    // striped allocation, one element per lane, into a single value:
+    //
+    //   for (r, 0, warp_size) { acc[c] = acc[c] + f[r] }
+    //
+    // Every lane gathers every element, so lowering the loads
+    // individually would produce a chain of warp_size serial
+    // shuffles. Instead, rewrite the loop as a log2(warp_size)
+    // butterfly shuffle sequence, which leaves the total in every
+    // lane. Returns an undefined Stmt if the loop is not a reduction
+    // of this form.
+    Stmt lower_warp_reduction(const For *op) {
+        const Store *store = op->body.as<Store>();
+        if (!store || !is_one(store->predicate)) return Stmt();
+
+        // Only associative and commutative reductions can be
+        // reassociated into a butterfly.
+        Expr a, b;
+        Expr (*make_op)(Expr, Expr) = nullptr;
+        if (const Add *add = store->value.as<Add>()) {
+            a = add->a; b = add->b; make_op = Add::make;
+        } else if (const Mul *mul = store->value.as<Mul>()) {
+            a = mul->a; b = mul->b; make_op = Mul::make;
+        } else if (const Min *min = store->value.as<Min>()) {
+            a = min->a; b = min->b; make_op = Min::make;
+        } else if (const Max *max = store->value.as<Max>()) {
+            a = max->a; b = max->b; make_op = Max::make;
+        } else {
+            return Stmt();
+        }
+
+        // One operand must reload the value being stored, and the
+        // other must be an element of a stride-one striped allocation
+        // indexed directly by the loop variable, so that each lane
+        // owns exactly one of the values being reduced.
+        const Load *acc = a.as<Load>();
+        const Load *src = b.as<Load>();
+        auto is_reload = [&](const Load *l) {
+            return l && l->name == store->name &&
+                equal(l->index, store->index) &&
+                is_one(l->predicate);
+        };
+        if (!is_reload(acc)) {
+            std::swap(acc, src);
+        }
+        if (!is_reload(acc) || !src) return Stmt();
+        const Variable *idx = src->index.as<Variable>();
+        if (!idx ||
+            idx->name != op->name ||
+            !is_one(src->predicate) ||
+            !allocation_info.contains(src->name) ||
+            !is_one(allocation_info.get(src->name).stride)) {
+            return Stmt();
+        }
+        if (src->type.lanes() != 1 || src->type.bits() > 32) {
+            // 64-bit warp shuffles not yet implemented.
+            return Stmt();
+        }
+        if (expr_uses_var(store->index, op->name)) return Stmt();
+
+        // Start with the element this lane owns, then fold in
+        // progressively more distant lanes.
+        Expr val = mutate(Load::make(src->type, src->name, this_lane,
+                                     Buffer<>(), Parameter(), const_true()));
+        const int64_t *ws = as_const_int(warp_size);
+        internal_assert(ws);
+        for (int offset = (int)(*ws) / 2; offset > 0; offset /= 2) {
+            string name = unique_name('t');
+            Expr var = Variable::make(val.type(), name);
+            val = Let::make(name, val, make_op(var, make_warp_butterfly(var, offset)));
+        }
+
+        // Fold the total into the accumulator. Mutating the
+        // reconstructed store handles any striping of the accumulator
+        // itself.
+        string total_name = unique_name('t');
+        Expr total = Variable::make(val.type(), total_name);
+        Stmt result = Store::make(store->name, make_op(Expr(acc), total),
+                                  store->index, store->param, store->predicate);
+        result = mutate(result);
+        return LetStmt::make(total_name, val, result);
+    }
+
+    // The value the lane 'offset' away in the xor sense holds for the
+    // given register value.
+    Expr make_warp_butterfly(Expr val, int offset) {
+        Type type = val.type();
+        Type shuffle_type = type;
+        if (type.bits() < 32) {
+            shuffle_type = UInt(32);
+            val = cast(shuffle_type, reinterpret(type.with_code(Type::UInt), val));
+        }
+        string intrin_suffix = shuffle_type.is_float() ? ".f32" : ".i32";
+        // Same mask format as the general gather in make_warp_load
+        // below.
+        Expr mask = simplify(((31 & ~(warp_size - 1)) << 8) | 31);
+        Expr shuffled = Call::make(shuffle_type, "llvm.nvvm.shfl.bfly" + intrin_suffix,
+                                   {val, offset, mask}, Call::PureExtern);
+        if (shuffled.type() != type) {
+            // Narrow it back down
+            shuffled = reinterpret(type, cast(type.with_code(Type::UInt), shuffled));
+        }
+        return shuffled;
+    }
+
     Stmt visit(const IfThenElse *op) override {
         // Consider lane-masking if-then-elses when determining the
         // active bounds of the lane index.
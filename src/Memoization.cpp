@@ -280,7 +280,8 @@ public:
 
     // Returns a statement which will store the result of a computation under this key
     Stmt store_computation(std::string key_allocation_name, std::string computed_bounds_name,
-                           int32_t tuple_count, std::string storage_base_name) {
+                           int32_t tuple_count, std::string storage_base_name,
+                           const Expr &eviction_key) {
         std::vector<Expr> args;
         args.push_back(Variable::make(type_of<uint8_t *>(), key_allocation_name));
         args.push_back(key_size());
@@ -296,6 +297,19 @@ public:
         }
         args.push_back(Call::make(type_of<halide_buffer_t **>(), Call::make_struct, buffers, Call::Intrinsic));
 
+        // The eviction tag, evaluated at store time. It does not
+        // participate in the cache key; it just lets groups of
+        // entries be flushed together via
+        // halide_memoization_cache_evict.
+        if (eviction_key.defined()) {
+            internal_assert(eviction_key.type() == UInt(64));
+            args.push_back(make_const(Int(32), 1));
+            args.push_back(eviction_key);
+        } else {
+            args.push_back(make_const(Int(32), 0));
+            args.push_back(make_const(UInt(64), 0));
+        }
+
         // This is actually a void call. How to indicate that? Look at Extern_ stuff.
         return Evaluate::make(Call::make(Int(32), "halide_memoization_cache_store", args, Call::Extern));
     }
@@ -415,7 +429,8 @@ private:
                 std::string computed_bounds_name = op->name + ".computed_bounds.buffer";
 
                 Stmt cache_store_back =
-                    IfThenElse::make(cache_miss, key_info.store_computation(cache_key_name, computed_bounds_name, f.outputs(), op->name));
+                    IfThenElse::make(cache_miss, key_info.store_computation(cache_key_name, computed_bounds_name, f.outputs(), op->name,
+                                                                            f.schedule().memoize_eviction_key()));
 
                 Stmt mutated_body = Block::make(cache_store_back, body);
                 return ProducerConsumer::make(op->name, op->is_producer, mutated_body);
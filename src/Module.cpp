@@ -14,6 +14,7 @@
 #include "LLVM_Runtime_Linker.h"
 #include "Outputs.h"
 #include "StmtToHtml.h"
+#include "ThreadPool.h"
 #include "WrapExternStages.h"
 
 using Halide::Internal::debug;
@@ -264,10 +265,6 @@ Buffer<uint8_t> Module::compile_to_buffer() const {
     llvm::LLVMContext context;
     std::unique_ptr<llvm::Module> llvm_module(compile_module_to_llvm_module(*this, context));
 
-    llvm::SmallVector<char, 4096> object;
-    llvm::raw_svector_ostream object_stream(object);
-    compile_llvm_module_to_object(*llvm_module, object_stream);
-
     if (debug::debug_level() >= 2) {
         debug(2) << "Submodule assembly for " << name() << ": " << "\n";
         llvm::SmallString<4096> assembly;
@@ -276,6 +273,10 @@ Buffer<uint8_t> Module::compile_to_buffer() const {
         debug(2) << assembly.c_str() << "\n";
     }
 
+    llvm::SmallVector<char, 4096> object;
+    llvm::raw_svector_ostream object_stream(object);
+    compile_llvm_module_to_object(*llvm_module, object_stream, /*preserve_module=*/false);
+
     Buffer<uint8_t> result(object.size(), name());
     memcpy(result.data(), reinterpret_cast<uint8_t*>(&object[0]), object.size());
     return result;
@@ -362,37 +363,14 @@ void Module::compile(const Outputs &output_files_arg) const {
     if (!output_files.object_name.empty() || !output_files.assembly_name.empty() ||
         !output_files.bitcode_name.empty() || !output_files.llvm_assembly_name.empty() ||
         !output_files.static_library_name.empty()) {
+        // All of the requested outputs are generated from a single
+        // run of lowering and codegen. The IR-level outputs are
+        // written first, since the native emissions below may consume
+        // the module; the object code is emitted once and shared
+        // between object_name and static_library_name.
         llvm::LLVMContext context;
         std::unique_ptr<llvm::Module> llvm_module(compile_module_to_llvm_module(*this, context));
 
-        if (!output_files.object_name.empty()) {
-            debug(1) << "Module.compile(): object_name " << output_files.object_name << "\n";
-            auto out = make_raw_fd_ostream(output_files.object_name);
-            compile_llvm_module_to_object(*llvm_module, *out);
-        }
-        if (!output_files.static_library_name.empty()) {
-            // To simplify the code, we always create a temporary object output
-            // here, even if output_files.object_name was also set: in practice,
-            // no real-world code ever sets both object_name and static_library_name
-            // at the same time, so there is no meaningful performance advantage
-            // to be had.
-            TemporaryObjectFileDir temp_dir;
-            {
-                std::string object_name = temp_dir.add_temp_object_file(output_files.static_library_name, "", target());
-                debug(1) << "Module.compile(): temporary object_name " << object_name << "\n";
-                auto out = make_raw_fd_ostream(object_name);
-                compile_llvm_module_to_object(*llvm_module, *out);
-                out->flush();  // create_static_library() is happier if we do this
-            }
-            debug(1) << "Module.compile(): static_library_name " << output_files.static_library_name << "\n";
-            Target base_target(target().os, target().arch, target().bits);
-            create_static_library(temp_dir.files(), base_target, output_files.static_library_name);
-        }
-        if (!output_files.assembly_name.empty()) {
-            debug(1) << "Module.compile(): assembly_name " << output_files.assembly_name << "\n";
-            auto out = make_raw_fd_ostream(output_files.assembly_name);
-            compile_llvm_module_to_assembly(*llvm_module, *out);
-        }
         if (!output_files.bitcode_name.empty()) {
             debug(1) << "Module.compile(): bitcode_name " << output_files.bitcode_name << "\n";
             auto out = make_raw_fd_ostream(output_files.bitcode_name);
@@ -403,6 +381,38 @@ void Module::compile(const Outputs &output_files_arg) const {
             auto out = make_raw_fd_ostream(output_files.llvm_assembly_name);
             compile_llvm_module_to_llvm_assembly(*llvm_module, *out);
         }
+
+        const bool need_object =
+            !output_files.object_name.empty() || !output_files.static_library_name.empty();
+
+        if (!output_files.assembly_name.empty()) {
+            debug(1) << "Module.compile(): assembly_name " << output_files.assembly_name << "\n";
+            auto out = make_raw_fd_ostream(output_files.assembly_name);
+            // Only clone the module if the object emission below still needs it.
+            compile_llvm_module_to_assembly(*llvm_module, *out, /*preserve_module=*/need_object);
+        }
+        if (need_object) {
+            // Emit the object code once. If only a static library was
+            // requested, it goes to a temporary file to be archived.
+            TemporaryObjectFileDir temp_dir;
+            std::string object_name = output_files.object_name;
+            if (object_name.empty()) {
+                object_name = temp_dir.add_temp_object_file(output_files.static_library_name, "", target());
+                debug(1) << "Module.compile(): temporary object_name " << object_name << "\n";
+            } else {
+                debug(1) << "Module.compile(): object_name " << object_name << "\n";
+            }
+            {
+                auto out = make_raw_fd_ostream(object_name);
+                compile_llvm_module_to_object(*llvm_module, *out, /*preserve_module=*/false);
+                out->flush();  // create_static_library() is happier if we do this
+            }
+            if (!output_files.static_library_name.empty()) {
+                debug(1) << "Module.compile(): static_library_name " << output_files.static_library_name << "\n";
+                Target base_target(target().os, target().arch, target().bits);
+                create_static_library({object_name}, base_target, output_files.static_library_name);
+            }
+        }
     }
     if (!output_files.c_header_name.empty()) {
         debug(1) << "Module.compile(): c_header_name " << output_files.c_header_name << "\n";
@@ -491,6 +501,17 @@ void compile_multitarget(const std::string &fn_name,
     TemporaryObjectFileDir temp_dir;
     std::vector<Expr> wrapper_args;
     std::vector<LoweredArgument> base_target_args;
+
+    // Sub-modules are produced serially (generators may not be
+    // re-entrant), but each one's compilation -- the LLVM codegen,
+    // which dominates build time -- is independent and gets its own
+    // llvm::Module and LLVMContext, so farm those out to a thread
+    // pool and overlap them with producing the remaining sub-modules.
+    ThreadPool<void> compile_pool(std::min(targets.size(), ThreadPool<void>::num_processors_online()));
+    std::vector<std::future<void>> sub_compiles;
+    std::vector<std::exception_ptr> sub_compile_errors(targets.size());
+    size_t target_index = 0;
+
     for (const Target &target : targets) {
         // arch-bits-os must be identical across all targets.
         if (target.os != base_target.os ||
@@ -542,7 +563,15 @@ void compile_multitarget(const std::string &fn_name,
         internal_assert(sub_out.object_name.empty());
         sub_out.object_name = temp_dir.add_temp_object_file(output_files.static_library_name, suffix, target);
         debug(1) << "compile_multitarget: compile_sub_target " << sub_out.object_name << "\n";
-        sub_module.compile(sub_out);
+        auto compile_job = [](Module m, Outputs o, std::exception_ptr *error) {
+            try {
+                m.compile(o);
+            } catch (...) {
+                *error = std::current_exception();
+            }
+        };
+        sub_compiles.push_back(
+            compile_pool.async(compile_job, sub_module, sub_out, &sub_compile_errors[target_index++]));
 
         const uint64_t cur_target_mask = target_feature_mask(target);
         Expr can_use = (target == base_target) ?
@@ -557,6 +586,17 @@ void compile_multitarget(const std::string &fn_name,
         wrapper_args.push_back(sub_fn_name);
     }
 
+    // Wait for the sub-target compiles and surface the first failure
+    // (if any) on this thread.
+    for (auto &f : sub_compiles) {
+        f.wait();
+    }
+    for (const auto &error : sub_compile_errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
     // If we haven't specified "no runtime", build a runtime with the base target
     // and add that to the result.
     if (!base_target.has_feature(Target::NoRuntime)) {
@@ -0,0 +1,909 @@
+#include "ModuleSerialization.h"
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Debug.h"
+#include "IR.h"
+#include "Parameter.h"
+
+namespace Halide {
+
+namespace {
+
+using namespace Internal;
+
+using std::map;
+using std::string;
+using std::vector;
+
+// Bump this when the format changes incompatibly.
+const uint32_t kFormatVersion = 1;
+const char kMagic[8] = {'H', 'L', 'M', 'O', 'D', 'U', 'L', 'E'};
+
+// Node tags are the IRNodeType shifted up by one so that zero can
+// mean an undefined Expr or Stmt.
+uint8_t node_tag(IRNodeType t) {
+    return (uint8_t)t + 1;
+}
+
+class ModuleSerializer {
+public:
+    ModuleSerializer(std::ostream &out) : out(out) {}
+
+    void write_module(const Module &m) {
+        out.write(kMagic, sizeof(kMagic));
+        write_u32(kFormatVersion);
+        write_module_body(m);
+        user_assert(out.good()) << "Error writing serialized module\n";
+    }
+
+private:
+    std::ostream &out;
+
+    // Parameters and embedded buffers are pooled by name so that
+    // nodes sharing one object still share it after a round trip.
+    map<string, uint32_t> param_pool;
+    map<string, uint32_t> buffer_pool;
+
+    void write_bytes(const void *p, size_t size) {
+        out.write((const char *)p, size);
+    }
+
+    void write_u8(uint8_t x) {
+        write_bytes(&x, 1);
+    }
+
+    void write_u32(uint32_t x) {
+        write_bytes(&x, 4);
+    }
+
+    void write_i32(int32_t x) {
+        write_bytes(&x, 4);
+    }
+
+    void write_u64(uint64_t x) {
+        write_bytes(&x, 8);
+    }
+
+    void write_i64(int64_t x) {
+        write_bytes(&x, 8);
+    }
+
+    void write_f64(double x) {
+        write_bytes(&x, 8);
+    }
+
+    void write_string(const string &s) {
+        write_u32((uint32_t)s.size());
+        write_bytes(s.data(), s.size());
+    }
+
+    void write_type(Type t) {
+        write_u8(t.code());
+        write_u8(t.bits());
+        write_i32(t.lanes());
+    }
+
+    void write_parameter(const Parameter &p) {
+        if (!p.defined()) {
+            write_u8(0);
+            return;
+        }
+        auto iter = param_pool.find(p.name());
+        if (iter != param_pool.end()) {
+            write_u8(2);
+            write_u32(iter->second);
+            return;
+        }
+        param_pool[p.name()] = (uint32_t)param_pool.size();
+        write_u8(1);
+        write_string(p.name());
+        write_type(p.type());
+        write_u8(p.is_buffer() ? 1 : 0);
+        write_i32(p.dimensions());
+        write_i32(p.is_buffer() ? p.host_alignment() : 0);
+    }
+
+    void write_buffer(const Buffer<> &b) {
+        if (!b.defined()) {
+            write_u8(0);
+            return;
+        }
+        auto iter = buffer_pool.find(b.name());
+        if (iter != buffer_pool.end()) {
+            write_u8(2);
+            write_u32(iter->second);
+            return;
+        }
+        buffer_pool[b.name()] = (uint32_t)buffer_pool.size();
+        write_u8(1);
+        write_string(b.name());
+        const halide_buffer_t *buf = b.raw_buffer();
+        user_assert(buf->host != nullptr && buf->device == 0)
+            << "Cannot serialize buffer " << b.name()
+            << ": only host-resident buffers can be serialized.\n";
+        write_type(Type(buf->type));
+        write_i32(buf->dimensions);
+        for (int i = 0; i < buf->dimensions; i++) {
+            write_i32(buf->dim[i].min);
+            write_i32(buf->dim[i].extent);
+        }
+        // Elements are written in lexicographic coordinate order, so
+        // the stored form is independent of the buffer's strides.
+        const size_t bytes = buf->type.bytes();
+        vector<int> pos(buf->dimensions, 0);
+        write_buffer_elements(buf, pos, buf->dimensions - 1, bytes);
+    }
+
+    void write_buffer_elements(const halide_buffer_t *buf, vector<int> &pos,
+                               int d, size_t bytes) {
+        if (d == -1) {
+            int64_t off = 0;
+            for (int i = 0; i < buf->dimensions; i++) {
+                off += (int64_t)pos[i] * buf->dim[i].stride;
+            }
+            write_bytes(buf->host + off * bytes, bytes);
+            return;
+        }
+        for (pos[d] = 0; pos[d] < buf->dim[d].extent; pos[d]++) {
+            write_buffer_elements(buf, pos, d - 1, bytes);
+        }
+        pos[d] = 0;
+    }
+
+    void write_expr_vector(const vector<Expr> &v) {
+        write_u32((uint32_t)v.size());
+        for (const Expr &e : v) {
+            write_expr(e);
+        }
+    }
+
+    void write_region(const Region &r) {
+        write_u32((uint32_t)r.size());
+        for (const Range &range : r) {
+            write_expr(range.min);
+            write_expr(range.extent);
+        }
+    }
+
+    void write_type_vector(const vector<Type> &v) {
+        write_u32((uint32_t)v.size());
+        for (Type t : v) {
+            write_type(t);
+        }
+    }
+
+    template<typename T>
+    void write_binary_op(const Expr &e) {
+        const T *op = e.as<T>();
+        write_expr(op->a);
+        write_expr(op->b);
+    }
+
+    void write_expr(const Expr &e) {
+        if (!e.defined()) {
+            write_u8(0);
+            return;
+        }
+        write_u8(node_tag(e->node_type));
+        write_type(e.type());
+        switch (e->node_type) {
+        case IRNodeType::IntImm:
+            write_i64(e.as<IntImm>()->value);
+            break;
+        case IRNodeType::UIntImm:
+            write_u64(e.as<UIntImm>()->value);
+            break;
+        case IRNodeType::FloatImm:
+            write_f64(e.as<FloatImm>()->value);
+            break;
+        case IRNodeType::StringImm:
+            write_string(e.as<StringImm>()->value);
+            break;
+        case IRNodeType::Cast:
+            write_expr(e.as<Cast>()->value);
+            break;
+        case IRNodeType::Variable: {
+            const Variable *op = e.as<Variable>();
+            user_assert(!op->reduction_domain.defined())
+                << "Cannot serialize variable " << op->name
+                << ": it refers to a reduction domain, so the module "
+                << "containing it has not been lowered.\n";
+            write_string(op->name);
+            write_parameter(op->param);
+            write_buffer(op->image);
+            break;
+        }
+        case IRNodeType::Add: write_binary_op<Add>(e); break;
+        case IRNodeType::Sub: write_binary_op<Sub>(e); break;
+        case IRNodeType::Mul: write_binary_op<Mul>(e); break;
+        case IRNodeType::Div: write_binary_op<Div>(e); break;
+        case IRNodeType::Mod: write_binary_op<Mod>(e); break;
+        case IRNodeType::Min: write_binary_op<Min>(e); break;
+        case IRNodeType::Max: write_binary_op<Max>(e); break;
+        case IRNodeType::EQ: write_binary_op<EQ>(e); break;
+        case IRNodeType::NE: write_binary_op<NE>(e); break;
+        case IRNodeType::LT: write_binary_op<LT>(e); break;
+        case IRNodeType::LE: write_binary_op<LE>(e); break;
+        case IRNodeType::GT: write_binary_op<GT>(e); break;
+        case IRNodeType::GE: write_binary_op<GE>(e); break;
+        case IRNodeType::And: write_binary_op<And>(e); break;
+        case IRNodeType::Or: write_binary_op<Or>(e); break;
+        case IRNodeType::Not:
+            write_expr(e.as<Not>()->a);
+            break;
+        case IRNodeType::Select: {
+            const Select *op = e.as<Select>();
+            write_expr(op->condition);
+            write_expr(op->true_value);
+            write_expr(op->false_value);
+            break;
+        }
+        case IRNodeType::Load: {
+            const Load *op = e.as<Load>();
+            write_string(op->name);
+            write_expr(op->predicate);
+            write_expr(op->index);
+            write_buffer(op->image);
+            write_parameter(op->param);
+            break;
+        }
+        case IRNodeType::Ramp: {
+            const Ramp *op = e.as<Ramp>();
+            write_expr(op->base);
+            write_expr(op->stride);
+            write_i32(op->lanes);
+            break;
+        }
+        case IRNodeType::Broadcast: {
+            const Broadcast *op = e.as<Broadcast>();
+            write_expr(op->value);
+            write_i32(op->lanes);
+            break;
+        }
+        case IRNodeType::Call: {
+            const Call *op = e.as<Call>();
+            user_assert(op->call_type != Call::Halide && !op->func.defined())
+                << "Cannot serialize call to " << op->name
+                << ": it refers to a Func, so the module containing it "
+                << "has not been lowered.\n";
+            write_string(op->name);
+            write_u8((uint8_t)op->call_type);
+            write_expr_vector(op->args);
+            write_i32(op->value_index);
+            write_buffer(op->image);
+            write_parameter(op->param);
+            break;
+        }
+        case IRNodeType::Let: {
+            const Let *op = e.as<Let>();
+            write_string(op->name);
+            write_expr(op->value);
+            write_expr(op->body);
+            break;
+        }
+        case IRNodeType::Shuffle: {
+            const Shuffle *op = e.as<Shuffle>();
+            write_expr_vector(op->vectors);
+            write_u32((uint32_t)op->indices.size());
+            for (int i : op->indices) {
+                write_i32(i);
+            }
+            break;
+        }
+        default:
+            internal_error << "Unhandled Expr node in module serialization: "
+                           << e << "\n";
+        }
+    }
+
+    void write_stmt(const Stmt &s) {
+        if (!s.defined()) {
+            write_u8(0);
+            return;
+        }
+        write_u8(node_tag(s->node_type));
+        switch (s->node_type) {
+        case IRNodeType::LetStmt: {
+            const LetStmt *op = s.as<LetStmt>();
+            write_string(op->name);
+            write_expr(op->value);
+            write_stmt(op->body);
+            break;
+        }
+        case IRNodeType::AssertStmt: {
+            const AssertStmt *op = s.as<AssertStmt>();
+            write_expr(op->condition);
+            write_expr(op->message);
+            break;
+        }
+        case IRNodeType::ProducerConsumer: {
+            const ProducerConsumer *op = s.as<ProducerConsumer>();
+            write_string(op->name);
+            write_u8(op->is_producer ? 1 : 0);
+            write_stmt(op->body);
+            break;
+        }
+        case IRNodeType::For: {
+            const For *op = s.as<For>();
+            write_string(op->name);
+            write_expr(op->min);
+            write_expr(op->extent);
+            write_u8((uint8_t)op->for_type);
+            write_u8((uint8_t)op->device_api);
+            write_stmt(op->body);
+            break;
+        }
+        case IRNodeType::Store: {
+            const Store *op = s.as<Store>();
+            write_string(op->name);
+            write_expr(op->predicate);
+            write_expr(op->value);
+            write_expr(op->index);
+            write_parameter(op->param);
+            break;
+        }
+        case IRNodeType::Provide: {
+            const Provide *op = s.as<Provide>();
+            write_string(op->name);
+            write_expr_vector(op->values);
+            write_expr_vector(op->args);
+            break;
+        }
+        case IRNodeType::Allocate: {
+            const Allocate *op = s.as<Allocate>();
+            write_string(op->name);
+            write_type(op->type);
+            write_u8((uint8_t)op->memory_type);
+            write_expr_vector(op->extents);
+            write_expr(op->condition);
+            write_expr(op->new_expr);
+            write_string(op->free_function);
+            write_stmt(op->body);
+            break;
+        }
+        case IRNodeType::Free:
+            write_string(s.as<Free>()->name);
+            break;
+        case IRNodeType::Realize: {
+            const Realize *op = s.as<Realize>();
+            write_string(op->name);
+            write_type_vector(op->types);
+            write_u8((uint8_t)op->memory_type);
+            write_region(op->bounds);
+            write_expr(op->condition);
+            write_stmt(op->body);
+            break;
+        }
+        case IRNodeType::Block: {
+            const Block *op = s.as<Block>();
+            write_stmt(op->first);
+            write_stmt(op->rest);
+            break;
+        }
+        case IRNodeType::IfThenElse: {
+            const IfThenElse *op = s.as<IfThenElse>();
+            write_expr(op->condition);
+            write_stmt(op->then_case);
+            write_stmt(op->else_case);
+            break;
+        }
+        case IRNodeType::Evaluate:
+            write_expr(s.as<Evaluate>()->value);
+            break;
+        case IRNodeType::Prefetch: {
+            const Prefetch *op = s.as<Prefetch>();
+            write_string(op->name);
+            write_type_vector(op->types);
+            write_region(op->bounds);
+            write_parameter(op->param);
+            break;
+        }
+        default:
+            internal_error << "Unhandled Stmt node in module serialization: "
+                           << s << "\n";
+        }
+    }
+
+    void write_lowered_func(const LoweredFunc &f) {
+        write_string(f.name);
+        write_u8((uint8_t)f.linkage);
+        write_u8((uint8_t)f.name_mangling);
+        write_u32((uint32_t)f.args.size());
+        for (const LoweredArgument &arg : f.args) {
+            write_string(arg.name);
+            write_u8((uint8_t)arg.kind);
+            write_u8(arg.dimensions);
+            write_type(arg.type);
+            write_expr(arg.def);
+            write_expr(arg.min);
+            write_expr(arg.max);
+            write_i32(arg.alignment.modulus);
+            write_i32(arg.alignment.remainder);
+        }
+        write_stmt(f.body);
+    }
+
+    void write_module_body(const Module &m) {
+        user_assert(m.external_code().empty())
+            << "Cannot serialize module " << m.name()
+            << ": it carries ExternalCode blobs.\n";
+        write_string(m.name());
+        write_string(m.target().to_string());
+        write_string(m.auto_schedule());
+        write_u8(m.any_strict_float() ? 1 : 0);
+        write_u32((uint32_t)m.buffers().size());
+        for (const Buffer<> &b : m.buffers()) {
+            write_buffer(b);
+        }
+        write_u32((uint32_t)m.functions().size());
+        for (const LoweredFunc &f : m.functions()) {
+            write_lowered_func(f);
+        }
+        write_u32((uint32_t)m.submodules().size());
+        for (const Module &sub : m.submodules()) {
+            write_module_body(sub);
+        }
+    }
+};
+
+class ModuleDeserializer {
+public:
+    ModuleDeserializer(std::istream &in) : in(in) {}
+
+    Module read_module() {
+        char magic[sizeof(kMagic)];
+        read_bytes(magic, sizeof(magic));
+        user_assert(memcmp(magic, kMagic, sizeof(kMagic)) == 0)
+            << "Input is not a serialized Halide module\n";
+        uint32_t version = read_u32();
+        user_assert(version == kFormatVersion)
+            << "Serialized module has format version " << version
+            << "; expected " << kFormatVersion << "\n";
+        return read_module_body();
+    }
+
+private:
+    std::istream &in;
+
+    vector<Parameter> param_pool;
+    vector<Buffer<>> buffer_pool;
+
+    void read_bytes(void *p, size_t size) {
+        in.read((char *)p, size);
+        user_assert(in.good()) << "Unexpected end of serialized module\n";
+    }
+
+    uint8_t read_u8() {
+        uint8_t x;
+        read_bytes(&x, 1);
+        return x;
+    }
+
+    uint32_t read_u32() {
+        uint32_t x;
+        read_bytes(&x, 4);
+        return x;
+    }
+
+    int32_t read_i32() {
+        int32_t x;
+        read_bytes(&x, 4);
+        return x;
+    }
+
+    uint64_t read_u64() {
+        uint64_t x;
+        read_bytes(&x, 8);
+        return x;
+    }
+
+    int64_t read_i64() {
+        int64_t x;
+        read_bytes(&x, 8);
+        return x;
+    }
+
+    double read_f64() {
+        double x;
+        read_bytes(&x, 8);
+        return x;
+    }
+
+    string read_string() {
+        uint32_t size = read_u32();
+        string s(size, '\0');
+        if (size) {
+            read_bytes(&s[0], size);
+        }
+        return s;
+    }
+
+    Type read_type() {
+        uint8_t code = read_u8();
+        uint8_t bits = read_u8();
+        int32_t lanes = read_i32();
+        return Type((halide_type_code_t)code, bits, lanes);
+    }
+
+    Parameter read_parameter() {
+        uint8_t flag = read_u8();
+        if (flag == 0) {
+            return Parameter();
+        }
+        if (flag == 2) {
+            uint32_t index = read_u32();
+            user_assert(index < param_pool.size())
+                << "Serialized module refers to unknown parameter\n";
+            return param_pool[index];
+        }
+        user_assert(flag == 1) << "Corrupt parameter in serialized module\n";
+        string name = read_string();
+        Type t = read_type();
+        bool is_buffer = read_u8() != 0;
+        int dims = read_i32();
+        int host_alignment = read_i32();
+        Parameter p(t, is_buffer, dims, name, /* is_explicit_name */ true);
+        if (is_buffer) {
+            p.set_host_alignment(host_alignment);
+        }
+        param_pool.push_back(p);
+        return p;
+    }
+
+    Buffer<> read_buffer() {
+        uint8_t flag = read_u8();
+        if (flag == 0) {
+            return Buffer<>();
+        }
+        if (flag == 2) {
+            uint32_t index = read_u32();
+            user_assert(index < buffer_pool.size())
+                << "Serialized module refers to unknown buffer\n";
+            return buffer_pool[index];
+        }
+        user_assert(flag == 1) << "Corrupt buffer in serialized module\n";
+        string name = read_string();
+        Type t = read_type();
+        int dims = read_i32();
+        vector<int> mins(dims), extents(dims);
+        for (int i = 0; i < dims; i++) {
+            mins[i] = read_i32();
+            extents[i] = read_i32();
+        }
+        Buffer<> b(t, extents, name);
+        halide_buffer_t *buf = b.raw_buffer();
+        for (int i = 0; i < dims; i++) {
+            buf->dim[i].min = mins[i];
+        }
+        const size_t bytes = buf->type.bytes();
+        vector<int> pos(dims, 0);
+        read_buffer_elements(buf, pos, dims - 1, bytes);
+        buffer_pool.push_back(b);
+        return b;
+    }
+
+    void read_buffer_elements(halide_buffer_t *buf, vector<int> &pos,
+                              int d, size_t bytes) {
+        if (d == -1) {
+            int64_t off = 0;
+            for (int i = 0; i < buf->dimensions; i++) {
+                off += (int64_t)pos[i] * buf->dim[i].stride;
+            }
+            read_bytes(buf->host + off * bytes, bytes);
+            return;
+        }
+        for (pos[d] = 0; pos[d] < buf->dim[d].extent; pos[d]++) {
+            read_buffer_elements(buf, pos, d - 1, bytes);
+        }
+        pos[d] = 0;
+    }
+
+    vector<Expr> read_expr_vector() {
+        uint32_t size = read_u32();
+        vector<Expr> v(size);
+        for (uint32_t i = 0; i < size; i++) {
+            v[i] = read_expr();
+        }
+        return v;
+    }
+
+    Region read_region() {
+        uint32_t size = read_u32();
+        Region r(size);
+        for (uint32_t i = 0; i < size; i++) {
+            Expr min = read_expr();
+            Expr extent = read_expr();
+            r[i] = Range(min, extent);
+        }
+        return r;
+    }
+
+    vector<Type> read_type_vector() {
+        uint32_t size = read_u32();
+        vector<Type> v(size);
+        for (uint32_t i = 0; i < size; i++) {
+            v[i] = read_type();
+        }
+        return v;
+    }
+
+    template<typename T>
+    Expr read_binary_op() {
+        Expr a = read_expr();
+        Expr b = read_expr();
+        return T::make(a, b);
+    }
+
+    Expr read_expr() {
+        uint8_t tag = read_u8();
+        if (tag == 0) {
+            return Expr();
+        }
+        IRNodeType node_type = (IRNodeType)(tag - 1);
+        Type t = read_type();
+        switch (node_type) {
+        case IRNodeType::IntImm:
+            return IntImm::make(t, read_i64());
+        case IRNodeType::UIntImm:
+            return UIntImm::make(t, read_u64());
+        case IRNodeType::FloatImm:
+            return FloatImm::make(t, read_f64());
+        case IRNodeType::StringImm:
+            return StringImm::make(read_string());
+        case IRNodeType::Cast:
+            return Cast::make(t, read_expr());
+        case IRNodeType::Variable: {
+            string name = read_string();
+            Parameter param = read_parameter();
+            Buffer<> image = read_buffer();
+            return Variable::make(t, name, image, param, ReductionDomain());
+        }
+        case IRNodeType::Add: return read_binary_op<Add>();
+        case IRNodeType::Sub: return read_binary_op<Sub>();
+        case IRNodeType::Mul: return read_binary_op<Mul>();
+        case IRNodeType::Div: return read_binary_op<Div>();
+        case IRNodeType::Mod: return read_binary_op<Mod>();
+        case IRNodeType::Min: return read_binary_op<Min>();
+        case IRNodeType::Max: return read_binary_op<Max>();
+        case IRNodeType::EQ: return read_binary_op<EQ>();
+        case IRNodeType::NE: return read_binary_op<NE>();
+        case IRNodeType::LT: return read_binary_op<LT>();
+        case IRNodeType::LE: return read_binary_op<LE>();
+        case IRNodeType::GT: return read_binary_op<GT>();
+        case IRNodeType::GE: return read_binary_op<GE>();
+        case IRNodeType::And: return read_binary_op<And>();
+        case IRNodeType::Or: return read_binary_op<Or>();
+        case IRNodeType::Not:
+            return Not::make(read_expr());
+        case IRNodeType::Select: {
+            Expr condition = read_expr();
+            Expr true_value = read_expr();
+            Expr false_value = read_expr();
+            return Select::make(condition, true_value, false_value);
+        }
+        case IRNodeType::Load: {
+            string name = read_string();
+            Expr predicate = read_expr();
+            Expr index = read_expr();
+            Buffer<> image = read_buffer();
+            Parameter param = read_parameter();
+            return Load::make(t, name, index, image, param, predicate);
+        }
+        case IRNodeType::Ramp: {
+            Expr base = read_expr();
+            Expr stride = read_expr();
+            int lanes = read_i32();
+            return Ramp::make(base, stride, lanes);
+        }
+        case IRNodeType::Broadcast: {
+            Expr value = read_expr();
+            int lanes = read_i32();
+            return Broadcast::make(value, lanes);
+        }
+        case IRNodeType::Call: {
+            string name = read_string();
+            Call::CallType call_type = (Call::CallType)read_u8();
+            vector<Expr> args = read_expr_vector();
+            int value_index = read_i32();
+            Buffer<> image = read_buffer();
+            Parameter param = read_parameter();
+            return Call::make(t, name, args, call_type,
+                              FunctionPtr(), value_index, image, param);
+        }
+        case IRNodeType::Let: {
+            string name = read_string();
+            Expr value = read_expr();
+            Expr body = read_expr();
+            return Let::make(name, value, body);
+        }
+        case IRNodeType::Shuffle: {
+            vector<Expr> vectors = read_expr_vector();
+            uint32_t size = read_u32();
+            vector<int> indices(size);
+            for (uint32_t i = 0; i < size; i++) {
+                indices[i] = read_i32();
+            }
+            return Shuffle::make(vectors, indices);
+        }
+        default:
+            user_error << "Corrupt Expr node in serialized module\n";
+            return Expr();
+        }
+    }
+
+    Stmt read_stmt() {
+        uint8_t tag = read_u8();
+        if (tag == 0) {
+            return Stmt();
+        }
+        IRNodeType node_type = (IRNodeType)(tag - 1);
+        switch (node_type) {
+        case IRNodeType::LetStmt: {
+            string name = read_string();
+            Expr value = read_expr();
+            Stmt body = read_stmt();
+            return LetStmt::make(name, value, body);
+        }
+        case IRNodeType::AssertStmt: {
+            Expr condition = read_expr();
+            Expr message = read_expr();
+            return AssertStmt::make(condition, message);
+        }
+        case IRNodeType::ProducerConsumer: {
+            string name = read_string();
+            bool is_producer = read_u8() != 0;
+            Stmt body = read_stmt();
+            return ProducerConsumer::make(name, is_producer, body);
+        }
+        case IRNodeType::For: {
+            string name = read_string();
+            Expr min = read_expr();
+            Expr extent = read_expr();
+            ForType for_type = (ForType)read_u8();
+            DeviceAPI device_api = (DeviceAPI)read_u8();
+            Stmt body = read_stmt();
+            return For::make(name, min, extent, for_type, device_api, body);
+        }
+        case IRNodeType::Store: {
+            string name = read_string();
+            Expr predicate = read_expr();
+            Expr value = read_expr();
+            Expr index = read_expr();
+            Parameter param = read_parameter();
+            return Store::make(name, value, index, param, predicate);
+        }
+        case IRNodeType::Provide: {
+            string name = read_string();
+            vector<Expr> values = read_expr_vector();
+            vector<Expr> args = read_expr_vector();
+            return Provide::make(name, values, args);
+        }
+        case IRNodeType::Allocate: {
+            string name = read_string();
+            Type t = read_type();
+            MemoryType memory_type = (MemoryType)read_u8();
+            vector<Expr> extents = read_expr_vector();
+            Expr condition = read_expr();
+            Expr new_expr = read_expr();
+            string free_function = read_string();
+            Stmt body = read_stmt();
+            return Allocate::make(name, t, memory_type, extents, condition,
+                                  body, new_expr, free_function);
+        }
+        case IRNodeType::Free:
+            return Free::make(read_string());
+        case IRNodeType::Realize: {
+            string name = read_string();
+            vector<Type> types = read_type_vector();
+            MemoryType memory_type = (MemoryType)read_u8();
+            Region bounds = read_region();
+            Expr condition = read_expr();
+            Stmt body = read_stmt();
+            return Realize::make(name, types, memory_type, bounds, condition, body);
+        }
+        case IRNodeType::Block: {
+            Stmt first = read_stmt();
+            Stmt rest = read_stmt();
+            return Block::make(first, rest);
+        }
+        case IRNodeType::IfThenElse: {
+            Expr condition = read_expr();
+            Stmt then_case = read_stmt();
+            Stmt else_case = read_stmt();
+            return IfThenElse::make(condition, then_case, else_case);
+        }
+        case IRNodeType::Evaluate:
+            return Evaluate::make(read_expr());
+        case IRNodeType::Prefetch: {
+            string name = read_string();
+            vector<Type> types = read_type_vector();
+            Region bounds = read_region();
+            Parameter param = read_parameter();
+            return Prefetch::make(name, types, bounds, param);
+        }
+        default:
+            user_error << "Corrupt Stmt node in serialized module\n";
+            return Stmt();
+        }
+    }
+
+    LoweredFunc read_lowered_func() {
+        string name = read_string();
+        LinkageType linkage = (LinkageType)read_u8();
+        NameMangling mangling = (NameMangling)read_u8();
+        uint32_t num_args = read_u32();
+        vector<LoweredArgument> args;
+        args.reserve(num_args);
+        for (uint32_t i = 0; i < num_args; i++) {
+            string arg_name = read_string();
+            Argument::Kind kind = (Argument::Kind)read_u8();
+            uint8_t dimensions = read_u8();
+            Type t = read_type();
+            Expr def = read_expr();
+            Expr min = read_expr();
+            Expr max = read_expr();
+            LoweredArgument arg(arg_name, kind, t, dimensions, def, min, max);
+            arg.alignment.modulus = read_i32();
+            arg.alignment.remainder = read_i32();
+            args.push_back(arg);
+        }
+        Stmt body = read_stmt();
+        return LoweredFunc(name, args, body, linkage, mangling);
+    }
+
+    Module read_module_body() {
+        string name = read_string();
+        Target target(read_string());
+        string auto_schedule = read_string();
+        bool any_strict_float = read_u8() != 0;
+        Module m(name, target);
+        if (!auto_schedule.empty()) {
+            m.set_auto_schedule(auto_schedule);
+        }
+        m.set_any_strict_float(any_strict_float);
+        uint32_t num_buffers = read_u32();
+        for (uint32_t i = 0; i < num_buffers; i++) {
+            m.append(read_buffer());
+        }
+        uint32_t num_functions = read_u32();
+        for (uint32_t i = 0; i < num_functions; i++) {
+            m.append(read_lowered_func());
+        }
+        uint32_t num_submodules = read_u32();
+        for (uint32_t i = 0; i < num_submodules; i++) {
+            m.append(read_module_body());
+        }
+        return m;
+    }
+};
+
+}  // namespace
+
+void serialize_module(const Module &module, std::ostream &out) {
+    ModuleSerializer(out).write_module(module);
+}
+
+void serialize_module(const Module &module, const std::string &filename) {
+    std::ofstream f(filename.c_str(), std::ios::binary);
+    user_assert(f.good()) << "Could not open " << filename << " for writing\n";
+    serialize_module(module, f);
+    f.close();
+    user_assert(f.good()) << "Error writing serialized module to " << filename << "\n";
+}
+
+Module deserialize_module(std::istream &in) {
+    return ModuleDeserializer(in).read_module();
+}
+
+Module deserialize_module(const std::string &filename) {
+    std::ifstream f(filename.c_str(), std::ios::binary);
+    user_assert(f.good()) << "Could not open " << filename << " for reading\n";
+    return deserialize_module(f);
+}
+
+}  // namespace Halide
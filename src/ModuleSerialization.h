@@ -0,0 +1,41 @@
+#ifndef HALIDE_MODULE_SERIALIZATION_H
+#define HALIDE_MODULE_SERIALIZATION_H
+
+/** \file
+ *
+ * Defines functions that serialize a lowered Module to a binary
+ * format and reconstruct it later, so a pipeline can be lowered once,
+ * stored, and code-generated on another machine without re-running
+ * the generator that produced it.
+ */
+
+#include <iostream>
+#include <string>
+
+#include "Module.h"
+
+namespace Halide {
+
+/** Write a binary representation of a lowered Module to a stream or
+ * file. Captures the module's functions (including their bodies and
+ * argument lists), embedded buffers, submodules, target, and
+ * auto-schedule text. The module must be fully lowered: IR that still
+ * refers to Funcs or reduction domains cannot be serialized, and
+ * neither can modules carrying ExternalCode blobs. Scalar parameter
+ * values bound for JIT use are not captured. */
+// @{
+void serialize_module(const Module &module, std::ostream &out);
+void serialize_module(const Module &module, const std::string &filename);
+// @}
+
+/** Reconstruct a Module written by serialize_module. The result can
+ * be passed to Module::compile and friends as usual. Asserts if the
+ * input is malformed or was written by an incompatible version. */
+// @{
+Module deserialize_module(std::istream &in);
+Module deserialize_module(const std::string &filename);
+// @}
+
+}  // namespace Halide
+
+#endif
@@ -8,6 +8,8 @@
 namespace Halide {
 namespace Internal {
 
+int64_t mod(int64_t a, int64_t m);
+
 class ComputeModulusRemainder : public IRVisitor {
 public:
     ModulusRemainder analyze(Expr e);
@@ -133,6 +135,16 @@ void modulus_remainder_test() {
     check(123, 0, 123);
     check(Let::make("y", x*3 + 4, y*3 + 4), 9, 7);
 
+    // Check bitwise ops, shifts, divs, and casts.
+    check((x*4 + 1) & 3, 0, 1);
+    check((x*2 + 1) << 2, 8, 4);
+    check((x*8 + 4) >> 1, 4, 2);
+    check((x*8 + 5) / 2, 4, 2);
+    check((x*16 + 3) % 8, 0, 3);
+    check(cast(Int(16), x*256 + 34), 256, 34);
+    check(cast(Int(64), x*4 + 3), 4, 3);
+    check(cast(Int(8), x*1024 + 7), 256, 7);
+
     std::cout << "modulus_remainder test passed\n";
 }
 
@@ -146,7 +158,13 @@ void ComputeModulusRemainder::visit(const IntImm *op) {
 }
 
 void ComputeModulusRemainder::visit(const UIntImm *op) {
-    internal_error << "modulus_remainder of uint\n";
+    if (op->value <= (uint64_t)0x7fffffff) {
+        remainder = (int)op->value;
+        modulus = 0;
+    } else {
+        remainder = 0;
+        modulus = 1;
+    }
 }
 
 void ComputeModulusRemainder::visit(const FloatImm *) {
@@ -157,7 +175,24 @@ void ComputeModulusRemainder::visit(const StringImm *) {
     internal_error << "modulus_remainder of string\n";
 }
 
-void ComputeModulusRemainder::visit(const Cast *) {
+void ComputeModulusRemainder::visit(const Cast *op) {
+    // Casts between signed integer types either preserve the value
+    // exactly (widening), or wrap it by a multiple of a power of two
+    // (narrowing). Wrapping preserves congruence modulo anything that
+    // divides both the modulus and the size of the destination type.
+    if (op->type.is_int() && op->value.type().is_int()) {
+        ModulusRemainder a = analyze(op->value);
+        if (op->type.bits() >= op->value.type().bits()) {
+            modulus = a.modulus;
+            remainder = a.remainder;
+            return;
+        } else if (a.modulus > 0 && op->type.bits() < 32) {
+            int64_t size = (int64_t)1 << op->type.bits();
+            modulus = gcd(a.modulus, size);
+            remainder = mod(a.remainder, modulus);
+            return;
+        }
+    }
     modulus = 1;
     remainder = 0;
 }
@@ -235,10 +270,26 @@ void ComputeModulusRemainder::visit(const Mul *op) {
     }
 }
 
-void ComputeModulusRemainder::visit(const Div *) {
-    // We might be able to say something about this if the numerator
-    // modulus is provably a multiple of a constant denominator, but
-    // in this case we should have simplified away the division.
+void ComputeModulusRemainder::visit(const Div *op) {
+    // When the denominator is a positive constant that divides the
+    // numerator's modulus, the division distributes over the terms:
+    // (m*x + r) / c == (m/c)*x + r/c, using round-towards-negative-
+    // infinity division, which is what Div means for ints. The
+    // remainder needn't be divisible: it's in [0, m), so its floor
+    // quotient lands in [0, m/c).
+    ModulusRemainder a = analyze(op->a);
+    ModulusRemainder b = analyze(op->b);
+    if (b.modulus == 0 && b.remainder > 0) {
+        if (a.modulus == 0) {
+            modulus = 0;
+            remainder = (int)div_imp((int64_t)a.remainder, (int64_t)b.remainder);
+            return;
+        } else if (a.modulus > 0 && a.modulus % b.remainder == 0) {
+            modulus = a.modulus / b.remainder;
+            remainder = mod(div_imp((int64_t)a.remainder, (int64_t)b.remainder), modulus);
+            return;
+        }
+    }
     remainder = 0;
     modulus = 1;
 }
@@ -294,6 +345,16 @@ void ComputeModulusRemainder::visit(const Mod *op) {
     // 2w + 1
     ModulusRemainder a = analyze(op->a);
     ModulusRemainder b = analyze(op->b);
+
+    // If the denominator is a constant that divides the numerator's
+    // modulus, the result is just a constant.
+    if (b.modulus == 0 && b.remainder > 0 &&
+        a.modulus > 0 && a.modulus % b.remainder == 0) {
+        modulus = 0;
+        remainder = mod(a.remainder, b.remainder);
+        return;
+    }
+
     modulus = gcd(a.modulus, b.modulus);
     modulus = gcd(modulus, b.remainder);
     remainder = mod(a.remainder, modulus);
@@ -367,7 +428,36 @@ void ComputeModulusRemainder::visit(const Broadcast *) {
     internal_assert(false) << "modulus_remainder of vector\n";
 }
 
-void ComputeModulusRemainder::visit(const Call *) {
+void ComputeModulusRemainder::visit(const Call *op) {
+    // The bitwise intrinsics with power-of-two operands are just
+    // arithmetic in disguise, so analyze them as the arithmetic the
+    // simplifier would lower them to. This catches masks and shifts
+    // that haven't passed through the simplifier yet.
+    const int64_t *shift = op->args.size() == 2 ? as_const_int(op->args[1]) : nullptr;
+    if (op->type.is_int() && shift) {
+        int64_t ib = *shift;
+        if (op->is_intrinsic(Call::shift_left) &&
+            ib >= 0 && ib < 31) {
+            ModulusRemainder r = analyze(Mul::make(op->args[0], make_const(op->type, (int64_t)1 << ib)));
+            modulus = r.modulus;
+            remainder = r.remainder;
+            return;
+        } else if (op->is_intrinsic(Call::shift_right) &&
+                   ib >= 0 && ib < 31) {
+            ModulusRemainder r = analyze(Div::make(op->args[0], make_const(op->type, (int64_t)1 << ib)));
+            modulus = r.modulus;
+            remainder = r.remainder;
+            return;
+        } else if (op->is_intrinsic(Call::bitwise_and) &&
+                   ib >= 0 && ib < 0x40000000 &&
+                   ((ib & (ib + 1)) == 0)) {
+            // Masking by a power of two minus one is a Euclidean mod.
+            ModulusRemainder r = analyze(Mod::make(op->args[0], make_const(op->type, ib + 1)));
+            modulus = r.modulus;
+            remainder = r.remainder;
+            return;
+        }
+    }
     modulus = 1;
     remainder = 0;
 }
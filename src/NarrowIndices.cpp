@@ -0,0 +1,172 @@
+#include "NarrowIndices.h"
+#include "Bounds.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Scope.h"
+
+namespace Halide {
+namespace Internal {
+
+namespace {
+
+class NarrowIndices : public IRMutator2 {
+    using IRMutator2::visit;
+
+    Scope<Interval> scope;
+
+    // Does every value this expression can take fit in an int32?
+    bool fits_in_int32(const Expr &e) {
+        Interval i = find_constant_bounds(e, scope);
+        if (!i.is_bounded()) {
+            return false;
+        }
+        const int64_t *lo = as_const_int(i.min);
+        const int64_t *hi = as_const_int(i.max);
+        return (lo && hi &&
+                *lo >= -2147483648LL &&
+                *hi <= 2147483647LL);
+    }
+
+    // Rewrite a 64-bit index in 32-bit arithmetic. Returns an
+    // undefined Expr if the index or any of its subexpressions can't
+    // be proved to fit in an int32, in which case the index must be
+    // left as it is.
+    Expr narrow(const Expr &e) {
+        internal_assert(e.type().element_of() == Int(64));
+        Type narrow_type = Int(32, e.type().lanes());
+        if (const IntImm *imm = e.as<IntImm>()) {
+            if (imm->value >= -2147483648LL && imm->value <= 2147483647LL) {
+                return IntImm::make(Int(32), imm->value);
+            }
+            return Expr();
+        } else if (const Cast *c = e.as<Cast>()) {
+            // Indices are usually 32-bit terms widened by storage
+            // flattening, so this is where most of the narrowing
+            // happens.
+            if (c->value.type() == narrow_type) {
+                return c->value;
+            } else if (c->value.type().bits() < 32) {
+                return Cast::make(narrow_type, c->value);
+            } else if (c->value.type().is_uint() && fits_in_int32(e)) {
+                return Cast::make(narrow_type, c->value);
+            }
+            return Expr();
+        } else if (const Add *op = e.as<Add>()) {
+            return narrow_binop<Add>(e, op->a, op->b);
+        } else if (const Sub *op = e.as<Sub>()) {
+            return narrow_binop<Sub>(e, op->a, op->b);
+        } else if (const Mul *op = e.as<Mul>()) {
+            return narrow_binop<Mul>(e, op->a, op->b);
+        } else if (const Div *op = e.as<Div>()) {
+            return narrow_binop<Div>(e, op->a, op->b);
+        } else if (const Mod *op = e.as<Mod>()) {
+            return narrow_binop<Mod>(e, op->a, op->b);
+        } else if (const Min *op = e.as<Min>()) {
+            return narrow_binop<Min>(e, op->a, op->b);
+        } else if (const Max *op = e.as<Max>()) {
+            return narrow_binop<Max>(e, op->a, op->b);
+        } else if (const Select *op = e.as<Select>()) {
+            Expr t = narrow(op->true_value);
+            Expr f = t.defined() ? narrow(op->false_value) : Expr();
+            if (f.defined()) {
+                return Select::make(op->condition, t, f);
+            }
+            return Expr();
+        } else if (const Ramp *op = e.as<Ramp>()) {
+            if (!fits_in_int32(e)) {
+                return Expr();
+            }
+            Expr base = narrow(op->base);
+            Expr stride = base.defined() ? narrow(op->stride) : Expr();
+            if (stride.defined()) {
+                return Ramp::make(base, stride, op->lanes);
+            }
+            return Expr();
+        } else if (const Broadcast *op = e.as<Broadcast>()) {
+            Expr value = narrow(op->value);
+            if (value.defined()) {
+                return Broadcast::make(value, op->lanes);
+            }
+            return Expr();
+        }
+        // Anything else (variables of unknown provenance, lets,
+        // loads used as indices, ...) we don't know how to retype.
+        return Expr();
+    }
+
+    // Narrow a binary op, requiring that the value of the node itself
+    // fits, so that evaluating it in 32 bits is exact.
+    template<typename Op>
+    Expr narrow_binop(const Expr &e, const Expr &ea, const Expr &eb) {
+        if (!fits_in_int32(e)) {
+            return Expr();
+        }
+        Expr a = narrow(ea);
+        Expr b = a.defined() ? narrow(eb) : Expr();
+        if (b.defined()) {
+            return Op::make(a, b);
+        }
+        return Expr();
+    }
+
+    Stmt visit(const For *op) override {
+        ScopedBinding<Interval> bind(scope, op->name,
+                                     Interval(op->min, op->min + op->extent - 1));
+        return IRMutator2::visit(op);
+    }
+
+    template<typename LetOrLetStmt>
+    auto visit_let(const LetOrLetStmt *op) -> decltype(IRMutator2::visit(op)) {
+        bool track = op->value.type().is_scalar() &&
+                     (op->value.type().is_int() || op->value.type().is_uint());
+        Interval value_bounds = Interval::everything();
+        if (track) {
+            value_bounds = find_constant_bounds(op->value, scope);
+        }
+        ScopedBinding<Interval> bind(track, scope, op->name, value_bounds);
+        return IRMutator2::visit(op);
+    }
+
+    Expr visit(const Let *op) override {
+        return visit_let(op);
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        return visit_let(op);
+    }
+
+    Expr visit(const Load *op) override {
+        Expr e = IRMutator2::visit(op);
+        const Load *load = e.as<Load>();
+        if (load && load->index.type().element_of() == Int(64)) {
+            Expr index = narrow(load->index);
+            if (index.defined()) {
+                return Load::make(load->type, load->name, index,
+                                  load->image, load->param, load->predicate);
+            }
+        }
+        return e;
+    }
+
+    Stmt visit(const Store *op) override {
+        Stmt s = IRMutator2::visit(op);
+        const Store *store = s.as<Store>();
+        if (store && store->index.type().element_of() == Int(64)) {
+            Expr index = narrow(store->index);
+            if (index.defined()) {
+                return Store::make(store->name, store->value, index,
+                                   store->param, store->predicate);
+            }
+        }
+        return s;
+    }
+};
+
+}  // namespace
+
+Stmt narrow_indices(Stmt s) {
+    return NarrowIndices().mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,26 @@
+#ifndef HALIDE_NARROW_INDICES_H
+#define HALIDE_NARROW_INDICES_H
+
+/** \file
+ * Defines the lowering pass that narrows 64-bit load and store
+ * indices back to 32 bits when they provably fit.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** With the large_buffers target feature, storage flattening computes
+ * all indices in 64-bit arithmetic, even for buffers that are small.
+ * Walk the stmt proving bounds on load and store indices, and rewrite
+ * any index that provably fits in an int32 (along with each of its
+ * subexpressions) to use 32-bit arithmetic, which keeps vector
+ * address computations at full lane width. Indices that can't be
+ * proved small are left alone. */
+Stmt narrow_indices(Stmt s);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "ObjectInstanceRegistry.h"
 #include "Error.h"
 #include "Introspection.h"
@@ -15,28 +17,30 @@ ObjectInstanceRegistry &ObjectInstanceRegistry::get_registry() {
 void ObjectInstanceRegistry::register_instance(void *this_ptr, size_t size, Kind kind,
                                                void *subject_ptr, const void *introspection_helper) {
     ObjectInstanceRegistry &registry = get_registry();
-    std::lock_guard<std::mutex> lock(registry.mutex);
     uintptr_t key = (uintptr_t)this_ptr;
-    internal_assert(registry.instances.find(key) == registry.instances.end());
+    Shard &shard = registry.shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    internal_assert(shard.instances.find(key) == shard.instances.end());
     if (introspection_helper) {
-        registry.instances[key] = InstanceInfo(size, kind, subject_ptr, true);
+        shard.instances[key] = InstanceInfo(size, kind, subject_ptr, true);
         Introspection::register_heap_object(this_ptr, size, introspection_helper);
     } else {
-        registry.instances[key] = InstanceInfo(size, kind, subject_ptr, false);
+        shard.instances[key] = InstanceInfo(size, kind, subject_ptr, false);
     }
 }
 
 /* static */
 void ObjectInstanceRegistry::unregister_instance(void *this_ptr) {
     ObjectInstanceRegistry &registry = get_registry();
-    std::lock_guard<std::mutex> lock(registry.mutex);
     uintptr_t key = (uintptr_t)this_ptr;
-    std::map<uintptr_t, InstanceInfo>::iterator it = registry.instances.find(key);
-    internal_assert(it != registry.instances.end());
+    Shard &shard = registry.shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    std::map<uintptr_t, InstanceInfo>::iterator it = shard.instances.find(key);
+    internal_assert(it != shard.instances.end());
     if (it->second.registered_for_introspection) {
         Introspection::deregister_heap_object(this_ptr, it->second.size);
     }
-    registry.instances.erase(it);
+    shard.instances.erase(it);
 }
 
 /* static */
@@ -45,22 +49,40 @@ std::vector<void *> ObjectInstanceRegistry::instances_in_range(void *start, size
     std::vector<void *> results;
 
     ObjectInstanceRegistry &registry = get_registry();
-    std::lock_guard<std::mutex> lock(registry.mutex);
-
-    std::map<uintptr_t, InstanceInfo>::const_iterator it =
-        registry.instances.lower_bound((uintptr_t)start);
 
+    // Every address in one region maps to the same shard, so walk the
+    // range region by region, locking only the shard that owns the
+    // region the cursor is in.
+    uintptr_t cursor = (uintptr_t)start;
     uintptr_t limit_ptr = ((uintptr_t)start) + size;
-    while (it != registry.instances.end() && it->first < limit_ptr) {
-        if (it->second.kind == kind) {
-            results.push_back(it->second.subject_ptr);
-        }
+    while (cursor < limit_ptr) {
+        uintptr_t region_end = ((cursor >> region_bits) + 1) << region_bits;
+        uintptr_t scan_end = std::min(region_end, limit_ptr);
+
+        Shard &shard = registry.shard_for(cursor);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        std::map<uintptr_t, InstanceInfo>::const_iterator it =
+            shard.instances.lower_bound(cursor);
+
+        cursor = scan_end;
+        while (it != shard.instances.end() && it->first < scan_end) {
+            if (it->second.kind == kind) {
+                results.push_back(it->second.subject_ptr);
+            }
 
-        if (it->first > (uintptr_t)start && it->second.size != 0) {
-            // Skip over containers that we enclose
-            it = registry.instances.lower_bound(it->first + it->second.size);
-        } else {
-            it++;
+            if (it->first > (uintptr_t)start && it->second.size != 0) {
+                // Skip over containers that we enclose. The skip may
+                // reach past this region, in which case resume there.
+                uintptr_t skip_to = it->first + it->second.size;
+                if (skip_to >= scan_end) {
+                    cursor = std::max(cursor, skip_to);
+                    break;
+                }
+                it = shard.instances.lower_bound(skip_to);
+            } else {
+                it++;
+            }
         }
     }
 
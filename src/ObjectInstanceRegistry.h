@@ -79,8 +79,24 @@ private:
             : subject_ptr(subject_ptr), size(size), kind(kind), registered_for_introspection(registered_for_introspection) {}
     };
 
-    std::mutex mutex;
-    std::map<uintptr_t, InstanceInfo> instances;
+    // The registry is sharded by address region so that threads
+    // building pipelines concurrently (whose objects live on
+    // different stacks or in different heap arenas) don't contend on
+    // a single lock in every Param/Generator constructor. All
+    // addresses within one region map to the same shard, so the
+    // ordered range scan in instances_in_range can walk a range
+    // region by region.
+    static const int num_shards = 64;
+    static const int region_bits = 12;  // 4KB regions
+    struct Shard {
+        std::mutex mutex;
+        std::map<uintptr_t, InstanceInfo> instances;
+    };
+    Shard shards[num_shards];
+
+    Shard &shard_for(uintptr_t addr) {
+        return shards[(addr >> region_bits) & (num_shards - 1)];
+    }
 
     ObjectInstanceRegistry() {}
     ObjectInstanceRegistry(ObjectInstanceRegistry &rhs);  // unimplemented
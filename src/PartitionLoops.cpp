@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <numeric>
 
+#include "Bounds.h"
 #include "CSE.h"
 #include "CodeGen_GPU_Dev.h"
 #include "ExprUsesVar.h"
@@ -441,12 +442,20 @@ class PartitionLoops : public IRMutator2 {
 
     bool in_gpu_loop = false;
 
+    // The ranges of the loops we're inside, used to relax partition
+    // points that would otherwise depend on an enclosing loop
+    // variable.
+    Scope<Interval> loop_bounds;
+
     Stmt visit(const For *op) override {
         Stmt body = op->body;
 
         ScopedValue<bool> old_in_gpu_loop(in_gpu_loop, in_gpu_loop ||
                                              CodeGen_GPU_Dev::is_gpu_var(op->name));
 
+        ScopedBinding<Interval> bind_loop_bounds(
+            loop_bounds, op->name, Interval(op->min, op->min + op->extent - 1));
+
         // If we're inside GPU kernel, and the body contains thread
         // barriers or warp shuffles, it's not safe to duplicate code.
         if (in_gpu_loop && contains_warp_synchronous_logic(op)) {
@@ -482,6 +491,34 @@ class PartitionLoops : public IRMutator2 {
                 s.tight &= equal(outer.min, s.interval.min) && equal(outer.max, s.interval.max);
             }
 
+            // If an endpoint of the interval depends on the variable
+            // of an enclosing loop, the steady state would be
+            // different on every iteration of that loop, and the
+            // partition points would have to be recomputed each time
+            // around it. Relax the endpoint over the enclosing loop's
+            // range instead, so that nested partitioned loops share a
+            // single rectangular interior core. The boundary strips
+            // grow to the worst case over the enclosing loop, but
+            // they run the unsimplified body (relaxing drops
+            // tightness, so no reverse simplifications are applied to
+            // them), so this is safe.
+            if (s.interval.has_lower_bound() &&
+                expr_uses_vars(s.interval.min, loop_bounds)) {
+                Interval b = bounds_of_expr_in_scope(s.interval.min, loop_bounds);
+                if (b.has_upper_bound() && !expr_uses_vars(b.max, loop_bounds)) {
+                    s.interval.min = simplify(b.max);
+                    s.tight = false;
+                }
+            }
+            if (s.interval.has_upper_bound() &&
+                expr_uses_vars(s.interval.max, loop_bounds)) {
+                Interval b = bounds_of_expr_in_scope(s.interval.max, loop_bounds);
+                if (b.has_lower_bound() && !expr_uses_vars(b.min, loop_bounds)) {
+                    s.interval.max = simplify(b.min);
+                    s.tight = false;
+                }
+            }
+
             debug(3) << "\nSimplification: \n"
                      << "  condition: " << s.condition << "\n"
                      << "  old: " << s.old_expr << "\n"
@@ -880,6 +917,85 @@ class RenormalizeGPULoops : public IRMutator2 {
 };
 
 
+// Partitioning an inner loop defines its partition points in lets
+// just around the pieces of the partitioned loop, inside any
+// enclosing loops. This visitor lifts those lets out of an enclosing
+// loop when their values don't depend on it, so that the interior
+// core's bounds are computed once instead of on every iteration.
+class LiftInvariantPartitionPoints : public IRMutator2 {
+    using IRMutator2::visit;
+
+    const string &loop_var;
+
+    // Variables bound between the enclosing loop and the let being
+    // considered. Lets that use them can't be lifted.
+    Scope<> inner_vars;
+
+    bool is_partition_point_let(const string &name) {
+        return name.find(".prologue") != string::npos ||
+               name.find(".epilogue") != string::npos;
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        if (is_partition_point_let(op->name) &&
+            !expr_uses_var(op->value, loop_var) &&
+            !expr_uses_vars(op->value, inner_vars) &&
+            !expr_contains_load(op->value)) {
+            lifted.push_back({op->name, op->value});
+            return mutate(op->body);
+        }
+        ScopedBinding<> bind(inner_vars, op->name);
+        return IRMutator2::visit(op);
+    }
+
+    Stmt visit(const For *op) override {
+        ScopedBinding<> bind(inner_vars, op->name);
+        return IRMutator2::visit(op);
+    }
+
+public:
+    vector<pair<string, Expr>> lifted;
+
+    LiftInvariantPartitionPoints(const string &v) : loop_var(v) {}
+};
+
+class HoistPartitionPoints : public IRMutator2 {
+    using IRMutator2::visit;
+
+    bool in_gpu_loop = false;
+
+    Stmt visit(const For *op) override {
+        ScopedValue<bool> old_in_gpu_loop(in_gpu_loop, in_gpu_loop ||
+                                             CodeGen_GPU_Dev::is_gpu_var(op->name));
+        if (in_gpu_loop) {
+            // RenormalizeGPULoops has already put lets inside GPU
+            // kernels where they need to be.
+            return IRMutator2::visit(op);
+        }
+
+        Stmt body = mutate(op->body);
+
+        LiftInvariantPartitionPoints lifter(op->name);
+        body = lifter.mutate(body);
+
+        if (lifter.lifted.empty()) {
+            if (body.same_as(op->body)) {
+                return op;
+            }
+            return For::make(op->name, op->min, op->extent, op->for_type,
+                             op->device_api, body);
+        }
+
+        Stmt stmt = For::make(op->name, op->min, op->extent, op->for_type,
+                              op->device_api, body);
+        for (size_t i = lifter.lifted.size(); i > 0; i--) {
+            stmt = LetStmt::make(lifter.lifted[i-1].first,
+                                 lifter.lifted[i-1].second, stmt);
+        }
+        return stmt;
+    }
+};
+
 // Expand selects of boolean conditions so that the partitioner can
 // consider them one-at-a-time.
 class ExpandSelects : public IRMutator2 {
@@ -994,6 +1110,7 @@ Stmt partition_loops(Stmt s) {
     s = ExpandSelects().mutate(s);
     s = PartitionLoops().mutate(s);
     s = RenormalizeGPULoops().mutate(s);
+    s = HoistPartitionPoints().mutate(s);
     s = RemoveLikelyTags().mutate(s);
     s = CollapseSelects().mutate(s);
     return s;
@@ -0,0 +1,196 @@
+#include "PerformanceLint.h"
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Innermost serial loops with fewer iterations than this are assumed
+// to be deliberately small (tail loops, small stencils) and aren't
+// worth a vectorization warning.
+const int64_t min_vectorizable_extent = 8;
+
+// Parallel loops with a constant extent below this probably don't
+// make enough tasks to fill a machine.
+const int64_t min_parallel_extent = 8;
+
+// Allocations at the root of the pipeline larger than this are
+// unlikely to stay in cache between being produced and consumed.
+const int64_t large_root_allocation_bytes = 4 << 20;
+
+// Loop names look like "f.s0.x" or "f.s0.x.xi"; pull out the Func and
+// the variable for use in a suggested directive.
+string func_of_loop(const string &loop) {
+    return split_string(loop, ".")[0];
+}
+
+string var_of_loop(const string &loop) {
+    vector<string> tokens = split_string(loop, ".");
+    return tokens[tokens.size() - 1];
+}
+
+class PerformanceLint : public IRVisitor {
+public:
+    PerformanceLint(const Target &t) : target(t) {}
+
+    vector<string> findings;
+
+private:
+    using IRVisitor::visit;
+
+    const Target &target;
+
+    int loop_depth = 0;
+
+    // Set while visiting a loop body if it contains a nested loop (so
+    // the loop being visited is not innermost), any vector
+    // operations, or any stores.
+    bool body_has_loop = false;
+    bool body_has_vector_op = false;
+    bool body_has_store = false;
+
+    // The innermost enclosing loop, for naming strided loads.
+    vector<const For *> loops;
+
+    // Report each distinct finding once.
+    set<string> reported;
+
+    void report(const string &msg) {
+        if (reported.insert(msg).second) {
+            findings.push_back(msg);
+        }
+    }
+
+    void visit(const For *op) override {
+        if (op->is_parallel()) {
+            const int64_t *extent = as_const_int(op->extent);
+            if (extent && *extent < min_parallel_extent) {
+                std::ostringstream msg;
+                msg << "parallel loop " << op->name << " has constant extent "
+                    << *extent << ", which may not make enough tasks to fill a "
+                    << "machine. Consider moving .parallel() to an outer "
+                    << "variable of " << func_of_loop(op->name)
+                    << ", or fusing more loops into it first with .fuse().";
+                report(msg.str());
+            }
+        }
+
+        op->min.accept(this);
+        op->extent.accept(this);
+
+        bool old_has_loop = body_has_loop;
+        bool old_has_vector_op = body_has_vector_op;
+        bool old_has_store = body_has_store;
+        body_has_loop = false;
+        body_has_vector_op = false;
+        body_has_store = false;
+        loop_depth++;
+        loops.push_back(op);
+
+        op->body.accept(this);
+
+        loops.pop_back();
+        loop_depth--;
+
+        if (op->for_type == ForType::Serial &&
+            !body_has_loop &&
+            !body_has_vector_op &&
+            body_has_store) {
+            const int64_t *extent = as_const_int(op->extent);
+            if (!extent || *extent >= min_vectorizable_extent) {
+                std::ostringstream msg;
+                msg << "innermost loop " << op->name << " does only scalar "
+                    << "work. Consider vectorizing it, e.g. "
+                    << func_of_loop(op->name) << ".vectorize("
+                    << var_of_loop(op->name) << ", "
+                    << target.natural_vector_size<float>()
+                    << ") (possibly after a split to guarantee the extent "
+                    << "divides).";
+                report(msg.str());
+            }
+        }
+
+        body_has_loop = true;
+        body_has_vector_op = old_has_vector_op;
+        body_has_store = old_has_store;
+        (void)old_has_loop;
+    }
+
+    void visit(const Ramp *op) override {
+        body_has_vector_op = true;
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Broadcast *op) override {
+        body_has_vector_op = true;
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Load *op) override {
+        if (op->type.is_vector()) {
+            body_has_vector_op = true;
+            const Ramp *ramp = op->index.as<Ramp>();
+            const int64_t *stride = ramp ? as_const_int(ramp->stride) : nullptr;
+            if (stride && *stride != 1 && !loops.empty()) {
+                std::ostringstream msg;
+                msg << "vector load of " << op->name << " in loop "
+                    << loops.back()->name << " has stride " << *stride
+                    << "; dense (stride 1) loads are much cheaper. Consider "
+                    << "reordering loops or storage (.reorder() / "
+                    << ".reorder_storage()) so the vectorized dimension is "
+                    << "innermost in memory.";
+                report(msg.str());
+            }
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Store *op) override {
+        body_has_store = true;
+        if (op->value.type().is_vector()) {
+            body_has_vector_op = true;
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Allocate *op) override {
+        int64_t bytes = op->constant_allocation_size_64() * op->type.bytes();
+        if (loop_depth == 0 && bytes >= large_root_allocation_bytes) {
+            std::ostringstream msg;
+            msg << "Func " << op->name << " is allocated at the root of the "
+                << "pipeline (" << bytes << " bytes), so the whole thing is "
+                << "written before any of it is consumed. If its consumer "
+                << "follows soon after, consider computing it in tiles with "
+                << func_of_loop(op->name)
+                << ".compute_at() to keep the working set in cache.";
+            report(msg.str());
+        }
+        IRVisitor::visit(op);
+    }
+};
+
+}  // namespace
+
+void performance_lint(const Stmt &s, const Target &t) {
+    PerformanceLint lint(t);
+    s.accept(&lint);
+    for (const string &f : lint.findings) {
+        user_warning << "Performance lint: " << f << "\n";
+    }
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,30 @@
+#ifndef HALIDE_PERFORMANCE_LINT_H
+#define HALIDE_PERFORMANCE_LINT_H
+
+/** \file
+ * Defines an opt-in analysis that inspects the lowered Stmt for
+ * common scheduling mistakes and prints actionable warnings.
+ */
+
+#include "IR.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Walk a lowered pipeline looking for scheduling problems that are
+ * visible in the Stmt but usually only discovered in production
+ * profiles: innermost loops doing scalar work that could be
+ * vectorized, parallel loops with too few iterations to fill a
+ * machine, large intermediates allocated at the root of the pipeline,
+ * and strided vector loads in innermost loops. Each finding is
+ * printed once via user_warning with the loop or Func it concerns and
+ * the scheduling directive to consider. Enabled by setting the
+ * environment variable HL_PERF_LINT to a non-empty value; the
+ * analysis never changes the Stmt. */
+void performance_lint(const Stmt &s, const Target &t);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
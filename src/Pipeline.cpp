@@ -13,11 +13,16 @@
 #include "Pipeline.h"
 #include "PrintLoopNest.h"
 #include "RealizationOrder.h"
+#include "ScheduleSerialization.h"
+#include "ThreadPool.h"
+
+#include <fstream>
 
 using namespace Halide::Internal;
 
 namespace Halide {
 
+using std::map;
 using std::set;
 using std::string;
 using std::vector;
@@ -47,8 +52,15 @@ Outputs static_library_outputs(const string &filename_prefix, const Target &targ
 struct PipelineContents {
     mutable RefCount ref_count;
 
-    // Cached lowered stmt
-    Module module;
+    // Cache of lowered Modules, keyed by everything that affects
+    // lowering (target, function name, argument signature, linkage),
+    // so that emitting several outputs for one function (e.g. a
+    // header and an object) or jitting after an AOT compile only
+    // lowers once. Modules are cheap shared handles, and anything
+    // that changes the lowered result without changing the key
+    // (rescheduling, adding custom lowering passes) goes through
+    // invalidate_cache, so entries never go stale.
+    map<string, Module> module_cache;
 
     // Name of the generated function
     string name;
@@ -59,7 +71,7 @@ struct PipelineContents {
 
     /** Clear all cached state */
     void invalidate_cache() {
-        module = Module("", Target());
+        module_cache.clear();
         jit_module = JITModule();
         jit_target = Target();
         inferred_args.clear();
@@ -81,6 +93,11 @@ struct PipelineContents {
     /** A set of custom passes to use when lowering this Func. */
     vector<CustomLoweringPass> custom_lowering_passes;
 
+    /** Requirements registered via add_requirement, stored as
+     * AssertStmts. Checked at pipeline entry and assumed to hold
+     * during lowering. */
+    vector<Stmt> requirements;
+
     /** The inferred arguments. Also the arguments to the main
      * function in the jit_module above. The two must be updated
      * together. */
@@ -158,6 +175,37 @@ string Pipeline::auto_schedule(const Target &target, const MachineParams &arch_p
     return generate_schedules(contents->outputs, target, arch_params);
 }
 
+void Pipeline::save_schedule(const string &filename) {
+    // Compute an environment
+    std::map<string, Function> env;
+    for (Function f : contents->outputs) {
+        std::map<string, Function> more_funcs = find_transitive_calls(f);
+        env.insert(more_funcs.begin(), more_funcs.end());
+    }
+
+    std::ofstream file(filename);
+    user_assert(file.good()) << "Could not open " << filename << " for writing.\n";
+    serialize_schedule(env, file);
+    user_assert(file.good()) << "Failed to write schedule to " << filename << "\n";
+}
+
+void Pipeline::apply_schedule(const string &filename) {
+    // Compute an environment
+    std::map<string, Function> env;
+    for (Function f : contents->outputs) {
+        std::map<string, Function> more_funcs = find_transitive_calls(f);
+        env.insert(more_funcs.begin(), more_funcs.end());
+    }
+
+    std::ifstream file(filename);
+    user_assert(file.good()) << "Could not open schedule file " << filename << "\n";
+    apply_serialized_schedule(env, file);
+
+    // The previously-compiled pipeline (if any) no longer reflects
+    // the schedule.
+    invalidate_cache();
+}
+
 Func Pipeline::get_func(size_t index) {
     // Compute an environment
     std::map<string, Function> env;
@@ -353,40 +401,37 @@ Module Pipeline::compile_to_module(const vector<Argument> &args,
         lowering_args.insert(lowering_args.begin(), contents->user_context_arg.arg);
     }
 
-    const Module &old_module = contents->module;
-
-    bool same_compile = !old_module.functions().empty() && old_module.target() == target;
-    // Either generated name or one of the LoweredFuncs in the existing module has the same name.
-    same_compile = same_compile && fn_name.empty();
-    bool found_name = false;
-    for (const auto &lf : old_module.functions()) {
-        if (lf.name == fn_name) {
-            found_name = true;
-            break;
-        }
+    // Lowering is a pure function of the target, the function name,
+    // the argument signature, and the linkage (the outputs of a
+    // Pipeline cannot change, and anything else that affects the
+    // result goes through invalidate_cache), so those form the cache
+    // key. This means that e.g. emitting a header and then an object
+    // for the same function, or jitting after an AOT compile for the
+    // same target, only lowers once.
+    std::ostringstream key_stream;
+    key_stream << target.to_string() << "/" << new_fn_name << "/" << (int) linkage_type;
+    for (const Argument &a : lowering_args) {
+        key_stream << "/" << a.name << ":" << (int) a.kind << ":" << a.dimensions << ":" << a.type;
     }
-    same_compile = same_compile && found_name;
-    // Number of args + number of outputs is the same as total args in existing LoweredFunc
-    same_compile = same_compile && (lowering_args.size() + outputs().size()) == old_module.functions().front().args.size();
-    // The initial args are the same.
-    same_compile = same_compile && std::equal(lowering_args.begin(), lowering_args.end(), old_module.functions().front().args.begin());
-    // Linkage is the same.
-    same_compile = same_compile && old_module.functions().front().linkage == linkage_type;
-    // The outputs of a Pipeline cannot change, so no need to test them.
+    const string key = key_stream.str();
 
-    if (same_compile) {
+    auto cached = contents->module_cache.find(key);
+    if (cached != contents->module_cache.end()) {
         // We can avoid relowering and just reuse the existing module.
-        debug(2) << "Reusing old module\n";
-    } else {
-        vector<IRMutator2 *> custom_passes;
-        for (CustomLoweringPass p : contents->custom_lowering_passes) {
-            custom_passes.push_back(p.pass);
-        }
+        debug(2) << "Reusing old module for " << new_fn_name << "\n";
+        return cached->second;
+    }
 
-        contents->module = lower(contents->outputs, new_fn_name, target, lowering_args, linkage_type, custom_passes);
+    vector<IRMutator2 *> custom_passes;
+    for (CustomLoweringPass p : contents->custom_lowering_passes) {
+        custom_passes.push_back(p.pass);
     }
 
-    return contents->module;
+    Module module = lower(contents->outputs, new_fn_name, target, lowering_args, linkage_type,
+                          custom_passes, contents->requirements);
+    contents->module_cache.emplace(key, module);
+
+    return module;
 }
 
 std::string Pipeline::generate_function_name() const {
@@ -417,9 +462,11 @@ void *Pipeline::compile_jit(const Target &target_arg) {
         debug(2) << "Reusing old jit module compiled for :\n" << contents->jit_target << "\n";
         return contents->jit_module.main_function();
     }
-    // Clear all cached info in case there is an error.
-    contents->invalidate_cache();
-
+    // Clear the cached jit state in case there is an error. The
+    // lowered-module cache is left alone: it is keyed by everything
+    // that affects lowering, so entries for other targets (e.g. an
+    // earlier AOT compile) remain valid and reusable.
+    contents->jit_module = JITModule();
     contents->jit_target = target;
 
     // Infer an arguments vector
@@ -463,6 +510,67 @@ void *Pipeline::compile_jit(const Target &target_arg) {
     return jit_module.main_function();
 }
 
+void Pipeline::warmup(const Target &target_arg) {
+    user_assert(defined()) << "Pipeline is undefined\n";
+
+    Target target = target_arg;
+    if (target.os == Target::OSUnknown) {
+        if (contents->jit_module.compiled()) {
+            target = contents->jit_target;
+        } else {
+            target = get_jit_target_from_environment();
+        }
+    }
+
+    compile_jit(target);
+
+    // Spin up the worker threads the parallel runtime will use.
+    JITModule::Symbol startup =
+        contents->jit_module.find_symbol_by_name("halide_thread_pool_startup");
+    if (startup.address) {
+        ((void (*)())startup.address)();
+    }
+
+    // Force any device runtimes the pipeline uses to create their
+    // contexts and load their modules. The interface getters and the
+    // warmup entry point all live in the jitted runtime.
+    struct {
+        Target::Feature feature;
+        const char *interface_getter;
+    } device_apis[] = {
+        {Target::OpenCL, "halide_opencl_device_interface"},
+        {Target::Metal, "halide_metal_device_interface"},
+        {Target::CUDA, "halide_cuda_device_interface"},
+        {Target::OpenGL, "halide_opengl_device_interface"},
+        {Target::OpenGLCompute, "halide_openglcompute_device_interface"},
+        {Target::HVX_64, "halide_hexagon_device_interface"},
+        {Target::HVX_128, "halide_hexagon_device_interface"},
+    };
+    JITModule::Symbol device_warmup =
+        contents->jit_module.find_symbol_by_name("halide_device_warmup");
+    if (!device_warmup.address) {
+        return;
+    }
+    const struct halide_device_interface_t *warmed_up = nullptr;
+    for (const auto &api : device_apis) {
+        if (!target.has_feature(api.feature)) {
+            continue;
+        }
+        JITModule::Symbol getter =
+            contents->jit_module.find_symbol_by_name(api.interface_getter);
+        if (!getter.address) {
+            continue;
+        }
+        const struct halide_device_interface_t *interface =
+            ((const struct halide_device_interface_t *(*)())getter.address)();
+        if (interface && interface != warmed_up) {
+            ((int (*)(void *, const struct halide_device_interface_t *))device_warmup.address)(
+                nullptr, interface);
+            warmed_up = interface;
+        }
+    }
+}
+
 
 void Pipeline::set_error_handler(void (*handler)(void *, const char *)) {
     user_assert(defined()) << "Pipeline is undefined\n";
@@ -524,6 +632,46 @@ const vector<CustomLoweringPass> &Pipeline::custom_lowering_passes() {
     return contents->custom_lowering_passes;
 }
 
+void Pipeline::add_requirement(Expr condition, std::vector<Expr> &error_args) {
+    user_assert(defined()) << "Pipeline is undefined\n";
+    user_assert(condition.defined()) << "Requirement of undefined condition\n";
+    user_assert(condition.type().is_bool()) << "Requirement condition must be a boolean type\n";
+
+    // Requirements are checked once at pipeline entry, so they may
+    // only refer to things that exist there: parameters, not Funcs
+    // or loop variables.
+    class Checker : public IRGraphVisitor {
+        using IRGraphVisitor::visit;
+
+        void visit(const Variable *op) override {
+            if (!op->param.defined() && !op->image.defined()) {
+                user_error << "Requirement " << condition
+                           << " refers to Var or RVar " << op->name << "\n";
+            }
+        }
+
+        void visit(const Call *op) override {
+            if (op->call_type == Call::Halide) {
+                user_error << "Requirement " << condition
+                           << " calls Func " << op->name << "\n";
+            }
+            IRGraphVisitor::visit(op);
+        }
+
+        const Expr &condition;
+
+    public:
+        Checker(const Expr &c) : condition(c) {
+            c.accept(this);
+        }
+    } checker(condition);
+
+    Expr error = Internal::requirement_failed_error(condition, error_args);
+
+    contents->invalidate_cache();
+    contents->requirements.push_back(AssertStmt::make(std::move(condition), std::move(error)));
+}
+
 const JITHandlers &Pipeline::jit_handlers() {
     user_assert(defined()) << "Pipeline is undefined\n";
     return contents->jit_handlers;
@@ -949,6 +1097,533 @@ void Pipeline::realize(RealizationArg outputs, const Target &t,
     jit_context.finalize(exit_status);
 }
 
+Pipeline::CallPlan Pipeline::make_call_plan(RealizationArg outputs, const Target &t,
+                                            const ParamMap &param_map) {
+    user_assert(defined()) << "Can't make a call plan for an undefined Pipeline\n";
+
+    // The same output validation realize() does, hoisted out of the
+    // per-call path.
+    if (outputs.r) {
+        for (size_t i = 0; i < outputs.r->size(); i++) {
+            user_assert((*outputs.r)[i].data() != nullptr)
+                << "Buffer at " << &((*outputs.r)[i]) << " is unallocated. "
+                << "The Buffers in a Realization passed to make_call_plan must all be allocated\n";
+        }
+    } else if (outputs.buffer_list) {
+        for (const Buffer<> &buf : *outputs.buffer_list) {
+            user_assert(buf.data() != nullptr)
+                << "Buffer at " << &buf << " is unallocated. "
+                << "The Buffers passed to make_call_plan must all be allocated\n";
+        }
+    } else {
+        user_assert(outputs.buf && (outputs.buf->host || outputs.buf->device))
+            << "Buffer at " << (void *)outputs.buf << " is unallocated. "
+            << "The Buffers passed to make_call_plan must all be allocated\n";
+    }
+
+    Target target = t;
+    if (target.os == Target::OSUnknown) {
+        if (contents->jit_module.compiled()) {
+            target = contents->jit_target;
+        } else {
+            target = get_jit_target_from_environment();
+        }
+    }
+
+    compile_jit(target);
+
+    const bool no_param_map = &param_map == &ParamMap::empty_map();
+
+    CallPlan plan;
+    plan.pipeline_contents = contents;
+    plan.jit_module = contents->jit_module;
+    plan.target = target;
+    plan.argv.resize(contents->inferred_args.size() + outputs.size(), nullptr);
+
+    size_t arg_index = 0;
+    for (const InferredArgument &arg : contents->inferred_args) {
+        if (arg.param.defined()) {
+            if (arg.param.same_as(contents->user_context_arg.param)) {
+                // The user context belongs to each individual call;
+                // this slot is patched in realize(CallPlan &).
+                plan.user_context_slot = arg_index++;
+            } else {
+                Buffer<> *buf_out_param = nullptr;
+                const Parameter &p = no_param_map ? arg.param : param_map.map(arg.param, buf_out_param);
+                user_assert(!buf_out_param)
+                    << "Cannot pass Buffer<> pointers in parameters map to a call plan.\n";
+                if (p.is_buffer()) {
+                    // The buffer bound to an ImageParam can change
+                    // between calls, so record the Parameter and
+                    // re-read it before each call.
+                    plan.buffer_param_slots.push_back({arg_index++, p});
+                } else {
+                    // The scalar value lives at a stable address
+                    // inside the Parameter, so later calls to set()
+                    // are picked up without repatching.
+                    plan.argv[arg_index++] = p.scalar_address();
+                }
+            }
+        } else {
+            internal_assert(arg.buffer.defined());
+            plan.argv[arg_index++] = arg.buffer.raw_buffer();
+        }
+    }
+
+    if (outputs.r) {
+        for (size_t i = 0; i < outputs.r->size(); i++) {
+            // Take shared handles so the halide_buffer_ts stay valid
+            // even if the caller's Realization goes away.
+            plan.outputs.push_back((*outputs.r)[i]);
+            plan.argv[arg_index++] = plan.outputs.back().raw_buffer();
+        }
+    } else if (outputs.buf) {
+        // A raw halide_buffer_t can't be kept alive from here; the
+        // caller retains ownership.
+        plan.argv[arg_index++] = outputs.buf;
+    } else {
+        for (const Buffer<> &buffer : *outputs.buffer_list) {
+            plan.outputs.push_back(buffer);
+            plan.argv[arg_index++] = plan.outputs.back().raw_buffer();
+        }
+    }
+    internal_assert(arg_index == plan.argv.size());
+
+    return plan;
+}
+
+void Pipeline::realize(CallPlan &plan) {
+    user_assert(defined()) << "Can't realize an undefined Pipeline\n";
+    user_assert(plan.defined()) << "Can't realize an undefined CallPlan\n";
+    user_assert(plan.pipeline_contents.same_as(contents))
+        << "The CallPlan passed to realize was made by a different Pipeline\n";
+
+    debug(2) << "Realizing Pipeline via call plan for " << plan.target << "\n";
+
+    JITFuncCallContext jit_context(jit_handlers());
+    void *user_context_storage = &jit_context.jit_context;
+    if (plan.user_context_slot != (size_t)-1) {
+        plan.argv[plan.user_context_slot] = &user_context_storage;
+    }
+
+    // Refresh the buffers bound to ImageParams; everything else in
+    // the argv array is stable across calls.
+    for (const CallPlan::BufferParamSlot &slot : plan.buffer_param_slots) {
+        Buffer<> buf = slot.param.buffer();
+        plan.argv[slot.index] = buf.defined() ? slot.param.raw_buffer() : nullptr;
+    }
+
+    debug(2) << "Calling jitted function\n";
+    int exit_status = plan.jit_module.argv_function()(&plan.argv[0]);
+    debug(2) << "Back from jitted function. Exit status was " << exit_status << "\n";
+
+    // If we're profiling, report runtimes and reset profiler stats.
+    if (plan.target.has_feature(Target::Profile)) {
+        JITModule::Symbol report_sym =
+            plan.jit_module.find_symbol_by_name("halide_profiler_report");
+        JITModule::Symbol reset_sym =
+            plan.jit_module.find_symbol_by_name("halide_profiler_reset");
+        if (report_sym.address && reset_sym.address) {
+            void *uc = &jit_context.jit_context;
+            void (*report_fn_ptr)(void *) = (void (*)(void *))(report_sym.address);
+            report_fn_ptr(uc);
+
+            void (*reset_fn_ptr)() = (void (*)())(reset_sym.address);
+            reset_fn_ptr();
+        }
+    }
+
+    jit_context.finalize(exit_status);
+}
+
+namespace {
+
+// The closure for the batch task below. Each task invocation runs one
+// batch item by calling the jitted argv function on that item's
+// prepared argument list.
+struct BatchRealizeClosure {
+    int (*argv_function)(const void **);
+    const void ***arg_stores;
+    int *exit_statuses;
+};
+
+int batch_realize_task(void *user_context, int idx, uint8_t *closure) {
+    BatchRealizeClosure *batch = (BatchRealizeClosure *)closure;
+    int exit_status = batch->argv_function(batch->arg_stores[idx]);
+    batch->exit_statuses[idx] = exit_status;
+    // A non-zero return asks the thread pool to stop issuing tasks.
+    return exit_status;
+}
+
+}  // namespace
+
+void Pipeline::realize_batch(vector<Realization> &outputs,
+                             const Target &t,
+                             const vector<ParamMap> &param_maps) {
+    Target target = t;
+    user_assert(defined()) << "Can't realize an undefined Pipeline\n";
+    user_assert(!outputs.empty()) << "realize_batch: the batch is empty\n";
+    user_assert(param_maps.empty() || param_maps.size() == outputs.size())
+        << "realize_batch: there are " << outputs.size() << " outputs but "
+        << param_maps.size() << " parameter maps\n";
+
+    for (const Realization &r : outputs) {
+        for (size_t i = 0; i < r.size(); i++) {
+            user_assert(r[i].data() != nullptr)
+                << "Buffer at " << &r[i] << " is unallocated. "
+                << "The Buffers in the Realizations passed to realize_batch must all be allocated\n";
+        }
+    }
+
+    if (target.os == Target::OSUnknown) {
+        if (contents->jit_module.compiled()) {
+            target = contents->jit_target;
+        } else {
+            target = get_jit_target_from_environment();
+        }
+    }
+
+    compile_jit(target);
+
+    // One context serves the whole batch: every item shares the same
+    // custom handlers, and the first error reported wins.
+    JITFuncCallContext jit_context(jit_handlers());
+    void *user_context_storage = &jit_context.jit_context;
+
+    // Marshal the arguments for every item up front, on this thread.
+    size_t batch_size = outputs.size();
+    vector<std::unique_ptr<JITCallArgs>> args(batch_size);
+    vector<const void **> arg_stores(batch_size);
+    vector<int> exit_statuses(batch_size, 0);
+    for (size_t i = 0; i < batch_size; i++) {
+        args[i].reset(new JITCallArgs(contents->inferred_args.size() + outputs[i].size()));
+        RealizationArg out(outputs[i]);
+        const ParamMap &param_map = param_maps.empty() ? ParamMap::empty_map() : param_maps[i];
+        prepare_jit_call_arguments(out, target, param_map,
+                                   &user_context_storage, false, *args[i]);
+        arg_stores[i] = args[i]->store;
+    }
+
+    BatchRealizeClosure batch = {
+        contents->jit_module.argv_function(),
+        arg_stores.data(),
+        exit_statuses.data()
+    };
+
+    // Run the batch as one task set on the pipeline's own thread
+    // pool, so the workers stay awake between items. Nested
+    // parallelism inside each item shares the same pool.
+    debug(2) << "Calling jitted function on a batch of " << batch_size << "\n";
+    int exit_status = 0;
+    JITModule::Symbol do_par_for_sym =
+        contents->jit_module.find_symbol_by_name("halide_do_par_for");
+    if (do_par_for_sym.address) {
+        halide_do_par_for_t do_par_for = (halide_do_par_for_t)do_par_for_sym.address;
+        exit_status = do_par_for(user_context_storage, batch_realize_task,
+                                 0, (int)batch_size, (uint8_t *)&batch);
+    } else {
+        // No thread pool in this runtime (e.g. no_threads targets).
+        for (size_t i = 0; i < batch_size && exit_status == 0; i++) {
+            exit_status = batch_realize_task(user_context_storage, (int)i, (uint8_t *)&batch);
+        }
+    }
+    for (size_t i = 0; i < batch_size && exit_status == 0; i++) {
+        exit_status = exit_statuses[i];
+    }
+    debug(2) << "Back from jitted function. Exit status was " << exit_status << "\n";
+
+    // If we're profiling, report runtimes and reset profiler stats.
+    if (target.has_feature(Target::Profile)) {
+        JITModule::Symbol report_sym =
+            contents->jit_module.find_symbol_by_name("halide_profiler_report");
+        JITModule::Symbol reset_sym =
+            contents->jit_module.find_symbol_by_name("halide_profiler_reset");
+        if (report_sym.address && reset_sym.address) {
+            void *uc = &jit_context.jit_context;
+            void (*report_fn_ptr)(void *) = (void (*)(void *))(report_sym.address);
+            report_fn_ptr(uc);
+
+            void (*reset_fn_ptr)() = (void (*)())(reset_sym.address);
+            reset_fn_ptr();
+        }
+    }
+
+    jit_context.finalize(exit_status);
+}
+
+void Pipeline::realize_streaming(Realization output,
+                                 const vector<int32_t> &tile_extents,
+                                 const Target &t,
+                                 const ParamMap &param_map) {
+    user_assert(defined()) << "Can't realize an undefined Pipeline\n";
+    user_assert(output.size() > 0) << "Realization must have at least one Buffer\n";
+
+    const Buffer<> &first = output[0];
+    user_assert((int)tile_extents.size() <= first.dimensions())
+        << "realize_streaming: more tile extents than output dimensions\n";
+    for (size_t i = 1; i < output.size(); i++) {
+        for (size_t d = 0; d < tile_extents.size(); d++) {
+            user_assert(tile_extents[d] == 0 ||
+                        (output[i].dim(d).min() == first.dim(d).min() &&
+                         output[i].dim(d).extent() == first.dim(d).extent()))
+                << "realize_streaming: all outputs must have the same shape "
+                << "in the tiled dimensions\n";
+        }
+    }
+
+    Target target = t;
+    if (target.os == Target::OSUnknown) {
+        if (contents->jit_module.compiled()) {
+            target = contents->jit_target;
+        } else {
+            target = get_jit_target_from_environment();
+        }
+    }
+
+    // Compile up front so the worker threads don't race to do it.
+    compile_jit(target);
+
+    // Enumerate the tile grid. Each job crops the outputs to one tile
+    // and realizes into the crop, so intermediate storage is bounded
+    // by what a single tile requires, and bounds inference only
+    // touches the corresponding input regions.
+    struct Tile {
+        vector<std::pair<int, int>> bounds;  // (min, extent) per tiled dim
+    };
+    vector<Tile> tiles(1);
+    for (size_t d = 0; d < tile_extents.size(); d++) {
+        int32_t tile = tile_extents[d];
+        if (tile <= 0) {
+            continue;
+        }
+        int32_t dim_min = first.dim((int)d).min();
+        int32_t dim_extent = first.dim((int)d).extent();
+        vector<Tile> next;
+        for (const Tile &partial : tiles) {
+            for (int32_t min = dim_min; min < dim_min + dim_extent; min += tile) {
+                int32_t extent = std::min(tile, dim_min + dim_extent - min);
+                Tile t2 = partial;
+                t2.bounds.push_back({min, extent});
+                next.push_back(t2);
+            }
+        }
+        tiles.swap(next);
+    }
+
+    // The dims that were actually tiled, in the order they appear in
+    // each Tile's bounds.
+    vector<int> tiled_dims;
+    for (size_t d = 0; d < tile_extents.size(); d++) {
+        if (tile_extents[d] > 0) {
+            tiled_dims.push_back((int)d);
+        }
+    }
+
+    ThreadPool<void> pool(std::min(tiles.size(), ThreadPool<void>::num_processors_online()));
+    vector<std::future<void>> jobs;
+    vector<std::exception_ptr> errors(tiles.size());
+
+    for (size_t i = 0; i < tiles.size(); i++) {
+        auto job = [this, target](Realization out, Tile tile,
+                                  vector<int> dims, ParamMap params,
+                                  std::exception_ptr *error) {
+            try {
+                vector<Buffer<>> cropped;
+                for (size_t j = 0; j < out.size(); j++) {
+                    // A non-owning view of the output that we can
+                    // crop without disturbing the shared buffer.
+                    Buffer<> view(*out[j].raw_buffer());
+                    for (size_t d = 0; d < dims.size(); d++) {
+                        view.crop(dims[d], tile.bounds[d].first, tile.bounds[d].second);
+                    }
+                    cropped.push_back(view);
+                }
+                Realization tile_output(cropped);
+                realize(tile_output, target, params);
+            } catch (...) {
+                *error = std::current_exception();
+            }
+        };
+        jobs.push_back(pool.async(job, output, tiles[i], tiled_dims, param_map, &errors[i]));
+    }
+
+    for (auto &j : jobs) {
+        j.wait();
+    }
+    for (const auto &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+void Pipeline::realize_distributed(Realization output, int dim,
+                                   const Target &t,
+                                   const ParamMap &param_map) {
+    user_assert(defined()) << "Can't realize an undefined Pipeline\n";
+    user_assert(output.size() > 0) << "Realization must have at least one Buffer\n";
+
+    const Buffer<> &first = output[0];
+    user_assert(dim >= 0 && dim < first.dimensions())
+        << "realize_distributed: dimension " << dim << " is out of range\n";
+    for (size_t i = 1; i < output.size(); i++) {
+        user_assert(output[i].dim(dim).min() == first.dim(dim).min() &&
+                    output[i].dim(dim).extent() == first.dim(dim).extent())
+            << "realize_distributed: all outputs must have the same extent "
+            << "in the distributed dimension\n";
+    }
+
+    Target target = t;
+    if (target.os == Target::OSUnknown) {
+        if (contents->jit_module.compiled()) {
+            target = contents->jit_target;
+        } else {
+            target = get_jit_target_from_environment();
+        }
+    }
+
+    compile_jit(target);
+
+    // Ask the runtime which slab of the output this process owns. The
+    // defaults describe a single-process world; an MPI program
+    // installs the real topology with halide_set_distributed_topology.
+    int rank = 0, num_ranks = 1;
+    JITModule::Symbol rank_sym =
+        contents->jit_module.find_symbol_by_name("halide_distributed_rank");
+    JITModule::Symbol size_sym =
+        contents->jit_module.find_symbol_by_name("halide_distributed_size");
+    if (rank_sym.address && size_sym.address) {
+        rank = ((int (*)())rank_sym.address)();
+        num_ranks = ((int (*)())size_sym.address)();
+    }
+    user_assert(num_ranks >= 1 && rank >= 0 && rank < num_ranks)
+        << "realize_distributed: bad topology: rank " << rank
+        << " of " << num_ranks << "\n";
+
+    // Partition the distributed dimension into even slabs; the first
+    // extent % num_ranks ranks get one extra element.
+    int dim_min = first.dim(dim).min();
+    int dim_extent = first.dim(dim).extent();
+    int slab = dim_extent / num_ranks;
+    int remainder = dim_extent % num_ranks;
+    int local_min = dim_min + rank * slab + std::min(rank, remainder);
+    int local_extent = slab + (rank < remainder ? 1 : 0);
+    if (local_extent == 0) {
+        // More ranks than elements; this rank owns nothing.
+        return;
+    }
+
+    // Non-owning views of the outputs, cropped to the local slab.
+    vector<Buffer<>> cropped;
+    for (size_t j = 0; j < output.size(); j++) {
+        Buffer<> view(*output[j].raw_buffer());
+        view.crop(dim, local_min, local_extent);
+        cropped.push_back(view);
+    }
+    Realization local(cropped);
+
+    // Run bounds inference on the local slab to learn the footprint
+    // this rank reads from each bound input, including any halo that
+    // reaches into slabs owned by other ranks. Metadata-only copies
+    // of the inputs stand in for them during the query, so the real
+    // buffers are not disturbed.
+    JITFuncCallContext jit_context(jit_handlers());
+    void *user_context_storage = &jit_context.jit_context;
+
+    RealizationArg query_outputs(local);
+    size_t args_size = contents->inferred_args.size() + query_outputs.size();
+    JITCallArgs args(args_size);
+    prepare_jit_call_arguments(query_outputs, target, param_map,
+                               &user_context_storage, true, args);
+
+    struct TrackedInput {
+        size_t index;             // position in args.store
+        halide_buffer_t *actual;  // the bound input buffer
+        // Metadata-only copies (null host puts them in bounds query
+        // mode), and a backup to check for convergence.
+        Runtime::Buffer<> query, orig;
+    };
+    vector<TrackedInput> tracked;
+    for (size_t i = 0; i < contents->inferred_args.size(); i++) {
+        const InferredArgument &ia = contents->inferred_args[i];
+        if (!ia.param.defined() || !ia.param.is_buffer()) {
+            continue;
+        }
+        user_assert(args.store[i] != nullptr)
+            << "realize_distributed: input ImageParam " << ia.param.name()
+            << " is unbound. All inputs must be bound so their footprints "
+            << "can be exchanged.\n";
+        TrackedInput tb;
+        tb.index = i;
+        tb.actual = (halide_buffer_t *)args.store[i];
+        tb.query = Runtime::Buffer<>(tb.actual->type, nullptr,
+                                     tb.actual->dimensions, tb.actual->dim);
+        tb.orig = tb.query;
+        tracked.push_back(tb);
+    }
+    for (TrackedInput &tb : tracked) {
+        args.store[tb.index] = tb.query.raw_buffer();
+    }
+
+    int exit_status = 0;
+    if (!tracked.empty()) {
+        int iter = 0;
+        const int max_iters = 16;
+        for (iter = 0; iter < max_iters; iter++) {
+            for (TrackedInput &tb : tracked) {
+                tb.orig = tb.query;
+            }
+            debug(2) << "Calling jitted function for a bounds query\n";
+            int query_status = contents->jit_module.argv_function()(args.store);
+            jit_context.report_if_error(query_status);
+            bool changed = false;
+            for (TrackedInput &tb : tracked) {
+                for (int d = 0; d < tb.query.dimensions(); d++) {
+                    if (tb.query.dim(d).min() != tb.orig.dim(d).min() ||
+                        tb.query.dim(d).extent() != tb.orig.dim(d).extent()) {
+                        changed = true;
+                    }
+                }
+            }
+            if (!changed) {
+                break;
+            }
+        }
+        user_assert(iter < max_iters)
+            << "Inferring input footprints in realize_distributed"
+            << " didn't converge after " << max_iters
+            << " iterations. There may be unsatisfiable constraints\n";
+
+        // Hand each input's footprint to the exchange hook so a
+        // user-installed handler can fetch ghost zones from the ranks
+        // that own them. The default hook just checks the region is
+        // already present.
+        JITModule::Symbol exchange_sym =
+            contents->jit_module.find_symbol_by_name("halide_distributed_exchange");
+        if (exchange_sym.address) {
+            halide_distributed_exchange_t exchange =
+                (halide_distributed_exchange_t)exchange_sym.address;
+            for (TrackedInput &tb : tracked) {
+                int dims = tb.query.dimensions();
+                vector<int> req_min(dims), req_extent(dims);
+                for (int d = 0; d < dims; d++) {
+                    req_min[d] = tb.query.dim(d).min();
+                    req_extent[d] = tb.query.dim(d).extent();
+                }
+                exit_status = exchange(user_context_storage, tb.actual,
+                                       req_min.data(), req_extent.data(), dims);
+                if (exit_status) {
+                    break;
+                }
+            }
+        }
+    }
+    jit_context.finalize(exit_status);
+
+    // The inputs now cover the local footprint; compute the slab.
+    realize(local, target, param_map);
+}
+
 void Pipeline::infer_input_bounds(RealizationArg outputs, const ParamMap &param_map) {
     Target target = get_jit_target_from_environment();
 
@@ -11,6 +11,7 @@
 
 #include "AutoSchedule.h"
 #include "ExternalCode.h"
+#include "IROperator.h"
 #include "IntrusivePtr.h"
 #include "JITModule.h"
 #include "Module.h"
@@ -122,6 +123,22 @@ public:
                               const MachineParams &arch_params = MachineParams::generic());
     //@}
 
+    /** Write the schedules of all Funcs in the pipeline to a text
+     * file, to be re-applied later with apply_schedule. Captures the
+     * directives stored in the schedule (splits, dimension ordering
+     * and loop types, storage order, compute/store levels); see
+     * Internal::serialize_schedule for the limitations. */
+    void save_schedule(const std::string &filename);
+
+    /** Apply a schedule written by save_schedule to this pipeline,
+     * replacing the existing scheduling directives of every Func the
+     * file mentions. The pipeline's Funcs and stages must match the
+     * pipeline the schedule was saved from. This allows a schedule to
+     * be swapped without rebuilding the pipeline: an autotuner can
+     * search schedules by re-lowering only, and production code can
+     * load a schedule file chosen per CPU model at startup. */
+    void apply_schedule(const std::string &filename);
+
     /** Return handle to the index-th Func within the pipeline based on the
      * topological order. */
     Func get_func(size_t index);
@@ -248,6 +265,16 @@ public:
      */
      void *compile_jit(const Target &target = get_jit_target_from_environment());
 
+    /** Perform every lazy initialization that would otherwise happen
+     * on the first call to realize, so that the first realization
+     * costs the same as the Nth. This jit-compiles the pipeline (see
+     * compile_jit), spawns the worker threads used by parallel
+     * loops, and creates the device contexts of any GPU APIs the
+     * target enables. The remaining first-call costs are the ones
+     * the caller owns: allocating output buffers and paging in input
+     * data. */
+    void warmup(const Target &target = get_jit_target_from_environment());
+
     /** Set the error handler function that be called in the case of
      * runtime errors during halide pipelines. If you are compiling
      * statically, you can also just define your own function with
@@ -384,6 +411,72 @@ public:
     /** Get the custom lowering passes. */
     const std::vector<CustomLoweringPass> &custom_lowering_passes();
 
+    /** Add a requirement: a boolean condition over the pipeline's
+     * scalar parameters that is checked once at pipeline entry, in
+     * the order added, before any computation runs. If the condition
+     * is false at runtime, the remaining args are stringified into an
+     * error message (as for require()) and the pipeline returns an
+     * error without computing anything.
+     *
+     * Unlike an unchecked bound() or set_bounds() promise, a
+     * requirement is safe: it is verified before it is exploited. The
+     * condition is assumed to hold during lowering, so the simplifier
+     * can use it to discharge proofs - e.g. requiring width % 64 == 0
+     * lets alignment and loop-partitioning logic drop tail cases.
+     *
+     * The condition may not refer to any Func or Var. */
+    // @{
+    void add_requirement(Expr condition, std::vector<Expr> &error_args);
+
+    template<typename ...Args>
+    inline HALIDE_NO_USER_CODE_INLINE void add_requirement(Expr condition, Args&&... args) {
+        std::vector<Expr> collected_args;
+        Internal::collect_print_args(collected_args, std::forward<Args>(args)...);
+        add_requirement(std::move(condition), collected_args);
+    }
+    // @}
+
+    /** A reusable, pre-validated argument list for calling a
+     * jit-compiled pipeline. See make_call_plan. */
+    class CallPlan {
+        Internal::IntrusivePtr<PipelineContents> pipeline_contents;
+
+        // The module the plan was compiled against. Holding a handle
+        // keeps the jitted code alive even if the pipeline is later
+        // recompiled.
+        Internal::JITModule jit_module;
+
+        Target target;
+
+        // The prepared argv array passed to the jitted function.
+        std::vector<const void *> argv;
+
+        // ImageParams can be rebound between calls, so these slots
+        // are re-read from their Parameter before each call.
+        struct BufferParamSlot {
+            size_t index;
+            Internal::Parameter param;
+        };
+        std::vector<BufferParamSlot> buffer_param_slots;
+
+        // The slot holding the user context, which belongs to each
+        // individual call.
+        size_t user_context_slot{(size_t)-1};
+
+        // Shared handles to the output buffers, so that their
+        // halide_buffer_ts stay valid for the life of the plan.
+        std::vector<Buffer<>> outputs;
+
+        friend class Pipeline;
+    public:
+        CallPlan() = default;
+
+        /** Check if this plan was produced by make_call_plan. */
+        bool defined() const {
+            return pipeline_contents.defined();
+        }
+    };
+
     /** See Func::realize */
     // @{
     Realization realize(std::vector<int32_t> sizes, const Target &target = Target(),
@@ -412,6 +505,85 @@ public:
     void realize(RealizationArg output, const Target &target = Target(),
                  const ParamMap &param_map = ParamMap::empty_map());
 
+    /** Build a reusable "call plan" for evaluating this Pipeline into
+     * the given buffers. realize() re-validates its arguments,
+     * resolves the ParamMap, and rebuilds the argv array on every
+     * call; when many small realizations are made at high frequency
+     * that marshalling can dominate the cost of the pipeline
+     * itself. make_call_plan does the validation, jit compilation,
+     * and ParamMap resolution once, and realize(plan) then just
+     * refreshes the few pointers that can change between calls before
+     * invoking the jitted code. Updates to scalar Params and
+     * rebinding of ImageParams between calls are picked up
+     * automatically. The plan keeps shared references to the output
+     * buffers (so it's fine for the caller's Realization to go away),
+     * except when made directly from a halide_buffer_t *, which the
+     * caller must keep alive. The plan is tied to the module it was
+     * compiled against: after rescheduling or anything else that
+     * invalidates the jit cache, make a new plan to pick up the
+     * changes. Like the RealizationArg form of realize, this does
+     * *not* automatically copy data back from the GPU. */
+    // @{
+    CallPlan make_call_plan(RealizationArg outputs, const Target &target = Target(),
+                            const ParamMap &param_map = ParamMap::empty_map());
+    void realize(CallPlan &plan);
+    // @}
+
+    /** Evaluate this Pipeline into an existing allocated buffer or
+     * buffers, computing the output one tile at a time with the tile
+     * loop spread across a thread pool. Intermediate storage is
+     * bounded by what one tile requires, so outputs much larger than
+     * RAM (e.g. backed by a memory-mapped file) can be realized with
+     * bounded memory: bounds inference ensures each tile only touches
+     * the corresponding regions of any ImageParams, so mmap-backed
+     * inputs are paged in a tile at a time. tile_extents gives the
+     * tile size in each output dimension, innermost first; pass 0 to
+     * leave a dimension untiled. Scheduled intermediates are
+     * recomputed where tiles overlap, just as if the output had been
+     * realized with an explicit crop() loop. Multi-output pipelines
+     * are supported if all outputs have the same shape in the tiled
+     * dimensions. Not supported for pipelines that update their
+     * outputs in-place across tiles. */
+    void realize_streaming(Realization output,
+                           const std::vector<int32_t> &tile_extents,
+                           const Target &target = Target(),
+                           const ParamMap &param_map = ParamMap::empty_map());
+
+    /** Evaluate this Pipeline once per entry of a batch, running the
+     * whole batch as a single parallel task set on the Halide thread
+     * pool. Compared to calling realize in a loop, this compiles and
+     * marshals arguments once, wakes the worker threads once, and
+     * keeps them busy across items, so it's much cheaper when each
+     * output is small. The batch index acts as an implicit outer
+     * parallel loop: items run concurrently, and any parallelism
+     * inside the pipeline shares the same thread pool. All output
+     * Realizations must be pre-allocated. If param_maps is non-empty
+     * it must have one entry per batch item, giving that item's
+     * parameter bindings; items may not write to shared state unless
+     * they synchronize. */
+    void realize_batch(std::vector<Realization> &outputs,
+                       const Target &target = Target(),
+                       const std::vector<ParamMap> &param_maps = std::vector<ParamMap>());
+
+    /** Evaluate this process's share of a realization that is split
+     * across cooperating processes (e.g. MPI ranks). The given output
+     * dimension is partitioned evenly across
+     * halide_distributed_size() ranks and only the slab owned by
+     * halide_distributed_rank() is computed; the output buffers
+     * describe the global grid and must at least cover the local
+     * slab. Before computing, bounds inference determines the
+     * footprint of every bound input buffer (including any halo
+     * reaching into neighbouring slabs) and passes it to the
+     * halide_distributed_exchange hook, so a user-installed handler
+     * can fetch ghost zones from the ranks that own them. With the
+     * default single-process topology this is equivalent to realize,
+     * plus a check that the inputs cover the required footprints. All
+     * outputs must share the same extent in the distributed
+     * dimension. */
+    void realize_distributed(Realization output, int dim,
+                             const Target &target = Target(),
+                             const ParamMap &param_map = ParamMap::empty_map());
+
     /** For a given size of output, or a given set of output buffers,
      * determine the bounds required of all unbound ImageParams
      * referenced. Communicates the result by allocating new buffers
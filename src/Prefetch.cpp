@@ -60,14 +60,49 @@ public:
     }
 };
 
+// Does the stmt contain a serial For whose name starts with the given
+// prefix? Used to find the innermost serial loop of a stage.
+class ContainsSerialLoopWithPrefix : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const For *op) {
+        if ((op->for_type == ForType::Serial) && starts_with(op->name, prefix)) {
+            result = true;
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    string prefix;
+    bool result = false;
+};
+
+// Collect the Funcs and input images loaded from in a stmt.
+class CollectReads : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Call *op) {
+        IRVisitor::visit(op);
+        if (op->call_type == Call::Halide || op->call_type == Call::Image) {
+            reads.emplace(op->name, op->param);
+        }
+    }
+
+public:
+    map<string, Parameter> reads;
+};
+
 class InjectPrefetch : public IRMutator2 {
 public:
-    InjectPrefetch(const map<string, Function> &e, const map<string, Box> &buffers)
-        : env(e), external_buffers(buffers), current_func(nullptr), stage(-1) { }
+    InjectPrefetch(const map<string, Function> &e, const map<string, Box> &buffers,
+                   const Target &t)
+        : env(e), external_buffers(buffers), target(t),
+          current_func(nullptr), stage(-1) { }
 
 private:
     const map<string, Function> &env;
     const map<string, Box> &external_buffers;
+    Target target;
     const Function *current_func;
     int stage;
     Scope<Box> buffer_bounds;
@@ -156,7 +191,51 @@ private:
         const Function *old_func = current_func;
         int old_stage = stage;
 
-        const vector<PrefetchDirective> &prefetch_list = get_prefetch_list(op->name);
+        vector<PrefetchDirective> prefetch_list = get_prefetch_list(op->name);
+
+        // Synthesize directives for Funcs scheduled with
+        // auto_prefetch(): at the innermost serial loop of each stage,
+        // prefetch each input the stage reads, a target-tuned number
+        // of iterations ahead. Inputs the user prefetches explicitly
+        // are left to the explicit directive.
+        if (current_func && current_func->schedule().auto_prefetch() &&
+            op->for_type == ForType::Serial) {
+            ContainsSerialLoopWithPrefix inner;
+            inner.prefix = current_func->name() + ".s" + std::to_string(stage) + ".";
+            op->body.accept(&inner);
+            if (!inner.result) {
+                // Hexagon's l2fetch grabs large blocks but has more
+                // latency to hide, so fetch further ahead there.
+                Expr offset =
+                    target.features_any_of({Target::HVX_64, Target::HVX_128}) ? 2 : 1;
+
+                set<string> explicitly_prefetched;
+                for (const PrefetchDirective &p : prefetch_list) {
+                    explicitly_prefetched.insert(p.name);
+                }
+
+                CollectReads reads;
+                op->body.accept(&reads);
+                for (const auto &r : reads.reads) {
+                    if (r.first == current_func->name() ||
+                        explicitly_prefetched.count(r.first)) {
+                        continue;
+                    }
+                    // Internal Funcs must have an enclosing
+                    // allocation to compute prefetch bounds against.
+                    if (env.count(r.first) && !buffer_bounds.contains(r.first)) {
+                        continue;
+                    }
+                    PrefetchDirective p;
+                    p.name = r.first;
+                    p.var = op->name.substr(op->name.rfind('.') + 1);
+                    p.offset = offset;
+                    p.strategy = PrefetchBoundStrategy::GuardWithIf;
+                    p.param = r.second;
+                    prefetch_list.push_back(p);
+                }
+            }
+        }
 
         Expr loop_var = Variable::make(Int(32), op->name);
         Stmt body = mutate(op->body);
@@ -340,10 +419,10 @@ public:
 
 } // anonymous namespace
 
-Stmt inject_prefetch(Stmt s, const map<string, Function> &env) {
+Stmt inject_prefetch(Stmt s, const map<string, Function> &env, const Target &t) {
     CollectExternalBufferBounds finder;
     s.accept(&finder);
-    return InjectPrefetch(env, finder.buffers).mutate(s);
+    return InjectPrefetch(env, finder.buffers, t).mutate(s);
 }
 
 Stmt reduce_prefetch_dimension(Stmt stmt, const Target &t) {
@@ -14,7 +14,12 @@
 namespace Halide {
 namespace Internal {
 
-Stmt inject_prefetch(Stmt s, const std::map<std::string, Function> &env);
+/** Inject the prefetches scheduled via Func::prefetch. For Funcs
+ * scheduled with Func::auto_prefetch, also synthesize a prefetch of
+ * each input read by the Func's stages at their innermost serial
+ * loops, with a prefetch distance tuned to the target. */
+Stmt inject_prefetch(Stmt s, const std::map<std::string, Function> &env,
+                     const Target &t);
 
 /** Reduce a multi-dimensional prefetch into a prefetch of lower dimension
  * (max dimension of the prefetch is specified by target architecture).
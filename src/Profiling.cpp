@@ -79,7 +79,7 @@ private:
             return make_zero(UInt(64));
         }
 
-        int32_t constant_size = Allocate::constant_allocation_size(extents, name);
+        int64_t constant_size = Allocate::constant_allocation_size_64(extents, name);
         if (constant_size > 0) {
             int64_t stack_bytes = constant_size * type.bytes();
             if (can_allocation_fit_on_stack(stack_bytes)) { // Allocation on stack
@@ -278,7 +278,9 @@ Stmt inject_profiling(Stmt s, string pipeline_name) {
     Expr start_profiler = Call::make(Int(32), "halide_profiler_pipeline_start",
                                      {pipeline_name, num_funcs, func_names_buf}, Call::Extern);
 
-    Expr get_state = Call::make(Handle(), "halide_profiler_get_state", {}, Call::Extern);
+    // The state to record samples into. This is the global profiler
+    // state unless per-pipeline profiling has been enabled at runtime.
+    Expr get_state = Call::make(Handle(), "halide_profiler_instance_state", {pipeline_name}, Call::Extern);
 
     Expr get_pipeline_state = Call::make(Handle(), "halide_profiler_get_pipeline_state", {pipeline_name}, Call::Extern);
 
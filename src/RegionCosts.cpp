@@ -1,3 +1,8 @@
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
 #include "RegionCosts.h"
 #include "FindCalls.h"
 #include "IRMutator.h"
@@ -79,16 +84,14 @@ class ExprCost : public IRVisitor {
         arith += op_cost;
     }
 
-    // The costs of all the simple binary operations is set to one.
-    // TODO: Changing the costs for division and multiplication may be
-    // beneficial. Write a test case to validate this and update the costs
-    // accordingly.
+    // Simple binary operations cost one op; multiplies and divides are
+    // charged according to the (possibly calibrated) op cost model.
 
     void visit(const Add *op) { visit_binary_operator(op, 1); }
     void visit(const Sub *op) { visit_binary_operator(op, 1); }
-    void visit(const Mul *op) { visit_binary_operator(op, 1); }
-    void visit(const Div *op) { visit_binary_operator(op, 1); }
-    void visit(const Mod *op) { visit_binary_operator(op, 1); }
+    void visit(const Mul *op) { visit_binary_operator(op, model.mul); }
+    void visit(const Div *op) { visit_binary_operator(op, model.div); }
+    void visit(const Mod *op) { visit_binary_operator(op, model.div); }
     void visit(const Min *op) { visit_binary_operator(op, 1); }
     void visit(const Max *op) { visit_binary_operator(op, 1); }
     void visit(const EQ *op) { visit_binary_operator(op, 1); }
@@ -164,11 +167,11 @@ class ExprCost : public IRVisitor {
             // TODO: Suffix based matching is kind of sketchy; but going ahead with
             // it for now. Also not all the PureExtern's are accounted for yet.
             if (ends_with(call->name, "_f64")) {
-                arith += 20;
+                arith += model.math * 2;
             } else if (ends_with(call->name, "_f32")) {
-                arith += 10;
+                arith += model.math;
             } else if (ends_with(call->name, "_f16")) {
-                arith += 5;
+                arith += std::max(model.math / 2, 1);
             } else {
                 // There is no visibility into an extern stage so there is no
                 // way to know the cost of the call statically. Modeling the
@@ -238,8 +241,11 @@ public:
     // Detailed breakdown of bytes loaded by the allocation or function
     // they are loaded from.
     map<string, int64_t> detailed_byte_loads;
+    // Relative per-op-class costs.
+    OpCostModel model;
 
-    ExprCost() : arith(0), memory(0) {}
+    ExprCost(const OpCostModel &model = OpCostModel())
+        : arith(0), memory(0), model(model) {}
 };
 
 // Return the number of bytes required to store a single value of the
@@ -299,15 +305,112 @@ Expr get_func_value_size(const Function &f) {
     }
 };*/
 
-Cost compute_expr_cost(Expr expr) {
+Cost compute_expr_cost(Expr expr, const OpCostModel &model = OpCostModel()) {
     // TODO: Handle likely
     //expr = LikelyExpression().mutate(expr);
     expr = simplify(expr);
-    ExprCost cost_visitor;
+    ExprCost cost_visitor(model);
     expr.accept(&cost_visitor);
     return Cost(cost_visitor.arith, cost_visitor.memory);
 }
 
+// Extends the cost model to the IR nodes that only appear in lowered
+// statements (loads, stores, ramps, etc.), so that lowered loop bodies
+// can be costed as well as stage definitions.
+class LoweredExprCost : public ExprCost {
+    void visit(const Load *op) {
+        op->predicate.accept(this);
+        op->index.accept(this);
+        // Each load also counts as an op, matching how ExprCost
+        // accounts for calls that turn into loads.
+        arith += 1;
+        memory += op->type.bytes() * op->type.lanes();
+    }
+
+    void visit(const Ramp *op) {
+        op->base.accept(this);
+        op->stride.accept(this);
+        arith += 1;
+    }
+
+    void visit(const Broadcast *op) {
+        op->value.accept(this);
+        arith += 1;
+    }
+};
+
+// Accumulate the cost of a lowered statement. Loops multiply the cost
+// of their body by their extent, so the result is symbolic in any loop
+// extents that are not statically known.
+class StmtCost : public IRVisitor {
+    using IRVisitor::visit;
+
+    void add(const Cost &c) {
+        result.arith += c.arith;
+        result.memory += c.memory;
+    }
+
+    Cost expr_cost(const Expr &e) {
+        LoweredExprCost cost;
+        e.accept(&cost);
+        return Cost(cost.arith, cost.memory);
+    }
+
+    void visit(const For *op) {
+        add(expr_cost(op->min));
+        add(expr_cost(op->extent));
+        StmtCost body;
+        op->body.accept(&body);
+        result.arith += op->extent * body.result.arith;
+        result.memory += op->extent * body.result.memory;
+    }
+
+    void visit(const LetStmt *op) {
+        add(expr_cost(op->value));
+        op->body.accept(this);
+    }
+
+    void visit(const IfThenElse *op) {
+        add(expr_cost(op->condition));
+        StmtCost then_case, else_case;
+        op->then_case.accept(&then_case);
+        if (op->else_case.defined()) {
+            op->else_case.accept(&else_case);
+        }
+        // Charge for the more expensive branch.
+        result.arith += max(then_case.result.arith, else_case.result.arith);
+        result.memory += max(then_case.result.memory, else_case.result.memory);
+    }
+
+    void visit(const Store *op) {
+        add(expr_cost(op->predicate));
+        add(expr_cost(op->index));
+        add(expr_cost(op->value));
+        result.memory += op->value.type().bytes() * op->value.type().lanes();
+    }
+
+    void visit(const Provide *op) {
+        for (const auto &arg : op->args) {
+            add(expr_cost(arg));
+        }
+        for (const auto &value : op->values) {
+            add(expr_cost(value));
+            result.memory += value.type().bytes() * value.type().lanes();
+        }
+    }
+
+    void visit(const Evaluate *op) {
+        add(expr_cost(op->value));
+    }
+
+    // Asserts are loop-invariant checks; don't charge the loop body
+    // for them.
+    void visit(const AssertStmt *) {}
+
+public:
+    Cost result{0, 0};
+};
+
 map<string, Expr> compute_expr_detailed_byte_loads(Expr expr) {
     // TODO: Handle likely
     //expr = LikelyExpression().mutate(expr);
@@ -322,9 +425,52 @@ map<string, Expr> compute_expr_detailed_byte_loads(Expr expr) {
     return loads;
 }
 
+// Parse per-Func times out of a profiling run. The file may be a raw
+// capture of halide_profiler_report's output, in which per-Func lines
+// look like "  f: 12.34ms (56%)", or a hand-written list of
+// "<func> <time_ms>" pairs, one per line. Lines matching neither form
+// are ignored. Times for duplicate entries are summed.
+map<string, float> parse_profile_times(std::istream &in) {
+    map<string, float> times;
+    string line;
+    while (std::getline(in, line)) {
+        std::istringstream tokens(line);
+        string name, value;
+        if (!(tokens >> name >> value)) {
+            continue;
+        }
+        if (name[name.size() - 1] == ':') {
+            // Profiler report style; the time carries an "ms" suffix.
+            if (value.size() <= 2 || value.substr(value.size() - 2) != "ms") {
+                continue;
+            }
+            name = name.substr(0, name.size() - 1);
+            value = value.substr(0, value.size() - 2);
+        }
+        const char *start = value.c_str();
+        char *end = nullptr;
+        float ms = strtof(start, &end);
+        if (end == start || *end != '\0' || ms < 0) {
+            continue;
+        }
+        times[name] += ms;
+    }
+    return times;
+}
+
 } // anonymous namespace
 
-RegionCosts::RegionCosts(const map<string, Function> &_env) : env(_env) {
+Cost compute_lowered_stmt_cost(Stmt s) {
+    StmtCost cost;
+    s.accept(&cost);
+    Cost result = cost.result;
+    result.simplify();
+    return result;
+}
+
+RegionCosts::RegionCosts(const map<string, Function> &_env,
+                         const OpCostModel &op_costs)
+    : env(_env), op_cost_model(op_costs) {
     for (const auto &kv : env) {
         // Pre-compute the function costs without any inlining.
         func_cost[kv.first] = get_func_cost(kv.second);
@@ -341,6 +487,74 @@ RegionCosts::RegionCosts(const map<string, Function> &_env) : env(_env) {
             input_estimates.push(iter.first, iter.second);
         }
     }
+
+    // If the user has supplied a profile of an earlier run of the
+    // pipeline, use the measured per-Func times to correct the static
+    // arithmetic cost estimates.
+    string profile_file = get_env_variable("HL_AUTO_SCHEDULE_PROFILE");
+    if (!profile_file.empty()) {
+        apply_profiled_costs(profile_file);
+    }
+}
+
+void RegionCosts::apply_profiled_costs(const string &filename) {
+    std::ifstream file(filename.c_str());
+    user_assert(file.good())
+        << "AutoSchedule: Cannot open the profile file \"" << filename
+        << "\" named by HL_AUTO_SCHEDULE_PROFILE.\n";
+    map<string, float> measured_ms = parse_profile_times(file);
+
+    // Only Funcs which have a measured time and whose static costs are
+    // compile-time constants can be calibrated; the relative shares are
+    // computed over that set.
+    map<string, int64_t> static_arith;
+    float total_measured = 0;
+    int64_t total_static = 0;
+    for (const auto &m : measured_ms) {
+        auto iter = func_cost.find(m.first);
+        if (iter == func_cost.end() || m.second <= 0) {
+            continue;
+        }
+        int64_t arith = 0;
+        bool constant = true;
+        for (const auto &c : iter->second) {
+            const int64_t *a = c.defined() ? as_const_int(c.arith) : nullptr;
+            if (a == nullptr) {
+                constant = false;
+                break;
+            }
+            arith += *a;
+        }
+        if (!constant || arith == 0) {
+            continue;
+        }
+        static_arith.emplace(m.first, arith);
+        total_measured += m.second;
+        total_static += arith;
+    }
+
+    // With fewer than two calibrated Funcs there are no relative shares
+    // to correct.
+    if (static_arith.size() < 2 || total_measured <= 0) {
+        return;
+    }
+
+    for (const auto &s : static_arith) {
+        // Scale the per-value arithmetic cost of each Func so that its
+        // share of the total estimated cost matches its measured share
+        // of the total runtime.
+        float measured_share = get_element(measured_ms, s.first) / total_measured;
+        float static_share = (float)s.second / total_static;
+        float scale = measured_share / static_share;
+        for (auto &c : get_element(func_cost, s.first)) {
+            const int64_t *a = as_const_int(c.arith);
+            internal_assert(a != nullptr);
+            int64_t scaled = (int64_t)std::llround(*a * scale);
+            c.arith = make_const(c.arith.type(), std::max(scaled, (int64_t)1));
+        }
+        debug(1) << "Profile calibration: scaling the arithmetic cost of \""
+                 << s.first << "\" by " << scale << '\n';
+    }
 }
 
 Cost RegionCosts::stage_region_cost(string func, int stage, const DimBounds &bounds,
@@ -566,7 +780,7 @@ Cost RegionCosts::get_func_stage_cost(const Function &f, int stage, const set<st
         Expr inlined_expr = perform_inline(e, env, inlines);
         inlined_expr = simplify(inlined_expr);
 
-        Cost expr_cost = compute_expr_cost(inlined_expr);
+        Cost expr_cost = compute_expr_cost(inlined_expr, op_cost_model);
         internal_assert(expr_cost.defined());
         cost.arith += expr_cost.arith;
         cost.memory += expr_cost.memory;
@@ -581,7 +795,7 @@ Cost RegionCosts::get_func_stage_cost(const Function &f, int stage, const set<st
             Expr inlined_arg = perform_inline(arg, env, inlines);
             inlined_arg = simplify(inlined_arg);
 
-            Cost expr_cost = compute_expr_cost(inlined_arg);
+            Cost expr_cost = compute_expr_cost(inlined_arg, op_cost_model);
             internal_assert(expr_cost.defined());
             cost.arith += expr_cost.arith;
             cost.memory += expr_cost.memory;
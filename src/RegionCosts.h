@@ -36,11 +36,30 @@ struct Cost {
     }
 };
 
+/** Relative costs of the operation classes the auto scheduler's cost model
+ * distinguishes, in units of one simple ALU op (e.g. an add). The defaults
+ * reproduce the historical hard-coded constants; measured values for the
+ * host machine can be substituted by the calibration support in
+ * AutoSchedule.cpp, since the right ratios differ between machines (e.g.
+ * divide throughput or transcendental library speed). */
+struct OpCostModel {
+    /** Cost of a multiply. */
+    int32_t mul{1};
+    /** Cost of an integer or floating-point divide or modulus. */
+    int32_t div{1};
+    /** Cost of a single-precision transcendental (exp, log, sin, ...).
+     * Double-precision is charged at twice this, and half-precision at
+     * half. */
+    int32_t math{10};
+};
+
 /** Auto scheduling component which is used to assign costs for computing a
  * region of a function or one of its stages. */
 struct RegionCosts {
     /** An environment map which contains all functions in the pipeline. */
     std::map<std::string, Function> env;
+    /** Relative per-op-class costs used when costing expressions. */
+    OpCostModel op_cost_model;
     /** A map containing the cost of computing a value in each stage of a
      * function. The number of entries in the vector is equal to the number of
      * stages in the function. */
@@ -126,14 +145,34 @@ struct RegionCosts {
     /** Return the total size of the many input regions in bytes. */
     Expr input_region_size(const std::map<std::string, Box> &input_regions);
 
+    /** Recalibrate the arithmetic costs in 'func_cost' using per-Func
+     * times measured by the profiler. 'filename' names a file containing
+     * either the output of halide_profiler_report or "<func> <time_ms>"
+     * pairs, one per line. Each Func's measured share of the total time
+     * is compared against its share of the statically estimated cost,
+     * and its per-value arithmetic cost is scaled to match. Funcs absent
+     * from the profile, or whose static costs are not compile-time
+     * constants, keep their static estimates. Called by the constructor
+     * when HL_AUTO_SCHEDULE_PROFILE names a file. */
+    void apply_profiled_costs(const std::string &filename);
+
     /** Display the cost of each function in the pipeline. */
     void disp_func_costs();
 
     /** Construct a region cost object for the pipeline. 'env' is a map of all
-     * functions in the pipeline.*/
-    RegionCosts(const std::map<std::string, Function> &env);
+     * functions in the pipeline. 'op_costs' optionally supplies measured
+     * per-op-class costs for the machine being scheduled for. */
+    RegionCosts(const std::map<std::string, Function> &env,
+                const OpCostModel &op_costs = OpCostModel());
 };
 
+/** Compute the arithmetic and memory costs of evaluating a lowered
+ * statement once, using the same per-op costs as the auto scheduler's
+ * cost model. Loop bodies are multiplied by their extents, so the
+ * result is symbolic in any loop extents that are not statically
+ * known. Used by the HTML statement dumper to annotate loops. */
+Cost compute_lowered_stmt_cost(Stmt s);
+
 /** Return true if the cost of inlining a function is equivalent to the
  * cost of calling the function directly. */
 bool is_func_trivial_to_inline(const Function &func);
@@ -168,6 +168,23 @@ std::string LoopLevel::to_string() const {
     }
 }
 
+std::string LoopLevel::serialize() const {
+    // Deliberately doesn't check_locked(): serialization happens
+    // outside of lowering, when the user's LoopLevels are unlocked.
+    if (contents->var_name == undefined_looplevel_name) {
+        return "undefined";
+    }
+    if (contents->var_name == root_looplevel_name) {
+        return "root";
+    }
+    if (contents->var_name == inline_looplevel_name) {
+        return "inlined";
+    }
+    return contents->func_name + " " + contents->var_name + " " +
+           std::to_string(contents->stage_index) + " " +
+           std::to_string(contents->is_rvar ? 1 : 0);
+}
+
 bool LoopLevel::match(const std::string &loop) const {
     check_defined_and_locked();
     if (contents->stage_index == -1) {
@@ -208,16 +225,28 @@ struct FuncScheduleContents {
     mutable RefCount ref_count;
 
     LoopLevel store_level, compute_level;
+    // Inlined means "don't hoist": the allocation stays at the store level.
+    LoopLevel hoist_level;
     std::vector<StorageDim> storage_dims;
     std::vector<Bound> bounds;
     std::vector<Bound> estimates;
     std::map<std::string, Internal::FunctionPtr> wrappers;
+    Expr compute_predicate;
+    Expr memoize_eviction_key;
     bool memoized;
+    bool async;
+    bool double_buffered;
+    bool tuple_interleaved;
+    bool auto_prefetch;
+    bool strict_float;
     MemoryType memory_type;
 
     FuncScheduleContents() :
         store_level(LoopLevel::inlined()), compute_level(LoopLevel::inlined()),
-        memoized(false), memory_type(MemoryType::Auto) {};
+        hoist_level(LoopLevel::inlined()),
+        memoized(false), async(false), double_buffered(false),
+        tuple_interleaved(false), auto_prefetch(false), strict_float(false),
+        memory_type(MemoryType::Auto) {};
 
     // Pass an IRMutator2 through to all Exprs referenced in the FuncScheduleContents
     void mutate(IRMutator2 *mutator) {
@@ -249,6 +278,12 @@ struct FuncScheduleContents {
                 b.remainder = mutator->mutate(b.remainder);
             }
         }
+        if (compute_predicate.defined()) {
+            compute_predicate = mutator->mutate(compute_predicate);
+        }
+        if (memoize_eviction_key.defined()) {
+            memoize_eviction_key = mutator->mutate(memoize_eviction_key);
+        }
     }
 };
 
@@ -276,9 +311,10 @@ struct StageScheduleContents {
     std::vector<FusedPair> fused_pairs;
     bool touched;
     bool allow_race_conditions;
+    bool atomic;
 
     StageScheduleContents() : fuse_level(FuseLoopLevel()), touched(false),
-                              allow_race_conditions(false) {};
+                              allow_race_conditions(false), atomic(false) {};
 
     // Pass an IRMutator2 through to all Exprs referenced in the StageScheduleContents
     void mutate(IRMutator2 *mutator) {
@@ -323,17 +359,27 @@ FuncSchedule FuncSchedule::deep_copy(
     FuncSchedule copy;
     copy.contents->store_level = contents->store_level;
     copy.contents->compute_level = contents->compute_level;
+    copy.contents->hoist_level = contents->hoist_level;
     copy.contents->storage_dims = contents->storage_dims;
     copy.contents->bounds = contents->bounds;
     copy.contents->estimates = contents->estimates;
+    copy.contents->compute_predicate = contents->compute_predicate;
+    copy.contents->memoize_eviction_key = contents->memoize_eviction_key;
     copy.contents->memoized = contents->memoized;
+    copy.contents->async = contents->async;
+    copy.contents->double_buffered = contents->double_buffered;
+    copy.contents->tuple_interleaved = contents->tuple_interleaved;
+    copy.contents->auto_prefetch = contents->auto_prefetch;
+    copy.contents->strict_float = contents->strict_float;
     copy.contents->memory_type = contents->memory_type;
 
-    // Deep-copy wrapper functions.
+    // Deep-copy wrapper functions. A find() rather than operator[] so
+    // that concurrent deep-copies never mutate the map.
     for (const auto &iter : contents->wrappers) {
-        FunctionPtr &copied_func = copied_map[iter.second];
-        internal_assert(copied_func.defined()) << Function(iter.second).name() << "\n";
-        copy.contents->wrappers[iter.first] = copied_func;
+        auto copied = copied_map.find(iter.second);
+        internal_assert(copied != copied_map.end() && copied->second.defined())
+            << Function(iter.second).name() << "\n";
+        copy.contents->wrappers[iter.first] = copied->second;
     }
     internal_assert(copy.contents->wrappers.size() == contents->wrappers.size());
     return copy;
@@ -343,10 +389,66 @@ bool &FuncSchedule::memoized() {
     return contents->memoized;
 }
 
+Expr &FuncSchedule::compute_predicate() {
+    return contents->compute_predicate;
+}
+
+Expr FuncSchedule::compute_predicate() const {
+    return contents->compute_predicate;
+}
+
 bool FuncSchedule::memoized() const {
     return contents->memoized;
 }
 
+Expr &FuncSchedule::memoize_eviction_key() {
+    return contents->memoize_eviction_key;
+}
+
+Expr FuncSchedule::memoize_eviction_key() const {
+    return contents->memoize_eviction_key;
+}
+
+bool &FuncSchedule::async() {
+    return contents->async;
+}
+
+bool FuncSchedule::async() const {
+    return contents->async;
+}
+
+bool &FuncSchedule::double_buffered() {
+    return contents->double_buffered;
+}
+
+bool FuncSchedule::double_buffered() const {
+    return contents->double_buffered;
+}
+
+bool &FuncSchedule::tuple_interleaved() {
+    return contents->tuple_interleaved;
+}
+
+bool FuncSchedule::tuple_interleaved() const {
+    return contents->tuple_interleaved;
+}
+
+bool &FuncSchedule::auto_prefetch() {
+    return contents->auto_prefetch;
+}
+
+bool FuncSchedule::auto_prefetch() const {
+    return contents->auto_prefetch;
+}
+
+bool &FuncSchedule::strict_float() {
+    return contents->strict_float;
+}
+
+bool FuncSchedule::strict_float() const {
+    return contents->strict_float;
+}
+
 MemoryType FuncSchedule::memory_type() const {
     return contents->memory_type;
 }
@@ -416,6 +518,14 @@ const LoopLevel &FuncSchedule::compute_level() const {
     return contents->compute_level;
 }
 
+LoopLevel &FuncSchedule::hoist_storage_level() {
+    return contents->hoist_level;
+}
+
+const LoopLevel &FuncSchedule::hoist_storage_level() const {
+    return contents->hoist_level;
+}
+
 void FuncSchedule::accept(IRVisitor *visitor) const {
     for (const Bound &b : bounds()) {
         if (b.min.defined()) {
@@ -467,6 +577,7 @@ StageSchedule StageSchedule::get_copy() const {
     copy.contents->fused_pairs = contents->fused_pairs;
     copy.contents->touched = contents->touched;
     copy.contents->allow_race_conditions = contents->allow_race_conditions;
+    copy.contents->atomic = contents->atomic;
     return copy;
 }
 
@@ -534,6 +645,14 @@ bool StageSchedule::allow_race_conditions() const {
     return contents->allow_race_conditions;
 }
 
+bool &StageSchedule::atomic() {
+    return contents->atomic;
+}
+
+bool StageSchedule::atomic() const {
+    return contents->atomic;
+}
+
 void StageSchedule::accept(IRVisitor *visitor) const {
     for (const ReductionVariable &r : rvars()) {
         if (r.min.defined()) {
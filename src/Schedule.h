@@ -39,8 +39,11 @@ enum class TailStrategy {
      * factored out into a loop epilogue if possible. Pros: no
      * redundant re-evaluation; does not constrain input our
      * output sizes. Cons: increases code size due to separate
-     * tail-case handling; vectorization will scalarize in the tail
-     * case to handle the if statement. */
+     * tail-case handling. On targets with predicated vector
+     * loads and stores (e.g. AVX-512 or HVX), the tail case is
+     * emitted as masked vector code; elsewhere vectorization
+     * will scalarize in the tail case to handle the if
+     * statement. */
     GuardWithIf,
 
     /** Prevent evaluation beyond the original extent by shifting
@@ -217,6 +220,13 @@ public:
     // to call for root or inline LoopLevels, but asserts if !defined().
     std::string to_string() const;
 
+    // Render this LoopLevel for schedule serialization: "undefined",
+    // "root", "inlined", or "<func> <var> <stage_index> <is_rvar>".
+    // Unlike the inspection methods above this does not require the
+    // LoopLevel to be locked, since serialization happens outside of
+    // lowering.
+    std::string serialize() const;
+
     // Compare this loop level against the variable name of a for
     // loop, to see if this loop level refers to the site
     // immediately inside this loop. Asserts if !defined().
@@ -261,7 +271,7 @@ struct Split {
                 // tail strategy to be GuardWithIf.
     TailStrategy tail;
 
-    enum SplitType {SplitVar = 0, RenameVar, FuseVars, PurifyRVar};
+    enum SplitType {SplitVar = 0, RenameVar, FuseVars, PurifyRVar, FuseVarsMorton};
 
     // If split_type is Rename, then this is just a renaming of the
     // old_var to the outer and not a split. The inner var should
@@ -274,12 +284,15 @@ struct Split {
     // should be one.
 
     // If split_type is Fuse, then this does the opposite of a
-    // split, it joins the outer and inner into the old_var.
+    // split, it joins the outer and inner into the old_var. The
+    // Morton variant iterates the fused dimension in Morton
+    // (Z-curve) order instead of row-major order.
     SplitType split_type;
 
     bool is_rename() const {return split_type == RenameVar;}
     bool is_split() const {return split_type == SplitVar;}
-    bool is_fuse() const {return split_type == FuseVars;}
+    bool is_fuse() const {return split_type == FuseVars || split_type == FuseVarsMorton;}
+    bool is_morton_fuse() const {return split_type == FuseVarsMorton;}
     bool is_purify() const {return split_type == PurifyRVar;}
 };
 
@@ -303,6 +316,13 @@ struct Dim {
 struct Bound {
     std::string var;
     Expr min, extent, modulus, remainder;
+
+    /** If defined, grow the region computed and allocated beyond what
+     * consumers require by this many elements on each side. Used by
+     * Func::pad_bounds to allocate intermediates with a halo. */
+    // @{
+    Expr pad_before, pad_after;
+    // @}
 };
 
 struct StorageDim {
@@ -310,6 +330,7 @@ struct StorageDim {
     Expr alignment;
     Expr fold_factor;
     bool fold_forward;
+    Expr tile_factor;
 };
 
 /** This represents two stages with fused loop nests from outermost to a specific
@@ -393,6 +414,65 @@ public:
     bool memoized() const;
     // @}
 
+    /** An optional eviction tag, stored alongside each memoization
+     * cache entry this function produces so that groups of entries
+     * can be flushed together with
+     * halide_memoization_cache_evict. Undefined unless set via
+     * Func::memoize(eviction_key). */
+    // @{
+    Expr &memoize_eviction_key();
+    Expr memoize_eviction_key() const;
+    // @}
+
+    /** An optional predicate guarding this function's production. When
+     * defined and false at the site where the function would be
+     * computed, the whole computation is skipped, leaving the
+     * function's values undefined. Set via Func::compute_if. */
+    // @{
+    Expr &compute_predicate();
+    Expr compute_predicate() const;
+    // @}
+
+    /** This flag is set to true if the producer of this function
+     * should run asynchronously on its own task. */
+    // @{
+    bool &async();
+    bool async() const;
+    // @}
+
+    /** This flag is set to true if the storage for this function
+     * should be doubled so that the producer can fill one half while
+     * the consumer reads the other. */
+    // @{
+    bool &double_buffered();
+    bool double_buffered() const;
+    // @}
+
+    /** This flag is set to true if this is a Tuple-valued function
+     * whose components should be stored interleaved (AoS) in a single
+     * allocation, rather than split into separate planar
+     * allocations. */
+    // @{
+    bool &tuple_interleaved();
+    bool tuple_interleaved() const;
+    // @}
+
+    /** This flag is set to true if prefetches of the inputs read by
+     * this function's stages should be inserted automatically during
+     * lowering, with a prefetch distance tuned to the target. */
+    // @{
+    bool &auto_prefetch();
+    bool auto_prefetch() const;
+    // @}
+
+    /** This flag is set to true if all floating-point math in this
+     * function's definitions should be kept strict (no reassociation,
+     * contraction, or approximation) during codegen. */
+    // @{
+    bool &strict_float();
+    bool strict_float() const;
+    // @}
+
     /** The list and order of dimensions used to store this
      * function. The first dimension in the vector corresponds to the
      * innermost dimension for storage (i.e. which dimension is
@@ -447,6 +527,14 @@ public:
     LoopLevel &compute_level();
     // @}
 
+    /** At what site, if any, should this function's allocation be
+     * hoisted to? Inlined (the default) means the allocation stays at
+     * the store_level. See \ref Func::hoist_storage */
+    // @{
+    const LoopLevel &hoist_storage_level() const;
+    LoopLevel &hoist_storage_level();
+    // @}
+
     /** Pass an IRVisitor through to all Exprs referenced in the
      * Schedule. */
     void accept(IRVisitor *) const;
@@ -538,6 +626,13 @@ public:
     bool &allow_race_conditions();
     // @}
 
+    /** Should update stores be lowered to atomic read-modify-write
+     * operations? */
+    // @{
+    bool atomic() const;
+    bool &atomic();
+    // @}
+
     /** Pass an IRVisitor through to all Exprs referenced in the
      * Schedule. */
     void accept(IRVisitor *) const;
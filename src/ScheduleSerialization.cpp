@@ -0,0 +1,269 @@
+#include "ScheduleSerialization.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Definition.h"
+#include "Func.h"
+#include "Function.h"
+#include "IROperator.h"
+#include "Schedule.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Bump this when the format changes incompatibly.
+const char * const kFormatHeader = "halide_schedule 1";
+
+// Collect the stage schedules of a Function: the pure definition
+// followed by the updates.
+vector<StageSchedule> stage_schedules(Function &f) {
+    vector<StageSchedule> stages;
+    if (f.has_pure_definition()) {
+        stages.push_back(f.definition().schedule());
+        for (int i = 0; i < f.updates().size(); i++) {
+            stages.push_back(f.update(i).schedule());
+        }
+    }
+    return stages;
+}
+
+void serialize_stage(const StageSchedule &s, size_t index, std::ostream &out) {
+    out << "stage " << index << "\n";
+    for (const Split &split : s.splits()) {
+        out << "split "
+            << split.old_var << " " << split.outer << " " << split.inner << " ";
+        if (!split.factor.defined()) {
+            out << "-";
+        } else if (const int64_t *f = as_const_int(split.factor)) {
+            out << *f;
+        } else {
+            user_error << "Cannot serialize schedule: the split of \""
+                       << split.old_var << "\" has a non-constant factor ("
+                       << split.factor << ").\n";
+        }
+        out << " " << (split.exact ? 1 : 0)
+            << " " << (int)split.tail
+            << " " << (int)split.split_type << "\n";
+    }
+    for (const Dim &dim : s.dims()) {
+        out << "dim " << dim.var
+            << " " << (int)dim.for_type
+            << " " << (int)dim.device_api
+            << " " << (int)dim.dim_type << "\n";
+    }
+}
+
+struct ScheduleParser {
+    map<string, Function> &env;
+    std::istream &in;
+    int line_number{0};
+
+    // State while parsing a "func" block.
+    Function func;
+    bool in_func{false};
+    vector<StageSchedule> stages;
+    int cur_stage{-1};
+
+    ScheduleParser(map<string, Function> &env, std::istream &in)
+        : env(env), in(in) {}
+
+    void error(const string &msg) {
+        user_error << "Error applying schedule at line " << line_number
+                   << ": " << msg << "\n";
+    }
+
+    LoopLevel parse_loop_level(std::istringstream &line) {
+        string token;
+        if (!(line >> token)) {
+            error("expected a loop level");
+        }
+        if (token == "undefined") {
+            return LoopLevel();
+        }
+        if (token == "root") {
+            return LoopLevel::root();
+        }
+        if (token == "inlined") {
+            return LoopLevel::inlined();
+        }
+        string var;
+        int stage_index, is_rvar;
+        if (!(line >> var >> stage_index >> is_rvar)) {
+            error("malformed loop level");
+        }
+        auto iter = env.find(token);
+        if (iter == env.end()) {
+            error("loop level refers to unknown Func \"" + token + "\"");
+        }
+        return LoopLevel(iter->second, VarOrRVar(var, is_rvar != 0), stage_index);
+    }
+
+    void parse() {
+        string raw_line;
+        while (std::getline(in, raw_line)) {
+            line_number++;
+            std::istringstream line(raw_line);
+            string directive;
+            if (!(line >> directive) || directive[0] == '#') {
+                continue;
+            }
+            if (directive == "func") {
+                string name;
+                line >> name;
+                auto iter = env.find(name);
+                if (iter == env.end()) {
+                    error("schedule refers to unknown Func \"" + name + "\"");
+                }
+                func = iter->second;
+                in_func = true;
+                stages = stage_schedules(func);
+                cur_stage = -1;
+                continue;
+            }
+            if (!in_func) {
+                error("directive \"" + directive + "\" outside of a func block");
+            }
+            if (directive == "flags") {
+                int memoized, async, double_buffered, tuple_interleaved, memory_type;
+                if (!(line >> memoized >> async >> double_buffered
+                           >> tuple_interleaved >> memory_type)) {
+                    error("malformed flags");
+                }
+                func.schedule().memoized() = memoized != 0;
+                func.schedule().async() = async != 0;
+                func.schedule().double_buffered() = double_buffered != 0;
+                func.schedule().tuple_interleaved() = tuple_interleaved != 0;
+                func.schedule().memory_type() = (MemoryType)memory_type;
+            } else if (directive == "store_level") {
+                func.schedule().store_level() = parse_loop_level(line);
+            } else if (directive == "compute_level") {
+                func.schedule().compute_level() = parse_loop_level(line);
+            } else if (directive == "storage") {
+                vector<StorageDim> &dims = func.schedule().storage_dims();
+                vector<StorageDim> reordered;
+                string var;
+                while (line >> var) {
+                    bool found = false;
+                    for (const StorageDim &d : dims) {
+                        if (d.var == var) {
+                            reordered.push_back(d);
+                            found = true;
+                            break;
+                        }
+                    }
+                    if (!found) {
+                        error("Func \"" + func.name() +
+                              "\" has no storage dimension \"" + var + "\"");
+                    }
+                }
+                if (reordered.size() != dims.size()) {
+                    error("wrong number of storage dimensions for Func \"" +
+                          func.name() + "\"");
+                }
+                dims = reordered;
+            } else if (directive == "stage") {
+                size_t index;
+                if (!(line >> index) || index >= stages.size()) {
+                    error("bad stage index for Func \"" + func.name() + "\"");
+                }
+                cur_stage = (int)index;
+                // The stage's directives are replaced wholesale.
+                stages[cur_stage].splits().clear();
+                stages[cur_stage].dims().clear();
+                stages[cur_stage].touched() = true;
+            } else if (directive == "split") {
+                if (cur_stage < 0) {
+                    error("split directive outside of a stage");
+                }
+                Split split;
+                string factor;
+                int exact, tail, type;
+                if (!(line >> split.old_var >> split.outer >> split.inner
+                           >> factor >> exact >> tail >> type)) {
+                    error("malformed split");
+                }
+                if (factor != "-") {
+                    split.factor = (int)std::stoll(factor);
+                }
+                split.exact = exact != 0;
+                split.tail = (TailStrategy)tail;
+                split.split_type = (Split::SplitType)type;
+                stages[cur_stage].splits().push_back(split);
+            } else if (directive == "dim") {
+                if (cur_stage < 0) {
+                    error("dim directive outside of a stage");
+                }
+                Dim dim;
+                int for_type, device_api, dim_type;
+                if (!(line >> dim.var >> for_type >> device_api >> dim_type)) {
+                    error("malformed dim");
+                }
+                dim.for_type = (ForType)for_type;
+                dim.device_api = (DeviceAPI)device_api;
+                dim.dim_type = (Dim::Type)dim_type;
+                stages[cur_stage].dims().push_back(dim);
+            } else if (directive == "end") {
+                in_func = false;
+            } else {
+                error("unknown directive \"" + directive + "\"");
+            }
+        }
+    }
+};
+
+}  // namespace
+
+void serialize_schedule(const map<string, Function> &env, std::ostream &out) {
+    out << kFormatHeader << "\n";
+    for (const auto &iter : env) {
+        Function f = iter.second;
+        const FuncSchedule &s = f.schedule();
+        out << "func " << f.name() << "\n";
+        out << "flags "
+            << (s.memoized() ? 1 : 0) << " "
+            << (s.async() ? 1 : 0) << " "
+            << (s.double_buffered() ? 1 : 0) << " "
+            << (s.tuple_interleaved() ? 1 : 0) << " "
+            << (int)s.memory_type() << "\n";
+        out << "store_level " << s.store_level().serialize() << "\n";
+        out << "compute_level " << s.compute_level().serialize() << "\n";
+        out << "storage";
+        for (const StorageDim &d : s.storage_dims()) {
+            out << " " << d.var;
+        }
+        out << "\n";
+        vector<StageSchedule> stages = stage_schedules(f);
+        for (size_t i = 0; i < stages.size(); i++) {
+            if (stages[i].fuse_level().level.serialize() != "inlined") {
+                user_error << "Cannot serialize schedule: Func \"" << f.name()
+                           << "\" uses compute_with, which is not supported.\n";
+            }
+            if (!stages[i].prefetches().empty()) {
+                user_warning << "Schedule serialization does not capture the "
+                             << "prefetch directives of Func \"" << f.name() << "\".\n";
+            }
+            serialize_stage(stages[i], i, out);
+        }
+        out << "end\n";
+    }
+}
+
+void apply_serialized_schedule(map<string, Function> &env, std::istream &in) {
+    string header;
+    std::getline(in, header);
+    user_assert(header == kFormatHeader)
+        << "Unrecognized schedule file header: \"" << header << "\"\n";
+    ScheduleParser parser(env, in);
+    parser.parse();
+}
+
+}  // namespace Internal
+}  // namespace Halide
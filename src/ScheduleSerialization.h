@@ -0,0 +1,39 @@
+#ifndef HALIDE_SCHEDULE_SERIALIZATION_H
+#define HALIDE_SCHEDULE_SERIALIZATION_H
+
+/** \file
+ *
+ * Defines functions that serialize the scheduling directives of a
+ * pipeline to a text format and re-apply them later, so a schedule
+ * can be swapped without recompiling the generator (e.g. by an
+ * autotuner, or to ship per-CPU-model schedules chosen at startup).
+ */
+
+#include <iostream>
+#include <map>
+
+namespace Halide {
+namespace Internal {
+
+class Function;
+
+/** Write the schedules of all Functions in 'env' to 'out'. Captures
+ * splits, dimension ordering and loop types, storage order,
+ * compute/store levels, and the Func-level flags (memoized, async,
+ * memory type, etc). Does not capture compute_with, prefetch
+ * directives, bounds/estimates, or specialization schedules; split
+ * factors must be compile-time constants. */
+void serialize_schedule(const std::map<std::string, Function> &env,
+                        std::ostream &out);
+
+/** Parse a schedule written by serialize_schedule from 'in' and apply
+ * it to the matching Functions in 'env', replacing their existing
+ * scheduling directives. Func names, stage counts, and storage
+ * dimensions must match the pipeline the schedule was saved from. */
+void apply_serialized_schedule(std::map<std::string, Function> &env,
+                               std::istream &in);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -82,6 +82,18 @@ public:
     }
 };
 
+/** A single binding in the flat representation of a Scope. */
+template<typename T>
+struct ScopeEntry {
+    std::string name;
+    T value;
+};
+
+template<>
+struct ScopeEntry<void> {
+    std::string name;
+};
+
 /** A common pattern when traversing Halide IR is that you need to
  * keep track of stuff when you find a Let or a LetStmt, and that it
  * should hide previous values with the same name until you leave the
@@ -89,7 +101,33 @@ public:
 template<typename T = void>
 class Scope {
 private:
+    // Most scopes only ever hold a handful of live bindings, so they
+    // start out as a flat vector searched backwards (which makes
+    // shadowing fall out naturally). Scopes that grow past the
+    // threshold spill into a map of binding stacks and stay there, so
+    // lookups in big scopes remain logarithmic.
+    static const size_t max_flat_entries = 16;
+    std::vector<ScopeEntry<T>> flat;
     std::map<std::string, SmallStack<T>> table;
+    bool spilled;
+
+    void spill() {
+        for (size_t i = 0; i < flat.size(); i++) {
+            spill_push(flat[i]);
+        }
+        flat.clear();
+        spilled = true;
+    }
+
+    // Overloads so spill() compiles for Scope<void> too; only the
+    // matching one is ever instantiated.
+    template<typename T2>
+    void spill_push(const ScopeEntry<T2> &e) {
+        table[e.name].push(e.value);
+    }
+    void spill_push(const ScopeEntry<void> &e) {
+        table[e.name].push();
+    }
 
     // Copying a scope object copies a large table full of strings and
     // stacks. Bad idea.
@@ -99,7 +137,7 @@ private:
     const Scope<T> *containing_scope;
 
 public:
-    Scope() : containing_scope(nullptr) {}
+    Scope() : spilled(false), containing_scope(nullptr) {}
 
     /** Set the parent scope. If lookups fail in this scope, they
      * check the containing scope before returning an error. Caller is
@@ -120,6 +158,17 @@ public:
     template<typename T2 = T,
              typename = typename std::enable_if<!std::is_same<T2, void>::value>::type>
     T2 get(const std::string &name) const {
+        if (!spilled) {
+            for (size_t i = flat.size(); i > 0; i--) {
+                if (flat[i-1].name == name) {
+                    return flat[i-1].value;
+                }
+            }
+            if (containing_scope) {
+                return containing_scope->get(name);
+            }
+            internal_error << "Name not in Scope: " << name << "\n";
+        }
         typename std::map<std::string, SmallStack<T>>::const_iterator iter = table.find(name);
         if (iter == table.end() || iter->second.empty()) {
             if (containing_scope) {
@@ -131,10 +180,20 @@ public:
         return iter->second.top();
     }
 
-    /** Return a reference to an entry. Does not consider the containing scope. */
+    /** Return a reference to an entry. Does not consider the
+     * containing scope. The reference may be invalidated by a
+     * subsequent push to this scope. */
     template<typename T2 = T,
              typename = typename std::enable_if<!std::is_same<T2, void>::value>::type>
     T2 &ref(const std::string &name) {
+        if (!spilled) {
+            for (size_t i = flat.size(); i > 0; i--) {
+                if (flat[i-1].name == name) {
+                    return flat[i-1].value;
+                }
+            }
+            internal_error << "Name not in Scope: " << name << "\n";
+        }
         typename std::map<std::string, SmallStack<T>>::iterator iter = table.find(name);
         if (iter == table.end() || iter->second.empty()) {
             internal_error << "Name not in Scope: " << name << "\n";
@@ -144,6 +203,17 @@ public:
 
     /** Tests if a name is in scope */
     bool contains(const std::string &name) const {
+        if (!spilled) {
+            for (size_t i = flat.size(); i > 0; i--) {
+                if (flat[i-1].name == name) {
+                    return true;
+                }
+            }
+            if (containing_scope) {
+                return containing_scope->contains(name);
+            }
+            return false;
+        }
         typename std::map<std::string, SmallStack<T>>::const_iterator iter = table.find(name);
         if (iter == table.end() || iter->second.empty()) {
             if (containing_scope) {
@@ -161,12 +231,31 @@ public:
     template<typename T2 = T,
              typename = typename std::enable_if<!std::is_same<T2, void>::value>::type>
     void push(const std::string &name, const T2 &value) {
+        if (!spilled) {
+            if (flat.size() < max_flat_entries) {
+                ScopeEntry<T> e;
+                e.name = name;
+                e.value = value;
+                flat.push_back(std::move(e));
+                return;
+            }
+            spill();
+        }
         table[name].push(value);
     }
 
     template<typename T2 = T,
              typename = typename std::enable_if<std::is_same<T2, void>::value>::type>
     void push(const std::string &name) {
+        if (!spilled) {
+            if (flat.size() < max_flat_entries) {
+                ScopeEntry<T> e;
+                e.name = name;
+                flat.push_back(std::move(e));
+                return;
+            }
+            spill();
+        }
         table[name].push();
     }
 
@@ -174,6 +263,16 @@ public:
      * was (or remove it entirely if there was nothing else of the
      * same name in an outer scope) */
     void pop(const std::string &name) {
+        if (!spilled) {
+            for (size_t i = flat.size(); i > 0; i--) {
+                if (flat[i-1].name == name) {
+                    flat.erase(flat.begin() + (i-1));
+                    return;
+                }
+            }
+            internal_error << "Name not in Scope: " << name << "\n";
+            return;
+        }
         typename std::map<std::string, SmallStack<T>>::iterator iter = table.find(name);
         internal_assert(iter != table.end()) << "Name not in Scope: " << name << "\n";
         iter->second.pop();
@@ -182,85 +281,155 @@ public:
         }
     }
 
-    /** Iterate through the scope. Does not capture any containing scope. */
+    /** Iterate through the scope, visiting each live name once with
+     * its innermost binding. Does not capture any containing
+     * scope. */
     class const_iterator {
+        const Scope<T> *scope;
+        size_t flat_index;
         typename std::map<std::string, SmallStack<T>>::const_iterator iter;
+
+        // In the flat representation a shadowed name appears more
+        // than once; only its last (innermost) occurrence counts.
+        bool shadowed() const {
+            for (size_t i = flat_index + 1; i < scope->flat.size(); i++) {
+                if (scope->flat[i].name == scope->flat[flat_index].name) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void skip_shadowed() {
+            while (flat_index < scope->flat.size() && shadowed()) {
+                flat_index++;
+            }
+        }
+
     public:
-        explicit const_iterator(const typename std::map<std::string, SmallStack<T>>::const_iterator &i) :
-            iter(i) {
+        const_iterator(const Scope<T> *s, size_t i,
+                       const typename std::map<std::string, SmallStack<T>>::const_iterator &it) :
+            scope(s), flat_index(i), iter(it) {
+            if (scope && !scope->spilled) {
+                skip_shadowed();
+            }
         }
 
-        const_iterator() {}
+        const_iterator() : scope(nullptr), flat_index(0) {}
 
         bool operator!=(const const_iterator &other) {
+            if (scope && !scope->spilled) {
+                return flat_index != other.flat_index;
+            }
             return iter != other.iter;
         }
 
         void operator++() {
-            ++iter;
+            if (scope && !scope->spilled) {
+                flat_index++;
+                skip_shadowed();
+            } else {
+                ++iter;
+            }
         }
 
         const std::string &name() {
+            if (scope && !scope->spilled) {
+                return scope->flat[flat_index].name;
+            }
             return iter->first;
         }
 
-        const SmallStack<T> &stack() {
-            return iter->second;
-        }
-
         const T &value() {
+            if (scope && !scope->spilled) {
+                return scope->flat[flat_index].value;
+            }
             return iter->second.top_ref();
         }
     };
 
     const_iterator cbegin() const {
-        return const_iterator(table.begin());
+        return const_iterator(this, 0, table.begin());
     }
 
     const_iterator cend() const {
-        return const_iterator(table.end());
+        return const_iterator(this, flat.size(), table.end());
     }
 
     class iterator {
+        Scope<T> *scope;
+        size_t flat_index;
         typename std::map<std::string, SmallStack<T>>::iterator iter;
+
+        bool shadowed() const {
+            for (size_t i = flat_index + 1; i < scope->flat.size(); i++) {
+                if (scope->flat[i].name == scope->flat[flat_index].name) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void skip_shadowed() {
+            while (flat_index < scope->flat.size() && shadowed()) {
+                flat_index++;
+            }
+        }
+
     public:
-        explicit iterator(typename std::map<std::string, SmallStack<T>>::iterator i) :
-            iter(i) {
+        iterator(Scope<T> *s, size_t i,
+                 const typename std::map<std::string, SmallStack<T>>::iterator &it) :
+            scope(s), flat_index(i), iter(it) {
+            if (scope && !scope->spilled) {
+                skip_shadowed();
+            }
         }
 
-        iterator() {}
+        iterator() : scope(nullptr), flat_index(0) {}
 
         bool operator!=(const iterator &other) {
+            if (scope && !scope->spilled) {
+                return flat_index != other.flat_index;
+            }
             return iter != other.iter;
         }
 
         void operator++() {
-            ++iter;
+            if (scope && !scope->spilled) {
+                flat_index++;
+                skip_shadowed();
+            } else {
+                ++iter;
+            }
         }
 
         const std::string &name() {
+            if (scope && !scope->spilled) {
+                return scope->flat[flat_index].name;
+            }
             return iter->first;
         }
 
-        SmallStack<T> &stack() {
-            return iter->second;
-        }
-
         T &value() {
+            if (scope && !scope->spilled) {
+                return scope->flat[flat_index].value;
+            }
             return iter->second.top_ref();
         }
     };
 
     iterator begin() {
-        return iterator(table.begin());
+        return iterator(this, 0, table.begin());
     }
 
     iterator end() {
-        return iterator(table.end());
+        return iterator(this, flat.size(), table.end());
     }
 
     void swap(Scope<T> &other) {
+        flat.swap(other.flat);
         table.swap(other.table);
+        std::swap(spilled, other.spilled);
         std::swap(containing_scope, other.containing_scope);
     }
 };
@@ -602,6 +602,23 @@ private:
             std::swap(a, b);
         }
 
+        // Fast path: when the operands are leaves (a variable plus a
+        // variable or a constant), only a couple of the rules in the
+        // cascade below can fire, so don't bother computing the
+        // operand shapes or walking the rest of the rules.
+        if (a.as<Variable>() && (b.as<Variable>() || is_simple_const(b))) {
+            if (is_zero(b)) {
+                return a;
+            } else if (equal(a, b)) {
+                // x + x = x*2
+                return mutate(a * make_const(op->type, 2));
+            } else if (a.same_as(op->a) && b.same_as(op->b)) {
+                return op;
+            } else {
+                return Add::make(a, b);
+            }
+        }
+
         const Call *call_a = a.as<Call>();
         const Call *call_b = b.as<Call>();
 
@@ -1107,6 +1124,17 @@ private:
         uint64_t ua = 0, ub = 0;
         double fa = 0.0f, fb = 0.0f;
 
+        // Fast path: two leaf operands can only cancel.
+        if (a.as<Variable>() && b.as<Variable>()) {
+            if (equal(a, b)) {
+                return make_zero(op->type);
+            } else if (a.same_as(op->a) && b.same_as(op->b)) {
+                return op;
+            } else {
+                return Sub::make(a, b);
+            }
+        }
+
         const Call *call_a = a.as<Call>();
         const Call *call_b = b.as<Call>();
 
@@ -1824,6 +1852,20 @@ private:
         uint64_t ua = 0, ub = 0;
         double fa = 0.0f, fb = 0.0f;
 
+        // Fast path: for a product of leaves (a variable times a
+        // variable or a constant), only the identity rules can fire.
+        if (a.as<Variable>() && (b.as<Variable>() || is_simple_const(b))) {
+            if (is_zero(b)) {
+                return b;
+            } else if (is_one(b)) {
+                return a;
+            } else if (a.same_as(op->a) && b.same_as(op->b)) {
+                return op;
+            } else {
+                return Mul::make(a, b);
+            }
+        }
+
         const Call *call_a = a.as<Call>();
         const Call *call_b = b.as<Call>();
         const Shuffle *shuffle_a = a.as<Shuffle>();
@@ -2564,6 +2606,28 @@ private:
             std::swap(a, b);
         }
 
+        // Fast path: the only rules below that can fire for two leaf
+        // operands are the cancellation and the bounds comparison.
+        if (a.as<Variable>() && b.as<Variable>()) {
+            if (equal(a, b)) {
+                return a;
+            }
+            int64_t leaf_a_min, leaf_a_max, leaf_b_min, leaf_b_max;
+            if (const_int_bounds(a, &leaf_a_min, &leaf_a_max) &&
+                const_int_bounds(b, &leaf_b_min, &leaf_b_max)) {
+                if (leaf_a_min >= leaf_b_max) {
+                    return b;
+                } else if (leaf_b_min >= leaf_a_max) {
+                    return a;
+                }
+            }
+            if (a.same_as(op->a) && b.same_as(op->b)) {
+                return op;
+            } else {
+                return Min::make(a, b);
+            }
+        }
+
         int64_t ia = 0, ib = 0, ic = 0;
         uint64_t ua = 0, ub = 0;
         double fa = 0.0f, fb = 0.0f;
@@ -3114,6 +3178,28 @@ private:
             std::swap(a, b);
         }
 
+        // Fast path: the only rules below that can fire for two leaf
+        // operands are the cancellation and the bounds comparison.
+        if (a.as<Variable>() && b.as<Variable>()) {
+            if (equal(a, b)) {
+                return a;
+            }
+            int64_t leaf_a_min, leaf_a_max, leaf_b_min, leaf_b_max;
+            if (const_int_bounds(a, &leaf_a_min, &leaf_a_max) &&
+                const_int_bounds(b, &leaf_b_min, &leaf_b_max)) {
+                if (leaf_a_min >= leaf_b_max) {
+                    return a;
+                } else if (leaf_b_min >= leaf_a_max) {
+                    return b;
+                }
+            }
+            if (a.same_as(op->a) && b.same_as(op->b)) {
+                return op;
+            } else {
+                return Max::make(a, b);
+            }
+        }
+
         int64_t ia = 0, ib = 0, ic = 0;
         uint64_t ua = 0, ub = 0;
         double fa = 0.0f, fb = 0.0f;
@@ -5679,12 +5765,16 @@ private:
         const AssertStmt *a = stmt.as<AssertStmt>();
         if (a && is_zero(a->condition)) {
             // Usually, assert(const-false) should generate a warning;
-            // in at least one case (specialize_fail()), we want to suppress
-            // the warning, because the assertion is generated internally
-            // by Halide and is expected to always fail.
+            // in some cases we want to suppress the warning, because
+            // the assertion is generated internally by Halide and is
+            // expected to always fail: specialize_fail(), and the
+            // else-branch assert of a Pipeline::add_requirement check
+            // (the requirement condition is substituted with false
+            // inside that branch).
             const Call *call = a->message.as<Call>();
             const bool const_false_conditions_expected =
-                call && call->name == "halide_error_specialize_fail";
+                call && (call->name == "halide_error_specialize_fail" ||
+                         call->name == "halide_error_requirement_failed");
             if (!const_false_conditions_expected) {
                 user_warning << "This pipeline is guaranteed to fail an assertion at runtime: \n"
                              << stmt << "\n";
@@ -72,24 +72,36 @@ vector<Definition> propagate_specialization_in_definition(Definition &def, const
 
     vector<Specialization> &specializations = def.specializations();
 
-    // Prune specializations based on constants:
+    // Prune specializations that can never trigger:
     // -- Any Specializations that have const-false as a condition
     // can never trigger; go ahead and prune them now to save time & energy
     // during later phases.
     // -- Once we encounter a Specialization that is const-true, no subsequent
     // Specializations can ever trigger (since we evaluate them in order),
     // so erase them.
+    // -- Any Specialization whose condition simplifies to that of an
+    // earlier one is shadowed by it (the first match wins), so erase
+    // it too; each variant of the loop nest we emit costs code size.
     bool seen_const_true = false;
+    vector<Expr> seen_conditions;
     for (auto it = specializations.begin(); it != specializations.end(); /*no-increment*/) {
         Expr old_c = it->condition;
         Expr c = simplify(it->condition);
         // Go ahead and save the simplified condition now
         it->condition = c;
-        if (is_zero(c) || seen_const_true) {
+        bool duplicate = false;
+        for (const Expr &prev : seen_conditions) {
+            if (equal(c, prev)) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (is_zero(c) || seen_const_true || duplicate) {
             debug(1) << "Erasing unreachable specialization ("
                 << old_c << ") -> (" << c << ") for function \"" << name << "\"\n";
             it = specializations.erase(it);
         } else {
+            seen_conditions.push_back(c);
             it++;
         }
         seen_const_true |= is_one(c);
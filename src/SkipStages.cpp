@@ -2,6 +2,7 @@
 #include "CSE.h"
 #include "Debug.h"
 #include "ExprUsesVar.h"
+#include "Function.h"
 #include "IREquality.h"
 #include "IRMutator.h"
 #include "IROperator.h"
@@ -473,6 +474,93 @@ public:
     set<string> candidates;
 };
 
+class InjectComputePredicates : public IRMutator2 {
+public:
+    InjectComputePredicates(const map<string, Function> &env) : env(env) {}
+
+private:
+    const map<string, Function> &env;
+
+    // The enclosing loop names, outermost first.
+    vector<string> loops;
+
+    using IRMutator2::visit;
+
+    // Resolve the free Vars in a compute_if predicate against the
+    // enclosing loop nest by suffix match, innermost first (the same
+    // convention LoopLevel::match uses).
+    class ResolveLoopVars : public IRMutator2 {
+        using IRMutator2::visit;
+
+        Expr visit(const Variable *op) override {
+            if (op->param.defined() || op->image.defined()) {
+                return op;
+            }
+            for (size_t i = loops.size(); i > 0; i--) {
+                if (ends_with(loops[i - 1], "." + op->name)) {
+                    return Variable::make(op->type, loops[i - 1]);
+                }
+            }
+            user_error << "In the compute_if() predicate for " << func
+                       << ", the variable " << op->name
+                       << " does not name any loop enclosing the computation of "
+                       << func << "\n";
+            return op;
+        }
+
+    public:
+        ResolveLoopVars(const vector<string> &l, const string &f) : loops(l), func(f) {}
+        const vector<string> &loops;
+        string func;
+    };
+
+    Stmt visit(const For *op) override {
+        loops.push_back(op->name);
+        Stmt stmt = IRMutator2::visit(op);
+        loops.pop_back();
+        return stmt;
+    }
+
+    Stmt visit(const ProducerConsumer *op) override {
+        Stmt stmt = IRMutator2::visit(op);
+        if (!op->is_producer) {
+            return stmt;
+        }
+        auto it = env.find(op->name);
+        if (it == env.end()) {
+            return stmt;
+        }
+        Expr predicate = it->second.schedule().compute_predicate();
+        if (!predicate.defined()) {
+            return stmt;
+        }
+
+        ResolveLoopVars resolver(loops, op->name);
+        predicate = resolver.mutate(predicate);
+
+        op = stmt.as<ProducerConsumer>();
+        internal_assert(op);
+        Stmt body = IfThenElse::make(predicate, op->body);
+        return ProducerConsumer::make(op->name, op->is_producer, body);
+    }
+};
+
+Stmt inject_compute_predicates(Stmt stmt, const map<string, Function> &env) {
+    bool any = false;
+    for (const auto &p : env) {
+        if (p.second.schedule().compute_predicate().defined()) {
+            user_assert(!p.second.schedule().compute_level().is_inlined())
+                << "Func " << p.first << " is scheduled with compute_if() but is inlined. "
+                << "compute_if() requires a compute_root() or compute_at() schedule.\n";
+            any = true;
+        }
+    }
+    if (!any) {
+        return stmt;
+    }
+    return InjectComputePredicates(env).mutate(stmt);
+}
+
 Stmt skip_stages(Stmt stmt, const vector<string> &order) {
     // Don't consider the last stage, because it's the output, so it's
     // never skippable.
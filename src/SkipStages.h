@@ -1,6 +1,8 @@
 #ifndef HALIDE_SKIP_STAGES
 #define HALIDE_SKIP_STAGES
 
+#include <map>
+
 #include "IR.h"
 
 /** \file
@@ -10,6 +12,8 @@
 namespace Halide {
 namespace Internal {
 
+class Function;
+
 /** Avoid computing certain stages if we can infer a runtime condition
  * to check that tells us they won't be used. Does this by analyzing
  * all reads of each buffer allocated, and inferring some condition
@@ -17,6 +21,14 @@ namespace Internal {
  * inject ifs that guard the production. */
 Stmt skip_stages(Stmt s, const std::vector<std::string> &order);
 
+/** Guard the production of any Func scheduled with compute_if with its
+ * predicate, resolving free Vars in the predicate against the
+ * enclosing loop nest. Runs right after the initial loop nests are
+ * created so that bounds inference sees the predicate's loads, and so
+ * that skip_stages can propagate the skip to producers that are used
+ * nowhere else. */
+Stmt inject_compute_predicates(Stmt s, const std::map<std::string, Function> &env);
+
 }  // namespace Internal
 }  // namespace Halide
 
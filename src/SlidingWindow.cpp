@@ -13,7 +13,9 @@ namespace Halide {
 namespace Internal {
 
 using std::map;
+using std::pair;
 using std::string;
+using std::vector;
 
 namespace {
 
@@ -387,6 +389,72 @@ class SlidingWindow : public IRMutator2 {
 
         debug(3) << "Doing sliding window analysis on realization of " << op->name << "\n";
 
+        // If the realization directly wraps a parallel loop over
+        // which this function could slide, we would normally have to
+        // abandon sliding and recompute the full footprint on every
+        // iteration. Instead, strip-mine the parallel loop and sink
+        // the realization into the strips. Each worker then gets its
+        // own buffer (which storage folding can shrink as usual) and
+        // slides serially within its strip, warming up once at the
+        // start of the strip.
+        {
+            vector<pair<string, Expr>> lets;
+            Stmt body = new_body;
+            while (const LetStmt *l = body.as<LetStmt>()) {
+                lets.push_back({l->name, l->value});
+                body = l->body;
+            }
+            const For *loop = body.as<For>();
+            if (loop &&
+                loop->for_type == ForType::Parallel &&
+                loop->device_api == DeviceAPI::None) {
+                // Check whether sliding would succeed if this loop were serial.
+                Stmt slid = SlidingWindowOnFunctionAndLoop(iter->second, loop->name, loop->min)
+                    .mutate(loop->body);
+                if (!slid.same_as(loop->body)) {
+                    debug(3) << "Strip-mining parallel loop " << loop->name
+                             << " to slide " << op->name << " within each strip\n";
+
+                    string strip_var = loop->name + ".strip";
+                    string num_strips_name = loop->name + ".num_strips";
+                    string strip_size_name = loop->name + ".strip_size";
+                    string strip_min_name = loop->name + ".strip_min";
+                    string strip_extent_name = loop->name + ".strip_extent";
+                    Expr strip_idx = Variable::make(Int(32), strip_var);
+                    Expr num_strips = Variable::make(Int(32), num_strips_name);
+                    Expr strip_size = Variable::make(Int(32), strip_size_name);
+
+                    Stmt serial = For::make(loop->name,
+                                            Variable::make(Int(32), strip_min_name),
+                                            Variable::make(Int(32), strip_extent_name),
+                                            ForType::Serial, loop->device_api, loop->body);
+                    Stmt r = Realize::make(op->name, op->types, op->memory_type,
+                                           op->bounds, op->condition, serial);
+                    r = LetStmt::make(strip_extent_name,
+                                      min(loop->extent - strip_idx * strip_size, strip_size), r);
+                    r = LetStmt::make(strip_min_name,
+                                      loop->min + strip_idx * strip_size, r);
+                    Stmt s = For::make(strip_var, 0, num_strips,
+                                       ForType::Parallel, loop->device_api, r);
+                    s = LetStmt::make(strip_size_name,
+                                      (loop->extent + num_strips - 1) / num_strips, s);
+                    // A few strips per worker amortizes the warm-up
+                    // while still leaving slack for load balancing.
+                    Expr threads = Call::make(Int(32), "halide_get_num_threads",
+                                              {}, Call::Extern);
+                    s = LetStmt::make(num_strips_name,
+                                      max(min(loop->extent, threads * 4), 1), s);
+                    while (!lets.empty()) {
+                        s = LetStmt::make(lets.back().first, lets.back().second, s);
+                        lets.pop_back();
+                    }
+                    // The recursive mutation slides over the now-serial
+                    // loop inside each strip's private realization.
+                    return mutate(s);
+                }
+            }
+        }
+
         new_body = SlidingWindowOnFunction(iter->second).mutate(new_body);
 
         new_body = mutate(new_body);
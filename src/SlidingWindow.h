@@ -16,7 +16,10 @@ namespace Internal {
 
 /** Perform sliding window optimizations on a halide
  * statement. I.e. don't bother computing points in a function that
- * have provably already been computed by a previous iteration.
+ * have provably already been computed by a previous iteration. When
+ * the loop being slid over is parallel, it is strip-mined so that
+ * each worker slides serially within its own strip of iterations,
+ * using a private buffer.
  */
 Stmt sliding_window(Stmt s, const std::map<std::string, Function> &env);
 
@@ -1,3 +1,6 @@
+#include <mutex>
+#include <set>
+
 #include "Solve.h"
 #include "CSE.h"
 #include "ExprUsesVar.h"
@@ -11,6 +14,7 @@ namespace Internal {
 
 using std::map;
 using std::pair;
+using std::set;
 using std::string;
 using std::vector;
 
@@ -1313,9 +1317,105 @@ public:
 
 
 
+// The solver is a pure function of the expression, the variable, and
+// the scope bindings the expression can reach, and bounds inference
+// asks it the same questions over and over as it walks the stages of
+// a pipeline. Cache the results, following the associativity cache:
+// the key components are packed into a single Call node so
+// IRDeepCompare can order them. Because the reachable bindings are
+// part of the key, a change of scope makes a different key rather
+// than a stale hit, so no explicit invalidation is needed; the caches
+// are cleared at the start of each lowering to bound their size.
+
+// Collect every variable name referenced anywhere in an expression.
+// Includes let-bound names, which makes the reachable-binding set
+// below a (sound) superset.
+class CollectVars : public IRVisitor {
+public:
+    set<string> vars;
+
+private:
+    using IRVisitor::visit;
+
+    void visit(const Variable *op) override {
+        vars.insert(op->name);
+    }
+};
+
+// Gather the scope bindings the solve could observe: those reachable
+// from the expression through the scope, transitively. std::map so
+// the key is canonically ordered.
+void reachable_bindings(const Expr &e, const Scope<Expr> &scope, map<string, Expr> *bindings) {
+    CollectVars collect;
+    e.accept(&collect);
+    vector<string> pending(collect.vars.begin(), collect.vars.end());
+    set<string> visited;
+    while (!pending.empty()) {
+        string v = pending.back();
+        pending.pop_back();
+        if (!visited.insert(v).second || !scope.contains(v)) {
+            continue;
+        }
+        Expr value = scope.get(v);
+        (*bindings)[v] = value;
+        CollectVars more;
+        value.accept(&more);
+        pending.insert(pending.end(), more.vars.begin(), more.vars.end());
+    }
+}
+
+void reachable_bindings(const Expr &e, const Scope<Interval> &scope, map<string, Interval> *bindings) {
+    CollectVars collect;
+    e.accept(&collect);
+    vector<string> pending(collect.vars.begin(), collect.vars.end());
+    set<string> visited;
+    while (!pending.empty()) {
+        string v = pending.back();
+        pending.pop_back();
+        if (!visited.insert(v).second || !scope.contains(v)) {
+            continue;
+        }
+        Interval value = scope.get(v);
+        (*bindings)[v] = value;
+        CollectVars more;
+        if (value.min.defined()) value.min.accept(&more);
+        if (value.max.defined()) value.max.accept(&more);
+        pending.insert(pending.end(), more.vars.begin(), more.vars.end());
+    }
+}
+
+std::mutex solve_cache_mutex;
+map<Expr, SolverResult, IRDeepCompare> solve_expression_cache;
+map<Expr, Interval, IRDeepCompare> solve_interval_cache;
+map<Expr, Expr, IRDeepCompare> and_condition_cache;
+
 } // Anonymous namespace
 
+void clear_solver_cache() {
+    std::lock_guard<std::mutex> lock(solve_cache_mutex);
+    solve_expression_cache.clear();
+    solve_interval_cache.clear();
+    and_condition_cache.clear();
+}
+
 SolverResult solve_expression(Expr e, const std::string &variable, const Scope<Expr> &scope) {
+    vector<Expr> key_args = {e, StringImm::make(variable)};
+    map<string, Expr> bindings;
+    reachable_bindings(e, scope, &bindings);
+    for (const auto &b : bindings) {
+        key_args.push_back(StringImm::make(b.first));
+        key_args.push_back(b.second);
+    }
+    Expr key = Call::make(Int(32), "solve_expression_cache_key", key_args, Call::Extern);
+
+    {
+        std::lock_guard<std::mutex> lock(solve_cache_mutex);
+        auto it = solve_expression_cache.find(key);
+        if (it != solve_expression_cache.end()) {
+            return it->second;
+        }
+    }
+
     SolveExpression solver(variable, scope);
     Expr new_e = solver.mutate(e);
     // The process has expanded lets. Re-collect them.
@@ -1323,41 +1423,85 @@ SolverResult solve_expression(Expr e, const std::string &variable, const Scope<E
     debug(3) << "Solved expr for " << variable << " :\n"
              << "  " << e << "\n"
              << "  " << new_e << "\n";
-    return {new_e, !solver.failed};
+    SolverResult result = {new_e, !solver.failed};
+
+    {
+        std::lock_guard<std::mutex> lock(solve_cache_mutex);
+        solve_expression_cache.emplace(key, result);
+    }
+    return result;
 }
 
+namespace {
 
-Interval solve_for_inner_interval(Expr c, const std::string &var) {
-    SolveForInterval s(var, false);
+Interval solve_for_interval(const Expr &c, const std::string &var, bool outer) {
+    Expr key = Call::make(Int(32),
+                          outer ? "solve_outer_interval_cache_key" : "solve_inner_interval_cache_key",
+                          {c, StringImm::make(var)}, Call::Extern);
+    {
+        std::lock_guard<std::mutex> lock(solve_cache_mutex);
+        auto it = solve_interval_cache.find(key);
+        if (it != solve_interval_cache.end()) {
+            return it->second;
+        }
+    }
+
+    SolveForInterval s(var, outer);
     c.accept(&s);
     internal_assert(s.result.min.defined() && s.result.max.defined())
-        << "solve_for_inner_interval returned undefined Exprs: " << c << "\n";
+        << "solve_for_" << (outer ? "outer" : "inner")
+        << "_interval returned undefined Exprs: " << c << "\n";
     s.result.min = simplify(common_subexpression_elimination(s.result.min));
     s.result.max = simplify(common_subexpression_elimination(s.result.max));
     if (s.result.is_bounded() &&
         can_prove(s.result.min > s.result.max)) {
-        return Interval::nothing();
+        s.result = Interval::nothing();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(solve_cache_mutex);
+        solve_interval_cache.emplace(key, s.result);
     }
     return s.result;
 }
 
+} // Anonymous namespace
+
+Interval solve_for_inner_interval(Expr c, const std::string &var) {
+    return solve_for_interval(c, var, false);
+}
+
 Interval solve_for_outer_interval(Expr c, const std::string &var) {
-    SolveForInterval s(var, true);
-    c.accept(&s);
-    internal_assert(s.result.min.defined() && s.result.max.defined())
-        << "solve_for_outer_interval returned undefined Exprs: " << c << "\n";
-    s.result.min = simplify(common_subexpression_elimination(s.result.min));
-    s.result.max = simplify(common_subexpression_elimination(s.result.max));
-    if (s.result.is_bounded() &&
-        can_prove(s.result.min > s.result.max)) {
-        return Interval::nothing();
-    }
-    return s.result;
+    return solve_for_interval(c, var, true);
 }
 
 Expr and_condition_over_domain(Expr e, const Scope<Interval> &varying) {
+    vector<Expr> key_args = {e};
+    map<string, Interval> bindings;
+    reachable_bindings(e, varying, &bindings);
+    for (const auto &b : bindings) {
+        key_args.push_back(StringImm::make(b.first));
+        key_args.push_back(b.second.min);
+        key_args.push_back(b.second.max);
+    }
+    Expr key = Call::make(Int(32), "and_condition_cache_key", key_args, Call::Extern);
+
+    {
+        std::lock_guard<std::mutex> lock(solve_cache_mutex);
+        auto it = and_condition_cache.find(key);
+        if (it != and_condition_cache.end()) {
+            return it->second;
+        }
+    }
+
     AndConditionOverDomain r(varying);
-    return simplify(r.mutate(e));
+    Expr result = simplify(r.mutate(e));
+
+    {
+        std::lock_guard<std::mutex> lock(solve_cache_mutex);
+        and_condition_cache.emplace(key, result);
+    }
+    return result;
 }
 
 // Testing code
@@ -46,6 +46,14 @@ Interval solve_for_inner_interval(Expr c, const std::string &variable);
  * 'and' over the vector lanes, and return a scalar result. */
 Expr and_condition_over_domain(Expr c, const Scope<Interval> &varying);
 
+/** The routines above memoize their results, keyed on the expression,
+ * the variable, and the scope bindings reachable from the expression
+ * (so a scope change produces a different key rather than a stale
+ * hit). Bounds inference asks the same questions many times across
+ * the stages of a pipeline. Called at the start of each lowering to
+ * bound the memory the caches hold. */
+void clear_solver_cache();
+
 void solve_test();
 
 }  // namespace Internal
@@ -56,11 +56,30 @@ class SplitTuples : public IRMutator2 {
 
     map<string, set<int>> func_value_indices;
 
+    bool is_interleaved(const string &name) const {
+        auto it = env.find(name);
+        return (it != env.end() &&
+                it->second.outputs() > 1 &&
+                it->second.schedule().tuple_interleaved());
+    }
+
     Stmt visit(const Realize *op) override {
         ScopedBinding<int> bind(realizations, op->name, 0);
         if (op->types.size() > 1) {
-            // Make a nested set of realize nodes for each tuple element
             Stmt body = mutate(op->body);
+            if (is_interleaved(op->name)) {
+                // Make a single realize node with an extra innermost
+                // dimension indexing the tuple component.
+                for (size_t i = 1; i < op->types.size(); i++) {
+                    user_assert(op->types[i] == op->types[0])
+                        << "Can't interleave the storage of " << op->name
+                        << ", because its Tuple components do not all have the same type.\n";
+                }
+                Region bounds = op->bounds;
+                bounds.push_back(Range(0, (int)op->types.size()));
+                return Realize::make(op->name, {op->types[0]}, op->memory_type, bounds, op->condition, body);
+            }
+            // Make a nested set of realize nodes for each tuple element
             for (int i = (int)op->types.size() - 1; i >= 0; i--) {
                 body = Realize::make(op->name + "." + std::to_string(i), {op->types[i]}, op->memory_type, op->bounds, op->condition, body);
             }
@@ -84,7 +103,13 @@ class SplitTuples : public IRMutator2 {
 
     Stmt visit(const Prefetch *op) override {
         Stmt stmt;
-        if (!op->param.defined() && (op->types.size() > 1)) {
+        if (!op->param.defined() && (op->types.size() > 1) && is_interleaved(op->name)) {
+            // Prefetch the whole interleaved allocation over the
+            // component dimension.
+            Region bounds = op->bounds;
+            bounds.push_back(Range(0, (int)op->types.size()));
+            stmt = Prefetch::make(op->name, {op->types[0]}, bounds);
+        } else if (!op->param.defined() && (op->types.size() > 1)) {
             // Split the prefetch from a multi-dimensional halide tuple to
             // prefetches of each tuple element. Keep only prefetches of
             // elements that are actually used in the loop body.
@@ -110,13 +135,18 @@ class SplitTuples : public IRMutator2 {
             internal_assert(it != env.end());
             Function f = it->second;
             string name = op->name;
-            if (f.outputs() > 1) {
+            bool interleaved = is_interleaved(op->name);
+            if (f.outputs() > 1 && !interleaved) {
                 name += "." + std::to_string(op->value_index);
             }
             vector<Expr> args;
             for (Expr e : op->args) {
                 args.push_back(mutate(e));
             }
+            if (f.outputs() > 1 && interleaved) {
+                // The component becomes an extra innermost coordinate.
+                args.push_back(op->value_index);
+            }
             // It's safe to hook up the pointer to the function
             // unconditionally. This expr never gets held by a
             // Function, so there can't be a cycle. We do this even
@@ -168,6 +198,11 @@ class SplitTuples : public IRMutator2 {
         vector<Stmt> provides;
         vector<pair<string, Expr>> lets;
 
+        bool interleaved = is_interleaved(op->name);
+        user_assert(!interleaved || realizations.contains(op->name))
+            << "Cannot use interleave_storage on " << op->name
+            << ", because it is a pipeline output.\n";
+
         for (size_t i = 0; i < op->values.size(); i++) {
             string name = op->name + "." + std::to_string(i);
             string var_name = name + ".value";
@@ -176,7 +211,13 @@ class SplitTuples : public IRMutator2 {
                 lets.push_back({ var_name, val });
                 val = Variable::make(val.type(), var_name);
             }
-            provides.push_back(Provide::make(name, {val}, args));
+            if (interleaved) {
+                vector<Expr> component_args = args;
+                component_args.push_back((int)i);
+                provides.push_back(Provide::make(op->name, {val}, component_args));
+            } else {
+                provides.push_back(Provide::make(name, {val}, args));
+            }
         }
 
         Stmt result = Block::make(provides);
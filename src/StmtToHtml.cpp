@@ -1,7 +1,9 @@
 #include "StmtToHtml.h"
 #include "IRVisitor.h"
 #include "IROperator.h"
+#include "RegionCosts.h"
 #include "Scope.h"
+#include "Simplify.h"
 
 #include <iterator>
 #include <iostream>
@@ -22,6 +24,24 @@ std::string to_string(T value) {
     return os.str() ;
 }
 
+// Escape text destined for the html (e.g. cost annotations, which
+// stream exprs directly rather than going through the visitor).
+std::string escape_html(const std::string &s) {
+    std::string result;
+    for (char c : s) {
+        if (c == '&') {
+            result += "&amp;";
+        } else if (c == '<') {
+            result += "&lt;";
+        } else if (c == '>') {
+            result += "&gt;";
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
 class StmtToHtml : public IRVisitor {
 
     static const std::string css, js;
@@ -341,6 +361,21 @@ private:
         stream << close_div();
         scope.pop(op->name);
     }
+    // Annotate a loop with its trip count and the estimated cost of
+    // everything beneath it, so that the heavy parts of the nest can
+    // be spotted (and the rest folded away) without running the
+    // profiler. The estimates come from the auto scheduler's cost
+    // model, and stay symbolic in any extents that are not statically
+    // known.
+    string loop_cost_comment(const For *op) {
+        Cost cost = compute_lowered_stmt_cost(Stmt(op));
+        std::ostringstream ss;
+        ss << "// trip count: " << simplify(op->extent)
+           << ", estimated ops: " << cost.arith
+           << ", bytes moved: " << cost.memory;
+        return " " + span("Comment Cost", escape_html(ss.str()));
+    }
+
     void visit(const For *op) {
         scope.push(op->name, unique_id());
         stream << open_div("For");
@@ -371,6 +406,7 @@ private:
         stream << matched(")");
         stream << close_expand_button();
         stream << " " << matched("{");
+        stream << loop_cost_comment(op);
         stream << open_div("ForBody Indent", id);
         print(op->body);
         stream << close_div();
@@ -696,6 +732,7 @@ div.WrapLine { margin-left: 30px; text-indent:-30px; } \n \
 div.Indent { padding-left: 15px; }\n \
 div.ShowHide { position:absolute; left:-12px; width:12px; height:12px; } \n \
 span.Comment { color: #998; font-style: italic; }\n \
+span.Cost { margin-left: 12px; }\n \
 span.Keyword { color: #333; font-weight: bold; }\n \
 span.Assign { color: #d14; font-weight: bold; }\n \
 span.Symbol { color: #990073; }\n \
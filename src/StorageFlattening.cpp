@@ -38,6 +38,10 @@ private:
     const Target &target;
     Scope<> realizations, shader_scope_realizations;
     bool in_shader = false;
+    // Depth of enclosing GPU block and thread loops; used to spot
+    // realizations that will become shared-memory allocations.
+    int gpu_block_depth = 0;
+    int gpu_thread_depth = 0;
 
     Expr make_shape_var(string name, string field, size_t dim,
                         const Buffer<> &buf, const Parameter &param) {
@@ -65,10 +69,47 @@ private:
 
         Expr zero = target.has_large_buffers() ? make_zero(Int(64)) : 0;
 
+        // Look for a tiled storage layout on this function. The tile
+        // factors are attached to the two innermost storage
+        // dimensions.
+        Expr tile_x, tile_y;
+        int tile_dx = -1, tile_dy = -1;
+        {
+            auto iter = env.find(name);
+            if (iter != env.end()) {
+                const Function &f = iter->second.first;
+                const vector<StorageDim> &storage_dims = f.schedule().storage_dims();
+                if (storage_dims.size() >= 2 &&
+                    storage_dims[0].tile_factor.defined() &&
+                    storage_dims[1].tile_factor.defined()) {
+                    user_assert(internal)
+                        << "Cannot use tiled storage for " << f.name()
+                        << ", because it is a pipeline output.\n";
+                    tile_x = storage_dims[0].tile_factor;
+                    tile_y = storage_dims[1].tile_factor;
+                    const vector<string> &f_args = f.args();
+                    for (size_t j = 0; j < f_args.size(); j++) {
+                        if (f_args[j] == storage_dims[0].var) {
+                            tile_dx = (int)j;
+                        } else if (f_args[j] == storage_dims[1].var) {
+                            tile_dy = (int)j;
+                        }
+                    }
+                    internal_assert(tile_dx >= 0 && tile_dy >= 0);
+                }
+            }
+        }
+
         // We peel off constant offsets so that multiple stencil
         // taps can share the same base address.
         Expr constant_term = zero;
         for (size_t i = 0; i < args.size(); i++) {
+            if ((int)i == tile_dx || (int)i == tile_dy) {
+                // Tiled dimensions have a non-linear addressing
+                // computation, so constant offsets can't be peeled
+                // through them.
+                continue;
+            }
             const Add *add = args[i].as<Add>();
             if (add && is_const(add->b)) {
                 constant_term += strides[i] * add->b;
@@ -81,7 +122,24 @@ private:
             // strategy makes sense when we expect x to cancel with
             // something in xmin.  We use this for internal allocations.
             for (size_t i = 0; i < args.size(); i++) {
-                idx += (args[i] - mins[i]) * strides[i];
+                if ((int)i == tile_dx) {
+                    // Within-tile coordinate, then tile column. Whole
+                    // tiles are contiguous, so the inter-tile stride
+                    // in x is the tile size.
+                    Expr d = args[i] - mins[i];
+                    idx += (d % tile_x) * strides[i];
+                    idx += (d / tile_x) * (tile_x * tile_y * strides[i]);
+                } else if ((int)i == tile_dy) {
+                    // Within-tile coordinate, then tile row. The
+                    // allocated extent in x is rounded up to a whole
+                    // number of tiles, so a row of tiles is tile_y
+                    // times the regular y stride.
+                    Expr d = args[i] - mins[i];
+                    idx += (d % tile_y) * (tile_x * strides[tile_dx]);
+                    idx += (d / tile_y) * (tile_y * strides[i]);
+                } else {
+                    idx += (args[i] - mins[i]) * strides[i];
+                }
             }
         } else {
             // f(x, y) -> f[x*stride + y*ystride - (xstride*xmin +
@@ -135,30 +193,81 @@ private:
         // also affects the device allocation in some backends).
         vector<Expr> allocation_extents(extents.size());
         vector<int> storage_permutation;
+        bool innermost_storage_aligned = false;
+        bool storage_tiled = false;
         {
             auto iter = env.find(op->name);
             internal_assert(iter != env.end()) << "Realize node refers to function not in environment.\n";
             Function f = iter->second.first;
             const vector<StorageDim> &storage_dims = f.schedule().storage_dims();
             const vector<string> &args = f.args();
+            if (f.outputs() > 1 && f.schedule().tuple_interleaved()) {
+                // The tuple component dimension appended by
+                // SplitTuples is innermost in storage, so that the
+                // components of each element are interleaved.
+                int component_dim = (int)op->bounds.size() - 1;
+                storage_permutation.push_back(component_dim);
+                allocation_extents[component_dim] = extents[component_dim];
+            }
+            size_t base = storage_permutation.size();
             for (size_t i = 0; i < storage_dims.size(); i++) {
                 for (size_t j = 0; j < args.size(); j++) {
                     if (args[j] == storage_dims[i].var) {
                         storage_permutation.push_back((int)j);
                         Expr alignment = storage_dims[i].alignment;
                         if (alignment.defined()) {
+                            if (i == 0) {
+                                innermost_storage_aligned = true;
+                            }
                             allocation_extents[j] = ((extents[j] + alignment - 1)/alignment)*alignment;
                         } else {
                             allocation_extents[j] = extents[j];
                         }
+                        Expr tile_factor = storage_dims[i].tile_factor;
+                        if (tile_factor.defined()) {
+                            storage_tiled = true;
+                            user_assert(i < 2)
+                                << "In schedule for " << op->name
+                                << ", the tiled storage dimensions must remain the "
+                                << "two innermost storage dimensions.\n";
+                            // Round the allocation up to a whole
+                            // number of tiles.
+                            allocation_extents[j] = ((allocation_extents[j] + tile_factor - 1)/tile_factor)*tile_factor;
+                        }
                     }
                 }
-                internal_assert(storage_permutation.size() == i+1);
+                internal_assert(storage_permutation.size() == base + i + 1);
             }
         }
 
         internal_assert(storage_permutation.size() == op->bounds.size());
 
+        // This realization will live in GPU shared memory if it sits
+        // inside the block loops but outside the thread loops. Shared
+        // memory is split into 32 four-byte banks, so if a row of the
+        // allocation spans a multiple of 128 bytes, threads walking a
+        // column (e.g. the store side of a transpose tile) all hit
+        // the same bank and serialize. Pad the innermost storage
+        // dimension by one bank to stagger the rows. An explicit
+        // align_storage on the innermost dimension turns this off;
+        // that dimension's layout is then whatever the user asked
+        // for.
+        if (gpu_block_depth > 0 && gpu_thread_depth == 0 && !in_shader &&
+            (op->memory_type == MemoryType::Auto ||
+             op->memory_type == MemoryType::GPUShared) &&
+            op->bounds.size() > 1 &&
+            !innermost_storage_aligned &&
+            !storage_tiled) {
+            int innermost = storage_permutation[0];
+            const int64_t *row = as_const_int(allocation_extents[innermost]);
+            int bytes = op->types[0].bytes();
+            if (row && ((*row) * bytes) % 128 == 0) {
+                int pad = 4 / bytes;
+                if (pad < 1) pad = 1;
+                allocation_extents[innermost] = (int)(*row + pad);
+            }
+        }
+
         Stmt stmt = body;
         internal_assert(op->types.size() == 1);
 
@@ -328,13 +437,18 @@ private:
                 Function f = iter->second.first;
                 const vector<StorageDim> &storage_dims = f.schedule().storage_dims();
                 const vector<string> &args = f.args();
+                if (f.outputs() > 1 && f.schedule().tuple_interleaved()) {
+                    // The tuple component dimension is innermost in storage.
+                    storage_permutation.push_back((int)op->bounds.size() - 1);
+                }
+                size_t base = storage_permutation.size();
                 for (size_t i = 0; i < storage_dims.size(); i++) {
                     for (size_t j = 0; j < args.size(); j++) {
                         if (args[j] == storage_dims[i].var) {
                             storage_permutation.push_back((int)j);
                         }
                     }
-                    internal_assert(storage_permutation.size() == i+1);
+                    internal_assert(storage_permutation.size() == base + i + 1);
                 }
             }
             internal_assert(storage_permutation.size() == op->bounds.size());
@@ -377,7 +491,15 @@ private:
             op->device_api == DeviceAPI::GLSL) {
             in_shader = true;
         }
+        int *gpu_depth = NULL;
+        if (op->for_type == ForType::GPUBlock) {
+            gpu_depth = &gpu_block_depth;
+        } else if (op->for_type == ForType::GPUThread) {
+            gpu_depth = &gpu_thread_depth;
+        }
+        if (gpu_depth) (*gpu_depth)++;
         Stmt stmt = IRMutator2::visit(op);
+        if (gpu_depth) (*gpu_depth)--;
         in_shader = old_in_shader;
         return stmt;
     }
@@ -443,7 +565,7 @@ Stmt storage_flattening(Stmt s,
     // all point to the function foo.
     map<string, pair<Function, int>> tuple_env;
     for (auto p : env) {
-        if (p.second.outputs() > 1) {
+        if (p.second.outputs() > 1 && !p.second.schedule().tuple_interleaved()) {
             for (int i = 0; i < p.second.outputs(); i++) {
                 tuple_env[p.first + "." + std::to_string(i)] = {p.second, i};
             }
@@ -426,7 +426,14 @@ class AttemptStorageFoldingOfFunction : public IRMutator {
                     const int max_fold = 1024;
                     const int64_t *const_max_extent = as_const_int(max_extent);
                     if (const_max_extent && *const_max_extent <= max_fold) {
-                        factor = static_cast<int>(next_power_of_two(*const_max_extent));
+                        int64_t extent_needed = *const_max_extent;
+                        if (func.schedule().async()) {
+                            // An async producer runs one fold ahead
+                            // of its consumer, so it needs slack to
+                            // work in beyond the consumer's window.
+                            extent_needed += 1;
+                        }
+                        factor = static_cast<int>(next_power_of_two(extent_needed));
                     } else {
                         debug(3) << "Not folding because extent not bounded by a constant not greater than " << max_fold << "\n"
                                  << "extent = " << extent << "\n"
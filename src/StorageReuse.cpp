@@ -0,0 +1,344 @@
+#include "StorageReuse.h"
+
+#include <algorithm>
+#include <limits>
+#include <set>
+
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+struct CandidateAllocation {
+    const Allocate *node;
+    // The statement interval over which this allocation is touched.
+    int first_use, last_use;
+    // The root-level lets visible at the allocation site. Another
+    // allocation can only absorb this one if this one's extents don't
+    // depend on lets bound below the other's position.
+    set<string> lets_in_scope;
+    // The root-level allocations whose bodies contain this one. We
+    // only reuse the storage of an allocation that encloses us, so
+    // that the shared symbol is in scope at all of our uses.
+    set<string> enclosing;
+};
+
+/** Walk the statements at the root of the pipeline in execution
+ * order, assigning them increasing times, and record the interval of
+ * times over which each root-level allocation is used. Loops and if
+ * statements are treated as a single atomic time step, so statements
+ * that may run in parallel (e.g. the task loops made by the async
+ * producer pass) share a time and thus always appear to overlap. */
+class FindRootAllocations : public IRVisitor {
+public:
+    map<string, CandidateAllocation> candidates;
+    vector<string> order;
+
+private:
+    using IRVisitor::visit;
+
+    int clock = 0;
+    bool at_root = true;
+    set<string> lets_in_scope;
+    set<string> enclosing;
+
+    // A use of "f.buffer" or "f.0.value" keeps the allocation "f" or
+    // "f.0" live, so strip trailing dotted suffixes when looking for
+    // the allocation a symbol refers to.
+    void record_use(const string &name) {
+        string key = name;
+        while (true) {
+            auto it = candidates.find(key);
+            if (it != candidates.end()) {
+                it->second.first_use = std::min(it->second.first_use, clock);
+                it->second.last_use = std::max(it->second.last_use, clock);
+                return;
+            }
+            size_t pos = key.rfind('.');
+            if (pos == string::npos) {
+                return;
+            }
+            key = key.substr(0, pos);
+        }
+    }
+
+    void visit(const Block *op) {
+        op->first.accept(this);
+        if (at_root) {
+            clock++;
+        }
+        op->rest.accept(this);
+    }
+
+    void visit(const For *op) {
+        op->min.accept(this);
+        op->extent.accept(this);
+        ScopedValue<bool> old_at_root(at_root, false);
+        op->body.accept(this);
+    }
+
+    void visit(const IfThenElse *op) {
+        op->condition.accept(this);
+        ScopedValue<bool> old_at_root(at_root, false);
+        op->then_case.accept(this);
+        if (op->else_case.defined()) {
+            op->else_case.accept(this);
+        }
+    }
+
+    void visit(const LetStmt *op) {
+        if (!at_root) {
+            IRVisitor::visit(op);
+            return;
+        }
+        op->value.accept(this);
+        lets_in_scope.insert(op->name);
+        op->body.accept(this);
+        lets_in_scope.erase(op->name);
+    }
+
+    void visit(const Allocate *op) {
+        for (const Expr &e : op->extents) {
+            e.accept(this);
+        }
+        op->condition.accept(this);
+        if (op->new_expr.defined()) {
+            op->new_expr.accept(this);
+        }
+
+        bool candidate = at_root &&
+            is_one(op->condition) &&
+            !op->new_expr.defined() &&
+            op->free_function.empty() &&
+            (op->memory_type == MemoryType::Auto ||
+             op->memory_type == MemoryType::Heap);
+        if (candidate) {
+            CandidateAllocation c;
+            c.node = op;
+            c.first_use = std::numeric_limits<int>::max();
+            c.last_use = -1;
+            c.lets_in_scope = lets_in_scope;
+            c.enclosing = enclosing;
+            candidates[op->name] = c;
+            order.push_back(op->name);
+            enclosing.insert(op->name);
+            op->body.accept(this);
+            enclosing.erase(op->name);
+        } else {
+            op->body.accept(this);
+        }
+    }
+
+    void visit(const Variable *op) {
+        record_use(op->name);
+    }
+
+    void visit(const Load *op) {
+        record_use(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Store *op) {
+        record_use(op->name);
+        IRVisitor::visit(op);
+    }
+};
+
+class CollectVariables : public IRVisitor {
+public:
+    set<string> vars;
+
+private:
+    using IRVisitor::visit;
+
+    void visit(const Variable *op) {
+        vars.insert(op->name);
+    }
+};
+
+Expr allocation_size(const Allocate *op) {
+    Expr size;
+    for (const Expr &e : op->extents) {
+        size = size.defined() ? size * e : e;
+    }
+    if (!size.defined()) {
+        size = 1;
+    }
+    return size;
+}
+
+class ReuseAllocations : public IRMutator2 {
+public:
+    ReuseAllocations(const map<string, string> &r, const map<string, Expr> &a)
+        : replacements(r), arena_extents(a) {}
+
+private:
+    const map<string, string> &replacements;
+    const map<string, Expr> &arena_extents;
+
+    using IRMutator2::visit;
+
+    Stmt visit(const Allocate *op) override {
+        if (replacements.count(op->name)) {
+            // This allocation now lives inside the one it replaces.
+            return mutate(op->body);
+        }
+        auto arena = arena_extents.find(op->name);
+        if (arena != arena_extents.end()) {
+            return Allocate::make(op->name, op->type, op->memory_type,
+                                  {arena->second}, mutate(op->condition),
+                                  mutate(op->body));
+        }
+        return IRMutator2::visit(op);
+    }
+
+    Expr visit(const Load *op) override {
+        auto it = replacements.find(op->name);
+        if (it != replacements.end()) {
+            return Load::make(op->type, it->second, mutate(op->index),
+                              op->image, op->param, mutate(op->predicate));
+        }
+        return IRMutator2::visit(op);
+    }
+
+    Stmt visit(const Store *op) override {
+        auto it = replacements.find(op->name);
+        if (it != replacements.end()) {
+            return Store::make(it->second, mutate(op->value), mutate(op->index),
+                               op->param, mutate(op->predicate));
+        }
+        return IRMutator2::visit(op);
+    }
+
+    Expr visit(const Variable *op) override {
+        auto it = replacements.find(op->name);
+        if (it != replacements.end()) {
+            return Variable::make(op->type, it->second);
+        }
+        return op;
+    }
+};
+
+}  // namespace
+
+Stmt storage_reuse(Stmt s, const map<string, Function> &env) {
+    FindRootAllocations finder;
+    s.accept(&finder);
+
+    // Memoized funcs keep their own allocations, because the
+    // memoization runtime identifies them by name and rewrites their
+    // allocation nodes later in lowering.
+    auto is_memoized = [&](const string &name) {
+        string key = name;
+        while (true) {
+            auto it = env.find(key);
+            if (it != env.end()) {
+                return it->second.schedule().memoized();
+            }
+            size_t pos = key.rfind('.');
+            if (pos == string::npos) {
+                return false;
+            }
+            key = key.substr(0, pos);
+        }
+    };
+
+    vector<const CandidateAllocation *> candidates;
+    for (const string &name : finder.order) {
+        const CandidateAllocation &c = finder.candidates[name];
+        if (c.last_use < c.first_use) {
+            // Never used. Leave it for dead code elimination.
+            continue;
+        }
+        if (is_memoized(name)) {
+            continue;
+        }
+        candidates.push_back(&c);
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const CandidateAllocation *a, const CandidateAllocation *b) {
+                         return a->first_use < b->first_use;
+                     });
+
+    // Greedily assign each allocation to the first existing slot
+    // whose members are all dead by the time it becomes live.
+    struct Slot {
+        const CandidateAllocation *anchor;
+        int last_use;
+        vector<const CandidateAllocation *> members;
+    };
+    vector<Slot> slots;
+    for (const CandidateAllocation *c : candidates) {
+        CollectVariables extent_vars;
+        for (const Expr &e : c->node->extents) {
+            e.accept(&extent_vars);
+        }
+        Slot *home = nullptr;
+        for (Slot &slot : slots) {
+            if (slot.last_use >= c->first_use) {
+                continue;
+            }
+            if (slot.anchor->node->type != c->node->type) {
+                continue;
+            }
+            if (!c->enclosing.count(slot.anchor->node->name)) {
+                continue;
+            }
+            // The combined size is computed at the anchor, so this
+            // allocation's extents must not depend on lets bound
+            // below the anchor's position.
+            bool scope_ok = true;
+            for (const string &v : extent_vars.vars) {
+                if (c->lets_in_scope.count(v) &&
+                    !slot.anchor->lets_in_scope.count(v)) {
+                    scope_ok = false;
+                    break;
+                }
+            }
+            if (!scope_ok) {
+                continue;
+            }
+            home = &slot;
+            break;
+        }
+        if (home) {
+            home->members.push_back(c);
+            home->last_use = c->last_use;
+        } else {
+            slots.push_back({c, c->last_use, {}});
+        }
+    }
+
+    map<string, string> replacements;
+    map<string, Expr> arena_extents;
+    for (const Slot &slot : slots) {
+        if (slot.members.empty()) {
+            continue;
+        }
+        Expr arena = allocation_size(slot.anchor->node);
+        for (const CandidateAllocation *m : slot.members) {
+            arena = max(arena, allocation_size(m->node));
+            replacements[m->node->name] = slot.anchor->node->name;
+        }
+        arena_extents[slot.anchor->node->name] = arena;
+    }
+
+    if (replacements.empty()) {
+        return s;
+    }
+
+    return ReuseAllocations(replacements, arena_extents).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
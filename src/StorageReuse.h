@@ -0,0 +1,28 @@
+#ifndef HALIDE_STORAGE_REUSE_H
+#define HALIDE_STORAGE_REUSE_H
+
+/** \file
+ * Defines the lowering optimization pass that reuses the storage of
+ * root-level allocations with non-overlapping lifetimes.
+ */
+
+#include <map>
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Reduce the peak memory footprint of a pipeline by sharing
+ * allocations between root-level intermediates whose live ranges do
+ * not overlap. Each allocation is live from the first statement that
+ * touches it to the last; allocations of the same type that are used
+ * over disjoint spans of the pipeline are assigned to a single
+ * allocation sized for the largest member. Runs after storage
+ * flattening, when allocation sizes are directly comparable. */
+Stmt storage_reuse(Stmt s, const std::map<std::string, Function> &env);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
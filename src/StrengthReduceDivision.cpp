@@ -0,0 +1,192 @@
+#include "StrengthReduceDivision.h"
+
+#include "ExprUsesVar.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Scope.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+
+namespace {
+
+// Is this expression cheap enough to hoist and evaluate once per
+// loop? Mirrors the conditions the LICM pass uses to decide whether
+// an expression can be lifted.
+class IsHoistable : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Call *op) {
+        if (!op->is_pure()) {
+            result = false;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+    void visit(const Load *op) {
+        result = false;
+    }
+
+public:
+    bool result = true;
+};
+
+class StrengthReduceDivision : public IRMutator2 {
+    using IRMutator2::visit;
+
+    int loop_depth = 0;
+    bool in_opengl = false;
+
+    // Variables bound inside some enclosing loop. A denominator that
+    // uses one of these varies with the loop, so there's nowhere to
+    // hoist its magic number to.
+    Scope<int> varying;
+
+    bool should_reduce(const Type &t, const Expr &den) {
+        if (loop_depth == 0 || in_opengl) {
+            return false;
+        }
+        if (!t.is_scalar() ||
+            !(t.is_int() || t.is_uint()) ||
+            t.bits() > 32) {
+            // The magic number computation needs a type twice as wide.
+            return false;
+        }
+        if (is_const(den)) {
+            // Codegen has better lowerings for constant denominators.
+            return false;
+        }
+        if (expr_uses_vars(den, varying)) {
+            return false;
+        }
+        IsHoistable hoistable;
+        den.accept(&hoistable);
+        return hoistable.result;
+    }
+
+    // The quotient of two unsigned expressions of the same type,
+    // computed with the round-up variant of the multiply-and-shift
+    // method from "Division by Invariant Integers using
+    // Multiplication" (Granlund and Montgomery, 1994), which is exact
+    // for all denominators from two up. The subexpressions that only
+    // depend on the denominator are what LICM later hoists.
+    Expr unsigned_div(const Expr &num, const Expr &den) {
+        Type t = num.type();
+        Type wide = t.with_bits(t.bits() * 2);
+
+        // Denominators of zero or one are handled by the caller, so
+        // clamping to two here only changes cases that are either
+        // selected away or undefined.
+        Expr d = max(den, make_const(t, 2));
+        Expr log2_d = make_const(t, t.bits()) - count_leading_zeros(d - 1);
+        Expr wide_d = cast(wide, d);
+        Expr magic =
+            cast(t, ((cast(wide, 1) << log2_d) - wide_d) * make_const(wide, (int64_t)1 << t.bits()) / wide_d + 1);
+        Expr shift = log2_d - 1;
+
+        Expr hi = cast(t, (cast(wide, magic) * num) / make_const(wide, (int64_t)1 << t.bits()));
+        return (hi + ((num - hi) >> 1)) >> shift;
+    }
+
+    Expr make_division(const Expr &num, const Expr &den) {
+        Type t = num.type();
+
+        if (t.is_uint()) {
+            return select(den == 1, num, unsigned_div(num, den));
+        }
+
+        // Signed division rounds towards negative infinity, and the
+        // denominator may be negative. Flipping the bits of a
+        // negative value maps floor division onto unsigned division:
+        // floor(n / d) == ~(~n / d) for positive d. A negative
+        // denominator then just negates the quotient.
+        Type ut = t.with_code(Type::UInt);
+        Expr dsign = den >> (t.bits() - 1);
+        Expr dabs = cast(ut, (den ^ dsign) - dsign);
+
+        string xsign_name = unique_name('t');
+        Expr xsign = Variable::make(t, xsign_name);
+        string unum_name = unique_name('t');
+        Expr unum = Variable::make(ut, unum_name);
+
+        Expr q = xsign ^ cast(t, unsigned_div(unum, dabs));
+        q = (q ^ dsign) - dsign;
+
+        // A denominator of +/-1 passes the numerator through with
+        // the denominator's sign.
+        q = select(dabs == 1, (num ^ dsign) - dsign, q);
+
+        q = Let::make(unum_name, cast(ut, xsign ^ num), q);
+        q = Let::make(xsign_name, num >> (t.bits() - 1), q);
+        return q;
+    }
+
+    Expr visit(const Div *op) override {
+        Expr num = mutate(op->a);
+        Expr den = mutate(op->b);
+        if (!should_reduce(op->type, den)) {
+            if (num.same_as(op->a) && den.same_as(op->b)) {
+                return op;
+            }
+            return Div::make(num, den);
+        }
+
+        string num_name = unique_name('t');
+        Expr num_var = Variable::make(op->type, num_name);
+        return Let::make(num_name, num, make_division(num_var, den));
+    }
+
+    Expr visit(const Mod *op) override {
+        Expr num = mutate(op->a);
+        Expr den = mutate(op->b);
+        if (!should_reduce(op->type, den)) {
+            if (num.same_as(op->a) && den.same_as(op->b)) {
+                return op;
+            }
+            return Mod::make(num, den);
+        }
+
+        string num_name = unique_name('t');
+        Expr num_var = Variable::make(op->type, num_name);
+        // a % b == a - (a / b) * b, which also yields the
+        // always-non-negative remainder for signed types.
+        Expr result = num_var - make_division(num_var, den) * den;
+        return Let::make(num_name, num, result);
+    }
+
+    Stmt visit(const For *op) override {
+        ScopedValue<bool> old_in_opengl(
+            in_opengl,
+            in_opengl ||
+                op->device_api == DeviceAPI::GLSL ||
+                op->device_api == DeviceAPI::OpenGLCompute);
+        loop_depth++;
+        ScopedBinding<int> bind(varying, op->name, 0);
+        Stmt stmt = IRMutator2::visit(op);
+        loop_depth--;
+        return stmt;
+    }
+
+    Expr visit(const Let *op) override {
+        ScopedBinding<int> bind(loop_depth > 0, varying, op->name, 0);
+        return IRMutator2::visit(op);
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        ScopedBinding<int> bind(loop_depth > 0, varying, op->name, 0);
+        return IRMutator2::visit(op);
+    }
+};
+
+}  // namespace
+
+Stmt strength_reduce_division(Stmt s) {
+    return StrengthReduceDivision().mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
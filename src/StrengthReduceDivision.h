@@ -0,0 +1,28 @@
+#ifndef HALIDE_STRENGTH_REDUCE_DIVISION_H
+#define HALIDE_STRENGTH_REDUCE_DIVISION_H
+
+/** \file
+ * Defines a lowering pass that replaces integer division by
+ * loop-invariant denominators with multiply-and-shift sequences.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Rewrite integer divisions and mods inside loops whose denominator
+ * is unknown at compile time but invariant across the loop
+ * (e.g. a Param) into a multiply-keep-high-half and shift using a
+ * magic number computed from the denominator. The magic number
+ * computation is a pure function of the denominator, so the loop
+ * invariant code motion pass hoists it out of the loop, leaving only
+ * cheap vectorizable ops per element. Divisions by compile-time
+ * constants are left alone; codegen already lowers those using the
+ * tables in IntegerDivisionTable.h. */
+Stmt strength_reduce_division(Stmt s);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -68,7 +68,10 @@ bool strictify_float(std::map<std::string, Function> &env, const Target &t) {
         Function &func = iter.second;
 
         StrictifyFloat::StrictnessMode mode = StrictifyFloat::Allowed;
-        if (t.has_feature(Target::StrictFloat)) {
+        if (t.has_feature(Target::StrictFloat) ||
+            func.schedule().strict_float()) {
+            // Either the whole pipeline is strict, or this Func was
+            // scheduled with Func::strict_float().
             mode = StrictifyFloat::Forced;
         }
         // TODO(zalman): Some targets don't allow strict float and we can provide errors for these.
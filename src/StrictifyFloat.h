@@ -17,7 +17,9 @@ namespace Internal {
  * all floating-point expressions. This makes the IR nodes context
  * independent.  If the Target::StrictFloat flag is specified in
  * target, starts in strict_float mode so all floating-point type
- * Exprs in the compilation will be marked with strict_float. Returns
+ * Exprs in the compilation will be marked with strict_float. The same
+ * is done per-function for any Func scheduled with
+ * Func::strict_float(). Returns
  * whether any strict floating-point is used in any function in the
  * passed in env.
  */
@@ -97,11 +97,13 @@ Stmt substitute(const string &name, const Expr &replacement, const Stmt &stmt) {
 }
 
 Expr substitute(const map<string, Expr> &m, const Expr &expr) {
+    if (m.empty()) return expr;
     Substitute s(m);
     return s.mutate(expr);
 }
 
 Stmt substitute(const map<string, Expr> &m, const Stmt &stmt) {
+    if (m.empty()) return stmt;
     Substitute s(m);
     return s.mutate(stmt);
 }
@@ -72,6 +72,9 @@ Target calculate_host_target() {
 #if __mips__ || __mips || __MIPS__
     Target::Arch arch = Target::MIPS;
 #else
+#if defined(__riscv)
+    Target::Arch arch = Target::RISCV;
+#else
 #if defined(__arm__) || defined(__aarch64__)
     Target::Arch arch = Target::ARM;
 #else
@@ -158,6 +161,7 @@ Target calculate_host_target() {
 
 #endif
 #endif
+#endif
 #endif
 
     return Target(os, arch, bits, initial_features);
@@ -203,6 +207,7 @@ const std::map<std::string, Target::Arch> arch_name_map = {
     {"mips", Target::MIPS},
     {"powerpc", Target::POWERPC},
     {"hexagon", Target::Hexagon},
+    {"riscv", Target::RISCV},
 };
 
 bool lookup_arch(const std::string &tok, Target::Arch &result) {
@@ -268,6 +273,13 @@ const std::map<std::string, Target::Feature> feature_name_map = {
     {"legacy_buffer_wrappers", Target::LegacyBufferWrappers},
     {"tsan", Target::TSAN},
     {"asan", Target::ASAN},
+    {"arm_dot_prod", Target::ARMDotProd},
+    {"arm_fp16", Target::ARMFp16},
+    {"parallel_roots", Target::ParallelRoots},
+    {"managed_memory", Target::ManagedMemory},
+    {"unchecked_entry", Target::UncheckedEntry},
+    {"rvv", Target::RVV},
+    {"sve", Target::SVE},
     // NOTE: When adding features to this map, be sure to update
     // PyEnums.cpp and halide.cmake as well.
 };
@@ -499,6 +511,9 @@ bool Target::supported() const {
 #if !defined(WITH_MIPS)
     bad |= arch == Target::MIPS;
 #endif
+#if !defined(WITH_RISCV)
+    bad |= arch == Target::RISCV;
+#endif
 #if !defined(WITH_POWERPC)
     bad |= arch == Target::POWERPC;
 #endif
@@ -27,7 +27,7 @@ struct Target {
     /** The architecture used by the target. Determines the
      * instruction set to use.
      * Corresponds to arch_name_map in Target.cpp. */
-    enum Arch {ArchUnknown = 0, X86, ARM, MIPS, Hexagon, POWERPC} arch;
+    enum Arch {ArchUnknown = 0, X86, ARM, MIPS, Hexagon, POWERPC, RISCV} arch;
 
     /** The bit-width of the target machine. Must be 0 for unknown, or 32 or 64. */
     int bits;
@@ -90,6 +90,13 @@ struct Target {
         LegacyBufferWrappers = halide_target_feature_legacy_buffer_wrappers,
         TSAN = halide_target_feature_tsan,
         ASAN = halide_target_feature_asan,
+        ARMDotProd = halide_target_feature_arm_dot_prod,
+        ARMFp16 = halide_target_feature_arm_fp16,
+        ParallelRoots = halide_target_feature_parallel_roots,
+        ManagedMemory = halide_target_feature_managed_memory,
+        UncheckedEntry = halide_target_feature_unchecked_entry,
+        RVV = halide_target_feature_rvv,
+        SVE = halide_target_feature_sve,
         FeatureEnd = halide_target_feature_end
     };
     Target() : os(OSUnknown), arch(ArchUnknown), bits(0) {}
@@ -281,6 +288,11 @@ struct Target {
                 // SSE was all 128-bit. We ignore MMX.
                 return 16 / data_size;
             }
+        } else if (arch == Target::ARM && bits == 64 &&
+                   has_feature(Halide::Target::SVE)) {
+            // We generate code for the 256-bit vector length SVE
+            // implementations we ship on.
+            return 32 / data_size;
         } else {
             // Assume 128-bit vectors on other targets.
             return 16 / data_size;
@@ -275,6 +275,7 @@ struct Type {
     static const halide_type_code_t UInt = halide_type_uint;
     static const halide_type_code_t Float = halide_type_float;
     static const halide_type_code_t Handle = halide_type_handle;
+    static const halide_type_code_t BFloat = halide_type_bfloat;
     // @}
 
     /** The number of bytes required to store a single scalar value of this type. Ignores vector lanes. */
@@ -349,6 +350,12 @@ struct Type {
     /** Is this type a floating point type (float or double). */
     bool is_float() const {return code() == Float;}
 
+    /** Is this type a bfloat type (truncated IEEE float32)? Note that
+     * is_float() is deliberately false for bfloat: it is a
+     * storage-only type, and none of the paths that assume IEEE
+     * arithmetic apply to it. */
+    bool is_bfloat() const {return code() == BFloat;}
+
     /** Is this type a signed integer type? */
     bool is_int() const {return code() == Int;}
 
@@ -429,6 +436,14 @@ inline Type Float(int bits, int lanes = 1) {
     return Type(Type::Float, bits, lanes);
 }
 
+/** Construct a bfloat type: the top 16 bits of an IEEE float32, giving
+ * float32 range at half the memory traffic. This is a storage-only
+ * type: it supports casts to and from Float(32) but not arithmetic, so
+ * compute in Float(32) and cast the result for storage. */
+inline Type BFloat(int bits, int lanes = 1) {
+    return Type(Type::BFloat, bits, lanes);
+}
+
 /** Construct a boolean type */
 inline Type Bool(int lanes = 1) {
     return UInt(1, lanes);
@@ -1,6 +1,7 @@
 #include "UnrollLoops.h"
 #include "IRMutator.h"
 #include "IROperator.h"
+#include "IRVisitor.h"
 #include "Simplify.h"
 #include "Substitute.h"
 
@@ -9,7 +10,79 @@ using std::vector;
 namespace Halide {
 namespace Internal {
 
+namespace {
+
+// A rough guess at the number of vector registers the target's
+// register allocator has to play with. This doesn't need to be
+// exact; it only feeds the over-unrolling warning below.
+int estimated_vector_registers(const Target &t) {
+    switch (t.arch) {
+    case Target::X86:
+        if (t.bits == 32) return 8;
+        if (t.has_feature(Target::AVX512)) return 32;
+        return 16;
+    case Target::ARM:
+        return 32;
+    case Target::MIPS:
+        return 32;
+    case Target::POWERPC:
+        return t.has_feature(Target::VSX) ? 64 : 32;
+    case Target::Hexagon:
+        return 32;
+    default:
+        return 16;
+    }
+}
+
+// Count the values in one copy of an unrolled body that will want a
+// vector register: loads and lets inside vectorized loops (which
+// become vector values once the vectorizer runs), plus values that
+// are already of vector type.
+class CountVectorValues : public IRVisitor {
+    using IRVisitor::visit;
+
+    int vectorized_depth = 0;
+
+    void visit(const For *op) override {
+        if (op->for_type == ForType::Vectorized) {
+            vectorized_depth++;
+            IRVisitor::visit(op);
+            vectorized_depth--;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+    void visit(const Load *op) override {
+        IRVisitor::visit(op);
+        if (vectorized_depth > 0 || op->type.is_vector()) {
+            count++;
+        }
+    }
+
+    void visit(const Let *op) override {
+        IRVisitor::visit(op);
+        if (vectorized_depth > 0 || op->value.type().is_vector()) {
+            count++;
+        }
+    }
+
+    void visit(const LetStmt *op) override {
+        IRVisitor::visit(op);
+        if (vectorized_depth > 0 || op->value.type().is_vector()) {
+            count++;
+        }
+    }
+
+public:
+    int count = 0;
+};
+
+}  // namespace
+
 class UnrollLoops : public IRMutator2 {
+    const Target &target;
+
     using IRMutator2::visit;
 
     Stmt visit(const For *for_loop) override {
@@ -26,6 +99,25 @@ class UnrollLoops : public IRMutator2 {
                 user_warning << "Warning: Unrolling a for loop of extent 1: " << for_loop->name << "\n";
             }
 
+            // Warn when the unrolled block wants more vector
+            // registers than the target has. The count is a rough
+            // per-copy estimate, but schedules it fires on almost
+            // always spill.
+            CountVectorValues pressure;
+            body.accept(&pressure);
+            if (pressure.count > 0) {
+                int registers = estimated_vector_registers(target);
+                if (e->value * pressure.count > registers) {
+                    user_warning << "Warning: Unrolling " << for_loop->name
+                                 << " by " << e->value << " produces roughly "
+                                 << e->value * pressure.count
+                                 << " live vector values, but the target has about "
+                                 << registers << " vector registers. "
+                                 << "The register allocator is likely to spill; "
+                                 << "consider a smaller unroll factor.\n";
+                }
+            }
+
             vector<Stmt> iters;
             // Make n copies of the body, each wrapped in a let that defines the loop var for that body
             for (int i = 0; i < e->value; i++) {
@@ -37,10 +129,13 @@ class UnrollLoops : public IRMutator2 {
             return IRMutator2::visit(for_loop);
         }
     }
+
+public:
+    UnrollLoops(const Target &t) : target(t) {}
 };
 
-Stmt unroll_loops(Stmt s) {
-    return UnrollLoops().mutate(s);
+Stmt unroll_loops(Stmt s, const Target &t) {
+    return UnrollLoops(t).mutate(s);
 }
 
 }  // namespace Internal
@@ -6,14 +6,16 @@
  */
 
 #include "IR.h"
+#include "Target.h"
 
 namespace Halide {
 namespace Internal {
 
 /** Take a statement with for loops marked for unrolling, and convert
  * each into several copies of the innermost statement. I.e. unroll
- * the loop. */
-Stmt unroll_loops(Stmt);
+ * the loop. The target is used to warn when the unrolled block is
+ * unlikely to fit in the target's vector register file. */
+Stmt unroll_loops(Stmt, const Target &t);
 
 }  // namespace Internal
 }  // namespace Halide
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <set>
 
 #include "CSE.h"
 #include "CodeGen_GPU_Dev.h"
@@ -249,6 +250,23 @@ class PredicateLoadStore : public IRMutator2 {
                 << "We are inside a hexagon loop, but the target doesn't have hexagon's features\n";
             return true;
         } else if (target.arch == Target::X86) {
+            if (target.features_any_of({Target::AVX512_Skylake, Target::AVX512_Cannonlake})) {
+                // AVX512BW+VL has mask registers for every element
+                // width at every vector length, so predicated tails
+                // stay vectorized instead of scalarizing.
+                return lanes >= 2;
+            }
+            if (target.has_feature(Target::AVX512) ||
+                target.has_feature(Target::AVX512_KNL)) {
+                // AVX512F masks cover 32- and 64-bit elements.
+                return (bit_size == 32 || bit_size == 64) && (lanes >= 2);
+            }
+            if (target.has_feature(Target::AVX2)) {
+                // AVX2 has maskload/maskstore for 32- and 64-bit
+                // elements.
+                return (bit_size == 32 && lanes >= 4) ||
+                       (bit_size == 64 && lanes >= 2);
+            }
             // Should only attempt to predicate store/load if the lane size is
             // no less than 4
             return (bit_size == 32) && (lanes >= 4);
@@ -343,6 +361,124 @@ public:
     }
 };
 
+// Does the condition have the shape that BoxesTouched in Bounds.cpp
+// understands well enough to trim the region touched by a guarded
+// statement (a comparison against a plain variable, possibly wrapped
+// in a likely)?
+bool trims_bounds_directly(const Expr &condition) {
+    Expr c = condition;
+    const Call *call = c.as<Call>();
+    if (call && (call->is_intrinsic(Call::likely) ||
+                 call->is_intrinsic(Call::likely_if_innermost) ||
+                 call->is_intrinsic(Call::strict_float))) {
+        c = call->args[0];
+    }
+    Expr a, b;
+    if (const LT *lt = c.as<LT>()) {
+        a = lt->a; b = lt->b;
+    } else if (const LE *le = c.as<LE>()) {
+        a = le->a; b = le->b;
+    } else if (const GT *gt = c.as<GT>()) {
+        a = gt->a; b = gt->b;
+    } else if (const GE *ge = c.as<GE>()) {
+        a = ge->a; b = ge->b;
+    } else if (const EQ *eq = c.as<EQ>()) {
+        a = eq->a; b = eq->b;
+    }
+    return (a.defined() &&
+            (a.as<Variable>() != nullptr || b.as<Variable>() != nullptr));
+}
+
+// May bounds inference have used the condition to trim the region
+// touched by a guarded statement? If so, the regions allocated or
+// checked for the loads and stores inside the guard may not cover the
+// iterations where the condition is false, so they must not be
+// touched speculatively. Before boxes_touched applies the shape test
+// above, it canonicalizes each if condition with solve_expression for
+// the innermost enclosing loop variable (SolveIfThenElse in
+// Bounds.cpp), so e.g. r + x < 50 trims just as r < 50 - x does. We
+// don't know here which enclosing variables were loop variables at
+// that point, so mirror the canonicalization for every free variable
+// in the condition, which can only over-approximate the set of
+// conditions that trimmed.
+bool may_trim_bounds(const Expr &condition) {
+    if (trims_bounds_directly(condition)) {
+        return true;
+    }
+
+    class FindFreeVars : public IRVisitor {
+        using IRVisitor::visit;
+        void visit(const Variable *op) override {
+            vars.insert(op->name);
+        }
+    public:
+        std::set<string> vars;
+    } free_vars;
+    condition.accept(&free_vars);
+
+    for (const string &v : free_vars.vars) {
+        Expr solved = solve_expression(condition, v).result;
+        if (solved.defined() && trims_bounds_directly(solved)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Rewrite the stores in a Stmt to blend against the old value at the
+// store site: store(select(pred, value, load())) with no predicate.
+// This keeps a guarded reduction (e.g. an RDom::where clause)
+// vectorized on targets with no masked loads and stores, at the cost
+// of a read-modify-write of the lanes the guard disables. Only valid
+// when every location stored to may be speculatively read and
+// written, which holds for the stores in a vectorized loop body:
+// bounds inference covers the store index regardless of any guards
+// around it. Note that unlike a true masked store, the blend writes
+// to the disabled lanes, so it must not be used where another thread
+// may own them; stores in a vectorized loop never share a vector
+// with another thread.
+class MaskStoresWithBlend : public IRMutator2 {
+    Expr vector_predicate;
+    int lanes;
+    bool valid;
+    bool masked;
+
+    using IRMutator2::visit;
+
+    Stmt visit(const Store *op) override {
+        // A store that is already predicated, or that doesn't span
+        // the lanes of the guard, is not something we can blend.
+        if (!is_one(op->predicate) ||
+            op->value.type().lanes() != lanes) {
+            valid = false;
+            return op;
+        }
+        Expr old_value = Load::make(op->value.type(), op->name, op->index,
+                                    Buffer<>(), op->param,
+                                    const_true(lanes));
+        Expr value = Select::make(vector_predicate, op->value, old_value);
+        masked = true;
+        return Store::make(op->name, value, op->index, op->param, op->predicate);
+    }
+
+    Expr visit(const Call *op) override {
+        // We should not vectorize calls with side-effects
+        valid = valid && op->is_pure();
+        return IRMutator2::visit(op);
+    }
+
+public:
+    MaskStoresWithBlend(Expr vpred) :
+            vector_predicate(vpred), lanes(vpred.type().lanes()),
+            valid(true), masked(false) {
+        internal_assert(lanes > 1);
+    }
+
+    bool is_masked() const {
+        return valid && masked;
+    }
+};
+
 // Substitutes a vector for a scalar var in a Stmt. Used on the
 // body of every vectorized loop.
 class VectorSubs : public IRMutator2 {
@@ -729,6 +865,29 @@ class VectorSubs : public IRMutator2 {
                 vectorize_predicate = p.is_vectorized();
             }
 
+            // If the target has no masked loads and stores, we can
+            // still keep the body vectorized by blending each store
+            // against the old value at the store site instead of
+            // scalarizing. When there's no else case, bounds
+            // inference may have used the condition to trim the
+            // regions the body touches, in which case the blend's
+            // speculative accesses could fall outside them.
+            if (!vectorize_predicate && !uses_gpu_vars(cond) &&
+                (else_case.defined() || !may_trim_bounds(op->condition))) {
+                MaskStoresWithBlend m(cond);
+                Stmt masked_stmt = m.mutate(then_case);
+                bool mask_ok = m.is_masked();
+                if (mask_ok && else_case.defined()) {
+                    MaskStoresWithBlend m2(!cond);
+                    masked_stmt = Block::make(masked_stmt, m2.mutate(else_case));
+                    mask_ok = m2.is_masked();
+                }
+                if (mask_ok) {
+                    predicated_stmt = masked_stmt;
+                    vectorize_predicate = true;
+                }
+            }
+
             debug(4) << "IfThenElse should vectorize predicate over var " << var << "? " << vectorize_predicate << "; cond: " << cond << "\n";
             debug(4) << "Predicated stmt:\n" << predicated_stmt << "\n";
 
@@ -61,9 +61,14 @@ struct AllInts<double, Args...> : std::false_type {};
 struct AllocationHeader {
     void (*deallocate_fn)(void *);
     std::atomic<int> ref_count;
+    // The number of usable bytes following the (aligned) start of the
+    // allocation. Used to decide whether the allocation can be reused
+    // for a new shape without going back to the allocator.
+    size_t size;
 
     // Note that ref_count always starts at 1
-    AllocationHeader(void (*deallocate_fn)(void *)) : deallocate_fn(deallocate_fn), ref_count(1) {}
+    AllocationHeader(void (*deallocate_fn)(void *), size_t size)
+        : deallocate_fn(deallocate_fn), ref_count(1), size(size) {}
 };
 
 /** This indicates how to deallocate the device for a Halide::Runtime::Buffer. */
@@ -83,6 +88,100 @@ struct DeviceRefCount {
     BufferDeviceOwnership ownership{BufferDeviceOwnership::Allocated};
 };
 
+namespace Internal {
+// The process-wide allocator hooks used by Buffers that allocate
+// their own host memory. Function-local statics so that this
+// header-only class has exactly one copy of each per process.
+inline void *(*&default_allocate_fn())(size_t) {
+    static void *(*fn)(size_t) = nullptr;
+    return fn;
+}
+inline void (*&default_deallocate_fn())(void *) {
+    static void (*fn)(void *) = nullptr;
+    return fn;
+}
+
+/** A thread-local freelist that recycles the heap arrays used for
+ * shape metadata when a Buffer's dimensionality exceeds its inline
+ * capacity D. Code that churns through high-dimensional Buffers would
+ * otherwise hit the allocator once per Buffer constructed and once per
+ * Buffer destroyed. Freed arrays store the freelist node in their own
+ * memory and are kept per-thread, so no locking is needed. The list is
+ * capped at a small length; anything beyond that goes back to the
+ * heap. */
+struct ShapeStorageFreeListNode {
+    ShapeStorageFreeListNode *next;
+    int capacity;
+};
+
+struct ShapeStorageFreeList {
+    ShapeStorageFreeListNode *head = nullptr;
+    int entries = 0;
+
+    ~ShapeStorageFreeList() {
+        while (head) {
+            ShapeStorageFreeListNode *node = head;
+            head = node->next;
+            delete[] (halide_dimension_t *)node;
+        }
+    }
+};
+
+inline ShapeStorageFreeList &shape_storage_free_list() {
+    static thread_local ShapeStorageFreeList list;
+    return list;
+}
+
+inline halide_dimension_t *allocate_shape_storage(int dimensions) {
+    static_assert(sizeof(halide_dimension_t) >= sizeof(ShapeStorageFreeListNode),
+                  "Freed shape storage must be large enough to hold a freelist node");
+    ShapeStorageFreeList &list = shape_storage_free_list();
+    for (ShapeStorageFreeListNode **prev = &list.head; *prev; prev = &(*prev)->next) {
+        ShapeStorageFreeListNode *node = *prev;
+        if (node->capacity >= dimensions) {
+            *prev = node->next;
+            list.entries--;
+            return (halide_dimension_t *)node;
+        }
+    }
+    return new halide_dimension_t[dimensions];
+}
+
+inline void release_shape_storage(halide_dimension_t *storage, int dimensions) {
+    if (!storage) {
+        return;
+    }
+    ShapeStorageFreeList &list = shape_storage_free_list();
+    if (list.entries >= 16) {
+        delete[] storage;
+        return;
+    }
+    // The capacity recorded here may understate the array's true size
+    // if the Buffer's dimensionality shrank (e.g. via slice) after the
+    // storage was made, which is harmless.
+    ShapeStorageFreeListNode *node = (ShapeStorageFreeListNode *)storage;
+    node->next = list.head;
+    node->capacity = dimensions;
+    list.head = node;
+    list.entries++;
+}
+}  // namespace Internal
+
+/** Override the allocator used by Buffers that allocate their own
+ * host memory and were not given an explicit allocator, e.g. with
+ * halide_cuda_host_malloc/halide_cuda_host_free from
+ * HalideRuntimeCuda.h to get pinned pages that the CUDA driver can
+ * DMA to and from directly instead of staging every copy. Each
+ * allocation remembers the deallocator that was current when it was
+ * made, so it is safe to change the hooks while Buffers are
+ * live. Pass nullptr for both to return to malloc/free. Not
+ * thread-safe with respect to concurrent Buffer allocations. */
+inline void set_default_allocate_fns(void *(*allocate_fn)(size_t),
+                                     void (*deallocate_fn)(void *)) {
+    Internal::default_allocate_fn() = allocate_fn;
+    Internal::default_deallocate_fn() = deallocate_fn;
+}
+
 /** A templated Buffer class that wraps halide_buffer_t and adds
  * functionality. When using Halide from C++, this is the preferred
  * way to create input and output buffers. The overhead of using this
@@ -240,7 +339,7 @@ private:
 
     void free_shape_storage() {
         if (buf.dim != shape) {
-            delete[] buf.dim;
+            Internal::release_shape_storage(buf.dim, buf.dimensions);
             buf.dim = nullptr;
         }
     }
@@ -249,7 +348,7 @@ private:
         if (buf.dimensions <= D) {
             buf.dim = shape;
         } else {
-            buf.dim = new halide_dimension_t[buf.dimensions];
+            buf.dim = Internal::allocate_shape_storage(buf.dimensions);
         }
     }
 
@@ -413,6 +512,33 @@ private:
         }
     }
 
+    /** Slice a single dimension without handling device allocation. */
+    void slice_host(int d, int pos) {
+        buf.dimensions--;
+        int shift = pos - buf.dim[d].min;
+        if (buf.host != nullptr) {
+            buf.host += shift * buf.dim[d].stride * type().bytes();
+        }
+        for (int i = d; i < buf.dimensions; i++) {
+            buf.dim[i] = buf.dim[i+1];
+        }
+        buf.dim[buf.dimensions] = {0, 0, 0};
+    }
+
+    void complete_device_slice(Buffer<T, D> &result_host_sliced, int d, int pos) const {
+        assert(buf.device_interface != nullptr);
+        if (buf.device_interface->device_slice(nullptr, &this->buf, d, pos, &result_host_sliced.buf) == 0) {
+            const Buffer<T, D> *sliced_from = this;
+            // TODO: Figure out what to do if dev_ref_count is nullptr. Should incref logic run here?
+            // (See identical comment in complete_device_crop.)
+            if (dev_ref_count != nullptr && dev_ref_count->ownership == BufferDeviceOwnership::Cropped) {
+                sliced_from = &((DevRefCountCropped *)dev_ref_count)->cropped_from;
+            }
+            // crop_from() is correct here, despite the fact that we are slicing.
+            result_host_sliced.crop_from(*sliced_from);
+        }
+    }
+
 public:
 
     typedef T ElemType;
@@ -621,8 +747,9 @@ public:
         copy_shape_from(other.buf);
     }
 
-    /** Move constructor */
-    Buffer(Buffer<T, D> &&other) : buf(other.buf),
+    /** Move constructor. Does not throw or touch the allocator: the
+     * shape storage is either inline or stolen from the source. */
+    Buffer(Buffer<T, D> &&other) noexcept : buf(other.buf),
                                    alloc(other.alloc),
                                    dev_ref_count(other.dev_ref_count) {
         other.dev_ref_count = nullptr;
@@ -699,8 +826,9 @@ public:
         return *this;
     }
 
-    /** Standard move-assignment operator */
-    Buffer<T, D> &operator=(Buffer<T, D> &&other) {
+    /** Standard move-assignment operator. Like the move constructor,
+     * does not throw or touch the allocator. */
+    Buffer<T, D> &operator=(Buffer<T, D> &&other) noexcept {
         decref();
         alloc = other.alloc;
         other.alloc = nullptr;
@@ -733,10 +861,16 @@ public:
     void allocate(void *(*allocate_fn)(size_t) = nullptr,
                   void (*deallocate_fn)(void *) = nullptr) {
         if (!allocate_fn) {
-            allocate_fn = malloc;
+            allocate_fn = Internal::default_allocate_fn();
+            if (!allocate_fn) {
+                allocate_fn = malloc;
+            }
         }
         if (!deallocate_fn) {
-            deallocate_fn = free;
+            deallocate_fn = Internal::default_deallocate_fn();
+            if (!deallocate_fn) {
+                deallocate_fn = free;
+            }
         }
 
         // Drop any existing allocation
@@ -748,7 +882,8 @@ public:
         const size_t alignment = 128;
         size = (size + alignment - 1) & ~(alignment - 1);
         void *alloc_storage = allocate_fn(size + sizeof(AllocationHeader) + alignment - 1);
-        alloc = new (alloc_storage) AllocationHeader(deallocate_fn);
+        assert(alloc_storage && "Error: allocation failed in Buffer::allocate");
+        alloc = new (alloc_storage) AllocationHeader(deallocate_fn, size);
         uint8_t *unaligned_ptr = ((uint8_t *)alloc) + sizeof(AllocationHeader);
         buf.host = (uint8_t *)((uintptr_t)(unaligned_ptr + alignment - 1) & ~(alignment - 1));
     }
@@ -768,6 +903,80 @@ public:
         decref_dev();
     }
 
+private:
+    /** Check whether the existing allocation is exclusively owned and
+     * large enough to hold a new densely-packed shape. Used by
+     * try_reuse below. */
+    bool can_reuse_allocation(const int *extents, int dims) const {
+        if (!owns_host_memory() || alloc->ref_count != 1) {
+            return false;
+        }
+        size_t size = (size_t)type().bytes();
+        for (int i = 0; i < dims; i++) {
+            int e = extents[i];
+            if (e < 0) {
+                return false;
+            }
+            if (e != 0 && size > alloc->size / (size_t)e) {
+                return false;
+            }
+            size *= (size_t)e;
+        }
+        return true;
+    }
+
+public:
+    /** Attempt to reshape this Buffer in place to a new set of
+     * densely-packed extents, reusing the existing host allocation
+     * instead of making a round-trip through the allocator. Succeeds
+     * if this Buffer is the sole owner of its allocation and the new
+     * shape occupies no more bytes than the allocation holds. On
+     * success the Buffer looks like a freshly-allocated one of the new
+     * shape: the mins are zero, the strides are dense, host_dirty is
+     * false, and any device allocation is released (asserting that
+     * device_dirty is false), since it describes the old shape. On
+     * failure the Buffer is left unchanged. Steady-state code that
+     * processes frames of varying but bounded shape can call this and
+     * fall back to allocate() only when it returns false. */
+    template<typename ...Args,
+             typename = typename std::enable_if<AllInts<Args...>::value>::type>
+    bool try_reuse(int first, Args... rest) {
+        const int extents[] = {first, (int)rest...};
+        const int dims = 1 + (int)(sizeof...(rest));
+        if (!can_reuse_allocation(extents, dims)) {
+            return false;
+        }
+        device_deallocate();
+        if (dims != buf.dimensions) {
+            free_shape_storage();
+            buf.dimensions = dims;
+            make_shape_storage();
+        }
+        initialize_shape(0, first, rest...);
+        set_host_dirty(false);
+        return true;
+    }
+
+    /** Attempt to reshape this Buffer in place, reusing the existing
+     * allocation, with the new extents given as a vector. See the
+     * variadic version above. */
+    bool try_reuse(const std::vector<int> &sizes) {
+        assert(sizes.size() <= std::numeric_limits<int>::max());
+        const int dims = (int)sizes.size();
+        if (!can_reuse_allocation(sizes.data(), dims)) {
+            return false;
+        }
+        device_deallocate();
+        if (dims != buf.dimensions) {
+            free_shape_storage();
+            buf.dimensions = dims;
+            make_shape_storage();
+        }
+        initialize_shape(sizes);
+        set_host_dirty(false);
+        return true;
+    }
+
     /** Allocate a new image of the given size with a runtime
      * type. Only used when you do know what size you want but you
      * don't know statically what type the elements are. Pass zeroes
@@ -1077,6 +1286,21 @@ public:
             src.crop(i, min_coord, max_coord - min_coord + 1);
         }
 
+        // If the region in common has the same dense layout in both
+        // buffers, the copy is a single memcpy over the span.
+        bool same_dense_layout =
+            (src.size_in_bytes() == src.number_of_elements() * type().bytes());
+        for (int i = 0; i < dimensions(); i++) {
+            same_dense_layout &= dst.dim(i).stride() == src.dim(i).stride();
+        }
+        if (same_dense_layout) {
+            // Cast away any constness of T (e.g. when copying a
+            // Buffer<const T>); we've already asserted dst is clean.
+            memcpy((void *)dst.begin(), (const void *)src.begin(), src.size_in_bytes());
+            set_host_dirty();
+            return;
+        }
+
         // If T is void, we need to do runtime dispatch to an
         // appropriately-typed lambda. We're copying, so we only care
         // about the element size.
@@ -1257,25 +1481,31 @@ public:
     /** Make a lower-dimensional image that refers to one slice of this
      * image. */
     Buffer<T, D> sliced(int d, int pos) const {
+        // Make a fresh copy of the underlying buffer (but not a fresh
+        // copy of the allocation, if there is one).
         Buffer<T, D> im = *this;
-        im.slice(d, pos);
+
+        // This guarantees the prexisting device ref is dropped if the
+        // device_slice call fails and maintains the buffer in a consistent
+        // state.
+        im.device_deallocate();
+
+        im.slice_host(d, pos);
+        if (buf.device_interface != nullptr) {
+            complete_device_slice(im, d, pos);
+        }
         return im;
     }
 
     /** Slice an image in-place */
     void slice(int d, int pos) {
-        // assert(pos >= dim(d).min() && pos <= dim(d).max());
-        device_deallocate();
-        buf.dimensions--;
-        int shift = pos - dim(d).min();
-        assert(buf.device == 0 || shift == 0);
-        if (buf.host != nullptr) {
-            buf.host += shift * dim(d).stride() * type().bytes();
-        }
-        for (int i = d; i < dimensions(); i++) {
-            buf.dim[i] = buf.dim[i+1];
+        // An optimization for non-device buffers. For the device case,
+        // a temp buffer is required, so reuse the not-in-place version.
+        if (buf.device_interface != nullptr) {
+            *this = sliced(d, pos);
+        } else {
+            slice_host(d, pos);
         }
-        buf.dim[buf.dimensions] = {0, 0, 0};
     }
 
     /** Make a new image that views this image as a single slice in a
@@ -1315,11 +1545,11 @@ public:
         buf.dimensions++;
         if (buf.dim != shape) {
             // We're already on the heap. Reallocate.
-            halide_dimension_t *new_shape = new halide_dimension_t[buf.dimensions];
+            halide_dimension_t *new_shape = Internal::allocate_shape_storage(buf.dimensions);
             for (int i = 0; i < dims; i++) {
                 new_shape[i] = buf.dim[i];
             }
-            delete[] buf.dim;
+            Internal::release_shape_storage(buf.dim, dims);
             buf.dim = new_shape;
         } else if (dims == D) {
             // Transition from the in-class storage to the heap
@@ -1715,6 +1945,21 @@ public:
 
     void fill(not_void_T val) {
         set_host_dirty();
+        // If the buffer spans a contiguous block of memory and the
+        // fill value is the same byte repeated (e.g. zero), use a
+        // single memset over the whole span instead of storing
+        // element-by-element.
+        if (size_in_bytes() == number_of_elements() * type().bytes()) {
+            const uint8_t *bytes = (const uint8_t *)&val;
+            bool all_bytes_equal = true;
+            for (size_t i = 1; i < sizeof(not_void_T); i++) {
+                all_bytes_equal &= bytes[i] == bytes[0];
+            }
+            if (all_bytes_equal) {
+                memset(begin(), bytes[0], size_in_bytes());
+                return;
+            }
+        }
         for_each_value([=](T &v) {v = val;});
     }
 
@@ -1801,6 +2046,23 @@ private:
     }
     // @}
 
+    /** Helpers for the parallel variants of for_each_value and
+     * for_each_element. The closure lives on the stack of the caller
+     * of parallel_for, which blocks until all tasks are done, so the
+     * pointer smuggled through the uint8_t * stays valid. */
+    // @{
+    template<typename Fn>
+    static int run_parallel_task(void *, int idx, uint8_t *closure) {
+        (*(Fn *)closure)(idx);
+        return 0;
+    }
+
+    template<typename Fn>
+    static void parallel_for(int min, int extent, Fn &f) {
+        halide_do_par_for(nullptr, run_parallel_task<Fn>, min, extent, (uint8_t *)&f);
+    }
+    // @}
+
 public:
     /** Call a function on every value in the buffer, and the
      * corresponding values in some number of other buffers of the
@@ -1863,6 +2125,25 @@ public:
         }
     }
 
+    /** A variant of for_each_value that carves the outermost
+     * dimension into slices and runs them across the Halide thread
+     * pool. The callable may be invoked from several threads at once,
+     * so it and anything it captures must be thread-safe. Only
+     * useful when linking against a Halide runtime; zero-dimensional
+     * buffers fall back to the serial version. */
+    template<typename Fn, typename ...Args>
+    void for_each_value_parallel(Fn &&f, Args... other_buffers) {
+        const int d = dimensions() - 1;
+        if (d < 0) {
+            for_each_value(std::forward<Fn>(f), other_buffers...);
+            return;
+        }
+        auto task = [&](int i) {
+            cropped(d, i, 1).for_each_value(f, other_buffers.cropped(d, i, 1)...);
+        };
+        parallel_for(dim(d).min(), dim(d).extent(), task);
+    }
+
 private:
 
     // Helper functions for for_each_element
@@ -2054,6 +2335,25 @@ public:
         for_each_element(0, dimensions(), t, std::forward<Fn>(f));
     }
 
+    /** A variant of for_each_element that carves the outermost
+     * dimension into slices and runs them across the Halide thread
+     * pool. The callable may be invoked from several threads at once,
+     * so it and anything it captures must be thread-safe. Only
+     * useful when linking against a Halide runtime; zero-dimensional
+     * buffers fall back to the serial version. */
+    template<typename Fn>
+    void for_each_element_parallel(Fn &&f) const {
+        const int d = dimensions() - 1;
+        if (d < 0) {
+            for_each_element(std::forward<Fn>(f));
+            return;
+        }
+        auto task = [&](int i) {
+            cropped(d, i, 1).for_each_element(f);
+        };
+        parallel_for(dim(d).min(), dim(d).extent(), task);
+    }
+
 private:
     template<typename Fn>
     struct FillHelper {
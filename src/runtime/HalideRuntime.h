@@ -107,6 +107,33 @@ extern void halide_mutex_lock(struct halide_mutex *mutex);
 extern void halide_mutex_unlock(struct halide_mutex *mutex);
 //@}
 
+/** Give a mutex a human-readable name for the contended-lock section
+ * of halide_profiler_report. Unnamed locks are reported by address.
+ * The string is not copied and must outlive the process. */
+extern void halide_mutex_set_name(struct halide_mutex *mutex, const char *name);
+
+/** A counting semaphore used to synchronize the producer and
+ * consumer of a Func scheduled with Func::async(). */
+struct halide_semaphore_t {
+    uint64_t _private[4];
+};
+
+/** Cross platform semaphore operations. The acquire blocks until the
+ * semaphore holds at least 'n' units. */
+//@{
+extern int halide_semaphore_init(struct halide_semaphore_t *sem, int n);
+extern int halide_semaphore_release(struct halide_semaphore_t *sem, int n);
+extern int halide_semaphore_acquire(struct halide_semaphore_t *sem, int n);
+//@}
+
+/** Allocate a semaphore on the heap with the given initial count, and
+ * free it again. Generated pipelines containing async Funcs call
+ * these around each realization of the producer. */
+//@{
+extern struct halide_semaphore_t *halide_semaphore_allocate(int n);
+extern int halide_semaphore_free(struct halide_semaphore_t *sem);
+//@}
+
 /** Define halide_do_par_for to replace the default thread pool
  * implementation. halide_shutdown_thread_pool can also be called to
  * release resources used by the default thread pool on platforms
@@ -125,6 +152,14 @@ extern int halide_do_par_for(void *user_context,
 extern void halide_shutdown_thread_pool();
 //@}
 
+/** Spawn the worker threads used by the default thread pool ahead of
+ * the first parallel loop. Normally the threads are created lazily,
+ * which makes the first parallel realization noticeably slower than
+ * subsequent ones; calling this during process or library
+ * initialization moves that cost out of the critical path. Safe to
+ * call multiple times. Only affects the default thread pool. */
+extern void halide_thread_pool_startup();
+
 /** Set a custom method for performing a parallel for loop. Returns
  * the old do_par_for handler. */
 typedef int (*halide_do_par_for_t)(void *, halide_task_t, int, int, uint8_t*);
@@ -159,6 +194,68 @@ extern struct halide_thread *halide_spawn_thread(void (*f)(void *), void *closur
 /** Join a thread. */
 extern void halide_join_thread(struct halide_thread *);
 
+/** Pin the calling thread to the CPUs whose bits are set in the given
+ * mask. Bit i of mask[i / 64] corresponds to CPU i, and words is the
+ * number of 64-bit words in the mask. Returns zero on success.
+ * Platforms without thread affinity support return non-zero and have
+ * no other effect. */
+extern int halide_host_cpu_set_affinity(const uint64_t *mask, int words);
+
+/** Restrict the threads of Halide's thread pool to the CPUs whose
+ * bits are set in the given mask. Bit i of mask[i / 64] corresponds
+ * to CPU i, and words is the number of 64-bit words in the mask. The
+ * calling thread is pinned immediately (it participates in parallel
+ * loops it launches), and worker threads created afterwards are
+ * pinned as they start, so call this before the first parallel loop
+ * runs. Passing NULL (or zero words) removes the restriction for
+ * future threads.
+ *
+ * On NUMA systems, passing the CPUs of one socket keeps the workers
+ * and their first-touch page placement on that socket's memory. The
+ * default thread pool assigns each worker a contiguous chunk of the
+ * parallel loop, so with the OS's usual first-touch policy each
+ * socket mostly re-reads pages it populated itself.
+ *
+ * Returns zero on success, or non-zero if thread affinity is not
+ * supported on this platform. Only the default implementation of
+ * halide_do_par_for() is guaranteed to honor this. */
+extern int halide_set_thread_affinity(const uint64_t *mask, int words);
+
+/** Query the host's heterogeneous core topology (e.g. ARM
+ * big.LITTLE). Fills mask with a bit per "big" core -- one that can
+ * reach the highest maximum frequency present on the system -- using
+ * the same layout as halide_set_thread_affinity. If little_ratio is
+ * non-NULL, stores the maximum frequency of the remaining cores as a
+ * percentage of the big cores' into it. Returns the number of big
+ * cores found, or zero if the cores are homogeneous or the topology
+ * cannot be determined on this platform. */
+extern int halide_host_cpu_big_cores(uint64_t *mask, int words, int *little_ratio);
+
+/** How Halide's thread pool should use heterogeneous cores. */
+typedef enum halide_cpu_core_policy_t {
+    /** Use every core and treat them all equally. The default. */
+    halide_cpu_core_policy_all = 0,
+
+    /** Pin the pool to the big cores and size it to match. Best for
+     * latency-sensitive pipelines: little cores never hold up the
+     * tail of a parallel loop. */
+    halide_cpu_core_policy_big_only = 1,
+
+    /** Use every core, but give the little cores proportionally
+     * smaller slices of parallel loops. Best for throughput when the
+     * machine is otherwise idle. */
+    halide_cpu_core_policy_all_weighted = 2
+} halide_cpu_core_policy_t;
+
+/** Apply a core policy to Halide's thread pool, adjusting its size,
+ * its affinity, and how parallel loop iterations are divided among
+ * workers. On hosts where halide_host_cpu_big_cores finds no distinct
+ * core classes, every policy behaves like halide_cpu_core_policy_all.
+ * Call before the first parallel loop runs; like
+ * halide_set_thread_affinity, it does not re-pin threads that already
+ * exist. Returns zero on success. */
+extern int halide_set_cpu_core_policy(int policy);
+
 /** Set the number of threads used by Halide's thread pool. Returns
  * the old number.
  *
@@ -177,6 +274,62 @@ extern void halide_join_thread(struct halide_thread *);
  */
 extern int halide_set_num_threads(int n);
 
+/** Return the number of threads Halide's thread pool will use for
+ * parallel loops, as set by halide_set_num_threads(), or the
+ * system-determined default if it has not been set. Lowered pipelines
+ * call this to pick how many strips to divide parallelized sliding
+ * window loops into. */
+extern int halide_get_num_threads();
+
+/** Set the priority given to parallel loops enqueued on Halide's
+ * thread pool from now on, and return the old value. Higher values
+ * run first: worker threads always pick the highest-priority
+ * outstanding loop, and threads busy on a lower-priority loop switch
+ * over as soon as they finish their current batch of iterations.
+ * Loops of equal priority run in the usual last-in-first-out order.
+ * The default priority is zero.
+ *
+ * The priority is captured when a parallel loop is enqueued, so to
+ * favor one pipeline over another, call this before realizing each of
+ * them. Only the default implementation of halide_do_par_for() is
+ * guaranteed to honor this. */
+extern int halide_set_task_priority(int priority);
+
+/** Hooks for running one pipeline cooperatively across multiple
+ * processes (e.g. MPI ranks), each realizing a slab of the output.
+ * Halide does not talk to any communication library itself; it asks
+ * these hooks which slab belongs to this process, and hands the
+ * footprint of each input it is about to read to
+ * halide_distributed_exchange so that a user-installed handler can
+ * fill in ghost zones owned by other processes. The defaults describe
+ * a single-process world of size one and an exchange that merely
+ * checks the required region is already present. Install replacements
+ * at startup (e.g. from MPI_Comm_rank/MPI_Comm_size and a handler
+ * built on MPI_Sendrecv). */
+//@{
+extern int halide_distributed_rank();
+extern int halide_distributed_size();
+extern void halide_set_distributed_topology(int rank, int size);
+
+/** Make the region of buf described by required_min/required_extent
+ * (one entry per dimension) valid before it is read, fetching any
+ * parts owned by other processes. Returns zero on success. */
+extern int halide_distributed_exchange(void *user_context,
+                                       struct halide_buffer_t *buf,
+                                       const int *required_min,
+                                       const int *required_extent,
+                                       int dimensions);
+typedef int (*halide_distributed_exchange_t)(void *, struct halide_buffer_t *,
+                                             const int *, const int *, int);
+extern halide_distributed_exchange_t halide_set_custom_distributed_exchange(
+    halide_distributed_exchange_t exchange);
+extern int halide_default_distributed_exchange(void *user_context,
+                                               struct halide_buffer_t *buf,
+                                               const int *required_min,
+                                               const int *required_extent,
+                                               int dimensions);
+//@}
+
 /** Halide calls these functions to allocate and free memory. To
  * replace in AOT code, use the halide_set_custom_malloc and
  * halide_set_custom_free, or (on platforms that support weak
@@ -205,6 +358,55 @@ extern halide_malloc_t halide_set_custom_malloc(halide_malloc_t user_malloc);
 extern halide_free_t halide_set_custom_free(halide_free_t user_free);
 //@}
 
+/** The default allocator keeps freed blocks around for reuse, so that
+ * a pipeline realized repeatedly with the same shapes stops calling
+ * the system allocator after its first realization. This sets the
+ * byte budget for cached blocks larger than the allocator's size
+ * classes (the compute_root intermediates of big pipelines). The
+ * default is 64 MB; raise it if your pipelines' intermediates exceed
+ * that, or set it to zero to release the cached memory and disable
+ * caching of large blocks. Only affects halide_default_malloc/free. */
+extern void halide_allocator_cache_set_size(int64_t size);
+
+/** A set of runtime hooks that apply to a single user_context rather
+ * than to the whole process. The halide_set_custom_* and
+ * halide_set_error_handler calls above swap process-global pointers,
+ * so two pipelines running in one process cannot use different
+ * allocators or thread pools without racing on configuration. To give
+ * each context its own hooks instead, fill in this struct and
+ * register it with halide_set_context_overrides; the default
+ * implementations of halide_malloc, halide_free, halide_do_task,
+ * halide_do_par_for, halide_error, and halide_print consult the
+ * overrides registered for their user_context before falling back to
+ * the process-global hook. Fields left NULL fall back too, so a
+ * partial struct is fine. */
+typedef struct halide_runtime_overrides_t {
+    halide_malloc_t custom_malloc;
+    halide_free_t custom_free;
+    halide_do_task_t custom_do_task;
+    halide_do_par_for_t custom_do_par_for;
+    halide_error_handler_t custom_error;
+    halide_print_t custom_print;
+} halide_runtime_overrides_t;
+
+/** Associate a set of hook overrides with a user_context pointer, or
+ * dissociate them by passing NULL. Both the context pointer and the
+ * struct must outlive any pipeline invocation passed that context;
+ * the struct is not copied. Registration takes a lock, but lookups on
+ * the hot paths are lock-free, and contexts with no registered
+ * overrides pay a single load. Register a context before launching
+ * pipelines that use it: registration is not synchronized against
+ * concurrent lookups of the same context. Returns zero on success,
+ * halide_error_code_out_of_memory if the (fixed-size) registration
+ * table is full. */
+extern int halide_set_context_overrides(void *user_context,
+                                        const struct halide_runtime_overrides_t *overrides);
+
+/** Retrieve the overrides registered for a user_context, or NULL if
+ * none have been. Called by the default hook dispatchers; also usable
+ * from custom hooks that want to chain. */
+extern const struct halide_runtime_overrides_t *halide_get_context_overrides(void *user_context);
+
 /** Halide calls these functions to interact with the underlying
  * system runtime functions. To replace in AOT code on platforms that
  * support weak linking, define these functions yourself, or use
@@ -239,6 +441,20 @@ extern int32_t halide_debug_to_file(void *user_context, const char *filename,
                                     int32_t type_code,
                                     struct halide_buffer_t *buf);
 
+/** Make halide_debug_to_file asynchronous. When enabled, the buffer
+ * is snapshotted into a pooled allocation and handed to a background
+ * writer thread, so the pipeline doesn't stall on file I/O. Write
+ * errors are deferred and reported by halide_debug_to_file_flush,
+ * which blocks until all pending writes have hit disk and returns
+ * the first error encountered since the last flush (zero if none).
+ * Call it before inspecting the dumped files or exiting the
+ * process. If a snapshot can't be taken (e.g. out of memory), the
+ * write falls back to being synchronous. */
+//@{
+extern void halide_debug_to_file_set_async(int enable);
+extern int32_t halide_debug_to_file_flush(void *user_context);
+//@}
+
 /** Types in the halide type system. They can be ints, unsigned ints,
  * or floats (of various bit-widths), or a handle (which is always 64-bits).
  * Note that the int/uint/float values do not imply a specific bit width
@@ -251,8 +467,9 @@ typedef enum halide_type_code_t
 {
     halide_type_int = 0,   //!< signed integers
     halide_type_uint = 1,  //!< unsigned integers
-    halide_type_float = 2, //!< floating point numbers
-    halide_type_handle = 3 //!< opaque pointer type (void *)
+    halide_type_float = 2, //!< IEEE floating point numbers
+    halide_type_handle = 3, //!< opaque pointer type (void *)
+    halide_type_bfloat = 4 //!< floating point numbers in the bfloat format
 } halide_type_code_t;
 
 // Note that while __attribute__ can go before or after the declaration,
@@ -323,7 +540,8 @@ enum halide_trace_event_code_t {halide_trace_load = 0,
                                 halide_trace_end_consume = 7,
                                 halide_trace_begin_pipeline = 8,
                                 halide_trace_end_pipeline = 9,
-                                halide_trace_tag = 10 };
+                                halide_trace_tag = 10,
+                                halide_trace_sync = 11 };
 
 struct halide_trace_event_t {
     /** The name of the Func or Pipeline that this event refers to */
@@ -420,6 +638,25 @@ typedef int32_t (*halide_trace_t)(void *user_context, const struct halide_trace_
 extern halide_trace_t halide_set_custom_trace(halide_trace_t trace);
 // @}
 
+/** Restrict tracing to the given comma- or semicolon-separated list
+ * of Func names. A trailing '*' in a name matches any suffix, which
+ * is useful for catching the stages of a Func. Pass NULL or an empty
+ * string to trace every Func again. Pipeline-level events and trace
+ * tags are always kept so the trace stays readable by the tools. Can
+ * also be set with the HL_TRACE_FUNCS environment variable; calling
+ * this overrides the environment. Not thread-safe with respect to
+ * pipelines that are currently tracing. */
+extern int halide_trace_set_func_filter(void *user_context, const char *funcs);
+
+/** Only trace every Nth realization of each Func, suppressing all
+ * events inside the others. Relies on the begin/end realization
+ * events emitted under the trace_realizations target feature; with
+ * parallel realizations of the same Func the sampling is approximate.
+ * A rate of 1 (the default) traces everything. Can also be set with
+ * the HL_TRACE_SAMPLE_RATE environment variable; calling this
+ * overrides the environment. */
+extern int halide_trace_set_sample_rate(void *user_context, int rate);
+
 /** The header of a packet in a binary trace. All fields are 32-bit. */
 struct halide_trace_packet_t {
     /** The total size of this packet in bytes. Always a multiple of
@@ -499,7 +736,26 @@ struct halide_trace_packet_t {
     #endif
 };
 
-
+/** When Halide opens the binary trace file itself (via the
+ * HL_TRACE_FILE environment variable), it periodically writes sync
+ * packets into the stream so that tools can seek around large traces
+ * without reading them end-to-end. A sync packet is an ordinary
+ * halide_trace_packet_t with event halide_trace_sync, no coordinates,
+ * an empty func name, and a payload of type.lanes bytes laid out as:
+ *
+ *   uint64_t: file offset of the previous sync packet (all ones if none)
+ *   uint64_t: file offset of this sync packet
+ *   uint64_t: the highest packet id written before this sync packet
+ *   uint32_t: the number of func entries that follow
+ *   entries:  uint64_t file offset of the func's first packet,
+ *             followed by the func's name and a terminating null
+ *
+ * The func table is cumulative, so the last sync packet lists every
+ * func seen in the trace (up to the packet size limit). The file ends
+ * with a 16-byte footer: the file offset of the last sync packet,
+ * then the eight bytes "HLTRIDX1". Sync packets and the footer are
+ * only written to seekable files Halide opened itself, never to file
+ * descriptors installed with halide_set_trace_file. */
 
 /** Set the file descriptor that Halide should write binary trace
  * events to. If called with 0 as the argument, Halide outputs trace
@@ -562,6 +818,8 @@ struct halide_device_interface_t {
                        const struct halide_device_interface_t *dst_device_interface, struct halide_buffer_t *dst);
     int (*device_crop)(void *user_context, const struct halide_buffer_t *src,
                        struct halide_buffer_t *dst);
+    int (*device_slice)(void *user_context, const struct halide_buffer_t *src,
+                        int slice_dim, int slice_pos, struct halide_buffer_t *dst);
     int (*device_release_crop)(void *user_context, struct halide_buffer_t *buf);
     int (*wrap_native)(void *user_context, struct halide_buffer_t *buf, uint64_t handle,
                        const struct halide_device_interface_t *device_interface);
@@ -591,6 +849,24 @@ extern int halide_copy_to_host(void *user_context, struct halide_buffer_t *buf);
 extern int halide_copy_to_device(void *user_context, struct halide_buffer_t *buf,
                                  const struct halide_device_interface_t *device_interface);
 
+/** Mark a sub-region of a buffer as modified on the host (or device),
+ * instead of setting the whole-buffer dirty flag directly. 'box' is
+ * an array of buf->dimensions halide_dimension_t giving the min and
+ * extent of the modified region in each dimension (the stride field
+ * is ignored). The next halide_copy_to_device (or halide_copy_to_host)
+ * will then only move the bounding box of the marked regions, using
+ * the device interface's crop support to address the sub-region;
+ * interfaces without crop support fall back to a whole-buffer copy.
+ * Multiple marks before a copy are unioned into a single bounding
+ * box. Mixing these calls with directly setting the corresponding
+ * whole-buffer dirty flag makes the whole buffer dirty as usual. */
+// @{
+extern int halide_buffer_mark_host_dirty_region(void *user_context, struct halide_buffer_t *buf,
+                                                const struct halide_dimension_t *box);
+extern int halide_buffer_mark_device_dirty_region(void *user_context, struct halide_buffer_t *buf,
+                                                  const struct halide_dimension_t *box);
+// @}
+
 /** Copy data from one buffer to another. The buffers may have
  * different shapes and sizes, but the destination buffer's shape must
  * be contained within the source buffer's shape. That is, for each
@@ -622,8 +898,19 @@ extern int halide_device_crop(void *user_context,
                               const struct halide_buffer_t *src,
                               struct halide_buffer_t *dst);
 
-/** Release any resources associated with a cropped view of another
- * buffer. */
+/** Give the destination buffer a device allocation which is an alias
+ * for a similar coordinate range in the source buffer, but with one
+ * dimension sliced away in the dst. Pass the dimension to slice, and
+ * the slice position. The same restrictions as halide_device_crop
+ * apply, and halide_device_release_crop must likewise be used to
+ * clean up the resulting view. */
+extern int halide_device_slice(void *user_context,
+                               const struct halide_buffer_t *src,
+                               int slice_dim, int slice_pos,
+                               struct halide_buffer_t *dst);
+
+/** Release any resources associated with a cropped/sliced view of
+ * another buffer. */
 extern int halide_device_release_crop(void *user_context,
                                       struct halide_buffer_t *buf);
 
@@ -638,6 +925,13 @@ extern int halide_device_malloc(void *user_context, struct halide_buffer_t *buf,
 /** Free device memory. */
 extern int halide_device_free(void *user_context, struct halide_buffer_t *buf);
 
+/** Complete a device interface's lazy initialization (context
+ * creation, module compilation) ahead of its first real use, so the
+ * first pipeline to run on the device does not pay for it. Returns
+ * zero on success. */
+extern int halide_device_warmup(void *user_context,
+                                const struct halide_device_interface_t *device_interface);
+
 /** Wrap or detach a native device handle, setting the device field
  * and device_interface field as appropriate for the given GPU
  * API. The meaning of the opaque handle is specific to the device
@@ -684,14 +978,25 @@ extern int halide_get_gpu_device(void *user_context);
  */
 extern void halide_memoization_cache_set_size(int64_t size);
 
+/** Set the soft maximum amount of device (GPU) memory, in bytes, that
+ *  the LRU cache will keep resident for memoized Func results. Cached
+ *  results computed on a device stay in device memory up to this
+ *  budget, so a later cache hit can be consumed on the device without
+ *  a round trip through host memory. Entries holding device memory
+ *  beyond the budget are evicted entirely.
+ */
+extern void halide_memoization_cache_set_device_size(int64_t size);
+
 /** Given a cache key for a memoized result, currently constructed
  *  from the Func name and top-level Func name plus the arguments of
  *  the computation, determine if the result is in the cache and
  *  return it if so. (The internals of the cache key should be
  *  considered opaque by this function.) If this routine returns true,
  *  it is a cache miss. Otherwise, it will return false and the
- *  buffers passed in will be filled, via copying, with memoized
- *  data. The last argument is a list if halide_buffer_t pointers which
+ *  buffers passed in will be made to alias the memoized data without
+ *  copying; the cache entry is reference counted and stays alive
+ *  until halide_memoization_cache_release is called on each
+ *  buffer. The last argument is a list if halide_buffer_t pointers which
  *  represents the outputs of the memoized Func. If the Func does not
  *  return a Tuple, there will only be one halide_buffer_t in the list. The
  *  tuple_count parameters determines the length of the list.
@@ -718,11 +1023,27 @@ extern int halide_memoization_cache_lookup(void *user_context, const uint8_t *ca
  *
  * If there is a memory allocation failure, the store does not store
  * the data into the cache.
+ *
+ * If has_eviction_key is non-zero, eviction_key is remembered with
+ * the entry so that a later halide_memoization_cache_evict with the
+ * same key flushes it. The eviction key is set via
+ * Func::memoize(eviction_key) and plays no part in lookup.
  */
 extern int halide_memoization_cache_store(void *user_context, const uint8_t *cache_key, int32_t size,
                                           struct halide_buffer_t *realized_bounds,
                                           int32_t tuple_count,
-                                          struct halide_buffer_t **tuple_buffers);
+                                          struct halide_buffer_t **tuple_buffers,
+                                          int32_t has_eviction_key, uint64_t eviction_key);
+
+/** Evict all cache entries that were tagged with the given eviction
+ * key when they were stored (via Func::memoize(eviction_key)).
+ * Entries currently handed out by halide_memoization_cache_lookup
+ * are skipped; evict again once they have been released. This allows
+ * e.g. flushing every cached intermediate
+ * derived from one input frame without touching the rest of the
+ * cache.
+ */
+extern void halide_memoization_cache_evict(void *user_context, uint64_t eviction_key);
 
 /** If halide_memoization_cache_lookup succeeds,
  * halide_memoization_cache_release must be called to signal the
@@ -741,11 +1062,54 @@ extern int halide_memoization_cache_store(void *user_context, const uint8_t *cac
   */
 extern void halide_memoization_cache_release(void *user_context, void *host);
 
+/** Buffers returned by a successful halide_memoization_cache_lookup
+ * alias the cache's own storage and must not be written through.  A
+ * caller that wants to mutate a memoized result in place can call
+ * this first: if the buffer aliases a cache entry it is replaced with
+ * a private copy (copy-on-write) and the entry's reference is
+ * dropped, after which halide_memoization_cache_release frees the
+ * copy as usual. Buffers that are already privately owned are left
+ * untouched.
+ *
+ * Returns zero on success, or -1 if the copy could not be allocated.
+ */
+extern int halide_memoization_cache_detach(void *user_context, struct halide_buffer_t *buf);
+
 /** Free all memory and resources associated with the memoization cache.
  * Must be called at a time when no other threads are accessing the cache.
  */
 extern void halide_memoization_cache_cleanup();
 
+/** Statistics about the memoization cache, filled in by
+ * halide_memoization_cache_get_stats. All counters are cumulative
+ * since process start. */
+struct halide_memoization_cache_stats {
+    /** Lookups that were satisfied from the cache. */
+    uint64_t hits;
+    /** Lookups that missed and caused the result to be computed. */
+    uint64_t misses;
+    /** Entries added to the cache. */
+    uint64_t stores;
+    /** Entries removed to stay under the size limit. */
+    uint64_t evictions;
+    /** Bytes currently held by cached results. */
+    uint64_t bytes_in_use;
+    /** The current size limit, as set by
+     * halide_memoization_cache_set_size. */
+    int64_t size_limit;
+    /** Bytes of device (GPU) memory currently held by cached
+     * results. */
+    uint64_t device_bytes_in_use;
+    /** The current device memory limit, as set by
+     * halide_memoization_cache_set_device_size. */
+    int64_t device_size_limit;
+};
+
+/** Fill in the given struct with a snapshot of the memoization
+ * cache's statistics. Useful for sizing the cache from production
+ * data rather than guesswork. */
+extern void halide_memoization_cache_get_stats(struct halide_memoization_cache_stats *stats);
+
 /** Create a unique file with a name of the form prefixXXXXXsuffix in an arbitrary
  * (but writable) directory; this is typically $TMP or /tmp, but the specific
  * location is not guaranteed. (Note that the exact form of the file name
@@ -1109,7 +1473,14 @@ typedef enum halide_target_feature_t {
     halide_target_feature_legacy_buffer_wrappers = 51,  ///< Emit legacy wrapper code for buffer_t (vs halide_buffer_t) when AOT-compiled.
     halide_target_feature_tsan = 52, ///< Enable hooks for TSAN support.
     halide_target_feature_asan = 53, ///< Enable hooks for ASAN support.
-    halide_target_feature_end = 54 ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
+    halide_target_feature_arm_dot_prod = 54, ///< Enable ARMv8.2-a dot-product instructions (sdot/udot)
+    halide_target_feature_arm_fp16 = 55, ///< Enable ARMv8.2-a half-precision floating point arithmetic (fullfp16)
+    halide_target_feature_parallel_roots = 56, ///< Run independent compute_root stages concurrently on the thread pool instead of in realization order.
+    halide_target_feature_managed_memory = 57, ///< Allocate GPU buffers from host-visible unified memory and elide copies. Intended for integrated GPUs (e.g. Tegra) where device and host share physical memory.
+    halide_target_feature_unchecked_entry = 58, ///< Also emit a "<name>_unchecked" entry point per pipeline that skips the runtime argument checks, for callers that validate arguments themselves.
+    halide_target_feature_rvv = 59, ///< Enable the RISC-V vector extension.
+    halide_target_feature_sve = 60, ///< Enable ARM Scalable Vector Extensions, assuming a 256-bit vector length.
+    halide_target_feature_end = 61 ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
 } halide_target_feature_t;
 
 /** This function is called internally by Halide in some situations to determine
@@ -1455,6 +1826,14 @@ struct halide_profiler_func_stats {
     /** Total time taken evaluating this Func (in nanoseconds). */
     uint64_t time;
 
+    /** Time spent computing this Func on a GPU or other device (in
+     * nanoseconds), as measured by the device API's own timers
+     * (e.g. CUDA events). The sampled time above attributes device
+     * work to whatever the CPU was doing at the time; this field
+     * gives the true device time. Only non-zero for device backends
+     * that support it. */
+    uint64_t device_time;
+
     /** The current memory allocation of this Func. */
     uint64_t memory_current;
 
@@ -1470,6 +1849,13 @@ struct halide_profiler_func_stats {
     /** The average number of thread pool worker threads active while computing this Func. */
     uint64_t active_threads_numerator, active_threads_denominator;
 
+    /** Hardware performance counter totals attributed to this Func by
+     * the sampling thread. Only non-zero if a counter source has been
+     * installed with halide_profiler_perf_counters_enable. */
+    uint64_t instructions;
+    uint64_t llc_misses;
+    uint64_t branch_misses;
+
     /** The name of this Func. A global constant string. */
     const char *name;
 
@@ -1483,6 +1869,10 @@ struct halide_profiler_pipeline_stats {
     /** Total time spent inside this pipeline (in nanoseconds) */
     uint64_t time;
 
+    /** Total device (GPU) time measured for funcs in this pipeline
+     * (in nanoseconds). See halide_profiler_func_stats::device_time. */
+    uint64_t device_time;
+
     /** The current memory allocation of funcs in this pipeline. */
     uint64_t memory_current;
 
@@ -1496,6 +1886,13 @@ struct halide_profiler_pipeline_stats {
      * work while computing this pipeline. */
     uint64_t active_threads_numerator, active_threads_denominator;
 
+    /** Hardware performance counter totals for this pipeline. Only
+     * non-zero if a counter source has been installed with
+     * halide_profiler_perf_counters_enable. */
+    uint64_t instructions;
+    uint64_t llc_misses;
+    uint64_t branch_misses;
+
     /** The name of this pipeline. A global constant string. */
     const char *name;
 
@@ -1554,6 +1951,85 @@ struct halide_profiler_state {
 
     /** Sampling thread reference to be joined at shutdown. */
     struct halide_thread *sampling_thread;
+
+    /** An optional ring buffer of timeline events, written by the
+     * sampling thread whenever the running func changes. NULL unless
+     * installed with halide_profiler_timeline_enable. */
+    struct halide_profiler_timeline_event *timeline_events;
+
+    /** The capacity of the ring buffer above, in events. */
+    int timeline_size;
+
+    /** The total number of events recorded so far. The next event is
+     * written at timeline_head % timeline_size, so once the buffer
+     * fills the oldest events are overwritten. */
+    int timeline_head;
+
+    /** An optional source of hardware performance counters, read by
+     * the sampling thread once per sample. Fills values with the
+     * current totals for instructions retired, last-level cache
+     * misses, and branch misses, in that order. The deltas between
+     * samples are attributed to the running func. NULL unless
+     * installed, e.g. by halide_profiler_perf_counters_enable. */
+    int (*read_perf_counters)(uint64_t values[3]);
+
+    /** A linked list of user-defined counters, created on first use
+     * by halide_profiler_user_counter_add. Only the global state
+     * carries these; per-pipeline instances leave them NULL. */
+    struct halide_profiler_user_counter *user_counters;
+
+    /** A linked list of user-defined scoped markers, created on first
+     * use by halide_profiler_marker_end. Only the global state
+     * carries these; per-pipeline instances leave them NULL. */
+    struct halide_profiler_user_marker *user_markers;
+};
+
+/** A single interval in the profiler timeline: a stretch of time over
+ * which the sampling thread observed the same func running with the
+ * same number of active threads. */
+struct halide_profiler_timeline_event {
+    /** The start and end of the interval, in nanoseconds, as reported
+     * by halide_current_time_ns. */
+    uint64_t begin;
+    uint64_t end;
+
+    /** The id of the func that was running. */
+    int func_id;
+
+    /** The number of threads that were doing work. */
+    int active_threads;
+};
+
+/** A named event counter incremented by user code (typically extern
+ * stages), reported alongside the sampled statistics. */
+struct halide_profiler_user_counter {
+    /** The name the counter was registered under. Not owned; must
+     * remain valid for the life of the process (use a string
+     * literal). */
+    const char *name;
+
+    /** The running total. */
+    uint64_t value;
+
+    struct halide_profiler_user_counter *next;
+};
+
+/** A named phase of user code bracketed by
+ * halide_profiler_marker_begin/end, reported alongside the sampled
+ * statistics with a percentage of total pipeline time. */
+struct halide_profiler_user_marker {
+    /** The name the marker was registered under. Not owned; must
+     * remain valid for the life of the process (use a string
+     * literal). */
+    const char *name;
+
+    /** Total time spent between begin and end, in nanoseconds. */
+    uint64_t time;
+
+    /** The number of times the marker was closed. */
+    uint64_t count;
+
+    struct halide_profiler_user_marker *next;
 };
 
 /** Profiler func ids with special meanings. */
@@ -1570,6 +2046,14 @@ enum {
  * inspection. Lock it before using to pause the profiler. */
 extern struct halide_profiler_state *halide_profiler_get_state();
 
+/** Get a pointer to the profiler state that samples for the named
+ * pipeline should be recorded into. This is the global state above
+ * unless per-pipeline profiling has been enabled with
+ * halide_profiler_per_pipeline_enable, in which case it is a state
+ * private to that pipeline. Called by instrumented pipelines on
+ * startup; pipeline_name must be a global constant string. */
+extern struct halide_profiler_state *halide_profiler_instance_state(const char *pipeline_name);
+
 /** Get a pointer to the pipeline state associated with pipeline_name.
  * This function grabs the global profiler state's lock on entry. */
 extern struct halide_profiler_pipeline_stats *halide_profiler_get_pipeline_state(const char *pipeline_name);
@@ -1593,6 +2077,97 @@ void halide_profiler_shutdown();
  * reset. Also happens at process exit. */
 extern void halide_profiler_report(void *user_context);
 
+/** Opt in to profiling of contended runtime locks (the thread pool
+ * work queue, memoization cache shards, and any other halide_mutex,
+ * including user ones). While enabled, every halide_mutex_lock
+ * records an acquisition, and contended acquisitions additionally
+ * record the time spent waiting. The totals appear in
+ * halide_profiler_report, so a scaling plateau can be attributed to a
+ * specific lock. Disabled by default: when off the only cost is one
+ * extra branch per lock. */
+extern void halide_profiler_lock_contention_set_enabled(bool enabled);
+
+/** Add device (GPU) time measured by a device API's own timers to the
+ * stats of the given func. Called by the GPU runtimes when a pipeline
+ * is being profiled; func_id should be the value of
+ * halide_profiler_state::current_func observed when the device work
+ * was launched. */
+extern void halide_profiler_device_time(void *user_context, int func_id, uint64_t time_ns);
+
+/** Start recording a timeline of profiler samples into a ring buffer
+ * holding at most max_events events. Once the buffer fills, the
+ * oldest events are overwritten. The per-Func totals printed by
+ * halide_profiler_report show where time went overall; the timeline
+ * shows when, which is what you need to find gaps between parallel
+ * tasks. Returns zero on success. */
+extern int halide_profiler_timeline_enable(void *user_context, int max_events);
+
+/** Stop recording timeline events and free the ring buffer. Discards
+ * any recorded events, so dump them first if you want them. */
+extern void halide_profiler_timeline_disable();
+
+/** Print the recorded timeline via halide_print as a JSON array of
+ * trace events in the format understood by chrome://tracing (and
+ * other tools that consume it, e.g. speedscope). Each event carries
+ * the func name, begin time and duration in microseconds, and the
+ * number of active threads during the interval. */
+extern void halide_profiler_chrome_trace_report(void *user_context);
+
+/** Start sampling hardware performance counters (instructions
+ * retired, last-level cache misses, and branch misses) alongside the
+ * profiler's time samples, so the per-Func report distinguishes
+ * memory-bound from compute-bound stages. Only implemented on Linux,
+ * via perf_event; returns an error if the counters can't be opened
+ * (e.g. perf_event_paranoid is too restrictive). The counters follow
+ * threads spawned after this call, so enable them before the first
+ * pipeline run. */
+extern int halide_profiler_perf_counters_enable(void *user_context);
+
+/** Stop sampling hardware performance counters and release them.
+ * Totals already attributed to funcs are kept. */
+extern void halide_profiler_perf_counters_disable();
+
+/** Give each pipeline started after this call its own profiler state,
+ * with a private lock and sampling thread. With the default shared
+ * state, pipelines running concurrently in different threads fight
+ * over a single current-func slot and their samples get attributed to
+ * whichever pipeline wrote it last; with per-pipeline states each is
+ * sampled independently. halide_profiler_report and
+ * halide_profiler_shutdown still report all pipelines. Returns zero
+ * on success. */
+extern int halide_profiler_per_pipeline_enable(void *user_context);
+
+/** Route pipelines started after this call back to the shared
+ * profiler state. Stops the per-pipeline sampling threads and folds
+ * the statistics they gathered into the shared state, so nothing is
+ * lost from subsequent reports. Do not call this while a profiled
+ * pipeline is running. */
+extern void halide_profiler_per_pipeline_disable();
+
+/** Add to a named user counter, creating it on first use. Intended
+ * for extern stages that want to report data-dependent events (tiles
+ * skipped, cache hits, etc.); the totals appear in
+ * halide_profiler_report. The name must be valid for the life of the
+ * process, e.g. a string literal. Safe to call concurrently from
+ * multiple threads. */
+extern void halide_profiler_user_counter_add(void *user_context,
+                                             const char *name, uint64_t amount);
+
+/** Mark the start of a named phase of user code, e.g. inside an
+ * extern stage. Returns a token to pass to the matching
+ * halide_profiler_marker_end. Nested and concurrent markers with
+ * different names are fine; a marker's total time and invocation
+ * count appear in halide_profiler_report with a percentage of total
+ * pipeline time. */
+extern uint64_t halide_profiler_marker_begin(void *user_context, const char *name);
+
+/** Close a phase opened by halide_profiler_marker_begin, attributing
+ * the elapsed time to the named marker (created on first use). The
+ * name must be valid for the life of the process, e.g. a string
+ * literal. */
+extern void halide_profiler_marker_end(void *user_context, const char *name,
+                                       uint64_t token);
+
 /// \name "Float16" functions
 /// These functions operate of bits (``uint16_t``) representing a half
 /// precision floating point number (IEEE-754 2008 binary16).
@@ -52,6 +52,60 @@ extern int halide_cuda_wrap_device_ptr(void *user_context, struct halide_buffer_
  */
 extern int halide_cuda_detach_device_ptr(void *user_context, struct halide_buffer_t *buf);
 
+/** Associate a CUDA stream with subsequent pipeline invocations.
+ *  Kernel launches and buffer copies are issued on this stream
+ *  instead of the default stream, so work for one invocation can
+ *  overlap with copies or kernels for another on a different
+ *  stream. The stream must belong to the context returned by
+ *  halide_cuda_acquire_context. Copies to the host are synchronized
+ *  with the stream before returning; for everything else the caller
+ *  is responsible for synchronizing the stream before reading
+ *  results. Pass NULL to return to the default stream. Note that
+ *  halide_cuda_get_stream can instead be replaced entirely for more
+ *  elaborate (e.g. per-thread) stream schemes. */
+extern int halide_cuda_set_stream(void *user_context, struct CUstream_st *stream);
+
+/** Enable or disable pooling of freed device allocations. While the
+ *  pool is enabled, device allocations freed by Halide are kept on a
+ *  size-bucketed freelist and recycled by later allocations of the
+ *  same size class, instead of being returned to the driver with
+ *  cuMemFree (which synchronizes the device). Worthwhile when a
+ *  pipeline makes the same allocations every frame. Disabled by
+ *  default. */
+extern int halide_cuda_enable_memory_pool(void *user_context, int enabled);
+
+/** Return all device allocations held by the memory pool to the
+ *  driver, e.g. to make memory available to other consumers of the
+ *  GPU. Also called automatically if an allocation fails with the
+ *  pool enabled, and on halide_device_release. */
+extern int halide_cuda_release_unused_memory(void *user_context);
+
+/** Allocate host memory as pinned (page-locked) pages with
+ *  cuMemHostAlloc, which lets the CUDA driver DMA to and from it
+ *  directly instead of staging each copy through an internal pinned
+ *  bounce buffer, roughly doubling PCIe transfer throughput for
+ *  large buffers. Intended for use as the allocator hook of
+ *  Halide::Runtime::Buffer (see set_default_allocate_fns in
+ *  HalideBuffer.h); existing pinned buffers can also be wrapped
+ *  without copying using the pointer-wrapping Buffer constructors.
+ *  Returns NULL if no CUDA context is available or the allocation
+ *  fails. Memory allocated with halide_cuda_host_malloc must be
+ *  freed with halide_cuda_host_free. */
+// @{
+extern void *halide_cuda_host_malloc(size_t size);
+extern void halide_cuda_host_free(void *ptr);
+// @}
+
+/** Returns non-zero if combined device-and-host allocations should be
+ *  made from CUDA managed (unified) memory, so that the host and
+ *  device views of a buffer alias the same physical pages and
+ *  copy_to_host/copy_to_device become synchronization points instead
+ *  of copies. The Halide runtime links in a definition returning 1
+ *  when the target has the managed_memory feature and one returning 0
+ *  otherwise; override it to decide at runtime (e.g. based on whether
+ *  the GPU is integrated). */
+extern int halide_cuda_use_managed_memory(void *user_context);
+
 /** Return the underlying device pointer for a halide_buffer_t. This buffer
  *  must be valid on a Cuda device, or not have any associated device
  *  memory. If there is no device memory (dev field is NULL), this
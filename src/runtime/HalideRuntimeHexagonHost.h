@@ -45,12 +45,20 @@ extern int halide_hexagon_detach_device_handle(void *user_context, struct halide
 extern void *halide_hexagon_get_device_handle(void *user_context, struct halide_buffer_t *buf);
 extern uint64_t halide_hexagon_get_device_size(void *user_context, struct halide_buffer_t *buf);
 
+/** ION allocations released by Halide pipelines are kept in a small
+ * pool and reused by later pipeline invocations, to avoid an
+ * allocation and remote mapping per realize. Call this to free
+ * everything held by the pool, e.g. under memory pressure or when no
+ * more pipelines will run for a while. */
+extern int halide_hexagon_release_unused_buffers(void *user_context);
+
 /** Power HVX on and off. Calling a Halide pipeline will do this
- * automatically on each pipeline invocation; however, it costs a
- * small but possibly significant amount of time for short running
- * pipelines. To avoid this cost, HVX can be powered on prior to
- * running several pipelines, and powered off afterwards. If HVX is
- * powered on, subsequent calls to power HVX on will be cheap. */
+ * automatically on each pipeline invocation. The votes are counted:
+ * HVX is powered on when the first vote arrives and powered off when
+ * the last is released, with only those two transitions making a
+ * round trip to the DSP. To keep HVX powered across several pipeline
+ * invocations, power it on beforehand and off afterwards; the
+ * per-invocation votes in between are then serviced locally. */
 // @{
 extern int halide_hexagon_power_hvx_on(void *user_context);
 extern int halide_hexagon_power_hvx_off(void *user_context);
@@ -36,6 +36,20 @@ extern int halide_metal_run(void *user_context,
                             int num_coords_dim1);
 // @}
 
+/** Enable or disable pooling of freed device allocations. While the
+ * pool is enabled, MTLBuffers freed by Halide are kept on a
+ * size-bucketed freelist and recycled by later allocations of the
+ * same size class, instead of being released back to the Metal
+ * driver. Worthwhile when a pipeline makes the same allocations every
+ * frame. Disabled by default. */
+extern int halide_metal_enable_memory_pool(void *user_context, int enabled);
+
+/** Release all MTLBuffers held by the memory pool, e.g. to make
+ * memory available to other consumers of the GPU. Also called
+ * automatically if an allocation fails with the pool enabled, and on
+ * halide_device_release. */
+extern int halide_metal_release_unused_memory(void *user_context);
+
 /** Set the underlying MTLBuffer for a halide_buffer_t. This memory should be
  * allocated using newBufferWithLength:options or similar and must
  * have an extent large enough to cover that specified by the halide_buffer_t
@@ -75,6 +75,20 @@ extern uintptr_t halide_opengl_get_texture(void *user_context, struct halide_buf
  * resources have already been reclaimed by the OS. */
 extern void halide_opengl_context_lost(void *user_context);
 
+/** Enable or disable pooling of freed textures. While the pool is
+ *  enabled, textures allocated by Halide are kept on a freelist when
+ *  freed and recycled by later allocations of identical size and
+ *  format, instead of being deleted with glDeleteTextures (which
+ *  stalls the GPU pipeline on many drivers). Worthwhile when a
+ *  pipeline makes the same allocations every frame. Disabled by
+ *  default. */
+extern int halide_opengl_enable_memory_pool(void *user_context, int enabled);
+
+/** Delete all textures held by the memory pool, e.g. to make memory
+ *  available to other consumers of the GL context. Also called
+ *  automatically on halide_device_release. */
+extern int halide_opengl_release_unused_memory(void *user_context);
+
 /** This functions MUST be provided by the host environment to retrieve pointers
  *  to OpenGL API functions. */
 void *halide_opengl_get_proc_address(void *user_context, const char *name);
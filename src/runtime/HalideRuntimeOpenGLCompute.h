@@ -61,6 +61,20 @@ void *halide_opengl_get_proc_address(void *user_context, const char *name);
  */
 int halide_opengl_create_context(void *user_context);
 
+/** Enable or disable pooling of freed buffer objects. While the pool
+ *  is enabled, buffer objects allocated by Halide are kept on a
+ *  size-bucketed freelist when freed and recycled by later
+ *  allocations of the same size class, instead of being deleted with
+ *  glDeleteBuffers (which stalls the GPU pipeline on many drivers).
+ *  Worthwhile when a pipeline makes the same allocations every frame.
+ *  Disabled by default. */
+extern int halide_openglcompute_enable_memory_pool(void *user_context, int enabled);
+
+/** Delete all buffer objects held by the memory pool, e.g. to make
+ *  memory available to other consumers of the GL context. Also called
+ *  automatically on halide_device_release. */
+extern int halide_openglcompute_release_unused_memory(void *user_context);
+
 #ifdef __cplusplus
 } // End extern "C"
 #endif
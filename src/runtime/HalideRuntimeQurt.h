@@ -20,6 +20,20 @@ extern int halide_qurt_hvx_unlock(void *user_context);
 extern void halide_qurt_hvx_unlock_as_destructor(void *user_context, void * /*obj*/);
 // @}
 
+/** Allocate and free memory in Hexagon's vector tightly-coupled
+ * memory (VTCM). Used to implement MemoryType::VTCM. Only available
+ * on Hexagon targets with VTCM (v65 and later). */
+// @{
+extern void *halide_vtcm_malloc(void *user_context, size_t size);
+extern void halide_vtcm_free(void *user_context, void *ptr);
+// @}
+
+/** Set the maximum number of bytes the QuRT runtime allocator will
+ * hold on to for reuse by later allocations. Setting the capacity
+ * below the number of bytes currently pooled frees pooled buffers
+ * until the pool fits. */
+extern void halide_qurt_set_malloc_pool_capacity(void *user_context, size_t bytes);
+
 #ifdef __cplusplus
 } // End extern "C"
 #endif
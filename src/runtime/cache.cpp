@@ -75,6 +75,18 @@ struct CacheEntry {
     uint32_t hash;
     uint32_t in_use_count; // 0 if none returned from halide_cache_lookup
     uint32_t tuple_count;
+    // Scaled recompute cost of the entry (ns << 8 per byte), measured
+    // between the cache miss and the store that filled it. Used to
+    // evict cheap-to-recompute entries first.
+    uint64_t cost_per_byte;
+    // Bytes of device memory held by the tuple buffers, counted
+    // against the device budget.
+    uint64_t device_bytes;
+    // An optional tag (from Func::memoize(eviction_key)) that
+    // halide_memoization_cache_evict matches on to flush groups of
+    // entries together. Plays no part in lookup.
+    bool has_eviction_key;
+    uint64_t eviction_key;
     // The shape of the computed data. There may be more data allocated than this.
     int32_t dimensions;
     halide_dimension_t *computed_bounds;
@@ -84,7 +96,8 @@ struct CacheEntry {
     bool init(const uint8_t *cache_key, size_t cache_key_size,
               uint32_t key_hash,
               const halide_buffer_t *computed_bounds_buf,
-              int32_t tuples, halide_buffer_t **tuple_buffers);
+              int32_t tuples, halide_buffer_t **tuple_buffers,
+              bool has_eviction_key_arg, uint64_t eviction_key_arg);
     void destroy();
     halide_buffer_t &buffer(int32_t i);
 
@@ -93,6 +106,9 @@ struct CacheEntry {
 struct CacheBlockHeader {
     CacheEntry *entry;
     uint32_t hash;
+    // Time of the cache miss that handed this block out, so the store
+    // that fills it can compute the recompute cost.
+    uint64_t compute_start_ns;
 };
 
 // Each host block has extra space to store a header just before the
@@ -112,7 +128,8 @@ WEAK CacheBlockHeader *get_pointer_to_header(uint8_t * host) {
 
 WEAK bool CacheEntry::init(const uint8_t *cache_key, size_t cache_key_size,
                            uint32_t key_hash, const halide_buffer_t *computed_bounds_buf,
-                           int32_t tuples, halide_buffer_t **tuple_buffers) {
+                           int32_t tuples, halide_buffer_t **tuple_buffers,
+                           bool has_eviction_key_arg, uint64_t eviction_key_arg) {
     next = NULL;
     more_recent = NULL;
     less_recent = NULL;
@@ -120,6 +137,10 @@ WEAK bool CacheEntry::init(const uint8_t *cache_key, size_t cache_key_size,
     hash = key_hash;
     in_use_count = 0;
     tuple_count = tuples;
+    cost_per_byte = 0;
+    device_bytes = 0;
+    has_eviction_key = has_eviction_key_arg;
+    eviction_key = eviction_key_arg;
     dimensions = computed_bounds_buf->dimensions;
 
     // Allocate all the necessary space (or die)
@@ -185,27 +206,80 @@ WEAK uint32_t djb_hash(const uint8_t *key, size_t key_size)  {
     return h;
 }
 
-WEAK halide_mutex memoization_lock = { { 0 } };
-
 const size_t kHashTableSize = 256;
+const uint64_t kDefaultCacheSize = 1 << 20;
 
-WEAK CacheEntry *cache_entries[kHashTableSize];
+// The cache is split into shards, selected by key hash, each with its
+// own lock, hash table, LRU chain, and size budget. Concurrent
+// lookups and stores from different pipeline instances only contend
+// when they land on the same shard.
+const size_t kNumShards = 16;
 
-WEAK CacheEntry *most_recently_used = NULL;
-WEAK CacheEntry *least_recently_used = NULL;
+struct CacheShard {
+    halide_mutex lock;
 
-const uint64_t kDefaultCacheSize = 1 << 20;
+    CacheEntry *entries[kHashTableSize];
+
+    CacheEntry *most_recently_used;
+    CacheEntry *least_recently_used;
+
+    int64_t current_size;
+    int64_t current_device_size;
+
+    // Statistics, updated under the shard lock.
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t stores;
+    uint64_t evictions;
+
+    // Unlink and deallocate one entry. Must be called with the shard
+    // lock held, and the entry must not be in use.
+    void evict(CacheEntry *entry);
+
+    // Evict entries until this shard is back under its budget. Must
+    // be called with the shard lock held.
+    void prune();
+
+#if CACHE_DEBUGGING
+    void validate();
+#endif
+};
+
+// The total cache size budget, split evenly across the shards.
 WEAK int64_t max_cache_size = kDefaultCacheSize;
-WEAK int64_t current_cache_size = 0;
+
+// A separate budget for entries that hold device (GPU) memory, so
+// device-resident results can be kept across pipeline invocations
+// without round trips through host memory, while still bounding the
+// device memory the cache pins.
+WEAK int64_t max_device_cache_size = kDefaultCacheSize;
+
+WEAK CacheShard cache_shards[kNumShards];
+
+// Label the shard locks for the contended-lock section of
+// halide_profiler_report. Racing here is benign; naming is idempotent.
+WEAK bool cache_shards_named = false;
+
+WEAK __attribute((always_inline)) CacheShard *shard_for_hash(uint32_t h) {
+    if (!cache_shards_named) {
+        cache_shards_named = true;
+        for (size_t i = 0; i < kNumShards; i++) {
+            halide_mutex_set_name(&cache_shards[i].lock, "memoization cache shard");
+        }
+    }
+    // The low bits of the hash pick the bucket within a shard, so use
+    // different bits to pick the shard.
+    return &cache_shards[(h / kHashTableSize) % kNumShards];
+}
 
 #if CACHE_DEBUGGING
-WEAK void validate_cache() {
-    print(NULL) << "validating cache, "
-                << "current size " << current_cache_size
-                << " of maximum " << max_cache_size << "\n";
+WEAK void CacheShard::validate() {
+    print(NULL) << "validating cache shard, "
+                << "current size " << current_size
+                << " of maximum " << (max_cache_size / (int64_t)kNumShards) << "\n";
     int entries_in_hash_table = 0;
     for (size_t i = 0; i < kHashTableSize; i++) {
-        CacheEntry *entry = cache_entries[i];
+        CacheEntry *entry = entries[i];
         while (entry != NULL) {
             entries_in_hash_table++;
             if (entry->more_recent == NULL && entry != most_recently_used) {
@@ -242,68 +316,97 @@ WEAK void validate_cache() {
         halide_print(NULL, "cache invalid case 4\n");
         __builtin_trap();
     }
-    if (current_cache_size < 0) {
+    if (current_size < 0) {
         halide_print(NULL, "cache size is negative\n");
         __builtin_trap();
     }
 }
 #endif
 
-WEAK void prune_cache() {
-#if CACHE_DEBUGGING
-    validate_cache();
-#endif
-    CacheEntry *prune_candidate = least_recently_used;
-    while (current_cache_size > max_cache_size &&
-           prune_candidate != NULL) {
-        CacheEntry *more_recent = prune_candidate->more_recent;
-
-        if (prune_candidate->in_use_count == 0) {
-            uint32_t h = prune_candidate->hash;
-            uint32_t index = h % kHashTableSize;
-
-            // Remove from hash table
-            CacheEntry *prev_hash_entry = cache_entries[index];
-            if (prev_hash_entry == prune_candidate) {
-                cache_entries[index] = prune_candidate->next;
-            } else {
-                while (prev_hash_entry != NULL && prev_hash_entry->next != prune_candidate) {
-                    prev_hash_entry = prev_hash_entry->next;
-                }
-                halide_assert(NULL, prev_hash_entry != NULL);
-                prev_hash_entry->next = prune_candidate->next;
-            }
+WEAK void CacheShard::evict(CacheEntry *prune_candidate) {
+    CacheEntry *more_recent = prune_candidate->more_recent;
+    uint32_t h = prune_candidate->hash;
+    uint32_t index = h % kHashTableSize;
 
-            // Remove from less recent chain.
-            if (least_recently_used == prune_candidate) {
-                least_recently_used = more_recent;
-            }
-            if (more_recent != NULL) {
-                more_recent->less_recent = prune_candidate->less_recent;
-            }
+    // Remove from hash table
+    CacheEntry *prev_hash_entry = entries[index];
+    if (prev_hash_entry == prune_candidate) {
+        entries[index] = prune_candidate->next;
+    } else {
+        while (prev_hash_entry != NULL && prev_hash_entry->next != prune_candidate) {
+            prev_hash_entry = prev_hash_entry->next;
+        }
+        halide_assert(NULL, prev_hash_entry != NULL);
+        prev_hash_entry->next = prune_candidate->next;
+    }
 
-            // Remove from more recent chain.
-            if (most_recently_used == prune_candidate) {
-                most_recently_used = prune_candidate->less_recent;
-            }
-            if (prune_candidate->less_recent != NULL) {
-                prune_candidate->less_recent = more_recent;
-            }
+    // Remove from less recent chain.
+    if (least_recently_used == prune_candidate) {
+        least_recently_used = more_recent;
+    }
+    if (more_recent != NULL) {
+        more_recent->less_recent = prune_candidate->less_recent;
+    }
 
-            // Decrease cache used amount.
-            for (uint32_t i = 0; i < prune_candidate->tuple_count; i++) {
-                current_cache_size -= prune_candidate->buf[i].size_in_bytes();
-            }
+    // Remove from more recent chain.
+    if (most_recently_used == prune_candidate) {
+        most_recently_used = prune_candidate->less_recent;
+    }
+    if (prune_candidate->less_recent != NULL) {
+        prune_candidate->less_recent = more_recent;
+    }
 
-            // Deallocate the entry.
-            prune_candidate->destroy();
-            halide_free(NULL, prune_candidate);
-        }
+    // Decrease cache used amount.
+    for (uint32_t i = 0; i < prune_candidate->tuple_count; i++) {
+        current_size -= prune_candidate->buf[i].size_in_bytes();
+    }
+    current_device_size -= prune_candidate->device_bytes;
+
+    // Deallocate the entry.
+    prune_candidate->destroy();
+    halide_free(NULL, prune_candidate);
+    evictions++;
+}
 
-        prune_candidate = more_recent;
+WEAK void CacheShard::prune() {
+#if CACHE_DEBUGGING
+    validate();
+#endif
+    const int64_t max_size = max_cache_size / (int64_t)kNumShards;
+    const int64_t max_device_size = max_device_cache_size / (int64_t)kNumShards;
+    while (current_size > max_size || current_device_size > max_device_size) {
+        // If only the device budget is exceeded, only entries
+        // holding device memory are worth evicting.
+        bool device_only = current_size <= max_size;
+
+        // Consider a small window of the least recently used entries
+        // and evict the one with the lowest recompute cost per byte,
+        // so that one cheap-to-recompute large entry goes before
+        // several expensive small ones of the same age.
+        const int kPruneWindow = 8;
+        CacheEntry *candidate = NULL;
+        int considered = 0;
+        for (CacheEntry *walk = least_recently_used;
+             walk != NULL && considered < kPruneWindow;
+             walk = walk->more_recent) {
+            if (walk->in_use_count != 0 ||
+                (device_only && walk->device_bytes == 0)) {
+                continue;
+            }
+            considered++;
+            if (candidate == NULL ||
+                walk->cost_per_byte < candidate->cost_per_byte) {
+                candidate = walk;
+            }
+        }
+        if (candidate == NULL) {
+            // Every eligible entry is in use.
+            break;
+        }
+        evict(candidate);
     }
 #if CACHE_DEBUGGING
-    validate_cache();
+    validate();
 #endif
 }
 
@@ -316,10 +419,27 @@ WEAK void halide_memoization_cache_set_size(int64_t size) {
         size = kDefaultCacheSize;
     }
 
-    ScopedMutexLock lock(&memoization_lock);
-
     max_cache_size = size;
-    prune_cache();
+
+    for (size_t i = 0; i < kNumShards; i++) {
+        CacheShard *shard = &cache_shards[i];
+        ScopedMutexLock lock(&shard->lock);
+        shard->prune();
+    }
+}
+
+WEAK void halide_memoization_cache_set_device_size(int64_t size) {
+    if (size == 0) {
+        size = kDefaultCacheSize;
+    }
+
+    max_device_cache_size = size;
+
+    for (size_t i = 0; i < kNumShards; i++) {
+        CacheShard *shard = &cache_shards[i];
+        ScopedMutexLock lock(&shard->lock);
+        shard->prune();
+    }
 }
 
 WEAK int halide_memoization_cache_lookup(void *user_context, const uint8_t *cache_key, int32_t size,
@@ -327,7 +447,8 @@ WEAK int halide_memoization_cache_lookup(void *user_context, const uint8_t *cach
     uint32_t h = djb_hash(cache_key, size);
     uint32_t index = h % kHashTableSize;
 
-    ScopedMutexLock lock(&memoization_lock);
+    CacheShard *shard = shard_for_hash(h);
+    ScopedMutexLock lock(&shard->lock);
 
 #if CACHE_DEBUGGING
     debug_print_key(user_context, "halide_memoization_cache_lookup", cache_key, size);
@@ -342,7 +463,7 @@ WEAK int halide_memoization_cache_lookup(void *user_context, const uint8_t *cach
     }
 #endif
 
-    CacheEntry *entry = cache_entries[index];
+    CacheEntry *entry = shard->entries[index];
     while (entry != NULL) {
         if (entry->hash == h && entry->key_size == (size_t)size &&
             keys_equal(entry->key, cache_key, size) &&
@@ -356,23 +477,23 @@ WEAK int halide_memoization_cache_lookup(void *user_context, const uint8_t *cach
             }
 
             if (all_bounds_equal) {
-                if (entry != most_recently_used) {
+                if (entry != shard->most_recently_used) {
                     halide_assert(user_context, entry->more_recent != NULL);
                     if (entry->less_recent != NULL) {
                         entry->less_recent->more_recent = entry->more_recent;
                     } else {
-                        halide_assert(user_context, least_recently_used == entry);
-                        least_recently_used = entry->more_recent;
+                        halide_assert(user_context, shard->least_recently_used == entry);
+                        shard->least_recently_used = entry->more_recent;
                     }
                     halide_assert(user_context, entry->more_recent != NULL);
                     entry->more_recent->less_recent = entry->less_recent;
 
                     entry->more_recent = NULL;
-                    entry->less_recent = most_recently_used;
-                    if (most_recently_used != NULL) {
-                        most_recently_used->more_recent = entry;
+                    entry->less_recent = shard->most_recently_used;
+                    if (shard->most_recently_used != NULL) {
+                        shard->most_recently_used->more_recent = entry;
                     }
-                    most_recently_used = entry;
+                    shard->most_recently_used = entry;
                 }
 
                 for (int32_t i = 0; i < tuple_count; i++) {
@@ -381,6 +502,7 @@ WEAK int halide_memoization_cache_lookup(void *user_context, const uint8_t *cach
                 }
 
                 entry->in_use_count += tuple_count;
+                shard->hits++;
 
                 return 0;
             }
@@ -403,10 +525,13 @@ WEAK int halide_memoization_cache_lookup(void *user_context, const uint8_t *cach
         CacheBlockHeader *header = get_pointer_to_header(buf->host);
         header->hash = h;
         header->entry = NULL;
+        header->compute_start_ns = halide_current_time_ns(user_context);
     }
 
+    shard->misses++;
+
 #if CACHE_DEBUGGING
-    validate_cache();
+    shard->validate();
 #endif
 
     return 1;
@@ -414,14 +539,16 @@ WEAK int halide_memoization_cache_lookup(void *user_context, const uint8_t *cach
 
 WEAK int halide_memoization_cache_store(void *user_context, const uint8_t *cache_key, int32_t size,
                                         halide_buffer_t *computed_bounds,
-                                        int32_t tuple_count, halide_buffer_t **tuple_buffers) {
+                                        int32_t tuple_count, halide_buffer_t **tuple_buffers,
+                                        int32_t has_eviction_key, uint64_t eviction_key) {
     debug(user_context) << "halide_memoization_cache_store\n";
 
     uint32_t h = get_pointer_to_header(tuple_buffers[0]->host)->hash;
 
     uint32_t index = h % kHashTableSize;
 
-    ScopedMutexLock lock(&memoization_lock);
+    CacheShard *shard = shard_for_hash(h);
+    ScopedMutexLock lock(&shard->lock);
 
 #if CACHE_DEBUGGING
     debug_print_key(user_context, "halide_memoization_cache_store", cache_key, size);
@@ -436,7 +563,7 @@ WEAK int halide_memoization_cache_store(void *user_context, const uint8_t *cache
     }
 #endif
 
-    CacheEntry *entry = cache_entries[index];
+    CacheEntry *entry = shard->entries[index];
     while (entry != NULL) {
         if (entry->hash == h && entry->key_size == (size_t)size &&
             keys_equal(entry->key, cache_key, size) &&
@@ -469,22 +596,44 @@ WEAK int halide_memoization_cache_store(void *user_context, const uint8_t *cache
     }
 
     uint64_t added_size = 0;
+    uint64_t added_device_size = 0;
     {
         for (int32_t i = 0; i < tuple_count; i++) {
             halide_buffer_t *buf = tuple_buffers[i];
             added_size += buf->size_in_bytes();
+            if (buf->device != 0) {
+                // The entry keeps the device allocation resident, so
+                // a later hit doesn't have to re-upload.
+                added_device_size += buf->size_in_bytes();
+            }
+        }
+    }
+
+    // The blocks were stamped with the time of the miss that handed
+    // them out, so the gap to now is the cost of recomputing this
+    // entry. Keep it scaled per byte for the eviction policy.
+    uint64_t compute_start_ns = get_pointer_to_header(tuple_buffers[0]->host)->compute_start_ns;
+    uint64_t compute_cost_ns = 0;
+    if (compute_start_ns != 0) {
+        int64_t now = halide_current_time_ns(user_context);
+        if (now > (int64_t)compute_start_ns) {
+            compute_cost_ns = now - compute_start_ns;
         }
     }
-    current_cache_size += added_size;
-    prune_cache();
+
+    shard->current_size += added_size;
+    shard->current_device_size += added_device_size;
+    shard->prune();
 
     CacheEntry *new_entry = (CacheEntry *)halide_malloc(NULL, sizeof(CacheEntry));
     bool inited = false;
     if (new_entry) {
-        inited = new_entry->init(cache_key, size, h, computed_bounds, tuple_count, tuple_buffers);
+        inited = new_entry->init(cache_key, size, h, computed_bounds, tuple_count, tuple_buffers,
+                                 has_eviction_key != 0, eviction_key);
     }
     if (!inited) {
-        current_cache_size -= added_size;
+        shard->current_size -= added_size;
+        shard->current_device_size -= added_device_size;
 
         // This entry is still in use by the caller. Mark it as having no cache entry
         // so halide_memoization_cache_release can free the buffer.
@@ -498,31 +647,59 @@ WEAK int halide_memoization_cache_store(void *user_context, const uint8_t *cache
         return 0;
     }
 
-    new_entry->next = cache_entries[index];
-    new_entry->less_recent = most_recently_used;
-    if (most_recently_used != NULL) {
-        most_recently_used->more_recent = new_entry;
+    new_entry->next = shard->entries[index];
+    new_entry->less_recent = shard->most_recently_used;
+    if (shard->most_recently_used != NULL) {
+        shard->most_recently_used->more_recent = new_entry;
     }
-    most_recently_used = new_entry;
-    if (least_recently_used == NULL) {
-        least_recently_used = new_entry;
+    shard->most_recently_used = new_entry;
+    if (shard->least_recently_used == NULL) {
+        shard->least_recently_used = new_entry;
     }
-    cache_entries[index] = new_entry;
+    shard->entries[index] = new_entry;
 
     new_entry->in_use_count = tuple_count;
+    new_entry->cost_per_byte = (compute_cost_ns << 8) / (added_size ? added_size : 1);
+    new_entry->device_bytes = added_device_size;
+    shard->stores++;
 
     for (int32_t i = 0; i < tuple_count; i++) {
         get_pointer_to_header(tuple_buffers[i]->host)->entry = new_entry;
     }
 
 #if CACHE_DEBUGGING
-    validate_cache();
+    shard->validate();
 #endif
     debug(user_context) << "Exiting halide_memoization_cache_store\n";
 
     return 0;
 }
 
+WEAK void halide_memoization_cache_evict(void *user_context, uint64_t eviction_key) {
+    debug(user_context) << "halide_memoization_cache_evict\n";
+
+    for (size_t i = 0; i < kNumShards; i++) {
+        CacheShard *shard = &cache_shards[i];
+        ScopedMutexLock lock(&shard->lock);
+        // Walk the LRU chain rather than the hash table so that
+        // evict(), which unlinks from both, can be reused. The next
+        // pointer is saved first because evict frees the entry.
+        CacheEntry *entry = shard->least_recently_used;
+        while (entry != NULL) {
+            CacheEntry *more_recent = entry->more_recent;
+            if (entry->has_eviction_key &&
+                entry->eviction_key == eviction_key &&
+                entry->in_use_count == 0) {
+                shard->evict(entry);
+            }
+            entry = more_recent;
+        }
+#if CACHE_DEBUGGING
+        shard->validate();
+#endif
+    }
+}
+
 WEAK void halide_memoization_cache_release(void *user_context, void *host) {
     CacheBlockHeader *header = get_pointer_to_header((uint8_t *)host);
     debug(user_context) << "halide_memoization_cache_release\n";
@@ -531,33 +708,101 @@ WEAK void halide_memoization_cache_release(void *user_context, void *host) {
     if (entry == NULL) {
         halide_free(user_context, header);
     } else {
-        ScopedMutexLock lock(&memoization_lock);
+        CacheShard *shard = shard_for_hash(entry->hash);
+        ScopedMutexLock lock(&shard->lock);
 
         halide_assert(user_context, entry->in_use_count > 0);
         entry->in_use_count--;
 #if CACHE_DEBUGGING
-        validate_cache();
+        shard->validate();
 #endif
     }
 
     debug(user_context) << "Exited halide_memoization_cache_release.\n";
 }
 
+WEAK int halide_memoization_cache_detach(void *user_context, halide_buffer_t *buf) {
+    if (buf == NULL || buf->host == NULL) {
+        return 0;
+    }
+
+    CacheBlockHeader *header = get_pointer_to_header(buf->host);
+    CacheEntry *entry = header->entry;
+    if (entry == NULL) {
+        // Already privately owned (a cache miss, or a previous detach).
+        return 0;
+    }
+
+    debug(user_context) << "halide_memoization_cache_detach\n";
+
+    // Replace the aliased storage with a private copy-on-write copy.
+    uint8_t *new_host = (uint8_t *)halide_malloc(user_context, buf->size_in_bytes() + header_bytes());
+    if (new_host == NULL) {
+        return -1;
+    }
+    new_host += header_bytes();
+    CacheBlockHeader *new_header = get_pointer_to_header(new_host);
+    new_header->hash = header->hash;
+    new_header->entry = NULL;
+    memcpy(new_host, buf->host, buf->size_in_bytes());
+    buf->host = new_host;
+
+    // Drop the reference to the shared entry.
+    {
+        CacheShard *shard = shard_for_hash(entry->hash);
+        ScopedMutexLock lock(&shard->lock);
+        halide_assert(user_context, entry->in_use_count > 0);
+        entry->in_use_count--;
+#if CACHE_DEBUGGING
+        shard->validate();
+#endif
+    }
+
+    return 0;
+}
+
+WEAK void halide_memoization_cache_get_stats(struct halide_memoization_cache_stats *stats) {
+    stats->hits = 0;
+    stats->misses = 0;
+    stats->stores = 0;
+    stats->evictions = 0;
+    stats->bytes_in_use = 0;
+    stats->size_limit = 0;
+    stats->device_bytes_in_use = 0;
+    stats->device_size_limit = 0;
+    for (size_t i = 0; i < kNumShards; i++) {
+        CacheShard *shard = &cache_shards[i];
+        ScopedMutexLock lock(&shard->lock);
+        stats->hits += shard->hits;
+        stats->misses += shard->misses;
+        stats->stores += shard->stores;
+        stats->evictions += shard->evictions;
+        stats->bytes_in_use += shard->current_size;
+        stats->device_bytes_in_use += shard->current_device_size;
+    }
+    stats->size_limit = max_cache_size;
+    stats->device_size_limit = max_device_cache_size;
+}
+
 WEAK void halide_memoization_cache_cleanup() {
     debug(NULL) << "halide_memoization_cache_cleanup\n";
-    for (size_t i = 0; i < kHashTableSize; i++) {
-        CacheEntry *entry = cache_entries[i];
-        cache_entries[i] = NULL;
-        while (entry != NULL) {
-            CacheEntry *next = entry->next;
-            entry->destroy();
-            halide_free(NULL, entry);
-            entry = next;
+    for (size_t s = 0; s < kNumShards; s++) {
+        CacheShard *shard = &cache_shards[s];
+        for (size_t i = 0; i < kHashTableSize; i++) {
+            CacheEntry *entry = shard->entries[i];
+            shard->entries[i] = NULL;
+            while (entry != NULL) {
+                CacheEntry *next = entry->next;
+                entry->destroy();
+                halide_free(NULL, entry);
+                entry = next;
+            }
         }
+        shard->current_size = 0;
+        shard->current_device_size = 0;
+        shard->most_recently_used = NULL;
+        shard->least_recently_used = NULL;
     }
-    current_cache_size = 0;
-    most_recently_used = NULL;
-    least_recently_used = NULL;
 }
 
 namespace {
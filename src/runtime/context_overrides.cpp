@@ -0,0 +1,114 @@
+#include "HalideRuntime.h"
+#include "runtime_internal.h"
+#include "scoped_spin_lock.h"
+
+// A registry mapping user_context pointers to per-context runtime
+// hook overrides. The process-global hooks installed via
+// halide_set_custom_malloc and friends remain the fallback; the
+// default dispatchers consult this registry first, so two pipelines
+// in one process can use different allocators, thread pools, or error
+// handlers without racing on the globals.
+//
+// Lookups happen on hot paths (every halide_malloc), so they are
+// lock-free: the table is open-addressed, keys are written exactly
+// once (registering NULL overrides clears the value but keeps the
+// key), and a count of live keys lets contexts that never registered
+// anything bail out after a single load. Registration takes a spin
+// lock and is expected to happen before the context is used from
+// other threads.
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+namespace {
+
+// Must be a power of two. 64 contexts with distinct override sets is
+// already an unusually elaborate process; the table is tiny so we can
+// afford slack to keep probe sequences short.
+const int overrides_table_size = 64;
+
+struct overrides_entry {
+    void *context;
+    const halide_runtime_overrides_t *overrides;
+};
+
+}
+
+WEAK overrides_entry overrides_table[overrides_table_size];
+WEAK int overrides_table_lock = 0;
+// Incremented when a key is first inserted, never decremented. Read
+// without the lock as the empty-registry fast path.
+WEAK int overrides_registered = 0;
+
+namespace {
+
+__attribute__((always_inline)) int overrides_hash(void *context) {
+    uintptr_t p = (uintptr_t)context;
+    // The low bits of a heap or stack pointer carry no information.
+    p >>= 4;
+    // Knuth's multiplicative hash.
+    p *= (uintptr_t)2654435761u;
+    return (int)(p & (overrides_table_size - 1));
+}
+
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+extern "C" {
+
+WEAK int halide_set_context_overrides(void *user_context,
+                                      const halide_runtime_overrides_t *overrides) {
+    if (user_context == NULL) {
+        // NULL is what pipelines without a user context parameter
+        // pass; it can't identify a tenant.
+        return halide_error_code_generic_error;
+    }
+    ScopedSpinLock lock(&overrides_table_lock);
+    int idx = overrides_hash(user_context);
+    for (int probe = 0; probe < overrides_table_size; probe++) {
+        overrides_entry *e = &overrides_table[idx];
+        if (e->context == user_context) {
+            e->overrides = overrides;
+            return 0;
+        }
+        if (e->context == NULL) {
+            if (overrides == NULL) {
+                // Clearing something never registered is a no-op.
+                return 0;
+            }
+            e->overrides = overrides;
+            // Publish the value before the key, so a concurrent
+            // lock-free lookup can never see the key with a stale
+            // value.
+            __sync_synchronize();
+            e->context = user_context;
+            overrides_registered++;
+            return 0;
+        }
+        idx = (idx + 1) & (overrides_table_size - 1);
+    }
+    return halide_error_code_out_of_memory;
+}
+
+WEAK const halide_runtime_overrides_t *halide_get_context_overrides(void *user_context) {
+    if (user_context == NULL || overrides_registered == 0) {
+        return NULL;
+    }
+    int idx = overrides_hash(user_context);
+    for (int probe = 0; probe < overrides_table_size; probe++) {
+        // Keys are written at most once, after their value, so a
+        // plain load either sees NULL (stop: keys are never removed,
+        // so the probe chain ends here) or a fully-published entry.
+        void *ctx = overrides_table[idx].context;
+        if (ctx == user_context) {
+            return overrides_table[idx].overrides;
+        }
+        if (ctx == NULL) {
+            return NULL;
+        }
+        idx = (idx + 1) & (overrides_table_size - 1);
+    }
+    return NULL;
+}
+
+}
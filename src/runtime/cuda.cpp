@@ -1,6 +1,7 @@
 #include "HalideRuntimeCuda.h"
 #include "device_buffer_utils.h"
 #include "device_interface.h"
+#include "gpu_kernel_cache.h"
 #include "printer.h"
 #include "mini_cuda.h"
 #include "scoped_spin_lock.h"
@@ -14,6 +15,7 @@ namespace Halide { namespace Runtime { namespace Internal { namespace Cuda {
 #define CUDA_FN_OPTIONAL(ret, fn, args) WEAK ret (CUDAAPI *fn)args;
 #define CUDA_FN_3020(ret, fn, fn_3020, args) WEAK ret (CUDAAPI *fn)args;
 #define CUDA_FN_4000(ret, fn, fn_4000, args) WEAK ret (CUDAAPI *fn)args;
+#define CUDA_FN_OPTIONAL_3020(ret, fn, fn_3020, args) WEAK ret (CUDAAPI *fn)args;
 #include "cuda_functions.h"
 
 // The default implementation of halide_cuda_get_symbol attempts to load
@@ -67,19 +69,102 @@ WEAK void load_libcuda(void *user_context) {
     #define CUDA_FN_OPTIONAL(ret, fn, args) fn = get_cuda_symbol<ret (CUDAAPI *)args>(user_context, #fn, true);
     #define CUDA_FN_3020(ret, fn, fn_3020, args) fn = get_cuda_symbol<ret (CUDAAPI *)args>(user_context, #fn_3020);
     #define CUDA_FN_4000(ret, fn, fn_4000, args) fn = get_cuda_symbol<ret (CUDAAPI *)args>(user_context, #fn_4000);
+    #define CUDA_FN_OPTIONAL_3020(ret, fn, fn_3020, args) fn = get_cuda_symbol<ret (CUDAAPI *)args>(user_context, #fn_3020, true);
     #include "cuda_functions.h"
 }
 
 extern WEAK halide_device_interface_t cuda_device_interface;
 
-WEAK const char *get_error_name(CUresult error);
-WEAK CUresult create_cuda_context(void *user_context, CUcontext *ctx);
+extern "C" WEAK int halide_cuda_device_sync(void *user_context, struct halide_buffer_t *);
 
-// A cuda context defined in this module with weak linkage
-CUcontext WEAK context = 0;
-// This spinlock protexts the above context variable.
+WEAK const char *get_error_name(CUresult error);
+WEAK CUresult create_cuda_context(void *user_context, CUcontext *ctx, int *device);
+
+// Cuda contexts defined in this module with weak linkage, one per
+// device ordinal. Which one an invocation uses is chosen by
+// halide_get_gpu_device, which may be overridden to return a
+// different device per user_context, so the same compiled pipeline
+// can run concurrently on different devices from different threads.
+// The module registry below already keeps separate module state per
+// context.
+const int max_cuda_devices = 16;
+CUcontext WEAK device_contexts[max_cuda_devices];
+// The device ordinal used when halide_get_gpu_device returns -1,
+// resolved once on first context creation.
+WEAK int default_cuda_device = -1;
+// This spinlock protects the two variables above.
 volatile int WEAK context_lock = 0;
 
+// The stream returned by the default halide_cuda_get_stream, set via
+// halide_cuda_set_stream. NULL means the default stream.
+CUstream WEAK custom_stream = NULL;
+
+// An opt-in pool of freed device allocations, bucketed by
+// power-of-two size class. cuMemFree synchronizes the device, so
+// recycling steady-state per-frame allocations instead of returning
+// them to the driver is worth milliseconds per frame. Enabled via
+// halide_cuda_enable_memory_pool; drained via
+// halide_cuda_release_unused_memory.
+struct pool_block {
+    pool_block *next;
+    CUdeviceptr ptr;
+    CUcontext ctx;
+};
+
+// Buckets cover sizes from 2^min_pool_bucket_bits up; anything larger
+// bypasses the pool.
+const int min_pool_bucket_bits = 6;
+const int num_pool_buckets = 40;
+pool_block *WEAK pool_buckets[num_pool_buckets];
+volatile int WEAK pool_lock = 0;
+WEAK bool pool_enabled = false;
+
+// Map a size to its bucket, rounding the size up to the bucket's
+// block size. Returns a negative bucket for sizes the pool doesn't
+// handle.
+WEAK int pool_bucket_for_size(size_t *size) {
+    for (int b = 0; b < num_pool_buckets; b++) {
+        size_t block_size = (size_t)1 << (b + min_pool_bucket_bits);
+        if (*size <= block_size) {
+            *size = block_size;
+            return b;
+        }
+    }
+    return -1;
+}
+
+// Return every block held in the pool to the driver. Called with the
+// pool lock *not* held.
+WEAK void pool_release_all(void *user_context) {
+    if (cuMemFree == NULL) {
+        return;
+    }
+    pool_block *blocks = NULL;
+    {
+        ScopedSpinLock spinlock(&pool_lock);
+        for (int b = 0; b < num_pool_buckets; b++) {
+            pool_block *list = pool_buckets[b];
+            while (list != NULL) {
+                pool_block *next = list->next;
+                list->next = blocks;
+                blocks = list;
+                list = next;
+            }
+            pool_buckets[b] = NULL;
+        }
+    }
+    while (blocks != NULL) {
+        pool_block *next = blocks->next;
+        CUcontext old;
+        cuCtxPushCurrent(blocks->ctx);
+        debug(user_context) << "    cuMemFree (pooled) " << (void *)blocks->ptr << "\n";
+        cuMemFree(blocks->ptr);
+        cuCtxPopCurrent(&old);
+        halide_free(user_context, blocks);
+        blocks = next;
+    }
+}
+
 }}}} // namespace Halide::Runtime::Internal::Cuda
 
 using namespace Halide::Runtime::Internal;
@@ -87,8 +172,12 @@ using namespace Halide::Runtime::Internal::Cuda;
 
 extern "C" {
 
-// The default implementation of halide_cuda_acquire_context uses the global
-// pointers above, and serializes access with a spin lock.
+// The default implementation of halide_cuda_acquire_context keeps a
+// table of contexts above, one per device ordinal, and serializes
+// access with a spin lock. The device used for a given invocation is
+// whatever halide_get_gpu_device(user_context) returns, so overriding
+// that function allows the same compiled pipeline to run concurrently
+// on different devices from different threads.
 // Overriding implementations of acquire/release must implement the following
 // behavior:
 // - halide_cuda_acquire_context should always store a valid context/command
@@ -101,15 +190,22 @@ WEAK int halide_cuda_acquire_context(void *user_context, CUcontext *ctx, bool cr
     // not block execution on failure.
     halide_assert(user_context, ctx != NULL);
 
-    // If the context has not been initialized, initialize it now.
-    halide_assert(user_context, &context != NULL);
+    // Which device to use for this invocation. -1 means pick a
+    // default device on first use.
+    int device = halide_get_gpu_device(user_context);
+    if (device < -1 || device >= max_cuda_devices) {
+        error(user_context) << "CUDA: Requested device " << device
+                            << " is out of range.";
+        return CUDA_ERROR_INVALID_DEVICE;
+    }
 
     // Note that this null-check of the context is *not* locked with
     // respect to device_release, so we may get a non-null context
     // that's in the process of being destroyed. Things will go badly
     // in general if you call device_release while other Halide code
     // is running though.
-    CUcontext local_val = context;
+    int slot = (device == -1) ? default_cuda_device : device;
+    CUcontext local_val = (slot >= 0) ? device_contexts[slot] : NULL;
     if (local_val == NULL) {
         if (!create) {
             *ctx = NULL;
@@ -118,20 +214,31 @@ WEAK int halide_cuda_acquire_context(void *user_context, CUcontext *ctx, bool cr
 
         {
             ScopedSpinLock spinlock(&context_lock);
-            local_val = context;
+            slot = (device == -1) ? default_cuda_device : device;
+            local_val = (slot >= 0) ? device_contexts[slot] : NULL;
             if (local_val == NULL) {
-                CUresult error = create_cuda_context(user_context, &local_val);
-                if (error != CUDA_SUCCESS) {
-                    return error;
+                int chosen = device;
+                CUresult err = create_cuda_context(user_context, &local_val, &chosen);
+                if (err != CUDA_SUCCESS) {
+                    return err;
+                }
+                if (chosen < 0 || chosen >= max_cuda_devices) {
+                    error(user_context) << "CUDA: Selected device " << chosen
+                                        << " is out of range.";
+                    cuCtxDestroy(local_val);
+                    return CUDA_ERROR_INVALID_DEVICE;
+                }
+                // Normally in double-checked locking you need a release
+                // fence here that synchronizes with an acquire fence
+                // above to ensure the context is fully constructed
+                // before assigning to the global, but there's no way
+                // that create_cuda_context can access the context
+                // table, so we should be OK just storing to it here.
+                device_contexts[chosen] = local_val;
+                if (device == -1) {
+                    default_cuda_device = chosen;
                 }
             }
-            // Normally in double-checked locking you need a release
-            // fence here that synchronizes with an acquire fence
-            // above to ensure context is fully constructed before
-            // assigning to the global, but there's no way that
-            // create_cuda_context can access the "context" global, so
-            // we should be OK just storing to it here.
-            context = local_val;
         }  // spinlock
     }
 
@@ -151,8 +258,39 @@ WEAK int halide_cuda_release_context(void *user_context) {
 WEAK int halide_cuda_get_stream(void *user_context, CUcontext ctx, CUstream *stream) {
     // There are two default streams we could use. stream 0 is fully
     // synchronous. stream 2 gives a separate non-blocking stream per
-    // thread.
-    *stream = 0;
+    // thread. By default we use stream 0, unless the application has
+    // installed a stream via halide_cuda_set_stream.
+    *stream = custom_stream;
+    return 0;
+}
+
+// Associate a stream with subsequent pipeline invocations. Kernel
+// launches and buffer copies are issued on this stream, so copies for
+// one invocation can overlap with kernels from another running on a
+// different stream. Pass NULL to return to the default stream. The
+// stream must belong to the context returned by
+// halide_cuda_acquire_context, and it is the caller's responsibility
+// to synchronize it before reading results on the host (e.g. via
+// halide_device_sync).
+WEAK int halide_cuda_set_stream(void *user_context, CUstream stream) {
+    custom_stream = stream;
+    return 0;
+}
+
+// Enable or disable the pool of freed device allocations. While
+// enabled, halide_cuda_device_free returns blocks to a size-bucketed
+// freelist instead of calling cuMemFree (which synchronizes the
+// device), and halide_cuda_device_malloc recycles them. Disabling the
+// pool stops recycling but does not free pooled blocks; use
+// halide_cuda_release_unused_memory for that.
+WEAK int halide_cuda_enable_memory_pool(void *user_context, int enabled) {
+    pool_enabled = (enabled != 0);
+    return 0;
+}
+
+// Return all pooled device allocations to the driver.
+WEAK int halide_cuda_release_unused_memory(void *user_context) {
+    pool_release_all(user_context);
     return 0;
 }
 
@@ -209,9 +347,20 @@ public:
 // The registered_filters struct is not freed as it is pointed to by the
 // Halide generated code. The module_state structs are freed.
 
+// Looking up a kernel with cuModuleGetFunction on every launch adds
+// measurable overhead on pipelines with many small stages, so each
+// module keeps a cache of resolved CUfunctions, keyed by the entry
+// name pointer (a string constant in the generated code).
+struct kernel_state {
+    const char *entry_name;
+    CUfunction f;
+    kernel_state *next;
+};
+
 struct module_state {
     CUcontext context;
     CUmodule module;
+    kernel_state *kernels;
     module_state *next;
 };
 
@@ -234,7 +383,9 @@ WEAK module_state *find_module_for_context(const registered_filters *filters, CU
     return NULL;
 }
 
-WEAK CUresult create_cuda_context(void *user_context, CUcontext *ctx) {
+// Create a context on the device with ordinal *device. If *device is
+// -1, pick a device and write the chosen ordinal back to *device.
+WEAK CUresult create_cuda_context(void *user_context, CUcontext *ctx, int *device_ptr) {
     // Initialize CUDA
     CUresult err = cuInit(0);
     if (err != CUDA_SUCCESS) {
@@ -256,7 +407,7 @@ WEAK CUresult create_cuda_context(void *user_context, CUcontext *ctx) {
         return CUDA_ERROR_NO_DEVICE;
     }
 
-    int device = halide_get_gpu_device(user_context);
+    int device = *device_ptr;
     if (device == -1 && deviceCount == 1) {
         device = 0;
     } else if (device == -1) {
@@ -282,6 +433,8 @@ WEAK CUresult create_cuda_context(void *user_context, CUcontext *ctx) {
         }
     }
 
+    *device_ptr = device;
+
     // Get device
     CUdevice dev;
     CUresult status = cuDeviceGet(&dev, device);
@@ -470,7 +623,6 @@ WEAK int halide_cuda_initialize_kernels(void *user_context, void **state_ptr, co
         module_state *loaded_module = find_module_for_context(*filters, ctx.context);
         if (loaded_module == NULL) {
             loaded_module = (module_state *)malloc(sizeof(module_state));
-            debug(user_context) <<  "    cuModuleLoadData " << (void *)ptx_src << ", " << size << " -> ";
 
             CUjit_option options[] = { CU_JIT_MAX_REGISTERS };
             unsigned int max_regs_per_thread = 64;
@@ -483,17 +635,97 @@ WEAK int halide_cuda_initialize_kernels(void *user_context, void **state_ptr, co
                 max_regs_per_thread = atoi(regs);
             }
             void *optionValues[] = { (void*)(uintptr_t) max_regs_per_thread };
-            CUresult err = cuModuleLoadDataEx(&loaded_module->module, ptx_src, 1, options, optionValues);
 
-            if (err != CUDA_SUCCESS) {
-                free(loaded_module);
-                error(user_context) << "CUDA: cuModuleLoadData failed: "
-                                    << get_error_name(err);
-                return err;
-            } else {
-                debug(user_context) << (void *)(loaded_module->module) << "\n";
+            // If the on-disk kernel binary cache is enabled, compute
+            // the cache entry path. The key covers the PTX, the JIT
+            // options, the device, and the driver version. Caching
+            // needs the linker API (to get the compiled cubin back
+            // out of the JIT); if the driver doesn't have it we just
+            // compile the PTX every time as before.
+            stringstream cache_path(user_context);
+            bool cache_enabled = false;
+            const char *cache_dir = kernel_cache_dir();
+            if (cache_dir &&
+                cuLinkCreate && cuLinkAddData && cuLinkComplete && cuLinkDestroy) {
+                CUdevice dev;
+                char device_name[256];
+                int driver_version = 0;
+                if (cuCtxGetDevice(&dev) == CUDA_SUCCESS &&
+                    cuDeviceGetName(device_name, sizeof(device_name), dev) == CUDA_SUCCESS &&
+                    cuDriverGetVersion(&driver_version) == CUDA_SUCCESS) {
+                    uint64_t key = kernel_cache_hash_seed;
+                    key = kernel_cache_hash(key, ptx_src, size);
+                    key = kernel_cache_hash(key, &max_regs_per_thread, sizeof(max_regs_per_thread));
+                    key = kernel_cache_hash(key, device_name, strlen(device_name));
+                    key = kernel_cache_hash(key, &driver_version, sizeof(driver_version));
+                    cache_path << cache_dir << "/halide_cuda_" << key << ".bin";
+                    cache_enabled = true;
+                }
+            }
+
+            CUresult err = CUDA_SUCCESS;
+            bool loaded = false;
+            if (cache_enabled) {
+                size_t cubin_size = 0;
+                void *cubin = kernel_cache_load(user_context, cache_path.str(), &cubin_size);
+                if (cubin) {
+                    // Loading a cubin skips the PTX JIT entirely.
+                    debug(user_context) << "    cuModuleLoadData (cached cubin) " << cubin << ", " << (uint64_t)cubin_size << " -> ";
+                    err = cuModuleLoadData(&loaded_module->module, cubin);
+                    free(cubin);
+                    if (err == CUDA_SUCCESS) {
+                        debug(user_context) << (void *)(loaded_module->module) << "\n";
+                        loaded = true;
+                    } else {
+                        // A stale or incompatible cache entry: fall
+                        // through to recompiling the PTX, which will
+                        // overwrite the entry.
+                        debug(user_context) << get_error_name(err) << "; recompiling\n";
+                    }
+                }
+            }
+
+            if (!loaded && cache_enabled) {
+                // Compile the PTX through the linker API instead of
+                // cuModuleLoadDataEx, so the resulting cubin can be
+                // retrieved and cached for the next process.
+                CUlinkState link_state;
+                if (cuLinkCreate(1, options, optionValues, &link_state) == CUDA_SUCCESS) {
+                    void *cubin = NULL;
+                    size_t cubin_size = 0;
+                    if (cuLinkAddData(link_state, CU_JIT_INPUT_PTX, (void *)ptx_src, size,
+                                      NULL, 0, NULL, NULL) == CUDA_SUCCESS &&
+                        cuLinkComplete(link_state, &cubin, &cubin_size) == CUDA_SUCCESS) {
+                        // The cubin is owned by the link state.
+                        debug(user_context) << "    cuModuleLoadData (linked cubin) " << cubin << ", " << (uint64_t)cubin_size << " -> ";
+                        err = cuModuleLoadData(&loaded_module->module, cubin);
+                        if (err == CUDA_SUCCESS) {
+                            debug(user_context) << (void *)(loaded_module->module) << "\n";
+                            loaded = true;
+                            kernel_cache_store(user_context, cache_path.str(), cubin, cubin_size);
+                        } else {
+                            debug(user_context) << get_error_name(err) << "\n";
+                        }
+                    }
+                    cuLinkDestroy(link_state);
+                }
+            }
+
+            if (!loaded) {
+                debug(user_context) <<  "    cuModuleLoadData " << (void *)ptx_src << ", " << size << " -> ";
+                err = cuModuleLoadDataEx(&loaded_module->module, ptx_src, 1, options, optionValues);
+
+                if (err != CUDA_SUCCESS) {
+                    free(loaded_module);
+                    error(user_context) << "CUDA: cuModuleLoadData failed: "
+                                        << get_error_name(err);
+                    return err;
+                } else {
+                    debug(user_context) << (void *)(loaded_module->module) << "\n";
+                }
             }
             loaded_module->context = ctx.context;
+            loaded_module->kernels = NULL;
             loaded_module->next = (*filters)->modules;
             (*filters)->modules = loaded_module;
         }
@@ -531,8 +763,33 @@ WEAK int halide_cuda_device_free(void *user_context, halide_buffer_t* buf) {
 
     halide_assert(user_context, validate_device_pointer(user_context, buf));
 
-    debug(user_context) <<  "    cuMemFree " << (void *)(dev_ptr) << "\n";
-    CUresult err = cuMemFree(dev_ptr);
+    CUresult err = CUDA_SUCCESS;
+    bool pooled = false;
+    if (pool_enabled) {
+        // Recycle the block instead of returning it to the driver
+        // (cuMemFree synchronizes the device). The bucket is computed
+        // from the same size device_malloc rounded up, so it gets the
+        // block size the allocation actually has.
+        size_t size = buf->size_in_bytes();
+        int bucket = pool_bucket_for_size(&size);
+        if (bucket >= 0) {
+            pool_block *b = (pool_block *)halide_malloc(user_context, sizeof(pool_block));
+            if (b != NULL) {
+                b->ptr = dev_ptr;
+                b->ctx = ctx.context;
+                ScopedSpinLock spinlock(&pool_lock);
+                b->next = pool_buckets[bucket];
+                pool_buckets[bucket] = b;
+                pooled = true;
+            }
+        }
+    }
+    if (pooled) {
+        debug(user_context) << "    pooled " << (void *)(dev_ptr) << "\n";
+    } else {
+        debug(user_context) <<  "    cuMemFree " << (void *)(dev_ptr) << "\n";
+        err = cuMemFree(dev_ptr);
+    }
     // If cuMemFree fails, it isn't likely to succeed later, so just drop
     // the reference.
     buf->device_interface->impl->release_module();
@@ -555,6 +812,10 @@ WEAK int halide_cuda_device_release(void *user_context) {
     debug(user_context)
         << "CUDA: halide_cuda_device_release (user_context: " <<  user_context << ")\n";
 
+    // Return pooled allocations to the driver before the context they
+    // belong to can be destroyed.
+    pool_release_all(user_context);
+
     int err;
     CUcontext ctx;
     err = halide_cuda_acquire_context(user_context, &ctx, false);
@@ -589,6 +850,12 @@ WEAK int halide_cuda_device_release(void *user_context) {
                         debug(user_context) << "    cuModuleUnload " << loaded_module->module << "\n";
                         err = cuModuleUnload(loaded_module->module);
                         halide_assert(user_context, err == CUDA_SUCCESS || err == CUDA_ERROR_DEINITIALIZED);
+                        kernel_state *ks = loaded_module->kernels;
+                        while (ks != NULL) {
+                            kernel_state *next_ks = ks->next;
+                            free(ks);
+                            ks = next_ks;
+                        }
                         *prev_ptr = loaded_module->next;
                         free(loaded_module);
                         loaded_module = *prev_ptr;
@@ -609,12 +876,15 @@ WEAK int halide_cuda_device_release(void *user_context) {
         {
             ScopedSpinLock spinlock(&context_lock);
 
-            if (ctx == context) {
-                debug(user_context) << "    cuCtxDestroy " << context << "\n";
-                err = cuProfilerStop();
-                err = cuCtxDestroy(context);
-                halide_assert(user_context, err == CUDA_SUCCESS || err == CUDA_ERROR_DEINITIALIZED);
-                context = NULL;
+            for (int i = 0; i < max_cuda_devices; i++) {
+                if (ctx == device_contexts[i]) {
+                    debug(user_context) << "    cuCtxDestroy " << ctx << "\n";
+                    err = cuProfilerStop();
+                    err = cuCtxDestroy(ctx);
+                    halide_assert(user_context, err == CUDA_SUCCESS || err == CUDA_ERROR_DEINITIALIZED);
+                    device_contexts[i] = NULL;
+                    break;
+                }
             }
         }  // spinlock
     }
@@ -653,16 +923,44 @@ WEAK int halide_cuda_device_malloc(void *user_context, halide_buffer_t *buf) {
     uint64_t t_before = halide_current_time_ns(user_context);
     #endif
 
-    CUdeviceptr p;
-    debug(user_context) << "    cuMemAlloc " << (uint64_t)size << " -> ";
-    CUresult err = cuMemAlloc(&p, size);
-    if (err != CUDA_SUCCESS) {
-        debug(user_context) << get_error_name(err) << "\n";
-        error(user_context) << "CUDA: cuMemAlloc failed: "
-                            << get_error_name(err);
-        return err;
+    CUdeviceptr p = 0;
+    if (pool_enabled) {
+        // Try to recycle a block from the pool. Note that
+        // pool_bucket_for_size rounds size up to the block size of
+        // the bucket, so a recycled block always fits.
+        int bucket = pool_bucket_for_size(&size);
+        if (bucket >= 0) {
+            ScopedSpinLock spinlock(&pool_lock);
+            pool_block **prev_ptr = &pool_buckets[bucket];
+            for (pool_block *b = *prev_ptr; b != NULL; prev_ptr = &b->next, b = b->next) {
+                if (b->ctx == ctx.context) {
+                    p = b->ptr;
+                    *prev_ptr = b->next;
+                    halide_free(user_context, b);
+                    break;
+                }
+            }
+        }
+    }
+    if (p != 0) {
+        debug(user_context) << "    recycled pooled allocation " << (void *)p << "\n";
     } else {
-        debug(user_context) << (void *)p << "\n";
+        debug(user_context) << "    cuMemAlloc " << (uint64_t)size << " -> ";
+        CUresult err = cuMemAlloc(&p, size);
+        if (err == CUDA_ERROR_OUT_OF_MEMORY && pool_enabled) {
+            // The pool may be sitting on the memory we need. Return
+            // it to the driver and retry once.
+            pool_release_all(user_context);
+            err = cuMemAlloc(&p, size);
+        }
+        if (err != CUDA_SUCCESS) {
+            debug(user_context) << get_error_name(err) << "\n";
+            error(user_context) << "CUDA: cuMemAlloc failed: "
+                                << get_error_name(err);
+            return err;
+        } else {
+            debug(user_context) << (void *)p << "\n";
+        }
     }
     halide_assert(user_context, p);
     buf->device = p;
@@ -678,8 +976,21 @@ WEAK int halide_cuda_device_malloc(void *user_context, halide_buffer_t *buf) {
 }
 
 namespace {
+// Returns the context that owns a device allocation, or NULL if the
+// driver cannot tell us (e.g. no unified addressing).
+WEAK CUcontext context_of_device_ptr(uint64_t device_ptr) {
+    CUcontext ctx = NULL;
+    if (cuPointerGetAttribute(&ctx, CU_POINTER_ATTRIBUTE_CONTEXT,
+                              (CUdeviceptr)device_ptr) != CUDA_SUCCESS) {
+        return NULL;
+    }
+    return ctx;
+}
+
 WEAK int do_multidimensional_copy(void *user_context, const device_copy &c,
-                                  uint64_t src, uint64_t dst, int d, bool from_host, bool to_host) {
+                                  uint64_t src, uint64_t dst, int d, bool from_host, bool to_host,
+                                  CUcontext src_ctx, CUcontext dst_ctx,
+                                  CUstream stream) {
     if (d > MAX_COPY_DIMS) {
         error(user_context) << "Buffer has too many dimensions to copy to/from GPU\n";
         return -1;
@@ -690,11 +1001,33 @@ WEAK int do_multidimensional_copy(void *user_context, const device_copy &c,
                             << " to " << (to_host ? "host" : "device") << ", "
                             << (void *)src << " -> " << (void *)dst << ", " << c.chunk_size << " bytes\n";
         if (!from_host && to_host) {
-            err = cuMemcpyDtoH((void *)dst, (CUdeviceptr)src, c.chunk_size);
+            if (stream != NULL && cuMemcpyDtoHAsync != NULL) {
+                err = cuMemcpyDtoHAsync((void *)dst, (CUdeviceptr)src, c.chunk_size, stream);
+            } else {
+                err = cuMemcpyDtoH((void *)dst, (CUdeviceptr)src, c.chunk_size);
+            }
         } else if (from_host && !to_host) {
-            err = cuMemcpyHtoD((CUdeviceptr)dst, (void *)src, c.chunk_size);
+            if (stream != NULL && cuMemcpyHtoDAsync != NULL) {
+                err = cuMemcpyHtoDAsync((CUdeviceptr)dst, (void *)src, c.chunk_size, stream);
+            } else {
+                err = cuMemcpyHtoD((CUdeviceptr)dst, (void *)src, c.chunk_size);
+            }
         } else if (!from_host && !to_host) {
-            err = cuMemcpyDtoD((CUdeviceptr)dst, (CUdeviceptr)src, c.chunk_size);
+            if (src_ctx != dst_ctx && src_ctx != NULL && dst_ctx != NULL &&
+                cuMemcpyPeer != NULL) {
+                // The endpoints belong to different devices' contexts;
+                // copy directly between them instead of bouncing the
+                // data through system memory.
+                if (stream != NULL && cuMemcpyPeerAsync != NULL) {
+                    err = cuMemcpyPeerAsync((CUdeviceptr)dst, dst_ctx, (CUdeviceptr)src, src_ctx, c.chunk_size, stream);
+                } else {
+                    err = cuMemcpyPeer((CUdeviceptr)dst, dst_ctx, (CUdeviceptr)src, src_ctx, c.chunk_size);
+                }
+            } else if (stream != NULL && cuMemcpyDtoDAsync != NULL) {
+                err = cuMemcpyDtoDAsync((CUdeviceptr)dst, (CUdeviceptr)src, c.chunk_size, stream);
+            } else {
+                err = cuMemcpyDtoD((CUdeviceptr)dst, (CUdeviceptr)src, c.chunk_size);
+            }
         } else if (dst != src) {
             // Could reach here if a user called directly into the
             // cuda API for a device->host copy on a source buffer
@@ -708,7 +1041,7 @@ WEAK int do_multidimensional_copy(void *user_context, const device_copy &c,
     } else {
         ssize_t src_off = 0, dst_off = 0;
         for (int i = 0; i < (int)c.extent[d-1]; i++) {
-            int err = do_multidimensional_copy(user_context, c, src + src_off, dst + dst_off, d - 1, from_host, to_host);
+            int err = do_multidimensional_copy(user_context, c, src + src_off, dst + dst_off, d - 1, from_host, to_host, src_ctx, dst_ctx, stream);
             dst_off += c.dst_stride_bytes[d-1];
             src_off += c.src_stride_bytes[d-1];
             if (err) {
@@ -738,6 +1071,18 @@ WEAK int halide_cuda_buffer_copy(void *user_context, struct halide_buffer_t *src
         src = dst;
     }
 
+    // Buffers backed by a single managed allocation need no copy at
+    // all: the host and device fields alias the same memory. A
+    // device-to-host "copy" must still wait for outstanding device
+    // work to finish before the host touches the pages.
+    if (dst == src && src->device != 0 &&
+        (uint64_t)(uintptr_t)src->host == src->device) {
+        if (src->device_dirty()) {
+            return halide_cuda_device_sync(user_context, src);
+        }
+        return 0;
+    }
+
     bool from_host = !src->device_dirty() && src->host;
     bool to_host = !dst_device_interface;
 
@@ -767,7 +1112,42 @@ WEAK int halide_cuda_buffer_copy(void *user_context, struct halide_buffer_t *src
         }
         #endif
 
-        err = do_multidimensional_copy(user_context, c, c.src + c.src_begin, c.dst, dst->dimensions, from_host, to_host);
+        CUstream stream = NULL;
+        if (cuStreamSynchronize != NULL) {
+            int result = halide_cuda_get_stream(user_context, ctx.context, &stream);
+            if (result != 0) {
+                error(user_context) << "CUDA: In halide_cuda_buffer_copy, halide_cuda_get_stream returned " << result << "\n";
+            }
+        }
+
+        // If both endpoints are device allocations they may belong to
+        // different devices' contexts (see halide_cuda_acquire_context);
+        // resolve the owning context of each so the copy can take the
+        // peer-to-peer path rather than bouncing through the host.
+        CUcontext src_ctx = ctx.context;
+        CUcontext dst_ctx = ctx.context;
+        if (!from_host && !to_host && cuMemcpyPeer != NULL) {
+            CUcontext owner = context_of_device_ptr(src->device);
+            if (owner != NULL) {
+                src_ctx = owner;
+            }
+            owner = context_of_device_ptr(dst->device);
+            if (owner != NULL) {
+                dst_ctx = owner;
+            }
+        }
+
+        err = do_multidimensional_copy(user_context, c, c.src + c.src_begin, c.dst, dst->dimensions, from_host, to_host, src_ctx, dst_ctx, stream);
+
+        // Copies to the host must be complete before this call
+        // returns, so if they were issued asynchronously on a stream,
+        // wait for that stream. Peer copies are ordered with respect
+        // to this context's stream but not with work later issued to
+        // the destination device, so wait for those too.
+        if (err == 0 && stream != NULL &&
+            (to_host || src_ctx != dst_ctx)) {
+            err = cuStreamSynchronize(stream);
+        }
 
         #ifdef DEBUG_RUNTIME
         uint64_t t_after = halide_current_time_ns(user_context);
@@ -778,22 +1158,45 @@ WEAK int halide_cuda_buffer_copy(void *user_context, struct halide_buffer_t *src
     return err;
 }
 
+namespace {
+
+WEAK int cuda_device_crop_from_offset(const struct halide_buffer_t *src,
+                                      int64_t offset,
+                                      struct halide_buffer_t *dst) {
+    // Pointer arithmetic works fine.
+    dst->device = src->device + offset;
+    dst->device_interface = src->device_interface;
+    dst->set_device_dirty(src->device_dirty());
+    return 0;
+}
+
+}  // namespace
+
 WEAK int halide_cuda_device_crop(void *user_context, const struct halide_buffer_t *src,
                                  struct halide_buffer_t *dst) {
     debug(user_context)
         << "CUDA: halide_cuda_device_crop (user_context: " << user_context
         << ", src: " << src << ", dst: " << dst << ")\n";
 
-    // Pointer arithmetic works fine.
     int64_t offset = 0;
     for (int i = 0; i < src->dimensions; i++) {
         offset += (dst->dim[i].min - src->dim[i].min) * src->dim[i].stride;
     }
     offset *= src->type.bytes();
-    dst->device = src->device + offset;
-    dst->device_interface = src->device_interface;
-    dst->set_device_dirty(src->device_dirty());
-    return 0;
+    return cuda_device_crop_from_offset(src, offset, dst);
+}
+
+WEAK int halide_cuda_device_slice(void *user_context, const struct halide_buffer_t *src,
+                                  int slice_dim, int slice_pos,
+                                  struct halide_buffer_t *dst) {
+    debug(user_context)
+        << "CUDA: halide_cuda_device_slice (user_context: " << user_context
+        << ", src: " << src << ", slice_dim: " << slice_dim
+        << ", slice_pos: " << slice_pos << ", dst: " << dst << ")\n";
+
+    int64_t offset = (slice_pos - src->dim[slice_dim].min) * src->dim[slice_dim].stride;
+    offset *= src->type.bytes();
+    return cuda_device_crop_from_offset(src, offset, dst);
 }
 
 WEAK int halide_cuda_device_release_crop(void *user_context, struct halide_buffer_t *dst) {
@@ -889,14 +1292,37 @@ WEAK int halide_cuda_run(void *user_context,
     CUmodule mod = loaded_module->module;
     debug(user_context) << "Got module " << mod << "\n";
     halide_assert(user_context, mod);
-    CUfunction f;
-    err = cuModuleGetFunction(&f, mod, entry_name);
-    debug(user_context) << "Got function " << f << "\n";
-    if (err != CUDA_SUCCESS) {
-        error(user_context) << "CUDA: cuModuleGetFunction failed: "
-                            << get_error_name(err);
-        return err;
+
+    // Check the module's kernel cache before asking the driver. The
+    // entry name is a string constant in the generated code, so
+    // pointer equality is a sufficient key; a miss just means a
+    // redundant lookup and cache node.
+    CUfunction f = NULL;
+    for (kernel_state *ks = loaded_module->kernels; ks != NULL; ks = ks->next) {
+        if (ks->entry_name == entry_name) {
+            f = ks->f;
+            break;
+        }
     }
+    if (f == NULL) {
+        err = cuModuleGetFunction(&f, mod, entry_name);
+        if (err != CUDA_SUCCESS) {
+            error(user_context) << "CUDA: cuModuleGetFunction failed: "
+                                << get_error_name(err);
+            return err;
+        }
+        kernel_state *ks = (kernel_state *)malloc(sizeof(kernel_state));
+        if (ks != NULL) {
+            ks->entry_name = entry_name;
+            ks->f = f;
+            // Concurrent launches may race to insert; prepend with a
+            // compare-and-swap so nobody's node is lost.
+            do {
+                ks->next = loaded_module->kernels;
+            } while (!__sync_bool_compare_and_swap(&loaded_module->kernels, ks->next, ks));
+        }
+    }
+    debug(user_context) << "Got function " << f << "\n";
 
     size_t num_args = 0;
     while (arg_sizes[num_args] != 0) {
@@ -908,9 +1334,19 @@ WEAK int halide_cuda_run(void *user_context,
     }
 
     // We need storage for both the arg and the pointer to it if if
-    // has to be translated.
-    void** translated_args = (void **)malloc((num_args + 1) * sizeof(void *));
-    uint64_t *dev_handles = (uint64_t *)malloc(num_args * sizeof(uint64_t));
+    // has to be translated. Launches with few arguments (the common
+    // case) use stack storage to avoid two heap allocations per
+    // launch.
+    const size_t max_stack_args = 16;
+    void *translated_args_storage[max_stack_args + 1];
+    uint64_t dev_handles_storage[max_stack_args];
+    void **translated_args = translated_args_storage;
+    uint64_t *dev_handles = dev_handles_storage;
+    bool heap_args = num_args > max_stack_args;
+    if (heap_args) {
+        translated_args = (void **)malloc((num_args + 1) * sizeof(void *));
+        dev_handles = (uint64_t *)malloc(num_args * sizeof(uint64_t));
+    }
     for (size_t i = 0; i <= num_args; i++) { // Get NULL at end.
         if (arg_is_buffer[i]) {
             halide_assert(user_context, arg_sizes[i] == sizeof(uint64_t));
@@ -933,6 +1369,32 @@ WEAK int halide_cuda_run(void *user_context,
         }
     }
 
+    // When the sampling profiler is running, bracket the launch with
+    // CUDA events so the kernel's device time can be billed to the
+    // Func that launched it. The profiler otherwise attributes device
+    // time to whatever the CPU happened to be doing. Reading the
+    // events back synchronizes with the kernel, so this only happens
+    // while profiling.
+    int profile_func_id = halide_profiler_get_state()->current_func;
+    bool profile_launch = profile_func_id >= 0 &&
+                          cuEventCreate != NULL &&
+                          cuEventRecord != NULL &&
+                          cuEventSynchronize != NULL &&
+                          cuEventElapsedTime != NULL &&
+                          cuEventDestroy != NULL;
+    CUevent start_event = NULL, end_event = NULL;
+    if (profile_launch) {
+        if (cuEventCreate(&start_event, CU_EVENT_DEFAULT) != CUDA_SUCCESS ||
+            cuEventCreate(&end_event, CU_EVENT_DEFAULT) != CUDA_SUCCESS) {
+            if (start_event != NULL) {
+                cuEventDestroy(start_event);
+            }
+            profile_launch = false;
+        } else {
+            cuEventRecord(start_event, stream);
+        }
+    }
+
     err = cuLaunchKernel(f,
                          blocksX,  blocksY,  blocksZ,
                          threadsX, threadsY, threadsZ,
@@ -940,8 +1402,25 @@ WEAK int halide_cuda_run(void *user_context,
                          stream,
                          translated_args,
                          NULL);
-    free(dev_handles);
-    free(translated_args);
+    if (heap_args) {
+        free(dev_handles);
+        free(translated_args);
+    }
+
+    if (profile_launch) {
+        if (err == CUDA_SUCCESS) {
+            cuEventRecord(end_event, stream);
+            float ms = 0.0f;
+            if (cuEventSynchronize(end_event) == CUDA_SUCCESS &&
+                cuEventElapsedTime(&ms, start_event, end_event) == CUDA_SUCCESS) {
+                halide_profiler_device_time(user_context, profile_func_id,
+                                            (uint64_t)(ms * 1e6));
+            }
+        }
+        cuEventDestroy(start_event);
+        cuEventDestroy(end_event);
+    }
+
     if (err != CUDA_SUCCESS) {
         error(user_context) << "CUDA: cuLaunchKernel failed: "
                             << get_error_name(err);
@@ -962,13 +1441,96 @@ WEAK int halide_cuda_run(void *user_context,
 }
 
 WEAK int halide_cuda_device_and_host_malloc(void *user_context, struct halide_buffer_t *buf) {
-    return halide_default_device_and_host_malloc(user_context, buf, &cuda_device_interface);
+    if (!halide_cuda_use_managed_memory(user_context) || cuMemAllocManaged == NULL) {
+        return halide_default_device_and_host_malloc(user_context, buf, &cuda_device_interface);
+    }
+
+    if (buf->device) {
+        return 0;
+    }
+
+    Context ctx(user_context);
+    if (ctx.error != CUDA_SUCCESS) {
+        return ctx.error;
+    }
+
+    size_t size = buf->size_in_bytes();
+    debug(user_context)
+        << "CUDA: halide_cuda_device_and_host_malloc (user_context: " << user_context
+        << ", buf: " << buf << ") " << (uint64_t)size << " bytes, managed\n";
+
+    CUdeviceptr p;
+    debug(user_context) << "    cuMemAllocManaged " << (uint64_t)size << " -> ";
+    CUresult err = cuMemAllocManaged(&p, size, CU_MEM_ATTACH_GLOBAL);
+    if (err != CUDA_SUCCESS) {
+        // Not every device supports managed memory; fall back to
+        // separate host and device allocations.
+        debug(user_context) << get_error_name(err) << "\n";
+        return halide_default_device_and_host_malloc(user_context, buf, &cuda_device_interface);
+    }
+    debug(user_context) << (void *)p << "\n";
+
+    // The host and device views of the buffer alias the same
+    // allocation, which is how halide_cuda_buffer_copy and
+    // halide_cuda_device_and_host_free recognize managed buffers.
+    buf->device = p;
+    buf->host = (uint8_t *)(uintptr_t)p;
+    buf->device_interface = &cuda_device_interface;
+    buf->device_interface->impl->use_module();
+    return 0;
 }
 
 WEAK int halide_cuda_device_and_host_free(void *user_context, struct halide_buffer_t *buf) {
+    if (buf->device != 0 &&
+        (uint64_t)(uintptr_t)buf->host == buf->device) {
+        // A single managed allocation backs both views (see
+        // halide_cuda_device_and_host_malloc); free it once.
+        int err = halide_cuda_device_free(user_context, buf);
+        buf->host = NULL;
+        return err;
+    }
     return halide_default_device_and_host_free(user_context, buf, &cuda_device_interface);
 }
 
+WEAK void *halide_cuda_host_malloc(size_t size) {
+    void *user_context = NULL;
+    Context ctx(user_context);
+    if (ctx.error != CUDA_SUCCESS) {
+        return NULL;
+    }
+    if (cuMemHostAlloc == NULL) {
+        // The driver is too old to pin host memory.
+        return NULL;
+    }
+    void *p = NULL;
+    debug(user_context) << "    cuMemHostAlloc " << (uint64_t)size << " -> ";
+    CUresult err = cuMemHostAlloc(&p, size, CU_MEMHOSTALLOC_PORTABLE);
+    if (err != CUDA_SUCCESS) {
+        debug(user_context) << get_error_name(err) << "\n";
+        return NULL;
+    }
+    debug(user_context) << p << "\n";
+    return p;
+}
+
+WEAK void halide_cuda_host_free(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    void *user_context = NULL;
+    Context ctx(user_context);
+    if (ctx.error != CUDA_SUCCESS) {
+        error(user_context) << "CUDA: unable to acquire context to free pinned host memory";
+        return;
+    }
+    debug(user_context) << "    cuMemFreeHost " << ptr << "\n";
+    CUresult err = cuMemFreeHost(ptr);
+    if (err != CUDA_SUCCESS) {
+        error(user_context) << "CUDA: cuMemFreeHost failed: "
+                            << get_error_name(err);
+    }
+}
+
 WEAK int halide_cuda_wrap_device_ptr(void *user_context, struct halide_buffer_t *buf, uint64_t device_ptr) {
     halide_assert(user_context, buf->device == 0);
     if (buf->device != 0) {
@@ -1102,6 +1664,7 @@ WEAK halide_device_interface_impl_t cuda_device_interface_impl = {
     halide_cuda_device_and_host_free,
     halide_cuda_buffer_copy,
     halide_cuda_device_crop,
+    halide_cuda_device_slice,
     halide_cuda_device_release_crop,
     halide_cuda_wrap_device_ptr,
     halide_cuda_detach_device_ptr,
@@ -1118,6 +1681,7 @@ WEAK halide_device_interface_t cuda_device_interface = {
     halide_device_and_host_free,
     halide_buffer_copy,
     halide_device_crop,
+    halide_device_slice,
     halide_device_release_crop,
     halide_device_wrap_native,
     halide_device_detach_native,
@@ -15,6 +15,9 @@
 #ifndef CUDA_FN_4000
 #define CUDA_FN_4000(ret, fn, fn_4000, args) CUDA_FN(ret, fn, args)
 #endif
+#ifndef CUDA_FN_OPTIONAL_3020
+#define CUDA_FN_OPTIONAL_3020(ret, fn, fn_3020, args) CUDA_FN_OPTIONAL(ret, fn, args)
+#endif
 
 CUDA_FN(CUresult, cuInit, (unsigned int Flags));
 CUDA_FN(CUresult, cuDeviceGetCount, (int *count));
@@ -26,8 +29,16 @@ CUDA_FN_3020(CUresult, cuCtxCreate, cuCtxCreate_v2, (CUcontext *pctx, unsigned i
 CUDA_FN_4000(CUresult, cuCtxDestroy, cuCtxDestroy_v2, (CUcontext pctx));
 CUDA_FN(CUresult, cuProfilerStop, ());
 CUDA_FN(CUresult, cuCtxGetApiVersion, (CUcontext ctx, unsigned int *version));
+CUDA_FN(CUresult, cuDriverGetVersion, (int *driverVersion));
+CUDA_FN(CUresult, cuCtxGetDevice, (CUdevice *device));
 CUDA_FN(CUresult, cuModuleLoadData, (CUmodule *module, const void *image));
 CUDA_FN(CUresult, cuModuleLoadDataEx, (CUmodule *module, const void *image, unsigned int numOptions, CUjit_option* options, void** optionValues));
+// The linker API is only used by the on-disk kernel binary cache, which
+// degrades gracefully when it is unavailable.
+CUDA_FN_OPTIONAL_3020(CUresult, cuLinkCreate, cuLinkCreate_v2, (unsigned int numOptions, CUjit_option *options, void **optionValues, CUlinkState *stateOut));
+CUDA_FN_OPTIONAL_3020(CUresult, cuLinkAddData, cuLinkAddData_v2, (CUlinkState state, CUjitInputType type, void *data, size_t size, const char *name, unsigned int numOptions, CUjit_option *options, void **optionValues));
+CUDA_FN_OPTIONAL(CUresult, cuLinkComplete, (CUlinkState state, void **cubinOut, size_t *sizeOut));
+CUDA_FN_OPTIONAL(CUresult, cuLinkDestroy, (CUlinkState state));
 CUDA_FN(CUresult, cuModuleUnload, (CUmodule module));
 CUDA_FN(CUresult, cuModuleGetFunction, (CUfunction *hfunc, CUmodule hmod, const char *name));
 CUDA_FN_3020(CUresult, cuMemAlloc, cuMemAlloc_v2, (CUdeviceptr *dptr, size_t bytesize));
@@ -36,6 +47,14 @@ CUDA_FN_3020(CUresult, cuMemcpyHtoD, cuMemcpyHtoD_v2, (CUdeviceptr dstDevice, co
 CUDA_FN_3020(CUresult, cuMemcpyDtoH, cuMemcpyDtoH_v2, (void *dstHost, CUdeviceptr srcDevice, size_t ByteCount));
 CUDA_FN_3020(CUresult, cuMemcpyDtoD, cuMemcpyDtoD_v2, (CUdeviceptr dstHost, CUdeviceptr srcDevice, size_t ByteCount));
 CUDA_FN_3020(CUresult, cuMemcpy3D, cuMemcpy3D_v2, (const CUDA_MEMCPY3D *pCopy));
+// Pinned host memory is only used by halide_cuda_host_malloc, which
+// fails cleanly when the driver does not provide it.
+CUDA_FN_OPTIONAL(CUresult, cuMemHostAlloc, (void **pp, size_t bytesize, unsigned int Flags));
+CUDA_FN_OPTIONAL(CUresult, cuMemFreeHost, (void *p));
+// Managed (unified) memory, used for zero-copy buffers on targets with
+// the managed_memory feature (CUDA 6.0+). Without it we fall back to
+// separate host and device allocations.
+CUDA_FN_OPTIONAL(CUresult, cuMemAllocManaged, (CUdeviceptr *dptr, size_t bytesize, unsigned int flags));
 CUDA_FN(CUresult, cuLaunchKernel, (CUfunction f,
                                    unsigned int gridDimX,
                                    unsigned int gridDimY,
@@ -56,7 +75,29 @@ CUDA_FN(CUresult, cuPointerGetAttribute, (void *result, int query, CUdeviceptr p
 
 CUDA_FN_OPTIONAL(CUresult, cuStreamSynchronize, (CUstream hStream));
 
+// Events are only used to time kernel launches when the Halide
+// profiler is running; timing degrades gracefully when they are
+// unavailable.
+CUDA_FN_OPTIONAL(CUresult, cuEventCreate, (CUevent *phEvent, unsigned int Flags));
+CUDA_FN_OPTIONAL(CUresult, cuEventRecord, (CUevent hEvent, CUstream hStream));
+CUDA_FN_OPTIONAL(CUresult, cuEventSynchronize, (CUevent hEvent));
+CUDA_FN_OPTIONAL(CUresult, cuEventElapsedTime, (float *pMilliseconds, CUevent hStart, CUevent hEnd));
+CUDA_FN_OPTIONAL(CUresult, cuEventDestroy, (CUevent hEvent));
+
+// Asynchronous copies, used when a stream has been associated with
+// the context via halide_cuda_set_stream.
+CUDA_FN_OPTIONAL_3020(CUresult, cuMemcpyHtoDAsync, cuMemcpyHtoDAsync_v2, (CUdeviceptr dstDevice, const void *srcHost, size_t ByteCount, CUstream hStream));
+CUDA_FN_OPTIONAL_3020(CUresult, cuMemcpyDtoHAsync, cuMemcpyDtoHAsync_v2, (void *dstHost, CUdeviceptr srcDevice, size_t ByteCount, CUstream hStream));
+CUDA_FN_OPTIONAL_3020(CUresult, cuMemcpyDtoDAsync, cuMemcpyDtoDAsync_v2, (CUdeviceptr dstDevice, CUdeviceptr srcDevice, size_t ByteCount, CUstream hStream));
+
+// Peer copies between contexts on different devices (CUDA 4.0+).
+// Without them, cross-device buffer copies bounce through host memory
+// via halide_default_buffer_copy.
+CUDA_FN_OPTIONAL(CUresult, cuMemcpyPeer, (CUdeviceptr dstDevice, CUcontext dstContext, CUdeviceptr srcDevice, CUcontext srcContext, size_t ByteCount));
+CUDA_FN_OPTIONAL(CUresult, cuMemcpyPeerAsync, (CUdeviceptr dstDevice, CUcontext dstContext, CUdeviceptr srcDevice, CUcontext srcContext, size_t ByteCount, CUstream hStream));
+
 #undef CUDA_FN
 #undef CUDA_FN_OPTIONAL
 #undef CUDA_FN_3020
 #undef CUDA_FN_4000
+#undef CUDA_FN_OPTIONAL_3020
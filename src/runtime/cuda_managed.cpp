@@ -0,0 +1,13 @@
+#include "HalideRuntime.h"
+
+extern "C" {
+
+// Linked into the runtime instead of cuda_managed_stubs.cpp when the
+// target has the managed_memory feature: combined device-and-host
+// allocations come from CUDA managed (unified) memory, and copies
+// between the host and device views of a buffer are elided.
+WEAK int halide_cuda_use_managed_memory(void *user_context) {
+    return 1;
+}
+
+}
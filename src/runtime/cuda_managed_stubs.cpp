@@ -0,0 +1,12 @@
+#include "HalideRuntime.h"
+
+extern "C" {
+
+// Default for targets without the managed_memory feature: keep
+// separate host and device allocations. Override this to enable
+// managed memory at runtime (see HalideRuntimeCuda.h).
+WEAK int halide_cuda_use_managed_memory(void *user_context) {
+    return 0;
+}
+
+}
@@ -26,6 +26,134 @@ struct device_handle_wrapper {
 // a copy internaly as well.
 WEAK halide_mutex device_copy_mutex;
 
+// Optional sub-region dirty tracking. The dirty bits on a
+// halide_buffer_t cover the whole buffer, so touching one tile of a
+// large frame forces the entire frame across the bus. Buffers opted
+// in via halide_buffer_mark_{host,device}_dirty_region get a side
+// table entry recording the bounding box of their dirty data, and the
+// copy routines below move just that box, using the device
+// interface's crop support to address the sub-region on the device.
+// The list is protected by device_copy_mutex and is expected to be
+// short: entries only exist between a region mark and the copy that
+// consumes it.
+struct dirty_region {
+    halide_buffer_t *buf;
+    halide_dimension_t box[MAX_COPY_DIMS];
+    dirty_region *next;
+};
+WEAK dirty_region *dirty_regions = NULL;
+
+WEAK dirty_region *find_dirty_region(halide_buffer_t *buf) {
+    for (dirty_region *r = dirty_regions; r != NULL; r = r->next) {
+        if (r->buf == buf) {
+            return r;
+        }
+    }
+    return NULL;
+}
+
+WEAK void drop_dirty_region_already_locked(halide_buffer_t *buf) {
+    dirty_region **prev = &dirty_regions;
+    for (dirty_region *r = dirty_regions; r != NULL; r = r->next) {
+        if (r->buf == buf) {
+            *prev = r->next;
+            free(r);
+            return;
+        }
+        prev = &r->next;
+    }
+}
+
+// Record (or grow) the dirty bounding box for a buffer. Returns true
+// if the box is being tracked; false means the caller should fall
+// back to whole-buffer semantics.
+WEAK bool mark_dirty_region_already_locked(halide_buffer_t *buf, const halide_dimension_t *box) {
+    if (buf->dimensions > MAX_COPY_DIMS) {
+        drop_dirty_region_already_locked(buf);
+        return false;
+    }
+    dirty_region *r = find_dirty_region(buf);
+    if (r == NULL) {
+        r = (dirty_region *)malloc(sizeof(dirty_region));
+        if (r == NULL) {
+            // Tracking is only an optimization; degrade to
+            // whole-buffer copies.
+            return false;
+        }
+        r->buf = buf;
+        for (int i = 0; i < buf->dimensions; i++) {
+            r->box[i] = buf->dim[i];
+            r->box[i].min = box[i].min;
+            r->box[i].extent = box[i].extent;
+        }
+        r->next = dirty_regions;
+        dirty_regions = r;
+    } else {
+        for (int i = 0; i < buf->dimensions; i++) {
+            int32_t max_plus_one = r->box[i].min + r->box[i].extent;
+            if (box[i].min + box[i].extent > max_plus_one) {
+                max_plus_one = box[i].min + box[i].extent;
+            }
+            if (box[i].min < r->box[i].min) {
+                r->box[i].min = box[i].min;
+            }
+            r->box[i].extent = max_plus_one - r->box[i].min;
+        }
+    }
+    // Clamp to the buffer bounds.
+    for (int i = 0; i < buf->dimensions; i++) {
+        if (r->box[i].min < buf->dim[i].min) {
+            r->box[i].min = buf->dim[i].min;
+        }
+        int32_t max_plus_one = r->box[i].min + r->box[i].extent;
+        if (max_plus_one > buf->dim[i].min + buf->dim[i].extent) {
+            max_plus_one = buf->dim[i].min + buf->dim[i].extent;
+        }
+        r->box[i].extent = max_plus_one - r->box[i].min;
+    }
+    return true;
+}
+
+// Copy just the tracked dirty box of buf between its host and device
+// allocations, by building a cropped shell over the same memory and
+// running the device interface's ordinary copy on it. Returns an
+// error if the device interface doesn't support cropping, in which
+// case the caller falls back to a whole-buffer copy.
+WEAK int copy_dirty_region_already_locked(void *user_context, halide_buffer_t *buf,
+                                          const dirty_region *r, bool to_host) {
+    const halide_device_interface_t *interface = buf->device_interface;
+
+    halide_buffer_t crop = *buf;
+    halide_dimension_t crop_dim[MAX_COPY_DIMS];
+    int64_t offset = 0;
+    for (int i = 0; i < buf->dimensions; i++) {
+        crop_dim[i] = buf->dim[i];
+        crop_dim[i].min = r->box[i].min;
+        crop_dim[i].extent = r->box[i].extent;
+        offset += (int64_t)(r->box[i].min - buf->dim[i].min) * buf->dim[i].stride;
+    }
+    crop.dim = crop_dim;
+    crop.host = buf->host ? (buf->host + offset * buf->type.bytes()) : NULL;
+    crop.device = 0;
+    crop.device_interface = NULL;
+
+    interface->impl->use_module();
+    int err = interface->impl->device_crop(user_context, buf, &crop);
+    if (err == 0) {
+        if (to_host) {
+            err = interface->impl->copy_to_host(user_context, &crop);
+        } else {
+            err = interface->impl->copy_to_device(user_context, &crop);
+        }
+        int release_err = interface->impl->device_release_crop(user_context, &crop);
+        if (err == 0) {
+            err = release_err;
+        }
+    }
+    interface->impl->release_module();
+    return err;
+}
+
 WEAK int copy_to_host_already_locked(void *user_context, struct halide_buffer_t *buf) {
     if (!buf->device_dirty()) {
         return 0;  // my, that was easy
@@ -41,6 +169,21 @@ WEAK int copy_to_host_already_locked(void *user_context, struct halide_buffer_t
         debug(user_context) << "copy_to_host_already_locked " << buf << " interface is NULL\n";
         return halide_error_code_no_device_interface;
     }
+
+    dirty_region *r = find_dirty_region(buf);
+    if (r != NULL) {
+        if (copy_dirty_region_already_locked(user_context, buf, r, true) == 0) {
+            debug(user_context) << "copy_to_host_already_locked " << buf << " copied dirty sub-region only\n";
+            drop_dirty_region_already_locked(buf);
+            buf->set_device_dirty(false);
+            halide_msan_annotate_buffer_is_initialized(user_context, buf);
+            return 0;
+        }
+        // Couldn't do the sub-region copy (e.g. no crop support);
+        // fall back to copying the whole buffer.
+        drop_dirty_region_already_locked(buf);
+    }
+
     int result = interface->impl->copy_to_host(user_context, buf);
     if (result != 0) {
         debug(user_context) << "copy_to_host_already_locked " << buf << " device copy_to_host returned an error\n";
@@ -159,6 +302,18 @@ WEAK int copy_to_device_already_locked(void *user_context,
             debug(user_context) << "halide_copy_to_device " << buf << " dev_dirty is true error\n";
             return halide_error_code_copy_to_device_failed;
         } else {
+            dirty_region *r = find_dirty_region(buf);
+            if (r != NULL) {
+                if (copy_dirty_region_already_locked(user_context, buf, r, false) == 0) {
+                    debug(user_context) << "halide_copy_to_device " << buf << " copied dirty sub-region only\n";
+                    drop_dirty_region_already_locked(buf);
+                    buf->set_host_dirty(false);
+                    return 0;
+                }
+                // Couldn't do the sub-region copy (e.g. no crop
+                // support); fall back to copying the whole buffer.
+                drop_dirty_region_already_locked(buf);
+            }
             result = device_interface->impl->copy_to_device(user_context, buf);
             if (result == 0) {
                 buf->set_host_dirty(false);
@@ -230,6 +385,24 @@ WEAK int halide_device_malloc(void *user_context, struct halide_buffer_t *buf,
     }
 }
 
+/** Complete a device interface's lazy initialization ahead of its
+ * first real use. A one-byte allocation is enough to force context
+ * creation and module loading without holding on to any memory. */
+WEAK int halide_device_warmup(void *user_context,
+                              const halide_device_interface_t *device_interface) {
+    halide_dimension_t shape(0, 1, 1);
+    halide_buffer_t buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = halide_type_of<uint8_t>();
+    buf.dimensions = 1;
+    buf.dim = &shape;
+    int result = halide_device_malloc(user_context, &buf, device_interface);
+    if (result == 0) {
+        result = halide_device_free(user_context, &buf);
+    }
+    return result;
+}
+
 /** Free any device memory associated with a halide_buffer_t. */
 WEAK int halide_device_free(void *user_context, struct halide_buffer_t *buf) {
     int result = debug_log_and_validate_buf(user_context, buf, "halide_device_free");
@@ -237,6 +410,12 @@ WEAK int halide_device_free(void *user_context, struct halide_buffer_t *buf) {
         return result;
     }
 
+    {
+        // Any tracked dirty region dies with the device allocation.
+        ScopedMutexLock lock(&device_copy_mutex);
+        drop_dirty_region_already_locked(buf);
+    }
+
     const halide_device_interface_t *device_interface = buf->device_interface;
     if (device_interface != NULL) {
         // Ensure interface is not freed prematurely.
@@ -594,6 +773,44 @@ WEAK int halide_device_crop(void *user_context,
     return err;
 }
 
+WEAK int halide_default_device_slice(void *user_context,
+                                     const struct halide_buffer_t *src,
+                                     int slice_dim, int slice_pos,
+                                     struct halide_buffer_t *dst) {
+    halide_error(user_context, "device_interface does not support slicing\n");
+    return halide_error_code_device_crop_unsupported;
+}
+
+WEAK int halide_device_slice(void *user_context,
+                             const struct halide_buffer_t *src,
+                             int slice_dim, int slice_pos,
+                             struct halide_buffer_t *dst) {
+    ScopedMutexLock lock(&device_copy_mutex);
+
+    if (!src->device) {
+        return 0;
+    }
+
+    if (dst->device) {
+        halide_error(user_context, "destination buffer already has a device allocation\n");
+        return halide_error_code_device_crop_failed;
+    }
+
+    if (dst->dimensions != src->dimensions - 1) {
+        halide_error(user_context, "destination buffer must have one fewer dimension than the source buffer\n");
+        return halide_error_code_device_crop_failed;
+    }
+
+    src->device_interface->impl->use_module();
+    int err = src->device_interface->impl->device_slice(user_context, src, slice_dim, slice_pos, dst);
+
+    debug(user_context) << "halide_device_slice " << "\n"
+                        << " src: " << *src << "\n"
+                        << " dst: " << *dst << "\n";
+
+    return err;
+}
+
 WEAK int halide_default_device_release_crop(void *user_context,
                                             struct halide_buffer_t *buf) {
     if (!buf->device) {
@@ -604,6 +821,36 @@ WEAK int halide_default_device_release_crop(void *user_context,
 }
 
 
+WEAK int halide_buffer_mark_host_dirty_region(void *user_context, struct halide_buffer_t *buf,
+                                              const halide_dimension_t *box) {
+    if (buf == NULL || box == NULL) {
+        return halide_error_buffer_is_null(user_context, "halide_buffer_mark_host_dirty_region");
+    }
+    ScopedMutexLock lock(&device_copy_mutex);
+    if (buf->host_dirty() && find_dirty_region(buf) == NULL) {
+        // The whole buffer is already dirty; a sub-region mark can't
+        // narrow that.
+        return 0;
+    }
+    mark_dirty_region_already_locked(buf, box);
+    buf->set_host_dirty(true);
+    return 0;
+}
+
+WEAK int halide_buffer_mark_device_dirty_region(void *user_context, struct halide_buffer_t *buf,
+                                                const halide_dimension_t *box) {
+    if (buf == NULL || box == NULL) {
+        return halide_error_buffer_is_null(user_context, "halide_buffer_mark_device_dirty_region");
+    }
+    ScopedMutexLock lock(&device_copy_mutex);
+    if (buf->device_dirty() && find_dirty_region(buf) == NULL) {
+        return 0;
+    }
+    mark_dirty_region_already_locked(buf, box);
+    buf->set_device_dirty(true);
+    return 0;
+}
+
 WEAK int halide_device_release_crop(void *user_context,
                                     struct halide_buffer_t *buf) {
     if (buf->device) {
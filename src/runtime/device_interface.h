@@ -24,6 +24,10 @@ struct halide_device_interface_impl_t {
     int (*device_crop)(void *user_context,
                        const struct halide_buffer_t *src,
                        struct halide_buffer_t *dst);
+    int (*device_slice)(void *user_context,
+                        const struct halide_buffer_t *src,
+                        int slice_dim, int slice_pos,
+                        struct halide_buffer_t *dst);
     int (*device_release_crop)(void *user_context,
                                struct halide_buffer_t *buf);
     int (*wrap_native)(void *user_context, struct halide_buffer_t *buf, uint64_t handle);
@@ -39,6 +43,9 @@ extern WEAK int halide_default_buffer_copy(void *user_context, struct halide_buf
                                            struct halide_buffer_t *dst);
 extern WEAK int halide_default_device_crop(void *user_context, const struct halide_buffer_t *src,
                                            struct halide_buffer_t *dst);
+extern WEAK int halide_default_device_slice(void *user_context, const struct halide_buffer_t *src,
+                                            int slice_dim, int slice_pos,
+                                            struct halide_buffer_t *dst);
 extern WEAK int halide_default_device_release_crop(void *user_context, struct halide_buffer_t *buf);
 extern WEAK int halide_default_device_wrap_native(void *user_context, struct halide_buffer_t *buf, uint64_t handle);
 extern WEAK int halide_default_device_detach_native(void *user_context, struct halide_buffer_t *buf);
@@ -0,0 +1,85 @@
+#include "HalideRuntime.h"
+#include "printer.h"
+
+// Hooks for cooperative execution across multiple processes. Halide
+// itself performs no communication: it reports the topology installed
+// here and routes input footprints through the exchange hook so a
+// user-provided handler (typically built on MPI) can fill ghost
+// zones. The defaults describe a single-process world.
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+WEAK int distributed_rank = 0;
+WEAK int distributed_size = 1;
+
+}}} // namespace Halide::Runtime::Internal
+
+extern "C" {
+
+WEAK int halide_distributed_rank() {
+    return distributed_rank;
+}
+
+WEAK int halide_distributed_size() {
+    return distributed_size;
+}
+
+WEAK void halide_set_distributed_topology(int rank, int size) {
+    distributed_rank = rank;
+    distributed_size = size;
+}
+
+// The default exchange cannot fetch anything; it just checks that the
+// required region is already present, so that single-process runs and
+// inputs without ghost zones work without a handler installed.
+WEAK int halide_default_distributed_exchange(void *user_context,
+                                             struct halide_buffer_t *buf,
+                                             const int *required_min,
+                                             const int *required_extent,
+                                             int dimensions) {
+    for (int i = 0; i < dimensions; i++) {
+        int req_min = required_min[i];
+        int req_max = required_min[i] + required_extent[i] - 1;
+        int buf_min = buf->dim[i].min;
+        int buf_max = buf->dim[i].min + buf->dim[i].extent - 1;
+        if (req_min < buf_min || req_max > buf_max) {
+            error(user_context)
+                << "Pipeline requires [" << req_min << ", " << req_max
+                << "] of an input in dimension " << i
+                << ", but only [" << buf_min << ", " << buf_max
+                << "] is present. Install a ghost zone handler with "
+                << "halide_set_custom_distributed_exchange.";
+            return halide_error_code_generic_error;
+        }
+    }
+    return 0;
+}
+
+}
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+WEAK halide_distributed_exchange_t custom_distributed_exchange =
+    halide_default_distributed_exchange;
+
+}}} // namespace Halide::Runtime::Internal
+
+extern "C" {
+
+WEAK halide_distributed_exchange_t halide_set_custom_distributed_exchange(
+        halide_distributed_exchange_t exchange) {
+    halide_distributed_exchange_t result = custom_distributed_exchange;
+    custom_distributed_exchange = exchange;
+    return result;
+}
+
+WEAK int halide_distributed_exchange(void *user_context,
+                                     struct halide_buffer_t *buf,
+                                     const int *required_min,
+                                     const int *required_extent,
+                                     int dimensions) {
+    return custom_distributed_exchange(user_context, buf, required_min,
+                                       required_extent, dimensions);
+}
+
+}
@@ -0,0 +1,12 @@
+#include "HalideRuntime.h"
+#include "runtime_internal.h"
+
+extern "C" {
+
+// Core topology detection is not supported on this platform; report
+// the cores as homogeneous.
+WEAK int halide_host_cpu_big_cores(uint64_t *mask, int words, int *little_ratio) {
+    return 0;
+}
+
+}
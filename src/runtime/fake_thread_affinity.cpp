@@ -0,0 +1,11 @@
+#include "HalideRuntime.h"
+#include "runtime_internal.h"
+
+extern "C" {
+
+// Thread affinity is not supported on this platform.
+WEAK int halide_host_cpu_set_affinity(const uint64_t *mask, int words) {
+    return -1;
+}
+
+}
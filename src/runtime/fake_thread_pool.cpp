@@ -51,6 +51,20 @@ WEAK int halide_set_num_threads(int n) {
     return 1;
 }
 
+WEAK int halide_get_num_threads() {
+    return 1;
+}
+
+WEAK int halide_set_task_priority(int priority) {
+    // There is no queue for tasks to jump.
+    return 0;
+}
+
+WEAK int halide_set_thread_affinity(const uint64_t *mask, int words) {
+    // There are no threads to pin.
+    return -1;
+}
+
 WEAK halide_do_task_t halide_set_custom_do_task(halide_do_task_t f) {
     halide_do_task_t result = custom_do_task;
     custom_do_task = f;
@@ -0,0 +1,100 @@
+#ifndef HALIDE_RUNTIME_GPU_KERNEL_CACHE_H
+#define HALIDE_RUNTIME_GPU_KERNEL_CACHE_H
+
+#include "printer.h"
+
+// An optional on-disk cache for compiled GPU kernel binaries, shared
+// by the OpenCL and CUDA runtimes. Compiling kernel source at process
+// start can cost seconds per pipeline on embedded GPUs; caching the
+// driver's output keyed by source, device, and driver version makes
+// subsequent process starts cheap. The cache is enabled by setting
+// HL_GPU_KERNEL_CACHE_DIR to an existing, writable directory. Entries
+// are never evicted; the directory can simply be deleted to clear it.
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+// 64-bit FNV-1a. Fold each component of the cache key into the hash
+// in turn, starting from kernel_cache_hash_seed.
+WEAK uint64_t kernel_cache_hash(uint64_t h, const void *bytes, size_t size) {
+    const uint8_t *p = (const uint8_t *)bytes;
+    for (size_t i = 0; i < size; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static const uint64_t kernel_cache_hash_seed = 14695981039346656037ULL;
+
+// Entries start with a small header so that truncated or foreign
+// files are rejected on load.
+struct kernel_cache_file_header {
+    uint64_t magic;
+    uint64_t size;
+};
+
+static const uint64_t kernel_cache_file_magic = 0x304b4c48656c6148ULL; // "HaleHLK0"
+
+// Returns the cache directory, or NULL if caching is disabled.
+WEAK const char *kernel_cache_dir() {
+    const char *dir = getenv("HL_GPU_KERNEL_CACHE_DIR");
+    if (dir && *dir) {
+        return dir;
+    }
+    return NULL;
+}
+
+// Load a cache entry into a freshly malloc-ed buffer, which the
+// caller owns. Returns NULL and leaves *size unchanged on a miss or a
+// corrupt entry.
+WEAK void *kernel_cache_load(void *user_context, const char *path, size_t *size) {
+    void *f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    kernel_cache_file_header header;
+    void *buf = NULL;
+    if (fread(&header, sizeof(header), 1, f) == 1 &&
+        header.magic == kernel_cache_file_magic &&
+        header.size > 0) {
+        buf = malloc((size_t)header.size);
+        if (buf && fread(buf, (size_t)header.size, 1, f) != 1) {
+            free(buf);
+            buf = NULL;
+        }
+    }
+    fclose(f);
+    if (buf) {
+        *size = (size_t)header.size;
+        debug(user_context) << "    loaded cached kernel binary from " << path << "\n";
+    }
+    return buf;
+}
+
+// Store a cache entry. Writes to a temporary file and renames it into
+// place so that a concurrently-starting process never observes a
+// partially-written entry. Failure to store is not an error; the
+// binary just gets recompiled next time.
+WEAK void kernel_cache_store(void *user_context, const char *path,
+                             const void *bytes, size_t size) {
+    stringstream tmp_path(user_context);
+    tmp_path << path << "." << (uint64_t)halide_current_time_ns(user_context) << ".tmp";
+    void *f = fopen(tmp_path.str(), "wb");
+    if (!f) {
+        debug(user_context) << "    could not open " << tmp_path.str() << " to cache kernel binary\n";
+        return;
+    }
+    kernel_cache_file_header header = {kernel_cache_file_magic, (uint64_t)size};
+    bool ok = (fwrite(&header, sizeof(header), 1, f) == 1 &&
+               fwrite(bytes, size, 1, f) == 1);
+    fclose(f);
+    if (!ok || rename(tmp_path.str(), path) != 0) {
+        remove(tmp_path.str());
+    } else {
+        debug(user_context) << "    cached kernel binary at " << path << "\n";
+    }
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+#endif // HALIDE_RUNTIME_GPU_KERNEL_CACHE_H
@@ -14,6 +14,13 @@ struct ion_device_handle {
 
 WEAK halide_mutex thread_lock = { { 0 } };
 
+// State for coalescing HVX power votes, so that nested or overlapping
+// pipeline invocations make at most one power RPC per transition
+// instead of one per invocation.
+WEAK halide_mutex hvx_power_lock = { { 0 } };
+WEAK int hvx_power_votes = 0;
+WEAK bool hvx_powered = false;
+
 extern WEAK halide_device_interface_t hexagon_device_interface;
 
 // Define dynamic version of hexagon_remote/halide_hexagon_remote.h
@@ -87,6 +94,17 @@ WEAK void get_remote_profiler_state(int *func, int *threads) {
     }
 
     remote_poll_profiler_state(func, threads);
+
+    if (*func < 0) {
+        // The DSP isn't inside a profiled func: it's in RPC glue or
+        // power transitions, or the loaded module was built without
+        // profiling. Bill the sample to whatever the host was doing
+        // (normally the func that launched the offloaded section)
+        // rather than to a stale remote func id.
+        halide_profiler_state *s = halide_profiler_get_state();
+        *func = s->current_func;
+        *threads = s->active_threads;
+    }
 }
 
 template <typename T>
@@ -160,11 +178,27 @@ WEAK int init_hexagon_runtime(void *user_context) {
 // when then context is released.
 struct module_state {
     halide_hexagon_handle_t module;
+    // A hash of the code the module was loaded from, so that
+    // identical code uploaded by another pipeline can share the
+    // remote module instead of being uploaded again.
+    uint64_t code_hash;
+    uint64_t code_size;
+    bool owns_module;
     module_state *next;
 };
 WEAK module_state *state_list = NULL;
 WEAK halide_hexagon_handle_t shared_runtime = 0;
 
+// FNV-1a, used to key the cache of uploaded modules.
+WEAK uint64_t hash_code(const uint8_t *code, uint64_t size) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (uint64_t i = 0; i < size; i++) {
+        h ^= code[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
 }}}}  // namespace Halide::Runtime::Internal::Hexagon
 
 using namespace Halide::Runtime::Internal;
@@ -232,25 +266,51 @@ WEAK int halide_hexagon_initialize_kernels(void *user_context, void **state_ptr,
         *state = (module_state*)malloc(sizeof(module_state));
         debug(user_context) << "        " << *state << "\n";
         (*state)->module = 0;
+        (*state)->code_hash = 0;
+        (*state)->code_size = 0;
+        (*state)->owns_module = false;
         (*state)->next = state_list;
         state_list = *state;
     }
 
     // Create the module itself if necessary.
     if (!(*state)->module) {
-        static int unique_id = 0;
-        stringstream soname(user_context);
-        soname << "libhalide_kernels" << unique_id++ << ".so";
-        debug(user_context) << "    halide_remote_load_library(" << soname.str() << ") -> ";
-        halide_hexagon_handle_t module = 0;
-        result = remote_load_library(soname.str(), soname.size() + 1, code, code_size, &module);
-        poll_log(user_context);
-        if (result == 0) {
-            debug(user_context) << "        " << module << "\n";
-            (*state)->module = module;
+        // If a module with identical code is already resident on the
+        // DSP, share it instead of uploading another copy.
+        uint64_t hash = hash_code(code, code_size);
+        module_state *existing = NULL;
+        for (module_state *s = state_list; s; s = s->next) {
+            if (s != *state && s->module &&
+                s->code_size == code_size && s->code_hash == hash) {
+                existing = s;
+                break;
+            }
+        }
+        if (existing) {
+            debug(user_context) << "    re-using module " << existing->module
+                                << " with identical code\n";
+            (*state)->module = existing->module;
+            (*state)->code_hash = hash;
+            (*state)->code_size = code_size;
+            (*state)->owns_module = false;
         } else {
-            debug(user_context) << "        " << result << "\n";
-            error(user_context) << "Initialization of Hexagon kernels failed\n";
+            static int unique_id = 0;
+            stringstream soname(user_context);
+            soname << "libhalide_kernels" << unique_id++ << ".so";
+            debug(user_context) << "    halide_remote_load_library(" << soname.str() << ") -> ";
+            halide_hexagon_handle_t module = 0;
+            result = remote_load_library(soname.str(), soname.size() + 1, code, code_size, &module);
+            poll_log(user_context);
+            if (result == 0) {
+                debug(user_context) << "        " << module << "\n";
+                (*state)->module = module;
+                (*state)->code_hash = hash;
+                (*state)->code_size = code_size;
+                (*state)->owns_module = true;
+            } else {
+                debug(user_context) << "        " << result << "\n";
+                error(user_context) << "Initialization of Hexagon kernels failed\n";
+            }
         }
     } else {
         debug(user_context) << "    re-using existing module " << (*state)->module << "\n";
@@ -393,17 +453,24 @@ WEAK int halide_hexagon_device_release(void *user_context) {
     debug(user_context)
         << "Hexagon: halide_hexagon_device_release (user_context: " <<  user_context << ")\n";
 
+    // Free any ION allocations held by the pool.
+    halide_hexagon_release_unused_buffers(user_context);
+
     ScopedMutexLock lock(&thread_lock);
 
     // Release all of the remote side modules.
     module_state *state = state_list;
     while (state) {
         if (state->module) {
-            debug(user_context) << "    halide_remote_release_library " << state
-                                << " (" << state->module << ") -> ";
-            int result = remote_release_library(state->module);
-            poll_log(user_context);
-            debug(user_context) << "        " << result << "\n";
+            // Modules shared between states are only released by the
+            // state that uploaded them.
+            if (state->owns_module) {
+                debug(user_context) << "    halide_remote_release_library " << state
+                                    << " (" << state->module << ") -> ";
+                int result = remote_release_library(state->module);
+                poll_log(user_context);
+                debug(user_context) << "        " << result << "\n";
+            }
             state->module = 0;
         }
         state = state->next;
@@ -431,6 +498,89 @@ WEAK int halide_hexagon_device_release(void *user_context) {
 // arguments than simply mapping the pages.
 static const int min_ion_allocation_size = 4096;
 
+namespace {
+
+// A pool of ION allocations released by previous realizes. Reusing
+// one avoids an allocation syscall and the remote mapping work per
+// frame in steady-state pipelines. The pool is capped to avoid
+// holding arbitrary amounts of ION memory; anything beyond the cap is
+// freed eagerly.
+struct ion_pool_entry {
+    ion_pool_entry *next;
+    void *buf;
+    size_t size;
+};
+
+WEAK halide_mutex ion_pool_lock = { { 0 } };
+WEAK ion_pool_entry *ion_pool = NULL;
+WEAK int ion_pool_count = 0;
+static const int max_ion_pool_entries = 16;
+
+// Take the smallest pooled allocation that is at least size bytes,
+// but no more than twice that, so small requests don't pin large
+// blocks. Returns NULL if there is no suitable entry.
+WEAK void *ion_pool_get(void *user_context, size_t size, size_t *actual_size) {
+    ScopedMutexLock lock(&ion_pool_lock);
+    ion_pool_entry **best = NULL;
+    for (ion_pool_entry **prev = &ion_pool; *prev; prev = &(*prev)->next) {
+        ion_pool_entry *entry = *prev;
+        if (entry->size >= size && entry->size <= size * 2 &&
+            (!best || entry->size < (*best)->size)) {
+            best = prev;
+        }
+    }
+    if (!best) {
+        return NULL;
+    }
+    ion_pool_entry *entry = *best;
+    *best = entry->next;
+    ion_pool_count--;
+    void *buf = entry->buf;
+    *actual_size = entry->size;
+    free(entry);
+    return buf;
+}
+
+// Return an ION allocation to the pool, or free it if the pool is full.
+WEAK void ion_pool_put(void *user_context, void *buf, size_t size) {
+    ion_pool_entry *entry = NULL;
+    {
+        ScopedMutexLock lock(&ion_pool_lock);
+        if (ion_pool_count < max_ion_pool_entries) {
+            entry = (ion_pool_entry *)malloc(sizeof(ion_pool_entry));
+            if (entry) {
+                entry->buf = buf;
+                entry->size = size;
+                entry->next = ion_pool;
+                ion_pool = entry;
+                ion_pool_count++;
+            }
+        }
+    }
+    if (!entry) {
+        debug(user_context) << "    host_free ion=" << buf << "\n";
+        host_free(buf);
+    }
+}
+
+}  // namespace
+
+WEAK int halide_hexagon_release_unused_buffers(void *user_context) {
+    debug(user_context)
+        << "Hexagon: halide_hexagon_release_unused_buffers (user_context: " << user_context << ")\n";
+
+    ScopedMutexLock lock(&ion_pool_lock);
+    while (ion_pool) {
+        ion_pool_entry *entry = ion_pool;
+        ion_pool = entry->next;
+        debug(user_context) << "    host_free ion=" << entry->buf << "\n";
+        host_free(entry->buf);
+        free(entry);
+    }
+    ion_pool_count = 0;
+    return 0;
+}
+
 WEAK int halide_hexagon_device_malloc(void *user_context, halide_buffer_t *buf) {
     int result = init_hexagon_runtime(user_context);
     if (result != 0) return result;
@@ -463,10 +613,17 @@ WEAK int halide_hexagon_device_malloc(void *user_context, halide_buffer_t *buf)
     #endif
 
     void *ion;
+    size_t actual_size = size;
     if (size >= min_ion_allocation_size) {
-        debug(user_context) << "    host_malloc len=" << (uint64_t)size << " -> ";
-        ion = host_malloc(size);
-        debug(user_context) << "        " << ion << "\n";
+        ion = ion_pool_get(user_context, size, &actual_size);
+        if (ion) {
+            debug(user_context) << "    reusing pooled allocation of "
+                                << (uint64_t)actual_size << " bytes -> " << ion << "\n";
+        } else {
+            debug(user_context) << "    host_malloc len=" << (uint64_t)size << " -> ";
+            ion = host_malloc(size);
+            debug(user_context) << "        " << ion << "\n";
+        }
         if (!ion) {
             error(user_context) << "host_malloc failed\n";
             return -1;
@@ -481,10 +638,10 @@ WEAK int halide_hexagon_device_malloc(void *user_context, halide_buffer_t *buf)
         }
     }
 
-    int err = halide_hexagon_wrap_device_handle(user_context, buf, ion, size);
+    int err = halide_hexagon_wrap_device_handle(user_context, buf, ion, actual_size);
     if (err != 0) {
         if (size >= min_ion_allocation_size) {
-            host_free(ion);
+            ion_pool_put(user_context, ion, actual_size);
         } else {
             halide_free(user_context, ion);
         }
@@ -519,8 +676,8 @@ WEAK int halide_hexagon_device_free(void *user_context, halide_buffer_t* buf) {
     void *ion = halide_hexagon_get_device_handle(user_context, buf);
     halide_hexagon_detach_device_handle(user_context, buf);
     if (size >= min_ion_allocation_size) {
-        debug(user_context) << "    host_free ion=" << ion << "\n";
-        host_free(ion);
+        debug(user_context) << "    pooling ion=" << ion << "\n";
+        ion_pool_put(user_context, ion, size);
     } else {
         debug(user_context) << "    halide_free ion=" << ion << "\n";
         halide_free(user_context, ion);
@@ -669,23 +826,17 @@ WEAK int halide_hexagon_device_and_host_free(void *user_context, struct halide_b
     return 0;
 }
 
-WEAK int halide_hexagon_device_crop(void *user_context, const struct halide_buffer_t *src,
-                                    struct halide_buffer_t *dst) {
-    debug(user_context) << "halide_hexagon_device_crop called.\n";
-
-    // Pointer arithmetic works fine.
-    int64_t offset = 0;
-    for (int i = 0; i < src->dimensions; i++) {
-        offset += (dst->dim[i].min - src->dim[i].min) * src->dim[i].stride;
-    }
-    offset *= src->type.bytes();
+namespace {
 
+WEAK int hexagon_device_crop_from_offset(const struct halide_buffer_t *src,
+                                         int64_t offset,
+                                         struct halide_buffer_t *dst) {
     ion_device_handle *src_handle = (ion_device_handle *)src->device;
     ion_device_handle *dst_handle = (ion_device_handle *)malloc(sizeof(ion_device_handle));
     if (!dst_handle) {
         return halide_error_code_out_of_memory;
     }
-    
+
     dst_handle->buffer = (uint8_t *)src_handle->buffer + offset;
     dst_handle->size = src_handle->size - offset;
     dst->device = reinterpret<uint64_t>(dst_handle);
@@ -694,6 +845,31 @@ WEAK int halide_hexagon_device_crop(void *user_context, const struct halide_buff
     return 0;
 }
 
+}  // namespace
+
+WEAK int halide_hexagon_device_crop(void *user_context, const struct halide_buffer_t *src,
+                                    struct halide_buffer_t *dst) {
+    debug(user_context) << "halide_hexagon_device_crop called.\n";
+
+    // Pointer arithmetic works fine.
+    int64_t offset = 0;
+    for (int i = 0; i < src->dimensions; i++) {
+        offset += (dst->dim[i].min - src->dim[i].min) * src->dim[i].stride;
+    }
+    offset *= src->type.bytes();
+    return hexagon_device_crop_from_offset(src, offset, dst);
+}
+
+WEAK int halide_hexagon_device_slice(void *user_context, const struct halide_buffer_t *src,
+                                     int slice_dim, int slice_pos,
+                                     struct halide_buffer_t *dst) {
+    debug(user_context) << "halide_hexagon_device_slice called.\n";
+
+    int64_t offset = (slice_pos - src->dim[slice_dim].min) * src->dim[slice_dim].stride;
+    offset *= src->type.bytes();
+    return hexagon_device_crop_from_offset(src, offset, dst);
+}
+
 WEAK int halide_hexagon_device_release_crop(void *user_context, struct halide_buffer_t *dst) {
     debug(user_context) << "halide_hexagon_release_crop called\n";
     free((ion_device_handle *)dst->device);
@@ -711,6 +887,15 @@ WEAK int halide_hexagon_power_hvx_on(void *user_context) {
         return 0;
     }
 
+    // Take a vote. Only the transition from powered off to powered on
+    // needs a round trip to the DSP.
+    ScopedMutexLock lock(&hvx_power_lock);
+    hvx_power_votes++;
+    if (hvx_powered) {
+        debug(user_context) << "    already powered on\n";
+        return 0;
+    }
+
     #ifdef DEBUG_RUNTIME
     uint64_t t_before = halide_current_time_ns(user_context);
     #endif
@@ -720,8 +905,10 @@ WEAK int halide_hexagon_power_hvx_on(void *user_context) {
     debug(user_context) << "        " << result << "\n";
     if (result != 0) {
         error(user_context) << "remote_power_hvx_on failed.\n";
+        hvx_power_votes--;
         return result;
     }
+    hvx_powered = true;
 
     #ifdef DEBUG_RUNTIME
     uint64_t t_after = halide_current_time_ns(user_context);
@@ -742,6 +929,18 @@ WEAK int halide_hexagon_power_hvx_off(void *user_context) {
         return 0;
     }
 
+    // Drop a vote. Only power off when the last vote is released, so
+    // overlapping pipeline invocations and explicit user votes share
+    // one power transition.
+    ScopedMutexLock lock(&hvx_power_lock);
+    if (hvx_power_votes > 0) {
+        hvx_power_votes--;
+    }
+    if (hvx_power_votes > 0 || !hvx_powered) {
+        debug(user_context) << "    keeping power on, " << hvx_power_votes << " votes remain\n";
+        return 0;
+    }
+
     #ifdef DEBUG_RUNTIME
     uint64_t t_before = halide_current_time_ns(user_context);
     #endif
@@ -753,6 +952,7 @@ WEAK int halide_hexagon_power_hvx_off(void *user_context) {
         error(user_context) << "remote_power_hvx_off failed.\n";
         return result;
     }
+    hvx_powered = false;
 
     #ifdef DEBUG_RUNTIME
     uint64_t t_after = halide_current_time_ns(user_context);
@@ -844,6 +1044,7 @@ WEAK halide_device_interface_impl_t hexagon_device_interface_impl = {
     halide_hexagon_device_and_host_free,
     halide_default_buffer_copy,
     halide_hexagon_device_crop,
+    halide_hexagon_device_slice,
     halide_hexagon_device_release_crop,
     halide_default_device_wrap_native,
     halide_default_device_detach_native,
@@ -860,6 +1061,7 @@ WEAK halide_device_interface_t hexagon_device_interface = {
     halide_device_and_host_free,
     halide_buffer_copy,
     halide_device_crop,
+    halide_device_slice,
     halide_device_release_crop,
     halide_device_wrap_native,
     halide_device_detach_native,
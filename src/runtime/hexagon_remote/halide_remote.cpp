@@ -356,6 +356,16 @@ int halide_hexagon_remote_run_v2(handle_t module_ptr, handle_t function,
         *next_arg = const_cast<scalar_t *>(&scalars[i]);
     }
 
+    // While the pipeline runs, the host-side profiler samples our
+    // profiler state over RPC. Reset it on the way in and out, so
+    // that time spent outside the pipeline body (RPC glue, HVX power
+    // transitions, or a module built without profiling) is reported
+    // as such instead of being billed to whatever func id a previous
+    // invocation left behind.
+    halide_profiler_state *prof = halide_profiler_get_state();
+    prof->current_func = halide_profiler_outside_of_halide;
+    prof->active_threads = 0;
+
     // Prior to running the pipeline, power HVX on (if it was not already on).
     int result = halide_hexagon_remote_power_hvx_on();
     if (result != 0) {
@@ -368,6 +378,9 @@ int halide_hexagon_remote_run_v2(handle_t module_ptr, handle_t function,
     // Power HVX off.
     halide_hexagon_remote_power_hvx_off();
 
+    prof->current_func = halide_profiler_outside_of_halide;
+    prof->active_threads = 0;
+
     return result;
 }
 
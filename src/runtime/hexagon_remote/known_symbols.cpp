@@ -22,6 +22,11 @@ extern "C" {
 // More symbols we need to support.
 extern int qurt_hvx_lock;
 extern int qurt_hvx_unlock;
+// The VTCM manager is only present on newer SDKs/targets, so bind to
+// it weakly. If it isn't available, these resolve to null and loading
+// a pipeline that uses VTCM fails with an unresolved symbol error.
+__attribute__((weak)) extern int HAP_request_VTCM;
+__attribute__((weak)) extern int HAP_release_VTCM;
 extern int __hexagon_muldf3;
 extern int __hexagon_divdf3;
 extern int __hexagon_adddf3;
@@ -108,6 +113,8 @@ void *get_known_symbol(const char *name) {
         {"halide_profiler_get_state", (char *)(&halide_profiler_get_state)},
         {"qurt_hvx_lock", (char *)(&qurt_hvx_lock)},
         {"qurt_hvx_unlock", (char *)(&qurt_hvx_unlock)},
+        {"HAP_request_VTCM", (char *)(&HAP_request_VTCM)},
+        {"HAP_release_VTCM", (char *)(&HAP_release_VTCM)},
 
         {"__hexagon_divdf3", (char *)(&__hexagon_divdf3)},
         {"__hexagon_muldf3", (char *)(&__hexagon_muldf3)},
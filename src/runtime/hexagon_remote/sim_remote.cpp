@@ -63,6 +63,19 @@ int qurt_hvx_unlock() {
     return 0;
 }
 
+// The simulator doesn't have a VTCM manager, so just hand out
+// suitably aligned heap memory. This keeps pipelines that use
+// MemoryType::VTCM loadable and functionally correct on the
+// simulator, without modelling the performance of real VTCM.
+void *HAP_request_VTCM(unsigned int size, unsigned int single_page_flag) {
+    return aligned_malloc(hvx_alignment, size);
+}
+
+int HAP_release_VTCM(void *pVA) {
+    aligned_free(pVA);
+    return 0;
+}
+
 void halide_print(void *user_context, const char *str) {
     log_printf("%s", str);
 }
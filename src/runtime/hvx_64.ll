@@ -411,3 +411,13 @@ define weak_odr <32 x i32> @halide.hexagon.vtmpy.vh.vh.b.b(<32 x i16> %low_v, <3
   %res = call <32 x i32> @llvm.hexagon.V6.vtmpyhb(<32 x i32> %dv, i32 %const)
   ret <32 x i32> %res
 }
+
+; Scatters to VTCM are posted: they complete asynchronously. The
+; release sequence is a vmem store tagged scatter_release followed by
+; a load of the same address, which stalls until all outstanding
+; scatters have landed. There is no LLVM intrinsic for the tag, so
+; spell the sequence out as inline asm.
+define weak_odr void @halide.hexagon.scatter.release(i8* %ptr) nounwind uwtable {
+  %unused = call <16 x i32> asm sideeffect "vmem($1+#0):scatter_release\0A\09$0 = vmem($1+#0)", "=v,r,~{memory}"(i8* %ptr)
+  ret void
+}
@@ -0,0 +1,99 @@
+#include "HalideRuntime.h"
+#include "runtime_internal.h"
+
+// Detects heterogeneous CPU core classes (e.g. ARM big.LITTLE) by
+// comparing the maximum frequency sysfs advertises for each core.
+// Cores that can reach the highest frequency present on the system
+// are "big"; everything else is "little".
+
+extern "C" {
+
+// Provided by libc. The real open is variadic; calling it with two
+// arguments is ABI-compatible on every Linux target we support.
+extern int open(const char *pathname, int flags);
+extern long read(int fd, void *buf, size_t count);
+extern int close(int fd);
+
+}
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+// Returns the value of
+// /sys/devices/system/cpu/cpu<n>/cpufreq/cpuinfo_max_freq, or zero if
+// it can't be read (e.g. no cpufreq driver, or the core is offline).
+WEAK int64_t linux_cpu_max_freq(int cpu) {
+    const char *prefix = "/sys/devices/system/cpu/cpu";
+    const char *suffix = "/cpufreq/cpuinfo_max_freq";
+    char path[64];
+    char *dst = path;
+    for (const char *p = prefix; *p; p++) *dst++ = *p;
+    char digits[8];
+    int n = 0;
+    do {
+        digits[n++] = '0' + (cpu % 10);
+        cpu /= 10;
+    } while (cpu && n < 8);
+    while (n) *dst++ = digits[--n];
+    for (const char *p = suffix; *p; p++) *dst++ = *p;
+    *dst = 0;
+
+    int fd = open(path, 0 /* O_RDONLY */);
+    if (fd < 0) {
+        return 0;
+    }
+    char buf[32];
+    long len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    int64_t freq = 0;
+    for (long i = 0; i < len && buf[i] >= '0' && buf[i] <= '9'; i++) {
+        freq = freq * 10 + (buf[i] - '0');
+    }
+    return freq;
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+extern "C" {
+
+WEAK int halide_host_cpu_big_cores(uint64_t *mask, int words, int *little_ratio) {
+    if (mask == NULL || words <= 0) {
+        return 0;
+    }
+    int num_cpus = halide_host_cpu_count();
+    if (num_cpus > words * 64) {
+        num_cpus = words * 64;
+    }
+
+    // First pass: find the fastest and slowest core classes. If any
+    // core's frequency is unreadable the topology is unknown.
+    int64_t big = 0, little = 0;
+    for (int i = 0; i < num_cpus; i++) {
+        int64_t f = linux_cpu_max_freq(i);
+        if (f == 0) {
+            return 0;
+        }
+        if (f > big) big = f;
+        if (little == 0 || f < little) little = f;
+    }
+    if (big == little) {
+        // Homogeneous.
+        return 0;
+    }
+
+    for (int i = 0; i < words; i++) {
+        mask[i] = 0;
+    }
+    int num_big = 0;
+    for (int i = 0; i < num_cpus; i++) {
+        if (linux_cpu_max_freq(i) == big) {
+            mask[i / 64] |= (uint64_t)1 << (i % 64);
+            num_big++;
+        }
+    }
+    if (little_ratio) {
+        *little_ratio = (int)((little * 100) / big);
+    }
+    return num_big;
+}
+
+}
@@ -0,0 +1,141 @@
+#include "HalideRuntime.h"
+#include "runtime_internal.h"
+#include "printer.h"
+#include "scoped_mutex_lock.h"
+
+// A perf_event-based source of hardware performance counters for the
+// sampling profiler. Opens one counter each for instructions retired,
+// last-level cache misses, and branch misses, covering the opening
+// thread and any threads it spawns afterwards, and installs a reader
+// in the global profiler state. The sampling thread attributes the
+// per-sample deltas to the running func.
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+// A prefix of struct perf_event_attr from linux/perf_event.h, which
+// we can't include here. The kernel accepts any size it knows about;
+// 64 bytes is the original (v0) layout, which is all we need.
+struct halide_perf_event_attr {
+    uint32_t type;
+    uint32_t size;
+    uint64_t config;
+    uint64_t sample_period;
+    uint64_t sample_type;
+    uint64_t read_format;
+    uint64_t flags;
+    uint32_t wakeup_events;
+    uint32_t bp_type;
+    uint64_t bp_addr;
+    uint64_t bp_len;
+};
+
+// PERF_TYPE_HARDWARE event configs.
+enum {
+    halide_perf_count_hw_instructions = 1,
+    halide_perf_count_hw_cache_misses = 3,
+    halide_perf_count_hw_branch_misses = 5,
+};
+
+WEAK int perf_counter_fds[3] = {-1, -1, -1};
+
+}}} // namespace Halide::Runtime::Internal
+
+extern "C" {
+
+// Provided by libc.
+extern long syscall(long number, ...);
+extern long read(int fd, void *buf, size_t count);
+extern int close(int fd);
+
+}
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+WEAK int perf_event_open(uint64_t config) {
+#if defined(__x86_64__)
+    const long nr_perf_event_open = 298;
+#elif defined(__i386__)
+    const long nr_perf_event_open = 336;
+#elif defined(__aarch64__)
+    const long nr_perf_event_open = 241;
+#elif defined(__arm__)
+    const long nr_perf_event_open = 364;
+#else
+    return -1;
+#endif
+    halide_perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = 0;  // PERF_TYPE_HARDWARE
+    attr.size = sizeof(attr);
+    attr.config = config;
+    // inherit | exclude_kernel | exclude_hv. The counter starts
+    // enabled and follows threads spawned after this call.
+    attr.flags = (1 << 1) | (1 << 5) | (1 << 6);
+    // This thread, any cpu.
+    return (int)syscall(nr_perf_event_open, &attr, 0, -1, -1, 0UL);
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+using namespace Halide::Runtime::Internal;
+
+extern "C" {
+
+WEAK int halide_profiler_read_perf_counters(uint64_t values[3]) {
+    for (int i = 0; i < 3; i++) {
+        uint64_t v = 0;
+        if (perf_counter_fds[i] < 0 ||
+            read(perf_counter_fds[i], &v, sizeof(v)) != sizeof(v)) {
+            return -1;
+        }
+        values[i] = v;
+    }
+    return 0;
+}
+
+WEAK int halide_profiler_perf_counters_enable(void *user_context) {
+    halide_profiler_state *s = halide_profiler_get_state();
+    ScopedMutexLock lock(&s->lock);
+
+    if (s->read_perf_counters) {
+        // Already enabled.
+        return 0;
+    }
+
+    const uint64_t configs[3] = {halide_perf_count_hw_instructions,
+                                 halide_perf_count_hw_cache_misses,
+                                 halide_perf_count_hw_branch_misses};
+    for (int i = 0; i < 3; i++) {
+        perf_counter_fds[i] = perf_event_open(configs[i]);
+        if (perf_counter_fds[i] < 0) {
+            for (int j = 0; j < i; j++) {
+                close(perf_counter_fds[j]);
+                perf_counter_fds[j] = -1;
+            }
+            error(user_context) << "Failed to open perf_event hardware counters. "
+                                << "Check /proc/sys/kernel/perf_event_paranoid.";
+            return halide_error_code_generic_error;
+        }
+    }
+
+    s->read_perf_counters = halide_profiler_read_perf_counters;
+    return 0;
+}
+
+WEAK void halide_profiler_perf_counters_disable() {
+    halide_profiler_state *s = halide_profiler_get_state();
+    ScopedMutexLock lock(&s->lock);
+
+    if (!s->read_perf_counters) {
+        return;
+    }
+    s->read_perf_counters = NULL;
+    for (int i = 0; i < 3; i++) {
+        if (perf_counter_fds[i] >= 0) {
+            close(perf_counter_fds[i]);
+            perf_counter_fds[i] = -1;
+        }
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,19 @@
+#include "HalideRuntime.h"
+#include "runtime_internal.h"
+
+extern "C" {
+
+// Both glibc and bionic provide sched_setaffinity. The real signature
+// takes a pid_t and a cpu_set_t *; an int and an array of 64-bit
+// words are ABI-compatible on every Linux target we support. A pid of
+// zero means the calling thread.
+extern int sched_setaffinity(int pid, size_t cpusetsize, const uint64_t *mask);
+
+WEAK int halide_host_cpu_set_affinity(const uint64_t *mask, int words) {
+    if (mask == NULL || words <= 0) {
+        return -1;
+    }
+    return sched_setaffinity(0, words * sizeof(uint64_t), mask);
+}
+
+}
@@ -173,6 +173,24 @@ INLINE mxArray *create_numeric_matrix(size_t M, size_t N, mxClassID type, mxComp
     }
 }
 
+// While negotiating the layout of buffer arguments with a pipeline,
+// errors from rejected attempts are captured here instead of being
+// reported to the user, so an attempt we recover from doesn't warn.
+WEAK char captured_error[1024];
+
+WEAK void capture_error(void *user_context, const char *msg) {
+    if (captured_error[0] != 0) {
+        // Keep the first error; it describes the canonical attempt.
+        return;
+    }
+    size_t i = 0;
+    while (msg[i] != 0 && i + 1 < sizeof(captured_error)) {
+        captured_error[i] = msg[i];
+        i++;
+    }
+    captured_error[i] = 0;
+}
+
 }  // namespace mex
 }  // namespace Runtime
 }  // namespace Halide
@@ -250,10 +268,16 @@ WEAK int halide_matlab_init(void *user_context) {
     return halide_error_code_success;
 }
 
-// Convert a matlab mxArray to a Halide halide_buffer_t, with a specific number of dimensions.
+// Convert a matlab mxArray to a Halide halide_buffer_t, with a
+// specific number of dimensions. The halide_buffer_t wraps the
+// mxArray's memory directly; no copy of the data is made. If
+// transposed is true, the dimensions (and their strides) are
+// presented in reverse order, i.e. a row-major view of the same
+// memory.
 WEAK int halide_matlab_array_to_halide_buffer_t(void *user_context,
                                                 const mxArray *arr,
                                                 const halide_filter_argument_t *arg,
+                                                bool transposed,
                                                 halide_buffer_t *buf) {
 
     if (mxIsComplex(arr)) {
@@ -304,12 +328,20 @@ WEAK int halide_matlab_array_to_halide_buffer_t(void *user_context,
         }
     }
 
-    // Compute dense strides.
+    // Compute dense strides for the mxArray's column-major layout.
     buf->dim[0].stride = 1;
     for (int i = 1; i < expected_dims; i++) {
         buf->dim[i].stride = buf->dim[i-1].extent * buf->dim[i-1].stride;
     }
 
+    if (transposed) {
+        for (int i = 0, j = expected_dims - 1; i < j; i++, j--) {
+            halide_dimension_t dim_i = buf->dim[i];
+            buf->dim[i] = buf->dim[j];
+            buf->dim[j] = dim_i;
+        }
+    }
+
     return halide_error_code_success;
 }
 
@@ -408,6 +440,7 @@ WEAK int halide_matlab_call_pipeline(void *user_context,
         return result;
     }
 
+    bool has_transposable_buffer = false;
     void **args = (void **)__builtin_alloca(nrhs * sizeof(void *));
     for (int i = 0; i < nrhs; i++) {
         const mxArray *arg = prhs[i];
@@ -419,12 +452,13 @@ WEAK int halide_matlab_call_pipeline(void *user_context,
             memset(buf, 0, sizeof(halide_buffer_t));
             buf->dim = (halide_dimension_t *)__builtin_alloca(sizeof(halide_dimension_t) * arg_metadata->dimensions);
             memset(buf->dim, 0, sizeof(halide_dimension_t) * arg_metadata->dimensions);
-            result = halide_matlab_array_to_halide_buffer_t(user_context, arg, arg_metadata, buf);
+            result = halide_matlab_array_to_halide_buffer_t(user_context, arg, arg_metadata, false, buf);
             if (result != 0) {
                 halide_matlab_note_pipeline_description(user_context, metadata);
                 return result;
             }
             args[i] = buf;
+            has_transposable_buffer = has_transposable_buffer || arg_metadata->dimensions > 1;
         } else {
             size_t size_bytes = max(8, (arg_metadata->type.bits + 7) / 8);
             void *scalar = __builtin_alloca(size_bytes);
@@ -438,7 +472,36 @@ WEAK int halide_matlab_call_pipeline(void *user_context,
         }
     }
 
+    // Call the pipeline with the natural column-major interpretation
+    // of the arguments. If the pipeline was compiled with constraints
+    // that reject that interpretation (e.g. it was written expecting
+    // the transposed dimension order), retry with the dimensions and
+    // strides of every array reversed, still wrapping the mxArray
+    // memory directly. Errors from rejected attempts are captured and
+    // only reported if no interpretation succeeds.
+    captured_error[0] = 0;
+    halide_error_handler_t prev_handler = halide_set_error_handler(capture_error);
     result = pipeline(args);
+    if (result == halide_error_code_constraint_violated && has_transposable_buffer) {
+        for (int i = 0; i < nrhs; i++) {
+            const halide_filter_argument_t *arg_metadata = &metadata->arguments[i];
+            if (arg_metadata->kind == halide_argument_kind_input_buffer ||
+                arg_metadata->kind == halide_argument_kind_output_buffer) {
+                halide_buffer_t *buf = (halide_buffer_t *)args[i];
+                result = halide_matlab_array_to_halide_buffer_t(user_context, prhs[i], arg_metadata, true, buf);
+                if (result != 0) {
+                    // The natural interpretation converted, so this can't fail.
+                    halide_set_error_handler(prev_handler);
+                    return result;
+                }
+            }
+        }
+        result = pipeline(args);
+    }
+    halide_set_error_handler(prev_handler);
+    if (result != 0 && captured_error[0] != 0) {
+        halide_error(user_context, captured_error);
+    }
 
     // Copy any GPU resident output buffers back to the CPU before returning.
     for (int i = 0; i < nrhs; i++) {
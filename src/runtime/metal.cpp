@@ -190,6 +190,27 @@ WEAK void wait_until_completed(mtl_command_buffer *buffer) {
     objc_msgSend(buffer, sel_getUid("waitUntilCompleted"));
 }
 
+// GPUStartTime/GPUEndTime report when a completed command buffer
+// actually ran on the GPU, in seconds. Not available on older OS
+// versions.
+WEAK bool command_buffer_has_gpu_times(mtl_command_buffer *buffer) {
+    typedef bool (*responds_to_selector_method)(objc_id obj, objc_sel sel_1, objc_sel sel_2);
+    responds_to_selector_method method = (responds_to_selector_method)&objc_msgSend;
+    return (*method)(buffer, sel_getUid("respondsToSelector:"), sel_getUid("GPUStartTime"));
+}
+
+WEAK double command_buffer_gpu_start_time(mtl_command_buffer *buffer) {
+    typedef double (*gpu_time_method)(objc_id obj, objc_sel sel);
+    gpu_time_method method = (gpu_time_method)&objc_msgSend;
+    return (*method)(buffer, sel_getUid("GPUStartTime"));
+}
+
+WEAK double command_buffer_gpu_end_time(mtl_command_buffer *buffer) {
+    typedef double (*gpu_time_method)(objc_id obj, objc_sel sel);
+    gpu_time_method method = (gpu_time_method)&objc_msgSend;
+    return (*method)(buffer, sel_getUid("GPUEndTime"));
+}
+
 WEAK void *buffer_contents(mtl_buffer *buffer) {
     return objc_msgSend(buffer, sel_getUid("contents"));
 }
@@ -220,6 +241,75 @@ WEAK module_state *state_list = NULL;
 WEAK bool metal_api_supports_set_bytes;
 WEAK mtl_device *metal_api_checked_device;
 
+// The current batch of kernel dispatches. halide_metal_run encodes
+// into this command buffer instead of committing one buffer per
+// kernel; the commit happens when the batch is synchronized (or grows
+// too large), so a pipeline of many small stages pays for one commit
+// instead of one per stage. Protected by the context lock.
+WEAK mtl_command_buffer *current_command_buffer = NULL;
+WEAK int current_command_buffer_dispatches = 0;
+
+// Cap on the number of dispatches batched into one command buffer, to
+// bound the resources the buffer keeps alive.
+const int max_dispatches_per_command_buffer = 64;
+
+// An opt-in pool of freed MTLBuffer allocations, bucketed by
+// power-of-two size class, mirroring the CUDA runtime's memory pool.
+// Enabled via halide_metal_enable_memory_pool; drained via
+// halide_metal_release_unused_memory.
+struct pool_block {
+    pool_block *next;
+    mtl_buffer *buf;
+};
+
+// Buckets cover sizes from 2^min_pool_bucket_bits up; anything larger
+// bypasses the pool.
+const int min_pool_bucket_bits = 6;
+const int num_pool_buckets = 40;
+pool_block *WEAK pool_buckets[num_pool_buckets];
+volatile int WEAK pool_lock = 0;
+WEAK bool pool_enabled = false;
+
+// Map a size to its bucket, rounding the size up to the bucket's
+// block size. Returns a negative bucket for sizes the pool doesn't
+// handle.
+WEAK int pool_bucket_for_size(size_t *size) {
+    for (int b = 0; b < num_pool_buckets; b++) {
+        size_t block_size = (size_t)1 << (b + min_pool_bucket_bits);
+        if (*size <= block_size) {
+            *size = block_size;
+            return b;
+        }
+    }
+    return -1;
+}
+
+// Release every MTLBuffer held in the pool. Called with the pool lock
+// *not* held.
+WEAK void pool_release_all(void *user_context) {
+    pool_block *blocks = NULL;
+    {
+        ScopedSpinLock spinlock(&pool_lock);
+        for (int b = 0; b < num_pool_buckets; b++) {
+            pool_block *list = pool_buckets[b];
+            while (list != NULL) {
+                pool_block *next = list->next;
+                list->next = blocks;
+                blocks = list;
+                list = next;
+            }
+            pool_buckets[b] = NULL;
+        }
+    }
+    while (blocks != NULL) {
+        pool_block *next = blocks->next;
+        debug(user_context) << "Metal - Releasing pooled buffer " << blocks->buf << "\n";
+        release_ns_object(blocks->buf);
+        free(blocks);
+        blocks = next;
+    }
+}
+
 }}}}
 
 using namespace Halide::Runtime::Internal;
@@ -278,6 +368,26 @@ WEAK int halide_metal_release_context(void *user_context) {
     return 0;
 }
 
+// Enable or disable pooling of freed MTLBuffer allocations. While the
+// pool is enabled, halide_metal_device_free parks buffers on a
+// size-bucketed freelist and halide_metal_device_malloc recycles
+// them, instead of round-tripping every per-frame allocation through
+// the Metal driver. Disabling the pool stops recycling but does not
+// release pooled buffers; use halide_metal_release_unused_memory for
+// that.
+WEAK int halide_metal_enable_memory_pool(void *user_context, int enabled) {
+    pool_enabled = (enabled != 0);
+    return 0;
+}
+
+// Release all MTLBuffers held by the memory pool. Also called
+// automatically if an allocation fails with the pool enabled, and on
+// halide_device_release.
+WEAK int halide_metal_release_unused_memory(void *user_context) {
+    pool_release_all(user_context);
+    return 0;
+}
+
 } // extern "C"
 
 namespace Halide { namespace Runtime { namespace Internal { namespace Metal {
@@ -342,6 +452,19 @@ WEAK command_buffer_completed_handler_block_literal command_buffer_completed_han
     &command_buffer_completed_handler_descriptor
 };
 
+// Commit the current batch of dispatches, if any. Must be called with
+// the context held.
+WEAK void commit_current_command_buffer(void *user_context) {
+    if (current_command_buffer != NULL) {
+        debug(user_context) << "Metal - committing command buffer with "
+                            << current_command_buffer_dispatches << " batched dispatches\n";
+        commit_command_buffer(current_command_buffer);
+        release_ns_object(current_command_buffer);
+        current_command_buffer = NULL;
+        current_command_buffer_dispatches = 0;
+    }
+}
+
 }}}} // namespace Halide::Runtime::Internal::Metal
 
 using namespace Halide::Runtime::Internal::Metal;
@@ -382,11 +505,37 @@ WEAK int halide_metal_device_malloc(void *user_context, halide_buffer_t* buf) {
         return halide_error_code_out_of_memory;
     }
 
-    mtl_buffer *metal_buf = new_buffer(metal_context.device, size);
-    if (metal_buf == 0) {
-        free(handle);
-        error(user_context) << "Metal: Failed to allocate buffer of size " << (int64_t)size << ".\n";
-        return -1;
+    mtl_buffer *metal_buf = NULL;
+    if (pool_enabled) {
+        // Try to recycle a buffer from the pool. Note that
+        // pool_bucket_for_size rounds size up to the block size of
+        // the bucket, so a recycled buffer always fits.
+        int bucket = pool_bucket_for_size(&size);
+        if (bucket >= 0) {
+            ScopedSpinLock spinlock(&pool_lock);
+            pool_block *b = pool_buckets[bucket];
+            if (b != NULL) {
+                pool_buckets[bucket] = b->next;
+                metal_buf = b->buf;
+                free(b);
+            }
+        }
+    }
+    if (metal_buf != NULL) {
+        debug(user_context) << "    recycled pooled buffer " << metal_buf << "\n";
+    } else {
+        metal_buf = new_buffer(metal_context.device, size);
+        if (metal_buf == 0 && pool_enabled) {
+            // The pool may be sitting on the memory we need. Release
+            // it and retry once.
+            pool_release_all(user_context);
+            metal_buf = new_buffer(metal_context.device, size);
+        }
+        if (metal_buf == 0) {
+            free(handle);
+            error(user_context) << "Metal: Failed to allocate buffer of size " << (int64_t)size << ".\n";
+            return -1;
+        }
     }
 
     handle->buf = metal_buf;
@@ -417,8 +566,30 @@ WEAK int halide_metal_device_free(void *user_context, halide_buffer_t* buf) {
 
     device_handle *handle = (device_handle *)buf->device;
     halide_assert(user_context, (((device_handle *)buf->device)->offset == 0) && "halide_metal_device_free on buffer obtained from halide_device_crop");
-    
-    release_ns_object(handle->buf);
+
+    bool pooled = false;
+    if (pool_enabled) {
+        // Park the buffer for reuse instead of releasing it. The
+        // bucket is computed from the same size device_malloc rounded
+        // up, so it gets the block size the allocation actually has.
+        size_t size = buf->size_in_bytes();
+        int bucket = pool_bucket_for_size(&size);
+        if (bucket >= 0) {
+            pool_block *b = (pool_block *)malloc(sizeof(pool_block));
+            if (b != NULL) {
+                b->buf = handle->buf;
+                ScopedSpinLock spinlock(&pool_lock);
+                b->next = pool_buckets[bucket];
+                pool_buckets[bucket] = b;
+                pooled = true;
+            }
+        }
+    }
+    if (pooled) {
+        debug(user_context) << "    pooled buffer " << handle->buf << "\n";
+    } else {
+        release_ns_object(handle->buf);
+    }
     free(handle);
     buf->device = 0;
     buf->device_interface->impl->release_module();
@@ -483,6 +654,11 @@ WEAK int halide_metal_initialize_kernels(void *user_context, void **state_ptr, c
 namespace {
 
 inline void halide_metal_device_sync_internal(mtl_command_queue *queue, struct halide_buffer_t *buffer) {
+    // Commit any batched dispatches first. The queue executes command
+    // buffers in order, so waiting on the sync buffer below waits for
+    // them as well.
+    commit_current_command_buffer(NULL);
+
     mtl_command_buffer *sync_command_buffer = new_command_buffer(queue);
     if (buffer != NULL) {
         mtl_buffer *metal_buffer = ((device_handle *)buffer->device)->buf;
@@ -532,6 +708,9 @@ WEAK int halide_metal_device_release(void *user_context) {
     if (device) {
         halide_metal_device_sync_internal(queue, NULL);
 
+        // Release pooled buffers before the device that owns them.
+        pool_release_all(user_context);
+
         // Unload the modules attached to this device. Note that the list
         // nodes themselves are not freed, only the program objects are
         // released. Subsequent calls to halide_init_kernels might re-create
@@ -584,6 +763,12 @@ WEAK int halide_metal_copy_to_device(void *user_context, halide_buffer_t* buffer
                         << " metal_buffer = " << metal_buffer
                         << " host = " << buffer->host << "\n";
 
+    // If the batch holds dispatches that may read or write this
+    // buffer, they must run before the host overwrites its contents.
+    if (current_command_buffer != NULL) {
+        halide_metal_device_sync_internal(metal_context.queue, buffer);
+    }
+
     copy_memory(c, user_context);
 
     if (is_buffer_managed(metal_buffer)) {
@@ -658,10 +843,37 @@ WEAK int halide_metal_run(void *user_context,
         return metal_context.error;
     }
 
-    mtl_command_buffer *command_buffer = new_command_buffer(metal_context.queue);
-    if (command_buffer == 0) {
-        error(user_context) << "Metal: Could not allocate command buffer.\n";
-        return -1;
+    // When the sampling profiler is running, give this dispatch its
+    // own command buffer and wait for it to complete, so its GPU time
+    // can be read back and billed to the Func that launched it. This
+    // defeats the dispatch batching below, but only while profiling.
+    int profile_func_id = halide_profiler_get_state()->current_func;
+    bool profile_launch = profile_func_id >= 0;
+
+    mtl_command_buffer *command_buffer;
+    if (profile_launch) {
+        // Commit any batched dispatches first so ordering is preserved.
+        commit_current_command_buffer(user_context);
+        command_buffer = new_command_buffer(metal_context.queue);
+        if (command_buffer == 0) {
+            error(user_context) << "Metal: Could not allocate command buffer.\n";
+            return -1;
+        }
+        add_command_buffer_completed_handler(command_buffer, &command_buffer_completed_handler_block);
+    } else {
+        command_buffer = current_command_buffer;
+        if (command_buffer == 0) {
+            command_buffer = new_command_buffer(metal_context.queue);
+            if (command_buffer == 0) {
+                error(user_context) << "Metal: Could not allocate command buffer.\n";
+                return -1;
+            }
+            add_command_buffer_completed_handler(command_buffer, &command_buffer_completed_handler_block);
+            // The batched command buffer must survive the autorelease pool
+            // drained when this call returns.
+            retain_ns_object(command_buffer);
+            current_command_buffer = command_buffer;
+        }
     }
 
     mtl_compute_command_encoder *encoder = new_compute_command_encoder(command_buffer);
@@ -780,9 +992,25 @@ WEAK int halide_metal_run(void *user_context,
                           threadsX, threadsY, threadsZ);
     end_encoding(encoder);
 
-    add_command_buffer_completed_handler(command_buffer, &command_buffer_completed_handler_block);
-
-    commit_command_buffer(command_buffer);
+    if (profile_launch) {
+        commit_command_buffer(command_buffer);
+        wait_until_completed(command_buffer);
+        if (command_buffer_has_gpu_times(command_buffer)) {
+            double t_start = command_buffer_gpu_start_time(command_buffer);
+            double t_end = command_buffer_gpu_end_time(command_buffer);
+            if (t_end > t_start) {
+                halide_profiler_device_time(user_context, profile_func_id,
+                                            (uint64_t)((t_end - t_start) * 1e9));
+            }
+        }
+    } else {
+        // Dispatches are batched into one command buffer; the commit
+        // happens in halide_metal_device_sync (or here, once the batch
+        // grows large enough to be worth bounding).
+        if (++current_command_buffer_dispatches >= max_dispatches_per_command_buffer) {
+            commit_current_command_buffer(user_context);
+        }
+    }
 
     release_ns_object(pipeline_state);
     release_ns_object(function);
@@ -816,20 +1044,18 @@ WEAK int halide_metal_device_and_host_free(void *user_context, struct halide_buf
     return 0;
 }
 
-WEAK int halide_metal_device_crop(void *user_context,
-                                    const struct halide_buffer_t *src,
-                                    struct halide_buffer_t *dst) {
+namespace {
+
+WEAK int metal_device_crop_from_offset(void *user_context,
+                                       const struct halide_buffer_t *src,
+                                       int64_t offset,
+                                       struct halide_buffer_t *dst) {
     MetalContextHolder metal_context(user_context, true);
     if (metal_context.error != 0) {
         return metal_context.error;
     }
 
     dst->device_interface = src->device_interface;
-    int64_t offset = 0;
-    for (int i = 0; i < src->dimensions; i++) {
-        offset += (dst->dim[i].min - src->dim[i].min) * src->dim[i].stride;
-    }
-    offset *= src->type.bytes();
 
     device_handle *new_handle = (device_handle *)malloc(sizeof(device_handle));
     if (new_handle == NULL) {
@@ -845,6 +1071,28 @@ WEAK int halide_metal_device_crop(void *user_context,
     return 0;
 }
 
+}  // namespace
+
+WEAK int halide_metal_device_crop(void *user_context,
+                                    const struct halide_buffer_t *src,
+                                    struct halide_buffer_t *dst) {
+    int64_t offset = 0;
+    for (int i = 0; i < src->dimensions; i++) {
+        offset += (dst->dim[i].min - src->dim[i].min) * src->dim[i].stride;
+    }
+    offset *= src->type.bytes();
+    return metal_device_crop_from_offset(user_context, src, offset, dst);
+}
+
+WEAK int halide_metal_device_slice(void *user_context,
+                                   const struct halide_buffer_t *src,
+                                   int slice_dim, int slice_pos,
+                                   struct halide_buffer_t *dst) {
+    int64_t offset = (slice_pos - src->dim[slice_dim].min) * src->dim[slice_dim].stride;
+    offset *= src->type.bytes();
+    return metal_device_crop_from_offset(user_context, src, offset, dst);
+}
+
 WEAK int halide_metal_device_release_crop(void *user_context,
                                           struct halide_buffer_t *buf) {
     // Basically the same code as in halide_metal_device_free, but with
@@ -948,6 +1196,7 @@ WEAK halide_device_interface_impl_t metal_device_interface_impl = {
     halide_metal_device_and_host_free,
     halide_default_buffer_copy,
     halide_metal_device_crop,
+    halide_metal_device_slice,
     halide_metal_device_release_crop,
     halide_metal_wrap_buffer,
     halide_metal_detach_buffer
@@ -964,6 +1213,7 @@ WEAK halide_device_interface_t metal_device_interface = {
     halide_device_and_host_free,
     halide_buffer_copy,
     halide_device_crop,
+    halide_device_slice,
     halide_device_release_crop,
     halide_device_wrap_native,
     halide_device_detach_native,
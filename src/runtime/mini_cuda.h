@@ -37,6 +37,16 @@ typedef enum CUjit_option_enum {
     CU_JIT_FALLBACK_STRATEGY = 10
 } CUjit_option;
 
+typedef struct CUlinkState_st *CUlinkState;               /**< CUDA linker state */
+
+typedef enum CUjitInputType_enum {
+    CU_JIT_INPUT_CUBIN = 0,
+    CU_JIT_INPUT_PTX = 1,
+    CU_JIT_INPUT_FATBINARY = 2,
+    CU_JIT_INPUT_OBJECT = 3,
+    CU_JIT_INPUT_LIBRARY = 4
+} CUjitInputType;
+
 typedef enum {
     CUDA_SUCCESS                              = 0,
     CUDA_ERROR_INVALID_VALUE                  = 1,
@@ -228,6 +238,13 @@ typedef struct CUDA_MEMCPY3D_st {
 
 #define CU_POINTER_ATTRIBUTE_CONTEXT 1
 
+#define CU_EVENT_DEFAULT 0x0
+
+#define CU_MEMHOSTALLOC_PORTABLE 0x01
+#define CU_MEM_ATTACH_GLOBAL 0x1
+#define CU_MEMHOSTALLOC_DEVICEMAP 0x02
+#define CU_MEMHOSTALLOC_WRITECOMBINED 0x04
+
 }}}}
 
 #endif
@@ -2,6 +2,7 @@
 #include "scoped_spin_lock.h"
 #include "device_buffer_utils.h"
 #include "device_interface.h"
+#include "gpu_kernel_cache.h"
 #include "printer.h"
 
 #include "mini_cl.h"
@@ -216,16 +217,61 @@ struct device_handle {
     cl_mem mem;
 };
 
+// The last value set for one kernel argument, so that redundant
+// clSetKernelArg calls can be skipped across launches. Kernel
+// argument state is sticky on the cl_kernel object, and all of our
+// argument values fit in eight bytes (scalars and cl_mem handles), so
+// if the bytes match what was set last time the call would be a
+// no-op. Oversized arguments get size set to -1 and are always
+// re-set.
+struct kernel_arg_record {
+    size_t size;
+    uint64_t value;
+};
+
+// A cached cl_kernel for one entry point of a module. Creating the
+// kernel and re-setting every argument per launch costs more than the
+// kernel itself for small stages on some drivers, so kernels live
+// here from first launch until halide_device_release. Access is
+// serialized by the context lock that halide_opencl_run already
+// holds.
+struct kernel_cache_entry {
+    kernel_cache_entry *next;
+    cl_kernel kernel;
+    char *entry_name;
+    // One record per argument, allocated on first launch; NULL until
+    // then. The trailing shared memory argument is tracked
+    // separately.
+    kernel_arg_record *args;
+    int num_args;
+    size_t shared_mem_bytes;
+};
+
 // Structure to hold the state of a module attached to the context.
 // Also used as a linked-list to keep track of all the different
 // modules that are attached to a context in order to release them all
 // when then context is released.
 struct module_state {
     cl_program program;
+    kernel_cache_entry *kernels;
     module_state *next;
 };
 WEAK module_state *state_list = NULL;
 
+// Release all kernels cached for a module. Called with the context
+// lock held, before the program they belong to is released.
+WEAK void release_kernel_cache(void *user_context, module_state *state) {
+    while (state->kernels) {
+        kernel_cache_entry *entry = state->kernels;
+        state->kernels = entry->next;
+        debug(user_context) << "    clReleaseKernel " << (void *)entry->kernel << "\n";
+        clReleaseKernel(entry->kernel);
+        free(entry->entry_name);
+        free(entry->args);
+        free(entry);
+    }
+}
+
 WEAK bool validate_device_pointer(void *user_context, halide_buffer_t* buf, size_t size=0) {
     if (buf->device == 0) {
         return true;
@@ -456,7 +502,11 @@ WEAK int create_opencl_context(void *user_context, cl_context *ctx, cl_command_q
     }
 
     debug(user_context) << "    clCreateCommandQueue ";
-    *q = clCreateCommandQueue(*ctx, dev, 0, &err);
+    // Profiling is enabled on the queue so that kernel launches can be
+    // timed with events when the Halide profiler is running. The
+    // property just makes the driver timestamp commands; it does not
+    // serialize them.
+    *q = clCreateCommandQueue(*ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
     if (err != CL_SUCCESS) {
         debug(user_context) << get_opencl_error_name(err);
         error(user_context) << "CL: clCreateCommandQueue failed: "
@@ -545,6 +595,7 @@ WEAK int halide_opencl_initialize_kernels(void *user_context, void **state_ptr,
     if (!(*state)) {
         *state = (module_state*)malloc(sizeof(module_state));
         (*state)->program = NULL;
+        (*state)->kernels = NULL;
         (*state)->next = state_list;
         state_list = *state;
     }
@@ -587,41 +638,119 @@ WEAK int halide_opencl_initialize_kernels(void *user_context, void **state_ptr,
         options << "-D MAX_CONSTANT_BUFFER_SIZE=" << max_constant_buffer_size
                 << " -D MAX_CONSTANT_ARGS=" << max_constant_args;
 
-        const char * sources[] = { src };
-        debug(user_context) << "    clCreateProgramWithSource -> ";
-        cl_program program = clCreateProgramWithSource(ctx.context, 1, &sources[0], NULL, &err );
-        if (err != CL_SUCCESS) {
-            debug(user_context) << get_opencl_error_name(err) << "\n";
-            error(user_context) << "CL: clCreateProgramWithSource failed: "
-                                << get_opencl_error_name(err);
-            return err;
-        } else {
-            debug(user_context) << (void *)program << "\n";
+        // If the on-disk kernel binary cache is enabled, compute the
+        // cache entry path. The key covers everything that can affect
+        // the compiled binary: the source, the build options, the
+        // device, and the driver version.
+        stringstream cache_path(user_context);
+        bool cache_enabled = false;
+        if (const char *cache_dir = kernel_cache_dir()) {
+            char device_name[256];
+            char driver_version[256];
+            if (clGetDeviceInfo(dev, CL_DEVICE_NAME, sizeof(device_name), device_name, NULL) == CL_SUCCESS &&
+                clGetDeviceInfo(dev, CL_DRIVER_VERSION, sizeof(driver_version), driver_version, NULL) == CL_SUCCESS) {
+                uint64_t key = kernel_cache_hash_seed;
+                key = kernel_cache_hash(key, src, size);
+                key = kernel_cache_hash(key, options.str(), strlen(options.str()));
+                key = kernel_cache_hash(key, device_name, strlen(device_name));
+                key = kernel_cache_hash(key, driver_version, strlen(driver_version));
+                cache_path << cache_dir << "/halide_opencl_" << key << ".bin";
+                cache_enabled = true;
+            }
         }
-        (*state)->program = program;
 
-        debug(user_context) << "    clBuildProgram " << (void *)program
-                            << " " << options.str() << "\n";
-        err = clBuildProgram(program, 1, devices, options.str(), NULL, NULL );
-        if (err != CL_SUCCESS) {
+        cl_program program = NULL;
+        if (cache_enabled) {
+            size_t binary_size = 0;
+            void *binary = kernel_cache_load(user_context, cache_path.str(), &binary_size);
+            if (binary) {
+                const unsigned char *binaries[] = { (const unsigned char *)binary };
+                cl_int binary_status = CL_SUCCESS;
+                debug(user_context) << "    clCreateProgramWithBinary -> ";
+                program = clCreateProgramWithBinary(ctx.context, 1, devices, &binary_size,
+                                                    binaries, &binary_status, &err);
+                if (err != CL_SUCCESS || binary_status != CL_SUCCESS) {
+                    debug(user_context) << get_opencl_error_name(err) << "\n";
+                    program = NULL;
+                } else {
+                    debug(user_context) << (void *)program << "\n";
+                    // Binaries still need a (cheap) clBuildProgram call.
+                    err = clBuildProgram(program, 1, devices, options.str(), NULL, NULL);
+                    if (err != CL_SUCCESS) {
+                        clReleaseProgram(program);
+                        program = NULL;
+                    }
+                }
+                free(binary);
+                if (!program) {
+                    // A stale or incompatible cache entry: fall back
+                    // to compiling from source below, which will
+                    // overwrite the entry.
+                    debug(user_context) << "    cached kernel binary rejected by driver; recompiling\n";
+                }
+            }
+        }
+        bool from_cache = program != NULL;
 
-            // Allocate an appropriately sized buffer for the build log.
-            char buffer[8192];
-
-            // Get build log
-            if (clGetProgramBuildInfo(program, dev,
-                                      CL_PROGRAM_BUILD_LOG,
-                                      sizeof(buffer), buffer,
-                                      NULL) == CL_SUCCESS) {
-                error(user_context) << "CL: clBuildProgram failed: "
-                                    << get_opencl_error_name(err)
-                                    << "\nBuild Log:\n"
-                                    << buffer << "\n";
+        if (!program) {
+            const char * sources[] = { src };
+            debug(user_context) << "    clCreateProgramWithSource -> ";
+            program = clCreateProgramWithSource(ctx.context, 1, &sources[0], NULL, &err );
+            if (err != CL_SUCCESS) {
+                debug(user_context) << get_opencl_error_name(err) << "\n";
+                error(user_context) << "CL: clCreateProgramWithSource failed: "
+                                    << get_opencl_error_name(err);
+                return err;
             } else {
-                error(user_context) << "clGetProgramBuildInfo failed";
+                debug(user_context) << (void *)program << "\n";
             }
+            // Track the program before building it, so that it is
+            // released at halide_release even if the build fails.
+            (*state)->program = program;
 
-            return err;
+            debug(user_context) << "    clBuildProgram " << (void *)program
+                                << " " << options.str() << "\n";
+            err = clBuildProgram(program, 1, devices, options.str(), NULL, NULL );
+            if (err != CL_SUCCESS) {
+
+                // Allocate an appropriately sized buffer for the build log.
+                char buffer[8192];
+
+                // Get build log
+                if (clGetProgramBuildInfo(program, dev,
+                                          CL_PROGRAM_BUILD_LOG,
+                                          sizeof(buffer), buffer,
+                                          NULL) == CL_SUCCESS) {
+                    error(user_context) << "CL: clBuildProgram failed: "
+                                        << get_opencl_error_name(err)
+                                        << "\nBuild Log:\n"
+                                        << buffer << "\n";
+                } else {
+                    error(user_context) << "clGetProgramBuildInfo failed";
+                }
+
+                return err;
+            }
+        }
+        (*state)->program = program;
+
+        if (cache_enabled && !from_cache) {
+            // Save the freshly compiled binary for the next process.
+            size_t binary_size = 0;
+            err = clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES,
+                                   sizeof(binary_size), &binary_size, NULL);
+            if (err == CL_SUCCESS && binary_size > 0) {
+                void *binary = malloc(binary_size);
+                if (binary) {
+                    unsigned char *binaries[] = { (unsigned char *)binary };
+                    err = clGetProgramInfo(program, CL_PROGRAM_BINARIES,
+                                           sizeof(binaries), binaries, NULL);
+                    if (err == CL_SUCCESS) {
+                        kernel_cache_store(user_context, cache_path.str(), binary, binary_size);
+                    }
+                    free(binary);
+                }
+            }
         }
     }
 
@@ -685,6 +814,7 @@ WEAK int halide_opencl_device_release(void *user_context) {
         module_state *state = state_list;
         while (state) {
             if (state->program) {
+                release_kernel_cache(user_context, state);
                 debug(user_context) << "    clReleaseProgram " << state->program << "\n";
                 err = clReleaseProgram(state->program);
                 halide_assert(user_context, err == CL_SUCCESS);
@@ -936,23 +1066,60 @@ WEAK int halide_opencl_run(void *user_context,
     uint64_t t_before = halide_current_time_ns(user_context);
     #endif
 
-    // Create kernel object for entry_name from the program for this module.
+    // Look up a cached kernel object for entry_name, creating one
+    // from the program for this module on the first launch. We hold
+    // the context lock, so the cache needs no further
+    // synchronization.
     halide_assert(user_context, state_ptr);
-    cl_program program = ((module_state*)state_ptr)->program;
+    module_state *state = (module_state*)state_ptr;
 
-    halide_assert(user_context, program);
-    debug(user_context) << "    clCreateKernel " << entry_name << " -> ";
-    cl_kernel f = clCreateKernel(program, entry_name, &err);
-    if (err != CL_SUCCESS) {
-        debug(user_context) << get_opencl_error_name(err) << "\n";
-        error(user_context) << "CL: clCreateKernel " << entry_name << " failed: "
-                            << get_opencl_error_name(err) << "\n";
-        return err;
+    kernel_cache_entry *cache = state->kernels;
+    while (cache && strcmp(cache->entry_name, entry_name) != 0) {
+        cache = cache->next;
+    }
+
+    cl_kernel f;
+    if (cache) {
+        f = cache->kernel;
+        debug(user_context) << "    cached kernel " << (void *)f << " for " << entry_name << "\n";
     } else {
-        #ifdef DEBUG_RUNTIME
-        uint64_t t_create_kernel = halide_current_time_ns(user_context);
-        debug(user_context) << "    Time: " << (t_create_kernel - t_before) / 1.0e6 << " ms\n";
-        #endif
+        cl_program program = state->program;
+        halide_assert(user_context, program);
+        debug(user_context) << "    clCreateKernel " << entry_name << " -> ";
+        f = clCreateKernel(program, entry_name, &err);
+        if (err != CL_SUCCESS) {
+            debug(user_context) << get_opencl_error_name(err) << "\n";
+            error(user_context) << "CL: clCreateKernel " << entry_name << " failed: "
+                                << get_opencl_error_name(err) << "\n";
+            return err;
+        } else {
+            #ifdef DEBUG_RUNTIME
+            uint64_t t_create_kernel = halide_current_time_ns(user_context);
+            debug(user_context) << "    Time: " << (t_create_kernel - t_before) / 1.0e6 << " ms\n";
+            #endif
+        }
+
+        // Cache it for subsequent launches. If any allocation fails
+        // we just run uncached and release the kernel at the end.
+        cache = (kernel_cache_entry *)malloc(sizeof(kernel_cache_entry));
+        if (cache) {
+            size_t name_len = strlen(entry_name) + 1;
+            cache->entry_name = (char *)malloc(name_len);
+            if (cache->entry_name) {
+                memcpy(cache->entry_name, entry_name, name_len);
+                cache->kernel = f;
+                cache->args = NULL;
+                cache->num_args = 0;
+                // Doesn't match any real size, so the shared memory
+                // argument gets set on the first launch.
+                cache->shared_mem_bytes = (size_t)-1;
+                cache->next = state->kernels;
+                state->kernels = cache;
+            } else {
+                free(cache);
+                cache = NULL;
+            }
+        }
     }
 
     // Pack dims
@@ -962,7 +1129,8 @@ WEAK int halide_opencl_run(void *user_context,
     // Set args
     int i = 0;
 
-    // Count sub buffers needed for crops.
+    // Count sub buffers needed for crops, and the total number of
+    // arguments.
     int sub_buffers_needed = 0;
     while (arg_sizes[i] != 0) {
         if (arg_is_buffer[i] &&
@@ -971,6 +1139,22 @@ WEAK int halide_opencl_run(void *user_context,
         }
         i += 1;
     }
+    int num_args = i;
+
+    // On the first launch of a cached kernel, make room to remember
+    // the arguments we set.
+    if (cache && !cache->args && num_args > 0) {
+        cache->args = (kernel_arg_record *)malloc(sizeof(kernel_arg_record) * num_args);
+        if (cache->args) {
+            cache->num_args = num_args;
+            for (int j = 0; j < num_args; j++) {
+                // Doesn't match any real size, so every argument gets
+                // set this launch.
+                cache->args[j].size = (size_t)-1;
+                cache->args[j].value = 0;
+            }
+        }
+    }
     cl_mem *sub_buffers = NULL;
     int sub_buffers_saved = 0;
     if (sub_buffers_needed > 0) {
@@ -990,9 +1174,15 @@ WEAK int halide_opencl_run(void *user_context,
         void *this_arg = args[i];
         cl_int err = CL_SUCCESS;
 
+        // The bytes to hand to clSetKernelArg. For buffers this is
+        // the resolved cl_mem handle rather than the halide_buffer_t.
+        const void *arg_bytes = this_arg;
+        size_t arg_size = arg_sizes[i];
+
+        cl_mem mem;
         if (arg_is_buffer[i]) {
             halide_assert(user_context, arg_sizes[i] == sizeof(uint64_t));
-            cl_mem mem = ((device_handle *)((halide_buffer_t *)this_arg)->device)->mem;
+            mem = ((device_handle *)((halide_buffer_t *)this_arg)->device)->mem;
             uint64_t offset = ((device_handle *)((halide_buffer_t *)this_arg)->device)->offset;
 
             if (offset != 0) {
@@ -1004,10 +1194,34 @@ WEAK int halide_opencl_run(void *user_context,
             }
             if (err == CL_SUCCESS) {
                 debug(user_context) << "Mapped dev handle is: " << (void *)mem << "\n";
-                err = clSetKernelArg(f, i, sizeof(mem), &mem);
+                arg_bytes = &mem;
+                arg_size = sizeof(mem);
+            }
+        }
+
+        if (err == CL_SUCCESS) {
+            // Skip the call if the argument still holds the same
+            // bytes as last launch. Kernel argument state is sticky,
+            // and the value a kernel stores for an argument is
+            // exactly these bytes, so byte equality means the call
+            // would be a no-op even if e.g. a cl_mem handle value has
+            // been recycled for a new buffer in the meantime.
+            kernel_arg_record *record = NULL;
+            if (cache && cache->args && i < cache->num_args && arg_size <= sizeof(record->value)) {
+                record = &cache->args[i];
+            }
+            if (record &&
+                record->size == arg_size &&
+                memcmp(&record->value, arg_bytes, arg_size) == 0) {
+                debug(user_context) << "        unchanged, skipped\n";
+            } else {
+                err = clSetKernelArg(f, i, arg_size, arg_bytes);
+                if (record && err == CL_SUCCESS) {
+                    record->size = arg_size;
+                    record->value = 0;
+                    memcpy(&record->value, arg_bytes, arg_size);
+                }
             }
-        } else {
-            err = clSetKernelArg(f, i, arg_sizes[i], this_arg);
         }
 
         if (err != CL_SUCCESS) {
@@ -1023,13 +1237,21 @@ WEAK int halide_opencl_run(void *user_context,
     }
     // Set the shared mem buffer last
     // Always set at least 1 byte of shmem, to keep the launch happy
+    size_t shared_mem_size = (shared_mem_bytes > 0) ? shared_mem_bytes : 1;
     debug(user_context)
         << "    clSetKernelArg " << i << " " << shared_mem_bytes << " [NULL]\n";
-    err = clSetKernelArg(f, i, (shared_mem_bytes > 0) ? shared_mem_bytes : 1, NULL);
-    if (err != CL_SUCCESS) {
-        error(user_context) << "CL: clSetKernelArg failed "
-                            << get_opencl_error_name(err);
-        return err;
+    if (cache && cache->shared_mem_bytes == shared_mem_size) {
+        debug(user_context) << "        unchanged, skipped\n";
+    } else {
+        err = clSetKernelArg(f, i, shared_mem_size, NULL);
+        if (err != CL_SUCCESS) {
+            error(user_context) << "CL: clSetKernelArg failed "
+                                << get_opencl_error_name(err);
+            return err;
+        }
+        if (cache) {
+            cache->shared_mem_bytes = shared_mem_size;
+        }
     }
 
     // Launch kernel
@@ -1037,13 +1259,37 @@ WEAK int halide_opencl_run(void *user_context,
         << "    clEnqueueNDRangeKernel "
         << blocksX << "x" << blocksY << "x" << blocksZ << ", "
         << threadsX << "x" << threadsY << "x" << threadsZ << " -> ";
+    // When the sampling profiler is running, request an event for the
+    // launch so the kernel's device time can be read back with
+    // clGetEventProfilingInfo and billed to the Func that launched
+    // it. Waiting on the event synchronizes with the kernel, so this
+    // only happens while profiling.
+    int profile_func_id = halide_profiler_get_state()->current_func;
+    bool profile_launch = profile_func_id >= 0;
+    cl_event launch_event = NULL;
+
     err = clEnqueueNDRangeKernel(ctx.cmd_queue, f,
                                  // NDRange
                                  3, NULL, global_dim, local_dim,
                                  // Events
-                                 0, NULL, NULL);
+                                 0, NULL, profile_launch ? &launch_event : NULL);
     debug(user_context) << get_opencl_error_name(err) << "\n";
 
+    if (launch_event != NULL) {
+        if (err == CL_SUCCESS && clWaitForEvents(1, &launch_event) == CL_SUCCESS) {
+            cl_ulong t_start = 0, t_end = 0;
+            if (clGetEventProfilingInfo(launch_event, CL_PROFILING_COMMAND_START,
+                                        sizeof(t_start), &t_start, NULL) == CL_SUCCESS &&
+                clGetEventProfilingInfo(launch_event, CL_PROFILING_COMMAND_END,
+                                        sizeof(t_end), &t_end, NULL) == CL_SUCCESS &&
+                t_end > t_start) {
+                // The timestamps are already in nanoseconds.
+                halide_profiler_device_time(user_context, profile_func_id, t_end - t_start);
+            }
+        }
+        clReleaseEvent(launch_event);
+    }
+
     // Now that the kernel is enqueued, OpenCL is holding its own
     // references to sub buffers and the local ones can be released.
     for (int sub_buf_index = 0; sub_buf_index < sub_buffers_saved; sub_buf_index++) {
@@ -1057,9 +1303,12 @@ WEAK int halide_opencl_run(void *user_context,
         return err;
     }
 
-    debug(user_context) << "    Releasing kernel " << (void *)f << "\n";
-    clReleaseKernel(f);
-    debug(user_context) << "    clReleaseKernel finished" << (void *)f << "\n";
+    if (!cache) {
+        // We failed to cache the kernel, so it dies with this launch.
+        debug(user_context) << "    Releasing kernel " << (void *)f << "\n";
+        clReleaseKernel(f);
+        debug(user_context) << "    clReleaseKernel finished" << (void *)f << "\n";
+    }
 
     #ifdef DEBUG_RUNTIME
     err = clFinish(ctx.cmd_queue);
@@ -1135,20 +1384,18 @@ WEAK uint64_t halide_opencl_get_crop_offset(void *user_context, halide_buffer_t
     return ((device_handle *)buf->device)->offset;
 }
 
-WEAK int halide_opencl_device_crop(void *user_context,
-                                    const struct halide_buffer_t *src,
-                                    struct halide_buffer_t *dst) {
+namespace {
+
+WEAK int opencl_device_crop_from_offset(void *user_context,
+                                        const struct halide_buffer_t *src,
+                                        int64_t offset,
+                                        struct halide_buffer_t *dst) {
     ClContext ctx(user_context);
     if (ctx.error != CL_SUCCESS) {
         return ctx.error;
     }
 
     dst->device_interface = src->device_interface;
-    int64_t offset = 0;
-    for (int i = 0; i < src->dimensions; i++) {
-        offset += (dst->dim[i].min - src->dim[i].min) * src->dim[i].stride;
-    }
-    offset *= src->type.bytes();
     device_handle *new_dev_handle = (device_handle *)malloc(sizeof(device_handle));
     if (new_dev_handle == NULL) {
         error(user_context) << "CL: malloc failed making device handle for crop.\n";
@@ -1163,6 +1410,28 @@ WEAK int halide_opencl_device_crop(void *user_context,
     return 0;
 }
 
+}  // namespace
+
+WEAK int halide_opencl_device_crop(void *user_context,
+                                    const struct halide_buffer_t *src,
+                                    struct halide_buffer_t *dst) {
+    int64_t offset = 0;
+    for (int i = 0; i < src->dimensions; i++) {
+        offset += (dst->dim[i].min - src->dim[i].min) * src->dim[i].stride;
+    }
+    offset *= src->type.bytes();
+    return opencl_device_crop_from_offset(user_context, src, offset, dst);
+}
+
+WEAK int halide_opencl_device_slice(void *user_context,
+                                    const struct halide_buffer_t *src,
+                                    int slice_dim, int slice_pos,
+                                    struct halide_buffer_t *dst) {
+    int64_t offset = (slice_pos - src->dim[slice_dim].min) * src->dim[slice_dim].stride;
+    offset *= src->type.bytes();
+    return opencl_device_crop_from_offset(user_context, src, offset, dst);
+}
+
 WEAK int halide_opencl_device_release_crop(void *user_context,
                                             struct halide_buffer_t *buf) {
     // Basically the same code as in halide_opencl_device_free, but with
@@ -1294,6 +1563,7 @@ WEAK halide_device_interface_impl_t opencl_device_interface_impl = {
     halide_opencl_device_and_host_free,
     halide_opencl_buffer_copy,
     halide_opencl_device_crop,
+    halide_opencl_device_slice,
     halide_opencl_device_release_crop,
     halide_opencl_wrap_cl_mem,
     halide_opencl_detach_cl_mem,
@@ -1310,6 +1580,7 @@ WEAK halide_device_interface_t opencl_device_interface = {
     halide_device_and_host_free,
     halide_buffer_copy,
     halide_device_crop,
+    halide_device_slice,
     halide_device_release_crop,
     halide_device_wrap_native,
     halide_device_detach_native,
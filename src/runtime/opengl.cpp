@@ -310,6 +310,41 @@ WEAK void GLStateSaver::restore()
 // A list of module-specific state. Each module corresponds to a single Halide filter
 WEAK ModuleState *state_list;
 
+// An opt-in pool of textures released by halide_opengl_device_free,
+// keyed by exact size and internal format, mirroring the device
+// allocation pools in the CUDA and Metal runtimes. Creating and
+// destroying a texture per realization stalls the GPU pipeline on many
+// drivers (especially mobile GLES), so steady-state per-frame
+// allocations can be recycled instead. Disabled by default; see
+// halide_opengl_enable_memory_pool. No lock is needed: every entry
+// point of this backend must already be called from the thread that
+// owns the GL context.
+struct TexturePoolEntry {
+    TexturePoolEntry *next;
+    GLuint tex;
+    GLint width, height;
+    GLint internal_format;
+};
+WEAK TexturePoolEntry *texture_pool = NULL;
+WEAK bool texture_pool_enabled = false;
+
+// Drop every texture held in the pool. If the GL context is still
+// alive the textures are deleted; after a context loss the names are
+// already invalid and only the host-side entries are freed.
+WEAK void texture_pool_release_all(void *user_context, bool context_valid) {
+    TexturePoolEntry *entry = texture_pool;
+    texture_pool = NULL;
+    while (entry) {
+        TexturePoolEntry *next = entry->next;
+        if (context_valid) {
+            debug(user_context) << "Deleting pooled texture " << entry->tex << "\n";
+            global_state.DeleteTextures(1, &entry->tex);
+        }
+        free(entry);
+        entry = next;
+    }
+}
+
 WEAK const char *kernel_marker = "/// KERNEL ";
 WEAK const char *input_marker  = "/// IN_BUFFER ";
 WEAK const char *output_marker = "/// OUT_BUFFER ";
@@ -740,6 +775,7 @@ WEAK int halide_opengl_device_release(void *user_context) {
     }
 
     debug(user_context) << "halide_opengl_release\n";
+    texture_pool_release_all(user_context, true);
     global_state.DeleteFramebuffers(1, &global_state.framebuffer_id);
 
     ModuleState *mod = state_list;
@@ -916,29 +952,9 @@ WEAK int halide_opengl_device_malloc(void *user_context, halide_buffer_t *buf) {
             return 1;
         }
 
-        // Generate texture ID
-        global_state.GenTextures(1, &tex);
-        if (global_state.CheckAndReportError(user_context, "halide_opengl_device_malloc GenTextures")) {
-            global_state.DeleteTextures(1, &tex);
-            return 1;
-        }
-
-        // Set parameters for this texture: no interpolation and clamp to edges.
-        global_state.BindTexture(GL_TEXTURE_2D, tex);
-        global_state.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        global_state.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        global_state.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        global_state.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        if (global_state.CheckAndReportError(user_context, "halide_opengl_device_malloc binding texture")) {
-            global_state.DeleteTextures(1, &tex);
-            return 1;
-        }
-
-        // Create empty texture here and fill it with glTexSubImage2D later.
         GLint internal_format, format, type;
         if (!get_texture_format(user_context, buf, &internal_format, &format, &type)) {
             error(user_context) << "Invalid texture format";
-            global_state.DeleteTextures(1, &tex);
             return 1;
         }
 
@@ -948,20 +964,61 @@ WEAK int halide_opengl_device_malloc(void *user_context, halide_buffer_t *buf) {
             return 1;
         }
 
-        global_state.TexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, NULL);
-        if (global_state.CheckAndReportError(user_context, "halide_opengl_device_malloc TexImage2D")) {
-            global_state.DeleteTextures(1, &tex);
-            return 1;
+        // Try to recycle a pooled texture of identical size and format
+        // before asking the driver for a new one.
+        if (texture_pool_enabled) {
+            TexturePoolEntry **prev = &texture_pool;
+            while (*prev) {
+                TexturePoolEntry *entry = *prev;
+                if (entry->width == width && entry->height == height &&
+                    entry->internal_format == internal_format) {
+                    tex = entry->tex;
+                    *prev = entry->next;
+                    free(entry);
+                    debug(user_context) << "Reusing pooled texture " << tex
+                                        << " of size " << width << " x " << height << "\n";
+                    break;
+                }
+                prev = &entry->next;
+            }
+        }
+
+        if (tex == 0) {
+            // Generate texture ID
+            global_state.GenTextures(1, &tex);
+            if (global_state.CheckAndReportError(user_context, "halide_opengl_device_malloc GenTextures")) {
+                global_state.DeleteTextures(1, &tex);
+                return 1;
+            }
+
+            // Set parameters for this texture: no interpolation and clamp to edges.
+            global_state.BindTexture(GL_TEXTURE_2D, tex);
+            global_state.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            global_state.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            global_state.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            global_state.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            if (global_state.CheckAndReportError(user_context, "halide_opengl_device_malloc binding texture")) {
+                global_state.DeleteTextures(1, &tex);
+                return 1;
+            }
+
+            // Create empty texture here and fill it with glTexSubImage2D later.
+            global_state.TexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, NULL);
+            if (global_state.CheckAndReportError(user_context, "halide_opengl_device_malloc TexImage2D")) {
+                global_state.DeleteTextures(1, &tex);
+                return 1;
+            }
+
+            debug(user_context) << "Allocated texture " << tex
+                                << " of size " << width << " x " << height << "\n";
+
+            global_state.BindTexture(GL_TEXTURE_2D, 0);
         }
 
         buf->device = tex;
         buf->device_interface = &opengl_device_interface;
         buf->device_interface->impl->use_module();
         halide_allocated = true;
-        debug(user_context) << "Allocated texture " << tex
-                            << " of size " << width << " x " << height << "\n";
-
-        global_state.BindTexture(GL_TEXTURE_2D, 0);
     }
 
     return 0;
@@ -982,12 +1039,40 @@ WEAK int halide_opengl_device_free(void *user_context, halide_buffer_t *buf) {
     GLuint tex = (handle == HALIDE_OPENGL_RENDER_TARGET) ? 0 : (GLuint)handle;
 
     int result = 0;
-    debug(user_context) << "halide_opengl_device_free: Deleting texture " << tex << "\n";
-    global_state.DeleteTextures(1, &tex);
-    if (global_state.CheckAndReportError(user_context, "halide_opengl_device_free DeleteTextures")) {
-        result = 1;
-        // do not return: we want to zero out the interface and
-        // device fields even if we can't delete the texture.
+
+    // If pooling is enabled, retain the texture for reuse by a later
+    // allocation of the same size and format instead of deleting it.
+    // Wrapped render targets (tex == 0) are never pooled, and if the
+    // size or format of the texture can't be recovered from the buffer
+    // we fall back to deleting it.
+    bool pooled = false;
+    if (texture_pool_enabled && tex != 0) {
+        GLint internal_format, format, type;
+        GLint width, height, channels;
+        if (get_texture_format(user_context, buf, &internal_format, &format, &type) &&
+            get_texture_dimensions(user_context, buf, &width, &height, &channels)) {
+            TexturePoolEntry *entry = (TexturePoolEntry *)malloc(sizeof(TexturePoolEntry));
+            if (entry) {
+                debug(user_context) << "halide_opengl_device_free: Pooling texture " << tex << "\n";
+                entry->tex = tex;
+                entry->width = width;
+                entry->height = height;
+                entry->internal_format = internal_format;
+                entry->next = texture_pool;
+                texture_pool = entry;
+                pooled = true;
+            }
+        }
+    }
+
+    if (!pooled) {
+        debug(user_context) << "halide_opengl_device_free: Deleting texture " << tex << "\n";
+        global_state.DeleteTextures(1, &tex);
+        if (global_state.CheckAndReportError(user_context, "halide_opengl_device_free DeleteTextures")) {
+            result = 1;
+            // do not return: we want to zero out the interface and
+            // device fields even if we can't delete the texture.
+        }
     }
     buf->device = 0;
     buf->device_interface->impl->release_module();
@@ -1313,6 +1398,25 @@ WEAK ModuleState* find_module(const char *stage_name) {
     return NULL;
 }
 
+// Find the module state for an already-parsed kernel by the name on
+// its "/// KERNEL" marker line, or NULL if this kernel has not been
+// compiled before.
+WEAK ModuleState* find_module_for_source(const char *src, int size) {
+    const char *name_start = match_prefix(src, kernel_marker);
+    if (!name_start) {
+        return NULL;
+    }
+    const char *name_end = name_start;
+    while (name_end < src + size && *name_end != '\n') {
+        name_end++;
+    }
+    char *name = strstrip(strndup(name_start, name_end - name_start),
+                          name_end - name_start);
+    ModuleState *mod = find_module(name);
+    free(name);
+    return mod;
+}
+
 //  Create wrappers that satisfy old naming conventions
 
 extern "C" {
@@ -1832,12 +1936,27 @@ WEAK int halide_opengl_initialize_kernels(void *user_context, void **state_ptr,
             len = next_kernel - this_kernel;
         }
 
-        // Construct a new ModuleState and add it to the global list
-        module = (ModuleState *)malloc(sizeof(ModuleState));
-        module->kernel = NULL;
-        module->next = state_list;
-        state_list = module;
-        *state = module;
+        // If this kernel was compiled before, recycle its state rather
+        // than parsing and compiling it again. After a context rebuild
+        // (halide_opengl_context_lost) the parsed kernel survives with
+        // its program_id reset to zero, so only the GL program needs to
+        // be recreated.
+        module = find_module_for_source(this_kernel, len);
+        if (module) {
+            *state = module;
+            if (module->kernel->program_id != 0) {
+                // The program from the previous compilation is still valid.
+                this_kernel = next_kernel;
+                continue;
+            }
+        } else {
+            // Construct a new ModuleState and add it to the global list
+            module = (ModuleState *)malloc(sizeof(ModuleState));
+            module->kernel = NULL;
+            module->next = state_list;
+            state_list = module;
+            *state = module;
+        }
 
         KernelInfo *kernel = module->kernel;
         if (!kernel) {
@@ -1965,10 +2084,32 @@ WEAK void halide_opengl_context_lost(void *user_context) {
         mod->kernel->program_id = 0;
     }
 
+    // The texture names in the pool died with the context; just drop
+    // the entries.
+    texture_pool_release_all(user_context, false);
+
     global_state.init();
     return;
 }
 
+// Enable or disable the pool of freed textures. While enabled,
+// halide_opengl_device_free returns Halide-allocated textures to a
+// freelist instead of calling glDeleteTextures, and
+// halide_opengl_device_malloc recycles a pooled texture whenever one
+// of identical size and format is available. Disabling the pool stops
+// recycling but does not delete pooled textures; use
+// halide_opengl_release_unused_memory for that.
+WEAK int halide_opengl_enable_memory_pool(void *user_context, int enabled) {
+    texture_pool_enabled = (enabled != 0);
+    return 0;
+}
+
+// Delete all textures held in the pool.
+WEAK int halide_opengl_release_unused_memory(void *user_context) {
+    texture_pool_release_all(user_context, global_state.initialized);
+    return 0;
+}
+
 WEAK int halide_opengl_wrap_texture(void *user_context, halide_buffer_t *buf, uint64_t texture_id) {
     if (!global_state.initialized) {
         if (int error = halide_opengl_init(user_context)) {
@@ -2052,6 +2193,7 @@ WEAK halide_device_interface_impl_t opengl_device_interface_impl = {
     halide_opengl_device_and_host_free,
     halide_default_buffer_copy,
     halide_default_device_crop,
+    halide_default_device_slice,
     halide_default_device_release_crop,
     halide_opengl_wrap_texture,
     halide_opengl_detach_texture
@@ -2068,6 +2210,7 @@ WEAK halide_device_interface_t opengl_device_interface = {
     halide_device_and_host_free,
     halide_buffer_copy,
     halide_device_crop,
+    halide_device_slice,
     halide_device_release_crop,
     halide_device_wrap_native,
     halide_device_detach_native,
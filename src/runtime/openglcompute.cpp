@@ -123,6 +123,59 @@ WEAK GlobalState global_state;
 // A list of module-specific state. Each module corresponds to a single Halide filter
 WEAK ModuleState *state_list;
 
+// An opt-in pool of freed SSBOs, bucketed by power-of-two size,
+// mirroring the device allocation pools in the CUDA and Metal
+// runtimes. Allocating and deleting a buffer object per realization
+// stalls the GPU pipeline on many GLES drivers, so steady-state
+// per-frame allocations can be recycled instead. Disabled by default;
+// see halide_openglcompute_enable_memory_pool. No lock is needed:
+// every entry point of this backend must already be called from the
+// thread that owns the GL context.
+struct PoolEntry {
+    PoolEntry *next;
+    GLuint the_buffer;
+};
+
+// Buckets cover sizes from 2^min_pool_bucket_bits up; anything larger
+// bypasses the pool.
+const int min_pool_bucket_bits = 6;
+const int num_pool_buckets = 40;
+PoolEntry *WEAK pool_buckets[num_pool_buckets];
+WEAK bool pool_enabled = false;
+
+// Map a size to its bucket, rounding the size up to the bucket's
+// block size. Returns a negative bucket for sizes the pool doesn't
+// handle.
+WEAK int pool_bucket_for_size(size_t *size) {
+    for (int b = 0; b < num_pool_buckets; b++) {
+        size_t block_size = (size_t)1 << (b + min_pool_bucket_bits);
+        if (*size <= block_size) {
+            *size = block_size;
+            return b;
+        }
+    }
+    return -1;
+}
+
+// Drop every buffer object held in the pool. If the GL context is
+// still alive the buffers are deleted; after a context loss the names
+// are already invalid and only the host-side entries are freed.
+WEAK void pool_release_all(void *user_context, bool context_valid) {
+    for (int b = 0; b < num_pool_buckets; b++) {
+        PoolEntry *entry = pool_buckets[b];
+        pool_buckets[b] = NULL;
+        while (entry) {
+            PoolEntry *next = entry->next;
+            if (context_valid) {
+                debug(user_context) << "Deleting pooled dev_buffer " << entry->the_buffer << "\n";
+                global_state.DeleteBuffers(1, &entry->the_buffer);
+            }
+            free(entry);
+            entry = next;
+        }
+    }
+}
+
 // ---------- Helper functions ----------
 
 WEAK void debug_buffer(void *user_context, halide_buffer_t *buf) {
@@ -198,6 +251,8 @@ WEAK int halide_openglcompute_device_release(void *user_context) {
     debug(user_context) << "OpenGLCompute: halide_openglcompute_device_release(user_context: "
                         << user_context << ")\n";
 
+    pool_release_all(user_context, true);
+
     ModuleState *mod = state_list;
     while (mod) {
         global_state.DeleteProgram(mod->kernel->program_id);
@@ -275,15 +330,31 @@ WEAK int halide_openglcompute_device_malloc(void *user_context, halide_buffer_t
         return 1;
     }
 
-    GLuint the_buffer;
-    global_state.GenBuffers(1, &the_buffer);
-    if (global_state.CheckAndReportError(user_context, "oglc: GenBuffers")) { return 1; }
-    global_state.BindBuffer(GL_ARRAY_BUFFER, the_buffer);
-    if (global_state.CheckAndReportError(user_context, "oglc: BindBuffer")) { return 1; }
+    GLuint the_buffer = 0;
     size_t size_in_bytes = buf->size_in_bytes();
     halide_assert(user_context, size_in_bytes != 0);
-    global_state.BufferData(GL_ARRAY_BUFFER, size_in_bytes, NULL, GL_DYNAMIC_COPY);
-    if (global_state.CheckAndReportError(user_context, "oglc: BufferData")) { return 1; }
+
+    // Try to recycle a pooled buffer object of the right size class
+    // before asking the driver for a new one.
+    if (pool_enabled) {
+        int bucket = pool_bucket_for_size(&size_in_bytes);
+        if (bucket >= 0 && pool_buckets[bucket] != NULL) {
+            PoolEntry *entry = pool_buckets[bucket];
+            pool_buckets[bucket] = entry->next;
+            the_buffer = entry->the_buffer;
+            free(entry);
+            debug(user_context) << "Reusing pooled dev_buffer " << the_buffer << "\n";
+        }
+    }
+
+    if (the_buffer == 0) {
+        global_state.GenBuffers(1, &the_buffer);
+        if (global_state.CheckAndReportError(user_context, "oglc: GenBuffers")) { return 1; }
+        global_state.BindBuffer(GL_ARRAY_BUFFER, the_buffer);
+        if (global_state.CheckAndReportError(user_context, "oglc: BindBuffer")) { return 1; }
+        global_state.BufferData(GL_ARRAY_BUFFER, size_in_bytes, NULL, GL_DYNAMIC_COPY);
+        if (global_state.CheckAndReportError(user_context, "oglc: BufferData")) { return 1; }
+    }
 
     buf->device = the_buffer;
     buf->device_interface = &openglcompute_device_interface;
@@ -320,7 +391,29 @@ WEAK int halide_openglcompute_device_free(void *user_context, halide_buffer_t *b
                         << ", the_buffer:" << the_buffer
                         << ")\n";
 
-    global_state.DeleteBuffers(1, &the_buffer);
+    // If pooling is enabled, retain the buffer object for reuse by a
+    // later allocation of the same size class instead of deleting it.
+    // The bucket is computed from the same size device_malloc rounded
+    // up, so it gets the block size the allocation actually has.
+    bool pooled = false;
+    if (pool_enabled) {
+        size_t size = buf->size_in_bytes();
+        int bucket = pool_bucket_for_size(&size);
+        if (bucket >= 0) {
+            PoolEntry *entry = (PoolEntry *)malloc(sizeof(PoolEntry));
+            if (entry) {
+                debug(user_context) << "OGLC: pooled dev_buffer " << the_buffer << "\n";
+                entry->the_buffer = the_buffer;
+                entry->next = pool_buckets[bucket];
+                pool_buckets[bucket] = entry;
+                pooled = true;
+            }
+        }
+    }
+
+    if (!pooled) {
+        global_state.DeleteBuffers(1, &the_buffer);
+    }
 
     buf->device = 0;
     buf->device_interface->impl->release_module();
@@ -661,6 +754,23 @@ WEAK int halide_openglcompute_device_and_host_free(void *user_context, struct ha
     return halide_default_device_and_host_free(user_context, buf, &openglcompute_device_interface);
 }
 
+// Enable or disable the pool of freed buffer objects. While enabled,
+// halide_openglcompute_device_free returns buffers to a size-bucketed
+// freelist instead of calling glDeleteBuffers, and
+// halide_openglcompute_device_malloc recycles them. Disabling the pool
+// stops recycling but does not delete pooled buffers; use
+// halide_openglcompute_release_unused_memory for that.
+WEAK int halide_openglcompute_enable_memory_pool(void *user_context, int enabled) {
+    pool_enabled = (enabled != 0);
+    return 0;
+}
+
+// Delete all buffer objects held in the pool.
+WEAK int halide_openglcompute_release_unused_memory(void *user_context) {
+    pool_release_all(user_context, global_state.initialized);
+    return 0;
+}
+
 WEAK const struct halide_device_interface_t *halide_openglcompute_device_interface() {
     return &openglcompute_device_interface;
 }
@@ -685,6 +795,7 @@ WEAK halide_device_interface_impl_t openglcompute_device_interface_impl = {
     halide_openglcompute_device_and_host_free,
     halide_default_buffer_copy,
     halide_default_device_crop,
+    halide_default_device_slice,
     halide_default_device_release_crop,
     halide_default_device_wrap_native,
     halide_default_device_detach_native,
@@ -702,6 +813,7 @@ WEAK halide_device_interface_t openglcompute_device_interface = {
     halide_device_and_host_free,
     halide_buffer_copy,
     halide_device_crop,
+    halide_device_slice,
     halide_device_release_crop,
     halide_device_wrap_native,
     halide_device_detach_native,
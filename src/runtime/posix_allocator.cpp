@@ -1,27 +1,237 @@
 #include "HalideRuntime.h"
 #include "runtime_internal.h"
+#include "scoped_spin_lock.h"
 
 extern "C" {
 
 extern void *malloc(size_t);
 extern void free(void *);
 
-WEAK void *halide_default_malloc(void *user_context, size_t x) {
-    // Allocate enough space for aligning the pointer we return.
+}
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+// Pipelines that use compute_at inside parallel loops make frequent
+// transient heap allocations, and routing each one through the system
+// malloc makes the threads contend on the allocator. We keep freed
+// blocks in a set of arenas, each with its own lock and per-size-class
+// free lists. Threads map to arenas by hashing their stack address, so
+// under the common pattern (a worker allocates and frees within its own
+// task) each worker reuses blocks from its own arena without touching
+// a shared lock. halide_set_custom_malloc remains the override point;
+// all of this sits behind halide_default_malloc/free.
+
+// Cached blocks have power-of-two capacities from min_block_size up to
+// max_block_size; larger allocations are cached by exact size in a
+// single shared pool (see below).
+static const size_t min_block_size = 512;
+static const size_t max_block_size = 4 * 1024 * 1024;
+static const int num_size_classes = 14;  // 512 << 13 == max_block_size
+static const int num_arenas = 64;
+// Per arena and size class, to bound how much freed memory we hold on to.
+static const int max_cached_blocks = 8;
+
+struct free_block {
+    free_block *next;
+};
+
+struct arena {
+    int lock;
+    free_block *free_list[num_size_classes];
+    int num_cached[num_size_classes];
+};
+
+WEAK arena arenas[num_arenas];
+
+// Map the current thread to an arena. Threads are distinguished by
+// their stacks, so hashing the address of a local gives each thread a
+// stable arena without needing TLS or a platform thread id. Collisions
+// just mean two threads share an arena, which is correct, only slower.
+WEAK int current_arena() {
+    int marker;
+    uintptr_t p = (uintptr_t)&marker;
+    // Ignore the position within the stack, then mix the bits so
+    // adjacent stacks don't land in adjacent arenas.
+    p >>= 16;
+    p *= (uintptr_t)2654435761u;
+    return (int)((p >> 8) % num_arenas);
+}
+
+// Index of the smallest size class with capacity >= x, or -1 if x is
+// too big to cache.
+WEAK int size_class(size_t x) {
+    size_t capacity = min_block_size;
+    for (int cls = 0; cls < num_size_classes; cls++) {
+        if (x <= capacity) {
+            return cls;
+        }
+        capacity <<= 1;
+    }
+    return -1;
+}
+
+WEAK size_t size_class_capacity(int cls) {
+    return min_block_size << cls;
+}
+
+// Allocations too big for the size classes - typically compute_root
+// intermediates whose extents repeat exactly from one realization of a
+// pipeline to the next - are cached by exact size in one shared pool,
+// bounded by a byte budget (see halide_allocator_cache_set_size). A
+// pipeline with static shapes asks for the same set of sizes every
+// frame, so after the first realization every request hits the pool and
+// steady-state traffic to the system allocator drops to zero.
+WEAK int large_cache_lock = 0;
+WEAK free_block *large_cache_list = NULL;
+WEAK size_t large_cache_bytes = 0;
+WEAK size_t large_cache_budget = 64 * 1024 * 1024;
+
+// Blocks carry a two-slot header just below the returned pointer: the
+// original system pointer (as before), and the block's capacity, which
+// is the size class capacity for small blocks and the exact requested
+// size for large ones.
+WEAK void *aligned_block_malloc(size_t x, size_t capacity) {
     const size_t alignment = halide_malloc_alignment();
-    void *orig = malloc(x + alignment);
+    void *orig = malloc(x + alignment + sizeof(void *));
     if (orig == NULL) {
         // Will result in a failed assertion and a call to halide_error
         return NULL;
     }
-    // We want to store the original pointer prior to the pointer we return.
-    void *ptr = (void *)(((size_t)orig + alignment + sizeof(void*) - 1) & ~(alignment - 1));
+    void *ptr = (void *)(((size_t)orig + alignment + 2 * sizeof(void *) - 1) & ~(alignment - 1));
     ((void **)ptr)[-1] = orig;
+    ((size_t *)ptr)[-2] = capacity;
     return ptr;
 }
 
+WEAK size_t block_capacity(void *ptr) {
+    return ((size_t *)ptr)[-2];
+}
+
+__attribute__((destructor))
+WEAK void halide_allocator_cleanup() {
+    for (int i = 0; i < num_arenas; i++) {
+        ScopedSpinLock lock(&arenas[i].lock);
+        for (int cls = 0; cls < num_size_classes; cls++) {
+            free_block *block = arenas[i].free_list[cls];
+            while (block) {
+                free_block *next = block->next;
+                free(((void **)block)[-1]);
+                block = next;
+            }
+            arenas[i].free_list[cls] = NULL;
+            arenas[i].num_cached[cls] = 0;
+        }
+    }
+    ScopedSpinLock lock(&large_cache_lock);
+    free_block *block = large_cache_list;
+    while (block) {
+        free_block *next = block->next;
+        free(((void **)block)[-1]);
+        block = next;
+    }
+    large_cache_list = NULL;
+    large_cache_bytes = 0;
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+extern "C" {
+
+WEAK void *halide_default_malloc(void *user_context, size_t x) {
+    int cls = size_class(x);
+    if (cls < 0) {
+        // Too big for the size classes; look for a cached block of
+        // exactly this size.
+        void *recycled = NULL;
+        {
+            ScopedSpinLock lock(&large_cache_lock);
+            free_block **prev = &large_cache_list;
+            for (free_block *block = large_cache_list; block; block = block->next) {
+                if (block_capacity((void *)block) == x) {
+                    *prev = block->next;
+                    large_cache_bytes -= x;
+                    recycled = (void *)block;
+                    break;
+                }
+                prev = &block->next;
+            }
+        }
+        if (recycled) {
+            return recycled;
+        }
+        return aligned_block_malloc(x, x);
+    }
+
+    // Try to reuse a block from this thread's arena.
+    arena *a = &arenas[current_arena()];
+    void *recycled = NULL;
+    {
+        ScopedSpinLock lock(&a->lock);
+        free_block *block = a->free_list[cls];
+        if (block) {
+            a->free_list[cls] = block->next;
+            a->num_cached[cls]--;
+            recycled = (void *)block;
+        }
+    }
+    if (recycled) {
+        return recycled;
+    }
+
+    // Allocate the full capacity of the size class, so the block is
+    // reusable for any request in the same class.
+    return aligned_block_malloc(size_class_capacity(cls), cls);
+}
+
 WEAK void halide_default_free(void *user_context, void *ptr) {
-    free(((void**)ptr)[-1]);
+    size_t capacity = block_capacity(ptr);
+    int cls = size_class(capacity);
+    if (cls >= 0) {
+        arena *a = &arenas[current_arena()];
+        ScopedSpinLock lock(&a->lock);
+        if (a->num_cached[cls] < max_cached_blocks) {
+            free_block *block = (free_block *)ptr;
+            block->next = a->free_list[cls];
+            a->free_list[cls] = block;
+            a->num_cached[cls]++;
+            return;
+        }
+    } else {
+        ScopedSpinLock lock(&large_cache_lock);
+        if (large_cache_bytes + capacity <= large_cache_budget) {
+            free_block *block = (free_block *)ptr;
+            block->next = large_cache_list;
+            large_cache_list = block;
+            large_cache_bytes += capacity;
+            return;
+        }
+    }
+    free(((void **)ptr)[-1]);
+}
+
+WEAK void halide_allocator_cache_set_size(int64_t size) {
+    free_block *to_free = NULL;
+    {
+        ScopedSpinLock lock(&large_cache_lock);
+        large_cache_budget = (size_t)size;
+        // Trim the pool down to the new budget, oldest blocks first.
+        while (large_cache_bytes > large_cache_budget && large_cache_list) {
+            free_block **prev = &large_cache_list;
+            while ((*prev)->next) {
+                prev = &(*prev)->next;
+            }
+            free_block *block = *prev;
+            *prev = NULL;
+            large_cache_bytes -= block_capacity((void *)block);
+            block->next = to_free;
+            to_free = block;
+        }
+    }
+    while (to_free) {
+        free_block *next = to_free->next;
+        free(((void **)to_free)[-1]);
+        to_free = next;
+    }
 }
 
 }
@@ -48,10 +258,19 @@ WEAK halide_free_t halide_set_custom_free(halide_free_t user_free) {
 }
 
 WEAK void *halide_malloc(void *user_context, size_t x) {
+    const halide_runtime_overrides_t *ovr = halide_get_context_overrides(user_context);
+    if (ovr && ovr->custom_malloc) {
+        return ovr->custom_malloc(user_context, x);
+    }
     return custom_malloc(user_context, x);
 }
 
 WEAK void halide_free(void *user_context, void *ptr) {
+    const halide_runtime_overrides_t *ovr = halide_get_context_overrides(user_context);
+    if (ovr && ovr->custom_free) {
+        ovr->custom_free(user_context, ptr);
+        return;
+    }
     custom_free(user_context, ptr);
 }
 
@@ -30,6 +30,11 @@ WEAK halide_error_handler_t error_handler = halide_default_error;
 extern "C" {
 
 WEAK void halide_error(void *user_context, const char *msg) {
+    const halide_runtime_overrides_t *ovr = halide_get_context_overrides(user_context);
+    if (ovr && ovr->custom_error) {
+        ovr->custom_error(user_context, msg);
+        return;
+    }
     (*error_handler)(user_context, msg);
 }
 
@@ -11,6 +11,11 @@ WEAK halide_print_t custom_print = halide_default_print;
 extern "C" {
 
 WEAK void halide_print(void *user_context, const char *msg) {
+    const halide_runtime_overrides_t *ovr = halide_get_context_overrides(user_context);
+    if (ovr && ovr->custom_print) {
+        ovr->custom_print(user_context, msg);
+        return;
+    }
     (*custom_print)(user_context, msg);
 }
 
@@ -9,16 +9,27 @@
 extern "C" {
 // Returns the address of the global halide_profiler state
 WEAK halide_profiler_state *halide_profiler_get_state() {
-    static halide_profiler_state s = {{{0}}, 1, 0, 0, 0, 0, NULL, NULL};
+    static halide_profiler_state s = {{{0}}, 1, 0, 0, 0, 0, NULL, NULL, NULL, 0, 0, NULL, NULL, NULL};
     return &s;
 }
 }
 
 namespace Halide { namespace Runtime { namespace Internal {
 
-WEAK halide_profiler_pipeline_stats *find_or_create_pipeline(const char *pipeline_name, int num_funcs, const uint64_t *func_names) {
-    halide_profiler_state *s = halide_profiler_get_state();
-
+// When per-pipeline profiling is enabled, each pipeline gets a
+// private profiler state with its own lock and sampling thread, so
+// concurrent pipelines don't contend on one lock or clobber each
+// other's current_func. The registry below is guarded by the global
+// state's lock.
+struct halide_profiler_instance {
+    halide_profiler_state state;
+    const char *name;
+    halide_profiler_instance *next;
+};
+WEAK halide_profiler_instance *profiler_instances = NULL;
+WEAK bool per_pipeline_profiling = false;
+
+WEAK halide_profiler_pipeline_stats *find_or_create_pipeline(halide_profiler_state *s, const char *pipeline_name, int num_funcs, const uint64_t *func_names) {
     for (halide_profiler_pipeline_stats *p = s->pipelines; p;
          p = (halide_profiler_pipeline_stats *)(p->next)) {
         // The same pipeline will deliver the same global constant
@@ -34,10 +45,15 @@ WEAK halide_profiler_pipeline_stats *find_or_create_pipeline(const char *pipelin
     if (!p) return NULL;
     p->next = s->pipelines;
     p->name = pipeline_name;
-    p->first_func_id = s->first_free_id;
+    // Func ids are drawn from a process-wide counter, even for
+    // per-pipeline states, so that callers like
+    // halide_profiler_device_time can find the owning pipeline given
+    // only an id.
+    p->first_func_id = __sync_fetch_and_add(&halide_profiler_get_state()->first_free_id, num_funcs);
     p->num_funcs = num_funcs;
     p->runs = 0;
     p->time = 0;
+    p->device_time = 0;
     p->samples = 0;
     p->memory_current = 0;
     p->memory_peak = 0;
@@ -45,6 +61,9 @@ WEAK halide_profiler_pipeline_stats *find_or_create_pipeline(const char *pipelin
     p->num_allocs = 0;
     p->active_threads_numerator = 0;
     p->active_threads_denominator = 0;
+    p->instructions = 0;
+    p->llc_misses = 0;
+    p->branch_misses = 0;
     p->funcs = (halide_profiler_func_stats *)malloc(num_funcs * sizeof(halide_profiler_func_stats));
     if (!p->funcs) {
         free(p);
@@ -52,6 +71,7 @@ WEAK halide_profiler_pipeline_stats *find_or_create_pipeline(const char *pipelin
     }
     for (int i = 0; i < num_funcs; i++) {
         p->funcs[i].time = 0;
+        p->funcs[i].device_time = 0;
         p->funcs[i].name = (const char *)(func_names[i]);
         p->funcs[i].memory_current = 0;
         p->funcs[i].memory_peak = 0;
@@ -60,13 +80,16 @@ WEAK halide_profiler_pipeline_stats *find_or_create_pipeline(const char *pipelin
         p->funcs[i].stack_peak = 0;
         p->funcs[i].active_threads_numerator = 0;
         p->funcs[i].active_threads_denominator = 0;
+        p->funcs[i].instructions = 0;
+        p->funcs[i].llc_misses = 0;
+        p->funcs[i].branch_misses = 0;
     }
-    s->first_free_id += num_funcs;
     s->pipelines = p;
     return p;
 }
 
-WEAK void bill_func(halide_profiler_state *s, int func_id, uint64_t time, int active_threads) {
+WEAK void bill_func(halide_profiler_state *s, int func_id, uint64_t time, int active_threads,
+                    const uint64_t *counter_deltas) {
     halide_profiler_pipeline_stats *p_prev = NULL;
     for (halide_profiler_pipeline_stats *p = s->pipelines; p;
          p = (halide_profiler_pipeline_stats *)(p->next)) {
@@ -81,6 +104,14 @@ WEAK void bill_func(halide_profiler_state *s, int func_id, uint64_t time, int ac
             f->time += time;
             f->active_threads_numerator += active_threads;
             f->active_threads_denominator += 1;
+            if (counter_deltas) {
+                f->instructions += counter_deltas[0];
+                f->llc_misses += counter_deltas[1];
+                f->branch_misses += counter_deltas[2];
+                p->instructions += counter_deltas[0];
+                p->llc_misses += counter_deltas[1];
+                p->branch_misses += counter_deltas[2];
+            }
             p->time += time;
             p->samples++;
             p->active_threads_numerator += active_threads;
@@ -92,8 +123,73 @@ WEAK void bill_func(halide_profiler_state *s, int func_id, uint64_t time, int ac
     // Someone must have called reset_state while a kernel was running. Do nothing.
 }
 
-WEAK void sampling_profiler_thread(void *) {
+// User counters and markers always live on the global state (the
+// extern code incrementing them has no pipeline to name), so they are
+// found by walking one list. Names are compared by content rather
+// than address, because different translation units incrementing the
+// same counter pass distinct copies of the string.
+WEAK halide_profiler_user_counter *find_or_create_user_counter(const char *name) {
     halide_profiler_state *s = halide_profiler_get_state();
+    ScopedMutexLock lock(&s->lock);
+    for (halide_profiler_user_counter *c = s->user_counters; c; c = c->next) {
+        if (strcmp(c->name, name) == 0) {
+            return c;
+        }
+    }
+    halide_profiler_user_counter *c =
+        (halide_profiler_user_counter *)malloc(sizeof(halide_profiler_user_counter));
+    if (!c) return NULL;
+    c->name = name;
+    c->value = 0;
+    c->next = s->user_counters;
+    s->user_counters = c;
+    return c;
+}
+
+WEAK halide_profiler_user_marker *find_or_create_user_marker(const char *name) {
+    halide_profiler_state *s = halide_profiler_get_state();
+    ScopedMutexLock lock(&s->lock);
+    for (halide_profiler_user_marker *m = s->user_markers; m; m = m->next) {
+        if (strcmp(m->name, name) == 0) {
+            return m;
+        }
+    }
+    halide_profiler_user_marker *m =
+        (halide_profiler_user_marker *)malloc(sizeof(halide_profiler_user_marker));
+    if (!m) return NULL;
+    m->name = name;
+    m->time = 0;
+    m->count = 0;
+    m->next = s->user_markers;
+    s->user_markers = m;
+    return m;
+}
+
+WEAK const char *find_func_name(halide_profiler_state *s, int func_id) {
+    for (halide_profiler_pipeline_stats *p = s->pipelines; p;
+         p = (halide_profiler_pipeline_stats *)(p->next)) {
+        if (func_id >= p->first_func_id && func_id < p->first_func_id + p->num_funcs) {
+            return p->funcs[func_id - p->first_func_id].name;
+        }
+    }
+    return "<unknown>";
+}
+
+WEAK void record_timeline_event(halide_profiler_state *s, int func_id,
+                                int active_threads, uint64_t begin, uint64_t end) {
+    halide_profiler_timeline_event *e =
+        s->timeline_events + (s->timeline_head % s->timeline_size);
+    e->begin = begin;
+    e->end = end;
+    e->func_id = func_id;
+    e->active_threads = active_threads;
+    s->timeline_head++;
+}
+
+WEAK void sampling_profiler_thread(void *arg) {
+    // The argument is the state this thread samples: the global state
+    // or a per-pipeline instance.
+    halide_profiler_state *s = (halide_profiler_state *)arg;
 
     // grab the lock
     halide_mutex_lock(&s->lock);
@@ -102,6 +198,18 @@ WEAK void sampling_profiler_thread(void *) {
 
         uint64_t t1 = halide_current_time_ns(NULL);
         uint64_t t = t1;
+
+        // The interval over which we have been observing the same
+        // func, for the timeline recorder.
+        int event_func = halide_profiler_outside_of_halide;
+        int event_threads = 0;
+        uint64_t event_begin = t1;
+
+        // The last hardware counter values observed, so that each
+        // sample can be billed the delta since the previous one.
+        uint64_t last_counters[3];
+        bool have_last_counters = false;
+
         while (1) {
             int func, active_threads;
             if (s->get_remote_profiler_state) {
@@ -113,12 +221,44 @@ WEAK void sampling_profiler_thread(void *) {
                 active_threads = s->active_threads;
             }
             uint64_t t_now = halide_current_time_ns(NULL);
+            if (s->timeline_events &&
+                (func != event_func || active_threads != event_threads)) {
+                // The observed state changed. Close off the previous
+                // interval. Intervals spent outside of Halide are
+                // implied by the gaps between events.
+                if (event_func >= 0) {
+                    record_timeline_event(s, event_func, event_threads,
+                                          event_begin, t_now);
+                }
+                event_func = func;
+                event_threads = active_threads;
+                event_begin = t_now;
+            }
+            uint64_t counter_deltas[3];
+            const uint64_t *deltas = NULL;
+            if (s->read_perf_counters) {
+                uint64_t counters[3];
+                if (s->read_perf_counters(counters) == 0) {
+                    if (have_last_counters) {
+                        for (int i = 0; i < 3; i++) {
+                            counter_deltas[i] = counters[i] - last_counters[i];
+                        }
+                        deltas = counter_deltas;
+                    }
+                    for (int i = 0; i < 3; i++) {
+                        last_counters[i] = counters[i];
+                    }
+                    have_last_counters = true;
+                }
+            } else {
+                have_last_counters = false;
+            }
             if (func == halide_profiler_please_stop) {
                 break;
             } else if (func >= 0) {
-                // Assume all time since I was last awake is due to
-                // the currently running func.
-                bill_func(s, func, t_now - t, active_threads);
+                // Assume all time (and all hardware events) since I
+                // was last awake is due to the currently running func.
+                bill_func(s, func, t_now - t, active_threads, deltas);
             }
             t = t_now;
 
@@ -152,6 +292,39 @@ void sync_compare_max_and_swap(T *ptr, T val) {
 }
 
 extern "C" {
+// Returns the state samples for the named pipeline should be recorded
+// into: the global state, or a per-pipeline instance if per-pipeline
+// profiling is enabled (creating it on first use).
+WEAK halide_profiler_state *halide_profiler_instance_state(const char *pipeline_name) {
+    halide_profiler_state *global = halide_profiler_get_state();
+
+    ScopedMutexLock lock(&global->lock);
+
+    if (!per_pipeline_profiling) {
+        return global;
+    }
+    for (halide_profiler_instance *i = profiler_instances; i; i = i->next) {
+        // The same pipeline will deliver the same global constant
+        // string, so they can be compared by pointer.
+        if (i->name == pipeline_name) {
+            return &i->state;
+        }
+    }
+    halide_profiler_instance *i =
+        (halide_profiler_instance *)malloc(sizeof(halide_profiler_instance));
+    if (!i) {
+        // Fall back to the shared state rather than drop the samples.
+        return global;
+    }
+    memset(i, 0, sizeof(halide_profiler_instance));
+    i->state.sleep_time = global->sleep_time;
+    i->state.current_func = halide_profiler_outside_of_halide;
+    i->name = pipeline_name;
+    i->next = profiler_instances;
+    profiler_instances = i;
+    return &i->state;
+}
+
 // Returns the address of the pipeline state associated with pipeline_name.
 WEAK halide_profiler_pipeline_stats *halide_profiler_get_pipeline_state(const char *pipeline_name) {
     halide_profiler_state *s = halide_profiler_get_state();
@@ -166,25 +339,67 @@ WEAK halide_profiler_pipeline_stats *halide_profiler_get_pipeline_state(const ch
             return p;
         }
     }
+    for (halide_profiler_instance *i = profiler_instances; i; i = i->next) {
+        ScopedMutexLock inner_lock(&i->state.lock);
+        for (halide_profiler_pipeline_stats *p = i->state.pipelines; p;
+             p = (halide_profiler_pipeline_stats *)(p->next)) {
+            if (p->name == pipeline_name) {
+                return p;
+            }
+        }
+    }
     return NULL;
 }
 
+// Fold time measured on a device (e.g. with CUDA events) into the
+// stats of the func that launched the work. Called by the GPU
+// runtimes; see halide_profiler_state::current_func.
+WEAK void halide_profiler_device_time(void *user_context, int func_id, uint64_t time_ns) {
+    if (func_id < 0) {
+        return;
+    }
+    halide_profiler_state *s = halide_profiler_get_state();
+    ScopedMutexLock lock(&s->lock);
+    for (halide_profiler_pipeline_stats *p = s->pipelines; p;
+         p = (halide_profiler_pipeline_stats *)(p->next)) {
+        if (func_id >= p->first_func_id && func_id < p->first_func_id + p->num_funcs) {
+            p->funcs[func_id - p->first_func_id].device_time += time_ns;
+            p->device_time += time_ns;
+            return;
+        }
+    }
+    // Func ids are unique across all states, so the id may belong to
+    // a per-pipeline instance instead.
+    for (halide_profiler_instance *i = profiler_instances; i; i = i->next) {
+        ScopedMutexLock inner_lock(&i->state.lock);
+        for (halide_profiler_pipeline_stats *p = i->state.pipelines; p;
+             p = (halide_profiler_pipeline_stats *)(p->next)) {
+            if (func_id >= p->first_func_id && func_id < p->first_func_id + p->num_funcs) {
+                p->funcs[func_id - p->first_func_id].device_time += time_ns;
+                p->device_time += time_ns;
+                return;
+            }
+        }
+    }
+    // Someone must have called reset_state while a kernel was running. Do nothing.
+}
+
 // Returns a token identifying this pipeline instance.
 WEAK int halide_profiler_pipeline_start(void *user_context,
                                         const char *pipeline_name,
                                         int num_funcs,
                                         const uint64_t *func_names) {
-    halide_profiler_state *s = halide_profiler_get_state();
+    halide_profiler_state *s = halide_profiler_instance_state(pipeline_name);
 
     ScopedMutexLock lock(&s->lock);
 
     if (!s->sampling_thread) {
         halide_start_clock(user_context);
-        s->sampling_thread = halide_spawn_thread(sampling_profiler_thread, NULL);
+        s->sampling_thread = halide_spawn_thread(sampling_profiler_thread, s);
     }
 
     halide_profiler_pipeline_stats *p =
-        find_or_create_pipeline(pipeline_name, num_funcs, func_names);
+        find_or_create_pipeline(s, pipeline_name, num_funcs, func_names);
     if (!p) {
         // Allocating space to track the statistics failed.
         return halide_error_out_of_memory(user_context);
@@ -280,6 +495,65 @@ WEAK void halide_profiler_memory_free(void *user_context,
     __sync_sub_and_fetch(&f_stats->memory_current, decr);
 }
 
+WEAK void halide_profiler_user_counter_add(void *user_context,
+                                           const char *name, uint64_t amount) {
+    halide_profiler_user_counter *c = find_or_create_user_counter(name);
+    if (!c) {
+        // Allocating the counter failed; drop the count.
+        return;
+    }
+    __sync_add_and_fetch(&c->value, amount);
+}
+
+WEAK uint64_t halide_profiler_marker_begin(void *user_context, const char *name) {
+    halide_start_clock(user_context);
+    return halide_current_time_ns(user_context);
+}
+
+WEAK void halide_profiler_marker_end(void *user_context, const char *name,
+                                     uint64_t token) {
+    uint64_t t = halide_current_time_ns(user_context);
+    halide_profiler_user_marker *m = find_or_create_user_marker(name);
+    if (!m) {
+        return;
+    }
+    __sync_add_and_fetch(&m->time, t - token);
+    __sync_add_and_fetch(&m->count, 1);
+}
+
+// Print the user counter and marker sections of a report. Marker
+// times are given as a percentage of total_time, the summed pipeline
+// time of every profiled state.
+WEAK void halide_profiler_print_user_stats(void *user_context, uint64_t total_time) {
+    halide_profiler_state *s = halide_profiler_get_state();
+
+    char line_buf[1024];
+    Printer<StringStreamPrinter, sizeof(line_buf)> sstr(user_context, line_buf);
+
+    if (s->user_markers) {
+        halide_print(user_context, "user markers:\n");
+        for (halide_profiler_user_marker *m = s->user_markers; m; m = m->next) {
+            int percent = 0;
+            if (total_time) {
+                percent = (int)((100 * m->time) / total_time);
+            }
+            sstr.clear();
+            sstr << "  " << m->name << ": " << m->time / 1000000.0f << "ms"
+                 << " (" << percent << "%)"
+                 << "  count: " << m->count << "\n";
+            halide_print(user_context, sstr.str());
+        }
+    }
+    if (s->user_counters) {
+        halide_print(user_context, "user counters:\n");
+        for (halide_profiler_user_counter *c = s->user_counters; c; c = c->next) {
+            sstr.clear();
+            sstr << "  " << c->name << ": " << c->value << "\n";
+            halide_print(user_context, sstr.str());
+        }
+    }
+}
+
 WEAK void halide_profiler_report_unlocked(void *user_context, halide_profiler_state *s) {
 
     char line_buf[1024];
@@ -304,11 +578,19 @@ WEAK void halide_profiler_report_unlocked(void *user_context, halide_profiler_st
         if (!serial) {
             sstr << " average threads used: " << threads << "\n";
         }
+        if (p->device_time) {
+            sstr << " device time: " << p->device_time / 1000000.0f << " ms\n";
+        }
         sstr << " heap allocations: " << p->num_allocs
              << "  peak heap usage: " << p->memory_peak << " bytes\n";
+        if (p->instructions || p->llc_misses || p->branch_misses) {
+            sstr << " instructions: " << p->instructions
+                 << "  llc misses: " << p->llc_misses
+                 << "  branch misses: " << p->branch_misses << "\n";
+        }
         halide_print(user_context, sstr.str());
 
-        bool print_f_states = p->time || p->memory_total;
+        bool print_f_states = p->time || p->device_time || p->memory_total;
         if (!print_f_states) {
             for (int i = 0; i < p->num_funcs; i++) {
                 halide_profiler_func_stats *fs = p->funcs + i;
@@ -349,6 +631,15 @@ WEAK void halide_profiler_report_unlocked(void *user_context, halide_profiler_st
                 cursor += 8;
                 while (sstr.size() < cursor) sstr << " ";
 
+                if (fs->device_time) {
+                    float dt = fs->device_time / (p->runs * 1000000.0f);
+                    sstr << "gpu: " << dt;
+                    sstr.erase(3);
+                    sstr << "ms";
+                    cursor += 15;
+                    while (sstr.size() < cursor) sstr << " ";
+                }
+
                 if (!serial) {
                     float threads = fs->active_threads_numerator / (fs->active_threads_denominator + 1e-10);
                     sstr << "threads: " << threads;
@@ -374,6 +665,22 @@ WEAK void halide_profiler_report_unlocked(void *user_context, halide_profiler_st
                 if (fs->stack_peak > 0) {
                     sstr << " stack: " << fs->stack_peak;
                 }
+
+                if (fs->instructions || fs->llc_misses || fs->branch_misses) {
+                    int inst_percent = 0, llc_percent = 0, branch_percent = 0;
+                    if (p->instructions) {
+                        inst_percent = (int)((100 * fs->instructions) / p->instructions);
+                    }
+                    if (p->llc_misses) {
+                        llc_percent = (int)((100 * fs->llc_misses) / p->llc_misses);
+                    }
+                    if (p->branch_misses) {
+                        branch_percent = (int)((100 * fs->branch_misses) / p->branch_misses);
+                    }
+                    sstr << " inst: " << fs->instructions << " (" << inst_percent << "%)"
+                         << " llc-miss: " << fs->llc_misses << " (" << llc_percent << "%)"
+                         << " br-miss: " << fs->branch_misses << " (" << branch_percent << "%)";
+                }
                 sstr << "\n";
 
                 halide_print(user_context, sstr.str());
@@ -383,11 +690,127 @@ WEAK void halide_profiler_report_unlocked(void *user_context, halide_profiler_st
 }
 
 WEAK void halide_profiler_report(void *user_context) {
+    halide_profiler_state *s = halide_profiler_get_state();
+    {
+        ScopedMutexLock lock(&s->lock);
+        halide_profiler_report_unlocked(user_context, s);
+        uint64_t total_time = 0;
+        for (halide_profiler_pipeline_stats *p = s->pipelines; p;
+             p = (halide_profiler_pipeline_stats *)(p->next)) {
+            total_time += p->time;
+        }
+        // Aggregated view: also report any per-pipeline instances.
+        for (halide_profiler_instance *i = profiler_instances; i; i = i->next) {
+            ScopedMutexLock inner_lock(&i->state.lock);
+            halide_profiler_report_unlocked(user_context, &i->state);
+            for (halide_profiler_pipeline_stats *p = i->state.pipelines; p;
+                 p = (halide_profiler_pipeline_stats *)(p->next)) {
+                total_time += p->time;
+            }
+        }
+        halide_profiler_print_user_stats(user_context, total_time);
+    }
+
+    // Contended-lock stats, collected process-wide when lock profiling
+    // is enabled (see halide_profiler_lock_contention_set_enabled).
+    // Reported outside the profiler lock: that lock is itself subject
+    // to the instrumentation.
+    char line_buf[1024];
+    Printer<StringStreamPrinter, sizeof(line_buf)> sstr(user_context, line_buf);
+    bool printed_header = false;
+    for (int i = 0; ; i++) {
+        uintptr_t addr;
+        const char *name;
+        uint64_t acquires, contended_acquires, wait_time_ns;
+        int valid = halide_lock_profiler_get(i, &addr, &name, &acquires,
+                                             &contended_acquires, &wait_time_ns);
+        if (valid < 0) {
+            break;
+        }
+        if (valid == 0 || acquires == 0) {
+            continue;
+        }
+        if (!printed_header) {
+            halide_print(user_context, "lock contention:\n");
+            printed_header = true;
+        }
+        sstr.clear();
+        sstr << "  ";
+        if (name) {
+            sstr << name;
+        } else {
+            sstr << (const void *)addr;
+        }
+        sstr << ": acquires: " << acquires
+             << "  contended: " << contended_acquires
+             << "  wait: " << wait_time_ns / 1000000.0f << " ms\n";
+        halide_print(user_context, sstr.str());
+    }
+}
+
+WEAK void halide_profiler_lock_contention_set_enabled(bool enabled) {
+    halide_lock_profiler_set_clock(enabled ? halide_current_time_ns : NULL);
+}
+
+
+WEAK int halide_profiler_timeline_enable(void *user_context, int max_events) {
+    halide_profiler_state *s = halide_profiler_get_state();
+    ScopedMutexLock lock(&s->lock);
+    if (s->timeline_events) {
+        free(s->timeline_events);
+    }
+    s->timeline_events = (halide_profiler_timeline_event *)
+        malloc(max_events * sizeof(halide_profiler_timeline_event));
+    if (!s->timeline_events) {
+        s->timeline_size = 0;
+        s->timeline_head = 0;
+        return halide_error_out_of_memory(user_context);
+    }
+    s->timeline_size = max_events;
+    s->timeline_head = 0;
+    return 0;
+}
+
+WEAK void halide_profiler_timeline_disable() {
     halide_profiler_state *s = halide_profiler_get_state();
     ScopedMutexLock lock(&s->lock);
-    halide_profiler_report_unlocked(user_context, s);
+    free(s->timeline_events);
+    s->timeline_events = NULL;
+    s->timeline_size = 0;
+    s->timeline_head = 0;
 }
 
+WEAK void halide_profiler_chrome_trace_report(void *user_context) {
+    halide_profiler_state *s = halide_profiler_get_state();
+    ScopedMutexLock lock(&s->lock);
+
+    char line_buf[1024];
+    Printer<StringStreamPrinter, sizeof(line_buf)> sstr(user_context, line_buf);
+
+    halide_print(user_context, "[\n");
+    int num_events = s->timeline_head;
+    if (num_events > s->timeline_size) {
+        // The ring buffer wrapped; the oldest events were overwritten.
+        num_events = s->timeline_size;
+    }
+    int start = s->timeline_head - num_events;
+    for (int i = 0; i < num_events; i++) {
+        halide_profiler_timeline_event *e =
+            s->timeline_events + ((start + i) % s->timeline_size);
+        sstr.clear();
+        sstr << "{\"name\": \"" << find_func_name(s, e->func_id) << "\""
+             << ", \"ph\": \"X\", \"pid\": 0, \"tid\": 0"
+             << ", \"ts\": " << e->begin / 1000
+             << ", \"dur\": " << (e->end - e->begin) / 1000
+             << ", \"args\": {\"active_threads\": " << e->active_threads << "}}";
+        if (i + 1 < num_events) {
+            sstr << ",";
+        }
+        sstr << "\n";
+        halide_print(user_context, sstr.str());
+    }
+    halide_print(user_context, "]\n");
+}
 
 WEAK void halide_profiler_reset_unlocked(halide_profiler_state *s) {
     while (s->pipelines) {
@@ -396,6 +819,16 @@ WEAK void halide_profiler_reset_unlocked(halide_profiler_state *s) {
         free(p->funcs);
         free(p);
     }
+    while (s->user_counters) {
+        halide_profiler_user_counter *c = s->user_counters;
+        s->user_counters = c->next;
+        free(c);
+    }
+    while (s->user_markers) {
+        halide_profiler_user_marker *m = s->user_markers;
+        s->user_markers = m->next;
+        free(m);
+    }
     s->first_free_id = 0;
 }
 
@@ -407,6 +840,10 @@ WEAK void halide_profiler_reset() {
     halide_profiler_state *s = halide_profiler_get_state();
     ScopedMutexLock lock(&s->lock);
     halide_profiler_reset_unlocked(s);
+    for (halide_profiler_instance *i = profiler_instances; i; i = i->next) {
+        ScopedMutexLock inner_lock(&i->state.lock);
+        halide_profiler_reset_unlocked(&i->state);
+    }
 }
 
 #ifndef WINDOWS
@@ -414,27 +851,56 @@ __attribute__((destructor))
 #endif
 WEAK void halide_profiler_shutdown() {
     halide_profiler_state *s = halide_profiler_get_state();
-    if (!s->sampling_thread) {
+    if (!s->sampling_thread && !profiler_instances) {
         return;
     }
 
-    s->current_func = halide_profiler_please_stop;
-    halide_join_thread(s->sampling_thread);
-    s->sampling_thread = NULL;
-    s->current_func = halide_profiler_outside_of_halide;
+    if (s->sampling_thread) {
+        s->current_func = halide_profiler_please_stop;
+        halide_join_thread(s->sampling_thread);
+        s->sampling_thread = NULL;
+        s->current_func = halide_profiler_outside_of_halide;
+    }
+    for (halide_profiler_instance *i = profiler_instances; i; i = i->next) {
+        if (i->state.sampling_thread) {
+            i->state.current_func = halide_profiler_please_stop;
+            halide_join_thread(i->state.sampling_thread);
+            i->state.sampling_thread = NULL;
+            i->state.current_func = halide_profiler_outside_of_halide;
+        }
+    }
 
     // Print results. No need to lock anything because we just shut
-    // down the thread.
+    // down the threads.
     halide_profiler_report_unlocked(NULL, s);
+    uint64_t total_time = 0;
+    for (halide_profiler_pipeline_stats *p = s->pipelines; p;
+         p = (halide_profiler_pipeline_stats *)(p->next)) {
+        total_time += p->time;
+    }
+    for (halide_profiler_instance *i = profiler_instances; i; i = i->next) {
+        halide_profiler_report_unlocked(NULL, &i->state);
+        for (halide_profiler_pipeline_stats *p = i->state.pipelines; p;
+             p = (halide_profiler_pipeline_stats *)(p->next)) {
+            total_time += p->time;
+        }
+    }
+    halide_profiler_print_user_stats(NULL, total_time);
 
     halide_profiler_reset_unlocked(s);
+    while (profiler_instances) {
+        halide_profiler_instance *i = profiler_instances;
+        profiler_instances = i->next;
+        halide_profiler_reset_unlocked(&i->state);
+        free(i);
+    }
 }
 
 namespace {
 #ifdef WINDOWS
 WEAK void halide_windows_profiler_shutdown() {
     halide_profiler_state *s = halide_profiler_get_state();
-    if (!s->sampling_thread) {
+    if (!s->sampling_thread && !profiler_instances) {
         return;
     }
 
@@ -448,10 +914,55 @@ WEAK void halide_windows_profiler_shutdown() {
     // Print results. Avoid locking as it will cause problems and
     // nothing should be running.
     halide_profiler_report_unlocked(NULL, s);
+    uint64_t total_time = 0;
+    for (halide_profiler_pipeline_stats *p = s->pipelines; p;
+         p = (halide_profiler_pipeline_stats *)(p->next)) {
+        total_time += p->time;
+    }
+    for (halide_profiler_instance *i = profiler_instances; i; i = i->next) {
+        halide_profiler_report_unlocked(NULL, &i->state);
+        for (halide_profiler_pipeline_stats *p = i->state.pipelines; p;
+             p = (halide_profiler_pipeline_stats *)(p->next)) {
+            total_time += p->time;
+        }
+    }
+    halide_profiler_print_user_stats(NULL, total_time);
 }
 #endif
 }
 
+WEAK int halide_profiler_per_pipeline_enable(void *user_context) {
+    halide_profiler_state *s = halide_profiler_get_state();
+    ScopedMutexLock lock(&s->lock);
+    per_pipeline_profiling = true;
+    return 0;
+}
+
+WEAK void halide_profiler_per_pipeline_disable() {
+    halide_profiler_state *s = halide_profiler_get_state();
+    ScopedMutexLock lock(&s->lock);
+    per_pipeline_profiling = false;
+    // Stop the per-pipeline samplers and fold their stats into the
+    // shared list so they still appear in reports. The instance
+    // states themselves stay allocated until shutdown, in case a
+    // compiled pipeline still holds a pointer to one.
+    for (halide_profiler_instance *i = profiler_instances; i; i = i->next) {
+        if (i->state.sampling_thread) {
+            i->state.current_func = halide_profiler_please_stop;
+            halide_join_thread(i->state.sampling_thread);
+            i->state.sampling_thread = NULL;
+            i->state.current_func = halide_profiler_outside_of_halide;
+        }
+        ScopedMutexLock inner_lock(&i->state.lock);
+        while (i->state.pipelines) {
+            halide_profiler_pipeline_stats *p = i->state.pipelines;
+            i->state.pipelines = (halide_profiler_pipeline_stats *)(p->next);
+            p->next = s->pipelines;
+            s->pipelines = p;
+        }
+    }
+}
+
 WEAK void halide_profiler_pipeline_end(void *user_context, void *state) {
     ((halide_profiler_state *)state)->current_func = halide_profiler_outside_of_halide;
 }
@@ -9,47 +9,94 @@ extern void free(void *);
 
 namespace Halide { namespace Runtime { namespace Internal {
 
+// Allocations are aligned to 128 bytes (an HVX vector), and carry two
+// words of metadata just below the returned pointer: the pointer
+// originally returned by malloc, and the size class of the block (or
+// all-ones if the block bypassed the pool below).
+
 WEAK void *aligned_malloc(size_t alignment, size_t size) {
     // We also need to align the size of the buffer.
     size = (size + alignment - 1) & ~(alignment - 1);
 
-    // Allocate enough space for aligning the pointer we return.
-    void *orig = malloc(size + alignment);
+    // Allocate enough space for aligning the pointer we return, plus
+    // the two words of metadata.
+    void *orig = malloc(size + alignment + 2 * sizeof(void *));
     if (orig == NULL) {
         // Will result in a failed assertion and a call to halide_error
         return NULL;
     }
-    // We want to store the original pointer prior to the pointer we return.
-    void *ptr = (void *)(((size_t)orig + alignment + sizeof(void*) - 1) & ~(alignment - 1));
+    // We want to store the metadata prior to the pointer we return.
+    void *ptr = (void *)(((size_t)orig + alignment + 2 * sizeof(void *) - 1) & ~(alignment - 1));
     ((void **)ptr)[-1] = orig;
     return ptr;
 }
 
 WEAK void aligned_free(void *ptr) {
     if (ptr) {
-        free(((void**)ptr)[-1]);
+        free(((void **)ptr)[-1]);
     }
 }
 
-// We keep a small pool of small pre-allocated buffers for use by Halide
-// code; some kernels end up doing per-scanline allocations and frees,
-// which can cause a noticable performance impact on some workloads.
-// 'num_buffers' is the number of pre-allocated buffers and 'buffer_size' is
-// the size of each buffer. The pre-allocated buffers are shared among threads
-// and we use __sync_val_compare_and_swap primitive to synchronize the buffer
-// allocation.
-// TODO(psuriana): make num_buffers configurable by user
-static const int num_buffers = 10;
-static const int buffer_size = 1024 * 64;
+// We keep a pool of recently-freed buffers for reuse by Halide code;
+// some kernels end up doing per-scanline allocations and frees, which
+// can cause a noticable performance impact on some workloads. Freed
+// buffers are binned by power-of-two size class, and allocations are
+// rounded up to their size class, so any pooled buffer of the right
+// class can satisfy a later allocation. The pool is shared among
+// threads, guarded by a spin lock built from the same __sync
+// primitives we use in the rest of the QuRT runtime.
+
+// Size classes run from 1 KB to 4 MB. Anything larger goes straight
+// to malloc/free.
+static const int min_class_bits = 10;
+static const int max_class_bits = 22;
+static const int num_classes = max_class_bits - min_class_bits + 1;
+
+// Freed blocks are linked through their first word.
+struct free_block {
+    free_block *next;
+};
+
+WEAK free_block *free_list[num_classes] = { NULL, };
+WEAK size_t pooled_bytes = 0;
+// The total number of bytes the pool may hold on to. Configurable via
+// halide_qurt_set_malloc_pool_capacity.
+WEAK size_t pool_capacity = 4 * 1024 * 1024;
+WEAK volatile int pool_lock = 0;
+
+WEAK void lock_pool() {
+    while (__sync_val_compare_and_swap(&pool_lock, 0, 1) != 0) {}
+}
 
-WEAK int buf_is_used[num_buffers];
-WEAK void *mem_buf[num_buffers] = { NULL, };
+WEAK void unlock_pool() {
+    __sync_lock_release(&pool_lock);
+}
+
+// Returns the smallest size class that fits 'size' bytes, or -1 if it
+// is too large to pool.
+WEAK int size_class(size_t size) {
+    if (size > ((size_t)1 << max_class_bits)) {
+        return -1;
+    }
+    int bits = min_class_bits;
+    while (((size_t)1 << bits) < size) {
+        bits++;
+    }
+    return bits - min_class_bits;
+}
 
 __attribute__((destructor))
 WEAK void halide_allocator_cleanup() {
-    for (int i = 0; i < num_buffers; ++i) {
-        aligned_free(mem_buf[i]);
+    for (int i = 0; i < num_classes; ++i) {
+        free_block *block = free_list[i];
+        while (block) {
+            free_block *next = block->next;
+            aligned_free(block);
+            block = next;
+        }
+        free_list[i] = NULL;
     }
+    pooled_bytes = 0;
 }
 
 }}} // namespace Halide::Runtime::Internal
@@ -58,26 +105,49 @@ WEAK void *halide_default_malloc(void *user_context, size_t x) {
     // Hexagon needs up to 128 byte alignment.
     const size_t alignment = 128;
 
-    if (x <= buffer_size) {
-        for (int i = 0; i < num_buffers; ++i) {
-            if (__sync_val_compare_and_swap(buf_is_used + i, 0, 1) == 0) {
-                if (mem_buf[i] == NULL) {
-                    mem_buf[i] = aligned_malloc(alignment, buffer_size);
-                }
-                return mem_buf[i];
-            }
+    int cls = size_class(x);
+    if (cls >= 0) {
+        size_t class_size = (size_t)1 << (cls + min_class_bits);
+        lock_pool();
+        free_block *block = free_list[cls];
+        if (block != NULL) {
+            free_list[cls] = block->next;
+            pooled_bytes -= class_size;
+        }
+        unlock_pool();
+        if (block != NULL) {
+            return block;
         }
+        // Allocate the whole size class, so this buffer can be reused
+        // by any later allocation of the same class.
+        x = class_size;
     }
 
-    return aligned_malloc(alignment, x);
+    void *ptr = aligned_malloc(alignment, x);
+    if (ptr) {
+        ((size_t *)ptr)[-2] = (size_t)cls;
+    }
+    return ptr;
 }
 
 WEAK void halide_default_free(void *user_context, void *ptr) {
-    for (int i = 0; i < num_buffers; ++i) {
-        if (mem_buf[i] == ptr) {
-            buf_is_used[i] = 0;
+    if (!ptr) {
+        return;
+    }
+
+    int cls = (int)((size_t *)ptr)[-2];
+    if (cls >= 0) {
+        size_t class_size = (size_t)1 << (cls + min_class_bits);
+        lock_pool();
+        if (pooled_bytes + class_size <= pool_capacity) {
+            free_block *block = (free_block *)ptr;
+            block->next = free_list[cls];
+            free_list[cls] = block;
+            pooled_bytes += class_size;
+            unlock_pool();
             return;
         }
+        unlock_pool();
     }
 
     aligned_free(ptr);
@@ -108,6 +178,23 @@ WEAK halide_free_t halide_set_custom_free(halide_free_t user_free) {
     return result;
 }
 
+WEAK void halide_qurt_set_malloc_pool_capacity(void *user_context, size_t bytes) {
+    lock_pool();
+    pool_capacity = bytes;
+    // Evict pooled buffers until we're back under the new capacity,
+    // largest classes first.
+    for (int i = num_classes - 1; i >= 0 && pooled_bytes > pool_capacity; --i) {
+        size_t class_size = (size_t)1 << (i + min_class_bits);
+        while (free_list[i] != NULL && pooled_bytes > pool_capacity) {
+            free_block *block = free_list[i];
+            free_list[i] = block->next;
+            pooled_bytes -= class_size;
+            aligned_free(block);
+        }
+    }
+    unlock_pool();
+}
+
 // TODO: These should be calling custom_malloc/custom_free, but globals are not
 // initialized correctly when using mmap_dlopen. We need to fix this, then we
 // can enable the custom allocators.
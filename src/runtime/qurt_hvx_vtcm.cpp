@@ -0,0 +1,36 @@
+#include "runtime_internal.h"
+#include "HalideRuntimeQurt.h"
+#include "printer.h"
+
+extern "C" {
+
+// The VTCM manager API, provided by the HAP libraries on the DSP. We
+// declare what we need here rather than depending on the HAP headers.
+extern void *HAP_request_VTCM(unsigned int size, unsigned int single_page_flag);
+extern int HAP_release_VTCM(void *pVA);
+
+WEAK void *halide_vtcm_malloc(void *user_context, size_t size) {
+    debug(user_context) << "QuRT: HAP_request_VTCM(" << (int)size << ") ->\n";
+    // Ask for a single-page mapping first, so the whole allocation
+    // lands in one TLB entry.
+    void *ptr = HAP_request_VTCM((unsigned int)size, 1);
+    if (!ptr) {
+        // Too big for a single page; take a multi-page mapping instead.
+        ptr = HAP_request_VTCM((unsigned int)size, 0);
+    }
+    debug(user_context) << "        " << ptr << "\n";
+    // A null result here feeds the halide_error_out_of_memory check
+    // in the generated code, so don't report an error ourselves.
+    return ptr;
+}
+
+WEAK void halide_vtcm_free(void *user_context, void *ptr) {
+    debug(user_context) << "QuRT: HAP_release_VTCM(" << ptr << ") ->\n";
+    int result = HAP_release_VTCM(ptr);
+    debug(user_context) << "        " << result << "\n";
+    if (result != 0) {
+        error(user_context) << "HAP_release_VTCM failed\n";
+    }
+}
+
+}
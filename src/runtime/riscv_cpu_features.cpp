@@ -0,0 +1,14 @@
+#include "HalideRuntime.h"
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+WEAK CpuFeatures halide_get_cpu_features() {
+    // RISC-V extensions are fixed at compile time via the target
+    // string; there are no runtime-detected Features.
+    const uint64_t known = 0;
+    const uint64_t available = 0;
+    CpuFeatures features = {known, available};
+    return features;
+}
+
+}}} // namespace Halide::Runtime::Internal
@@ -15,7 +15,10 @@
 // cat src/runtime/runtime_internal.h src/runtime/HalideRuntime*.h | grep "^[^ ][^(]*halide_[^ ]*(" | grep -v '#define' | sed "s/[^(]*halide/halide/" | sed "s/(.*//" | sed "s/^h/    \(void *)\&h/" | sed "s/$/,/" | sort | uniq
 
 extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
+    (void *)&halide_allocator_cache_set_size,
     (void *)&halide_buffer_copy,
+    (void *)&halide_buffer_mark_device_dirty_region,
+    (void *)&halide_buffer_mark_host_dirty_region,
     (void *)&halide_buffer_to_string,
     (void *)&halide_can_use_target_features,
     (void *)&halide_cond_broadcast,
@@ -29,11 +32,16 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_cuda_detach_device_ptr,
     (void *)&halide_cuda_device_interface,
     (void *)&halide_cuda_get_device_ptr,
+    (void *)&halide_cuda_host_free,
+    (void *)&halide_cuda_host_malloc,
     (void *)&halide_cuda_initialize_kernels,
     (void *)&halide_cuda_run,
+    (void *)&halide_cuda_use_managed_memory,
     (void *)&halide_cuda_wrap_device_ptr,
     (void *)&halide_current_time_ns,
     (void *)&halide_debug_to_file,
+    (void *)&halide_debug_to_file_flush,
+    (void *)&halide_debug_to_file_set_async,
     (void *)&halide_default_can_use_target_features,
     (void *)&halide_device_and_host_free,
     (void *)&halide_device_and_host_free_as_destructor,
@@ -47,6 +55,10 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_device_release,
     (void *)&halide_device_sync,
     (void *)&halide_device_sync_legacy,
+    (void *)&halide_device_warmup,
+    (void *)&halide_distributed_exchange,
+    (void *)&halide_distributed_rank,
+    (void *)&halide_distributed_size,
     (void *)&halide_do_par_for,
     (void *)&halide_do_task,
     (void *)&halide_double_to_string,
@@ -82,9 +94,11 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_float16_bits_to_double,
     (void *)&halide_float16_bits_to_float,
     (void *)&halide_free,
+    (void *)&halide_get_context_overrides,
     (void *)&halide_get_cpu_features,
     (void *)&halide_get_gpu_device,
     (void *)&halide_get_library_symbol,
+    (void *)&halide_get_num_threads,
     (void *)&halide_get_symbol,
     (void *)&halide_get_trace_file,
     (void *)&halide_hexagon_detach_device_handle,
@@ -96,6 +110,7 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_hexagon_power_hvx_off,
     (void *)&halide_hexagon_power_hvx_off_as_destructor,
     (void *)&halide_hexagon_power_hvx_on,
+    (void *)&halide_hexagon_release_unused_buffers,
     (void *)&halide_hexagon_run,
     (void *)&halide_hexagon_set_performance,
     (void *)&halide_hexagon_set_performance_mode,
@@ -106,23 +121,30 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_malloc,
     (void *)&halide_matlab_call_pipeline,
     (void *)&halide_memoization_cache_cleanup,
+    (void *)&halide_memoization_cache_detach,
+    (void *)&halide_memoization_cache_evict,
+    (void *)&halide_memoization_cache_get_stats,
     (void *)&halide_memoization_cache_lookup,
     (void *)&halide_memoization_cache_release,
+    (void *)&halide_memoization_cache_set_device_size,
     (void *)&halide_memoization_cache_set_size,
     (void *)&halide_memoization_cache_store,
     (void *)&halide_metal_acquire_context,
     (void *)&halide_metal_detach_buffer,
     (void *)&halide_metal_device_interface,
+    (void *)&halide_metal_enable_memory_pool,
     (void *)&halide_metal_get_buffer,
     (void *)&halide_metal_get_crop_offset,
     (void *)&halide_metal_initialize_kernels,
     (void *)&halide_metal_release_context,
+    (void *)&halide_metal_release_unused_memory,
     (void *)&halide_metal_run,
     (void *)&halide_metal_wrap_buffer,
     (void *)&halide_msan_annotate_buffer_is_initialized,
     (void *)&halide_msan_annotate_buffer_is_initialized_as_destructor,
     (void *)&halide_msan_annotate_memory_is_initialized,
     (void *)&halide_mutex_lock,
+    (void *)&halide_mutex_set_name,
     (void *)&halide_mutex_unlock,
     (void *)&halide_opencl_detach_cl_mem,
     (void *)&halide_opencl_device_interface,
@@ -139,30 +161,47 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_opengl_create_context,
     (void *)&halide_opengl_detach_texture,
     (void *)&halide_opengl_device_interface,
+    (void *)&halide_opengl_enable_memory_pool,
     (void *)&halide_opengl_get_proc_address,
     (void *)&halide_opengl_get_texture,
     (void *)&halide_opengl_initialize_kernels,
+    (void *)&halide_opengl_release_unused_memory,
     (void *)&halide_opengl_run,
     (void *)&halide_opengl_wrap_render_target,
     (void *)&halide_opengl_wrap_texture,
     (void *)&halide_openglcompute_device_interface,
+    (void *)&halide_openglcompute_enable_memory_pool,
     (void *)&halide_openglcompute_initialize_kernels,
+    (void *)&halide_openglcompute_release_unused_memory,
     (void *)&halide_openglcompute_run,
     (void *)&halide_pointer_to_string,
     (void *)&halide_print,
+    (void *)&halide_profiler_chrome_trace_report,
+    (void *)&halide_profiler_device_time,
     (void *)&halide_profiler_get_pipeline_state,
     (void *)&halide_profiler_get_state,
+    (void *)&halide_profiler_instance_state,
+    (void *)&halide_profiler_lock_contention_set_enabled,
+    (void *)&halide_profiler_marker_begin,
+    (void *)&halide_profiler_marker_end,
     (void *)&halide_profiler_memory_allocate,
     (void *)&halide_profiler_memory_free,
+    (void *)&halide_profiler_per_pipeline_disable,
+    (void *)&halide_profiler_per_pipeline_enable,
     (void *)&halide_profiler_pipeline_start,
     (void *)&halide_profiler_report,
     (void *)&halide_profiler_reset,
     (void *)&halide_profiler_stack_peak_update,
+    (void *)&halide_profiler_timeline_disable,
+    (void *)&halide_profiler_timeline_enable,
+    (void *)&halide_profiler_user_counter_add,
     (void *)&halide_qurt_hvx_lock,
     (void *)&halide_qurt_hvx_unlock,
     (void *)&halide_qurt_hvx_unlock_as_destructor,
     (void *)&halide_release_jit_module,
     (void *)&halide_set_custom_can_use_target_features,
+    (void *)&halide_set_context_overrides,
+    (void *)&halide_set_custom_distributed_exchange,
     (void *)&halide_set_custom_do_par_for,
     (void *)&halide_set_custom_do_task,
     (void *)&halide_set_custom_free,
@@ -172,9 +211,18 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_set_custom_malloc,
     (void *)&halide_set_custom_print,
     (void *)&halide_set_custom_trace,
+    (void *)&halide_set_distributed_topology,
     (void *)&halide_set_error_handler,
     (void *)&halide_set_gpu_device,
+    (void *)&halide_semaphore_acquire,
+    (void *)&halide_semaphore_allocate,
+    (void *)&halide_semaphore_free,
+    (void *)&halide_semaphore_init,
+    (void *)&halide_semaphore_release,
+    (void *)&halide_set_cpu_core_policy,
     (void *)&halide_set_num_threads,
+    (void *)&halide_set_task_priority,
+    (void *)&halide_set_thread_affinity,
     (void *)&halide_set_trace_file,
     (void *)&halide_shutdown_thread_pool,
     (void *)&halide_shutdown_trace,
@@ -182,8 +230,11 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_spawn_thread,
     (void *)&halide_start_clock,
     (void *)&halide_string_to_string,
+    (void *)&halide_thread_pool_startup,
     (void *)&halide_trace,
     (void *)&halide_trace_helper,
+    (void *)&halide_trace_set_func_filter,
+    (void *)&halide_trace_set_sample_rate,
     (void *)&halide_uint64_to_string,
     (void *)&halide_upgrade_buffer_t,
     (void *)&halide_use_jit_module,
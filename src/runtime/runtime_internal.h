@@ -78,8 +78,10 @@ int fileno(void *);
 int fclose(void *);
 int close(int);
 size_t fwrite(const void *, size_t, size_t, void *);
+size_t fread(void *, size_t, size_t, void *);
 ssize_t write(int fd, const void *buf, size_t bytes);
 int remove(const char *pathname);
+int rename(const char *oldname, const char *newname);
 int ioctl(int fd, unsigned long request, ...);
 void exit(int);
 void abort();
@@ -156,6 +158,14 @@ WEAK void halide_cond_signal(struct halide_cond *cond);
 WEAK void halide_cond_broadcast(struct halide_cond *cond);
 WEAK void halide_cond_wait(struct halide_cond *cond, struct halide_mutex *mutex);
 
+// Hooks into the opt-in contended-lock profiler in
+// synchronization_common.h. The profiler module installs a clock to
+// enable collection and reads the stats back out for its report.
+WEAK void halide_lock_profiler_set_clock(int64_t (*clock)(void *user_context));
+WEAK int halide_lock_profiler_get(int idx, uintptr_t *addr, const char **name,
+                                  uint64_t *acquires, uint64_t *contended_acquires,
+                                  uint64_t *wait_time_ns);
+
 WEAK int halide_trace_helper(void *user_context,
                              const char *func,
                              void *value, int *coords,
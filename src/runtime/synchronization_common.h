@@ -888,6 +888,15 @@ public:
         }
     }
 
+    // The uncontended fast path of lock(), exposed so the lock
+    // profiler below can tell contended acquisitions apart. May fail
+    // spuriously, which just charges a near-zero wait to the lock.
+    __attribute__((always_inline)) bool try_lock() {
+        uintptr_t expected = 0;
+        uintptr_t desired = lock_bit;
+        return atomic_cas_weak_acquire_relaxed(&state, &expected, &desired);
+    }
+
     bool make_parked_if_locked() {
         uintptr_t val;
         atomic_load_relaxed(&state, &val);
@@ -1074,6 +1083,54 @@ class fast_cond {
     }
 };
 
+// -- Contended-lock profiling --------------------------------------
+//
+// Opt-in instrumentation of halide_mutex_lock, recording per-lock
+// acquisition counts and time spent waiting on contended
+// acquisitions, so scaling problems can be attributed to a specific
+// lock (thread pool work queue, memoization shard, ...) from
+// halide_profiler_report. Collection lives here because this module is
+// linked into every runtime; the clock arrives via a function pointer,
+// set by halide_profiler_lock_contention_set_enabled in the profiler
+// module, so platforms without a clock never reference one. A null
+// clock means disabled, which costs one relaxed load and branch per
+// lock.
+struct lock_stats_entry {
+    uintptr_t addr;
+    const char *name;
+    uint64_t acquires;
+    uint64_t contended_acquires;
+    uint64_t wait_time_ns;
+};
+static const int num_lock_stats_entries = 64;
+WEAK lock_stats_entry lock_stats[num_lock_stats_entries];
+WEAK int64_t (*lock_profiler_clock)(void *user_context) = NULL;
+
+// Find or claim the stats entry for a lock, keyed by address, with
+// linear probing. Returns NULL if the table is full; such locks go
+// unrecorded rather than perturbing what we do record.
+WEAK lock_stats_entry *lock_stats_slot(uintptr_t addr) {
+    uintptr_t h = addr >> 4;
+    h *= (uintptr_t)2654435761u;
+    for (int i = 0; i < num_lock_stats_entries; i++) {
+        lock_stats_entry *entry = &lock_stats[(h + i) & (num_lock_stats_entries - 1)];
+        uintptr_t existing;
+        atomic_load_relaxed(&entry->addr, &existing);
+        if (existing == addr) {
+            return entry;
+        }
+        if (existing == 0) {
+            uintptr_t expected = 0;
+            uintptr_t desired = addr;
+            if (atomic_cas_weak_relaxed_relaxed(&entry->addr, &expected, &desired) ||
+                expected == addr) {
+                return entry;
+            }
+        }
+    }
+    return NULL;
+}
+
 }
 
 }}}
@@ -1083,7 +1140,25 @@ extern "C" {
 WEAK void halide_mutex_lock(halide_mutex *mutex) {
     Halide::Runtime::Internal::Synchronization::fast_mutex *fast_mutex =
         (Halide::Runtime::Internal::Synchronization::fast_mutex *)mutex;
+    using namespace Halide::Runtime::Internal::Synchronization;
+    int64_t (*clock)(void *) = lock_profiler_clock;
+    if (clock == NULL) {
+        fast_mutex->lock();
+        return;
+    }
+    lock_stats_entry *entry = lock_stats_slot((uintptr_t)mutex);
+    if (entry == NULL) {
+        fast_mutex->lock();
+        return;
+    }
+    __sync_fetch_and_add(&entry->acquires, (uint64_t)1);
+    if (fast_mutex->try_lock()) {
+        return;
+    }
+    int64_t start = clock(NULL);
     fast_mutex->lock();
+    __sync_fetch_and_add(&entry->contended_acquires, (uint64_t)1);
+    __sync_fetch_and_add(&entry->wait_time_ns, (uint64_t)(clock(NULL) - start));
 }
 
 WEAK void halide_mutex_unlock(halide_mutex *mutex) {
@@ -1112,4 +1187,90 @@ WEAK void halide_cond_wait(struct halide_cond *cond, struct halide_mutex *mutex)
    fast_cond->wait(fast_mutex);
 }
 
+// A counting semaphore built on the mutex and condvar above. The
+// public struct is opaque; this is what actually lives inside it.
+struct halide_semaphore_impl_t {
+    halide_mutex mutex;
+    halide_cond cond;
+    int count;
+};
+
+WEAK int halide_semaphore_init(halide_semaphore_t *s, int n) {
+    halide_semaphore_impl_t *sem = (halide_semaphore_impl_t *)s;
+    memset(sem, 0, sizeof(halide_semaphore_impl_t));
+    sem->count = n;
+    return n;
+}
+
+WEAK int halide_semaphore_release(halide_semaphore_t *s, int n) {
+    halide_semaphore_impl_t *sem = (halide_semaphore_impl_t *)s;
+    halide_mutex_lock(&sem->mutex);
+    int result = sem->count += n;
+    halide_cond_broadcast(&sem->cond);
+    halide_mutex_unlock(&sem->mutex);
+    return result;
+}
+
+WEAK int halide_semaphore_acquire(halide_semaphore_t *s, int n) {
+    halide_semaphore_impl_t *sem = (halide_semaphore_impl_t *)s;
+    halide_mutex_lock(&sem->mutex);
+    while (sem->count < n) {
+        halide_cond_wait(&sem->cond, &sem->mutex);
+    }
+    sem->count -= n;
+    halide_mutex_unlock(&sem->mutex);
+    return 0;
+}
+
+WEAK halide_semaphore_t *halide_semaphore_allocate(int n) {
+    halide_semaphore_t *sem =
+        (halide_semaphore_t *)halide_malloc(NULL, sizeof(halide_semaphore_t));
+    if (sem) {
+        halide_semaphore_init(sem, n);
+    }
+    return sem;
+}
+
+WEAK int halide_semaphore_free(halide_semaphore_t *sem) {
+    halide_free(NULL, sem);
+    return 0;
+}
+
+WEAK void halide_mutex_set_name(struct halide_mutex *mutex, const char *name) {
+    using namespace Halide::Runtime::Internal::Synchronization;
+    lock_stats_entry *entry = lock_stats_slot((uintptr_t)mutex);
+    if (entry) {
+        entry->name = name;
+    }
+}
+
+// Internal: installs (or clears) the clock used to time contended
+// acquisitions. See halide_profiler_lock_contention_set_enabled.
+WEAK void halide_lock_profiler_set_clock(int64_t (*clock)(void *user_context)) {
+    using namespace Halide::Runtime::Internal::Synchronization;
+    lock_profiler_clock = clock;
+}
+
+// Internal: reads one slot of the lock stats table, for the profiler's
+// report. Returns -1 for an out-of-range index, zero for an unused
+// slot, and one for a populated slot.
+WEAK int halide_lock_profiler_get(int idx, uintptr_t *addr, const char **name,
+                                  uint64_t *acquires, uint64_t *contended_acquires,
+                                  uint64_t *wait_time_ns) {
+    using namespace Halide::Runtime::Internal::Synchronization;
+    if (idx < 0 || idx >= num_lock_stats_entries) {
+        return -1;
+    }
+    lock_stats_entry *entry = &lock_stats[idx];
+    atomic_load_relaxed(&entry->addr, addr);
+    if (*addr == 0) {
+        return 0;
+    }
+    *name = entry->name;
+    *acquires = entry->acquires;
+    *contended_acquires = entry->contended_acquires;
+    *wait_time_ns = entry->wait_time_ns;
+    return 1;
+}
+
 }
@@ -2,15 +2,51 @@ extern "C" void * pthread_self();
 
 namespace Halide { namespace Runtime { namespace Internal {
 
+// A contiguous range of tasks belonging to a job. Each worker thread
+// preferentially drains its own chunk, and steals from the chunks of
+// other workers once its own is empty. Tasks are claimed with an
+// atomic fetch-and-add on 'next', so the fast path doesn't take the
+// work queue mutex.
+struct work_chunk {
+    int next, max;
+    // Claim a batch of 'grain' consecutive task indices. Returns the
+    // first index of the batch, which is max or greater if the chunk
+    // is empty. 'next' may overshoot max by up to grain - 1; empty()
+    // and the batch end must be clamped against max by the caller.
+    int claim(int grain) {
+        return __sync_fetch_and_add(&next, grain);
+    }
+    bool empty() const {
+        return next >= max;
+    }
+};
+
 struct work {
     work *next_job;
     int (*f)(void *, int, uint8_t *);
     void *user_context;
-    int next, max;
+    // The iteration space is divided into up to one chunk per worker
+    // so that threads mostly touch disjoint cache lines while
+    // claiming tasks.
+    work_chunk chunks[MAX_THREADS];
+    int num_chunks;
+    // Number of consecutive tasks claimed per atomic transaction, so
+    // that cheap loops with many iterations don't pay one atomic op
+    // and one indirect call per iteration.
+    int grain;
+    // Captured from the work queue's task_priority when the job was
+    // enqueued. Workers always work on the highest-priority job.
+    int priority;
     uint8_t *closure;
     int active_workers;
     int exit_status;
-    bool running() { return next < max || active_workers > 0; }
+    bool tasks_remaining() const {
+        for (int i = 0; i < num_chunks; i++) {
+            if (!chunks[i].empty()) return true;
+        }
+        return false;
+    }
+    bool running() const { return tasks_remaining() || active_workers > 0; }
 };
 
 // The work queue and thread pool is weak, so one big work queue is shared by all halide functions
@@ -21,11 +57,34 @@ struct work_queue_t {
     // The desired number threads doing work.
     int desired_num_threads;
 
+    // CPUs that worker threads may run on, as a bitmask. Zero words
+    // means unrestricted. Like desired_num_threads, this is
+    // configuration that survives a shutdown of the pool.
+    uint64_t affinity_mask[MAX_THREADS / 64];
+    int affinity_words;
+
+    // On heterogeneous hosts running with
+    // halide_cpu_core_policy_all_weighted, the first num_big_workers
+    // workers get full-sized chunks of each parallel loop, and the
+    // rest get chunks scaled by little_worker_weight (a percentage).
+    // Zero num_big_workers means no weighting. Configuration that
+    // survives a shutdown of the pool.
+    int num_big_workers;
+    int little_worker_weight;
+
+    // The priority given to jobs enqueued from now on. Like
+    // desired_num_threads, this is configuration that survives a
+    // shutdown of the pool.
+    int task_priority;
+
     // All fields after this must be zero in the initial state. See assert_zeroed
     // Field serves both to mark the offset in struct and as layout padding.
     int zero_marker;
 
-    // Singly linked list for job stack
+    // Singly linked list of outstanding jobs, ordered by decreasing
+    // priority, and as a stack among jobs of equal priority. The head
+    // is always a job of the highest priority present, so workers can
+    // just take the head.
     work *jobs;
 
     // Worker threads are divided into an 'A' team and a 'B' team. The
@@ -36,7 +95,17 @@ struct work_queue_t {
     // a_team_size < target_a_team_size.
     int a_team_size, target_a_team_size;
 
-    // Broadcast when a job completes.
+    // Number of job owners currently asleep waiting for their job to
+    // finish. An owner is a thread inside halide_do_par_for; rather
+    // than block while its job drains, it executes tasks from the
+    // head of the job list, and only sleeps when the list is
+    // empty. This count lets enqueuers wake sleeping owners when new
+    // jobs arrive, so nested parallel loops get the owners of the
+    // enclosing loops as extra workers instead of idle threads.
+    int owners_sleeping;
+
+    // Broadcast when a job completes, and when jobs are enqueued
+    // while owners are sleeping.
     halide_cond wakeup_owners;
 
     // Broadcast whenever items are added to the work queue.
@@ -107,7 +176,71 @@ WEAK int default_desired_num_threads() {
     return desired_num_threads;
 }
 
-WEAK void worker_thread_already_locked(work *owned_job) {
+#ifdef THREAD_POOL_MEASURED_SERIAL_PATH
+// Per-loop cost estimates for the serial fast path, direct-mapped by
+// the task function pointer. Entries are hints: reads and writes are
+// deliberately unsynchronized, and a lost update just means one extra
+// measurement.
+struct loop_cost_entry {
+    halide_task_t f;
+    uint64_t task_time_ns;
+};
+static const int num_loop_cost_entries = 64;
+WEAK loop_cost_entry loop_costs[num_loop_cost_entries];
+
+// Below this much predicted total work, waking workers costs more than
+// they can save, and the loop runs inline on the calling thread.
+static const uint64_t serial_work_threshold_ns = 100 * 1000;
+
+WEAK loop_cost_entry *loop_cost_slot(halide_task_t f) {
+    uintptr_t h = (uintptr_t)f;
+    h ^= h >> 12;
+    return &loop_costs[(h >> 4) & (num_loop_cost_entries - 1)];
+}
+
+// Fold a measurement into a loop's estimate. Grow it immediately (the
+// same loop can get more expensive, e.g. a larger extent captured in
+// the closure), but decay it slowly, so one slow run doesn't stick.
+WEAK void update_loop_cost(loop_cost_entry *cost, halide_task_t f, uint64_t per_task_ns) {
+    if (per_task_ns == 0) {
+        per_task_ns = 1;
+    }
+    if (cost->f != f || per_task_ns > cost->task_time_ns) {
+        cost->task_time_ns = per_task_ns;
+        cost->f = f;
+    } else {
+        cost->task_time_ns = (3 * cost->task_time_ns + per_task_ns) / 4;
+    }
+}
+#endif
+
+// Run tasks from the given job without holding the work queue
+// mutex. The worker drains the chunk it owns first, then steals from
+// the other workers' chunks. Returns the exit status of the first
+// failing task, or zero.
+WEAK int run_tasks_from_job(work *job, int worker_id) {
+    int result = 0;
+    for (int i = 0; i < job->num_chunks && result == 0; i++) {
+        work_chunk *chunk = &job->chunks[(worker_id + i) % job->num_chunks];
+        while (result == 0) {
+            int task = chunk->claim(job->grain);
+            if (task >= chunk->max) {
+                // Chunk drained (possibly by a concurrent claim). Move
+                // on to stealing from the next worker's chunk.
+                break;
+            }
+            int end = task + job->grain;
+            if (end > chunk->max) end = chunk->max;
+            for (; task < end && result == 0; task++) {
+                result = halide_do_task(job->user_context, job->f, task,
+                                        job->closure);
+            }
+        }
+    }
+    return result;
+}
+
+WEAK void worker_thread_already_locked(work *owned_job, int worker_id) {
     // If I'm a job owner, then I was the thread that called
     // do_par_for, and I should only stay in this function until my
     // job is complete. If I'm a lowly worker thread, I should stay in
@@ -118,8 +251,13 @@ WEAK void worker_thread_already_locked(work *owned_job) {
         if (work_queue.jobs == NULL) {
             if (owned_job) {
                 // There are no jobs pending. Wait for the last worker
-                // to signal that the job is finished.
+                // to signal that the job is finished, or for new jobs
+                // to be enqueued: a nested parallel loop launched by
+                // one of this job's straggler tasks should get this
+                // thread as a worker, not leave it blocked here.
+                work_queue.owners_sleeping++;
                 halide_cond_wait(&work_queue.wakeup_owners, &work_queue.mutex);
+                work_queue.owners_sleeping--;
             } else if (work_queue.a_team_size <= work_queue.target_a_team_size) {
                 // There are no jobs pending. Wait until more jobs are enqueued.
                 halide_cond_wait(&work_queue.wakeup_a_team, &work_queue.mutex);
@@ -135,28 +273,20 @@ WEAK void worker_thread_already_locked(work *owned_job) {
             // Grab the next job.
             work *job = work_queue.jobs;
 
-            // Claim a task from it.
-            work myjob = *job;
-            job->next++;
-
-            // If there were no more tasks pending for this job,
-            // remove it from the stack.
-            if (job->next == job->max) {
-                work_queue.jobs = job->next_job;
-            }
-
             // Increment the active_worker count so that other threads
             // are aware that this job is still in progress even
-            // though there are no outstanding tasks for it.
+            // though there may be no unclaimed tasks for it.
             job->active_workers++;
 
-            // Release the lock and do the task.
+            // Release the lock and work on the job until its tasks
+            // are exhausted. Tasks are claimed with atomic ops, so
+            // the queue mutex is untouched while there is work to
+            // steal.
             halide_mutex_unlock(&work_queue.mutex);
-            int result = halide_do_task(myjob.user_context, myjob.f, myjob.next,
-                                        myjob.closure);
+            int result = run_tasks_from_job(job, worker_id);
             halide_mutex_lock(&work_queue.mutex);
 
-            // If this task failed, set the exit status on the job.
+            // If a task failed, set the exit status on the job.
             if (result) {
                 job->exit_status = result;
             }
@@ -164,6 +294,13 @@ WEAK void worker_thread_already_locked(work *owned_job) {
             // We are no longer active on this job
             job->active_workers--;
 
+            // If all the job's tasks have been claimed, remove it
+            // from the stack so that idle threads go to sleep instead
+            // of spinning over it.
+            if (work_queue.jobs == job && !job->tasks_remaining()) {
+                work_queue.jobs = job->next_job;
+            }
+
             // If the job is done and I'm not the owner of it, wake up
             // the owner.
             if (!job->running() && job != owned_job) {
@@ -173,12 +310,55 @@ WEAK void worker_thread_already_locked(work *owned_job) {
     }
 }
 
-WEAK void worker_thread(void *) {
+WEAK void worker_thread(void *arg) {
+    int worker_id = (int)(intptr_t)arg;
     halide_mutex_lock(&work_queue.mutex);
-    worker_thread_already_locked(NULL);
+    if (work_queue.affinity_words) {
+        halide_host_cpu_set_affinity(work_queue.affinity_mask,
+                                     work_queue.affinity_words);
+    }
+    worker_thread_already_locked(NULL, worker_id);
     halide_mutex_unlock(&work_queue.mutex);
 }
 
+// Bring the thread pool up to its desired size. Called with the work
+// queue lock held, both on the first parallel loop and from
+// halide_thread_pool_startup.
+WEAK void grow_thread_pool_already_locked() {
+    if (!work_queue.initialized) {
+        work_queue.assert_zeroed();
+
+        // Compute the desired number of threads to use. Other code
+        // can also mess with this value, but only when the work queue
+        // is locked.
+        if (!work_queue.desired_num_threads) {
+            work_queue.desired_num_threads = default_desired_num_threads();
+        }
+        work_queue.desired_num_threads = clamp_num_threads(work_queue.desired_num_threads);
+        work_queue.threads_created = 0;
+
+        // Everyone starts on the a team.
+        work_queue.a_team_size = work_queue.desired_num_threads;
+
+        // Label the queue lock for the contended-lock section of
+        // halide_profiler_report.
+        halide_mutex_set_name(&work_queue.mutex, "thread pool work queue");
+
+        work_queue.initialized = true;
+    }
+
+    while (work_queue.threads_created < work_queue.desired_num_threads - 1) {
+        // We might need to make some new threads, if work_queue.desired_num_threads has
+        // increased.
+        // Worker ids start at one; the thread that called
+        // do_par_for participates as worker zero.
+        work_queue.threads[work_queue.threads_created] =
+            halide_spawn_thread(worker_thread,
+                                (void *)(intptr_t)(work_queue.threads_created + 1));
+        work_queue.threads_created++;
+    }
+}
+
 WEAK halide_do_task_t custom_do_task = halide_default_do_task;
 WEAK halide_do_par_for_t custom_do_par_for = halide_default_do_par_for;
 
@@ -207,44 +387,86 @@ WEAK int halide_default_do_par_for(void *user_context, halide_task_t f,
         return 0;
     }
 
+#ifdef THREAD_POOL_MEASURED_SERIAL_PATH
+    // Fast serial path: if a previous run of this same loop measured
+    // its per-task cost, and the predicted total is below what a round
+    // of worker wake-ups costs, run the tasks inline without touching
+    // the work queue. Single-task loops have nothing to distribute and
+    // always run inline; their first run provides the measurement.
+    loop_cost_entry *cost = loop_cost_slot(f);
+    bool cost_known = (cost->f == f && cost->task_time_ns > 0);
+    if (size == 1 ||
+        (cost_known &&
+         (uint64_t)size * cost->task_time_ns < serial_work_threshold_ns)) {
+        int64_t serial_start = halide_current_time_ns(user_context);
+        int result = 0;
+        for (int i = min; i < min + size && result == 0; i++) {
+            result = halide_do_task(user_context, f, i, closure);
+        }
+        uint64_t elapsed = (uint64_t)(halide_current_time_ns(user_context) - serial_start);
+        update_loop_cost(cost, f, elapsed / (uint64_t)size);
+        return result;
+    }
+    int64_t parallel_start = halide_current_time_ns(user_context);
+#endif
+
     // Grab the lock. If it hasn't been initialized yet, then the
     // field will be zero-initialized because it's a static global.
     halide_mutex_lock(&work_queue.mutex);
 
-    if (!work_queue.initialized) {
-        work_queue.assert_zeroed();
-
-        // Compute the desired number of threads to use. Other code
-        // can also mess with this value, but only when the work queue
-        // is locked.
-        if (!work_queue.desired_num_threads) {
-            work_queue.desired_num_threads = default_desired_num_threads();
-        }
-        work_queue.desired_num_threads = clamp_num_threads(work_queue.desired_num_threads);
-        work_queue.threads_created = 0;
-
-        // Everyone starts on the a team.
-        work_queue.a_team_size = work_queue.desired_num_threads;
-
-        work_queue.initialized = true;
-    }
-
-    while (work_queue.threads_created < work_queue.desired_num_threads - 1) {
-        // We might need to make some new threads, if work_queue.desired_num_threads has
-        // increased.
-        work_queue.threads[work_queue.threads_created++] =
-            halide_spawn_thread(worker_thread, NULL);
-    }
+    grow_thread_pool_already_locked();
 
     // Make the job.
     work job;
     job.f = f;               // The job should call this function. It takes an index and a closure.
     job.user_context = user_context;
-    job.next = min;          // Start at this index.
-    job.max  = min + size;   // Keep going until one less than this index.
     job.closure = closure;   // Use this closure.
     job.exit_status = 0;     // The job hasn't failed yet
     job.active_workers = 0;  // Nobody is working on this yet
+    job.priority = work_queue.task_priority;
+
+    // Divide the tasks into one contiguous chunk per thread that
+    // might participate. Each worker owns one chunk and steals from
+    // the others once its own is empty, which keeps threads claiming
+    // tasks from disjoint cache lines in the common case.
+    int num_chunks = work_queue.desired_num_threads;
+    if (num_chunks > size) num_chunks = size;
+    job.num_chunks = num_chunks;
+    if (work_queue.num_big_workers > 0 &&
+        work_queue.num_big_workers < num_chunks) {
+        // Heterogeneous cores: give the workers expected to land on
+        // little cores proportionally smaller chunks, so the big
+        // cores don't sit in the stealing path from the start. Work
+        // stealing still corrects any residual imbalance.
+        int little_weight = work_queue.little_worker_weight;
+        if (little_weight < 1) little_weight = 1;
+        int64_t total_weight =
+            (int64_t)work_queue.num_big_workers * 100 +
+            (int64_t)(num_chunks - work_queue.num_big_workers) * little_weight;
+        int64_t acc = 0;
+        int start = min;
+        for (int i = 0; i < num_chunks; i++) {
+            acc += (i < work_queue.num_big_workers) ? 100 : little_weight;
+            int end = min + (int)(((int64_t)size * acc) / total_weight);
+            job.chunks[i].next = start;
+            job.chunks[i].max = end;
+            start = end;
+        }
+    } else {
+        for (int i = 0; i < num_chunks; i++) {
+            job.chunks[i].next = min + (int)(((int64_t)size * i) / num_chunks);
+            job.chunks[i].max = min + (int)(((int64_t)size * (i + 1)) / num_chunks);
+        }
+    }
+
+    // Batch consecutive tasks so that each chunk is claimed in about
+    // eight transactions. That bounds the atomic-op and call overhead
+    // for cheap loops with many iterations, while leaving enough
+    // batches per chunk for work stealing to balance the load. Tasks
+    // that need finer- or coarser-grained distribution can split the
+    // loop explicitly in the schedule.
+    job.grain = size / (num_chunks * 8);
+    if (job.grain < 1) job.grain = 1;
 
     if (!work_queue.jobs && size < work_queue.desired_num_threads) {
         // If there's no nested parallelism happening and there are
@@ -260,12 +482,41 @@ WEAK int halide_default_do_par_for(void *user_context, halide_task_t f,
         work_queue.target_a_team_size = work_queue.desired_num_threads;
     }
 
-    // Push the job onto the stack.
-    job.next_job = work_queue.jobs;
-    work_queue.jobs = &job;
+    // Insert the job ahead of the first job with strictly lower
+    // priority. Equal-priority jobs behave as a stack, which keeps
+    // jobs enqueued from within a parallel loop ahead of the loop
+    // that spawned them. Workers preempt at task granularity: threads
+    // busy on a lower-priority job switch to the new head after
+    // finishing their current batch of tasks.
+    work **prev = &work_queue.jobs;
+    while (*prev && (*prev)->priority > job.priority) {
+        prev = &(*prev)->next_job;
+    }
+    job.next_job = *prev;
+    *prev = &job;
+
+    // Wake up the A team, but only as many workers as there are chunks
+    // of this job left after the owner takes one itself: a broadcast
+    // would wake the whole team just for most of it to find nothing to
+    // claim and go back to sleep. Signals with no sleeper are lost,
+    // which is fine -- any thread already awake will see this job on
+    // the queue anyway.
+    if (num_chunks - 1 >= work_queue.a_team_size) {
+        halide_cond_broadcast(&work_queue.wakeup_a_team);
+    } else {
+        for (int i = 1; i < num_chunks; i++) {
+            halide_cond_signal(&work_queue.wakeup_a_team);
+        }
+    }
 
-    // Wake up our A team.
-    halide_cond_broadcast(&work_queue.wakeup_a_team);
+    // Also wake any owners asleep waiting for their own jobs: they
+    // are ready threads, and putting them to work on this job keeps
+    // nested parallelism running on exactly the desired number of
+    // threads instead of leaving enclosing-loop owners blocked while
+    // their stragglers spawn inner loops.
+    if (work_queue.owners_sleeping) {
+        halide_cond_broadcast(&work_queue.wakeup_owners);
+    }
 
     // If there are fewer threads than we would like on the a team,
     // wake up the b team too.
@@ -274,15 +525,40 @@ WEAK int halide_default_do_par_for(void *user_context, halide_task_t f,
     }
 
     // Do some work myself.
-    worker_thread_already_locked(&job);
+    worker_thread_already_locked(&job, 0);
+
+    // The job is done, but it may still be linked into the job list
+    // if it was passed over in favor of higher-priority work. Unlink
+    // it before this stack frame disappears.
+    for (work **prev = &work_queue.jobs; *prev; prev = &(*prev)->next_job) {
+        if (*prev == &job) {
+            *prev = job.next_job;
+            break;
+        }
+    }
 
     halide_mutex_unlock(&work_queue.mutex);
 
+#ifdef THREAD_POOL_MEASURED_SERIAL_PATH
+    // Record what this loop cost so that a future small realization of
+    // it can run inline. A serial run could not beat the parallel
+    // elapsed time times the number of participating chunks, so this
+    // over-estimate errs toward staying parallel.
+    uint64_t elapsed = (uint64_t)(halide_current_time_ns(user_context) - parallel_start);
+    update_loop_cost(cost, f, elapsed * (uint64_t)num_chunks / (uint64_t)size);
+#endif
+
     // Return zero if the job succeeded, otherwise return the exit
     // status of one of the failing jobs (whichever one failed last).
     return job.exit_status;
 }
 
+WEAK void halide_thread_pool_startup() {
+    halide_mutex_lock(&work_queue.mutex);
+    grow_thread_pool_already_locked();
+    halide_mutex_unlock(&work_queue.mutex);
+}
+
 WEAK int halide_set_num_threads(int n) {
     if (n < 0) {
         halide_error(NULL, "halide_set_num_threads: must be >= 0.");
@@ -300,6 +576,88 @@ WEAK int halide_set_num_threads(int n) {
     return old;
 }
 
+WEAK int halide_get_num_threads() {
+    halide_mutex_lock(&work_queue.mutex);
+    int n = work_queue.desired_num_threads;
+    halide_mutex_unlock(&work_queue.mutex);
+    if (n == 0) {
+        // The thread pool hasn't been initialized yet.
+        n = clamp_num_threads(default_desired_num_threads());
+    }
+    return n;
+}
+
+WEAK int halide_set_task_priority(int priority) {
+    halide_mutex_lock(&work_queue.mutex);
+    int old = work_queue.task_priority;
+    work_queue.task_priority = priority;
+    halide_mutex_unlock(&work_queue.mutex);
+    return old;
+}
+
+WEAK int halide_set_thread_affinity(const uint64_t *mask, int words) {
+    if (words > MAX_THREADS / 64) {
+        halide_error(NULL, "halide_set_thread_affinity: mask too large.");
+        return -1;
+    }
+    if (mask == NULL || words < 0) {
+        words = 0;
+    }
+    halide_mutex_lock(&work_queue.mutex);
+    work_queue.affinity_words = words;
+    for (int i = 0; i < words; i++) {
+        work_queue.affinity_mask[i] = mask[i];
+    }
+    int result = 0;
+    if (words) {
+        // Pin the calling thread too: it participates in parallel
+        // loops as worker zero. This also tells us whether the
+        // platform supports affinity at all.
+        result = halide_host_cpu_set_affinity(work_queue.affinity_mask, words);
+    }
+    halide_mutex_unlock(&work_queue.mutex);
+    return result;
+}
+
+WEAK int halide_set_cpu_core_policy(int policy) {
+    uint64_t big_mask[MAX_THREADS / 64];
+    int little_ratio = 0;
+    int num_big = halide_host_cpu_big_cores(big_mask, MAX_THREADS / 64,
+                                            &little_ratio);
+    if (num_big == 0 && policy != halide_cpu_core_policy_all) {
+        // Homogeneous (or unknown) topology: every policy degrades to
+        // treating all cores equally.
+        policy = halide_cpu_core_policy_all;
+    }
+    switch (policy) {
+    case halide_cpu_core_policy_all:
+        halide_set_thread_affinity(NULL, 0);
+        halide_mutex_lock(&work_queue.mutex);
+        work_queue.num_big_workers = 0;
+        halide_mutex_unlock(&work_queue.mutex);
+        halide_set_num_threads(0);
+        return 0;
+    case halide_cpu_core_policy_big_only: {
+        halide_mutex_lock(&work_queue.mutex);
+        work_queue.num_big_workers = 0;
+        halide_mutex_unlock(&work_queue.mutex);
+        int result = halide_set_thread_affinity(big_mask, MAX_THREADS / 64);
+        halide_set_num_threads(num_big);
+        return result;
+    }
+    case halide_cpu_core_policy_all_weighted:
+        halide_set_thread_affinity(NULL, 0);
+        halide_set_num_threads(0);
+        halide_mutex_lock(&work_queue.mutex);
+        work_queue.num_big_workers = num_big;
+        work_queue.little_worker_weight = little_ratio;
+        halide_mutex_unlock(&work_queue.mutex);
+        return 0;
+    }
+    halide_error(NULL, "halide_set_cpu_core_policy: unknown policy.");
+    return -1;
+}
+
 WEAK void halide_shutdown_thread_pool() {
     if (work_queue.initialized) {
         // Wake everyone up and tell them the party's over and it's time
@@ -335,12 +693,20 @@ WEAK halide_do_par_for_t halide_set_custom_do_par_for(halide_do_par_for_t f) {
 
 WEAK int halide_do_task(void *user_context, halide_task_t f, int idx,
                         uint8_t *closure) {
+    const halide_runtime_overrides_t *ovr = halide_get_context_overrides(user_context);
+    if (ovr && ovr->custom_do_task) {
+        return ovr->custom_do_task(user_context, f, idx, closure);
+    }
     return (*custom_do_task)(user_context, f, idx, closure);
 }
 
 WEAK int halide_do_par_for(void *user_context, halide_task_t f,
                            int min, int size, uint8_t *closure) {
-  return (*custom_do_par_for)(user_context, f, min, size, closure);
+    const halide_runtime_overrides_t *ovr = halide_get_context_overrides(user_context);
+    if (ovr && ovr->custom_do_par_for) {
+        return ovr->custom_do_par_for(user_context, f, min, size, closure);
+    }
+    return (*custom_do_par_for)(user_context, f, min, size, closure);
 }
 
 }
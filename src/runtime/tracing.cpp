@@ -70,6 +70,11 @@ public:
 
 const static int buffer_size = 1024 * 1024;
 
+// Write a block of packets to the trace file, maintaining the trace
+// index along the way. Only ever called from the writer thread (or
+// after it has been joined), so the index state needs no locking.
+WEAK bool trace_file_write(void *user_context, int fd, uint8_t *buf, uint32_t size);
+
 class TraceBuffer {
     SharedExclusiveSpinLock lock;
     uint32_t cursor, overage;
@@ -103,7 +108,7 @@ public:
         bool success = true;
         if (cursor) {
             cursor -= overage;
-            success = (cursor == (uint32_t)write(fd, buf, cursor));
+            success = trace_file_write(user_context, fd, buf, cursor);
             cursor = 0;
             overage = 0;
         }
@@ -111,18 +116,13 @@ public:
         halide_assert(user_context, success && "Could not write to trace file");
     }
 
-    // Acquire and return a packet's worth of space in the trace
-    // buffer, flushing the trace buffer to the given fd to make space
-    // if necessary. The region acquired is protected from other
-    // threads writing or reading to it, so it must be released before
-    // a flush can occur.
-    __attribute__((always_inline)) halide_trace_packet_t *acquire_packet(void *user_context, int fd, uint32_t size) {
-        halide_trace_packet_t *packet = NULL;
-        while (!(packet = try_acquire_packet(user_context, size))) {
-            // Couldn't acquire space to write a packet. Flush and try again.
-            flush(user_context, fd);
-        }
-        return packet;
+    // Attempt to acquire and return a packet's worth of space in the
+    // trace buffer. Returns NULL if the buffer is full; the caller is
+    // responsible for arranging a flush and retrying. The region
+    // acquired is protected from other threads writing or reading to
+    // it, so it must be released before a flush can occur.
+    __attribute__((always_inline)) halide_trace_packet_t *acquire_packet(void *user_context, uint32_t size) {
+        return try_acquire_packet(user_context, size);
     }
 
     // Release a packet, allowing it to be written out with flush
@@ -132,15 +132,465 @@ public:
         lock.release_shared();
     }
 
+    // Does the given packet point into this buffer?
+    __attribute__((always_inline)) bool owns(const halide_trace_packet_t *packet) const {
+        return ((const uint8_t *)packet >= buf &&
+                (const uint8_t *)packet < buf + buffer_size);
+    }
+
     TraceBuffer() : cursor(0), overage(0) {}
 };
 
-WEAK TraceBuffer *halide_trace_buffer = NULL;
+// We double-buffer: threads running the pipeline write packets into
+// one buffer while a background thread drains the other to the trace
+// file, so tracing threads never block on file I/O unless the writer
+// falls a whole buffer behind.
+WEAK TraceBuffer *halide_trace_buffers[2] = {NULL, NULL};
+WEAK int halide_trace_active_buffer = 0;
+WEAK bool halide_trace_buffer_pending[2] = {false, false};
+WEAK bool halide_trace_writer_shutdown = false;
+WEAK halide_mutex halide_trace_writer_lock;
+WEAK halide_cond halide_trace_writer_wakeup;
+WEAK halide_cond halide_trace_buffer_drained;
+WEAK halide_thread *halide_trace_writer = NULL;
 WEAK int halide_trace_file = -1; // -1 indicates uninitialized
 WEAK int halide_trace_file_lock = 0;
 WEAK bool halide_trace_file_initialized = false;
 WEAK void *halide_trace_file_internally_opened = NULL;
 
+// State for the trace index. Sync packets are only written when we
+// opened the trace file ourselves, so the packet offsets we record
+// are real file offsets. All of this is owned by the writer thread.
+WEAK bool halide_trace_index_enabled = false;
+WEAK uint64_t halide_trace_bytes_written = 0;
+WEAK uint64_t halide_trace_bytes_at_last_sync = 0;
+WEAK uint64_t halide_trace_last_sync_offset = (uint64_t)(-1);
+WEAK uint64_t halide_trace_last_packet_id = 0;
+// How many bytes of packets to write between sync packets.
+WEAK uint64_t halide_trace_sync_interval = 4 * 1024 * 1024;
+
+// The funcs seen in the trace so far, with the offset of the first
+// packet that mentioned each. Every sync packet carries the whole
+// table, so readers only need the last one.
+struct trace_func_entry {
+    trace_func_entry *next;
+    uint64_t first_offset;
+    char name[1]; // Actually variable-length
+};
+WEAK trace_func_entry *halide_trace_funcs = NULL;
+
+WEAK void record_trace_func(const char *name, uint64_t offset) {
+    for (trace_func_entry *e = halide_trace_funcs; e; e = e->next) {
+        if (strcmp(e->name, name) == 0) {
+            return;
+        }
+    }
+    size_t len = strlen(name);
+    trace_func_entry *e = (trace_func_entry *)malloc(sizeof(trace_func_entry) + len);
+    if (!e) {
+        return;
+    }
+    e->next = halide_trace_funcs;
+    e->first_offset = offset;
+    memcpy(e->name, name, len + 1);
+    halide_trace_funcs = e;
+}
+
+namespace {
+__attribute__((always_inline)) void poke_u32(uint8_t *dst, uint32_t val) {
+    memcpy(dst, &val, sizeof(val));
+}
+__attribute__((always_inline)) void poke_u64(uint8_t *dst, uint64_t val) {
+    memcpy(dst, &val, sizeof(val));
+}
+}
+
+// Append a sync packet holding the func table to the trace file. Sync
+// packets must fit in the 4096-byte packet size limit the tools
+// assume, so the table is truncated if there are a very large number
+// of funcs.
+WEAK bool write_sync_packet(void *user_context, int fd) {
+    const uint32_t max_packet_size = 4096;
+    uint8_t buf[max_packet_size];
+    uint32_t header_bytes = (uint32_t)sizeof(halide_trace_packet_t);
+    // header, payload, empty func name, empty trace tag
+    uint32_t cursor = header_bytes;
+
+    poke_u64(buf + cursor, halide_trace_last_sync_offset);
+    cursor += 8;
+    poke_u64(buf + cursor, halide_trace_bytes_written);
+    cursor += 8;
+    poke_u64(buf + cursor, halide_trace_last_packet_id);
+    cursor += 8;
+    uint32_t count_pos = cursor;
+    cursor += 4;
+
+    uint32_t num_funcs = 0;
+    for (trace_func_entry *e = halide_trace_funcs; e; e = e->next) {
+        uint32_t entry_bytes = 8 + (uint32_t)strlen(e->name) + 1;
+        // Leave room for the two empty strings and padding below.
+        if (cursor + entry_bytes + 8 > max_packet_size) {
+            break;
+        }
+        poke_u64(buf + cursor, e->first_offset);
+        cursor += 8;
+        memcpy(buf + cursor, e->name, entry_bytes - 8);
+        cursor += entry_bytes - 8;
+        num_funcs++;
+    }
+    poke_u32(buf + count_pos, num_funcs);
+
+    uint32_t payload_bytes = cursor - header_bytes;
+    buf[cursor++] = 0; // func name
+    buf[cursor++] = 0; // trace tag
+    uint32_t total_size = (cursor + 3) & ~3;
+    while (cursor < total_size) {
+        buf[cursor++] = 0;
+    }
+
+    halide_trace_packet_t *packet = (halide_trace_packet_t *)buf;
+    packet->size = total_size;
+    packet->id = 0;
+    packet->type.code = halide_type_uint;
+    packet->type.bits = 8;
+    packet->type.lanes = (uint16_t)payload_bytes;
+    packet->event = halide_trace_sync;
+    packet->parent_id = 0;
+    packet->value_index = 0;
+    packet->dimensions = 0;
+
+    bool success = (total_size == (uint32_t)write(fd, buf, total_size));
+    halide_trace_last_sync_offset = halide_trace_bytes_written;
+    halide_trace_bytes_written += total_size;
+    halide_trace_bytes_at_last_sync = halide_trace_bytes_written;
+    return success;
+}
+
+WEAK bool trace_file_write(void *user_context, int fd, uint8_t *buf, uint32_t size) {
+    if (halide_trace_index_enabled) {
+        // Note the first packet that mentions each func, and the
+        // highest packet id flushed so far, for the next sync packet.
+        uint32_t off = 0;
+        while (off + sizeof(halide_trace_packet_t) <= size) {
+            halide_trace_packet_t *packet = (halide_trace_packet_t *)(buf + off);
+            if (packet->size < sizeof(halide_trace_packet_t) ||
+                off + packet->size > size) {
+                break;
+            }
+            if ((uint64_t)packet->id > halide_trace_last_packet_id) {
+                halide_trace_last_packet_id = (uint64_t)packet->id;
+            }
+            const char *name = packet->func();
+            if (*name) {
+                record_trace_func(name, halide_trace_bytes_written + off);
+            }
+            off += packet->size;
+        }
+    }
+
+    bool success = (size == (uint32_t)write(fd, buf, size));
+    halide_trace_bytes_written += size;
+
+    if (halide_trace_index_enabled && success &&
+        halide_trace_bytes_written - halide_trace_bytes_at_last_sync >= halide_trace_sync_interval) {
+        success = write_sync_packet(user_context, fd);
+    }
+    return success;
+}
+
+// The background thread that drains filled trace buffers to the
+// trace file. All writes to the file funnel through here, so packets
+// hit the file in drain order.
+WEAK void trace_writer_thread(void *) {
+    halide_mutex_lock(&halide_trace_writer_lock);
+    while (1) {
+        int idx = -1;
+        for (int i = 0; i < 2; i++) {
+            if (halide_trace_buffer_pending[i]) {
+                idx = i;
+            }
+        }
+        if (idx < 0) {
+            if (halide_trace_writer_shutdown) {
+                break;
+            }
+            halide_cond_wait(&halide_trace_writer_wakeup, &halide_trace_writer_lock);
+            continue;
+        }
+        int fd = halide_trace_file;
+        halide_mutex_unlock(&halide_trace_writer_lock);
+        halide_trace_buffers[idx]->flush(NULL, fd);
+        halide_mutex_lock(&halide_trace_writer_lock);
+        halide_trace_buffer_pending[idx] = false;
+        halide_cond_broadcast(&halide_trace_buffer_drained);
+    }
+    halide_mutex_unlock(&halide_trace_writer_lock);
+}
+
+// Lazily allocate the trace buffers and start the writer thread. Must
+// be called with a valid fd before writing any packets.
+WEAK void ensure_trace_writer_started(void *user_context) {
+    halide_mutex_lock(&halide_trace_writer_lock);
+    if (!halide_trace_writer) {
+        for (int i = 0; i < 2; i++) {
+            if (!halide_trace_buffers[i]) {
+                // The buffers are not constructed, just zeroed, which
+                // gives the cursor, overage, and lock their initial
+                // states.
+                halide_trace_buffers[i] = (TraceBuffer *)malloc(sizeof(TraceBuffer));
+                halide_assert(user_context, halide_trace_buffers[i] && "Could not allocate trace buffer");
+                memset((void *)halide_trace_buffers[i], 0, sizeof(TraceBuffer));
+            }
+        }
+        halide_trace_writer_shutdown = false;
+        halide_trace_writer = halide_spawn_thread(trace_writer_thread, NULL);
+    }
+    halide_mutex_unlock(&halide_trace_writer_lock);
+}
+
+// Acquire a packet's worth of space in the active trace buffer. If
+// the active buffer is full, hand it to the writer thread and switch
+// to the other one rather than draining it on this thread.
+WEAK halide_trace_packet_t *acquire_trace_packet(void *user_context, uint32_t size) {
+    while (1) {
+        int idx = halide_trace_active_buffer;
+        halide_trace_packet_t *packet =
+            halide_trace_buffers[idx]->acquire_packet(user_context, size);
+        if (packet) {
+            return packet;
+        }
+        halide_mutex_lock(&halide_trace_writer_lock);
+        if (halide_trace_active_buffer == idx) {
+            // Wait until the other buffer has been drained before
+            // reusing it. This is the only point at which tracing
+            // threads can stall on I/O, and it only happens if
+            // packets are produced faster than the writer thread can
+            // retire an entire buffer.
+            int other = idx ^ 1;
+            while (halide_trace_buffer_pending[other]) {
+                halide_cond_wait(&halide_trace_buffer_drained, &halide_trace_writer_lock);
+            }
+            halide_trace_buffer_pending[idx] = true;
+            halide_trace_active_buffer = other;
+            halide_cond_broadcast(&halide_trace_writer_wakeup);
+        }
+        halide_mutex_unlock(&halide_trace_writer_lock);
+    }
+}
+
+// Release a packet back to whichever buffer it was acquired from. The
+// active buffer may have changed since the packet was acquired.
+WEAK void release_trace_packet(halide_trace_packet_t *packet) {
+    for (int i = 0; i < 2; i++) {
+        if (halide_trace_buffers[i]->owns(packet)) {
+            halide_trace_buffers[i]->release_packet(packet);
+            return;
+        }
+    }
+}
+
+// ---------- Trace filtering and sampling ----------
+//
+// Pipelines compiled with the trace_stores/trace_loads target
+// features instrument every Func, which makes full traces enormous
+// and means tracing a single suspect stage requires a recompile. The
+// state below lets the decision be made at runtime instead: a filter
+// over which Funcs get traced, and a sampling rate so that only every
+// Nth realization of a Func is traced. Both are consulted by
+// halide_trace before events are dispatched, so they also apply to
+// custom trace handlers.
+
+// The filter is a list of func names; a trailing '*' in a name
+// matches any suffix, which is useful for catching the stages of a
+// Func. Empty filter means trace everything.
+struct trace_filter_entry {
+    trace_filter_entry *next;
+    char name[1]; // Actually variable-length
+};
+WEAK trace_filter_entry *halide_trace_func_filter = NULL;
+WEAK int halide_trace_sample_rate = 1;
+WEAK bool halide_trace_filter_env_checked = false;
+volatile int WEAK halide_trace_filter_lock = 0;
+
+// Per-func realization counters for sampling, and whether the current
+// realization of each func is being suppressed.
+struct trace_sample_entry {
+    trace_sample_entry *next;
+    uint64_t count;
+    bool suppressed;
+    char name[1]; // Actually variable-length
+};
+WEAK trace_sample_entry *halide_trace_sample_funcs = NULL;
+
+// Must be called with the filter lock held.
+WEAK void clear_trace_func_filter() {
+    while (halide_trace_func_filter) {
+        trace_filter_entry *next = halide_trace_func_filter->next;
+        free(halide_trace_func_filter);
+        halide_trace_func_filter = next;
+    }
+}
+
+// Split a comma- or semicolon-separated list of func names into
+// filter entries. Must be called with the filter lock held.
+WEAK void parse_trace_func_filter(const char *funcs) {
+    clear_trace_func_filter();
+    const char *start = funcs;
+    while (start && *start) {
+        const char *end = start;
+        while (*end && *end != ',' && *end != ';') {
+            end++;
+        }
+        size_t len = end - start;
+        if (len > 0) {
+            trace_filter_entry *e = (trace_filter_entry *)malloc(sizeof(trace_filter_entry) + len);
+            if (e) {
+                memcpy(e->name, start, len);
+                e->name[len] = 0;
+                e->next = halide_trace_func_filter;
+                halide_trace_func_filter = e;
+            }
+        }
+        start = *end ? end + 1 : end;
+    }
+}
+
+// Check the HL_TRACE_FUNCS and HL_TRACE_SAMPLE_RATE environment
+// variables the first time they might matter. Must be called with the
+// filter lock held. Explicit calls to the halide_trace_set_* API
+// below override whatever the environment said.
+WEAK void init_trace_filter_from_env() {
+    if (halide_trace_filter_env_checked) {
+        return;
+    }
+    halide_trace_filter_env_checked = true;
+    const char *funcs = getenv("HL_TRACE_FUNCS");
+    if (funcs && *funcs) {
+        parse_trace_func_filter(funcs);
+    }
+    const char *rate = getenv("HL_TRACE_SAMPLE_RATE");
+    if (rate) {
+        int r = atoi(rate);
+        if (r > 0) {
+            halide_trace_sample_rate = r;
+        }
+    }
+}
+
+WEAK bool trace_func_filter_matches(const char *func) {
+    for (trace_filter_entry *e = halide_trace_func_filter; e; e = e->next) {
+        size_t len = strlen(e->name);
+        if (len > 0 && e->name[len - 1] == '*') {
+            if (strncmp(e->name, func, len - 1) == 0) {
+                return true;
+            }
+        } else if (strcmp(e->name, func) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+WEAK trace_sample_entry *find_sample_entry(const char *func) {
+    for (trace_sample_entry *e = halide_trace_sample_funcs; e; e = e->next) {
+        if (strcmp(e->name, func) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+// Must be called with the filter lock held. Entries are fully
+// initialized before being published, so find_sample_entry may walk
+// the list without the lock.
+WEAK trace_sample_entry *find_or_create_sample_entry(const char *func) {
+    trace_sample_entry *e = find_sample_entry(func);
+    if (e) {
+        return e;
+    }
+    size_t len = strlen(func);
+    e = (trace_sample_entry *)malloc(sizeof(trace_sample_entry) + len);
+    if (!e) {
+        return NULL;
+    }
+    e->count = 0;
+    e->suppressed = false;
+    memcpy(e->name, func, len + 1);
+    e->next = halide_trace_sample_funcs;
+    __sync_synchronize();
+    halide_trace_sample_funcs = e;
+    return e;
+}
+
+// Decide whether a trace event should be dispatched. Pipeline-level
+// events and trace tags always pass, so a filtered or sampled trace
+// is still well-formed enough for the tools to read.
+WEAK bool trace_event_enabled(void *user_context, const halide_trace_event_t *e) {
+    if (!halide_trace_filter_env_checked) {
+        ScopedSpinLock lock(&halide_trace_filter_lock);
+        init_trace_filter_from_env();
+    }
+
+    if (e->event == halide_trace_begin_pipeline ||
+        e->event == halide_trace_end_pipeline ||
+        e->event == halide_trace_tag) {
+        return true;
+    }
+
+    if (halide_trace_func_filter && !trace_func_filter_matches(e->func)) {
+        return false;
+    }
+
+    if (halide_trace_sample_rate > 1) {
+        // Count realizations of each func and suppress everything
+        // inside all but every Nth one. This relies on the
+        // begin/end_realization events emitted under the
+        // trace_realizations target feature; without them sampling
+        // has no effect. When there are parallel realizations of the
+        // same func (e.g. tiles) the suppression flag is shared, so
+        // the sampling is approximate there.
+        if (e->event == halide_trace_begin_realization) {
+            ScopedSpinLock lock(&halide_trace_filter_lock);
+            trace_sample_entry *entry = find_or_create_sample_entry(e->func);
+            if (entry) {
+                entry->suppressed =
+                    (entry->count % (uint64_t)halide_trace_sample_rate) != 0;
+                entry->count++;
+                return !entry->suppressed;
+            }
+        } else {
+            // A racy read; suppression of loads and stores doesn't
+            // need to be exact, and taking the lock on every store
+            // would serialize the tracing threads.
+            trace_sample_entry *entry = find_sample_entry(e->func);
+            if (entry && entry->suppressed) {
+                if (e->event == halide_trace_end_realization) {
+                    entry->suppressed = false;
+                }
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Push everything recorded so far out to the trace file and wait for
+// the writer thread to finish with it.
+WEAK void flush_trace_buffers(void *user_context) {
+    halide_mutex_lock(&halide_trace_writer_lock);
+    if (halide_trace_writer) {
+        // Flushing an empty buffer is harmless, so just mark the
+        // active one pending too.
+        halide_trace_buffer_pending[halide_trace_active_buffer] = true;
+        halide_cond_broadcast(&halide_trace_writer_wakeup);
+        while (halide_trace_buffer_pending[0] || halide_trace_buffer_pending[1]) {
+            halide_cond_wait(&halide_trace_buffer_drained, &halide_trace_writer_lock);
+        }
+    }
+    halide_mutex_unlock(&halide_trace_writer_lock);
+}
+
 }}}
 
 extern "C" {
@@ -153,6 +603,8 @@ WEAK int32_t halide_default_trace(void *user_context, const halide_trace_event_t
     // If we're dumping to a file, use a binary format
     int fd = halide_get_trace_file(user_context);
     if (fd > 0) {
+        ensure_trace_writer_started(user_context);
+
         // Compute the total packet size
         uint32_t value_bytes = (uint32_t)(e->type.lanes * e->type.bytes());
         uint32_t header_bytes = (uint32_t)sizeof(halide_trace_packet_t);
@@ -163,7 +615,7 @@ WEAK int32_t halide_default_trace(void *user_context, const halide_trace_event_t
         uint32_t total_size = (total_size_without_padding + 3) & ~3;
 
         // Claim some space to write to in the trace buffer
-        halide_trace_packet_t *packet = halide_trace_buffer->acquire_packet(user_context, fd, total_size);
+        halide_trace_packet_t *packet = acquire_trace_packet(user_context, total_size);
 
         if (total_size > 4096) {
             print(NULL) << total_size << "\n";
@@ -187,12 +639,12 @@ WEAK int32_t halide_default_trace(void *user_context, const halide_trace_event_t
         memcpy((void *)packet->trace_tag(), e->trace_tag ? e->trace_tag : "", trace_tag_bytes);
 
         // Release it
-        halide_trace_buffer->release_packet(packet);
+        release_trace_packet(packet);
 
-        // We should also flush the trace buffer if we hit an event
+        // We should also flush the trace buffers if we hit an event
         // that might be the end of the trace.
         if (e->event == halide_trace_end_pipeline) {
-            halide_trace_buffer->flush(user_context, fd);
+            flush_trace_buffers(user_context);
         }
 
     } else {
@@ -331,12 +783,19 @@ WEAK int halide_get_trace_file(void *user_context) {
     if (halide_trace_file < 0) {
         const char *trace_file_name = getenv("HL_TRACE_FILE");
         if (trace_file_name) {
-            void *file = fopen(trace_file_name, "ab");
+            // Truncate rather than append, so that the packet offsets
+            // recorded in the trace index below are file offsets.
+            void *file = fopen(trace_file_name, "wb");
             halide_assert(user_context, file && "Failed to open trace file\n");
             halide_set_trace_file(fileno(file));
             halide_trace_file_internally_opened = file;
-            if (!halide_trace_buffer) {
-                halide_trace_buffer = (TraceBuffer *)malloc(sizeof(TraceBuffer));
+            halide_trace_index_enabled = true;
+            const char *sync_interval = getenv("HL_TRACE_SYNC_INTERVAL");
+            if (sync_interval) {
+                int bytes = atoi(sync_interval);
+                if (bytes > 0) {
+                    halide_trace_sync_interval = (uint64_t)bytes;
+                }
             }
         } else {
             halide_set_trace_file(0);
@@ -346,18 +805,74 @@ WEAK int halide_get_trace_file(void *user_context) {
 }
 
 WEAK int32_t halide_trace(void *user_context, const halide_trace_event_t *e) {
+    if (!trace_event_enabled(user_context, e)) {
+        // The id returned for a suppressed event only ever flows into
+        // the parent_id of events that will themselves be suppressed.
+        return 0;
+    }
     return (*halide_custom_trace)(user_context, e);
 }
 
+WEAK int halide_trace_set_func_filter(void *user_context, const char *funcs) {
+    ScopedSpinLock lock(&halide_trace_filter_lock);
+    init_trace_filter_from_env();
+    if (funcs && *funcs) {
+        parse_trace_func_filter(funcs);
+    } else {
+        clear_trace_func_filter();
+    }
+    return 0;
+}
+
+WEAK int halide_trace_set_sample_rate(void *user_context, int rate) {
+    ScopedSpinLock lock(&halide_trace_filter_lock);
+    init_trace_filter_from_env();
+    halide_trace_sample_rate = rate > 1 ? rate : 1;
+    return 0;
+}
+
 WEAK int halide_shutdown_trace() {
+    // Stop the writer thread, draining anything still buffered.
+    halide_mutex_lock(&halide_trace_writer_lock);
+    halide_thread *writer = halide_trace_writer;
+    if (writer) {
+        halide_trace_buffer_pending[halide_trace_active_buffer] = true;
+        halide_trace_writer_shutdown = true;
+        halide_trace_writer = NULL;
+        halide_cond_broadcast(&halide_trace_writer_wakeup);
+    }
+    halide_mutex_unlock(&halide_trace_writer_lock);
+    if (writer) {
+        halide_join_thread(writer);
+    }
+    for (int i = 0; i < 2; i++) {
+        free(halide_trace_buffers[i]);
+        halide_trace_buffers[i] = NULL;
+    }
+    if (halide_trace_index_enabled && halide_trace_bytes_written > 0) {
+        // Write a final sync packet with the complete func table, and
+        // a footer pointing at it so tools can find the index.
+        write_sync_packet(NULL, halide_trace_file);
+        uint8_t footer[16];
+        poke_u64(footer, halide_trace_last_sync_offset);
+        memcpy(footer + 8, "HLTRIDX1", 8);
+        write(halide_trace_file, footer, sizeof(footer));
+        halide_trace_index_enabled = false;
+        halide_trace_bytes_written = 0;
+        halide_trace_bytes_at_last_sync = 0;
+        halide_trace_last_sync_offset = (uint64_t)(-1);
+        halide_trace_last_packet_id = 0;
+        while (halide_trace_funcs) {
+            trace_func_entry *next = halide_trace_funcs->next;
+            free(halide_trace_funcs);
+            halide_trace_funcs = next;
+        }
+    }
     if (halide_trace_file_internally_opened) {
         int ret = fclose(halide_trace_file_internally_opened);
         halide_trace_file = 0;
         halide_trace_file_initialized = false;
         halide_trace_file_internally_opened = NULL;
-        if (halide_trace_buffer) {
-            free(halide_trace_buffer);
-        }
         return ret;
     } else {
         return 0;
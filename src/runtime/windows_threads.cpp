@@ -4,6 +4,10 @@
 // TODO: consider getting rid of this
 #define MAX_THREADS 256
 
+// A clock module is always linked alongside this thread pool, so the
+// work queue can time loops to decide when parallelism pays off.
+#define THREAD_POOL_MEASURED_SERIAL_PATH 1
+
 extern "C" {
 
 #ifdef BITS_64
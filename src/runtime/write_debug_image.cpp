@@ -118,18 +118,12 @@ struct ScopedFile {
     }
 };
 
-}}} // namespace Halide::Runtime::Internal
-
-WEAK extern "C" int32_t halide_debug_to_file(void *user_context, const char *filename,
-                                             int32_t type_code, struct halide_buffer_t *buf) {
-
-    if (buf->dimensions > 4) {
-        halide_error(user_context, "Can't debug_to_file a Func with more than four dimensions\n");
-        return -1;
-    }
-
-    halide_copy_to_host(user_context, buf);
-
+// Writes an image in the format implied by filename's extension. The
+// buffer must already be in host memory and have four or fewer
+// dimensions. Runs on the caller's thread for synchronous dumps and
+// on the background writer thread for asynchronous ones.
+WEAK int32_t write_debug_image(void *user_context, const char *filename,
+                               int32_t type_code, halide_buffer_t *buf) {
     ScopedFile f(filename, "wb");
     if (!f.open()) return -2;
 
@@ -355,3 +349,202 @@ WEAK extern "C" int32_t halide_debug_to_file(void *user_context, const char *fil
 
     return 0;
 }
+
+// Asynchronous writes. Each pending job owns a densely-packed
+// snapshot of the producer's output, so the pipeline is free to
+// overwrite the original buffer the moment halide_debug_to_file
+// returns. A single background thread drains the queue in FIFO
+// order. Completed jobs go on a free list and are reused for later
+// dumps of the same (or smaller) size, so dumping an intermediate
+// every frame doesn't hammer the allocator.
+struct debug_to_file_job {
+    debug_to_file_job *next;
+    halide_buffer_t snapshot;
+    halide_dimension_t shape[4];
+    int32_t type_code;
+    // The capacity of the payload that follows this struct, which may
+    // exceed what the current snapshot needs if the job was recycled.
+    size_t payload_size;
+    char filename[512];
+    // The snapshot's host data follows.
+};
+
+WEAK halide_mutex debug_to_file_mutex = {{0}};
+WEAK halide_cond debug_to_file_cond = {{0}};
+WEAK debug_to_file_job *debug_to_file_head = NULL;
+WEAK debug_to_file_job *debug_to_file_tail = NULL;
+WEAK debug_to_file_job *debug_to_file_pool = NULL;
+WEAK halide_thread *debug_to_file_thread = NULL;
+WEAK bool debug_to_file_async_enabled = false;
+WEAK int debug_to_file_outstanding = 0;
+WEAK int32_t debug_to_file_first_error = 0;
+
+WEAK void debug_to_file_writer_thread(void *) {
+    halide_mutex_lock(&debug_to_file_mutex);
+    while (true) {
+        while (debug_to_file_head == NULL) {
+            halide_cond_wait(&debug_to_file_cond, &debug_to_file_mutex);
+        }
+        debug_to_file_job *job = debug_to_file_head;
+        debug_to_file_head = job->next;
+        if (debug_to_file_head == NULL) {
+            debug_to_file_tail = NULL;
+        }
+        halide_mutex_unlock(&debug_to_file_mutex);
+
+        int32_t result = write_debug_image(NULL, job->filename, job->type_code, &job->snapshot);
+
+        halide_mutex_lock(&debug_to_file_mutex);
+        if (result != 0 && debug_to_file_first_error == 0) {
+            debug_to_file_first_error = result;
+        }
+        job->next = debug_to_file_pool;
+        debug_to_file_pool = job;
+        debug_to_file_outstanding--;
+        halide_cond_broadcast(&debug_to_file_cond);
+    }
+}
+
+// Snapshot buf into a (possibly recycled) job and hand it to the
+// writer thread. Returns non-zero if a snapshot couldn't be taken
+// (allocation failure or over-long filename), in which case the
+// caller should write synchronously instead.
+WEAK int32_t debug_to_file_enqueue(void *user_context, const char *filename,
+                                   int32_t type_code, halide_buffer_t *buf) {
+    size_t filename_len = strlen(filename);
+    if (filename_len >= sizeof(debug_to_file_head->filename)) {
+        return -1;
+    }
+
+    halide_dimension_t src_shape[4];
+    size_t elts = 1;
+    for (int i = 0; i < 4; i++) {
+        if (i < buf->dimensions) {
+            src_shape[i] = buf->dim[i];
+        } else {
+            src_shape[i].min = 0;
+            src_shape[i].extent = 1;
+            src_shape[i].stride = 0;
+        }
+        elts *= src_shape[i].extent;
+    }
+    int32_t bytes_per_element = buf->type.bytes();
+    size_t payload_size = elts * bytes_per_element;
+
+    // Look for a recycled job with enough payload capacity.
+    debug_to_file_job *job = NULL;
+    halide_mutex_lock(&debug_to_file_mutex);
+    for (debug_to_file_job **prev = &debug_to_file_pool; *prev; prev = &(*prev)->next) {
+        if ((*prev)->payload_size >= payload_size) {
+            job = *prev;
+            *prev = job->next;
+            break;
+        }
+    }
+    halide_mutex_unlock(&debug_to_file_mutex);
+
+    if (job == NULL) {
+        job = (debug_to_file_job *)halide_malloc(user_context, sizeof(debug_to_file_job) + payload_size);
+        if (job == NULL) {
+            return -1;
+        }
+        job->payload_size = payload_size;
+    }
+
+    memcpy(job->filename, filename, filename_len + 1);
+    job->type_code = type_code;
+
+    // The snapshot is densely packed in the source's dimension order.
+    uint8_t *payload = (uint8_t *)(job + 1);
+    int32_t stride = 1;
+    for (int i = 0; i < buf->dimensions; i++) {
+        job->shape[i].min = src_shape[i].min;
+        job->shape[i].extent = src_shape[i].extent;
+        job->shape[i].stride = stride;
+        stride *= src_shape[i].extent;
+    }
+    job->snapshot.device = 0;
+    job->snapshot.device_interface = NULL;
+    job->snapshot.host = payload;
+    job->snapshot.flags = 0;
+    job->snapshot.type = buf->type;
+    job->snapshot.dimensions = buf->dimensions;
+    job->snapshot.dim = job->shape;
+    job->snapshot.padding = NULL;
+
+    // Copy the data, a row at a time if the source rows are dense.
+    uint8_t *dst = payload;
+    for (int32_t dim3 = src_shape[3].min; dim3 < src_shape[3].extent + src_shape[3].min; ++dim3) {
+        for (int32_t dim2 = src_shape[2].min; dim2 < src_shape[2].extent + src_shape[2].min; ++dim2) {
+            for (int32_t dim1 = src_shape[1].min; dim1 < src_shape[1].extent + src_shape[1].min; ++dim1) {
+                int idx[] = {src_shape[0].min, dim1, dim2, dim3};
+                if (src_shape[0].stride == 1) {
+                    memcpy(dst, buf->address_of(idx), src_shape[0].extent * bytes_per_element);
+                    dst += src_shape[0].extent * bytes_per_element;
+                } else {
+                    for (int32_t dim0 = src_shape[0].min; dim0 < src_shape[0].extent + src_shape[0].min; ++dim0) {
+                        idx[0] = dim0;
+                        memcpy(dst, buf->address_of(idx), bytes_per_element);
+                        dst += bytes_per_element;
+                    }
+                }
+            }
+        }
+    }
+
+    halide_mutex_lock(&debug_to_file_mutex);
+    job->next = NULL;
+    if (debug_to_file_tail) {
+        debug_to_file_tail->next = job;
+    } else {
+        debug_to_file_head = job;
+    }
+    debug_to_file_tail = job;
+    debug_to_file_outstanding++;
+    if (debug_to_file_thread == NULL) {
+        debug_to_file_thread = halide_spawn_thread(debug_to_file_writer_thread, NULL);
+    }
+    halide_cond_broadcast(&debug_to_file_cond);
+    halide_mutex_unlock(&debug_to_file_mutex);
+
+    return 0;
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+WEAK extern "C" int32_t halide_debug_to_file(void *user_context, const char *filename,
+                                             int32_t type_code, struct halide_buffer_t *buf) {
+
+    if (buf->dimensions > 4) {
+        halide_error(user_context, "Can't debug_to_file a Func with more than four dimensions\n");
+        return -1;
+    }
+
+    halide_copy_to_host(user_context, buf);
+
+    if (debug_to_file_async_enabled) {
+        if (debug_to_file_enqueue(user_context, filename, type_code, buf) == 0) {
+            return 0;
+        }
+        // Couldn't snapshot the buffer; write it synchronously instead.
+    }
+
+    return write_debug_image(user_context, filename, type_code, buf);
+}
+
+WEAK extern "C" void halide_debug_to_file_set_async(int enable) {
+    halide_mutex_lock(&debug_to_file_mutex);
+    debug_to_file_async_enabled = (enable != 0);
+    halide_mutex_unlock(&debug_to_file_mutex);
+}
+
+WEAK extern "C" int32_t halide_debug_to_file_flush(void *user_context) {
+    halide_mutex_lock(&debug_to_file_mutex);
+    while (debug_to_file_outstanding != 0) {
+        halide_cond_wait(&debug_to_file_cond, &debug_to_file_mutex);
+    }
+    int32_t result = debug_to_file_first_error;
+    debug_to_file_first_error = 0;
+    halide_mutex_unlock(&debug_to_file_mutex);
+    return result;
+}
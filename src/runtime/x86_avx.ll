@@ -70,6 +70,23 @@ define weak_odr <4 x double> @abs_f64x4(<4 x double> %x) nounwind uwtable readno
   ret <4 x double> %result
 }
 
+declare <8 x float> @llvm.x86.vcvtph2ps.256(<8 x i16>) nounwind readnone
+declare <8 x i16> @llvm.x86.vcvtps2ph.256(<8 x float>, i32) nounwind readnone
+
+; Only referenced when the f16c feature is present.
+define weak_odr <8 x float> @vcvtph2psx8(<8 x half> %arg) nounwind uwtable readnone alwaysinline {
+  %bits = bitcast <8 x half> %arg to <8 x i16>
+  %result = tail call <8 x float> @llvm.x86.vcvtph2ps.256(<8 x i16> %bits)
+  ret <8 x float> %result
+}
+
+; Rounding mode 0 is round-to-nearest-even, matching fptrunc.
+define weak_odr <8 x half> @vcvtps2phx8(<8 x float> %arg) nounwind uwtable readnone alwaysinline {
+  %bits = tail call <8 x i16> @llvm.x86.vcvtps2ph.256(<8 x float> %arg, i32 0)
+  %result = bitcast <8 x i16> %bits to <8 x half>
+  ret <8 x half> %result
+}
+
 declare <8 x float> @llvm.x86.avx.rcp.ps.256(<8 x float>) nounwind readnone
 
 define weak_odr <8 x float> @fast_inverse_f32x8(<8 x float> %x) nounwind uwtable readnone alwaysinline {
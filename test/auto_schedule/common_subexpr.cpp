@@ -0,0 +1,64 @@
+#include "Halide.h"
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    int W = 800;
+    int H = 800;
+
+    Buffer<float> input(W, H);
+    for (int y = 0; y < input.height(); y++) {
+        for (int x = 0; x < input.width(); x++) {
+            input(x, y) = rand() & 0xfff;
+        }
+    }
+
+    Var x("x"), y("y");
+
+    Func gx("gx"), gy("gy");
+    gx(x, y) = input(x + 1, y) - input(x, y);
+    gy(x, y) = input(x, y + 1) - input(x, y);
+
+    // Four consumers each recompute the same gradient magnitude.
+    // The auto-scheduler should spot the shared subexpression and
+    // consider computing it once.
+    Func f("f"), g("g"), h("h"), out("out");
+    f(x, y) = sqrt(gx(x, y) * gx(x, y) + gy(x, y) * gy(x, y)) * 2.0f;
+    g(x, y) = sqrt(gx(x, y) * gx(x, y) + gy(x, y) * gy(x, y)) + input(x, y);
+    h(x, y) = sqrt(gx(x, y) * gx(x, y) + gy(x, y) * gy(x, y)) - input(x, y);
+    out(x, y) = f(x, y) + g(x, y) + h(x, y);
+
+    // Provide estimates on the pipeline output
+    out.estimate(x, 0, input.width() - 1)
+        .estimate(y, 0, input.height() - 1);
+
+    // Auto-schedule the pipeline
+    Target target = get_jit_target_from_environment();
+    Pipeline p(out);
+
+    p.auto_schedule(target);
+
+    // Inspect the schedule
+    out.print_loop_nest();
+
+    // Run the schedule
+    Buffer<float> result = p.realize(input.width() - 1, input.height() - 1);
+
+    // Verify the result against a straightforward reference.
+    for (int yy = 0; yy < result.height(); yy++) {
+        for (int xx = 0; xx < result.width(); xx++) {
+            float dx = input(xx + 1, yy) - input(xx, yy);
+            float dy = input(xx, yy + 1) - input(xx, yy);
+            float mag = sqrtf(dx * dx + dy * dy);
+            float correct = (mag * 2.0f) + (mag + input(xx, yy)) + (mag - input(xx, yy));
+            if (fabs(result(xx, yy) - correct) > 0.001f * fabs(correct) + 0.001f) {
+                printf("result(%d, %d) = %f instead of %f\n",
+                       xx, yy, result(xx, yy), correct);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
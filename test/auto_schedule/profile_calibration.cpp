@@ -0,0 +1,71 @@
+#include "Halide.h"
+
+#include <fstream>
+#include <stdlib.h>
+
+using namespace Halide;
+
+namespace {
+
+void set_profile_env_var(const std::string &path) {
+#ifdef _WIN32
+    _putenv_s("HL_AUTO_SCHEDULE_PROFILE", path.c_str());
+#else
+    setenv("HL_AUTO_SCHEDULE_PROFILE", path.c_str(), 1);
+#endif
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    // Write out a fake profiler report which claims that "g" dominates
+    // the runtime, to exercise the profile-guided cost calibration.
+    std::string profile_file = "profile_calibration.profile";
+    {
+        std::ofstream out(profile_file.c_str());
+        out << "the_pipeline\n"
+            << " total time: 100.0 ms  samples: 90  runs: 10  time/run: 10.0 ms\n"
+            << " heap allocations: 0  peak heap usage: 0 bytes\n"
+            << "  f: 1.0ms (10%)\n"
+            << "  g: 9.0ms (90%)\n";
+    }
+    set_profile_env_var(profile_file);
+
+    Func f("f"), g("g"), out("out");
+    Var x("x"), y("y");
+
+    f(x, y) = x + y;
+    g(x, y) = cast<int>(sqrt(f(x, y) * f(x, y) + 1));
+    out(x, y) = g(x, y) + g(x + 1, y + 1);
+
+    // Provide estimates on the pipeline output
+    out.estimate(x, 0, 1000).estimate(y, 0, 1000);
+
+    // Auto-schedule the pipeline with the measured costs in effect.
+    Target target = get_jit_target_from_environment();
+    Pipeline p(out);
+
+    p.auto_schedule(target);
+
+    // Unset the profile so later pipelines in this process (if any) use
+    // static costs again.
+    set_profile_env_var("");
+
+    // The calibrated schedule should still compute the right thing.
+    Buffer<int> result = p.realize(1000, 1000);
+    for (int y = 0; y < result.height(); y++) {
+        for (int x = 0; x < result.width(); x++) {
+            int g1 = (int)sqrt((float)((x + y) * (x + y) + 1));
+            int g2 = (int)sqrt((float)((x + 1 + y + 1) * (x + 1 + y + 1) + 1));
+            int correct = g1 + g2;
+            if (result(x, y) != correct) {
+                printf("result(%d, %d) = %d instead of %d\n",
+                       x, y, result(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,86 @@
+#ifndef HALIDE_CHECK_ASM_H
+#define HALIDE_CHECK_ASM_H
+
+// Helpers for asserting on the quality of generated assembly, used by
+// simd_op_check and usable against any .s file produced with
+// compile_to_assembly (e.g. from a Generator in a build rule). This
+// file may be used by AOT tests, so it deliberately does not include
+// Halide.h.
+
+#include <istream>
+#include <string>
+
+namespace Halide {
+namespace Internal {
+
+namespace Test {
+
+struct AsmQuality {
+    // Total instructions in the file (labels, directives and comments
+    // excluded). For a single-kernel .s this approximates the size of
+    // the kernel including its loop nest and prologue.
+    int instructions{0};
+
+    // Vector registers moving to or from the stack: the signature of
+    // register spills in a vectorized loop.
+    int vector_stack_accesses{0};
+
+    // Vector lane extract/insert instructions: the signature of an
+    // operation that failed to vectorize and is being done lane by
+    // lane.
+    int lane_extracts{0};
+};
+
+// Scan an assembly listing and count the patterns above. Understands
+// x86 (AT&T syntax, as emitted by compile_to_assembly) and ARM.
+inline AsmQuality analyze_assembly(std::istream &asm_stream) {
+    AsmQuality result;
+    std::string line;
+    while (std::getline(asm_stream, line)) {
+        // Skip to the mnemonic, if any.
+        size_t first = line.find_first_not_of(" \t");
+        if (first == std::string::npos) {
+            continue;
+        }
+        char c = line[first];
+        if (c == '.' || c == '#' || c == ';' || c == '@') {
+            // Directive or comment.
+            continue;
+        }
+        if (line.find(':') != std::string::npos &&
+            line.find_first_of(" \t", first) > line.find(':')) {
+            // Label.
+            continue;
+        }
+        result.instructions++;
+
+        auto contains = [&](const char *s) {
+            return line.find(s) != std::string::npos;
+        };
+
+        // x86 vector registers spilled to the stack frame, or ARM
+        // quad registers moved to/from sp.
+        bool vector_reg = contains("xmm") || contains("ymm") || contains("zmm") ||
+                          ((contains(" q") || contains("{d")) && line.find("v", first) == first);
+        bool stack = contains("(%rsp") || contains("(%esp") ||
+                     contains("(%rbp") || contains("(%ebp") ||
+                     contains("[sp");
+        if (vector_reg && stack) {
+            result.vector_stack_accesses++;
+        }
+
+        // Lane-by-lane extraction/insertion.
+        if (contains("pextr") || contains("pinsr") ||
+            contains("vmov.32") || contains("vmov.16") || contains("vmov.8")) {
+            result.lane_extracts++;
+        }
+    }
+    return result;
+}
+
+}  // namespace Test
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif  // HALIDE_CHECK_ASM_H
@@ -0,0 +1,62 @@
+#include "Halide.h"
+#include <cmath>
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Var x;
+
+    // bfloat16 is a storage-only type: compute in float, then cast to
+    // bfloat for storage and back to float to keep computing.
+    Func f, g;
+    f(x) = cast(BFloat(16), sqrt(cast<float>(x)));
+    f.compute_root();
+    g(x) = cast<float>(f(x));
+
+    Buffer<float> out = g.realize(1024);
+    for (int i = 0; i < out.width(); i++) {
+        float exact = std::sqrt((float)i);
+        // bfloat16 keeps 8 mantissa bits (one implicit), so
+        // round-to-nearest gives a relative error of at most 2^-9.
+        float tolerance = exact / 512.0f;
+        if (std::abs(out(i) - exact) > tolerance) {
+            printf("out(%d) = %f instead of %f\n", i, out(i), exact);
+            return -1;
+        }
+    }
+
+    // Small integers (and their negations) fit in the bfloat mantissa
+    // exactly, so they should round-trip bit-exactly.
+    Func h, k;
+    h(x) = cast(BFloat(16), cast<float>(x - 128));
+    h.compute_root();
+    k(x) = cast<float>(h(x));
+    Buffer<float> out2 = k.realize(256);
+    for (int i = 0; i < out2.width(); i++) {
+        float exact = (float)(i - 128);
+        if (out2(i) != exact) {
+            printf("out2(%d) = %f instead of %f\n", i, out2(i), exact);
+            return -1;
+        }
+    }
+
+    // The same, vectorized, to exercise the vector lowering of the
+    // conversions.
+    Func fv, gv;
+    fv(x) = cast(BFloat(16), cast<float>(x) * 0.25f);
+    fv.compute_root().vectorize(x, 8);
+    gv(x) = cast<float>(fv(x));
+    gv.vectorize(x, 8);
+    Buffer<float> out3 = gv.realize(256);
+    for (int i = 0; i < out3.width(); i++) {
+        float exact = (float)i * 0.25f;
+        if (out3(i) != exact) {
+            printf("out3(%d) = %f instead of %f\n", i, out3(i), exact);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
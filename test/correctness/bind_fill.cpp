@@ -0,0 +1,132 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+// Imagine that this reads a box out of a tiled store. Here we just
+// synthesize the data, and record how often and how widely we're
+// asked to fill.
+int num_fill_calls = 0;
+int max_fill_width = 0;
+int max_fill_height = 0;
+
+extern "C" DLLEXPORT int fill_input(halide_buffer_t *out) {
+    if (out->is_bounds_query()) {
+        // We can produce any box we're asked for.
+        return 0;
+    }
+    assert(out->host);
+    assert(out->type == halide_type_of<int>());
+    assert(out->dimensions == 2);
+    num_fill_calls++;
+    if (out->dim[0].extent > max_fill_width) {
+        max_fill_width = out->dim[0].extent;
+    }
+    if (out->dim[1].extent > max_fill_height) {
+        max_fill_height = out->dim[1].extent;
+    }
+    for (int y = 0; y < out->dim[1].extent; y++) {
+        int *dst = (int *)out->host + y * out->dim[1].stride;
+        for (int x = 0; x < out->dim[0].extent; x++) {
+            int x_coord = x + out->dim[0].min;
+            int y_coord = y + out->dim[1].min;
+            dst[x] = x_coord + 100 * y_coord;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Var x("x"), y("y"), xi("xi"), yi("yi");
+
+    {
+        // A consumer pipeline authored against an ImageParam, with
+        // the input paged in by a callback instead of materialized up
+        // front.
+        ImageParam input(Int(32), 2);
+        Func consumer("consumer");
+        consumer(x, y) = input(x, y) * 2;
+
+        Func fill = input.bind_fill("fill_input");
+        fill.compute_root();
+
+        // The ImageParam is no longer an argument of the pipeline.
+        std::vector<Argument> args = Pipeline(consumer).infer_arguments();
+        if (!args.empty()) {
+            printf("Unexpected pipeline argument: %s\n", args[0].name.c_str());
+            return -1;
+        }
+
+        num_fill_calls = 0;
+        max_fill_width = max_fill_height = 0;
+        Buffer<int> result = consumer.realize(32, 32);
+        for (int j = 0; j < 32; j++) {
+            for (int i = 0; i < 32; i++) {
+                int correct = (i + 100 * j) * 2;
+                if (result(i, j) != correct) {
+                    printf("result(%d, %d) = %d instead of %d\n",
+                           i, j, result(i, j), correct);
+                    return -1;
+                }
+            }
+        }
+
+        // compute_root means one fill call covering just the required region.
+        if (num_fill_calls != 1) {
+            printf("fill_input was called %d times instead of once\n", num_fill_calls);
+            return -1;
+        }
+        if (max_fill_width != 32 || max_fill_height != 32) {
+            printf("fill_input was asked for %d x %d instead of 32 x 32\n",
+                   max_fill_width, max_fill_height);
+            return -1;
+        }
+    }
+
+    {
+        // Scheduling the fill stage at a tile loop pages the input in
+        // per-tile, so a cropped realization never touches the rest.
+        ImageParam input(Int(32), 2);
+        Func consumer("consumer");
+        consumer(x, y) = input(x, y) + input(x + 1, y + 1);
+
+        Func fill = input.bind_fill("fill_input");
+        consumer.tile(x, y, xi, yi, 8, 8);
+        fill.compute_at(consumer, x);
+
+        num_fill_calls = 0;
+        max_fill_width = max_fill_height = 0;
+        Buffer<int> result = consumer.realize(16, 16);
+        for (int j = 0; j < 16; j++) {
+            for (int i = 0; i < 16; i++) {
+                int correct = (i + 100 * j) + (i + 1 + 100 * (j + 1));
+                if (result(i, j) != correct) {
+                    printf("result(%d, %d) = %d instead of %d\n",
+                           i, j, result(i, j), correct);
+                    return -1;
+                }
+            }
+        }
+
+        // One fill per 8x8 tile, each asking for at most the tile
+        // plus the one-pixel stencil apron.
+        if (num_fill_calls != 4) {
+            printf("fill_input was called %d times instead of 4\n", num_fill_calls);
+            return -1;
+        }
+        if (max_fill_width > 9 || max_fill_height > 9) {
+            printf("fill_input was asked for %d x %d; expected at most 9 x 9\n",
+                   max_fill_width, max_fill_height);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
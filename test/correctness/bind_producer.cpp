@@ -0,0 +1,76 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Var x("x"), y("y");
+
+    {
+        // A pipeline from a "producer library".
+        Func producer("producer");
+        producer(x, y) = x + y;
+
+        // A consumer pipeline authored against an ImageParam.
+        ImageParam input(Int(32), 2);
+        Func consumer("consumer");
+        consumer(x, y) = input(x, y) * 2 + input(x + 1, y);
+
+        // Fuse the two pipelines and schedule the boundary so the
+        // intermediate is computed per scanline of the consumer
+        // instead of being realized into a whole buffer first.
+        input.bind_producer(producer);
+        producer.compute_at(consumer, y);
+
+        // The ImageParam is no longer an argument of the pipeline.
+        std::vector<Argument> args = Pipeline(consumer).infer_arguments();
+        if (!args.empty()) {
+            printf("Unexpected pipeline argument: %s\n", args[0].name.c_str());
+            return -1;
+        }
+
+        // Realizing without binding a Buffer to the ImageParam should
+        // use the producer's values.
+        Buffer<int> result = consumer.realize(32, 32);
+        for (int j = 0; j < 32; j++) {
+            for (int i = 0; i < 32; i++) {
+                int correct = (i + j) * 2 + (i + 1 + j);
+                if (result(i, j) != correct) {
+                    printf("result(%d, %d) = %d instead of %d\n",
+                           i, j, result(i, j), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    {
+        // The returned boundary wrapper can itself be scheduled to
+        // stage the producer's output.
+        Func producer("producer");
+        producer(x, y) = x * y;
+
+        ImageParam input(Int(32), 2);
+        Func consumer("consumer");
+        consumer(x, y) = input(x, y) + 1;
+
+        Func staged = input.bind_producer(producer);
+        staged.compute_at(consumer, y);
+        producer.compute_root();
+
+        Buffer<int> result = consumer.realize(16, 16);
+        for (int j = 0; j < 16; j++) {
+            for (int i = 0; i < 16; i++) {
+                int correct = i * j + 1;
+                if (result(i, j) != correct) {
+                    printf("result(%d, %d) = %d instead of %d\n",
+                           i, j, result(i, j), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include "Halide.h"
+
+using namespace Halide;
+
+// Count heap allocations made by the pipeline.
+
+int malloc_count = 0;
+
+void *my_malloc(void *user_context, size_t x) {
+    malloc_count++;
+    return malloc(x);
+}
+
+void my_free(void *user_context, void *ptr) {
+    free(ptr);
+}
+
+int main(int argc, char **argv) {
+    // A producer computed per scanline with a parametric but
+    // provably-small width. The allocation has a dynamic size, but
+    // bounds inference can bound it, so it should go on the stack
+    // instead of making a malloc/free pair per scanline.
+    Param<int> w;
+    Func f("f"), g("g");
+    Var x("x"), y("y");
+
+    Expr width = clamp(w, 1, 64);
+
+    f(x, y) = x * 3 + y;
+    g(x, y) = f(x % width, y) + f((x + 1) % width, y);
+
+    f.compute_at(g, y);
+
+    g.set_custom_allocator(my_malloc, my_free);
+
+    w.set(37);
+    Buffer<int> out = g.realize(100, 100);
+
+    for (int y = 0; y < out.height(); y++) {
+        for (int x = 0; x < out.width(); x++) {
+            int correct = (x % 37) * 3 + y + ((x + 1) % 37) * 3 + y;
+            if (out(x, y) != correct) {
+                printf("out(%d, %d) = %d instead of %d\n",
+                       x, y, out(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    if (malloc_count != 0) {
+        printf("The pipeline made %d heap allocation(s). "
+               "The bounded dynamic allocation should have gone on the stack.\n",
+               malloc_count);
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "Halide.h"
+#include <stdio.h>
+
+#include "test/common/halide_test_dirs.h"
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count how many times lower() runs by counting root-level
+// invocations of a custom lowering pass.
+class CountLowerings : public IRMutator2 {
+public:
+    using IRMutator2::mutate;
+
+    Stmt mutate(const Stmt &s) override {
+        if (depth == 0) {
+            runs++;
+        }
+        depth++;
+        Stmt result = IRMutator2::mutate(s);
+        depth--;
+        return result;
+    }
+
+    int runs = 0;
+
+private:
+    int depth = 0;
+};
+
+int main(int argc, char **argv) {
+    Param<int> bias("bias");
+    Func f("f");
+    Var x, y;
+    f(x, y) = x + y + bias;
+
+    Pipeline p(f);
+
+    // Ownership passes to the Pipeline.
+    CountLowerings *counter = new CountLowerings;
+    p.add_custom_lowering_pass(counter);
+    Target t = get_target_from_environment();
+    std::vector<Argument> args = p.infer_arguments();
+
+    std::string header = Internal::get_test_tmp_dir() + "cached_lowering.h";
+    std::string object = Internal::get_test_tmp_dir() + "cached_lowering.o";
+    Internal::ensure_no_file_exists(header);
+    Internal::ensure_no_file_exists(object);
+
+    // Emitting several outputs for the same function, target, and
+    // args should only lower once.
+    p.compile_to_header(header, args, "cached_lowering", t);
+    p.compile_to_object(object, args, "cached_lowering", t);
+
+    Internal::assert_file_exists(header);
+    Internal::assert_file_exists(object);
+
+    if (counter->runs != 1) {
+        printf("Lowered %d times instead of once for header + object\n", counter->runs);
+        return -1;
+    }
+
+    // A different function name is a different lowering.
+    std::string header2 = Internal::get_test_tmp_dir() + "cached_lowering2.h";
+    Internal::ensure_no_file_exists(header2);
+    p.compile_to_header(header2, args, "cached_lowering2", t);
+    if (counter->runs != 2) {
+        printf("Lowered %d times instead of twice after changing the function name\n", counter->runs);
+        return -1;
+    }
+
+    // Jitting lowers again (different target and args)...
+    bias.set(5);
+    Buffer<int> out = p.realize(8, 8, get_jit_target_from_environment());
+    for (int yy = 0; yy < 8; yy++) {
+        for (int xx = 0; xx < 8; xx++) {
+            if (out(xx, yy) != xx + yy + 5) {
+                printf("out(%d, %d) = %d instead of %d\n", xx, yy, out(xx, yy), xx + yy + 5);
+                return -1;
+            }
+        }
+    }
+    const int runs_after_jit = counter->runs;
+
+    // ...but must not evict the AOT entries.
+    p.compile_to_object(object, args, "cached_lowering", t);
+    if (counter->runs != runs_after_jit) {
+        printf("Lowered again for a cached compile after jitting (%d -> %d runs)\n",
+               runs_after_jit, counter->runs);
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
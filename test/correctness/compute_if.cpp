@@ -0,0 +1,92 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+int call_count[2];
+extern "C" DLLEXPORT int if_call_counter(int x, int idx) {
+    call_count[idx]++;
+    return x;
+}
+HalideExtern_2(int, if_call_counter, int, int);
+
+void reset_counts() {
+    call_count[0] = call_count[1] = 0;
+}
+
+int main(int argc, char **argv) {
+    // A mask that enables two of the four tiles below.
+    Buffer<uint8_t> mask(4);
+    mask(0) = 1;
+    mask(1) = 0;
+    mask(2) = 1;
+    mask(3) = 0;
+
+    {
+        // Skip the computation of a tile of an expensive producer when
+        // a cheap per-tile predicate is false.
+        Func heavy("heavy"), out("out");
+        Var x("x"), xo("xo"), xi("xi");
+
+        heavy(x) = if_call_counter(x, 0);
+        out(x) = select(mask(x / 8) != 0, heavy(x), 0);
+
+        out.split(x, xo, xi, 8);
+        heavy.compute_at(out, xo).compute_if(mask(xo) != 0);
+
+        reset_counts();
+        Buffer<int> result = out.realize(32);
+        for (int i = 0; i < result.width(); i++) {
+            int correct = mask(i / 8) ? i : 0;
+            if (result(i) != correct) {
+                printf("result(%d) = %d instead of %d\n", i, result(i), correct);
+                return -1;
+            }
+        }
+        // Only the two enabled tiles should have been computed.
+        if (call_count[0] != 16) {
+            printf("heavy was evaluated %d times instead of 16\n", call_count[0]);
+            return -1;
+        }
+    }
+
+    {
+        // The skip should propagate to producers that are used nowhere
+        // else, via the same analysis that drives automatic stage
+        // skipping.
+        Func feeder("feeder"), heavy("heavy"), out("out");
+        Var x("x"), xo("xo"), xi("xi");
+
+        feeder(x) = if_call_counter(x, 1);
+        heavy(x) = if_call_counter(feeder(x), 0);
+        out(x) = select(mask(x / 8) != 0, heavy(x), 0);
+
+        out.split(x, xo, xi, 8);
+        heavy.compute_at(out, xo).compute_if(mask(xo) != 0);
+        feeder.compute_at(out, xo);
+
+        reset_counts();
+        Buffer<int> result = out.realize(32);
+        for (int i = 0; i < result.width(); i++) {
+            int correct = mask(i / 8) ? i : 0;
+            if (result(i) != correct) {
+                printf("result(%d) = %d instead of %d\n", i, result(i), correct);
+                return -1;
+            }
+        }
+        if (call_count[0] != 16 || call_count[1] != 16) {
+            printf("heavy/feeder were evaluated %d/%d times instead of 16/16\n",
+                   call_count[0], call_count[1]);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -760,6 +760,76 @@ int multiple_outputs_on_gpu_test() {
     return 0;
 }
 
+int update_stages_on_gpu_test() {
+    Target target = get_jit_target_from_environment();
+    if (!target.has_gpu_feature()) {
+        printf("No GPU feature enabled in target. Skipping test\n");
+        return 0;
+    }
+
+    // Two funcs whose update stages iterate the same tiles, sharing
+    // one traversal of the blocks in both the pure and the update
+    // stages.
+    const int size = 256;
+    Buffer<int> f_im(size, size), g_im(size, size);
+    Buffer<int> f_im_ref(size, size), g_im_ref(size, size);
+
+    {
+        Var x("x"), y("y");
+        Func f("f"), g("g"), input("input");
+
+        input(x, y) = x + y + 1;
+        f(x, y) = input(x, y);
+        f(x, y) += input(x + 1, y);
+        g(x, y) = 2 * input(x, y);
+        g(x, y) += input(x, y + 1);
+        f.realize(f_im_ref);
+        g.realize(g_im_ref);
+    }
+
+    {
+        Var x("x"), y("y");
+        Func f("f"), g("g"), input("input");
+
+        input(x, y) = x + y + 1;
+        f(x, y) = input(x, y);
+        f(x, y) += input(x + 1, y);
+        g(x, y) = 2 * input(x, y);
+        g(x, y) += input(x, y + 1);
+
+        input.compute_root();
+        Var xi("xi"), yi("yi");
+        f.compute_root().gpu_tile(x, y, xi, yi, 8, 8);
+        f.update().gpu_tile(x, y, xi, yi, 8, 8);
+        g.compute_root().gpu_tile(x, y, xi, yi, 8, 8);
+        g.update().gpu_tile(x, y, xi, yi, 8, 8);
+
+        g.compute_with(f, x);
+        g.update().compute_with(f.update(0), x);
+
+        Realization r(f_im, g_im);
+        Pipeline({f, g}).realize(r);
+        r[0].copy_to_host();
+        r[1].copy_to_host();
+    }
+
+    auto f_func = [f_im_ref](int x, int y) {
+        return f_im_ref(x, y);
+    };
+    if (check_image(f_im, f_func)) {
+        return -1;
+    }
+
+    auto g_func = [g_im_ref](int x, int y) {
+        return g_im_ref(x, y);
+    };
+    if (check_image(g_im, g_func)) {
+        return -1;
+    }
+
+    return 0;
+}
+
 int mixed_tile_factor_test() {
     const int size = 256;
     Buffer<int> f_im(size, size), g_im(size/2, size/2), h_im(size/2, size/2);
@@ -1244,6 +1314,11 @@ int main(int argc, char **argv) {
         return -1;
     }
 
+    printf("Running update stages on gpu test\n");
+    if (update_stages_on_gpu_test() != 0) {
+        return -1;
+    }
+
     printf("Running multi tile mixed tile factor test\n");
     if (multi_tile_mixed_tile_factor_test() != 0) {
         return -1;
@@ -0,0 +1,36 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+// With the LargeBuffers feature, an internal allocation with a
+// constant size beyond 2^31 elements should compile; the old
+// total-size assert fired even though every per-dimension extent fit
+// comfortably in an int32. Compile-only: actually realizing this
+// would need > 4GB of memory.
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment();
+    if (t.bits != 64) {
+        printf("Skipping test because the target is not 64-bit.\n");
+        return 0;
+    }
+    t.set_feature(Target::LargeBuffers);
+
+    const int edge = 1 << 16;
+
+    Var x, y;
+    Func big, out;
+    big(x, y) = cast<uint8_t>(x + y);
+    big.compute_root();
+
+    out(x, y) = big(x, y) + big((x + 1) % edge, (y + 1) % edge);
+    out.bound(x, 0, edge).bound(y, 0, edge);
+
+    // The allocation for big is a constant 2^32 bytes. This errors
+    // out during lowering or codegen if large constant allocations
+    // aren't plumbed through.
+    out.compile_jit(t);
+
+    printf("Success!\n");
+    return 0;
+}
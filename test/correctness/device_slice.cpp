@@ -0,0 +1,141 @@
+#include "Halide.h"
+#include "HalideBuffer.h"
+
+using namespace Halide;
+
+Halide::Runtime::Buffer<int32_t> make_gpu_buffer(bool hexagon_rpc) {
+  Var x, y, c;
+  Func f;
+  f(x, y, c) = x + y * 256 + c * 65536;
+
+  if (hexagon_rpc) {
+      f.hexagon();
+  } else {
+      Var xi, yi;
+      f.gpu_tile(x, y, xi, yi, 8, 8);
+  }
+
+  Buffer<int32_t>  result = f.realize(128, 128, 4);
+  return *result.get();
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+
+    bool hexagon_rpc = (target.arch != Target::Hexagon) &&
+                       target.features_any_of({ Target::HVX_64, Target::HVX_128 });
+
+    if (!hexagon_rpc && !target.has_gpu_feature()) {
+        printf("This is a gpu-specific test. Skipping it.\n");
+        return 0;
+    }
+
+    printf("Test in-place slicing.\n");
+    {
+        Halide::Runtime::Buffer<int32_t> gpu_buf = make_gpu_buffer(hexagon_rpc);
+        assert(gpu_buf.raw_buffer()->device_interface != nullptr);
+
+        gpu_buf.slice(2, 2);
+        assert(gpu_buf.dimensions() == 2);
+        assert(gpu_buf.raw_buffer()->device_interface != nullptr);
+
+        gpu_buf.copy_to_host();
+        for (int i = 0; i < 128; i++) {
+            for (int j = 0; j < 128; j++) {
+                assert(gpu_buf(i, j) == i + 256 * j + 65536 * 2);
+            }
+        }
+    }
+
+    printf("Test nondestructive slicing.\n");
+    {
+        Halide::Runtime::Buffer<int32_t> gpu_buf = make_gpu_buffer(hexagon_rpc);
+        assert(gpu_buf.raw_buffer()->device_interface != nullptr);
+
+        Halide::Runtime::Buffer<int32_t> sliced = gpu_buf.sliced(2, 1);
+        assert(sliced.dimensions() == 2);
+        assert(sliced.raw_buffer()->device_interface != nullptr);
+
+        sliced.copy_to_host();
+        for (int i = 0; i < 128; i++) {
+            for (int j = 0; j < 128; j++) {
+                assert(sliced(i, j) == i + 256 * j + 65536);
+            }
+        }
+    }
+
+    printf("Test slice of a crop.\n");
+    {
+        Halide::Runtime::Buffer<int32_t> gpu_buf = make_gpu_buffer(hexagon_rpc);
+        assert(gpu_buf.raw_buffer()->device_interface != nullptr);
+
+        Halide::Runtime::Buffer<int32_t> cropped = gpu_buf.cropped({ {32, 64} , {32, 64}, {0, 4} });
+        assert(cropped.raw_buffer()->device_interface != nullptr);
+
+        Halide::Runtime::Buffer<int32_t> sliced = cropped.sliced(2, 3);
+        assert(sliced.raw_buffer()->device_interface != nullptr);
+
+        sliced.copy_to_host();
+        for (int i = 0; i < 64; i++) {
+            for (int j = 0; j < 64; j++) {
+                assert(sliced(32 + i, 32 + j) == (i + 32) + 256 * (j + 32) + 65536 * 3);
+            }
+        }
+    }
+
+    printf("Test parent going out of scope before slice.\n");
+    {
+        Halide::Runtime::Buffer<int32_t> sliced;
+
+        {
+            Halide::Runtime::Buffer<int32_t> gpu_buf = make_gpu_buffer(hexagon_rpc);
+            assert(gpu_buf.raw_buffer()->device_interface != nullptr);
+
+            sliced = gpu_buf.sliced(2, 2);
+            assert(sliced.raw_buffer()->device_interface != nullptr);
+        }
+
+        sliced.copy_to_host();
+        for (int i = 0; i < 128; i++) {
+            for (int j = 0; j < 128; j++) {
+                assert(sliced(i, j) == i + 256 * j + 65536 * 2);
+            }
+        }
+    }
+
+    printf("Test realizing to/from slice.\n");
+    {
+        ImageParam in(Int(32), 2);
+        Var x, y;
+        Func f;
+        f(x, y) = in(x, y) + 42;
+
+        Var xi, yi;
+        if (hexagon_rpc) {
+            f.hexagon();
+        } else {
+            f.gpu_tile(x, y, xi, yi, 8, 8);
+        }
+
+        Halide::Buffer<int32_t> gpu_input = make_gpu_buffer(hexagon_rpc);
+        Halide::Buffer<int32_t> gpu_output = make_gpu_buffer(hexagon_rpc);
+
+        gpu_input.slice(2, 1);
+        gpu_output.slice(2, 3);
+
+        in.set(gpu_input);
+
+        f.realize(gpu_output, target);
+
+        gpu_output.copy_to_host();
+        for (int i = 0; i < 128; i++) {
+            for (int j = 0; j < 128; j++) {
+                assert(gpu_output(i, j) == i + 256 * j + 65536 + 42);
+            }
+        }
+    }
+
+    printf("Success!\n");
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+namespace {
+
+// Count the translation wrappers that WrapExternStages added to a
+// lowered module.
+int count_wrappers(const Module &m) {
+    int wrappers = 0;
+    for (const auto &fn : m.functions()) {
+        if (fn.name.find("_halide_wrapper_") != std::string::npos) {
+            wrappers++;
+        }
+    }
+    return wrappers;
+}
+
+Module compile_extern_pipeline(bool uses_old_buffer_t, const Target &target) {
+    Var x("x"), y("y");
+
+    Func source("source");
+    source(x, y) = x + y;
+    source.compute_root();
+
+    Func ext("ext");
+    ext.define_extern("extern_stage", {source}, Int(32), 2,
+                      NameMangling::C, uses_old_buffer_t);
+    ext.compute_root();
+
+    Func out("out");
+    out(x, y) = ext(x, y);
+
+    return out.compile_to_module({out.infer_arguments()}, "out", target);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+
+    // With the default ABI, the extern stage takes halide_buffer_t
+    // pointers directly and no per-invocation translation shim should
+    // be generated.
+    {
+        Module m = compile_extern_pipeline(false, target);
+        int wrappers = count_wrappers(m);
+        if (wrappers != 0) {
+            printf("Expected no translation wrappers for a halide_buffer_t "
+                   "extern stage, found %d\n", wrappers);
+            return -1;
+        }
+    }
+
+    // With the legacy ABI, the shim that converts to buffer_t and back
+    // should be present.
+    {
+        Target legacy_target = target.with_feature(Target::LegacyBufferWrappers);
+        Module m = compile_extern_pipeline(true, legacy_target);
+        int wrappers = count_wrappers(m);
+        if (wrappers == 0) {
+            printf("Expected a translation wrapper for a buffer_t extern "
+                   "stage, found none\n");
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
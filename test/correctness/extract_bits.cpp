@@ -0,0 +1,86 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    const int W = 256;
+
+    // Bytes of packed sub-byte data.
+    Buffer<uint8_t> packed(W);
+    for (int i = 0; i < W; i++) {
+        packed(i) = (uint8_t)rand();
+    }
+    Var x;
+
+    // Unsigned nibbles, two to a byte.
+    Func f1;
+    f1(x) = unpack_uint4(packed(x / 2), x);
+    f1.vectorize(x, 16);
+    Buffer<uint8_t> im1 = f1.realize(2 * W);
+    for (int x = 0; x < 2 * W; x++) {
+        uint8_t correct = (packed(x / 2) >> (4 * (x % 2))) & 0xf;
+        if (im1(x) != correct) {
+            printf("unpack_uint4 at %d -> %d instead of %d\n",
+                   x, im1(x), correct);
+            return -1;
+        }
+    }
+
+    // Signed nibbles sign-extend.
+    Func f2;
+    f2(x) = unpack_int4(packed(x / 2), x);
+    f2.vectorize(x, 16);
+    Buffer<int8_t> im2 = f2.realize(2 * W);
+    for (int x = 0; x < 2 * W; x++) {
+        int8_t correct = (int8_t)(packed(x / 2) << (4 * (1 - x % 2))) >> 4;
+        if (im2(x) != correct) {
+            printf("unpack_int4 at %d -> %d instead of %d\n",
+                   x, im2(x), correct);
+            return -1;
+        }
+    }
+
+    // Single-bit masks, eight to a byte.
+    Func f3;
+    f3(x) = unpack_uint1(packed(x / 8), x);
+    f3.vectorize(x, 16);
+    Buffer<uint8_t> im3 = f3.realize(8 * W);
+    for (int x = 0; x < 8 * W; x++) {
+        uint8_t correct = (packed(x / 8) >> (x % 8)) & 1;
+        if (im3(x) != correct) {
+            printf("unpack_uint1 at %d -> %d instead of %d\n",
+                   x, im3(x), correct);
+            return -1;
+        }
+    }
+
+    // Arbitrary fields with a run-time lsb, from a wider word.
+    Buffer<uint32_t> words(W);
+    for (int i = 0; i < W; i++) {
+        words(i) = ((uint32_t)rand() << 16) ^ rand();
+    }
+    Func f4, f5;
+    f4(x) = extract_bits(words(x), (x * 3) % 27, 6);
+    f5(x) = extract_signed_bits(words(x), (x * 3) % 27, 6);
+    Buffer<uint32_t> im4 = f4.realize(W);
+    Buffer<int32_t> im5 = f5.realize(W);
+    for (int x = 0; x < W; x++) {
+        int lsb = (x * 3) % 27;
+        uint32_t correct = (words(x) >> lsb) & 0x3f;
+        if (im4(x) != correct) {
+            printf("extract_bits at %d -> %u instead of %u\n",
+                   x, im4(x), correct);
+            return -1;
+        }
+        int32_t correct_signed = (int32_t)(words(x) << (26 - lsb)) >> 26;
+        if (im5(x) != correct_signed) {
+            printf("extract_signed_bits at %d -> %d instead of %d\n",
+                   x, im5(x), correct_signed);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
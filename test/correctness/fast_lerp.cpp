@@ -0,0 +1,115 @@
+#include "Halide.h"
+#include <math.h>
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Var x, y, w;
+
+    // 8-bit: exhaustive over zero value, one value, and weight.
+    {
+        Func f;
+        f(x, y, w) = fast_lerp(cast<uint8_t>(x), cast<uint8_t>(y), cast<uint8_t>(w));
+        f.vectorize(x, 16);
+        Buffer<uint8_t> out = f.realize(256, 256, 256);
+
+        for (int wi = 0; wi < 256; wi++) {
+            for (int yi = 0; yi < 256; yi++) {
+                for (int xi = 0; xi < 256; xi++) {
+                    double correct = xi + (yi - xi) * (wi / 255.0);
+                    double err = fabs(out(xi, yi, wi) - correct);
+                    if (err > 2.5) {
+                        printf("fast_lerp(%d, %d, %d) = %d instead of %f\n",
+                               xi, yi, wi, out(xi, yi, wi), correct);
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    // 16-bit: sampled.
+    {
+        Func f;
+        Expr zero = cast<uint16_t>(x * 289);
+        Expr one = cast<uint16_t>(y * 325 + 7);
+        Expr weight = cast<uint16_t>(w * 257);
+        f(x, y, w) = fast_lerp(zero, one, weight);
+        f.vectorize(x, 8);
+        Buffer<uint16_t> out = f.realize(128, 128, 128);
+
+        for (int wi = 0; wi < 128; wi++) {
+            for (int yi = 0; yi < 128; yi++) {
+                for (int xi = 0; xi < 128; xi++) {
+                    uint16_t zero = (uint16_t)(xi * 289);
+                    uint16_t one = (uint16_t)(yi * 325 + 7);
+                    uint16_t weight = (uint16_t)(wi * 257);
+                    double correct = zero + (one - zero) * (weight / 65535.0);
+                    double err = fabs(out(xi, yi, wi) - correct);
+                    if (err > 2.5) {
+                        printf("fast_lerp(%d, %d, %d) = %d instead of %f\n",
+                               zero, one, weight, out(xi, yi, wi), correct);
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    // A float weight is also allowed.
+    {
+        Func f;
+        f(x, y) = fast_lerp(cast<uint8_t>(x), cast<uint8_t>(y), 0.25f);
+        f.vectorize(x, 16);
+        Buffer<uint8_t> out = f.realize(256, 256);
+        for (int yi = 0; yi < 256; yi++) {
+            for (int xi = 0; xi < 256; xi++) {
+                double correct = xi + (yi - xi) * 0.25;
+                if (fabs(out(xi, yi) - correct) > 2.5) {
+                    printf("fast_lerp(%d, %d, 0.25f) = %d instead of %f\n",
+                           xi, yi, out(xi, yi), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // bilerp is three exact lerps.
+    {
+        Buffer<uint8_t> in(32, 32);
+        for (int j = 0; j < 32; j++) {
+            for (int i = 0; i < 32; i++) {
+                in(i, j) = (uint8_t)(i * 17 + j * 43);
+            }
+        }
+
+        Func up;
+        Expr xf = cast<uint8_t>((x % 4) * 64);
+        Expr yf = cast<uint8_t>((y % 4) * 64);
+        Expr xi = min(x / 4, 30), yi = min(y / 4, 30);
+        up(x, y) = bilerp(in(xi, yi), in(xi + 1, yi),
+                          in(xi, yi + 1), in(xi + 1, yi + 1),
+                          xf, yf);
+        up.vectorize(x, 16);
+        Buffer<uint8_t> out = up.realize(120, 120);
+
+        for (int j = 0; j < 120; j++) {
+            for (int i = 0; i < 120; i++) {
+                int ii = std::min(i / 4, 30), jj = std::min(j / 4, 30);
+                double fx = ((i % 4) * 64) / 255.0, fy = ((j % 4) * 64) / 255.0;
+                double lower = in(ii, jj) + (in(ii + 1, jj) - in(ii, jj)) * fx;
+                double upper = in(ii, jj + 1) + (in(ii + 1, jj + 1) - in(ii, jj + 1)) * fx;
+                double correct = lower + (upper - lower) * fy;
+                if (fabs(out(i, j) - correct) > 2) {
+                    printf("bilerp at (%d, %d) = %d instead of %f\n",
+                           i, j, out(i, j), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "Halide.h"
+#include <math.h>
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    const int N = 4096;
+
+    // Arguments spanning several periods on either side of zero.
+    Func arg;
+    Var x;
+    arg(x) = (x - N / 2) * (40.0f / N);
+    Buffer<float> args = arg.realize(N);
+
+    struct Tier {
+        ApproximationPrecision precision;
+        const char *name;
+        float tolerance;
+    } tiers[] = {
+        {ApproximationPrecision::Fast, "Fast", 4e-3f},
+        {ApproximationPrecision::Medium, "Medium", 2e-5f},
+        {ApproximationPrecision::Accurate, "Accurate", 2e-6f},
+    };
+
+    for (const Tier &tier : tiers) {
+        Func s, c, t;
+        s(x) = fast_sin(args(x), tier.precision);
+        c(x) = fast_cos(args(x), tier.precision);
+        t(x) = fast_tanh(args(x), tier.precision);
+        s.vectorize(x, 8);
+        c.vectorize(x, 8);
+        t.vectorize(x, 8);
+
+        Buffer<float> sin_im = s.realize(N);
+        Buffer<float> cos_im = c.realize(N);
+        Buffer<float> tanh_im = t.realize(N);
+
+        for (int i = 0; i < N; i++) {
+            float a = args(i);
+            float sin_err = fabsf(sin_im(i) - sinf(a));
+            float cos_err = fabsf(cos_im(i) - cosf(a));
+            float tanh_err = fabsf(tanh_im(i) - tanhf(a));
+            if (sin_err > tier.tolerance) {
+                printf("fast_sin(%f) (%s) = %10.7f instead of %10.7f\n",
+                       a, tier.name, sin_im(i), sinf(a));
+                return -1;
+            }
+            if (cos_err > tier.tolerance) {
+                printf("fast_cos(%f) (%s) = %10.7f instead of %10.7f\n",
+                       a, tier.name, cos_im(i), cosf(a));
+                return -1;
+            }
+            if (tanh_err > tier.tolerance) {
+                printf("fast_tanh(%f) (%s) = %10.7f instead of %10.7f\n",
+                       a, tier.name, tanh_im(i), tanhf(a));
+                return -1;
+            }
+        }
+    }
+
+    // fast_erf matches erf.
+    {
+        Func e;
+        e(x) = fast_erf(args(x) / 8.0f);
+        e.vectorize(x, 8);
+        Buffer<float> erf_im = e.realize(N);
+        for (int i = 0; i < N; i++) {
+            float a = args(i) / 8.0f;
+            if (fabsf(erf_im(i) - erff(a)) > 1e-6f) {
+                printf("fast_erf(%f) = %10.7f instead of %10.7f\n",
+                       a, erf_im(i), erff(a));
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
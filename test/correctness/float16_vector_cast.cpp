@@ -0,0 +1,43 @@
+#include "Halide.h"
+#include <math.h>
+#include <stdio.h>
+
+using namespace Halide;
+
+// Exercises vectorized float16 <-> float32 casts. On x86 with the f16c
+// feature these should compile to vcvtph2ps/vcvtps2ph, but the result
+// must be identical everywhere.
+
+int main(int argc, char **argv) {
+    const int N = 1024;
+
+    Buffer<float> in(N);
+    for (int i = 0; i < N; i++) {
+        // A mix of magnitudes, including values that round when
+        // squeezed into a half, and denormals.
+        in(i) = (i - N / 2) * 0.123f + (i % 7) * 1e-5f;
+    }
+
+    Var x;
+
+    // Round-trip: compute in f32, store as f16, read back as f32.
+    Func to_half, back;
+    to_half(x) = cast<float16_t>(in(x));
+    back(x) = cast<float>(to_half(x));
+    to_half.compute_root().vectorize(x, 8);
+    back.vectorize(x, 8);
+
+    Buffer<float> out = back.realize(N);
+
+    for (int i = 0; i < N; i++) {
+        float correct = float(float16_t(in(i)));
+        if (out(i) != correct) {
+            printf("Round-tripping %f through float16 gave %f instead of %f\n",
+                   in(i), out(i), correct);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
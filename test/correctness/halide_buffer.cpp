@@ -68,6 +68,29 @@ int main(int argc, char **argv) {
         check_equal(a_window, b_window);
     }
 
+    {
+        // Check the dense fast paths in fill and copy_from against
+        // the general element-wise versions. Filling with a
+        // repeated-byte pattern and copying between identical dense
+        // layouts take memset/memcpy shortcuts; cropped windows fall
+        // back to the loop nest.
+        Buffer<int32_t> a(64, 48, 3), b(64, 48, 3);
+        a.fill(0x01010101);  // all bytes equal: uses memset
+        assert(a.all_equal(0x01010101));
+        a.fill(42);          // bytes differ: uses the loop nest
+        assert(a.all_equal(42));
+
+        b.fill([&](int x, int y, int c) { return x + 64 * y + 10000 * c; });
+        a.copy_from(b);  // same dense layout: one memcpy
+        check_equal(a, b);
+
+        a.fill(0);
+        Buffer<int32_t> a_window = a.cropped(0, 10, 20).cropped(1, 10, 20);
+        a_window.copy_from(b);  // not dense: loop nest
+        check_equal(a_window, b.cropped(0, 10, 20).cropped(1, 10, 20));
+        assert(a(0, 0, 0) == 0 && a(63, 47, 2) == 0);
+    }
+
     {
         // Check make a Buffer from a Buffer of a different type
         Buffer<float, 2> a(100, 80);
@@ -154,6 +177,73 @@ int main(int argc, char **argv) {
         assert(b.all_equal(42));
     }
 
+    {
+        // Check reusing an allocation for new shapes.
+        Buffer<float> a(100, 80, 3);
+        const void *host = a.data();
+
+        // Smaller shapes of any dimensionality reuse the allocation.
+        assert(a.try_reuse(80, 100, 3));
+        assert(a.data() == host);
+        assert(a.dim(0).extent() == 80 && a.dim(1).extent() == 100);
+        assert(a.dim(1).stride() == 80);
+
+        assert(a.try_reuse(100 * 80 * 3));
+        assert(a.data() == host);
+        assert(a.dimensions() == 1);
+
+        // A bigger shape does not fit, and leaves the buffer unchanged.
+        assert(!a.try_reuse(100, 80, 4));
+        assert(a.data() == host);
+        assert(a.dimensions() == 1);
+
+        a.fill(42.0f);
+        assert(a.all_equal(42.0f));
+
+        // A second reference to the allocation blocks reuse.
+        Buffer<float> b(a);
+        assert(!a.try_reuse(10));
+        b = Buffer<float>();
+        assert(a.try_reuse(10));
+
+        // An unallocated buffer can't be reused.
+        Buffer<float> c;
+        assert(!c.try_reuse(10));
+    }
+
+    {
+        // Check buffers with more dimensions than the inline shape
+        // storage. The heap shape metadata goes through a thread-local
+        // freelist, which this exercises.
+        for (int iter = 0; iter < 10; iter++) {
+            Buffer<int, 2> a(2, 3, 2, 2, 3);
+            assert(a.dimensions() == 5);
+            a.fill(iter);
+            assert(a.all_equal(iter));
+
+            // Growing the dimensionality reallocates the heap shape.
+            a.embed(5, 0);
+            assert(a.dimensions() == 6);
+
+            // Moves steal the heap shape rather than copying it.
+            Buffer<int, 2> b(std::move(a));
+            assert(b.dimensions() == 6);
+            assert(b.all_equal(iter));
+
+            a = std::move(b);
+            assert(a.dimensions() == 6);
+        }
+    }
+
+    {
+        // Moving a Buffer must not throw, so that containers of
+        // Buffers can offer the strong exception guarantee.
+        static_assert(std::is_nothrow_move_constructible<Buffer<float>>::value,
+                      "Buffer should be nothrow move constructible");
+        static_assert(std::is_nothrow_move_assignable<Buffer<float>>::value,
+                      "Buffer should be nothrow move assignable");
+    }
+
     {
         // Check the fields get zero-initialized with the default constructor.
         uint8_t buf[sizeof(Halide::Runtime::Buffer<float>)];
@@ -0,0 +1,81 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    {
+        // A producer computed per tile of a parallel consumer, with
+        // its allocation hoisted out to the row-of-tiles loop. Each
+        // thread should get one allocation that its tiles reuse.
+        Func f, g;
+        Var x, y, xo, yo, xi, yi;
+
+        f(x, y) = x + y;
+        g(x, y) = f(x, y) + f(x + 1, y + 1);
+
+        g.tile(x, y, xo, yo, xi, yi, 8, 8).parallel(yo);
+        f.compute_at(g, xo).hoist_storage(g, yo);
+
+        Buffer<int> out = g.realize(128, 128);
+        for (int y = 0; y < out.height(); y++) {
+            for (int x = 0; x < out.width(); x++) {
+                int correct = 2 * (x + y) + 2;
+                if (out(x, y) != correct) {
+                    printf("out(%d, %d) = %d instead of %d\n",
+                           x, y, out(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    {
+        // Hoisting all the way to the root of the pipeline.
+        Func f, g;
+        Var x, y, yo, yi;
+
+        f(x, y) = x * y;
+        g(x, y) = f(x, y) + 1;
+
+        g.split(y, yo, yi, 16);
+        f.compute_at(g, yo).hoist_storage_root();
+
+        Buffer<int> out = g.realize(100, 100);
+        for (int y = 0; y < out.height(); y++) {
+            for (int x = 0; x < out.width(); x++) {
+                int correct = x * y + 1;
+                if (out(x, y) != correct) {
+                    printf("out(%d, %d) = %d instead of %d\n",
+                           x, y, out(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    {
+        // An extent that varies with the loop being crossed: the
+        // hoisted allocation should be sized for the worst case.
+        Func f, g;
+        Var x, xo, xi;
+
+        f(x) = x;
+        g(x) = f(x / 2 + x % 3);
+
+        g.split(x, xo, xi, 10);
+        f.compute_at(g, xi).hoist_storage(g, xo);
+
+        Buffer<int> out = g.realize(50);
+        for (int x = 0; x < out.width(); x++) {
+            int correct = x / 2 + x % 3;
+            if (out(x) != correct) {
+                printf("out(%d) = %d instead of %d\n", x, out(x), correct);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
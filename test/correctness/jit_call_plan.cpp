@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include "Halide.h"
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    ImageParam in(Int(32), 1, "in");
+    Param<int32_t> bias("bias");
+
+    Var x("x");
+    Func f("f");
+    f(x) = in(x) * 2 + bias;
+
+    Target t = get_jit_target_from_environment();
+
+    const int size = 16;
+    Buffer<int> a(size), b(size);
+    for (int i = 0; i < size; i++) {
+        a(i) = i;
+        b(i) = i * 10;
+    }
+
+    Buffer<int> out(size);
+    Pipeline p(f);
+
+    // Marshal and validate the arguments once...
+    Pipeline::CallPlan plan = p.make_call_plan(Realization(out), t);
+
+    // ...then updates to scalar params and rebinding of image params
+    // are picked up by subsequent calls through the same plan.
+    in.set(a);
+    bias.set(7);
+    p.realize(plan);
+    for (int i = 0; i < size; i++) {
+        int correct = a(i) * 2 + 7;
+        if (out(i) != correct) {
+            printf("out(%d) = %d instead of %d\n", i, out(i), correct);
+            return -1;
+        }
+    }
+
+    in.set(b);
+    bias.set(100);
+    p.realize(plan);
+    for (int i = 0; i < size; i++) {
+        int correct = b(i) * 2 + 100;
+        if (out(i) != correct) {
+            printf("out(%d) = %d instead of %d\n", i, out(i), correct);
+            return -1;
+        }
+    }
+
+    // Many small realizations through one plan; this is the use case
+    // the plan exists for.
+    for (int iter = 0; iter < 1000; iter++) {
+        bias.set(iter);
+        p.realize(plan);
+        if (out(3) != b(3) * 2 + iter) {
+            printf("iter %d: out(3) = %d instead of %d\n", iter, out(3), b(3) * 2 + iter);
+            return -1;
+        }
+    }
+
+    // A plan can also resolve params through a ParamMap at
+    // plan-construction time.
+    ParamMap pm;
+    pm.set(bias, 42);
+    Pipeline::CallPlan plan2 = p.make_call_plan(Realization(out), t, pm);
+    bias.set(-1);  // should have no effect on plan2
+    p.realize(plan2);
+    for (int i = 0; i < size; i++) {
+        int correct = b(i) * 2 + 42;
+        if (out(i) != correct) {
+            printf("out(%d) = %d instead of %d\n", i, out(i), correct);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Param<float> val;
+
+    Func f("f"), g("g");
+    Var x("x"), y("y");
+
+    f(x, y) = val + cast<uint8_t>(x);
+    g(x, y) = f(x, y) + f(x - 1, y) + f(x + 1, y);
+
+    f.compute_root().memoize();
+
+    val.set(23.0f);
+
+    // Two realizations with the same param should be one miss
+    // followed by one hit.
+    g.realize(128, 128);
+    g.realize(128, 128);
+
+    halide_memoization_cache_stats stats;
+    Internal::JITSharedRuntime::memoization_cache_get_stats(&stats);
+
+    if (stats.misses < 1 || stats.stores < 1) {
+        printf("Expected at least one miss and one store: "
+               "misses = %llu, stores = %llu\n",
+               (unsigned long long)stats.misses,
+               (unsigned long long)stats.stores);
+        return -1;
+    }
+    if (stats.hits < 1) {
+        printf("Expected at least one hit: hits = %llu\n",
+               (unsigned long long)stats.hits);
+        return -1;
+    }
+    if (stats.bytes_in_use == 0) {
+        printf("Expected the cached result to be counted in bytes_in_use.\n");
+        return -1;
+    }
+
+    // Shrinking the cache to almost nothing should evict the entry.
+    Internal::JITSharedRuntime::memoization_cache_set_size(1);
+    Internal::JITSharedRuntime::memoization_cache_get_stats(&stats);
+    if (stats.evictions < 1) {
+        printf("Expected at least one eviction after shrinking the cache: "
+               "evictions = %llu\n",
+               (unsigned long long)stats.evictions);
+        return -1;
+    }
+    Internal::JITSharedRuntime::memoization_cache_set_size(0);
+
+    // The device budget is plumbed through the same way. Nothing here
+    // runs on a device, so no device bytes should be in use, but the
+    // limit should be settable and visible.
+    Internal::JITSharedRuntime::memoization_cache_set_device_size(1 << 20);
+    Internal::JITSharedRuntime::memoization_cache_get_stats(&stats);
+    if (stats.device_size_limit != (1 << 20)) {
+        printf("Expected device_size_limit = %d, got %lld\n",
+               1 << 20, (long long)stats.device_size_limit);
+        return -1;
+    }
+    if (stats.device_bytes_in_use != 0) {
+        printf("Expected no device bytes in use on a CPU target: %llu\n",
+               (unsigned long long)stats.device_bytes_in_use);
+        return -1;
+    }
+    Internal::JITSharedRuntime::memoization_cache_set_device_size(0);
+
+    printf("Success!\n");
+    return 0;
+}
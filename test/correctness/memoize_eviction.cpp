@@ -0,0 +1,67 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+int call_count[2];
+extern "C" DLLEXPORT int eviction_count_calls(int x, int idx) {
+    call_count[idx]++;
+    return x;
+}
+HalideExtern_2(int, eviction_count_calls, int, int);
+
+void check(int a, int b) {
+    if (call_count[0] != a || call_count[1] != b) {
+        printf("Call counts were %d/%d instead of %d/%d\n",
+               call_count[0], call_count[1], a, b);
+        exit(-1);
+    }
+}
+
+int main(int argc, char **argv) {
+    // Two memoized producers with different eviction tags, so that
+    // one group of cache entries can be flushed without the other.
+    Func f("f"), g("g"), out("out");
+    Var x("x");
+
+    f(x) = eviction_count_calls(x, 0);
+    g(x) = eviction_count_calls(x, 1);
+    out(x) = f(x) + g(x);
+
+    f.compute_root().memoize(1);
+    g.compute_root().memoize(2);
+
+    call_count[0] = call_count[1] = 0;
+
+    // First realization computes both.
+    out.realize(32);
+    check(32, 32);
+
+    // Second hits the cache for both.
+    out.realize(32);
+    check(32, 32);
+
+    // Evicting tag 1 forces f to be recomputed; g stays cached.
+    Internal::JITSharedRuntime::memoization_cache_evict(1);
+    out.realize(32);
+    check(64, 32);
+
+    // Evicting a tag nothing was stored under is a no-op.
+    Internal::JITSharedRuntime::memoization_cache_evict(3);
+    out.realize(32);
+    check(64, 32);
+
+    // Evicting tag 2 flushes g's entry.
+    Internal::JITSharedRuntime::memoization_cache_evict(2);
+    out.realize(32);
+    check(64, 64);
+
+    printf("Success!\n");
+    return 0;
+}
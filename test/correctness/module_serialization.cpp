@@ -0,0 +1,96 @@
+#include "Halide.h"
+#include <sstream>
+#include <stdio.h>
+
+#include "test/common/halide_test_dirs.h"
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Var x("x"), y("y");
+
+    // A pipeline with the interesting kinds of IR leaves: an input
+    // image, a scalar parameter, and an embedded constant buffer.
+    ImageParam input(Int(32), 2, "input");
+    Param<int> offset("offset");
+
+    Buffer<int> lut(8, "lut");
+    for (int i = 0; i < 8; i++) {
+        lut(i) = i * i;
+    }
+
+    Func f("f");
+    f(x, y) = input(x, y) + lut(x % 8) + offset;
+    f.vectorize(x, 4).parallel(y);
+
+    Target target = get_target_from_environment();
+    Module m = f.compile_to_module({input, offset}, "serialized_pipeline", target);
+
+    // Round-trip through the binary format.
+    std::stringstream blob;
+    serialize_module(m, blob);
+    Module m2 = deserialize_module(blob);
+
+    // The reconstructed module should describe the same thing.
+    if (m2.name() != m.name()) {
+        printf("Module name %s instead of %s\n",
+               m2.name().c_str(), m.name().c_str());
+        return -1;
+    }
+    if (m2.target() != m.target()) {
+        printf("Module target %s instead of %s\n",
+               m2.target().to_string().c_str(), m.target().to_string().c_str());
+        return -1;
+    }
+    if (m2.functions().size() != m.functions().size()) {
+        printf("Module has %d functions instead of %d\n",
+               (int)m2.functions().size(), (int)m.functions().size());
+        return -1;
+    }
+    for (size_t i = 0; i < m.functions().size(); i++) {
+        const Internal::LoweredFunc &a = m.functions()[i];
+        const Internal::LoweredFunc &b = m2.functions()[i];
+        if (a.name != b.name ||
+            a.args.size() != b.args.size() ||
+            a.linkage != b.linkage) {
+            printf("Function %s did not survive the round trip\n", a.name.c_str());
+            return -1;
+        }
+        std::ostringstream before, after;
+        before << a.body;
+        after << b.body;
+        if (before.str() != after.str()) {
+            printf("Body of %s did not survive the round trip:\n%s\nvs:\n%s\n",
+                   a.name.c_str(), before.str().c_str(), after.str().c_str());
+            return -1;
+        }
+    }
+    if (m2.buffers().size() != m.buffers().size()) {
+        printf("Module has %d buffers instead of %d\n",
+               (int)m2.buffers().size(), (int)m.buffers().size());
+        return -1;
+    }
+    for (size_t i = 0; i < m.buffers().size(); i++) {
+        Buffer<int> a = m.buffers()[i], b = m2.buffers()[i];
+        if (a.name() != b.name() || a.dimensions() != b.dimensions()) {
+            printf("Buffer %s did not survive the round trip\n", a.name().c_str());
+            return -1;
+        }
+        for (int j = 0; j < a.dim(0).extent(); j++) {
+            if (a(j) != b(j)) {
+                printf("Buffer %s element %d is %d instead of %d\n",
+                       a.name().c_str(), j, b(j), a(j));
+                return -1;
+            }
+        }
+    }
+
+    // The deserialized module should still be compilable.
+    std::string object_name = Internal::get_test_tmp_dir() + "module_serialization.o";
+    Internal::ensure_no_file_exists(object_name);
+    m2.compile(Outputs().object(object_name));
+    Internal::assert_file_exists(object_name);
+
+    printf("Success!\n");
+    return 0;
+}
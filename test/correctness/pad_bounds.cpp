@@ -0,0 +1,68 @@
+#include "Halide.h"
+
+using namespace Halide;
+
+int trace_min, trace_extent;
+int my_trace(void *user_context, const halide_trace_event_t *e) {
+    if (e->event == 2) {
+        trace_min = e->coordinates[0];
+        trace_extent = e->coordinates[1];
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    {
+        // Realize an intermediate with a two-pixel halo on either
+        // side of what its consumer needs.
+        Func f, g;
+        Var x;
+
+        f(x) = x * 2;
+        g(x) = f(x - 1) + f(x + 1);
+
+        f.compute_root().pad_bounds(x, 2, 2).trace_realizations();
+
+        g.set_custom_trace(my_trace);
+        Buffer<int> result = g.realize(10);
+
+        for (int i = 0; i < 10; i++) {
+            int correct = 4 * i;
+            if (result(i) != correct) {
+                printf("result(%d) = %d instead of %d\n", i, result(i), correct);
+                return -1;
+            }
+        }
+
+        // g needs f over [-1, 10]; the halo grows that to [-3, 12].
+        if (trace_min != -3 || trace_extent != 16) {
+            printf("%d: Wrong bounds: [%d, %d]\n", __LINE__, trace_min, trace_extent);
+            return -1;
+        }
+    }
+
+    {
+        // The padding composes with alignment: the halo is added
+        // first, then the bounds are rounded outwards.
+        Func f, g;
+        Var x;
+
+        f(x) = x;
+        g(x) = f(x);
+
+        f.compute_root().pad_bounds(x, 1, 1).align_bounds(x, 4).trace_realizations();
+
+        g.set_custom_trace(my_trace);
+        g.realize(10);
+
+        // g needs f over [0, 9]; padding gives [-1, 10], and aligning
+        // gives [-4, 11].
+        if (trace_min != -4 || trace_extent != 16) {
+            printf("%d: Wrong bounds: [%d, %d]\n", __LINE__, trace_min, trace_extent);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    const int size = 1 << 16;
+
+    Buffer<int> a(size), b(size);
+    for (int i = 0; i < size; i++) {
+        a(i) = rand() & 0xff;
+        b(i) = rand() & 0xff;
+    }
+
+    // A parallel dot product.
+    {
+        int reference = 0;
+        for (int i = 0; i < size; i++) {
+            reference += a(i) * b(i);
+        }
+
+        RDom r(0, size);
+        Func dot("dot");
+        dot() = 0;
+        dot() += a(r) * b(r);
+
+        dot.update().parallel_rfactor(r, 4096);
+
+        Buffer<int> result = dot.realize();
+        if (result() != reference) {
+            printf("Dot product was %d instead of %d\n", result(), reference);
+            return -1;
+        }
+    }
+
+    // A per-column reduction, with a task size that doesn't divide the
+    // reduction extent.
+    {
+        Buffer<int> input(100, 1000);
+        for (int y = 0; y < input.height(); y++) {
+            for (int x = 0; x < input.width(); x++) {
+                input(x, y) = rand() & 0xffff;
+            }
+        }
+
+        Var x("x");
+        RDom r(0, input.height());
+        Func col_max("col_max");
+        col_max(x) = 0;
+        col_max(x) = max(col_max(x), input(x, r));
+
+        Func intm = col_max.update().parallel_rfactor(r, 64);
+        // The intermediate can be scheduled further.
+        intm.update().vectorize(x, 8);
+
+        Buffer<int> result = col_max.realize(input.width());
+        for (int x = 0; x < input.width(); x++) {
+            int reference = 0;
+            for (int y = 0; y < input.height(); y++) {
+                reference = std::max(reference, input(x, y));
+            }
+            if (result(x) != reference) {
+                printf("Column max at %d was %d instead of %d\n",
+                       x, result(x), reference);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Buffer<int> input(100, 100);
+    for (int y = 0; y < input.height(); y++) {
+        for (int x = 0; x < input.width(); x++) {
+            input(x, y) = x * 3 + y * 7;
+        }
+    }
+
+    Var x("x"), y("y");
+
+    // A sheared access pattern. The conditions guarding the clamp in
+    // x depend on y, so the partition points of the inner loop depend
+    // on the outer loop variable. Loop partitioning should relax them
+    // over the range of y to produce a single rectangular interior
+    // core, while still computing the right thing in the strips near
+    // the boundary.
+    {
+        Func f("f");
+        f(x, y) = input(clamp(x + y, 0, input.width() - 1),
+                        clamp(y, 0, input.height() - 1)) * 2;
+        f.vectorize(x, 8);
+
+        Buffer<int> out = f.realize(100, 100);
+        for (int yy = 0; yy < out.height(); yy++) {
+            for (int xx = 0; xx < out.width(); xx++) {
+                int cx = std::min(std::max(xx + yy, 0), input.width() - 1);
+                int correct = input(cx, yy) * 2;
+                if (out(xx, yy) != correct) {
+                    printf("out(%d, %d) = %d instead of %d\n",
+                           xx, yy, out(xx, yy), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // A plain clamped stencil. The partition points of the inner loop
+    // don't depend on the outer loop at all, so they should get
+    // hoisted out of it. This is just a correctness check that the
+    // hoisting doesn't break anything.
+    {
+        Func g("g");
+        g(x, y) = input(clamp(x - 1, 0, input.width() - 1), y) +
+                  input(clamp(x + 1, 0, input.width() - 1), y);
+        g.vectorize(x, 8);
+
+        Buffer<int> out = g.realize(100, 100);
+        for (int yy = 0; yy < out.height(); yy++) {
+            for (int xx = 0; xx < out.width(); xx++) {
+                int lo = std::min(std::max(xx - 1, 0), input.width() - 1);
+                int hi = std::min(std::max(xx + 1, 0), input.width() - 1);
+                int correct = input(lo, yy) + input(hi, yy);
+                if (out(xx, yy) != correct) {
+                    printf("out(%d, %d) = %d instead of %d\n",
+                           xx, yy, out(xx, yy), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "Halide.h"
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count strict_float intrinsics in each Func's produce node.
+class CountStrictFloat : public IRVisitor {
+    using IRVisitor::visit;
+
+    std::string producer;
+
+    void visit(const ProducerConsumer *op) {
+        if (op->is_producer) {
+            std::string old = producer;
+            producer = op->name;
+            IRVisitor::visit(op);
+            producer = old;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+    void visit(const Call *op) {
+        if (op->is_intrinsic(Call::strict_float)) {
+            counts[producer]++;
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    std::map<std::string, int> counts;
+};
+
+int main(int argc, char **argv) {
+    Var x("x");
+    Func f("f"), g("g");
+
+    f(x) = sqrt(cast<float>(x));
+    g(x) = f(x) * 0.5f + f(x + 1) * 0.5f;
+
+    f.compute_root();
+
+    // Keep g's math strict while f still gets relaxed codegen.
+    g.strict_float();
+
+    Module m = g.compile_to_module({});
+    CountStrictFloat count;
+    m.functions()[0].body.accept(&count);
+
+    if (count.counts["f"] != 0) {
+        printf("f's produce node contains %d strict_float calls; expected none\n",
+               count.counts["f"]);
+        return -1;
+    }
+    if (count.counts["g"] == 0) {
+        printf("g's produce node contains no strict_float calls\n");
+        return -1;
+    }
+
+    // The pipeline should still compute the right thing.
+    Buffer<float> result = g.realize(16);
+    for (int i = 0; i < 16; i++) {
+        float correct = sqrtf((float)i) * 0.5f + sqrtf((float)(i + 1)) * 0.5f;
+        if (fabsf(result(i) - correct) > 1e-4f) {
+            printf("result(%d) = %f instead of %f\n", i, result(i), correct);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include "Halide.h"
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Param<int32_t> bias("bias");
+
+    Var x("x"), y("y");
+    Func g("g"), f("f");
+
+    g(x, y) = x * 3 + y;
+    f(x, y) = g(x, y) + g(x + 1, y) + bias;
+    g.compute_root();
+    f.parallel(y);
+
+    Target t = get_jit_target_from_environment();
+
+    // Realize a batch of small outputs in one call, each with its own
+    // value for the bias param.
+    const int batch_size = 20;
+    const int size = 64;
+    std::vector<Realization> outputs;
+    std::vector<ParamMap> param_maps(batch_size);
+    for (int i = 0; i < batch_size; i++) {
+        outputs.push_back(Realization(Buffer<int>(size, size)));
+        param_maps[i].set(bias, i * 100);
+    }
+
+    Pipeline p(f);
+    p.realize_batch(outputs, t, param_maps);
+
+    for (int i = 0; i < batch_size; i++) {
+        Buffer<int> im = outputs[i][0];
+        for (int yy = 0; yy < size; yy++) {
+            for (int xx = 0; xx < size; xx++) {
+                int correct = (xx * 3 + yy) + ((xx + 1) * 3 + yy) + i * 100;
+                if (im(xx, yy) != correct) {
+                    printf("batch item %d: im(%d, %d) = %d instead of %d\n",
+                           i, xx, yy, im(xx, yy), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // A batch sharing the currently-bound param value.
+    bias.set(7);
+    p.realize_batch(outputs, t);
+    for (int i = 0; i < batch_size; i++) {
+        Buffer<int> im = outputs[i][0];
+        for (int yy = 0; yy < size; yy++) {
+            for (int xx = 0; xx < size; xx++) {
+                int correct = (xx * 3 + yy) + ((xx + 1) * 3 + yy) + 7;
+                if (im(xx, yy) != correct) {
+                    printf("batch item %d: im(%d, %d) = %d instead of %d\n",
+                           i, xx, yy, im(xx, yy), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
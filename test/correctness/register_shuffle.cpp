@@ -380,6 +380,40 @@ int main(int argc, char **argv) {
         }
     }
 
+    {
+        // Sum across the lanes of a warp with an RDom. The serial
+        // reduction loop over the staged values becomes a butterfly
+        // shuffle sequence.
+        Func f;
+        Var x, y;
+        f(x, y) = cast<float>(x + 17 * y);
+        f.compute_root();
+
+        Func staged = f.in();
+
+        RDom r(0, 32);
+        Func g;
+        g(x, y) = sum(staged(r, y));
+
+        Var xi, yi;
+        g.gpu_tile(x, y, xi, yi, 32, 1, TailStrategy::RoundUp).gpu_lanes(xi);
+        staged.compute_at(g, yi).gpu_lanes(x);
+
+        Buffer<float> out = g.realize(32, 32);
+
+        for (int y = 0; y < out.height(); y++) {
+            for (int x = 0; x < out.width(); x++) {
+                float actual = out(x, y);
+                float correct = 496 + 544 * y;
+                if (correct != actual) {
+                    printf("out(%d, %d) = %f instead of %f\n",
+                           x, y, actual, correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
     printf("Success!\n");
     return 0;
 }
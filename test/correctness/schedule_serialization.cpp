@@ -0,0 +1,71 @@
+#include "Halide.h"
+#include <stdio.h>
+
+#include "test/common/halide_test_dirs.h"
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    std::string schedule_file =
+        Internal::get_test_tmp_dir() + "schedule_serialization.schedule";
+
+    // Build and schedule a pipeline, and save its schedule.
+    {
+        Func f("f"), g("g");
+        Var x("x"), y("y"), xo("xo"), xi("xi");
+
+        f(x, y) = x + y;
+        g(x, y) = f(x, y) * 2 + f(x + 1, y);
+
+        f.compute_at(g, y).store_root();
+        g.split(x, xo, xi, 8, TailStrategy::GuardWithIf)
+            .vectorize(xi)
+            .reorder(xo, y)
+            .parallel(y);
+
+        Pipeline(g).save_schedule(schedule_file);
+    }
+
+    // Build the same pipeline, unscheduled, and apply the saved
+    // schedule to it.
+    Func f("f"), g("g");
+    Var x("x"), y("y");
+
+    f(x, y) = x + y;
+    g(x, y) = f(x, y) * 2 + f(x + 1, y);
+
+    Pipeline p(g);
+    p.apply_schedule(schedule_file);
+
+    // The directives should have landed on the Funcs.
+    const Internal::StageSchedule &sched = g.function().definition().schedule();
+    if (sched.splits().size() != 1) {
+        printf("Expected one split on g after applying the schedule, got %d\n",
+               (int)sched.splits().size());
+        return -1;
+    }
+    bool vectorized = false;
+    for (const auto &d : sched.dims()) {
+        vectorized |= d.for_type == Internal::ForType::Vectorized;
+    }
+    if (!vectorized) {
+        printf("Expected a vectorized dimension on g after applying the schedule.\n");
+        return -1;
+    }
+
+    // And the pipeline should still compute the right thing.
+    Buffer<int> out = p.realize(100, 100);
+    for (int y = 0; y < out.height(); y++) {
+        for (int x = 0; x < out.width(); x++) {
+            int correct = (x + y) * 2 + (x + 1 + y);
+            if (out(x, y) != correct) {
+                printf("out(%d, %d) = %d instead of %d\n",
+                       x, y, out(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "test/common/check_asm.h"
 #include "test/common/halide_test_dirs.h"
 
 using namespace Halide;
@@ -41,6 +42,9 @@ struct Task {
     string name;
     int vector_width;
     Expr expr;
+    // If non-zero, also gate on the quality of the assembly: at most
+    // this many instructions, no vector spills, no scalarization.
+    int max_instructions{0};
 };
 
 size_t num_threads = Halide::Internal::ThreadPool<void>::num_processors_online();
@@ -190,7 +194,8 @@ struct Test {
         return wildcard_match("*" + p + "*", str);
     }
 
-    TestResult check_one(const string &op, const string &name, int vector_width, Expr e) const {
+    TestResult check_one(const string &op, const string &name, int vector_width, Expr e,
+                         int max_instructions = 0) const {
         std::ostringstream error_msg;
 
         // Define a vectorized Func that uses the pattern.
@@ -236,6 +241,38 @@ struct Test {
             }
 
             asm_file.close();
+
+            if (max_instructions > 0) {
+                // This op is also a quality gate: assert on the size
+                // and shape of the code, so codegen regressions (a
+                // pattern ceasing to fire, the register allocator
+                // spilling, an op scalarizing) fail here rather than
+                // showing up in production profiles.
+                std::ifstream asm_again(asm_filename);
+                auto quality = Halide::Internal::Test::analyze_assembly(asm_again);
+                if (quality.instructions > max_instructions) {
+                    error_msg << "Quality gate failed for " << name
+                              << " on target=" << target.to_string() << ": "
+                              << quality.instructions << " instructions, budget is "
+                              << max_instructions << ". See " << asm_filename << "\n";
+                }
+                if (quality.vector_stack_accesses > 0) {
+                    error_msg << "Quality gate failed for " << name
+                              << " on target=" << target.to_string() << ": "
+                              << quality.vector_stack_accesses
+                              << " vector spill(s) to the stack. See " << asm_filename << "\n";
+                }
+                // A handful of extracts can be legitimate (e.g. in a
+                // strip-mined epilogue); a pile of them means the op
+                // scalarized.
+                if (quality.lane_extracts > 4) {
+                    error_msg << "Quality gate failed for " << name
+                              << " on target=" << target.to_string() << ": "
+                              << quality.lane_extracts
+                              << " lane extracts/inserts suggest the op scalarized. See "
+                              << asm_filename << "\n";
+                }
+            }
         }
 
         // Also compile the error checking Func (to be sure it compiles without error)
@@ -275,6 +312,42 @@ struct Test {
         tasks.emplace_back(Task {op, name, vector_width, e});
     }
 
+    // Like check, but also gates on assembly quality (see Task).
+    void check_gated(string op, int vector_width, int max_instructions, Expr e) {
+        size_t before = tasks.size();
+        check(op, vector_width, e);
+        if (tasks.size() > before) {
+            tasks.back().max_instructions = max_instructions;
+        }
+    }
+
+    // A small set of kernels that should compile to tight,
+    // fully-vectorized, spill-free loops on every target we care
+    // about. The budgets are deliberately generous - they catch an op
+    // scalarizing or a codegen pattern ceasing to fire, not
+    // instruction-scheduling noise across LLVM versions.
+    void check_quality_all() {
+        Expr f32_1 = in_f32(x), f32_2 = in_f32(x+16), f32_3 = in_f32(x+32);
+        Expr i8_1  = in_i8(x),  i8_2  = in_i8(x+16);
+        Expr u8_1  = in_u8(x),  u8_2  = in_u8(x+16);
+        Expr i16_1 = in_i16(x), i16_2 = in_i16(x+16);
+        Expr i32_1 = in_i32(x), i32_2 = in_i32(x+16);
+
+        if (target.arch == Target::X86) {
+            check_gated("addps", 8, 48, f32_1 + f32_2);
+            check_gated("mulps", 8, 64, f32_1 * f32_2 + f32_3);
+            check_gated("paddd", 8, 48, i32_1 + i32_2);
+            check_gated("pmullw", 8, 48, i16_1 * i16_2);
+            check_gated("paddsb", 16, 64, i8_sat(i16(i8_1) + i16(i8_2)));
+            check_gated("pavgb", 16, 64, u8((u16(u8_1) + u16(u8_2) + 1)/2));
+        } else if (target.arch == Target::ARM) {
+            check_gated("vadd.i32", 4, 48, i32_1 + i32_2);
+            check_gated("vmul.i16", 8, 48, i16_1 * i16_2);
+            check_gated("vqadd.s8", 16, 64, i8_sat(i16(i8_1) + i16(i8_2)));
+            check_gated("vrhadd.u8", 16, 64, u8((u16(u8_1) + u16(u8_2) + 1)/2));
+        }
+    }
+
     void check_sse_all() {
         Expr f64_1 = in_f64(x), f64_2 = in_f64(x+16), f64_3 = in_f64(x+32);
         Expr f32_1 = in_f32(x), f32_2 = in_f32(x+16), f32_3 = in_f32(x+32);
@@ -2066,12 +2139,14 @@ check("v*.w += vrmpy(v*.b,v*.b)", hvx_width, i32_1 + i32(i8_1)*i8_1 + i32(i8_2)*
         } else if (target.arch == Target::POWERPC) {
             check_altivec_all();
         }
+        check_quality_all();
 
         Halide::Internal::ThreadPool<TestResult> pool(num_threads);
         std::vector<std::future<TestResult>> futures;
         for (const Task &task : tasks) {
             futures.push_back(pool.async([this, task]() {
-                return check_one(task.op, task.name, task.vector_width, task.expr);
+                return check_one(task.op, task.name, task.vector_width, task.expr,
+                                 task.max_instructions);
             }));
         }
 
@@ -610,6 +610,50 @@ int main(int argc, char **argv) {
         _halide_user_assert(vector_store_lanes == 32);
     }
 
+    {
+        Var x;
+        Param<int> p;
+
+        // Check that we prune specializations whose condition simplifies to
+        // that of an earlier one; the first match wins, so the later copy is
+        // unreachable and would just bloat the generated code.
+        Func f;
+        f(x) = x;
+        f.specialize(p == 0).vectorize(x, 32);       // will *not* be pruned
+        f.specialize(p == 7).vectorize(x, 16);       // will *not* be pruned
+        // Not structurally identical to the first condition (so specialize()
+        // adds a new specialization rather than returning the existing one),
+        // but simplifies to the same thing.
+        f.specialize(Expr(0) == p).vectorize(x, 8);  // will be pruned
+        f.vectorize(x, 4);                           // default case, not a specialization
+
+        _halide_user_assert(f.function().definition().specializations().size() == 3);
+
+        std::map<std::string, Internal::Function> env;
+        env.insert({f.function().name(), f.function()});
+        simplify_specializations(env);
+
+        _halide_user_assert(f.function().definition().specializations().size() == 2);
+
+        f.set_custom_trace(&my_trace);
+        f.trace_stores();
+
+        vector_store_lanes = 0;
+        p.set(0);
+        f.realize(100);
+        _halide_user_assert(vector_store_lanes == 32);
+
+        vector_store_lanes = 0;
+        p.set(7);
+        f.realize(100);
+        _halide_user_assert(vector_store_lanes == 16);
+
+        vector_store_lanes = 0;
+        p.set(42);  // just a value matching no specialization
+        f.realize(100);
+        _halide_user_assert(vector_store_lanes == 4);
+    }
+
     {
         Var x;
         Param<int> p;
@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include "Halide.h"
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Var x("x"), y("y");
+
+    {
+        // A large intermediate produced row-wise but consumed
+        // column-wise, stored in tiles.
+        Func f("f"), g("g");
+        f(x, y) = x * 3 + y * 7;
+        g(x, y) = f(y, x);
+
+        f.compute_root().tile_storage(x, y, 16, 16);
+
+        Buffer<int> result = g.realize(100, 50);
+        for (int yy = 0; yy < 50; yy++) {
+            for (int xx = 0; xx < 100; xx++) {
+                int correct = yy * 3 + xx * 7;
+                if (result(xx, yy) != correct) {
+                    printf("result(%d, %d) = %d instead of %d\n",
+                           xx, yy, result(xx, yy), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    {
+        // A Tuple-valued intermediate whose components are always
+        // read together, stored interleaved.
+        Func f("f"), g("g");
+        f(x, y) = Tuple(x + y, x - y);
+        g(x, y) = f(x, y)[0] * f(x, y)[1];
+
+        f.compute_root().interleave_storage();
+
+        Buffer<int> result = g.realize(64, 64);
+        for (int yy = 0; yy < 64; yy++) {
+            for (int xx = 0; xx < 64; xx++) {
+                int correct = (xx + yy) * (xx - yy);
+                if (result(xx, yy) != correct) {
+                    printf("result(%d, %d) = %d instead of %d\n",
+                           xx, yy, result(xx, yy), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    {
+        // Both at once.
+        Func f("f"), g("g");
+        f(x, y) = Tuple(x, y);
+        g(x, y) = f(y, x)[0] + f(y, x)[1];
+
+        f.compute_root().tile_storage(x, y, 8, 8).interleave_storage();
+
+        Buffer<int> result = g.realize(30, 70);
+        for (int yy = 0; yy < 70; yy++) {
+            for (int xx = 0; xx < 30; xx++) {
+                int correct = xx + yy;
+                if (result(xx, yy) != correct) {
+                    printf("result(%d, %d) = %d instead of %d\n",
+                           xx, yy, result(xx, yy), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
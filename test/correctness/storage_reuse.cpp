@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include "Halide.h"
+
+using namespace Halide;
+
+// Track the peak number of bytes allocated at once.
+
+size_t live_bytes = 0;
+size_t peak_bytes = 0;
+
+void *my_malloc(void *user_context, size_t x) {
+    live_bytes += x;
+    if (live_bytes > peak_bytes) {
+        peak_bytes = live_bytes;
+    }
+    void *orig = malloc(x + 64);
+    void *ptr = (void *)((((size_t)orig + 64) >> 5) << 5);
+    ((void **)ptr)[-1] = orig;
+    ((size_t *)ptr)[-2] = x;
+    return ptr;
+}
+
+void my_free(void *user_context, void *ptr) {
+    live_bytes -= ((size_t *)ptr)[-2];
+    free(((void **)ptr)[-1]);
+}
+
+int main(int argc, char **argv) {
+    // A chain of root-level stages. a is dead by the time c is
+    // produced, so a and c should share one allocation, keeping the
+    // peak at roughly two intermediate buffers rather than three.
+    Func a("a"), b("b"), c("c"), out("out");
+    Var x("x");
+
+    a(x) = x * 2;
+    b(x) = a(x) + a(x + 1);
+    c(x) = b(x) + b(x + 1);
+    out(x) = c(x) + c(x + 1);
+
+    a.compute_root();
+    b.compute_root();
+    c.compute_root();
+
+    out.set_custom_allocator(my_malloc, my_free);
+
+    const int size = 100000;
+    Buffer<int> im = out.realize(size);
+
+    for (int i = 0; i < size; i++) {
+        int correct = 8 * i + 16;
+        if (im(i) != correct) {
+            printf("im(%d) = %d instead of %d\n", i, im(i), correct);
+            return -1;
+        }
+    }
+
+    size_t buf_size = (size + 3) * sizeof(int);
+    if (peak_bytes > (5 * buf_size) / 2) {
+        printf("Peak allocation was %d bytes; expected at most two "
+               "intermediate buffers of %d bytes to be live at once.\n",
+               (int)peak_bytes, (int)buf_size);
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include "Halide.h"
+
+using namespace Halide;
+
+// Division truncates towards zero in C, but rounds towards negative
+// infinity in Halide, with a non-negative remainder.
+void euclidean_div_mod(int64_t a, int64_t b, int64_t &q, int64_t &r) {
+    q = a / b;
+    r = a - q * b;
+    if (r < 0) {
+        if (b > 0) {
+            q -= 1;
+            r += b;
+        } else {
+            q += 1;
+            r -= b;
+        }
+    }
+}
+
+template<typename T>
+bool test(const std::vector<int> &divisors) {
+    Param<T> d;
+    Var x;
+
+    Func num;
+    num(x) = cast<T>(x * x * 17 + x - 520);
+
+    Func f;
+    f(x) = {num(x) / d, num(x) % d};
+    f.vectorize(x, 8);
+
+    const int size = 1024;
+    for (int divisor : divisors) {
+        d.set((T)divisor);
+        Realization result = f.realize(size);
+        Buffer<T> q_im = result[0];
+        Buffer<T> r_im = result[1];
+        for (int i = 0; i < size; i++) {
+            T n = (T)(i * i * 17 + i - 520);
+            int64_t q, r;
+            euclidean_div_mod((int64_t)n, (int64_t)(T)divisor, q, r);
+            if (q_im(i) != (T)q || r_im(i) != (T)r) {
+                printf("%d / %d = %lld rem %lld, got %lld rem %lld\n",
+                       (int)n, divisor,
+                       (long long)(T)q, (long long)(T)r,
+                       (long long)q_im(i), (long long)r_im(i));
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    std::vector<int> unsigned_divisors = {1, 2, 3, 5, 7, 16, 25, 100, 255};
+    std::vector<int> signed_divisors = {1, 2, 3, 5, 7, 16, 25, 100,
+                                        -1, -2, -3, -16, -100};
+
+    if (!test<uint8_t>(unsigned_divisors) ||
+        !test<uint16_t>(unsigned_divisors) ||
+        !test<uint32_t>(unsigned_divisors) ||
+        !test<int8_t>(signed_divisors) ||
+        !test<int16_t>(signed_divisors) ||
+        !test<int32_t>(signed_divisors)) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "Halide.h"
+#include <map>
+#include <string>
+
+using namespace Halide;
+
+std::map<std::string, int> store_counts, realization_counts;
+
+int my_trace(void *user_context, const halide_trace_event_t *e) {
+    if (e->event == halide_trace_store) {
+        store_counts[e->func]++;
+    } else if (e->event == halide_trace_begin_realization) {
+        realization_counts[e->func]++;
+    }
+    return 0;
+}
+
+int check(const char *func, std::map<std::string, int> &counts, int correct) {
+    if (counts[func] != correct) {
+        printf("Saw %d events for %s instead of %d\n", counts[func], func, correct);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Func f("f"), g("g");
+    Var x;
+
+    f(x) = x;
+    g(x) = f(x) + 1;
+    f.compute_at(g, x);
+
+    g.set_custom_trace(&my_trace);
+
+    Target t = get_jit_target_from_environment()
+        .with_feature(Target::TraceStores)
+        .with_feature(Target::TraceRealizations);
+
+    // With no filter set, every Func is traced.
+    store_counts.clear();
+    g.realize(16, t);
+    if (check("f", store_counts, 16) < 0 ||
+        check("g", store_counts, 16) < 0) {
+        return -1;
+    }
+
+    // Restrict tracing to g by exact name.
+    Internal::JITSharedRuntime::trace_set_func_filter("g");
+    store_counts.clear();
+    g.realize(16, t);
+    if (check("f", store_counts, 0) < 0 ||
+        check("g", store_counts, 16) < 0) {
+        return -1;
+    }
+
+    // A trailing '*' matches by prefix.
+    Internal::JITSharedRuntime::trace_set_func_filter("f*");
+    store_counts.clear();
+    g.realize(16, t);
+    if (check("f", store_counts, 16) < 0 ||
+        check("g", store_counts, 0) < 0) {
+        return -1;
+    }
+
+    // Clear the filter and trace every 4th realization instead. f is
+    // realized 16 times (once per x), so 4 of them should be traced,
+    // each storing a single value. g's single realization is the
+    // first one seen, so it is always traced.
+    Internal::JITSharedRuntime::trace_set_func_filter("");
+    Internal::JITSharedRuntime::trace_set_sample_rate(4);
+    store_counts.clear();
+    realization_counts.clear();
+    g.realize(16, t);
+    if (check("f", realization_counts, 4) < 0 ||
+        check("f", store_counts, 4) < 0 ||
+        check("g", realization_counts, 1) < 0 ||
+        check("g", store_counts, 16) < 0) {
+        return -1;
+    }
+
+    Internal::JITSharedRuntime::trace_set_sample_rate(1);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+namespace {
+
+class CountAsserts : public IRVisitor {
+    using IRVisitor::visit;
+    void visit(const AssertStmt *op) override {
+        count++;
+        IRVisitor::visit(op);
+    }
+
+public:
+    int count = 0;
+};
+
+int count_asserts(const Stmt &s) {
+    CountAsserts c;
+    s.accept(&c);
+    return c.count;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    ImageParam in(Int(32), 1);
+
+    Var x;
+    Func f("f");
+    f(x) = in(x) + in(x + 1);
+
+    Target t = get_host_target().with_feature(Target::UncheckedEntry);
+    Module m = f.compile_to_module({in}, "f", t);
+
+    Stmt checked = m.get_function_by_name("f").body;
+    Stmt unchecked = m.get_function_by_name("f_unchecked").body;
+
+    if (count_asserts(checked) == 0) {
+        printf("The checked entry point should still contain assertions\n");
+        return -1;
+    }
+
+    if (count_asserts(unchecked) != 0) {
+        printf("The unchecked entry point should contain no assertions\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    const int groups = 256;
+
+    // Build a RAW10 stream: 4 10-bit samples packed into 5 bytes, with
+    // the four 2-bit remainders sharing the fifth byte.
+    const int samples10 = 4 * groups;
+    Buffer<uint16_t> vals10(samples10);
+    Buffer<uint8_t> raw10(5 * groups);
+    for (int g = 0; g < groups; g++) {
+        uint8_t lsbs = 0;
+        for (int j = 0; j < 4; j++) {
+            uint16_t v = (uint16_t)(rand() & 0x3ff);
+            vals10(4 * g + j) = v;
+            raw10(5 * g + j) = (uint8_t)(v >> 2);
+            lsbs |= (uint8_t)((v & 3) << (2 * j));
+        }
+        raw10(5 * g + 4) = lsbs;
+    }
+
+    {
+        Func unpacked, out;
+        Var j, g, x, xo, xi;
+        unpacked(j, g) = unpack_raw10(raw10(5 * g + j), raw10(5 * g + 4), j);
+        out(x) = unpacked(x % 4, x / 4);
+
+        out.split(x, xo, xi, 64).vectorize(xi, 16);
+        unpacked.compute_at(out, xo).vectorize(g);
+
+        Buffer<uint16_t> im = out.realize(samples10);
+        for (int x = 0; x < samples10; x++) {
+            if (im(x) != vals10(x)) {
+                printf("unpack_raw10 at %d -> %d instead of %d\n",
+                       x, im(x), vals10(x));
+                return -1;
+            }
+        }
+    }
+
+    // Same for RAW12: 2 12-bit samples packed into 3 bytes.
+    const int samples12 = 2 * groups;
+    Buffer<uint16_t> vals12(samples12);
+    Buffer<uint8_t> raw12(3 * groups);
+    for (int g = 0; g < groups; g++) {
+        uint8_t lsbs = 0;
+        for (int j = 0; j < 2; j++) {
+            uint16_t v = (uint16_t)(rand() & 0xfff);
+            vals12(2 * g + j) = v;
+            raw12(3 * g + j) = (uint8_t)(v >> 4);
+            lsbs |= (uint8_t)((v & 0xf) << (4 * j));
+        }
+        raw12(3 * g + 2) = lsbs;
+    }
+
+    {
+        Func unpacked, out;
+        Var j, g, x, xo, xi;
+        unpacked(j, g) = unpack_raw12(raw12(3 * g + j), raw12(3 * g + 2), j);
+        out(x) = unpacked(x % 2, x / 2);
+
+        out.split(x, xo, xi, 64).vectorize(xi, 16);
+        unpacked.compute_at(out, xo).vectorize(g);
+
+        Buffer<uint16_t> im = out.realize(samples12);
+        for (int x = 0; x < samples12; x++) {
+            if (im(x) != vals12(x)) {
+                printf("unpack_raw12 at %d -> %d instead of %d\n",
+                       x, im(x), vals12(x));
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include "Halide.h"
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Buffer<float> input(66, 66);
+    for (int y = 0; y < 66; y++) {
+        for (int x = 0; x < 66; x++) {
+            input(x, y) = (float)rand() / RAND_MAX;
+        }
+    }
+
+    Var x("x"), y("y");
+
+    // A 3x3 convolution, register-blocked over rows so that loads
+    // from input rows shared between adjacent output rows are only
+    // issued once.
+    Func conv("conv");
+    RDom r(0, 3, 0, 3);
+    conv(x, y) = 0.0f;
+    conv(x, y) += input(x + r.x, y + r.y);
+
+    conv.update()
+        .unroll(r.x)
+        .unroll(r.y)
+        .vectorize(x, 8)
+        .unroll_and_jam(y, 2);
+
+    Buffer<float> result = conv.realize(64, 64);
+
+    for (int yy = 0; yy < 64; yy++) {
+        for (int xx = 0; xx < 64; xx++) {
+            float correct = 0.0f;
+            for (int ry = 0; ry < 3; ry++) {
+                for (int rx = 0; rx < 3; rx++) {
+                    correct += input(xx + rx, yy + ry);
+                }
+            }
+            if (fabs(result(xx, yy) - correct) > 1e-4) {
+                printf("result(%d, %d) = %f instead of %f\n",
+                       xx, yy, result(xx, yy), correct);
+                return -1;
+            }
+        }
+    }
+
+    // Also check that unroll_and_jam of an RVar refuses to sink past
+    // another RVar but still works when it only crosses pure dims.
+    Func hist("hist");
+    RDom s(0, 64);
+    hist(x) = 0.0f;
+    hist(x) += input(x, s);
+    hist.update().unroll_and_jam(s, 4);
+
+    Buffer<float> sums = hist.realize(64);
+    for (int xx = 0; xx < 64; xx++) {
+        float correct = 0.0f;
+        for (int yy = 0; yy < 64; yy++) {
+            correct += input(xx, yy);
+        }
+        if (fabs(sums(xx) - correct) > 1e-3) {
+            printf("sums(%d) = %f instead of %f\n", xx, sums(xx), correct);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    // A reduction guarded by a where clause that can't be turned into
+    // loop bounds. With 16-bit values most targets have no masked
+    // stores, so vectorizing the guarded update used to scalarize it;
+    // it should now stay vectorized by blending each store against
+    // the old value.
+    const int W = 128, H = 64;
+
+    Buffer<uint16_t> input(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            input(x, y) = (uint16_t)(rand() & 0xff);
+        }
+    }
+
+    Var x("x"), y("y");
+    RDom r(0, W, "r");
+
+    Func f("f");
+    f(x, y) = cast<uint16_t>(0);
+    f(x, y) += select(((x + r) % 3) == 0, input(r, y), cast<uint16_t>(0));
+
+    Func g("g");
+    RDom r2(0, W, "r2");
+    r2.where(((x + r2) % 3) == 0);
+    g(x, y) = cast<uint16_t>(0);
+    g(x, y) += input(r2, y);
+
+    g.update().vectorize(x, 8);
+
+    Buffer<uint16_t> ref = f.realize(W, H);
+    Buffer<uint16_t> out = g.realize(W, H);
+
+    for (int yy = 0; yy < H; yy++) {
+        for (int xx = 0; xx < W; xx++) {
+            if (out(xx, yy) != ref(xx, yy)) {
+                printf("out(%d, %d) = %d instead of %d\n",
+                       xx, yy, out(xx, yy), ref(xx, yy));
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
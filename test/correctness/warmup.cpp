@@ -0,0 +1,34 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Func f("f");
+    Var x("x"), y("y");
+
+    f(x, y) = x + y;
+    f.parallel(y);
+
+    // Warming up should do all of the lazy initialization (jit
+    // compilation, worker thread creation, device contexts) without
+    // running the pipeline.
+    f.warmup();
+
+    // Warming up twice should be harmless.
+    f.warmup();
+
+    Buffer<int> out = f.realize(64, 64);
+    for (int y = 0; y < out.height(); y++) {
+        for (int x = 0; x < out.width(); x++) {
+            if (out(x, y) != x + y) {
+                printf("out(%d, %d) = %d instead of %d\n",
+                       x, y, out(x, y), x + y);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    const int W = 256;
+
+    Buffer<uint8_t> in_a(W), in_b(W);
+    for (int x = 0; x < W; x++) {
+        in_a(x) = (uint8_t)((x * 17 + 3) % 256);
+        in_b(x) = (uint8_t)((x * 31 + 120) % 256);
+    }
+
+    Var x;
+    Func wa, wm, ha, hs, rha, sa, ss;
+    wa(x) = widening_add(in_a(x), in_b(x));
+    wm(x) = widening_mul(in_a(x), in_b(x));
+    ha(x) = halving_add(in_a(x), in_b(x));
+    hs(x) = halving_sub(cast<int8_t>(in_a(x) / 2), cast<int8_t>(in_b(x) / 2));
+    rha(x) = rounding_halving_add(in_a(x), in_b(x));
+    sa(x) = saturating_add(in_a(x), in_b(x));
+    ss(x) = saturating_sub(in_a(x), in_b(x));
+
+    Buffer<uint16_t> wa_im = wa.realize(W);
+    Buffer<uint16_t> wm_im = wm.realize(W);
+    Buffer<uint8_t> ha_im = ha.realize(W);
+    Buffer<int8_t> hs_im = hs.realize(W);
+    Buffer<uint8_t> rha_im = rha.realize(W);
+    Buffer<uint8_t> sa_im = sa.realize(W);
+    Buffer<uint8_t> ss_im = ss.realize(W);
+
+    for (int i = 0; i < W; i++) {
+        int a = in_a(i), b = in_b(i);
+        int sb = (int8_t)(in_b(i) / 2), sc = (int8_t)(in_a(i) / 2);
+
+        uint16_t correct_wa = (uint16_t)(a + b);
+        if (wa_im(i) != correct_wa) {
+            printf("widening_add(%d, %d) = %d instead of %d\n", a, b, wa_im(i), correct_wa);
+            return -1;
+        }
+
+        uint16_t correct_wm = (uint16_t)(a * b);
+        if (wm_im(i) != correct_wm) {
+            printf("widening_mul(%d, %d) = %d instead of %d\n", a, b, wm_im(i), correct_wm);
+            return -1;
+        }
+
+        uint8_t correct_ha = (uint8_t)((a + b) / 2);
+        if (ha_im(i) != correct_ha) {
+            printf("halving_add(%d, %d) = %d instead of %d\n", a, b, ha_im(i), correct_ha);
+            return -1;
+        }
+
+        // Halide's division rounds towards negative infinity, so
+        // halving a signed difference is an arithmetic shift right.
+        int diff = sc - sb;
+        int8_t correct_hs = (int8_t)(diff >> 1);
+        if (hs_im(i) != correct_hs) {
+            printf("halving_sub(%d, %d) = %d instead of %d\n", sc, sb, hs_im(i), correct_hs);
+            return -1;
+        }
+
+        uint8_t correct_rha = (uint8_t)((a + b + 1) / 2);
+        if (rha_im(i) != correct_rha) {
+            printf("rounding_halving_add(%d, %d) = %d instead of %d\n", a, b, rha_im(i), correct_rha);
+            return -1;
+        }
+
+        uint8_t correct_sa = (uint8_t)(a + b > 255 ? 255 : a + b);
+        if (sa_im(i) != correct_sa) {
+            printf("saturating_add(%d, %d) = %d instead of %d\n", a, b, sa_im(i), correct_sa);
+            return -1;
+        }
+
+        uint8_t correct_ss = (uint8_t)(a - b < 0 ? 0 : a - b);
+        if (ss_im(i) != correct_ss) {
+            printf("saturating_sub(%d, %d) = %d instead of %d\n", a, b, ss_im(i), correct_ss);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
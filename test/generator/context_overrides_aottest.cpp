@@ -0,0 +1,125 @@
+#include <math.h>
+#include <stdio.h>
+#include <assert.h>
+#include <atomic>
+
+#include "HalideRuntime.h"
+#include "HalideBuffer.h"
+#include "context_overrides.h"
+
+using namespace Halide::Runtime;
+
+// Two tenants sharing one process, each with its own counters. The
+// context pointers double as the per-tenant state.
+struct Tenant {
+    std::atomic<int> mallocs{0};
+    std::atomic<int> frees{0};
+    std::atomic<int> par_fors{0};
+    std::atomic<bool> errored{false};
+};
+
+static Tenant tenant_a, tenant_b;
+
+// The process-global hooks, which unregistered contexts should still hit.
+static std::atomic<int> global_mallocs{0};
+static std::atomic<int> global_frees{0};
+
+void *tenant_malloc(void *context, size_t sz) {
+    ((Tenant *)context)->mallocs++;
+    return halide_default_malloc(context, sz);
+}
+
+void tenant_free(void *context, void *ptr) {
+    ((Tenant *)context)->frees++;
+    halide_default_free(context, ptr);
+}
+
+int tenant_do_par_for(void *context, halide_task_t f,
+                      int min, int size, uint8_t *closure) {
+    ((Tenant *)context)->par_fors++;
+    return halide_default_do_par_for(context, f, min, size, closure);
+}
+
+void tenant_error(void *context, const char *msg) {
+    // Don't abort, unlike the default handler.
+    ((Tenant *)context)->errored = true;
+}
+
+void *global_malloc(void *context, size_t sz) {
+    global_mallocs++;
+    return halide_default_malloc(context, sz);
+}
+
+void global_free(void *context, void *ptr) {
+    global_frees++;
+    halide_default_free(context, ptr);
+}
+
+int main(int argc, char **argv) {
+    Buffer<float> input(10, 10);
+    for (int y = 0; y < 10; y++) {
+        for (int x = 0; x < 10; x++) {
+            input(x, y) = 1;
+        }
+    }
+    Buffer<float> output(10, 10);
+
+    halide_runtime_overrides_t overrides_a = {0};
+    overrides_a.custom_malloc = tenant_malloc;
+    overrides_a.custom_free = tenant_free;
+    overrides_a.custom_do_par_for = tenant_do_par_for;
+    overrides_a.custom_error = tenant_error;
+
+    // B overrides the allocator only; everything else should fall
+    // back to the process-global hooks.
+    halide_runtime_overrides_t overrides_b = {0};
+    overrides_b.custom_malloc = tenant_malloc;
+    overrides_b.custom_free = tenant_free;
+
+    assert(halide_set_context_overrides(&tenant_a, &overrides_a) == 0);
+    assert(halide_set_context_overrides(&tenant_b, &overrides_b) == 0);
+    halide_set_custom_malloc(global_malloc);
+    halide_set_custom_free(global_free);
+
+    // Tenant A's hooks fire; tenant B's and the globals don't.
+    int result = context_overrides(&tenant_a, input, output);
+    assert(result == 0);
+    assert(tenant_a.mallocs > 0 && tenant_a.frees > 0 && tenant_a.par_fors > 0);
+    assert(tenant_b.mallocs == 0 && global_mallocs == 0);
+
+    // Tenant B's allocator fires, independently of A.
+    int a_mallocs = tenant_a.mallocs;
+    result = context_overrides(&tenant_b, input, output);
+    assert(result == 0);
+    assert(tenant_b.mallocs > 0 && tenant_b.frees > 0);
+    assert(tenant_b.par_fors == 0);  // not overridden for B
+    assert(tenant_a.mallocs == a_mallocs);
+
+    // An unregistered context falls through to the globals.
+    Tenant tenant_c;
+    result = context_overrides(&tenant_c, input, output);
+    assert(result == 0);
+    assert(global_mallocs > 0 && global_frees > 0);
+    assert(tenant_c.mallocs == 0);
+
+    // A's error override fires on a bounds error, without touching B.
+    Buffer<float> big_output(11, 11);
+    result = context_overrides(&tenant_a, input, big_output);
+    assert(result != 0);
+    assert(tenant_a.errored && !tenant_b.errored);
+
+    // Clearing A's registration restores the global hooks.
+    assert(halide_set_context_overrides(&tenant_a, NULL) == 0);
+    a_mallocs = tenant_a.mallocs;
+    int g_mallocs = global_mallocs;
+    result = context_overrides(&tenant_a, input, output);
+    assert(result == 0);
+    assert(tenant_a.mallocs == a_mallocs);
+    assert(global_mallocs > g_mallocs);
+
+    // NULL identifies no tenant and can't register overrides.
+    assert(halide_set_context_overrides(NULL, &overrides_a) != 0);
+
+    printf("Success!\n");
+    return 0;
+}
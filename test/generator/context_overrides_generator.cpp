@@ -0,0 +1,28 @@
+#include "Halide.h"
+
+namespace {
+
+class ContextOverrides : public Halide::Generator<ContextOverrides> {
+public:
+    Input<Buffer<float>>  input{"input", 2};
+    Output<Buffer<float>> output{"output", 2};
+
+    void generate() {
+        Var x, y;
+
+        // A compute_root intermediate forces a halide_malloc, and the
+        // parallel output loop goes through halide_do_par_for, so the
+        // per-context overrides for both get exercised.
+        Func g;
+        g(x, y) = input(x, y) * 2;
+        g.compute_root();
+
+        output(x, y) = g(x, y);
+
+        output.parallel(y);
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(ContextOverrides, context_overrides)
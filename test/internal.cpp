@@ -14,6 +14,7 @@
 #include "Monotonic.h"
 #include "Reduction.h"
 #include "Interval.h"
+#include "LoopCarry.h"
 #include "Associativity.h"
 #include "Generator.h"
 #include "AutoScheduleUtils.h"
@@ -36,6 +37,7 @@ int main(int argc, const char **argv) {
     is_monotonic_test();
     split_predicate_test();
     interval_test();
+    loop_carry_test();
     associativity_test();
     generator_test();
     propagate_estimate_test();
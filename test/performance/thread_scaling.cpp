@@ -0,0 +1,188 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Measures how representative kernels scale as the thread pool grows
+// from 1 to the machine's core count, via halide_set_num_threads.
+// Parallel efficiency at t threads is (time at 1 thread) / (t * time
+// at t threads): 1.0 is perfect scaling. A thread pool regression can
+// leave low-count numbers flat while wrecking the high end, so the
+// whole curve is printed and the top of the curve is what's checked.
+//
+// If HL_THREAD_SCALING_BASELINE names a file, the efficiency at the
+// maximum thread count is compared per-kernel against the values
+// stored there, and the test fails on a regression of more than 20%.
+// If the file doesn't exist yet it is written, so a first run on a
+// quiet machine establishes the baseline. Without the variable the
+// test only warns, like the other parallel performance tests, since
+// absolute scaling is very machine- and load-dependent.
+
+struct ScalingResult {
+    const char *name;
+    // Efficiency at the largest thread count measured.
+    double efficiency;
+};
+
+std::vector<int> thread_counts() {
+    int max_threads = (int)std::thread::hardware_concurrency();
+    if (max_threads < 1) {
+        max_threads = 1;
+    }
+    std::vector<int> counts;
+    for (int t = 1; t < max_threads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(max_threads);
+    return counts;
+}
+
+// Benchmark fn at each thread count and return the efficiency at the
+// largest one, printing the whole curve.
+template<typename Fn>
+double measure_scaling(const char *name, Fn fn) {
+    printf("%s:\n", name);
+    double time_at_one = 0;
+    double efficiency = 1;
+    for (int t : thread_counts()) {
+        halide_set_num_threads(t);
+        // Let the pool grow/shrink before timing.
+        fn();
+        double time = benchmark([&]() { fn(); });
+        if (t == 1) {
+            time_at_one = time;
+        }
+        efficiency = time_at_one / (t * time);
+        printf("  %3d threads: %8.3f ms  speedup: %6.2f  efficiency: %.2f\n",
+               t, time * 1e3, time_at_one / time, efficiency);
+    }
+    return efficiency;
+}
+
+int main(int argc, char **argv) {
+    const int W = 2048, H = 2048;
+
+    Buffer<float> input(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            input(x, y) = (float)((x * 17 + y * 31) % 256);
+        }
+    }
+
+    std::vector<ScalingResult> results;
+
+    {
+        // Compute-heavy blur-like stencil.
+        Var x, y, xi, yi;
+        Func blur_x, blur_y;
+        blur_x(x, y) = (input(clamp(x - 1, 0, W - 1), y) +
+                        input(x, y) +
+                        input(clamp(x + 1, 0, W - 1), y)) / 3.0f;
+        blur_y(x, y) = (blur_x(x, clamp(y - 1, 0, H - 1)) +
+                        blur_x(x, y) +
+                        blur_x(x, clamp(y + 1, 0, H - 1))) / 3.0f;
+        blur_y.tile(x, y, xi, yi, 64, 32)
+            .parallel(y)
+            .vectorize(xi, 8);
+        blur_x.compute_at(blur_y, x).vectorize(x, 8);
+
+        Buffer<float> out(W, H);
+        double e = measure_scaling("blur", [&]() { blur_y.realize(out); });
+        results.push_back({"blur", e});
+    }
+
+    {
+        // Reduction-heavy: a full sum parallelized with rfactor.
+        Var u, x;
+        RVar rxo, rxi;
+        RDom r(0, W * H);
+        Func in2;
+        in2(x) = input(x % W, x / W);
+        in2.compute_root().vectorize(x, 8).parallel(x, 64 * 1024);
+
+        Func total;
+        total() = 0.0f;
+        total() += in2(r.x);
+        total.update().split(r.x, rxo, rxi, 64 * 1024);
+        Func intm = total.update().rfactor(rxo, u);
+        intm.compute_root()
+            .update()
+            .parallel(u)
+            .vectorize(rxi, 8);
+
+        Buffer<float> out = Buffer<float>::make_scalar();
+        double e = measure_scaling("rfactor sum", [&]() { total.realize(out); });
+        results.push_back({"rfactor_sum", e});
+    }
+
+    {
+        // Memory-bound copy.
+        Var x, y;
+        Func copy;
+        copy(x, y) = input(x, y);
+        copy.parallel(y, 16).vectorize(x, 8);
+
+        Buffer<float> out(W, H);
+        double e = measure_scaling("copy", [&]() { copy.realize(out); });
+        results.push_back({"copy", e});
+    }
+
+    halide_set_num_threads(0);  // restore the default
+
+    const char *baseline_path = getenv("HL_THREAD_SCALING_BASELINE");
+    if (baseline_path) {
+        FILE *f = fopen(baseline_path, "r");
+        if (f) {
+            // Compare against the stored curve endpoints.
+            bool ok = true;
+            char name[64];
+            double stored;
+            while (fscanf(f, "%63s %lf", name, &stored) == 2) {
+                for (const ScalingResult &r : results) {
+                    if (strcmp(r.name, name) == 0 && r.efficiency < 0.8 * stored) {
+                        printf("Efficiency of %s regressed: %.2f vs stored %.2f\n",
+                               name, r.efficiency, stored);
+                        ok = false;
+                    }
+                }
+            }
+            fclose(f);
+            if (!ok) {
+                return -1;
+            }
+        } else {
+            // First run: record the baseline.
+            f = fopen(baseline_path, "w");
+            if (!f) {
+                printf("Could not write baseline file %s\n", baseline_path);
+                return -1;
+            }
+            for (const ScalingResult &r : results) {
+                fprintf(f, "%s %f\n", r.name, r.efficiency);
+            }
+            fclose(f);
+            printf("Wrote baseline to %s\n", baseline_path);
+        }
+    } else {
+        // Without a baseline, just sanity-check that adding threads
+        // helped at all on multi-core machines. Exact efficiency is
+        // too machine- and load-dependent to hard-fail on.
+        if (thread_counts().back() >= 4) {
+            for (const ScalingResult &r : results) {
+                if (r.efficiency * thread_counts().back() < 1.5) {
+                    fprintf(stderr, "WARNING: %s showed no parallel speedup\n", r.name);
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -3,8 +3,12 @@
 #include "halide_benchmark.h"
 #include "halide_image_io.h"
 
+#include <algorithm>
+#include <cctype>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <map>
@@ -14,6 +18,13 @@
 #include <string>
 #include <vector>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 extern "C" int halide_rungen_redirect_argv(void **args);
 extern "C" const struct halide_filter_metadata_t *halide_rungen_redirect_metadata();
 
@@ -48,6 +59,9 @@ std::ostream &operator<<(std::ostream &stream, const halide_type_t &type) {
         case halide_type_handle:
             stream << "handle";
             break;
+        case halide_type_bfloat:
+            stream << "bfloat";
+            break;
         default:
             stream << "#unknown";
             break;
@@ -319,6 +333,10 @@ auto dynamic_type_dispatch(const halide_type_t &type, Args&&... args) ->
         HANDLE_CASE(halide_type_uint, 32, uint32_t)
         HANDLE_CASE(halide_type_uint, 64, uint64_t)
         HANDLE_CASE(halide_type_handle, 64, void*)
+        // bfloat16 buffers are handled as raw 16-bit patterns; RunGen
+        // can allocate, zero-fill, and copy them, but doesn't interpret
+        // their values numerically.
+        HANDLE_CASE(halide_type_bfloat, 16, uint16_t)
         default:
             fail() << "Unsupported type: " << type << "\n";
             using ReturnType = decltype(std::declval<Functor<uint8_t>>()(std::forward<Args>(args)...));
@@ -611,13 +629,525 @@ Buffer<> adjust_buffer_dims(const std::string &title, const std::string &name, c
     return b;
 }
 
+// Return the file extension of the pathname (after the last '.'),
+// lowercased, or an empty string if there is none.
+std::string get_lowercase_extension(const std::string &pathname) {
+    size_t dot = pathname.rfind('.');
+    if (dot == std::string::npos) {
+        return "";
+    }
+    std::string ext = pathname.substr(dot + 1);
+    for (char &c : ext) {
+        c = (char) std::tolower(c);
+    }
+    return ext;
+}
+
+std::string type_to_string(const halide_type_t &type) {
+    std::ostringstream o;
+    o << type;
+    return o.str();
+}
+
+// Parse strings of the sort produced by operator<<(halide_type_t)
+// (e.g. "float32", "uint8", "bool") back into a halide_type_t.
+bool parse_type_string(const std::string &str, halide_type_t *type) {
+    if (str == "bool") {
+        *type = halide_type_t(halide_type_uint, 1);
+        return true;
+    }
+    size_t i = 0;
+    while (i < str.size() && std::isalpha(str[i])) {
+        i++;
+    }
+    const std::string code_name = str.substr(0, i);
+    halide_type_code_t code;
+    if (code_name == "int") {
+        code = halide_type_int;
+    } else if (code_name == "uint") {
+        code = halide_type_uint;
+    } else if (code_name == "float") {
+        code = halide_type_float;
+    } else if (code_name == "bfloat") {
+        code = halide_type_bfloat;
+    } else {
+        return false;
+    }
+    int bits;
+    if (!parse_scalar(str.substr(i), &bits) ||
+        (bits != 8 && bits != 16 && bits != 32 && bits != 64) ||
+        (code == halide_type_bfloat && bits != 16)) {
+        return false;
+    }
+    *type = halide_type_t(code, (uint8_t) bits);
+    return true;
+}
+
+// Map an entire file into memory, read-only from the file's point of view
+// but copy-on-write from ours (so a filter that dirties an input buffer
+// won't fault). The mapping is deliberately never unmapped: the Buffers we
+// wrap around it live until exit, and RunGen is a one-shot tool, so letting
+// process teardown reclaim it is both safe and simplest. The point of
+// mapping (rather than reading) is that a multi-GB input is paged in lazily
+// as the filter touches it instead of being copied up front.
+void *map_file_for_input(const std::string &pathname, size_t *size_out) {
+#ifndef _WIN32
+    int fd = open(pathname.c_str(), O_RDONLY);
+    if (fd < 0) {
+        fail() << "Unable to open: " << pathname;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        fail() << "Unable to stat: " << pathname;
+    }
+    *size_out = (size_t) st.st_size;
+    void *base = mmap(nullptr, *size_out, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fail() << "Unable to mmap: " << pathname;
+    }
+    return base;
+#else
+    // No mmap on Windows (without extra machinery); just read the whole
+    // file. Correct, but loses the lazy-paging benefit.
+    std::ifstream f(pathname, std::ios::binary | std::ios::ate);
+    if (!f.good()) {
+        fail() << "Unable to open: " << pathname;
+    }
+    *size_out = (size_t) f.tellg();
+    f.seekg(0, std::ios::beg);
+    void *base = malloc(*size_out);
+    if (!base || !f.read((char *) base, *size_out)) {
+        fail() << "Unable to read: " << pathname;
+    }
+    return base;
+#endif
+}
+
+bool is_dense_planar(const Buffer<> &b) {
+    int32_t expected_stride = 1;
+    for (int i = 0; i < b.dimensions(); ++i) {
+        if (b.dim(i).stride() != expected_stride) {
+            return false;
+        }
+        expected_stride *= b.dim(i).extent();
+    }
+    return true;
+}
+
+// Return a version of the buffer that is dense and planar (dimension 0
+// has stride 1, etc.), copying it if it isn't already.
+Buffer<> make_dense_planar(const Buffer<> &b) {
+    if (is_dense_planar(b)) {
+        return b;
+    }
+    Shape shape = get_shape(b);
+    int32_t stride = 1;
+    for (size_t i = 0; i < shape.size(); ++i) {
+        shape[i].stride = stride;
+        stride *= shape[i].extent;
+    }
+    Buffer<> dense = allocate_buffer(b.type(), shape);
+    dense.copy_from(b);
+    return dense;
+}
+
+// ---------------------------------------------------------------
+// NumPy .npy support. Format reference:
+// https://docs.scipy.org/doc/numpy/neps/npy-format.html
+
+// Map a numpy dtype descr (e.g. '<f4', '|u1') to a halide_type_t.
+// Only little-endian (or endian-agnostic single-byte) types are supported.
+halide_type_t npy_descr_to_type(const std::string &descr) {
+    if (descr.size() != 3 || (descr[0] != '<' && descr[0] != '|' && descr[0] != '=')) {
+        fail() << "Unsupported .npy dtype (must be little-endian): " << descr;
+    }
+    const int bytes = descr[2] - '0';
+    halide_type_code_t code;
+    switch (descr[1]) {
+    case 'b':
+        return halide_type_t(halide_type_uint, 1);
+    case 'i':
+        code = halide_type_int;
+        break;
+    case 'u':
+        code = halide_type_uint;
+        break;
+    case 'f':
+        code = halide_type_float;
+        break;
+    default:
+        fail() << "Unsupported .npy dtype: " << descr;
+        code = halide_type_uint;  // unreachable
+        break;
+    }
+    if (bytes != 1 && bytes != 2 && bytes != 4 && bytes != 8) {
+        fail() << "Unsupported .npy dtype: " << descr;
+    }
+    if (code == halide_type_float && bytes < 4) {
+        fail() << "Unsupported .npy dtype (float16 not supported): " << descr;
+    }
+    return halide_type_t(code, (uint8_t)(bytes * 8));
+}
+
+std::string type_to_npy_descr(const halide_type_t &type) {
+    if (type.code == halide_type_uint && type.bits == 1) {
+        return "|b1";
+    }
+    char code;
+    switch (type.code) {
+    case halide_type_int:
+        code = 'i';
+        break;
+    case halide_type_uint:
+        code = 'u';
+        break;
+    case halide_type_float:
+        code = 'f';
+        break;
+    default:
+        fail() << "Unsupported type for .npy: " << type;
+        code = 'u';  // unreachable
+        break;
+    }
+    const int bytes = (type.bits + 7) / 8;
+    return std::string(bytes == 1 ? "|" : "<") + code + std::to_string(bytes);
+}
+
+// Extract the (unquoted) value for the given key from a .npy header dict,
+// e.g. given key "'descr'", return "'<f4'". This is nothing like a real
+// Python parser, but .npy headers are machine-generated and regular enough
+// that simple string matching suffices.
+std::string npy_dict_value(const std::string &dict, const std::string &key) {
+    size_t pos = dict.find(key);
+    if (pos == std::string::npos) {
+        fail() << "Malformed .npy header (missing " << key << "): " << dict;
+    }
+    pos = dict.find(':', pos + key.size());
+    if (pos == std::string::npos) {
+        fail() << "Malformed .npy header: " << dict;
+    }
+    pos++;
+    while (pos < dict.size() && std::isspace(dict[pos])) {
+        pos++;
+    }
+    size_t end;
+    if (dict[pos] == '(') {
+        end = dict.find(')', pos);
+        end = (end == std::string::npos) ? end : end + 1;
+    } else {
+        end = dict.find_first_of(",}", pos);
+    }
+    if (end == std::string::npos) {
+        fail() << "Malformed .npy header: " << dict;
+    }
+    return dict.substr(pos, end - pos);
+}
+
+// Load a .npy file as a Buffer<> whose host memory is a lazily-paged
+// mapping of the file itself; nothing is copied.
+Buffer<> load_npy(const std::string &pathname) {
+    size_t file_size;
+    char *base = (char *) map_file_for_input(pathname, &file_size);
+    constexpr size_t kMagicLen = 8;  // "\x93NUMPY" + major + minor
+    if (file_size < kMagicLen + 2 || memcmp(base, "\x93NUMPY", 6) != 0) {
+        fail() << "Not a .npy file: " << pathname;
+    }
+    const int version_major = base[6];
+    size_t header_len, data_start;
+    if (version_major == 1) {
+        header_len = (uint8_t) base[8] | ((uint8_t) base[9] << 8);
+        data_start = kMagicLen + 2 + header_len;
+    } else if (version_major == 2) {
+        header_len = (uint8_t) base[8] | ((uint8_t) base[9] << 8) |
+                     ((uint8_t) base[10] << 16) | ((uint32_t)(uint8_t) base[11] << 24);
+        data_start = kMagicLen + 4 + header_len;
+    } else {
+        fail() << "Unsupported .npy version: " << version_major;
+        return Buffer<>();
+    }
+    if (data_start > file_size) {
+        fail() << "Truncated .npy file: " << pathname;
+    }
+    const std::string dict(base + data_start - header_len, header_len);
+
+    const std::string descr = npy_dict_value(dict, "'descr'");
+    if (descr.size() < 2 || descr.front() != '\'' || descr.back() != '\'') {
+        fail() << "Malformed .npy header: " << dict;
+    }
+    const halide_type_t type = npy_descr_to_type(descr.substr(1, descr.size() - 2));
+
+    const bool fortran_order = (npy_dict_value(dict, "'fortran_order'") == "True");
+
+    std::string shape_str = npy_dict_value(dict, "'shape'");
+    if (shape_str.size() < 2 || shape_str.front() != '(' || shape_str.back() != ')') {
+        fail() << "Malformed .npy header: " << dict;
+    }
+    std::vector<int> extents;
+    for (const std::string &s : split_string(shape_str.substr(1, shape_str.size() - 2), ",")) {
+        std::string trimmed;
+        for (char c : s) {
+            if (!std::isspace(c)) trimmed += c;
+        }
+        if (trimmed.empty()) {
+            continue;  // trailing comma, e.g. "(3,)"
+        }
+        int e;
+        if (!parse_scalar(trimmed, &e)) {
+            fail() << "Malformed .npy shape: " << shape_str;
+        }
+        extents.push_back(e);
+    }
+    // numpy's C order stores the *last* dimension densely, while Halide's
+    // dimension 0 is the one with stride 1, so a C-order shape maps to
+    // Halide dimensions in reverse; Fortran order maps directly.
+    if (!fortran_order) {
+        std::reverse(extents.begin(), extents.end());
+    }
+    Shape shape;
+    size_t elem_count = 1;
+    for (size_t i = 0; i < extents.size(); ++i) {
+        const int stride = (i == 0) ? 1 : shape[i - 1].stride * shape[i - 1].extent;
+        shape.push_back(halide_dimension_t{0, extents[i], stride});
+        elem_count *= (size_t) extents[i];
+    }
+    const size_t bytes_needed = elem_count * ((type.bits + 7) / 8);
+    if (file_size - data_start < bytes_needed) {
+        fail() << "Truncated .npy file: " << pathname
+               << " (expected " << bytes_needed << " bytes of data, have "
+               << (file_size - data_start) << ")";
+    }
+    return Buffer<>(type, base + data_start, (int) shape.size(), shape.empty() ? nullptr : &shape[0]);
+}
+
+void save_npy(Buffer<> b, const std::string &pathname) {
+    // We always write C order, so the file's shape is the Halide shape
+    // reversed; data is then just our dense-planar memory image.
+    b = make_dense_planar(b);
+    b.copy_to_host();
+
+    std::ostringstream dict;
+    dict << "{'descr': '" << type_to_npy_descr(b.type())
+         << "', 'fortran_order': False, 'shape': (";
+    for (int i = b.dimensions() - 1; i >= 0; --i) {
+        dict << b.dim(i).extent();
+        if (i > 0 || b.dimensions() == 1) {
+            dict << ",";
+        }
+        if (i > 0) {
+            dict << " ";
+        }
+    }
+    dict << "), }";
+    std::string header = dict.str();
+    // Pad with spaces so that magic + length + header is a multiple of 64
+    // bytes (so the data is nicely aligned for readers that map the file),
+    // ending with a newline as the spec requires.
+    const size_t prefix_len = 8 + 2;
+    size_t padded = (prefix_len + header.size() + 1 + 63) & ~(size_t) 63;
+    header.resize(padded - prefix_len - 1, ' ');
+    header += '\n';
+    if (header.size() > 65535) {
+        fail() << "Header too large for .npy version 1.0: " << pathname;
+    }
+
+    std::ofstream f(pathname, std::ios::binary);
+    if (!f.good()) {
+        fail() << "Unable to open for write: " << pathname;
+    }
+    const uint8_t prefix[] = {
+        0x93, 'N', 'U', 'M', 'P', 'Y', 1, 0,
+        (uint8_t)(header.size() & 0xff), (uint8_t)(header.size() >> 8)
+    };
+    f.write((const char *) prefix, sizeof(prefix));
+    f.write(header.data(), header.size());
+    f.write((const char *) b.data(), b.size_in_bytes());
+    if (!f.good()) {
+        fail() << "Unable to write: " << pathname;
+    }
+}
+
+// ---------------------------------------------------------------
+// Raw binary data with a JSON sidecar describing its type and shape.
+// For a data file "foo.raw", the sidecar is "foo.json" and looks like:
+//
+//     {"type": "float32", "extent": [640, 480, 3], "min": [0, 0, 0], "stride": [1, 640, 307200]}
+//
+// "min" and "stride" are optional (defaulting to zeros and dense planar
+// strides respectively); "type" and "extent" are required.
+
+std::string sidecar_pathname(const std::string &pathname) {
+    size_t dot = pathname.rfind('.');
+    return pathname.substr(0, dot) + ".json";
+}
+
+// Minimal value extraction from a flat JSON object; like the .npy header
+// parser above, this is matching a format we also write, not arbitrary JSON.
+bool json_find_value(const std::string &json, const std::string &key,
+                     size_t *pos_out, size_t *end_out) {
+    size_t pos = json.find("\"" + key + "\"");
+    if (pos == std::string::npos) {
+        return false;
+    }
+    pos = json.find(':', pos);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    pos++;
+    while (pos < json.size() && std::isspace(json[pos])) {
+        pos++;
+    }
+    size_t end;
+    if (json[pos] == '[') {
+        end = json.find(']', pos);
+        end = (end == std::string::npos) ? end : end + 1;
+    } else if (json[pos] == '"') {
+        end = json.find('"', pos + 1);
+        end = (end == std::string::npos) ? end : end + 1;
+    } else {
+        end = json.find_first_of(",}", pos);
+    }
+    if (end == std::string::npos) {
+        return false;
+    }
+    *pos_out = pos;
+    *end_out = end;
+    return true;
+}
+
+bool json_get_string(const std::string &json, const std::string &key, std::string *value) {
+    size_t pos, end;
+    if (!json_find_value(json, key, &pos, &end) ||
+        json[pos] != '"' || end - pos < 2) {
+        return false;
+    }
+    *value = json.substr(pos + 1, end - pos - 2);
+    return true;
+}
+
+bool json_get_int_array(const std::string &json, const std::string &key, std::vector<int> *value) {
+    size_t pos, end;
+    if (!json_find_value(json, key, &pos, &end) ||
+        json[pos] != '[' || end - pos < 2) {
+        return false;
+    }
+    value->clear();
+    for (const std::string &s : split_string(json.substr(pos + 1, end - pos - 2), ",")) {
+        std::string trimmed;
+        for (char c : s) {
+            if (!std::isspace(c)) trimmed += c;
+        }
+        if (trimmed.empty()) {
+            continue;
+        }
+        int i;
+        if (!parse_scalar(trimmed, &i)) {
+            return false;
+        }
+        value->push_back(i);
+    }
+    return true;
+}
+
+// Load raw data described by its JSON sidecar; as with .npy, the host
+// memory is a lazily-paged mapping of the data file.
+Buffer<> load_raw_with_sidecar(const std::string &pathname) {
+    const std::string sidecar = sidecar_pathname(pathname);
+    std::ifstream f(sidecar);
+    if (!f.good()) {
+        fail() << "Unable to open sidecar for raw input: " << sidecar;
+    }
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    const std::string json = ss.str();
+
+    std::string type_str;
+    halide_type_t type;
+    if (!json_get_string(json, "type", &type_str) ||
+        !parse_type_string(type_str, &type)) {
+        fail() << "Missing or invalid \"type\" in: " << sidecar;
+    }
+    std::vector<int> extents, mins, strides;
+    if (!json_get_int_array(json, "extent", &extents)) {
+        fail() << "Missing or invalid \"extent\" in: " << sidecar;
+    }
+    if (json_get_int_array(json, "min", &mins) && mins.size() != extents.size()) {
+        fail() << "\"min\" and \"extent\" disagree on dimensionality in: " << sidecar;
+    }
+    if (json_get_int_array(json, "stride", &strides) && strides.size() != extents.size()) {
+        fail() << "\"stride\" and \"extent\" disagree on dimensionality in: " << sidecar;
+    }
+
+    Shape shape;
+    size_t elem_span = 1;
+    for (size_t i = 0; i < extents.size(); ++i) {
+        halide_dimension_t d;
+        d.min = i < mins.size() ? mins[i] : 0;
+        d.extent = extents[i];
+        d.stride = i < strides.size() ? strides[i]
+                   : (i == 0) ? 1 : shape[i - 1].stride * shape[i - 1].extent;
+        shape.push_back(d);
+        // The highest byte touched, for validating the file size below.
+        // (Only correct for nonnegative strides, which is all we write.)
+        elem_span += (size_t) d.stride * (d.extent - 1);
+    }
+
+    size_t file_size;
+    char *base = (char *) map_file_for_input(pathname, &file_size);
+    const size_t bytes_needed = elem_span * ((type.bits + 7) / 8);
+    if (file_size < bytes_needed) {
+        fail() << "Raw file too small: " << pathname
+               << " (sidecar implies " << bytes_needed << " bytes, have " << file_size << ")";
+    }
+    return Buffer<>(type, base, (int) shape.size(), shape.empty() ? nullptr : &shape[0]);
+}
+
+void save_raw_with_sidecar(Buffer<> b, const std::string &pathname) {
+    b = make_dense_planar(b);
+    b.copy_to_host();
+
+    const std::string sidecar = sidecar_pathname(pathname);
+    std::ofstream j(sidecar);
+    if (!j.good()) {
+        fail() << "Unable to open for write: " << sidecar;
+    }
+    j << "{\"type\": \"" << type_to_string(b.type()) << "\"";
+    const char *keys[] = {"extent", "min", "stride"};
+    for (int k = 0; k < 3; k++) {
+        j << ", \"" << keys[k] << "\": [";
+        for (int i = 0; i < b.dimensions(); ++i) {
+            const auto &d = b.raw_buffer()->dim[i];
+            j << (i ? ", " : "") << (k == 0 ? d.extent : k == 1 ? d.min : d.stride);
+        }
+        j << "]";
+    }
+    j << "}\n";
+    if (!j.good()) {
+        fail() << "Unable to write: " << sidecar;
+    }
+
+    std::ofstream f(pathname, std::ios::binary);
+    if (!f.good()) {
+        fail() << "Unable to open for write: " << pathname;
+    }
+    f.write((const char *) b.data(), b.size_in_bytes());
+    if (!f.good()) {
+        fail() << "Unable to write: " << pathname;
+    }
+}
+
 // Load a buffer from a pathname, adjusting the type and dimensions to
 // fit the metadata's requirements as needed.
 Buffer<> load_input_from_file(const std::string &pathname,
                               const halide_filter_argument_t &metadata) {
     Buffer<> b = Buffer<>(metadata.type, 0);
     info() << "Loading input " << metadata.name << " from " << pathname << " ...";
-    if (!Halide::Tools::load<Buffer<>, IOCheckFail>(pathname, &b)) {
+    const std::string ext = get_lowercase_extension(pathname);
+    if (ext == "npy") {
+        b = load_npy(pathname);
+    } else if (ext == "raw") {
+        b = load_raw_with_sidecar(pathname);
+    } else if (!Halide::Tools::load<Buffer<>, IOCheckFail>(pathname, &b)) {
         fail() << "Unable to load input: " << pathname;
     }
     if (b.dimensions() != metadata.dimensions) {
@@ -755,6 +1285,27 @@ Arguments:
     (We anticipate adding other image formats in the future, in particular,
     TIFF and TMP.)
 
+    For data that isn't image-shaped (e.g. float32 tensors of arbitrary
+    dimensionality), two lossless binary formats are also supported:
+
+        some_tensor=/path/to/tensor.npy
+
+        NumPy's .npy format: any scalar type and any number of dimensions,
+        directly loadable with numpy.load(). Inputs are memory-mapped, so
+        large tensors are paged in lazily rather than copied up front.
+
+        some_tensor=/path/to/tensor.raw
+
+        Raw binary data, with type and shape described by a JSON sidecar
+        alongside it (for foo.raw, foo.json), e.g.:
+
+            {"type": "float32", "extent": [640, 480, 3]}
+
+        Optional "min" and "stride" arrays default to zeros and dense planar
+        strides. Inputs are memory-mapped, as with .npy; both formats are
+        written with a sidecar/header describing exactly what the filter
+        produced.
+
     For inputs, there are also "pseudo-file" specifiers you can use; currently
     supported are
 
@@ -792,9 +1343,9 @@ Flags:
 
     --benchmarks=all:
         Run the filter with the given arguments many times to
-        produce an estimate of average execution time; this currently
-        runs "samples" sets of "iterations" each, and chooses the fastest
-        sample set.
+        produce an estimate of execution time; the number of samples
+        adapts until the result is stable (see --benchmark_min_time
+        et al below). Both the best and the median sample are reported.
 
     --benchmark_min_time=DURATION_SECONDS [default = 0.1]:
         Override the default minimum desired benchmarking time; ignored if
@@ -808,6 +1359,18 @@ Flags:
         Override the default maximum number of benchmarking iterations; ignored
         if --benchmarks is not also specified.
 
+    --benchmark_flush_caches:
+        Stomp over a large buffer between benchmark samples to flush the
+        processor caches, so each sample measures cold-cache performance;
+        ignored if --benchmarks is not also specified.
+
+    --benchmark_report=PATH:
+        Append the benchmark results to the given file, in addition to the
+        usual stdout report. If PATH ends in ".json", a one-line JSON object
+        is appended; otherwise a CSV row is appended (with a header row
+        first if the file is new or empty). Ignored if --benchmarks is not
+        also specified.
+
     --track_memory:
         Override Halide memory allocator to track high-water mark of memory
         allocation during run; note that this may slow down execution, so
@@ -905,6 +1468,8 @@ int main(int argc, char **argv) {
     double benchmark_min_time = BenchmarkConfig().min_time;
     uint64_t benchmark_min_iters = BenchmarkConfig().min_iters;
     uint64_t benchmark_max_iters = BenchmarkConfig().max_iters;
+    bool benchmark_flush_caches = false;
+    std::string benchmark_report;
     for (int i = 1; i < argc; ++i) {
         if (argv[i][0] == '-') {
             const char *p = argv[i] + 1; // skip -
@@ -962,6 +1527,18 @@ int main(int argc, char **argv) {
                 if (!parse_scalar(flag_value, &benchmark_max_iters)) {
                     fail() << "Invalid value for flag: " << flag_name;
                 }
+            } else if (flag_name == "benchmark_flush_caches") {
+                if (flag_value.empty()) {
+                    flag_value = "true";
+                }
+                if (!parse_scalar(flag_value, &benchmark_flush_caches)) {
+                    fail() << "Invalid value for flag: " << flag_name;
+                }
+            } else if (flag_name == "benchmark_report") {
+                if (flag_value.empty()) {
+                    fail() << "Missing value for flag: " << flag_name;
+                }
+                benchmark_report = flag_value;
             } else if (flag_name == "output_extents") {
                 default_output_shape = parse_extents(flag_value);
             } else {
@@ -1132,14 +1709,44 @@ int main(int argc, char **argv) {
             config.max_time = benchmark_min_time * 4;
             config.min_iters = benchmark_min_iters;
             config.max_iters = benchmark_max_iters;
+            if (benchmark_flush_caches) {
+                // A few multiples of a typical last-level cache.
+                config.flush_cache_bytes = 1 << 25;
+            }
             auto result = Halide::Tools::benchmark(benchmark_inner, config);
 
             std::cout << "Benchmark for " << md->name << " produces best case of " << result.wall_time << " sec/iter (over "
                 << result.samples << " samples, "
                 << result.iterations << " iterations, "
                 << "accuracy " << std::setprecision(2) << (result.accuracy * 100.0) << "%).\n";
+            std::cout << "Median is " << result.median_time << " sec/iter "
+                << "(median absolute deviation " << result.mad_time << " sec).\n";
             std::cout << "Best output throughput is " << (megapixels / result.wall_time) << " mpix/sec.\n";
 
+            if (!benchmark_report.empty()) {
+                bool json = benchmark_report.size() >= 5 &&
+                    benchmark_report.compare(benchmark_report.size() - 5, 5, ".json") == 0;
+                // Emit a CSV header if the file is new or empty.
+                bool need_header = false;
+                if (!json) {
+                    std::ifstream peek(benchmark_report);
+                    need_header = !peek.good() || peek.peek() == std::ifstream::traits_type::eof();
+                }
+                std::ofstream report(benchmark_report, std::ios::app);
+                if (!report.good()) {
+                    fail() << "Unable to write to: " << benchmark_report;
+                }
+                if (json) {
+                    report << result.to_json(md->name) << "\n";
+                } else {
+                    if (need_header) {
+                        report << Halide::Tools::BenchmarkResult::csv_header() << "\n";
+                    }
+                    report << result.to_csv(md->name) << "\n";
+                }
+                info() << "Benchmark results appended to " << benchmark_report;
+            }
+
         } else {
             info() << "Running filter...";
             // Ignore result since our halide_error() should catch everything.
@@ -1170,6 +1777,17 @@ int main(int argc, char **argv) {
                 info() << "Saving output " << arg_name << " to " << arg.raw_string << " ...";
                 Buffer<> &b = arg.buffer_value;
 
+                const std::string ext = get_lowercase_extension(arg.raw_string);
+                // These formats can represent any type and shape exactly, so
+                // they skip the approximate-format negotiation below.
+                if (ext == "npy") {
+                    save_npy(b, arg.raw_string);
+                    continue;
+                } else if (ext == "raw") {
+                    save_raw_with_sidecar(b, arg.raw_string);
+                    continue;
+                }
+
                 std::set<FormatInfo> savable_types;
                 if (!Halide::Tools::save_query<Buffer<>, IOCheckFail>(arg.raw_string, &savable_types)) {
                     fail() << "Unable to save output: " << arg.raw_string;
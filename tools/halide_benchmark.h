@@ -4,8 +4,12 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
 
 namespace Halide {
 namespace Tools {
@@ -94,8 +98,32 @@ struct BenchmarkConfig {
     // this. Controls accuracy. The closer to zero this gets the more
     // reliable the answer, but the longer it may take to run.
     double accuracy{0.03};
+
+    // If nonzero, stomp over this many bytes of memory between samples
+    // to flush the processor caches, so each sample measures cold-cache
+    // performance. The time spent flushing is not counted against the
+    // sample times (but does count against wall-clock budgets like
+    // min_time). A good value is a few multiples of the last-level
+    // cache size, e.g. 1 << 25.
+    uint64_t flush_cache_bytes{0};
 };
 
+// Write through a scratch buffer of the given size to displace the
+// contents of the processor caches. Returns a value dependent on the
+// buffer contents so the writes can't be optimized away.
+inline uint64_t benchmark_flush_cache(uint64_t bytes) {
+    static std::vector<uint8_t> stomp;
+    if (stomp.size() < bytes) {
+        stomp.resize(bytes);
+    }
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < bytes; i += 64) {
+        stomp[i]++;
+        sum += stomp[i];
+    }
+    return sum;
+}
+
 struct BenchmarkResult {
     // Best elapsed wall-clock time per iteration (seconds).
     double wall_time;
@@ -114,11 +142,70 @@ struct BenchmarkResult {
     // Will be <= config.accuracy unless max_iters is exceeded.
     double accuracy;
 
+    // Median elapsed wall-clock time per iteration (seconds), over the
+    // samples used for measurement. More robust than the min on
+    // machines with turbo or thermal throttling.
+    double median_time;
+
+    // Median absolute deviation of the per-iteration sample times
+    // (seconds). A robust measure of how noisy the samples were.
+    double mad_time;
+
     operator double() const { return wall_time; }
+
+    // Render the result as a single JSON object, suitable for
+    // appending to a log that is parsed by other tools.
+    std::string to_json(const std::string &name) const {
+        std::ostringstream o;
+        o.precision(9);
+        o << "{\"name\":\"" << name << "\""
+          << ",\"wall_time\":" << wall_time
+          << ",\"median_time\":" << median_time
+          << ",\"mad_time\":" << mad_time
+          << ",\"samples\":" << samples
+          << ",\"iterations\":" << iterations
+          << ",\"accuracy\":" << accuracy
+          << "}";
+        return o.str();
+    }
+
+    // Render the result as a CSV row matching csv_header().
+    static std::string csv_header() {
+        return "name,wall_time,median_time,mad_time,samples,iterations,accuracy";
+    }
+    std::string to_csv(const std::string &name) const {
+        std::ostringstream o;
+        o.precision(9);
+        o << name
+          << "," << wall_time
+          << "," << median_time
+          << "," << mad_time
+          << "," << samples
+          << "," << iterations
+          << "," << accuracy;
+        return o.str();
+    }
 };
 
+namespace Internal {
+
+// Median of a list of sample times. Modifies its argument.
+inline double benchmark_median(std::vector<double> &times) {
+    if (times.empty()) {
+        return 0;
+    }
+    std::sort(times.begin(), times.end());
+    size_t mid = times.size() / 2;
+    if (times.size() % 2 == 0) {
+        return (times[mid - 1] + times[mid]) / 2;
+    }
+    return times[mid];
+}
+
+}  // namespace Internal
+
 inline BenchmarkResult benchmark(std::function<void()> op, const BenchmarkConfig& config = {}) {
-    BenchmarkResult result{0, 0, 0};
+    BenchmarkResult result{0, 0, 0, 0, 0, 0};
 
     const double min_time = std::max(10 * 1e-6, config.min_time);
     const double max_time = std::max(config.min_time, config.max_time);
@@ -135,14 +222,27 @@ inline BenchmarkResult benchmark(std::function<void()> op, const BenchmarkConfig
     constexpr int kMinSamples = 3;
     double times[kMinSamples + 1] = {0};
 
+    // Keep every sample used for measurement so we can also report
+    // robust statistics (median and median absolute deviation).
+    std::vector<double> sample_times;
+    const auto one_sample = [&](uint64_t iters) -> double {
+        if (config.flush_cache_bytes) {
+            benchmark_flush_cache(config.flush_cache_bytes);
+        }
+        double t = benchmark(1, iters, op);
+        sample_times.push_back(t);
+        return t;
+    };
+
     double total_time = 0;
     uint64_t iters_per_sample = min_iters;
     while (result.iterations < max_iters) {
         result.samples = 0;
         result.iterations = 0;
         total_time = 0;
+        sample_times.clear();
         for (int i = 0; i < kMinSamples; i++) {
-            times[i] = benchmark(1, iters_per_sample, op);
+            times[i] = one_sample(iters_per_sample);
             result.samples++;
             result.iterations += iters_per_sample;
             total_time += times[i] * iters_per_sample;
@@ -165,7 +265,7 @@ inline BenchmarkResult benchmark(std::function<void()> op, const BenchmarkConfig
     while ((times[0] * accuracy < times[kMinSamples - 1] || total_time < min_time) &&
                  total_time < max_time &&
                  result.iterations < max_iters) {
-        times[kMinSamples] = benchmark(1, iters_per_sample, op);
+        times[kMinSamples] = one_sample(iters_per_sample);
         result.samples++;
         result.iterations += iters_per_sample;
         total_time += times[kMinSamples] * iters_per_sample;
@@ -174,6 +274,12 @@ inline BenchmarkResult benchmark(std::function<void()> op, const BenchmarkConfig
     result.wall_time = times[0];
     result.accuracy = (times[kMinSamples - 1] / times[0]) - 1.0;
 
+    result.median_time = Internal::benchmark_median(sample_times);
+    for (double &t : sample_times) {
+        t = t < result.median_time ? result.median_time - t : t - result.median_time;
+    }
+    result.mad_time = Internal::benchmark_median(sample_times);
+
     return result;
 }
 
@@ -12,9 +12,18 @@
 #include <map>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 #include <cctype>
 
+// For the memory-mapped loading fast path.
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #ifndef HALIDE_NO_PNG
 #include "png.h"
 #endif
@@ -324,6 +333,157 @@ struct FileOpener {
     FILE * const f;
 };
 
+// An RAII wrapper around a private (copy-on-write) memory mapping of
+// an entire file. On platforms without mmap, or if mapping fails,
+// data() returns nullptr and callers should fall back to stdio.
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string &filename) {
+#ifndef _WIN32
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd == -1) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            size_t len = (size_t)st.st_size;
+            // Map privately and writably so that callers can do
+            // in-place fixups (e.g. endian swaps); pages written to
+            // become copy-on-write, untouched pages stay shared.
+            void *p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                mapping = (uint8_t *)p;
+                mapping_size = len;
+            }
+        }
+        close(fd);
+#else
+        (void)filename;
+#endif
+    }
+
+    ~MappedFile() {
+        reset();
+    }
+
+    MappedFile(MappedFile &&other) : mapping(other.mapping), mapping_size(other.mapping_size) {
+        other.mapping = nullptr;
+        other.mapping_size = 0;
+    }
+
+    MappedFile &operator=(MappedFile &&other) {
+        reset();
+        std::swap(mapping, other.mapping);
+        std::swap(mapping_size, other.mapping_size);
+        return *this;
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    uint8_t *data() const { return mapping; }
+    size_t size() const { return mapping_size; }
+
+private:
+    void reset() {
+#ifndef _WIN32
+        if (mapping) {
+            munmap(mapping, mapping_size);
+        }
+#endif
+        mapping = nullptr;
+        mapping_size = 0;
+    }
+
+    uint8_t *mapping = nullptr;
+    size_t mapping_size = 0;
+};
+
+// Run fn(y) for each row in [ymin, ymax], spreading the rows across
+// worker threads when there are enough of them to be worth it.
+template<typename Fn>
+void parallel_for_rows(int ymin, int ymax, Fn &&fn) {
+    const int rows = ymax - ymin + 1;
+    int workers = (int)std::thread::hardware_concurrency();
+    // Below a few hundred rows the thread launch overhead dominates.
+    workers = std::min(workers, rows / 128);
+    if (workers <= 1) {
+        for (int y = ymin; y <= ymax; y++) {
+            fn(y);
+        }
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < workers; t++) {
+        threads.emplace_back([=]() {
+            for (int y = ymin + t; y <= ymax; y += workers) {
+                fn(y);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+// Parse a binary PNM header (magic, optional comments, width, height,
+// maxval, one terminating whitespace byte) from the start of a mapped
+// file. Returns the offset of the first byte of pixel data in
+// *data_offset, and the second character of the magic ('5' for PGM,
+// '6' for PPM) in *magic.
+inline bool parse_pnm_header(const uint8_t *data, size_t size, char *magic,
+                             int *width, int *height, int *bit_depth,
+                             size_t *data_offset) {
+    size_t pos = 0;
+    auto parse_int = [&](int *out) -> bool {
+        while (pos < size) {
+            if (isspace(data[pos])) {
+                pos++;
+            } else if (data[pos] == '#') {
+                while (pos < size && data[pos] != '\n') {
+                    pos++;
+                }
+            } else {
+                break;
+            }
+        }
+        int v = 0;
+        bool any = false;
+        while (pos < size && isdigit(data[pos])) {
+            v = v * 10 + (data[pos] - '0');
+            pos++;
+            any = true;
+        }
+        *out = v;
+        return any;
+    };
+    if (size < 2 || data[0] != 'P') {
+        return false;
+    }
+    *magic = (char)data[1];
+    pos = 2;
+    int maxval = 0;
+    if (!parse_int(width) || !parse_int(height) || !parse_int(&maxval)) {
+        return false;
+    }
+    // A single whitespace byte separates the header from the pixel data.
+    if (pos >= size || !isspace(data[pos])) {
+        return false;
+    }
+    pos++;
+    if (maxval == 255) {
+        *bit_depth = 8;
+    } else if (maxval == 65535) {
+        *bit_depth = 16;
+    } else {
+        return false;
+    }
+    *data_offset = pos;
+    return true;
+}
+
 // Read a row of ElemTypes from a byte buffer and copy them into a specific image row.
 // Multibyte elements are assumed to be big-endian.
 template<typename ElemType, typename ImageType>
@@ -430,13 +590,19 @@ bool load_png(const std::string &filename, ImageType *im) {
         Internal::read_big_endian_row<uint8_t, ImageType> :
         Internal::read_big_endian_row<uint16_t, ImageType>;
 
-    std::vector<uint8_t> row(png_get_rowbytes(png_ptr, info_ptr));
+    // libpng must decode rows in order (each row's filter depends on
+    // the previous row), but the big-endian deinterleave into the
+    // planar image can be spread across threads afterwards.
+    const size_t row_bytes = png_get_rowbytes(png_ptr, info_ptr);
+    std::vector<uint8_t> data(row_bytes * height);
     const int ymin = im->dim(1).min();
     const int ymax = im->dim(1).max();
     for (int y = ymin; y <= ymax; ++y) {
-        png_read_row(png_ptr, row.data(), nullptr);
-        copy_to_image(row.data(), y, im);
+        png_read_row(png_ptr, data.data() + (size_t)(y - ymin) * row_bytes, nullptr);
     }
+    Internal::parallel_for_rows(ymin, ymax, [&](int y) {
+        copy_to_image(data.data() + (size_t)(y - ymin) * row_bytes, y, im);
+    });
 
     png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
 
@@ -569,6 +735,46 @@ bool load_pnm(const std::string &filename, int channels, ImageType *im) {
 
     const char *hdr_fmt = channels == 3 ? "P6" : "P5";
 
+    // Fast path: map the file and read rows straight out of the
+    // mapping in parallel, instead of staging each row through stdio.
+    {
+        Internal::MappedFile file(filename);
+        if (file.data() != nullptr) {
+            char magic;
+            int width, height, bit_depth;
+            size_t data_offset;
+            if (!check(Internal::parse_pnm_header(file.data(), file.size(), &magic,
+                                                  &width, &height, &bit_depth, &data_offset) &&
+                       magic == hdr_fmt[1],
+                       "Unexpected file header")) {
+                return false;
+            }
+            const size_t row_bytes = (size_t)width * channels * (bit_depth / 8);
+            if (!check(data_offset + row_bytes * height <= file.size(),
+                       "File ended before end of pixel data")) {
+                return false;
+            }
+
+            const halide_type_t im_type(halide_type_uint, bit_depth);
+            std::vector<int> im_dimensions = { width, height };
+            if (channels > 1) {
+                im_dimensions.push_back(channels);
+            }
+            *im = ImageType(im_type, im_dimensions);
+
+            auto copy_to_image = bit_depth == 8 ?
+                Internal::read_big_endian_row<uint8_t, ImageType> :
+                Internal::read_big_endian_row<uint16_t, ImageType>;
+
+            const uint8_t *pixels = file.data() + data_offset;
+            const int ymin = im->dim(1).min();
+            Internal::parallel_for_rows(ymin, im->dim(1).max(), [&](int y) {
+                copy_to_image(pixels + (size_t)(y - ymin) * row_bytes, y, im);
+            });
+            return true;
+        }
+    }
+
     Internal::FileOpener f(filename, "rb");
     int width, height, bit_depth;
     if (!Internal::read_pnm_header<check>(f, hdr_fmt, &width, &height, &bit_depth)) {
@@ -1671,6 +1877,93 @@ private:
   const std::string filename;
 };
 
+// The result of load_mapped_image: an image that directly references
+// the memory-mapped pages of a file, plus the mapping that keeps
+// those pages alive. The image must not outlive the mapping, so keep
+// the two together (or keep this struct whole) for as long as the
+// pixels are in use.
+template<typename ImageType>
+struct MappedImage {
+    ImageType image;
+    Internal::MappedFile mapping;
+};
+
+// Load a binary PGM or PPM by wrapping the file's pixel data in a
+// Buffer with zero copies. PPM pixel data is left interleaved, so the
+// resulting buffer has stride 1 in the channel dimension; pipelines
+// consuming it must expect that layout. 16-bit files are stored
+// big-endian and get an in-place, multi-threaded endian (and, if the
+// header length is odd, alignment) fixup, which only dirties
+// copy-on-write pages of the private mapping; 8-bit files are wrapped
+// untouched. Returns false if the file can't be mapped (e.g. on
+// Windows) or isn't a binary PGM/PPM; callers can then fall back to
+// load().
+template<typename ImageType, Internal::CheckFunc check = Internal::CheckReturn>
+bool load_mapped_image(const std::string &filename, MappedImage<ImageType> *result) {
+    static_assert(!ImageType::has_static_halide_type, "");
+
+    Internal::MappedFile file(filename);
+    if (!check(file.data() != nullptr, "File could not be memory-mapped")) {
+        return false;
+    }
+
+    char magic;
+    int width, height, bit_depth;
+    size_t data_offset;
+    if (!check(Internal::parse_pnm_header(file.data(), file.size(), &magic,
+                                          &width, &height, &bit_depth, &data_offset) &&
+               (magic == '5' || magic == '6'),
+               "File is not a binary PGM or PPM")) {
+        return false;
+    }
+    const int channels = (magic == '6') ? 3 : 1;
+    const size_t row_bytes = (size_t)width * channels * (bit_depth / 8);
+    if (!check(data_offset + row_bytes * height <= file.size(),
+               "File ended before end of pixel data")) {
+        return false;
+    }
+
+    uint8_t *pixels = file.data() + data_offset;
+    if (bit_depth == 16) {
+        // 16-bit PNM data is big-endian, and the header is arbitrary
+        // length, so the data may also be misaligned. Fix both up in
+        // place; writes only dirty copy-on-write pages of the private
+        // mapping. A misaligned payload is shifted down one byte,
+        // over the header's terminating whitespace, to align it.
+        uint8_t *dst = pixels;
+        if ((uintptr_t)pixels % 2 != 0) {
+            dst = pixels - 1;
+        }
+        const uint16_t probe = 1;
+        const bool host_little_endian = (*(const uint8_t *)&probe == 1);
+        if (dst != pixels || host_little_endian) {
+            // Each destination row only overlaps its own source row,
+            // so rows can be rewritten in parallel; within a row the
+            // shift is downwards, so walk forwards.
+            Internal::parallel_for_rows(0, height - 1, [&](int y) {
+                const uint8_t *src_row = pixels + (size_t)y * row_bytes;
+                uint16_t *dst_row = (uint16_t *)(dst + (size_t)y * row_bytes);
+                for (int i = 0; i < width * channels; i++) {
+                    dst_row[i] = (uint16_t)((src_row[2 * i] << 8) | src_row[2 * i + 1]);
+                }
+            });
+        }
+        pixels = dst;
+    }
+
+    halide_dimension_t shape[3];
+    shape[0] = halide_dimension_t(0, width, channels);
+    shape[1] = halide_dimension_t(0, height, width * channels);
+    shape[2] = halide_dimension_t(0, channels, 1);
+    const int dims = (channels > 1) ? 3 : 2;
+
+    result->image = ImageType(halide_type_t(halide_type_uint, bit_depth),
+                              pixels, dims, shape);
+    result->image.set_host_dirty();
+    result->mapping = std::move(file);
+    return true;
+}
+
 // Fancy wrapper to call save() with CheckFail; this allows you to simply use
 //
 //    save_image(im, "filename");
@@ -270,10 +270,14 @@ void finish_dump(map<string, FuncInfo> &func_info, BufferOutputOpts output_opts)
 
 void usage(char * const *argv) {
     const string usage =
-        "Usage: " + string(argv[0]) + " -i trace_file -t {png,jpg,pgm,tmp,mat}\n"
+        "Usage: " + string(argv[0]) + " -i trace_file -t {png,jpg,pgm,tmp,mat} [-w first_id:last_id]\n"
         "\n"
         "This tool reads a binary trace produced by Halide, and dumps all\n"
         "Funcs into individual image files in the current directory.\n"
+        "With -w, only packets with ids in the given inclusive range are\n"
+        "dumped. If the trace file contains an index (traces written via\n"
+        "HL_TRACE_FILE do), the prefix of the file before the window is\n"
+        "skipped using it rather than read.\n"
         "To generate a suitable binary trace, use Func::trace_stores(), or the\n"
         "target features trace_stores and trace_realizations, and run with\n"
         "HL_TRACE_FILE=<filename>.\n";
@@ -284,6 +288,9 @@ void usage(char * const *argv) {
 int main(int argc, char * const *argv) {
     char *buf_filename = nullptr;
     char *buf_imagetype = nullptr;
+    uint64_t window_first = 0;
+    uint64_t window_last = UINT64_MAX;
+    bool have_window = false;
     BufferOutputOpts outputopts;
     for (int i = 1; i < argc - 1; i++) {
         string arg = argv[i];
@@ -293,6 +300,15 @@ int main(int argc, char * const *argv) {
         } else if (arg == "-i") {
             i++;
             buf_filename = argv[i];
+        } else if (arg == "-w") {
+            i++;
+            if (sscanf(argv[i], "%llu:%llu",
+                       (unsigned long long *)&window_first,
+                       (unsigned long long *)&window_last) != 2 ||
+                window_last < window_first) {
+                usage(argv);
+            }
+            have_window = true;
         }
     }
 
@@ -330,6 +346,23 @@ int main(int argc, char * const *argv) {
 
     map<string, FuncInfo> func_info;
 
+    TraceIndex index;
+    bool have_index = TraceIndex::load(file_desc, &index);
+    long window_start_offset = 0;
+    if (have_index) {
+        printf("[INFO] Found trace index: %d sync points, %d Funcs.\n",
+               (int)index.sync_offsets.size(), (int)index.funcs.size());
+        if (have_window) {
+            window_start_offset = (long)index.seek_offset_for_id(window_first);
+            printf("[INFO] Seeking to offset %ld for packet id %llu.\n",
+                   window_start_offset, (unsigned long long)window_first);
+        }
+    }
+    if (fseek(file_desc, window_start_offset, SEEK_SET) != 0) {
+        fprintf(stderr, "Error: couldn't seek in trace file. Aborting.\n");
+        exit(-1);
+    }
+
     printf("[INFO] First pass...\n");
 
     for (;;) {
@@ -345,6 +378,14 @@ int main(int argc, char * const *argv) {
             printf("[INFO] Pass 1: Read %d packets so far.\n", packet_count);
         }
 
+        if (p.event == halide_trace_sync) {
+            continue;
+        }
+        if (have_window &&
+            ((uint64_t)p.id < window_first || (uint64_t)p.id > window_last)) {
+            continue;
+        }
+
         // Check if this was a store packet.
         if ( (p.event == halide_trace_store) || (p.event == halide_trace_load) ) {
             if (func_info.find(string(p.func())) == func_info.end()) {
@@ -356,7 +397,7 @@ int main(int argc, char * const *argv) {
     }
 
     packet_count = 0;
-    fseek(file_desc, 0, SEEK_SET);
+    fseek(file_desc, window_start_offset, SEEK_SET);
     if (ferror(file_desc)){
         fprintf(stderr, "Error: couldn't seek back to beginning of trace file. Aborting.\n");
         exit(-1);
@@ -383,6 +424,14 @@ int main(int argc, char * const *argv) {
             printf("[INFO] Pass 2: Read %d packets so far.\n", packet_count);
         }
 
+        if (p.event == halide_trace_sync) {
+            continue;
+        }
+        if (have_window &&
+            ((uint64_t)p.id < window_first || (uint64_t)p.id > window_last)) {
+            continue;
+        }
+
         // Check if this was a store packet.
         if ( (p.event == halide_trace_store) || (p.event == halide_trace_load) ) {
             if (func_info.find(string(p.func())) == func_info.end()) {
@@ -1,4 +1,5 @@
 #include "HalideTraceUtils.h"
+#include <algorithm>
 #include <stdint.h>
 #include <assert.h>
 #include <stdlib.h>
@@ -44,6 +45,118 @@ bool Packet::read(void *d, size_t size, FILE *fdesc) {
     return true;
 }
 
+namespace {
+
+uint64_t peek_u64(const uint8_t *src) {
+    uint64_t val;
+    memcpy(&val, src, sizeof(val));
+    return val;
+}
+
+uint32_t peek_u32(const uint8_t *src) {
+    uint32_t val;
+    memcpy(&val, src, sizeof(val));
+    return val;
+}
+
+}  // namespace
+
+bool TraceIndex::load(FILE *fdesc, TraceIndex *index) {
+    long saved_pos = ftell(fdesc);
+    if (saved_pos < 0 ||
+        fseek(fdesc, 0, SEEK_END) != 0) {
+        return false;
+    }
+    long file_size = ftell(fdesc);
+
+    // The footer is the offset of the last sync packet followed by a
+    // magic number.
+    uint8_t footer[16];
+    bool found = false;
+    uint64_t sync_offset = 0;
+    if (file_size >= (long)sizeof(footer) &&
+        fseek(fdesc, file_size - sizeof(footer), SEEK_SET) == 0 &&
+        fread(footer, 1, sizeof(footer), fdesc) == sizeof(footer) &&
+        memcmp(footer + 8, "HLTRIDX1", 8) == 0) {
+        sync_offset = peek_u64(footer);
+        found = sync_offset < (uint64_t)file_size;
+    }
+
+    // Walk the chain of sync packets backwards from the last one.
+    bool last = true;
+    while (found) {
+        Packet p;
+        if (fseek(fdesc, (long)sync_offset, SEEK_SET) != 0 ||
+            !p.read_from_filedesc(fdesc) ||
+            p.event != halide_trace_sync ||
+            p.type.lanes < 28) {
+            found = false;
+            break;
+        }
+        const uint8_t *payload = (const uint8_t *)p.value();
+        uint64_t prev_offset = peek_u64(payload);
+        uint64_t self_offset = peek_u64(payload + 8);
+        uint64_t last_id = peek_u64(payload + 16);
+        if (self_offset != sync_offset) {
+            found = false;
+            break;
+        }
+        index->sync_offsets.push_back(sync_offset);
+        index->sync_last_ids.push_back(last_id);
+        if (last) {
+            // The func table is cumulative; only the last one matters.
+            uint32_t num_funcs = peek_u32(payload + 24);
+            const uint8_t *entry = payload + 28;
+            const uint8_t *end = payload + p.type.lanes;
+            for (uint32_t i = 0; i < num_funcs && entry + 9 <= end; i++) {
+                FuncEntry f;
+                f.first_offset = peek_u64(entry);
+                entry += 8;
+                while (entry < end && *entry) {
+                    f.name.push_back((char)*entry++);
+                }
+                entry++; // skip the null
+                index->funcs.push_back(f);
+            }
+            last = false;
+        }
+        if (prev_offset == (uint64_t)(-1)) {
+            break;
+        }
+        if (prev_offset >= sync_offset) {
+            // A corrupt chain; don't loop forever.
+            found = false;
+            break;
+        }
+        sync_offset = prev_offset;
+    }
+
+    if (!found) {
+        index->sync_offsets.clear();
+        index->sync_last_ids.clear();
+        index->funcs.clear();
+    } else {
+        // We walked the chain newest-first.
+        std::reverse(index->sync_offsets.begin(), index->sync_offsets.end());
+        std::reverse(index->sync_last_ids.begin(), index->sync_last_ids.end());
+    }
+
+    fseek(fdesc, saved_pos, SEEK_SET);
+    return found;
+}
+
+uint64_t TraceIndex::seek_offset_for_id(uint64_t id) const {
+    uint64_t offset = 0;
+    for (size_t i = 0; i < sync_offsets.size(); i++) {
+        if (sync_last_ids[i] < id) {
+            offset = sync_offsets[i];
+        } else {
+            break;
+        }
+    }
+    return offset;
+}
+
 void bad_type_error(halide_type_t type) {
     fprintf(stderr, "Can't convert packet with type: %d bits: %d\n", type.code, type.bits);
     exit(-1);
@@ -3,7 +3,10 @@
 
 #include "HalideRuntime.h"
 #include <stdio.h>
+#include <stdint.h>
 #include <cstring>
+#include <string>
+#include <vector>
 
 namespace Halide {
 namespace Internal {
@@ -94,6 +97,34 @@ private:
     bool read(void *d, size_t size, FILE *fdesc);
 };
 
+// The index the tracing runtime writes into trace files: a chain of
+// sync packets, located via a footer at the end of the file. See the
+// format description next to halide_trace_packet_t in HalideRuntime.h.
+struct TraceIndex {
+    struct FuncEntry {
+        std::string name;
+        // Offset of the first packet mentioning the func.
+        uint64_t first_offset;
+    };
+
+    // Offsets of the sync packets, in file order, and the highest
+    // packet id written before each one.
+    std::vector<uint64_t> sync_offsets;
+    std::vector<uint64_t> sync_last_ids;
+
+    // Every func in the trace, from the last sync packet's table.
+    std::vector<FuncEntry> funcs;
+
+    // Load the index from a seekable trace file, leaving the file
+    // position where it was. Returns false if the file has no index.
+    static bool load(FILE *fdesc, TraceIndex *index);
+
+    // The offset of the latest sync packet entirely before the given
+    // packet id, or zero if there is none. Reading from the returned
+    // offset visits every packet with an id >= the given one.
+    uint64_t seek_offset_for_id(uint64_t id) const;
+};
+
 }
 }
 
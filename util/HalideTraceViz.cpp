@@ -1110,6 +1110,12 @@ int run(bool ignore_trace_tags, FlagProcessor flag_processor) {
         }
         packet_clock++;
 
+        if (p.event == halide_trace_sync) {
+            // Sync packets only carry the seek index for tools
+            // reading from a file; there's nothing to draw.
+            continue;
+        }
+
         // It's a pipeline begin/end event
         if (p.event == halide_trace_begin_pipeline) {
             pipeline_info[p.id] = {p.func(), p.id};
@@ -0,0 +1,569 @@
+// HalideTuner: random schedule search driver for AOT generators.
+//
+// The tool drives the schedule serialization support in libHalide
+// (Pipeline::save_schedule / apply_schedule, exposed to generator
+// binaries via the HL_SAVE_SCHEDULE and HL_APPLY_SCHEDULE environment
+// variables). Starting from the schedule the generator ships with, it
+// repeatedly mutates split factors, loop types, loop orders, and
+// compute levels, compiles each candidate through the generator (in
+// parallel), benchmarks the survivors one at a time through a
+// RunGen-style runner, and appends every result to a persistent
+// database so a search can be resumed and refined across runs.
+//
+// The tool doesn't know how to link your filter against RunGen itself;
+// you supply a compile command template (typically a one-line link of
+// tools/RunGen.cpp against the emitted static library), e.g.:
+//
+//   HalideTuner
+//       --generator=bin/my.generator --name=my_filter --target=host
+//       --output=tune
+//       --compile='c++ -std=c++11 -I include -I tools tools/RunGen.cpp
+//                  tools/RunGenStubs.cpp -DHL_RUNGEN_FILTER_HEADER="\"{DIR}/my_filter.h\""
+//                  {DIR}/my_filter.a -ldl -lpthread -o {DIR}/bench'
+//   (as a single command line)
+//
+// Even a weekend of purely random search over this space tends to beat
+// a hand-written schedule; smarter search strategies can be layered on
+// top of the results database.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using std::map;
+using std::string;
+using std::vector;
+
+void usage(const char *argv0) {
+    std::cerr
+        << "Usage: " << argv0 << " [options]\n"
+        << "Options:\n"
+        << "  --generator=PATH    Generator binary to drive (required).\n"
+        << "  --name=NAME         Generator name to pass as -g (required).\n"
+        << "  --target=TARGET     Halide target string [default: host].\n"
+        << "  --output=DIR        Work directory and results database [default: tune].\n"
+        << "  --compile=CMD       Command that builds {DIR}/bench from the generator\n"
+        << "                      output in {DIR} (required). {DIR} is substituted.\n"
+        << "  --benchmark=CMD     Command that benchmarks a candidate; must print\n"
+        << "                      RunGen's \"best case of T sec\" line\n"
+        << "                      [default: {DIR}/bench --benchmarks=all --default_input_buffers=random:0:estimate_then_auto --default_input_scalars=estimate --output_extents=estimate].\n"
+        << "  --generator-arg=A   Extra argument passed to every generator\n"
+        << "                      invocation (e.g. a GeneratorParam); repeatable.\n"
+        << "  --samples=N         Number of candidates to try [default: 100].\n"
+        << "  --jobs=N            Candidate compiles to run in parallel [default: 4].\n"
+        << "  --seed=N            Random seed [default: time-based].\n";
+    exit(1);
+}
+
+// ---------------------------------------------------------------------------
+// A structured (but format-preserving) model of a serialized schedule.
+// The grammar is defined by src/ScheduleSerialization.cpp; anything this
+// tool doesn't mutate is carried through verbatim.
+
+// ForType values from src/Expr.h.
+enum { kSerial = 0, kParallel = 1, kVectorized = 2, kUnrolled = 3 };
+
+struct SplitLine {
+    string old_var, outer, inner;
+    string factor;  // "-" if undefined
+    int exact, tail, split_type;
+};
+
+struct DimLine {
+    string var;
+    int for_type, device_api, dim_type;  // dim_type 0 == pure Var
+};
+
+struct StageBlock {
+    int index;
+    vector<SplitLine> splits;
+    vector<DimLine> dims;
+};
+
+struct FuncBlock {
+    string name;
+    string flags_line;
+    string store_level;    // everything after the "store_level" token
+    string compute_level;  // likewise
+    vector<string> storage;
+    vector<StageBlock> stages;
+};
+
+struct Schedule {
+    string header;
+    vector<FuncBlock> funcs;
+};
+
+bool parse_schedule(const string &filename, Schedule *s) {
+    std::ifstream in(filename);
+    if (!in.good() || !std::getline(in, s->header)) {
+        return false;
+    }
+    s->funcs.clear();
+    FuncBlock func;
+    StageBlock *stage = nullptr;
+    string raw;
+    while (std::getline(in, raw)) {
+        std::istringstream line(raw);
+        string directive;
+        if (!(line >> directive) || directive[0] == '#') {
+            continue;
+        }
+        if (directive == "func") {
+            func = FuncBlock();
+            stage = nullptr;
+            line >> func.name;
+        } else if (directive == "flags") {
+            std::getline(line, func.flags_line);
+        } else if (directive == "store_level") {
+            std::getline(line, func.store_level);
+        } else if (directive == "compute_level") {
+            std::getline(line, func.compute_level);
+        } else if (directive == "storage") {
+            string var;
+            while (line >> var) {
+                func.storage.push_back(var);
+            }
+        } else if (directive == "stage") {
+            func.stages.push_back(StageBlock());
+            stage = &func.stages.back();
+            line >> stage->index;
+        } else if (directive == "split" && stage) {
+            SplitLine sp;
+            if (line >> sp.old_var >> sp.outer >> sp.inner >> sp.factor
+                     >> sp.exact >> sp.tail >> sp.split_type) {
+                stage->splits.push_back(sp);
+            }
+        } else if (directive == "dim" && stage) {
+            DimLine d;
+            if (line >> d.var >> d.for_type >> d.device_api >> d.dim_type) {
+                stage->dims.push_back(d);
+            }
+        } else if (directive == "end") {
+            s->funcs.push_back(func);
+            stage = nullptr;
+        }
+    }
+    return !s->funcs.empty();
+}
+
+void write_schedule(const Schedule &s, const string &filename) {
+    std::ofstream out(filename);
+    out << s.header << "\n";
+    for (const FuncBlock &f : s.funcs) {
+        out << "func " << f.name << "\n";
+        out << "flags" << f.flags_line << "\n";
+        out << "store_level" << f.store_level << "\n";
+        out << "compute_level" << f.compute_level << "\n";
+        out << "storage";
+        for (const string &v : f.storage) {
+            out << " " << v;
+        }
+        out << "\n";
+        for (const StageBlock &st : f.stages) {
+            out << "stage " << st.index << "\n";
+            for (const SplitLine &sp : st.splits) {
+                out << "split " << sp.old_var << " " << sp.outer << " "
+                    << sp.inner << " " << sp.factor << " " << sp.exact << " "
+                    << sp.tail << " " << sp.split_type << "\n";
+            }
+            for (const DimLine &d : st.dims) {
+                out << "dim " << d.var << " " << d.for_type << " "
+                    << d.device_api << " " << d.dim_type << "\n";
+            }
+        }
+        out << "end\n";
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Mutations. Each returns false if it couldn't find a legal site to act
+// on. Anything these accept can still be rejected when the generator
+// recompiles (e.g. vectorizing a dimension with non-constant extent);
+// such candidates are simply recorded as failures in the database.
+
+// A dim is fair game for reordering/loop-type changes if it is a pure
+// Var and not the synthetic __outermost loop.
+bool mutable_dim(const StageBlock &st, size_t i) {
+    return i + 1 < st.dims.size() && st.dims[i].dim_type == 0 &&
+           st.dims[i].var.find("__outermost") == string::npos;
+}
+
+StageBlock *random_stage(Schedule *s, std::mt19937 &rng) {
+    vector<StageBlock *> stages;
+    for (FuncBlock &f : s->funcs) {
+        for (StageBlock &st : f.stages) {
+            stages.push_back(&st);
+        }
+    }
+    if (stages.empty()) return nullptr;
+    return stages[rng() % stages.size()];
+}
+
+bool mutate_split_factor(Schedule *s, std::mt19937 &rng, string *desc) {
+    StageBlock *st = random_stage(s, rng);
+    if (!st) return false;
+    vector<SplitLine *> numeric;
+    for (SplitLine &sp : st->splits) {
+        // split_type 0 == SplitVar; renames/fuses have no useful factor.
+        if (sp.split_type == 0 && sp.factor != "-") {
+            numeric.push_back(&sp);
+        }
+    }
+    if (numeric.empty()) return false;
+    SplitLine *sp = numeric[rng() % numeric.size()];
+    long f = strtol(sp->factor.c_str(), nullptr, 10);
+    f = (rng() & 1) ? f * 2 : f / 2;
+    f = std::max(2L, std::min(1024L, f));
+    *desc = "split " + sp->old_var + " " + sp->factor + "->" + std::to_string(f);
+    sp->factor = std::to_string(f);
+    return true;
+}
+
+bool mutate_reorder(Schedule *s, std::mt19937 &rng, string *desc) {
+    StageBlock *st = random_stage(s, rng);
+    if (!st || st->dims.size() < 3) return false;
+    // Swap a random pair of adjacent pure dims (never the trailing
+    // __outermost marker; never move an RVar, whose order can matter).
+    size_t i = rng() % (st->dims.size() - 2);
+    if (!mutable_dim(*st, i) || !mutable_dim(*st, i + 1)) return false;
+    *desc = "reorder " + st->dims[i].var + "<->" + st->dims[i + 1].var;
+    std::swap(st->dims[i], st->dims[i + 1]);
+    return true;
+}
+
+bool mutate_loop_type(Schedule *s, std::mt19937 &rng, string *desc) {
+    StageBlock *st = random_stage(s, rng);
+    if (!st) return false;
+    size_t i = rng() % st->dims.size();
+    if (!mutable_dim(*st, i)) return false;
+    DimLine &d = st->dims[i];
+    int choices[] = {kSerial, kParallel, kUnrolled, kVectorized};
+    int t = choices[rng() % 4];
+    if (t == d.for_type) return false;
+    // Only vectorize the innermost loop, and only when it is the inner
+    // half of a constant-factor split (otherwise lowering will reject it).
+    if (t == kVectorized) {
+        if (i != 0) return false;
+        bool constant_extent = false;
+        for (const SplitLine &sp : st->splits) {
+            if (sp.inner == d.var && sp.factor != "-") {
+                constant_extent = true;
+            }
+        }
+        if (!constant_extent) return false;
+    }
+    // Unrolling wants a small constant extent too; same test.
+    if (t == kUnrolled) {
+        bool small_extent = false;
+        for (const SplitLine &sp : st->splits) {
+            if (sp.inner == d.var && sp.factor != "-" &&
+                strtol(sp.factor.c_str(), nullptr, 10) <= 16) {
+                small_extent = true;
+            }
+        }
+        if (!small_extent) return false;
+    }
+    *desc = "loop_type " + d.var + " " + std::to_string(d.for_type) +
+            "->" + std::to_string(t);
+    d.for_type = t;
+    return true;
+}
+
+bool mutate_compute_level(Schedule *s, std::mt19937 &rng, string *desc) {
+    if (s->funcs.size() < 2) return false;
+    FuncBlock &f = s->funcs[rng() % s->funcs.size()];
+    // The output's compute level is fixed at root; leave it alone.
+    if (&f == &s->funcs.back() && f.compute_level == " root") {
+        return false;
+    }
+    // Candidate levels: inlined, root, or inside a pure loop of some
+    // other func. Illegal choices (e.g. inlining an update stage, or
+    // computing at a non-consumer) fail when the generator reruns.
+    std::ostringstream level;
+    int choice = rng() % 3;
+    if (choice == 0) {
+        level << " inlined";
+        if (f.stages.size() > 1) return false;  // updates can't be inlined
+    } else if (choice == 1) {
+        level << " root";
+    } else {
+        const FuncBlock &host = s->funcs[rng() % s->funcs.size()];
+        if (host.name == f.name || host.stages.empty()) return false;
+        const StageBlock &st = host.stages[0];
+        vector<const DimLine *> pure;
+        for (size_t i = 0; i < st.dims.size(); i++) {
+            if (mutable_dim(st, i)) pure.push_back(&st.dims[i]);
+        }
+        if (pure.empty()) return false;
+        const DimLine *d = pure[rng() % pure.size()];
+        level << " " << host.name << " " << d->var << " 0 0";
+    }
+    if (level.str() == f.compute_level) return false;
+    *desc = "compute_level " + f.name + " ->" + level.str();
+    f.compute_level = level.str();
+    // Keep store_level consistent: undefined means "same as compute".
+    f.store_level = " undefined";
+    return true;
+}
+
+// Apply 1-3 random mutations; returns a human-readable description.
+string mutate(Schedule *s, std::mt19937 &rng) {
+    string desc;
+    int wanted = 1 + rng() % 3;
+    for (int tries = 0; tries < 50 && wanted > 0; tries++) {
+        string d;
+        bool ok = false;
+        switch (rng() % 4) {
+        case 0: ok = mutate_split_factor(s, rng, &d); break;
+        case 1: ok = mutate_reorder(s, rng, &d); break;
+        case 2: ok = mutate_loop_type(s, rng, &d); break;
+        case 3: ok = mutate_compute_level(s, rng, &d); break;
+        }
+        if (ok) {
+            if (!desc.empty()) desc += "; ";
+            desc += d;
+            wanted--;
+        }
+    }
+    return desc;
+}
+
+// ---------------------------------------------------------------------------
+// Driving the generator, the compiler, and the benchmark.
+
+string substitute_dir(const string &tmpl, const string &dir) {
+    string result = tmpl;
+    size_t pos;
+    while ((pos = result.find("{DIR}")) != string::npos) {
+        result.replace(pos, 5, dir);
+    }
+    return result;
+}
+
+bool run_logged(const string &cmd, const string &log) {
+    string full = "( " + cmd + " ) >> " + log + " 2>&1";
+    return system(full.c_str()) == 0;
+}
+
+struct Options {
+    string generator, name, target = "host", output = "tune";
+    string compile;
+    string benchmark =
+        "{DIR}/bench --benchmarks=all "
+        "--default_input_buffers=random:0:estimate_then_auto "
+        "--default_input_scalars=estimate --output_extents=estimate";
+    vector<string> generator_args;
+    int samples = 100;
+    int jobs = 4;
+    unsigned seed = (unsigned)time(nullptr);
+};
+
+// Run the generator into dir, optionally applying/saving a schedule.
+bool run_generator(const Options &opt, const string &dir,
+                   const string &apply, const string &save) {
+    std::ostringstream cmd;
+    if (!apply.empty()) cmd << "HL_APPLY_SCHEDULE=" << apply << " ";
+    if (!save.empty()) cmd << "HL_SAVE_SCHEDULE=" << save << " ";
+    cmd << opt.generator << " -g " << opt.name << " -o " << dir
+        << " target=" << opt.target;
+    for (const string &a : opt.generator_args) {
+        cmd << " " << a;
+    }
+    return run_logged(cmd.str(), dir + "/log.txt");
+}
+
+// Parse RunGen's "...best case of T sec/iter..." line out of a benchmark log.
+double parse_benchmark_time(const string &log) {
+    std::ifstream in(log);
+    string line;
+    const string needle = "best case of ";
+    while (std::getline(in, line)) {
+        size_t pos = line.find(needle);
+        if (pos != string::npos) {
+            return atof(line.c_str() + pos + needle.size());
+        }
+    }
+    return -1;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        auto flag = [&](const char *name, string *value) {
+            string prefix = string(name) + "=";
+            if (arg.compare(0, prefix.size(), prefix) == 0) {
+                *value = arg.substr(prefix.size());
+                return true;
+            }
+            return false;
+        };
+        string v;
+        if (flag("--generator", &opt.generator) ||
+            flag("--name", &opt.name) ||
+            flag("--target", &opt.target) ||
+            flag("--output", &opt.output) ||
+            flag("--compile", &opt.compile) ||
+            flag("--benchmark", &opt.benchmark)) {
+            // handled
+        } else if (flag("--generator-arg", &v)) {
+            opt.generator_args.push_back(v);
+        } else if (flag("--samples", &v)) {
+            opt.samples = atoi(v.c_str());
+        } else if (flag("--jobs", &v)) {
+            opt.jobs = std::max(1, atoi(v.c_str()));
+        } else if (flag("--seed", &v)) {
+            opt.seed = (unsigned)strtoul(v.c_str(), nullptr, 10);
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            usage(argv[0]);
+        }
+    }
+    if (opt.generator.empty() || opt.name.empty() || opt.compile.empty()) {
+        usage(argv[0]);
+    }
+
+    mkdir(opt.output.c_str(), 0777);
+    const string db_path = opt.output + "/results.db";
+    const string best_path = opt.output + "/best.schedule";
+    const string baseline_path = opt.output + "/baseline.schedule";
+
+    // Dump the schedule the generator ships with.
+    {
+        string dir = opt.output + "/baseline";
+        mkdir(dir.c_str(), 0777);
+        if (!run_generator(opt, dir, "", baseline_path)) {
+            std::cerr << "Generator failed on the baseline schedule; see "
+                      << dir << "/log.txt\n";
+            return 1;
+        }
+    }
+
+    // Resume from the database: the best known time seeds the search.
+    double best_time = -1;
+    {
+        std::ifstream db(db_path);
+        string line;
+        while (std::getline(db, line)) {
+            std::istringstream l(line);
+            string status;
+            double t;
+            if (l >> status >> t && status == "ok" && t > 0 &&
+                (best_time < 0 || t < best_time)) {
+                best_time = t;
+            }
+        }
+    }
+
+    Schedule seed;
+    struct stat st;
+    const string &seed_path =
+        (best_time > 0 && stat(best_path.c_str(), &st) == 0) ? best_path
+                                                             : baseline_path;
+    if (!parse_schedule(seed_path, &seed)) {
+        std::cerr << "Could not parse schedule file " << seed_path << "\n";
+        return 1;
+    }
+    std::cout << "Seeding search from " << seed_path;
+    if (best_time > 0) {
+        std::cout << " (best known: " << best_time << " sec/iter)";
+    }
+    std::cout << "\n";
+
+    std::mt19937 rng(opt.seed);
+
+    // Generate the candidate pool up front so compiles can proceed in
+    // parallel; benchmarking stays serial to keep timings quiet.
+    struct Candidate {
+        string dir, schedule, desc;
+        bool compiled = false;
+    };
+    vector<Candidate> candidates(opt.samples);
+    for (int i = 0; i < opt.samples; i++) {
+        std::ostringstream dir;
+        dir << opt.output << "/c" << std::setw(4) << std::setfill('0') << i;
+        candidates[i].dir = dir.str();
+        candidates[i].schedule = candidates[i].dir + "/candidate.schedule";
+        mkdir(candidates[i].dir.c_str(), 0777);
+        Schedule mutant = seed;
+        candidates[i].desc = mutate(&mutant, rng);
+        write_schedule(mutant, candidates[i].schedule);
+    }
+
+    std::mutex m;
+    size_t next = 0;
+    auto worker = [&]() {
+        for (;;) {
+            size_t i;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if (next >= candidates.size()) return;
+                i = next++;
+            }
+            Candidate &c = candidates[i];
+            c.compiled =
+                run_generator(opt, c.dir, c.schedule, "") &&
+                run_logged(substitute_dir(opt.compile, c.dir),
+                           c.dir + "/log.txt");
+        }
+    };
+    vector<std::thread> threads;
+    for (int i = 0; i < opt.jobs; i++) {
+        threads.emplace_back(worker);
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    std::ofstream db(db_path, std::ios::app);
+    for (Candidate &c : candidates) {
+        double t = -1;
+        if (c.compiled) {
+            string bench_log = c.dir + "/bench.txt";
+            if (run_logged(substitute_dir(opt.benchmark, c.dir), bench_log)) {
+                t = parse_benchmark_time(bench_log);
+            }
+        }
+        const char *status = (t > 0) ? "ok" : (c.compiled ? "bench_failed"
+                                                          : "compile_failed");
+        db << status << " " << t << " " << c.dir << " # " << c.desc << "\n";
+        std::cout << c.dir << ": " << status;
+        if (t > 0) {
+            std::cout << " " << t << " sec/iter";
+        }
+        std::cout << " (" << c.desc << ")\n";
+        if (t > 0 && (best_time < 0 || t < best_time)) {
+            best_time = t;
+            std::ifstream src(c.schedule, std::ios::binary);
+            std::ofstream dst(best_path, std::ios::binary);
+            dst << src.rdbuf();
+            std::cout << "New best: " << t << " sec/iter -> " << best_path << "\n";
+        }
+    }
+    if (best_time > 0) {
+        std::cout << "Best schedule: " << best_path << " (" << best_time
+                  << " sec/iter). Re-run to keep searching, or build with "
+                  << "HL_APPLY_SCHEDULE=" << best_path << " to use it.\n";
+    } else {
+        std::cout << "No candidate produced a valid benchmark; see the "
+                  << "per-candidate log.txt files under " << opt.output << "\n";
+    }
+    return 0;
+}